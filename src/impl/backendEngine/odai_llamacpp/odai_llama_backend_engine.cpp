@@ -17,13 +17,20 @@
 #include "utils/string_utils.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <filesystem>
 #include <format>
+#include <limits>
+#include <mutex>
 #include <nlohmann/json.hpp>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -91,6 +98,37 @@ constexpr uint32_t FIXED_LLAMA_BATCH_SIZE = 512;
 constexpr uint32_t FIXED_LLAMA_UBATCH_SIZE = 512;
 constexpr int32_t FIXED_LLAMA_DECODE_THREADS = 4;
 constexpr int32_t FIXED_LLAMA_BATCH_THREADS = 4;
+// Token budget shared by all texts packed into one embedding decode
+constexpr uint32_t EMBEDDING_BATCH_TOKEN_BUDGET = 4 * DEFAULT_EMBEDDING_CONTEXT_WINDOW;
+constexpr uint32_t EMBEDDING_MAX_SEQUENCES_PER_BATCH = 16;
+// Texts a tokenizer thread claims at once, words are cheap to tokenize so claims are coarse
+constexpr size_t TOKENIZER_TEXTS_PER_CLAIM = 512;
+
+static_assert(std::is_same_v<TokenId, llama_token>, "TokenId must match llama_token");
+
+/// Tokenizes text, by default without parsing special token text inside it.
+/// llama_tokenize only reads the vocabulary, so this can run on several threads at once.
+/// @return false if tokenization failed
+bool tokenize_with_vocab(const llama_vocab* vocab, std::string_view text, bool add_special,
+                         std::vector<llama_token>& tokens_out, bool parse_special = false)
+{
+  tokens_out.clear();
+  const auto text_length = static_cast<int32_t>(text.size());
+  const int32_t required = llama_tokenize(vocab, text.data(), text_length, nullptr, 0, add_special, parse_special);
+  if (required >= 0)
+  {
+    return required == 0;
+  }
+  if (required == std::numeric_limits<int32_t>::min())
+  {
+    return false;
+  }
+
+  tokens_out.resize(static_cast<size_t>(-required));
+  const int32_t written = llama_tokenize(vocab, text.data(), text_length, tokens_out.data(),
+                                         static_cast<int32_t>(tokens_out.size()), add_special, parse_special);
+  return written == static_cast<int32_t>(tokens_out.size());
+}
 
 uint64_t estimate_mmproj_memory_requirement(uint64_t mmproj_model_file_size_bytes)
 {
@@ -120,6 +158,63 @@ llama_context_params make_base_llm_context_params(uint32_t context_window, bool
   context_params.offload_kqv = offload_kqv;
   return context_params;
 }
+
+llama_context_params make_embedding_context_params()
+{
+  llama_context_params context_params = llama_context_default_params();
+  // whole batch is decoded in one ubatch since non-causal embedding models can't split a sequence across ubatches
+  context_params.n_ctx = EMBEDDING_BATCH_TOKEN_BUDGET;
+  context_params.n_batch = EMBEDDING_BATCH_TOKEN_BUDGET;
+  context_params.n_ubatch = EMBEDDING_BATCH_TOKEN_BUDGET;
+  context_params.n_seq_max = EMBEDDING_MAX_SEQUENCES_PER_BATCH;
+  // let any sequence in the batch use the whole token budget instead of an even per-sequence split
+  context_params.kv_unified = true;
+  context_params.n_threads = FIXED_LLAMA_DECODE_THREADS;
+  context_params.n_threads_batch = FIXED_LLAMA_BATCH_THREADS;
+  context_params.embeddings = true;
+  return context_params;
+}
+
+llama_context_params make_reranker_context_params()
+{
+  // packed like embeddings, rank pooling turns each sequence's output into its relevance logit
+  llama_context_params context_params = make_embedding_context_params();
+  context_params.pooling_type = LLAMA_POOLING_TYPE_RANK;
+  return context_params;
+}
+
+/// Loads a small model (embedding, reranker) entirely on the CPU, leaving accelerators to the LLM.
+/// @return the model, or nullptr if loading failed
+llama_model* load_model_on_cpu(const std::string& path)
+{
+  llama_model_params model_params = llama_model_default_params();
+  model_params.n_gpu_layers = 0;
+  model_params.devices = nullptr;
+  model_params.main_gpu = -1;
+  model_params.split_mode = LLAMA_SPLIT_MODE_NONE;
+  model_params.use_mlock = false;
+  return llama_model_load_from_file(path.c_str(), model_params);
+}
+
+void l2_normalize(std::vector<float>& embedding)
+{
+  double sum = 0.0;
+  for (float value : embedding)
+  {
+    sum += static_cast<double>(value) * value;
+  }
+
+  if (sum <= 0.0)
+  {
+    return;
+  }
+
+  const auto inv_norm = static_cast<float>(1.0 / std::sqrt(sum));
+  for (float& value : embedding)
+  {
+    value *= inv_norm;
+  }
+}
 } // namespace
 
 /// Redirects llama.cpp log messages to the Odai logging system.
@@ -168,8 +263,15 @@ bool OdaiLlamaEngine::register_available_backends()
       get_module_directory_from_address(reinterpret_cast<const void*>(&register_available_backends));
   const std::string backend_dir_str = backend_dir.string();
 
-  ODAI_LOG(ODAI_LOG_INFO, "Registering ggml backends from runtime directory: {}", backend_dir_str);
-  ggml_backend_load_all_from_path(backend_dir_str.c_str());
+  // the ggml backend registry is process wide and loading again would register every backend twice, which happens as
+  // soon as a second engine is initialized (e.g. by the re-embedding worker)
+  static std::once_flag backends_loaded;
+  std::call_once(backends_loaded,
+                 [&]()
+                 {
+                   ODAI_LOG(ODAI_LOG_INFO, "Registering ggml backends from runtime directory: {}", backend_dir_str);
+                   ggml_backend_load_all_from_path(backend_dir_str.c_str());
+                 });
 
   if (ggml_backend_reg_by_name("cpu") != nullptr)
   {
@@ -1310,9 +1412,12 @@ std::unique_ptr<llama_context, LlamaContextDeleter> OdaiLlamaEngine::get_new_lla
   else if (model_type == ModelType::EMBEDDING)
   {
     model = this->m_embeddingModel.get();
-    context_params.n_ctx = DEFAULT_EMBEDDING_CONTEXT_WINDOW;
-    context_params.n_threads = 4;
-    context_params.embeddings = true;
+    context_params = make_embedding_context_params();
+  }
+  else if (model_type == ModelType::RERANKER)
+  {
+    model = this->m_rerankerModel.get();
+    context_params = make_reranker_context_params();
   }
   else
   {
@@ -1408,7 +1513,7 @@ OdaiResult<bool> OdaiLlamaEngine::validate_model_files(const ModelFiles& files)
         return false;
       }
     }
-    else if (files.m_modelType == ModelType::EMBEDDING)
+    else if (files.m_modelType == ModelType::EMBEDDING || files.m_modelType == ModelType::RERANKER)
     {
       if (files.m_entries.size() != 1)
       {
@@ -1482,7 +1587,9 @@ OdaiResult<void> OdaiLlamaEngine::load_embedding_model(const ModelFiles& files,
 
     std::string path = files.m_entries.at("base_model_path");
 
-    if (this->m_embeddingModelFiles.m_entries.at("base_model_path") == path)
+    auto loaded_path_it = this->m_embeddingModelFiles.m_entries.find("base_model_path");
+    if (this->m_embeddingModel != nullptr && loaded_path_it != this->m_embeddingModelFiles.m_entries.end() &&
+        loaded_path_it->second == path)
     {
       ODAI_LOG(ODAI_LOG_INFO, "embedding model {} is already loaded", path);
       // update config though, some other params might have changed
@@ -1491,14 +1598,7 @@ OdaiResult<void> OdaiLlamaEngine::load_embedding_model(const ModelFiles& files,
       return {};
     }
 
-    llama_model_params embedding_model_params = llama_model_default_params();
-    embedding_model_params.n_gpu_layers = 0; // Load entire model on CPU
-    embedding_model_params.devices = nullptr;
-    embedding_model_params.main_gpu = -1;
-    embedding_model_params.split_mode = LLAMA_SPLIT_MODE_NONE;
-    embedding_model_params.use_mlock = false;
-
-    this->m_embeddingModel.reset(llama_model_load_from_file(path.c_str(), embedding_model_params));
+    this->m_embeddingModel.reset(load_model_on_cpu(path));
 
     if (this->m_embeddingModel == nullptr)
     {
@@ -1506,6 +1606,16 @@ OdaiResult<void> OdaiLlamaEngine::load_embedding_model(const ModelFiles& files,
       return unexpected_internal_error();
     }
 
+    OdaiResult<EmbeddingTokenizerTraits> traits_res =
+        OdaiLlamaEngine::detect_embedding_tokenizer_traits(llama_model_get_vocab(this->m_embeddingModel.get()));
+    if (!traits_res)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "failed to detect tokenizer traits of embedding model {}", path);
+      this->m_embeddingModel.reset();
+      return tl::unexpected(traits_res.error());
+    }
+    this->m_embeddingTokenizerTraits = std::move(traits_res.value());
+
     this->m_embeddingModelConfig = config;
     this->m_embeddingModelFiles = files;
 
@@ -1526,6 +1636,56 @@ OdaiResult<void> OdaiLlamaEngine::load_embedding_model(const ModelFiles& files,
   }
 }
 
+OdaiResult<void> OdaiLlamaEngine::load_reranker_model(const ModelFiles& files, const RerankerModelConfig& config)
+{
+  try
+  {
+    if (files.m_modelType != ModelType::RERANKER)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Reranker loader received non-reranker model files");
+      return tl::unexpected(OdaiResultEnum::INVALID_ARGUMENT);
+    }
+
+    std::string path = files.m_entries.at("base_model_path");
+
+    auto loaded_path_it = this->m_rerankerModelFiles.m_entries.find("base_model_path");
+    if (this->m_rerankerModel != nullptr && loaded_path_it != this->m_rerankerModelFiles.m_entries.end() &&
+        loaded_path_it->second == path)
+    {
+      ODAI_LOG(ODAI_LOG_INFO, "reranker model {} is already loaded", path);
+      this->m_rerankerModelConfig = config;
+      this->m_rerankerModelFiles = files;
+      return {};
+    }
+
+    this->m_rerankerModel.reset(load_model_on_cpu(path));
+
+    if (this->m_rerankerModel == nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "failed to load reranker model");
+      return unexpected_internal_error();
+    }
+
+    this->m_rerankerModelConfig = config;
+    this->m_rerankerModelFiles = files;
+
+    ODAI_LOG(ODAI_LOG_INFO, "successfully loaded reranker model {}", path);
+    return {};
+  }
+  catch (const std::exception& e)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Exception caught while loading reranker model: {}", e.what());
+    this->m_rerankerModel.reset();
+    return unexpected_internal_error();
+  }
+  catch (...)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Unknown exception caught while loading reranker model");
+    this->m_rerankerModel.reset();
+    return unexpected_internal_error();
+  }
+}
+
 OdaiResult<void> OdaiLlamaEngine::load_language_model(const ModelFiles& files, const LLMModelConfig& config)
 {
   if (files.m_modelType != ModelType::LLM)
@@ -1635,7 +1795,10 @@ OdaiResult<std::vector<llama_token>> OdaiLlamaEngine::tokenize(const std::string
 
   if (model_type == EMBEDDING)
   {
-    // ToDo
+    if (this->m_embeddingModel != nullptr)
+    {
+      vocab = llama_model_get_vocab(this->m_embeddingModel.get());
+    }
   }
   else if (model_type == LLM)
   {
@@ -2338,6 +2501,745 @@ OdaiResult<StreamingStats> OdaiLlamaEngine::generate_streaming_chat_response(
   return this->generate_streaming_response_impl(chat_context, *sampler, formatted_prompt, bitmaps, callback, user_data);
 }
 
+OdaiResult<void> OdaiLlamaEngine::decode_embedding_batch(llama_context& context, const llama_batch& batch,
+                                                         int32_t n_sequences, int32_t n_embd,
+                                                         std::vector<std::vector<float>>& embeddings_out)
+{
+  // sequence ids are reused across batches, so drop whatever the previous batch left behind
+  llama_memory_t memory = llama_get_memory(&context);
+  if (memory != nullptr)
+  {
+    llama_memory_clear(memory, true);
+  }
+
+  if (llama_decode(&context, batch) != 0)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "llama_decode failed for embedding batch of {} sequences", n_sequences);
+    return unexpected_internal_error();
+  }
+
+  for (llama_seq_id seq_id = 0; seq_id < n_sequences; seq_id++)
+  {
+    const float* pooled_embedding = llama_get_embeddings_seq(&context, seq_id);
+    if (pooled_embedding == nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "failed to get pooled embedding for sequence {}", seq_id);
+      return unexpected_internal_error();
+    }
+
+    std::vector<float> embedding(pooled_embedding, pooled_embedding + n_embd);
+    l2_normalize(embedding);
+    embeddings_out.push_back(std::move(embedding));
+  }
+
+  return {};
+}
+
+OdaiResult<OdaiLlamaEngine::EmbeddingTokenizerTraits>
+OdaiLlamaEngine::detect_embedding_tokenizer_traits(const llama_vocab* vocab)
+{
+  if (vocab == nullptr)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "no vocab present to detect tokenizer traits");
+    return unexpected_not_initialized();
+  }
+
+  EmbeddingTokenizerTraits traits;
+
+  // an empty text tokenizes to just the special tokens, the ones equal to BOS go before the text
+  std::vector<llama_token> special_tokens;
+  if (!tokenize_with_vocab(vocab, "", true, special_tokens))
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "failed to tokenize empty text to find special tokens");
+    return unexpected_internal_error();
+  }
+  const llama_token bos = llama_vocab_bos(vocab);
+  size_t prefix_length = 0;
+  while (prefix_length < special_tokens.size() && special_tokens[prefix_length] == bos)
+  {
+    prefix_length++;
+  }
+  const auto text_position = special_tokens.begin() + static_cast<std::ptrdiff_t>(prefix_length);
+  traits.m_prefixTokens.assign(special_tokens.begin(), text_position);
+  traits.m_suffixTokens.assign(text_position, special_tokens.end());
+
+  // a tokenizer prepending a space turns " a" into an extra space token followed by "a" with its own space prefix
+  std::vector<llama_token> spaced_tokens;
+  std::vector<llama_token> plain_tokens;
+  if (!tokenize_with_vocab(vocab, " a", false, spaced_tokens) || !tokenize_with_vocab(vocab, "a", false, plain_tokens))
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "failed to tokenize probe text to detect space prefix handling");
+    return unexpected_internal_error();
+  }
+  traits.m_addsSpacePrefix = spaced_tokens.size() > plain_tokens.size();
+
+  ODAI_LOG(ODAI_LOG_DEBUG, "embedding tokenizer adds {} prefix and {} suffix special tokens, space prefix: {}",
+           traits.m_prefixTokens.size(), traits.m_suffixTokens.size(), traits.m_addsSpacePrefix);
+  return traits;
+}
+
+OdaiResult<void> OdaiLlamaEngine::prepare_embedding_model(const ModelFiles& model_files,
+                                                          const EmbeddingModelConfig& embedding_model_config)
+{
+  OdaiResult<bool> model_validation_res = validate_model_files(model_files);
+  if (!model_validation_res)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "model file validation failed with operational error: {}",
+             static_cast<std::uint32_t>(model_validation_res.error()));
+    return tl::unexpected(model_validation_res.error());
+  }
+  if (!model_validation_res.value())
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "invalid embedding model files passed");
+    return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+  }
+
+  OdaiResult<void> load_model_res = this->load_embedding_model(model_files, embedding_model_config);
+  if (!load_model_res)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to load given embedding model, error code: {}",
+             static_cast<std::uint32_t>(load_model_res.error()));
+    return tl::unexpected(load_model_res.error());
+  }
+
+  return {};
+}
+
+OdaiResult<std::vector<std::vector<float>>>
+OdaiLlamaEngine::embed_token_sequences(std::vector<std::vector<llama_token>>& token_sequences)
+{
+  std::vector<std::vector<float>> embeddings;
+
+  std::unique_ptr<llama_context, LlamaContextDeleter> context = this->get_new_llama_context(ModelType::EMBEDDING);
+  if (context == nullptr)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "failed to create embedding context");
+    return unexpected_internal_error();
+  }
+
+  if (llama_pooling_type(context.get()) == LLAMA_POOLING_TYPE_NONE)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "embedding model doesn't define a pooling type, can't produce text embeddings");
+    return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+  }
+
+  const int32_t n_embd = llama_model_n_embd(this->m_embeddingModel.get());
+  const uint32_t batch_token_budget = llama_n_batch(context.get());
+  const auto max_sequences_per_batch = static_cast<int32_t>(llama_n_seq_max(context.get()));
+
+  size_t max_tokens_per_text = std::min<size_t>(DEFAULT_EMBEDDING_CONTEXT_WINDOW, batch_token_budget);
+  const int32_t n_ctx_train = llama_model_n_ctx_train(this->m_embeddingModel.get());
+  if (n_ctx_train > 0)
+  {
+    max_tokens_per_text = std::min<size_t>(max_tokens_per_text, static_cast<size_t>(n_ctx_train));
+  }
+
+  std::unique_ptr<llama_batch, LlamaBatchDeleter> batch = nullptr;
+  batch.reset(new llama_batch(llama_batch_init(static_cast<int32_t>(batch_token_budget), 0, 1)));
+
+  embeddings.reserve(token_sequences.size());
+  int32_t n_sequences_in_batch = 0;
+
+  for (std::vector<llama_token>& tokens : token_sequences)
+  {
+    if (tokens.empty())
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "text produced no tokens, can't embed it");
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+
+    if (tokens.size() > max_tokens_per_text)
+    {
+      ODAI_LOG(ODAI_LOG_WARN, "text has {} tokens, truncating to embedding window of {} tokens", tokens.size(),
+               max_tokens_per_text);
+      tokens.resize(max_tokens_per_text);
+    }
+
+    // flush the current batch when this text doesn't fit in it anymore
+    if (n_sequences_in_batch == max_sequences_per_batch ||
+        static_cast<size_t>(batch->n_tokens) + tokens.size() > batch_token_budget)
+    {
+      OdaiResult<void> decode_res =
+          OdaiLlamaEngine::decode_embedding_batch(*context, *batch, n_sequences_in_batch, n_embd, embeddings);
+      if (!decode_res)
+      {
+        return tl::unexpected(decode_res.error());
+      }
+      batch->n_tokens = 0;
+      n_sequences_in_batch = 0;
+    }
+
+    uint32_t pos = 0;
+    OdaiLlamaEngine::add_tokens_to_batch(tokens, *batch, pos, n_sequences_in_batch, true);
+    // pooling reads the outputs of every token of the sequence, not just the last one
+    for (int32_t i = batch->n_tokens - static_cast<int32_t>(tokens.size()); i < batch->n_tokens; i++)
+    {
+      batch->logits[i] = 1;
+    }
+    n_sequences_in_batch++;
+  }
+
+  if (n_sequences_in_batch > 0)
+  {
+    OdaiResult<void> decode_res =
+        OdaiLlamaEngine::decode_embedding_batch(*context, *batch, n_sequences_in_batch, n_embd, embeddings);
+    if (!decode_res)
+    {
+      return tl::unexpected(decode_res.error());
+    }
+  }
+
+  ODAI_LOG(ODAI_LOG_DEBUG, "Generated {} embeddings of dimension {}", embeddings.size(), n_embd);
+  return embeddings;
+}
+
+OdaiResult<std::vector<std::vector<float>>>
+OdaiLlamaEngine::generate_embeddings(const std::vector<std::string>& texts,
+                                     const EmbeddingModelConfig& embedding_model_config, const ModelFiles& model_files)
+{
+  try
+  {
+    if (!this->m_isInitialized)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "llama backend is not Initialized yet hence can't generate embeddings");
+      return unexpected_not_initialized();
+    }
+
+    if (texts.empty())
+    {
+      return std::vector<std::vector<float>>{};
+    }
+
+    OdaiResult<void> prepare_res = this->prepare_embedding_model(model_files, embedding_model_config);
+    if (!prepare_res)
+    {
+      return tl::unexpected(prepare_res.error());
+    }
+
+    std::vector<std::vector<llama_token>> token_sequences;
+    token_sequences.reserve(texts.size());
+    for (const std::string& text : texts)
+    {
+      OdaiResult<std::vector<llama_token>> tokens_res = this->tokenize(text, true, ModelType::EMBEDDING);
+      if (!tokens_res)
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "failed to tokenize text for embedding, error code: {}",
+                 static_cast<std::uint32_t>(tokens_res.error()));
+        return tl::unexpected(tokens_res.error());
+      }
+      token_sequences.push_back(std::move(tokens_res.value()));
+    }
+
+    return this->embed_token_sequences(token_sequences);
+  }
+  ODAI_CATCH_RETURN(unexpected_internal_error())
+}
+
+OdaiResult<std::vector<std::vector<TokenId>>>
+OdaiLlamaEngine::tokenize_embedding_texts(const std::vector<std::string>& texts,
+                                          const EmbeddingModelConfig& embedding_model_config,
+                                          const ModelFiles& model_files)
+{
+  try
+  {
+    if (!this->m_isInitialized)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "llama backend is not Initialized yet hence can't tokenize texts");
+      return unexpected_not_initialized();
+    }
+
+    std::vector<std::vector<TokenId>> tokens(texts.size());
+    if (texts.empty())
+    {
+      return tokens;
+    }
+
+    OdaiResult<void> prepare_res = this->prepare_embedding_model(model_files, embedding_model_config);
+    if (!prepare_res)
+    {
+      return tl::unexpected(prepare_res.error());
+    }
+
+    const llama_vocab* vocab = llama_model_get_vocab(this->m_embeddingModel.get());
+    const bool fold_space_prefix = this->m_embeddingTokenizerTraits.m_addsSpacePrefix;
+    std::atomic<size_t> next_text{0};
+    std::atomic<bool> failed{false};
+
+    // every worker claims blocks of texts until none are left, tokens of a text are written only by its claimer
+    auto tokenize_worker = [&]()
+    {
+      try
+      {
+        while (!failed)
+        {
+          const size_t begin = next_text.fetch_add(TOKENIZER_TEXTS_PER_CLAIM);
+          if (begin >= texts.size())
+          {
+            return;
+          }
+
+          const size_t end = std::min(begin + TOKENIZER_TEXTS_PER_CLAIM, texts.size());
+          for (size_t i = begin; i < end; ++i)
+          {
+            std::string_view text = texts[i];
+            if (fold_space_prefix && !text.empty() && text.front() == ' ')
+            {
+              text.remove_prefix(1);
+            }
+            if (!tokenize_with_vocab(vocab, text, false, tokens[i]))
+            {
+              failed = true;
+              return;
+            }
+          }
+        }
+      }
+      catch (const std::exception& e)
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "tokenizer thread failed: {}", e.what());
+        failed = true;
+      }
+    };
+
+    const size_t claims = (texts.size() + TOKENIZER_TEXTS_PER_CLAIM - 1) / TOKENIZER_TEXTS_PER_CLAIM;
+    const size_t worker_count = std::min<size_t>(std::max(1U, std::thread::hardware_concurrency()), claims);
+
+    std::vector<std::thread> workers;
+    try
+    {
+      for (size_t i = 1; i < worker_count; ++i)
+      {
+        workers.emplace_back(tokenize_worker);
+      }
+    }
+    catch (const std::exception& e)
+    {
+      // the calling thread still tokenizes whatever the started workers don't
+      ODAI_LOG(ODAI_LOG_WARN, "started only {} tokenizer threads: {}", workers.size(), e.what());
+    }
+    tokenize_worker();
+    for (std::thread& worker : workers)
+    {
+      worker.join();
+    }
+
+    if (failed)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "failed to tokenize texts for embedding");
+      return unexpected_internal_error();
+    }
+
+    ODAI_LOG(ODAI_LOG_DEBUG, "Tokenized {} texts on {} threads", texts.size(), workers.size() + 1);
+    return tokens;
+  }
+  ODAI_CATCH_RETURN(unexpected_internal_error())
+}
+
+OdaiResult<std::vector<std::vector<float>>>
+OdaiLlamaEngine::generate_embeddings_from_tokens(const std::vector<std::vector<TokenId>>& token_sequences,
+                                                 const EmbeddingModelConfig& embedding_model_config,
+                                                 const ModelFiles& model_files)
+{
+  try
+  {
+    if (!this->m_isInitialized)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "llama backend is not Initialized yet hence can't generate embeddings");
+      return unexpected_not_initialized();
+    }
+
+    if (token_sequences.empty())
+    {
+      return std::vector<std::vector<float>>{};
+    }
+
+    OdaiResult<void> prepare_res = this->prepare_embedding_model(model_files, embedding_model_config);
+    if (!prepare_res)
+    {
+      return tl::unexpected(prepare_res.error());
+    }
+
+    const EmbeddingTokenizerTraits& traits = this->m_embeddingTokenizerTraits;
+    std::vector<std::vector<llama_token>> wrapped_sequences;
+    wrapped_sequences.reserve(token_sequences.size());
+    for (const std::vector<TokenId>& tokens : token_sequences)
+    {
+      if (tokens.empty())
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "empty token sequence passed, can't embed it");
+        return tl::unexpected(OdaiResultEnum::INVALID_ARGUMENT);
+      }
+
+      std::vector<llama_token>& wrapped = wrapped_sequences.emplace_back();
+      wrapped.reserve(traits.m_prefixTokens.size() + tokens.size() + traits.m_suffixTokens.size());
+      wrapped.insert(wrapped.end(), traits.m_prefixTokens.begin(), traits.m_prefixTokens.end());
+      wrapped.insert(wrapped.end(), tokens.begin(), tokens.end());
+      wrapped.insert(wrapped.end(), traits.m_suffixTokens.begin(), traits.m_suffixTokens.end());
+    }
+
+    return this->embed_token_sequences(wrapped_sequences);
+  }
+  ODAI_CATCH_RETURN(unexpected_internal_error())
+}
+
+OdaiResult<std::vector<OdaiLlamaEngine::RerankLayoutSegment>>
+OdaiLlamaEngine::build_rerank_layout(const std::string& query, size_t max_query_tokens) const
+{
+  const llama_vocab* vocab = llama_model_get_vocab(this->m_rerankerModel.get());
+
+  std::vector<llama_token> query_tokens;
+  if (!tokenize_with_vocab(vocab, query, false, query_tokens))
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "failed to tokenize rerank query");
+    return unexpected_internal_error();
+  }
+  if (query_tokens.size() > max_query_tokens)
+  {
+    ODAI_LOG(ODAI_LOG_WARN, "rerank query has {} tokens, truncating to {}", query_tokens.size(), max_query_tokens);
+    query_tokens.resize(max_query_tokens);
+  }
+
+  std::vector<RerankLayoutSegment> layout(1);
+  auto append_fixed = [&layout](const std::vector<llama_token>& tokens)
+  {
+    if (layout.back().m_isDocument)
+    {
+      layout.emplace_back();
+    }
+    layout.back().m_tokens.insert(layout.back().m_tokens.end(), tokens.begin(), tokens.end());
+  };
+  auto append_document = [&layout]() { layout.push_back({true, {}}); };
+
+  const char* rerank_template = llama_model_chat_template(this->m_rerankerModel.get(), "rerank");
+  if (rerank_template != nullptr)
+  {
+    // template text may name special tokens, the query and document are inserted as plain tokens
+    constexpr std::string_view QUERY_PLACEHOLDER = "{query}";
+    constexpr std::string_view DOCUMENT_PLACEHOLDER = "{document}";
+    std::string_view rest = rerank_template;
+    while (!rest.empty())
+    {
+      const size_t query_pos = rest.find(QUERY_PLACEHOLDER);
+      const size_t document_pos = rest.find(DOCUMENT_PLACEHOLDER);
+      const size_t placeholder_pos = std::min(query_pos, document_pos);
+
+      std::vector<llama_token> literal_tokens;
+      if (!tokenize_with_vocab(vocab, rest.substr(0, placeholder_pos), false, literal_tokens, true))
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "failed to tokenize rerank template");
+        return unexpected_internal_error();
+      }
+      append_fixed(literal_tokens);
+
+      if (placeholder_pos == std::string_view::npos)
+      {
+        break;
+      }
+      if (placeholder_pos == query_pos)
+      {
+        append_fixed(query_tokens);
+        rest.remove_prefix(query_pos + QUERY_PLACEHOLDER.size());
+      }
+      else
+      {
+        append_document();
+        rest.remove_prefix(document_pos + DOCUMENT_PLACEHOLDER.size());
+      }
+    }
+    return layout;
+  }
+
+  llama_token eos = llama_vocab_eos(vocab);
+  if (eos == LLAMA_TOKEN_NULL)
+  {
+    eos = llama_vocab_sep(vocab);
+  }
+  std::vector<llama_token> before_query;
+  std::vector<llama_token> between;
+  std::vector<llama_token> after_document;
+  if (llama_vocab_get_add_bos(vocab))
+  {
+    before_query.push_back(llama_vocab_bos(vocab));
+  }
+  if (llama_vocab_get_add_eos(vocab))
+  {
+    between.push_back(eos);
+    after_document.push_back(eos);
+  }
+  if (llama_vocab_get_add_sep(vocab))
+  {
+    between.push_back(llama_vocab_sep(vocab));
+  }
+
+  append_fixed(before_query);
+  append_fixed(query_tokens);
+  append_fixed(between);
+  append_document();
+  append_fixed(after_document);
+  return layout;
+}
+
+OdaiResult<void> OdaiLlamaEngine::decode_rerank_batch(llama_context& context, const llama_batch& batch,
+                                                      int32_t n_sequences, std::vector<float>& scores_out)
+{
+  llama_memory_t memory = llama_get_memory(&context);
+  if (memory != nullptr)
+  {
+    llama_memory_clear(memory, true);
+  }
+
+  if (llama_decode(&context, batch) != 0)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "llama_decode failed for rerank batch of {} sequences", n_sequences);
+    return unexpected_internal_error();
+  }
+
+  for (llama_seq_id seq_id = 0; seq_id < n_sequences; seq_id++)
+  {
+    // rank pooling leaves the classifier output of the sequence, the first value is the relevance logit
+    const float* rank_output = llama_get_embeddings_seq(&context, seq_id);
+    if (rank_output == nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "failed to get rerank score for sequence {}", seq_id);
+      return unexpected_internal_error();
+    }
+    scores_out.push_back(1.0F / (1.0F + std::exp(-rank_output[0])));
+  }
+
+  return {};
+}
+
+OdaiResult<uint32_t> OdaiLlamaEngine::get_embedding_dimensions(const EmbeddingModelConfig& embedding_model_config,
+                                                              const ModelFiles& model_files)
+{
+  try
+  {
+    if (!this->m_isInitialized)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "llama backend is not Initialized yet hence can't read embedding dimensions");
+      return unexpected_not_initialized();
+    }
+
+    // the space being created is filled with this model next, so this load is not wasted
+    OdaiResult<void> prepare_res = this->prepare_embedding_model(model_files, embedding_model_config);
+    if (!prepare_res)
+    {
+      return tl::unexpected(prepare_res.error());
+    }
+
+    const int32_t n_embd = llama_model_n_embd(this->m_embeddingModel.get());
+    if (n_embd <= 0)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "embedding model reports invalid embedding dimension {}", n_embd);
+      return unexpected_internal_error();
+    }
+    return static_cast<uint32_t>(n_embd);
+  }
+  ODAI_CATCH_RETURN(unexpected_internal_error())
+}
+
+OdaiResult<std::vector<uint32_t>> OdaiLlamaEngine::count_llm_tokens(const std::vector<std::string>& texts,
+                                                                    const LLMModelConfig& llm_model_config,
+                                                                    const ModelFiles& model_files)
+{
+  try
+  {
+    if (!this->m_isInitialized)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "llama backend is not Initialized yet hence can't count tokens");
+      return unexpected_not_initialized();
+    }
+
+    std::vector<uint32_t> counts;
+    if (texts.empty())
+    {
+      return counts;
+    }
+
+    OdaiResult<bool> model_validation_res = validate_model_files(model_files);
+    if (!model_validation_res)
+    {
+      return tl::unexpected(model_validation_res.error());
+    }
+    if (!model_validation_res.value())
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "invalid model files passed");
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+
+    // the request generating next needs the same model loaded, so this load is not wasted
+    OdaiResult<void> load_model_res = this->load_language_model(model_files, llm_model_config);
+    if (!load_model_res)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Failed to load given language model, error code: {}",
+               static_cast<std::uint32_t>(load_model_res.error()));
+      return tl::unexpected(load_model_res.error());
+    }
+
+    counts.reserve(texts.size());
+    std::vector<llama_token> tokens;
+    for (const std::string& text : texts)
+    {
+      if (!tokenize_with_vocab(this->m_loadedLlmState.m_vocab, text, false, tokens))
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "failed to tokenize text of {} bytes to count its tokens", text.size());
+        return unexpected_internal_error();
+      }
+      counts.push_back(static_cast<uint32_t>(tokens.size()));
+    }
+    return counts;
+  }
+  ODAI_CATCH_RETURN(unexpected_internal_error())
+}
+
+OdaiResult<std::vector<float>> OdaiLlamaEngine::rerank(const std::string& query,
+                                                       const std::vector<std::string>& documents,
+                                                       const RerankerModelConfig& reranker_model_config,
+                                                       const ModelFiles& model_files)
+{
+  try
+  {
+    if (!this->m_isInitialized)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "llama backend is not Initialized yet hence can't rerank");
+      return unexpected_not_initialized();
+    }
+
+    if (documents.empty())
+    {
+      return std::vector<float>{};
+    }
+
+    OdaiResult<bool> model_validation_res = validate_model_files(model_files);
+    if (!model_validation_res)
+    {
+      return tl::unexpected(model_validation_res.error());
+    }
+    if (!model_validation_res.value() || model_files.m_modelType != ModelType::RERANKER)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "invalid reranker model files passed");
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+
+    OdaiResult<void> load_model_res = this->load_reranker_model(model_files, reranker_model_config);
+    if (!load_model_res)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Failed to load given reranker model, error code: {}",
+               static_cast<std::uint32_t>(load_model_res.error()));
+      return tl::unexpected(load_model_res.error());
+    }
+
+    std::unique_ptr<llama_context, LlamaContextDeleter> context = this->get_new_llama_context(ModelType::RERANKER);
+    if (context == nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "failed to create reranker context");
+      return unexpected_internal_error();
+    }
+    if (llama_pooling_type(context.get()) != LLAMA_POOLING_TYPE_RANK)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "reranker model doesn't support rank pooling, is it a cross-encoder?");
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+
+    const uint32_t batch_token_budget = llama_n_batch(context.get());
+    const auto max_sequences_per_batch = static_cast<int32_t>(llama_n_seq_max(context.get()));
+    size_t max_tokens_per_pair = std::min<size_t>(DEFAULT_RERANKER_CONTEXT_WINDOW, batch_token_budget);
+    const int32_t n_ctx_train = llama_model_n_ctx_train(this->m_rerankerModel.get());
+    if (n_ctx_train > 0)
+    {
+      max_tokens_per_pair = std::min<size_t>(max_tokens_per_pair, static_cast<size_t>(n_ctx_train));
+    }
+
+    // the query keeps at most half of the pair, so every document is scored on some of its text
+    OdaiResult<std::vector<RerankLayoutSegment>> layout_res = this->build_rerank_layout(query, max_tokens_per_pair / 2);
+    if (!layout_res)
+    {
+      return tl::unexpected(layout_res.error());
+    }
+    const std::vector<RerankLayoutSegment>& layout = layout_res.value();
+    size_t fixed_tokens = 0;
+    size_t document_slots = 0;
+    for (const RerankLayoutSegment& segment : layout)
+    {
+      fixed_tokens += segment.m_tokens.size();
+      document_slots += segment.m_isDocument ? 1 : 0;
+    }
+    if (document_slots == 0 || fixed_tokens >= max_tokens_per_pair)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "reranker pair layout leaves no room for the document");
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+    const size_t max_document_tokens = (max_tokens_per_pair - fixed_tokens) / document_slots;
+
+    const llama_vocab* vocab = llama_model_get_vocab(this->m_rerankerModel.get());
+    std::unique_ptr<llama_batch, LlamaBatchDeleter> batch = nullptr;
+    batch.reset(new llama_batch(llama_batch_init(static_cast<int32_t>(batch_token_budget), 0, 1)));
+
+    std::vector<float> scores;
+    scores.reserve(documents.size());
+    int32_t n_sequences_in_batch = 0;
+    std::vector<llama_token> document_tokens;
+    std::vector<llama_token> pair_tokens;
+
+    for (const std::string& document : documents)
+    {
+      if (!tokenize_with_vocab(vocab, document, false, document_tokens))
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "failed to tokenize document for reranking");
+        return unexpected_internal_error();
+      }
+      if (document_tokens.size() > max_document_tokens)
+      {
+        document_tokens.resize(max_document_tokens);
+      }
+
+      pair_tokens.clear();
+      for (const RerankLayoutSegment& segment : layout)
+      {
+        const std::vector<llama_token>& tokens = segment.m_isDocument ? document_tokens : segment.m_tokens;
+        pair_tokens.insert(pair_tokens.end(), tokens.begin(), tokens.end());
+      }
+
+      // flush the current batch when this pair doesn't fit in it anymore
+      if (n_sequences_in_batch == max_sequences_per_batch ||
+          static_cast<size_t>(batch->n_tokens) + pair_tokens.size() > batch_token_budget)
+      {
+        OdaiResult<void> decode_res =
+            OdaiLlamaEngine::decode_rerank_batch(*context, *batch, n_sequences_in_batch, scores);
+        if (!decode_res)
+        {
+          return tl::unexpected(decode_res.error());
+        }
+        batch->n_tokens = 0;
+        n_sequences_in_batch = 0;
+      }
+
+      uint32_t pos = 0;
+      OdaiLlamaEngine::add_tokens_to_batch(pair_tokens, *batch, pos, n_sequences_in_batch, true);
+      // rank pooling reads the outputs of the whole sequence, like the embedding pooling types
+      for (int32_t i = batch->n_tokens - static_cast<int32_t>(pair_tokens.size()); i < batch->n_tokens; i++)
+      {
+        batch->logits[i] = 1;
+      }
+      n_sequences_in_batch++;
+    }
+
+    if (n_sequences_in_batch > 0)
+    {
+      OdaiResult<void> decode_res =
+          OdaiLlamaEngine::decode_rerank_batch(*context, *batch, n_sequences_in_batch, scores);
+      if (!decode_res)
+      {
+        return tl::unexpected(decode_res.error());
+      }
+    }
+
+    ODAI_LOG(ODAI_LOG_DEBUG, "Reranked {} documents", scores.size());
+    return scores;
+  }
+  ODAI_CATCH_RETURN(unexpected_internal_error())
+}
+
 OdaiLlamaEngine::~OdaiLlamaEngine()
 {
   llama_backend_free();
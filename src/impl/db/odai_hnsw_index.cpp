@@ -0,0 +1,813 @@
+#include "db/odai_hnsw_index.h"
+#include "odai_logger.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <queue>
+#include <type_traits>
+
+namespace
+{
+constexpr char HNSW_FILE_MAGIC[8] = {'O', 'D', 'A', 'I', 'H', 'N', 'S', 'W'};
+constexpr uint32_t HNSW_FILE_VERSION = 2;
+/// Sections of the index file start on cache line boundaries so mapped arrays are aligned for their element types
+constexpr size_t HNSW_FILE_SECTION_ALIGNMENT = 64;
+/// Largest vector dimension accepted from an index file, guards the size computations against corrupt headers
+constexpr uint64_t HNSW_MAX_FILE_DIMENSIONS = 1U << 16U;
+
+/// Levels are drawn from an exponential distribution, this cap only guards against a pathological draw
+constexpr uint32_t HNSW_MAX_LEVEL = 16;
+/// Fixed seed so building the same vectors in the same order gives the same graph
+constexpr uint64_t HNSW_LEVEL_SEED = 0x0DA1C0DE;
+
+/// Below this many vectors in a scope an exact scan is cheap enough that the graph isn't worth its approximation
+constexpr uint64_t HNSW_MIN_GRAPH_SEARCH_VECTORS = 4096;
+/// The graph is walked for a scope only if it holds at least 1 / HNSW_MAX_SCOPE_DILUTION of the indexed vectors,
+/// otherwise most of the visited nodes belong to other scopes
+constexpr uint64_t HNSW_MAX_SCOPE_DILUTION = 16;
+/// The graph is rebuilt once more than 1 / HNSW_MAX_DELETED_SHARE of its nodes are deleted. Searches walk through
+/// deleted nodes, so up to this share they cost less than a build.
+constexpr uint64_t HNSW_MAX_DELETED_SHARE = 4;
+
+struct HnswFileHeader
+{
+  char m_magic[8];
+  uint32_t m_version;
+  uint32_t m_dimensions;
+  uint32_t m_maxConnections;
+  uint32_t m_efConstruction;
+  uint64_t m_count;
+  uint64_t m_upperBlockCount;
+  int64_t m_maxRowid;
+  uint32_t m_entryPoint;
+  uint32_t m_maxLevel;
+  uint64_t m_scopeCount;
+  uint64_t m_scopeTableBytes;
+};
+static_assert(std::is_trivially_copyable_v<HnswFileHeader>);
+
+/// Byte offsets of the sections of an index file
+struct HnswFileLayout
+{
+  size_t m_vectors;
+  size_t m_rowids;
+  size_t m_nodeScopes;
+  size_t m_levels;
+  size_t m_level0Links;
+  size_t m_upperLinkOffsets;
+  size_t m_upperLinks;
+  size_t m_deleted;
+  size_t m_scopeTable;
+  size_t m_total;
+};
+
+/// @return number of 64 bit words holding one deletion bit per node
+size_t deleted_words(size_t count)
+{
+  return (count + 63) / 64;
+}
+
+size_t align_section(size_t offset)
+{
+  return (offset + HNSW_FILE_SECTION_ALIGNMENT - 1) / HNSW_FILE_SECTION_ALIGNMENT * HNSW_FILE_SECTION_ALIGNMENT;
+}
+
+HnswFileLayout compute_layout(const HnswFileHeader& header)
+{
+  const size_t count = header.m_count;
+  const size_t level0_entries = 2 * static_cast<size_t>(header.m_maxConnections) + 1;
+  const size_t upper_entries = static_cast<size_t>(header.m_maxConnections) + 1;
+
+  HnswFileLayout layout{};
+  layout.m_vectors = align_section(sizeof(HnswFileHeader));
+  layout.m_rowids = align_section(layout.m_vectors + count * header.m_dimensions * sizeof(float));
+  layout.m_nodeScopes = align_section(layout.m_rowids + count * sizeof(int64_t));
+  layout.m_levels = align_section(layout.m_nodeScopes + count * sizeof(uint32_t));
+  layout.m_level0Links = align_section(layout.m_levels + count * sizeof(uint32_t));
+  layout.m_upperLinkOffsets = align_section(layout.m_level0Links + count * level0_entries * sizeof(uint32_t));
+  layout.m_upperLinks = align_section(layout.m_upperLinkOffsets + count * sizeof(uint32_t));
+  layout.m_deleted = align_section(layout.m_upperLinks + header.m_upperBlockCount * upper_entries * sizeof(uint32_t));
+  layout.m_scopeTable = align_section(layout.m_deleted + deleted_words(count) * sizeof(uint64_t));
+  layout.m_total = layout.m_scopeTable + header.m_scopeTableBytes;
+  return layout;
+}
+
+/// Writes a section at its offset, padding with zeros from the current position.
+void write_section(std::ofstream& out, size_t& position, size_t offset, const void* data, size_t bytes)
+{
+  static constexpr char PADDING[HNSW_FILE_SECTION_ALIGNMENT] = {};
+  out.write(PADDING, static_cast<std::streamsize>(offset - position));
+  if (bytes > 0)
+  {
+    out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+  }
+  position = offset + bytes;
+}
+
+template <typename T>
+const T* section_at(const uint8_t* image, size_t offset)
+{
+  return reinterpret_cast<const T*>(image + offset);
+}
+
+/// L2-normalizes a vector in place, a zero vector is left unchanged.
+void normalize(float* values, size_t count)
+{
+  double norm = 0.0;
+  for (size_t i = 0; i < count; ++i)
+  {
+    norm += static_cast<double>(values[i]) * values[i];
+  }
+  if (norm <= 0.0)
+  {
+    return;
+  }
+  const float inverse = static_cast<float>(1.0 / std::sqrt(norm));
+  for (size_t i = 0; i < count; ++i)
+  {
+    values[i] *= inverse;
+  }
+}
+} // namespace
+
+OdaiHnswIndex::OdaiHnswIndex(uint32_t dimensions, const VectorIndexConfig& config)
+    : m_dimensions(dimensions), m_config(config), m_maxLinks(config.m_hnswMaxConnections),
+      m_maxLinksLevel0(2 * config.m_hnswMaxConnections),
+      m_levelMultiplier(1.0 / std::log(static_cast<double>(config.m_hnswMaxConnections))),
+      m_levelGenerator(HNSW_LEVEL_SEED)
+{
+}
+
+OdaiResult<std::unique_ptr<OdaiHnswIndex>> OdaiHnswIndex::load(const std::filesystem::path& path,
+                                                               const VectorIndexConfig& config, uint64_t offset)
+{
+  auto mapped_res = OdaiMappedFile::open(path);
+  if (!mapped_res)
+  {
+    return tl::unexpected(mapped_res.error());
+  }
+  std::unique_ptr<OdaiMappedFile> mapped = std::move(mapped_res.value());
+  if (offset >= mapped->size())
+  {
+    return tl::unexpected(OdaiResultEnum::NOT_FOUND);
+  }
+  if (offset % HNSW_FILE_SECTION_ALIGNMENT != 0)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "HNSW index at offset {} of {} is misaligned", offset, path.string());
+    return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+  }
+  const uint8_t* const image = mapped->data() + offset;
+  const size_t file_size = mapped->size() - offset;
+
+  HnswFileHeader header{};
+  if (file_size < sizeof(header))
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "HNSW index file {} is truncated", path.string());
+    return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+  }
+  std::memcpy(&header, image, sizeof(header));
+
+  if (std::memcmp(header.m_magic, HNSW_FILE_MAGIC, sizeof(HNSW_FILE_MAGIC)) != 0 ||
+      header.m_version != HNSW_FILE_VERSION)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "{} is not a version {} HNSW index file", path.string(), HNSW_FILE_VERSION);
+    return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+  }
+
+  if (header.m_maxConnections != config.m_hnswMaxConnections ||
+      header.m_efConstruction != config.m_hnswEfConstruction)
+  {
+    ODAI_LOG(ODAI_LOG_WARN, "HNSW index file {} was built with M={} efConstruction={}, expected M={} efConstruction={}",
+             path.string(), header.m_maxConnections, header.m_efConstruction, config.m_hnswMaxConnections,
+             config.m_hnswEfConstruction);
+    return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+  }
+
+  // bound every count by the file size first so the layout computation can't overflow
+  const bool counts_sane = header.m_dimensions > 0 && header.m_dimensions <= HNSW_MAX_FILE_DIMENSIONS &&
+                           header.m_count <= file_size && header.m_upperBlockCount <= file_size &&
+                           header.m_scopeCount <= file_size && header.m_scopeTableBytes <= file_size &&
+                           header.m_count < NO_NODE && header.m_maxLevel <= HNSW_MAX_LEVEL &&
+                           ((header.m_count == 0 && header.m_entryPoint == NO_NODE) ||
+                            header.m_entryPoint < header.m_count);
+  const HnswFileLayout layout = compute_layout(header);
+  if (!counts_sane || layout.m_total != file_size)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "HNSW index file {} is corrupt", path.string());
+    return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+  }
+
+  std::unique_ptr<OdaiHnswIndex> index = std::make_unique<OdaiHnswIndex>(header.m_dimensions, config);
+  const size_t count = header.m_count;
+
+  // scope table: per scope its vector count (uint64), name length (uint32) and name bytes
+  const uint8_t* cursor = image + layout.m_scopeTable;
+  const uint8_t* const table_end = image + layout.m_total;
+  for (uint64_t i = 0; i < header.m_scopeCount; ++i)
+  {
+    uint64_t scope_size = 0;
+    uint32_t name_length = 0;
+    if (static_cast<size_t>(table_end - cursor) < sizeof(scope_size) + sizeof(name_length))
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "HNSW index file {} has a truncated scope table", path.string());
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+    std::memcpy(&scope_size, cursor, sizeof(scope_size));
+    cursor += sizeof(scope_size);
+    std::memcpy(&name_length, cursor, sizeof(name_length));
+    cursor += sizeof(name_length);
+    if (static_cast<size_t>(table_end - cursor) < name_length)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "HNSW index file {} has a truncated scope table", path.string());
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+    ScopeId scope_id(reinterpret_cast<const char*>(cursor), name_length);
+    cursor += name_length;
+
+    index->m_scopeOrdinalByName.emplace(scope_id, static_cast<uint32_t>(index->m_scopes.size()));
+    index->m_scopes.push_back(std::move(scope_id));
+    index->m_scopeSizes.push_back(scope_size);
+  }
+
+  index->m_vectors.view(section_at<float>(image, layout.m_vectors), count * header.m_dimensions);
+  index->m_rowids.view(section_at<int64_t>(image, layout.m_rowids), count);
+  index->m_nodeScopes.view(section_at<uint32_t>(image, layout.m_nodeScopes), count);
+  index->m_levels.view(section_at<uint32_t>(image, layout.m_levels), count);
+  index->m_level0Links.view(section_at<uint32_t>(image, layout.m_level0Links),
+                            count * (index->m_maxLinksLevel0 + 1));
+  index->m_upperLinkOffsets.view(section_at<uint32_t>(image, layout.m_upperLinkOffsets), count);
+  index->m_upperLinks.view(section_at<uint32_t>(image, layout.m_upperLinks),
+                           header.m_upperBlockCount * (index->m_maxLinks + 1));
+  index->m_deleted.view(section_at<uint64_t>(image, layout.m_deleted), deleted_words(count));
+  for (size_t word = 0; word < deleted_words(count); ++word)
+  {
+    index->m_deletedCount += static_cast<size_t>(std::popcount(index->m_deleted.data()[word]));
+  }
+
+  index->m_count = count;
+  index->m_maxRowid = header.m_maxRowid;
+  index->m_entryPoint = header.m_entryPoint;
+  index->m_maxLevel = header.m_maxLevel;
+  if (!index->has_consistent_graph(header.m_upperBlockCount))
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "HNSW index file {} has a corrupt graph", path.string());
+    return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+  }
+  index->m_mappedFile = std::move(mapped);
+  // continue the level sequence differently from a fresh index so reloads don't replay the first draws
+  index->m_levelGenerator.seed(HNSW_LEVEL_SEED + count);
+
+  return index;
+}
+
+OdaiResult<void> OdaiHnswIndex::save(const std::filesystem::path& path)
+{
+  // the file being replaced may be the one this index maps, some platforms refuse to replace a mapped file
+  materialize();
+
+  try
+  {
+    std::string scope_table;
+    for (size_t i = 0; i < m_scopes.size(); ++i)
+    {
+      const uint64_t scope_size = m_scopeSizes[i];
+      const auto name_length = static_cast<uint32_t>(m_scopes[i].size());
+      scope_table.append(reinterpret_cast<const char*>(&scope_size), sizeof(scope_size));
+      scope_table.append(reinterpret_cast<const char*>(&name_length), sizeof(name_length));
+      scope_table.append(m_scopes[i]);
+    }
+
+    HnswFileHeader header{};
+    std::memcpy(header.m_magic, HNSW_FILE_MAGIC, sizeof(HNSW_FILE_MAGIC));
+    header.m_version = HNSW_FILE_VERSION;
+    header.m_dimensions = m_dimensions;
+    header.m_maxConnections = m_maxLinks;
+    header.m_efConstruction = m_config.m_hnswEfConstruction;
+    header.m_count = m_count;
+    header.m_upperBlockCount = m_upperLinks.size() / (m_maxLinks + 1);
+    header.m_maxRowid = m_maxRowid;
+    header.m_entryPoint = m_entryPoint;
+    header.m_maxLevel = m_maxLevel;
+    header.m_scopeCount = m_scopes.size();
+    header.m_scopeTableBytes = scope_table.size();
+    const HnswFileLayout layout = compute_layout(header);
+
+    std::filesystem::path temp_path = path;
+    temp_path += ".tmp";
+    {
+      std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+      if (!out)
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "Failed to open {} for writing", temp_path.string());
+        return unexpected_internal_error();
+      }
+
+      size_t position = 0;
+      write_section(out, position, 0, &header, sizeof(header));
+      write_section(out, position, layout.m_vectors, m_vectors.data(), m_vectors.size() * sizeof(float));
+      write_section(out, position, layout.m_rowids, m_rowids.data(), m_rowids.size() * sizeof(int64_t));
+      write_section(out, position, layout.m_nodeScopes, m_nodeScopes.data(), m_nodeScopes.size() * sizeof(uint32_t));
+      write_section(out, position, layout.m_levels, m_levels.data(), m_levels.size() * sizeof(uint32_t));
+      write_section(out, position, layout.m_level0Links, m_level0Links.data(),
+                    m_level0Links.size() * sizeof(uint32_t));
+      write_section(out, position, layout.m_upperLinkOffsets, m_upperLinkOffsets.data(),
+                    m_upperLinkOffsets.size() * sizeof(uint32_t));
+      write_section(out, position, layout.m_upperLinks, m_upperLinks.data(), m_upperLinks.size() * sizeof(uint32_t));
+      write_section(out, position, layout.m_deleted, m_deleted.data(), m_deleted.size() * sizeof(uint64_t));
+      write_section(out, position, layout.m_scopeTable, scope_table.data(), scope_table.size());
+
+      out.close();
+      if (out.fail())
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "Failed to write HNSW index file {}", temp_path.string());
+        return unexpected_internal_error();
+      }
+    }
+
+    std::filesystem::rename(temp_path, path);
+  }
+  catch (const std::exception& e)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to save HNSW index file {}: {}", path.string(), e.what());
+    return unexpected_internal_error();
+  }
+
+  m_dirty = false;
+  return {};
+}
+
+OdaiResult<void> OdaiHnswIndex::add(int64_t vector_rowid, const ScopeId& scope_id, const std::vector<float>& embedding)
+{
+  if (embedding.size() != m_dimensions)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Vector has {} dimensions, HNSW index expects {}", embedding.size(), m_dimensions);
+    return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+  }
+  if (m_count > 0 && vector_rowid <= m_maxRowid)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Vector rowid {} is not greater than the indexed rowid {}", vector_rowid, m_maxRowid);
+    return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+  }
+  if (m_count + 1 >= NO_NODE)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "HNSW index is full");
+    return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+  }
+
+  materialize();
+
+  uint32_t scope_ordinal = 0;
+  auto scope_it = m_scopeOrdinalByName.find(scope_id);
+  if (scope_it == m_scopeOrdinalByName.end())
+  {
+    scope_ordinal = static_cast<uint32_t>(m_scopes.size());
+    m_scopeOrdinalByName.emplace(scope_id, scope_ordinal);
+    m_scopes.push_back(scope_id);
+    m_scopeSizes.push_back(0);
+  }
+  else
+  {
+    scope_ordinal = scope_it->second;
+  }
+
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  const auto level = static_cast<uint32_t>(
+      std::min<double>(std::floor(-std::log(1.0 - unit(m_levelGenerator)) * m_levelMultiplier), HNSW_MAX_LEVEL));
+
+  const auto node = static_cast<uint32_t>(m_count);
+  std::vector<float>& vectors = m_vectors.own();
+  vectors.insert(vectors.end(), embedding.begin(), embedding.end());
+  normalize(vectors.data() + static_cast<size_t>(node) * m_dimensions, m_dimensions);
+
+  m_rowids.own().push_back(vector_rowid);
+  m_nodeScopes.own().push_back(scope_ordinal);
+  m_levels.own().push_back(level);
+  std::vector<uint32_t>& level0_links = m_level0Links.own();
+  level0_links.resize(level0_links.size() + m_maxLinksLevel0 + 1, 0);
+  std::vector<uint32_t>& upper_links = m_upperLinks.own();
+  m_upperLinkOffsets.own().push_back(static_cast<uint32_t>(upper_links.size() / (m_maxLinks + 1)));
+  upper_links.resize(upper_links.size() + static_cast<size_t>(level) * (m_maxLinks + 1), 0);
+  m_deleted.own().resize(deleted_words(m_count + 1), 0);
+
+  ++m_count;
+  ++m_scopeSizes[scope_ordinal];
+  m_maxRowid = vector_rowid;
+  m_dirty = true;
+
+  if (m_entryPoint == NO_NODE)
+  {
+    m_entryPoint = node;
+    m_maxLevel = level;
+    return {};
+  }
+
+  const float* query = vector(node);
+  Candidate current{distance(query, vector(m_entryPoint)), m_entryPoint};
+  for (uint32_t lvl = m_maxLevel; lvl > level; --lvl)
+  {
+    current = greedy_closest(query, current, lvl);
+  }
+
+  for (uint32_t lvl = std::min(level, m_maxLevel) + 1; lvl-- > 0;)
+  {
+    const std::vector<Candidate> found = search_level(query, current, m_config.m_hnswEfConstruction, lvl, SCOPE_ANY);
+    const std::vector<uint32_t> neighbors = select_neighbors(found, m_maxLinks);
+
+    uint32_t* node_links = mutable_links(node, lvl);
+    node_links[0] = static_cast<uint32_t>(neighbors.size());
+    std::copy(neighbors.begin(), neighbors.end(), node_links + 1);
+    for (const uint32_t neighbor : neighbors)
+    {
+      connect(neighbor, node, lvl);
+    }
+
+    current = found.front();
+  }
+
+  if (level > m_maxLevel)
+  {
+    m_maxLevel = level;
+    m_entryPoint = node;
+  }
+
+  return {};
+}
+
+std::vector<OdaiHnswIndex::SearchHit> OdaiHnswIndex::search(const std::vector<float>& query, const ScopeId& scope_id,
+                                                            uint32_t k) const
+{
+  std::vector<SearchHit> hits;
+  if (size() == 0 || k == 0 || query.size() != m_dimensions)
+  {
+    return hits;
+  }
+
+  auto scope_it = m_scopeOrdinalByName.find(scope_id);
+  if (scope_it == m_scopeOrdinalByName.end())
+  {
+    return hits;
+  }
+
+  std::vector<float> normalized = query;
+  normalize(normalized.data(), normalized.size());
+
+  Candidate current{distance(normalized.data(), vector(m_entryPoint)), m_entryPoint};
+  for (uint32_t lvl = m_maxLevel; lvl > 0; --lvl)
+  {
+    current = greedy_closest(normalized.data(), current, lvl);
+  }
+
+  const std::vector<Candidate> found =
+      search_level(normalized.data(), current, std::max(m_config.m_hnswEfSearch, k), 0, scope_it->second);
+
+  const int64_t* rowids = m_rowids.data();
+  hits.reserve(std::min<size_t>(found.size(), k));
+  for (size_t i = 0; i < found.size() && i < k; ++i)
+  {
+    hits.push_back(SearchHit{rowids[found[i].second], found[i].first});
+  }
+  return hits;
+}
+
+bool OdaiHnswIndex::prefers_graph_search(const ScopeId& scope_id) const
+{
+  auto scope_it = m_scopeOrdinalByName.find(scope_id);
+  if (scope_it == m_scopeOrdinalByName.end())
+  {
+    return false;
+  }
+
+  const uint64_t scope_size = m_scopeSizes[scope_it->second];
+  return scope_size >= HNSW_MIN_GRAPH_SEARCH_VECTORS && scope_size * HNSW_MAX_SCOPE_DILUTION >= m_count;
+}
+
+bool OdaiHnswIndex::mark_deleted(int64_t vector_rowid)
+{
+  const uint32_t node = find_node(vector_rowid);
+  if (node == NO_NODE || is_deleted(node))
+  {
+    return false;
+  }
+  mark_node_deleted(node);
+  return true;
+}
+
+OdaiResult<size_t> OdaiHnswIndex::retain_only(const std::vector<int64_t>& vector_rowids)
+{
+  // both lists are ascending, one merge pass pairs them up
+  const int64_t* rowids = m_rowids.data();
+  size_t marked = 0;
+  size_t next = 0;
+  for (uint32_t node = 0; node < m_count; ++node)
+  {
+    if (next < vector_rowids.size() && vector_rowids[next] < rowids[node])
+    {
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+    const bool kept = next < vector_rowids.size() && vector_rowids[next] == rowids[node];
+    next += kept ? 1 : 0;
+    if (is_deleted(node))
+    {
+      if (kept)
+      {
+        return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+      }
+      continue;
+    }
+    if (!kept)
+    {
+      mark_node_deleted(node);
+      ++marked;
+    }
+  }
+  if (next < vector_rowids.size())
+  {
+    return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+  }
+  return marked;
+}
+
+bool OdaiHnswIndex::needs_rebuild() const
+{
+  return m_deletedCount * HNSW_MAX_DELETED_SHARE > m_count;
+}
+
+bool OdaiHnswIndex::has_consistent_graph(uint64_t upper_block_count) const
+{
+  if (m_count > 0 && (m_levels.data()[m_entryPoint] != m_maxLevel || m_rowids.data()[m_count - 1] != m_maxRowid))
+  {
+    return false;
+  }
+  // bits past the last node would count as deleted nodes that don't exist
+  if (m_count % 64 != 0 && (m_deleted.data()[m_count / 64] >> (m_count % 64)) != 0)
+  {
+    return false;
+  }
+
+  const int64_t* rowids = m_rowids.data();
+  const uint32_t* node_scopes = m_nodeScopes.data();
+  const uint32_t* levels = m_levels.data();
+  const uint32_t* upper_link_offsets = m_upperLinkOffsets.data();
+  std::vector<uint64_t> scope_sizes(m_scopes.size(), 0);
+  for (uint32_t node = 0; node < m_count; ++node)
+  {
+    if (node_scopes[node] >= m_scopes.size() || levels[node] > m_maxLevel ||
+        static_cast<uint64_t>(upper_link_offsets[node]) + levels[node] > upper_block_count ||
+        (node > 0 && rowids[node] <= rowids[node - 1]))
+    {
+      return false;
+    }
+    scope_sizes[node_scopes[node]] += is_deleted(node) ? 0 : 1;
+
+    // a walk on a level only follows links to nodes present on it, so their link lists of that level exist too
+    for (uint32_t level = 0; level <= levels[node]; ++level)
+    {
+      const uint32_t* node_links = links(node, level);
+      if (node_links[0] > max_links(level))
+      {
+        return false;
+      }
+      for (uint32_t i = 1; i <= node_links[0]; ++i)
+      {
+        if (node_links[i] >= m_count || levels[node_links[i]] < level)
+        {
+          return false;
+        }
+      }
+    }
+  }
+  return scope_sizes == m_scopeSizes;
+}
+
+const uint32_t* OdaiHnswIndex::links(uint32_t node, uint32_t level) const
+{
+  if (level == 0)
+  {
+    return m_level0Links.data() + static_cast<size_t>(node) * (m_maxLinksLevel0 + 1);
+  }
+  const size_t block = static_cast<size_t>(m_upperLinkOffsets.data()[node]) + level - 1;
+  return m_upperLinks.data() + block * (m_maxLinks + 1);
+}
+
+uint32_t* OdaiHnswIndex::mutable_links(uint32_t node, uint32_t level)
+{
+  if (level == 0)
+  {
+    return m_level0Links.own().data() + static_cast<size_t>(node) * (m_maxLinksLevel0 + 1);
+  }
+  const size_t block = static_cast<size_t>(m_upperLinkOffsets.data()[node]) + level - 1;
+  return m_upperLinks.own().data() + block * (m_maxLinks + 1);
+}
+
+uint32_t OdaiHnswIndex::find_node(int64_t vector_rowid) const
+{
+  const int64_t* rowids = m_rowids.data();
+  const int64_t* found = std::lower_bound(rowids, rowids + m_count, vector_rowid);
+  return found != rowids + m_count && *found == vector_rowid ? static_cast<uint32_t>(found - rowids) : NO_NODE;
+}
+
+void OdaiHnswIndex::mark_node_deleted(uint32_t node)
+{
+  m_deleted.own()[node / 64] |= uint64_t{1} << (node % 64);
+  --m_scopeSizes[m_nodeScopes.data()[node]];
+  ++m_deletedCount;
+  m_dirty = true;
+}
+
+float OdaiHnswIndex::distance(const float* a, const float* b) const
+{
+  // independent partial sums let the compiler vectorize the loop without reordering a single sum
+  float sum0 = 0.0F;
+  float sum1 = 0.0F;
+  float sum2 = 0.0F;
+  float sum3 = 0.0F;
+  size_t i = 0;
+  for (; i + 4 <= m_dimensions; i += 4)
+  {
+    sum0 += a[i] * b[i];
+    sum1 += a[i + 1] * b[i + 1];
+    sum2 += a[i + 2] * b[i + 2];
+    sum3 += a[i + 3] * b[i + 3];
+  }
+  for (; i < m_dimensions; ++i)
+  {
+    sum0 += a[i] * b[i];
+  }
+  return 1.0F - ((sum0 + sum1) + (sum2 + sum3));
+}
+
+void OdaiHnswIndex::materialize()
+{
+  if (m_mappedFile == nullptr)
+  {
+    return;
+  }
+
+  m_vectors.own();
+  m_rowids.own();
+  m_nodeScopes.own();
+  m_levels.own();
+  m_level0Links.own();
+  m_upperLinkOffsets.own();
+  m_upperLinks.own();
+  m_deleted.own();
+  m_mappedFile.reset();
+}
+
+OdaiHnswIndex::Candidate OdaiHnswIndex::greedy_closest(const float* query, Candidate entry, uint32_t level) const
+{
+  Candidate best = entry;
+  bool improved = true;
+  while (improved)
+  {
+    improved = false;
+    const uint32_t* node_links = links(best.second, level);
+    for (uint32_t i = 1; i <= node_links[0]; ++i)
+    {
+      const float dist = distance(query, vector(node_links[i]));
+      if (dist < best.first)
+      {
+        best = Candidate{dist, node_links[i]};
+        improved = true;
+      }
+    }
+  }
+  return best;
+}
+
+std::vector<OdaiHnswIndex::Candidate> OdaiHnswIndex::search_level(const float* query, Candidate entry, uint32_t ef,
+                                                                  uint32_t level, uint32_t scope_ordinal) const
+{
+  const uint32_t tag = next_visit_tag();
+  const uint32_t* node_scopes = m_nodeScopes.data();
+  auto collects = [&](uint32_t node)
+  { return scope_ordinal == SCOPE_ANY || (node_scopes[node] == scope_ordinal && !is_deleted(node)); };
+
+  // nodes still to expand, nearest on top
+  std::priority_queue<Candidate, std::vector<Candidate>, std::greater<>> to_expand;
+  // collected nodes, farthest on top
+  std::priority_queue<Candidate> collected;
+  float farthest_collected = std::numeric_limits<float>::max();
+
+  m_visitTags[entry.second] = tag;
+  to_expand.push(entry);
+  if (collects(entry.second))
+  {
+    collected.push(entry);
+    farthest_collected = entry.first;
+  }
+
+  while (!to_expand.empty())
+  {
+    const Candidate closest = to_expand.top();
+    if (closest.first > farthest_collected && collected.size() >= ef)
+    {
+      break;
+    }
+    to_expand.pop();
+
+    const uint32_t* node_links = links(closest.second, level);
+    for (uint32_t i = 1; i <= node_links[0]; ++i)
+    {
+      const uint32_t neighbor = node_links[i];
+      if (m_visitTags[neighbor] == tag)
+      {
+        continue;
+      }
+      m_visitTags[neighbor] = tag;
+
+      const float dist = distance(query, vector(neighbor));
+      // nodes of other scopes are still expanded, they connect the nodes of the requested scope
+      if (collected.size() < ef || dist < farthest_collected)
+      {
+        to_expand.push(Candidate{dist, neighbor});
+        if (collects(neighbor))
+        {
+          collected.push(Candidate{dist, neighbor});
+          if (collected.size() > ef)
+          {
+            collected.pop();
+          }
+          farthest_collected = collected.top().first;
+        }
+      }
+    }
+  }
+
+  std::vector<Candidate> nearest_first(collected.size());
+  for (size_t i = nearest_first.size(); i-- > 0;)
+  {
+    nearest_first[i] = collected.top();
+    collected.pop();
+  }
+  return nearest_first;
+}
+
+std::vector<uint32_t> OdaiHnswIndex::select_neighbors(const std::vector<Candidate>& sorted_candidates,
+                                                      size_t max_count) const
+{
+  std::vector<uint32_t> selected;
+  selected.reserve(max_count);
+  for (const Candidate& candidate : sorted_candidates)
+  {
+    if (selected.size() >= max_count)
+    {
+      break;
+    }
+
+    // skip candidates closer to an already selected neighbour than to the node, that neighbour already leads there
+    const float* candidate_vector = vector(candidate.second);
+    const bool diverse = std::none_of(selected.begin(), selected.end(), [&](uint32_t chosen)
+                                      { return distance(candidate_vector, vector(chosen)) < candidate.first; });
+    if (diverse)
+    {
+      selected.push_back(candidate.second);
+    }
+  }
+  return selected;
+}
+
+void OdaiHnswIndex::connect(uint32_t neighbor, uint32_t node, uint32_t level)
+{
+  uint32_t* neighbor_links = mutable_links(neighbor, level);
+  const uint32_t link_count = neighbor_links[0];
+  const uint32_t link_limit = max_links(level);
+  if (link_count < link_limit)
+  {
+    neighbor_links[link_count + 1] = node;
+    neighbor_links[0] = link_count + 1;
+    return;
+  }
+
+  const float* neighbor_vector = vector(neighbor);
+  std::vector<Candidate> candidates;
+  candidates.reserve(link_count + 1);
+  candidates.emplace_back(distance(neighbor_vector, vector(node)), node);
+  for (uint32_t i = 1; i <= link_count; ++i)
+  {
+    candidates.emplace_back(distance(neighbor_vector, vector(neighbor_links[i])), neighbor_links[i]);
+  }
+  std::sort(candidates.begin(), candidates.end());
+
+  const std::vector<uint32_t> kept = select_neighbors(candidates, link_limit);
+  neighbor_links[0] = static_cast<uint32_t>(kept.size());
+  std::copy(kept.begin(), kept.end(), neighbor_links + 1);
+}
+
+uint32_t OdaiHnswIndex::next_visit_tag() const
+{
+  if (m_visitTags.size() < m_count)
+  {
+    m_visitTags.resize(m_count, 0);
+  }
+  if (++m_visitTag == 0)
+  {
+    std::fill(m_visitTags.begin(), m_visitTags.end(), 0);
+    m_visitTag = 1;
+  }
+  return m_visitTag;
+}
@@ -1,10 +1,16 @@
 #include "db/odai_sqlite/odai_sqlite_db.h"
 #include "odai_sdk.h"
 
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
 #include <filesystem>
+#include <utility>
 #include <nlohmann/json.hpp>
 #include <sqlite3.h>
 
+#include "db/odai_vector_quantization.h"
 #include "types/odai_type_conversions.h"
 
 #include "types/odai_types.h"
@@ -28,12 +34,344 @@ OdaiResult<std::string> to_model_type_db_value(ModelType model_type)
   {
     return std::string{"EMBEDDING"};
   }
+  if (model_type == ModelType::RERANKER)
+  {
+    return std::string{"RERANKER"};
+  }
 
   return tl::unexpected(OdaiResultEnum::INVALID_ARGUMENT);
 }
+
+/// Largest k sqlite-vec accepts in a KNN query
+constexpr uint32_t SQLITE_VEC_MAX_KNN_K = 4096;
+
+/// How long a statement waits for another connection's write lock before failing with SQLITE_BUSY
+constexpr int SQLITE_BUSY_TIMEOUT_MS = 5000;
+
+/// PRAGMA application_id of a knowledge pack file, "ODKP"
+constexpr int64_t KNOWLEDGE_PACK_APPLICATION_ID = 0x4F444B50;
+/// PRAGMA user_version of a knowledge pack file, bumped whenever the pack layout or the schema it holds changes
+constexpr int64_t KNOWLEDGE_PACK_FORMAT_VERSION = 1;
+/// Internal id of the exported semantic space inside a knowledge pack
+constexpr int64_t KNOWLEDGE_PACK_SPACE_ID = 1;
+
+/// Name of a sqlite-vec table holding chunk vectors of a semantic space. A re-embedding job writes its vectors to the
+/// table of the space's next vector generation, generation 0 keeps the name of tables created before re-embedding.
+std::string vector_table_name(int64_t space_id, int64_t generation)
+{
+  std::string name = "vec_space_" + std::to_string(space_id);
+  if (generation > 0)
+  {
+    name += "_g" + std::to_string(generation);
+  }
+  return name;
+}
+
+/// Declaration of the vector table column holding the quantized copy of each vector, empty for float storage
+std::string coarse_column_definition(VectorStorageType storage_type, size_t dimensions)
+{
+  if (storage_type == VECTOR_STORAGE_INT8)
+  {
+    return ", embedding_coarse INT8[" + std::to_string(dimensions) + "] distance_metric=cosine";
+  }
+  if (storage_type == VECTOR_STORAGE_BINARY)
+  {
+    // bit vectors are compared by hamming distance, padding bits are zero in every vector
+    return ", embedding_coarse BIT[" + std::to_string(binary_quantized_bytes(dimensions) * 8) + "]";
+  }
+  return "";
+}
+
+/// Name of the sqlite-vec table holding the document vectors built from a chunk vector table
+std::string document_vector_table_name(const std::string& vector_table)
+{
+  return vector_table + "_docs";
+}
+
+/// Declarations of the metadata columns holding the values of a space's filter fields, empty without filter fields
+std::string filter_column_definitions(const std::vector<std::string>& filter_fields)
+{
+  std::string definitions;
+  for (const std::string& field : filter_fields)
+  {
+    definitions += ", filter_" + field + " TEXT";
+  }
+  return definitions;
+}
+
+/// Names of a space's filter columns and the parameters inserting their values, bound by bind_filter_values()
+std::pair<std::string, std::string> filter_column_inserts(const std::vector<std::string>& filter_fields)
+{
+  std::pair<std::string, std::string> inserts;
+  for (size_t i = 0; i < filter_fields.size(); ++i)
+  {
+    inserts.first += ", filter_" + filter_fields[i];
+    inserts.second += ", :filter_" + std::to_string(i);
+  }
+  return inserts;
+}
+
+/// Assignments of a space's filter columns to the parameters bound by bind_filter_values()
+std::string filter_column_updates(const std::vector<std::string>& filter_fields)
+{
+  std::string updates;
+  for (size_t i = 0; i < filter_fields.size(); ++i)
+  {
+    updates += (i == 0 ? "filter_" : ", filter_") + filter_fields[i] + " = :filter_" + std::to_string(i);
+  }
+  return updates;
+}
+
+void bind_filter_values(SQLite::Statement& statement, const std::vector<std::string>& filter_values)
+{
+  for (size_t i = 0; i < filter_values.size(); ++i)
+  {
+    statement.bind(":filter_" + std::to_string(i), filter_values[i]);
+  }
+}
+
+/// Values of a space's filter fields in a document's metadata, in field order. sqlite-vec text metadata columns can't
+/// hold NULL, so a missing field has an empty value.
+std::vector<std::string> document_filter_values(const std::vector<std::string>& filter_fields,
+                                                const DocumentMetadata& metadata)
+{
+  std::vector<std::string> values;
+  values.reserve(filter_fields.size());
+  for (const std::string& field : filter_fields)
+  {
+    auto it = metadata.find(field);
+    values.push_back(it != metadata.end() ? it->second : std::string());
+  }
+  return values;
+}
+
+/// filter_key of a document: the JSON array of its filter values, empty in a space without filter fields
+std::string make_filter_key(const std::vector<std::string>& filter_values)
+{
+  return filter_values.empty() ? std::string() : nlohmann::json(filter_values).dump();
+}
+
+/// Filter values of a filter_key, one per filter field of its space
+std::vector<std::string> parse_filter_key(const std::string& filter_key, size_t field_count)
+{
+  std::vector<std::string> values;
+  if (!filter_key.empty())
+  {
+    values = nlohmann::json::parse(filter_key).get<std::vector<std::string>>();
+  }
+  values.resize(field_count);
+  return values;
+}
+
+/// Constraints of a metadata filter on the filter columns of a vector table, bound by bind_metadata_filter(). Added to
+/// a KNN query, sqlite-vec checks them while scanning, before computing any distance.
+/// @param column_prefix Qualifies the filter columns, e.g. "v."
+/// @return the constraints, each starting with " AND ", or std::nullopt if the filter uses a field the space doesn't
+/// declare
+std::optional<std::string> metadata_filter_sql(const std::vector<std::string>& filter_fields,
+                                               const MetadataFilter& filter, const std::string& column_prefix)
+{
+  std::string sql;
+  for (size_t i = 0; i < filter.size(); ++i)
+  {
+    const MetadataFilterCondition& condition = filter[i];
+    if (condition.m_values.empty() ||
+        std::find(filter_fields.begin(), filter_fields.end(), condition.m_field) == filter_fields.end())
+    {
+      return std::nullopt;
+    }
+    sql += " AND " + column_prefix + "filter_" + condition.m_field + " IN (";
+    for (size_t j = 0; j < condition.m_values.size(); ++j)
+    {
+      sql += (j > 0 ? ", :mf_" : ":mf_") + std::to_string(i) + "_" + std::to_string(j);
+    }
+    sql += ")";
+  }
+  return sql;
+}
+
+void bind_metadata_filter(SQLite::Statement& statement, const MetadataFilter& filter)
+{
+  for (size_t i = 0; i < filter.size(); ++i)
+  {
+    for (size_t j = 0; j < filter[i].m_values.size(); ++j)
+    {
+      statement.bind(":mf_" + std::to_string(i) + "_" + std::to_string(j), filter[i].m_values[j]);
+    }
+  }
+}
+
+/// Statement creating a chunk vector table, see OdaiSqliteDb::create_vector_table()
+std::string create_vector_table_sql(const std::string& vector_table, size_t dimensions, VectorStorageType storage_type,
+                                    const std::vector<std::string>& filter_fields)
+{
+  return "CREATE VIRTUAL TABLE " + vector_table + " USING vec0(embedding FLOAT[" + std::to_string(dimensions) +
+         "] distance_metric=cosine" + coarse_column_definition(storage_type, dimensions) +
+         ", scope_id TEXT PARTITION KEY" + filter_column_definitions(filter_fields) + ")";
+}
+
+/// Statement creating the document vector table next to a chunk vector table. Document vectors are only compared with
+/// float query embeddings, so they are never quantized.
+std::string create_document_vector_table_sql(const std::string& vector_table, size_t dimensions,
+                                             const std::vector<std::string>& filter_fields)
+{
+  return "CREATE VIRTUAL TABLE " + document_vector_table_name(vector_table) + " USING vec0(embedding FLOAT[" +
+         std::to_string(dimensions) + "] distance_metric=cosine, scope_id TEXT PARTITION KEY" +
+         filter_column_definitions(filter_fields) + ")";
+}
+
+/// Statement inserting a document vector with its scope and filter values
+std::string insert_document_vector_sql(const std::string& vector_table, const std::vector<std::string>& filter_fields)
+{
+  const auto [columns, params] = filter_column_inserts(filter_fields);
+  return "INSERT INTO " + document_vector_table_name(vector_table) + " (rowid, embedding, scope_id" + columns +
+         ") VALUES (:rowid, :embedding, :scope_id" + params + ")";
+}
+
+/// Adds the L2-normalized vector to sum, sizing an empty sum to the vector. Zero vectors add nothing.
+void add_normalized(std::vector<float>& sum, const std::vector<float>& vector)
+{
+  if (sum.empty())
+  {
+    sum.assign(vector.size(), 0.0F);
+  }
+  if (vector.size() != sum.size())
+  {
+    return;
+  }
+
+  double norm = 0.0;
+  for (const float value : vector)
+  {
+    norm += static_cast<double>(value) * value;
+  }
+  if (norm == 0.0)
+  {
+    return;
+  }
+  const auto inverse_norm = static_cast<float>(1.0 / std::sqrt(norm));
+  for (size_t i = 0; i < vector.size(); ++i)
+  {
+    sum[i] += vector[i] * inverse_norm;
+  }
+}
+
+/// Wraps a quantized blob operand so sqlite-vec reads it with the storage type's element type instead of float32
+std::string coarse_vector_sql(VectorStorageType storage_type, const std::string& operand)
+{
+  return (storage_type == VECTOR_STORAGE_INT8 ? "vec_int8(" : "vec_bit(") + operand + ")";
+}
+
+/// Statement inserting a chunk vector with its quantized copy (quantized spaces only), scope and filter values
+std::string insert_vector_sql(const std::string& vector_table, VectorStorageType storage_type,
+                              const std::vector<std::string>& filter_fields)
+{
+  const bool quantized = storage_type != VECTOR_STORAGE_FLOAT32;
+  const auto [columns, params] = filter_column_inserts(filter_fields);
+  return "INSERT INTO " + vector_table + " (rowid, embedding" + (quantized ? ", embedding_coarse" : "") +
+         ", scope_id" + columns + ") VALUES (:rowid, :embedding" +
+         (quantized ? ", " + coarse_vector_sql(storage_type, ":coarse") : "") + ", :scope_id" + params + ")";
+}
+
+/// HNSW index file of a vector table, kept next to the database file
+std::filesystem::path vector_index_path(const std::string& db_path, const std::string& vector_table)
+{
+  return std::filesystem::path(db_path + "." + vector_table + ".hnsw");
+}
+
+/// SQLite URI opening a file read-only as immutable: SQLite takes no locks on it and never checks it for changes
+std::string immutable_file_uri(const std::string& path)
+{
+  static constexpr char HEX_DIGITS[] = "0123456789ABCDEF";
+  const std::string generic_path = std::filesystem::path(path).generic_string();
+  // a Windows drive letter needs a leading slash in a file URI
+  std::string uri = generic_path.size() > 1 && generic_path[1] == ':' ? "file:/" : "file:";
+  for (const char c : generic_path)
+  {
+    if (c == '%' || c == '?' || c == '#')
+    {
+      const auto byte = static_cast<unsigned char>(c);
+      uri += '%';
+      uri += HEX_DIGITS[byte >> 4U];
+      uri += HEX_DIGITS[byte & 0xFU];
+    }
+    else
+    {
+      uri += c;
+    }
+  }
+  return uri + "?immutable=1";
+}
+
+/// @note Throws SQLite::Exception on database errors.
+/// @return value of an integer PRAGMA of a database
+int64_t read_pragma(SQLite::Database& db, const std::string& pragma)
+{
+  SQLite::Statement query(db, "PRAGMA " + pragma);
+  return query.executeStep() ? query.getColumn(0).getInt64() : 0;
+}
+
+/// Joins resolving a chunk_vector_ref row `r` to its chunk `c` and to the first document `d` of the searched space and
+/// scope containing the chunk with the vector's filter values, at position `dr`. A chunk shared by several documents
+/// is returned once per vector.
+constexpr const char* CHUNK_SOURCE_JOINS =
+    "JOIN chunk c ON c.id = r.chunk_id "
+    "JOIN doc_chunk_ref dr ON dr.rowid = ("
+    "  SELECT dr2.rowid FROM doc_chunk_ref dr2 JOIN document d2 ON d2.id = dr2.doc_id "
+    "  WHERE dr2.chunk_id = c.id AND d2.space_id = :space_id AND d2.scope_id = :scope_id "
+    "  AND d2.filter_key = r.filter_key "
+    "  ORDER BY d2.created_at, dr2.doc_id, dr2.sequence_index LIMIT 1) "
+    "JOIN document d ON d.id = dr.doc_id ";
+
+/// Builds an FTS5 MATCH expression finding chunks containing any word of a free text query.
+/// Every whitespace separated word is quoted as an FTS5 string, so operators, column filters and punctuation in the
+/// query are never interpreted. Words without any letter or digit would match nothing and are dropped.
+/// @return the MATCH expression, empty if the query has no searchable word
+std::string build_keyword_match_expression(const std::string& query_text)
+{
+  std::string expression;
+  size_t pos = 0;
+  while (pos < query_text.size())
+  {
+    while (pos < query_text.size() && std::isspace(static_cast<unsigned char>(query_text[pos])) != 0)
+    {
+      ++pos;
+    }
+    const size_t word_start = pos;
+    bool searchable = false;
+    while (pos < query_text.size() && std::isspace(static_cast<unsigned char>(query_text[pos])) == 0)
+    {
+      const auto byte = static_cast<unsigned char>(query_text[pos]);
+      // bytes of multi byte UTF-8 characters are kept, the unicode61 tokenizer decides what they are
+      searchable = searchable || byte >= 0x80 || std::isalnum(byte) != 0;
+      ++pos;
+    }
+    if (!searchable)
+    {
+      continue;
+    }
+
+    if (!expression.empty())
+    {
+      expression += " OR ";
+    }
+    expression += '"';
+    for (size_t i = word_start; i < pos; ++i)
+    {
+      if (query_text[i] == '"')
+      {
+        expression += '"';
+      }
+      expression += query_text[i];
+    }
+    expression += '"';
+  }
+  return expression;
+}
 } // namespace
 
-OdaiSqliteDb::OdaiSqliteDb(const DBConfig& db_config) : IOdaiDb(db_config)
+OdaiSqliteDb::OdaiSqliteDb(const DBConfig& db_config, size_t statement_cache_capacity)
+    : IOdaiDb(db_config), m_statementCache(statement_cache_capacity)
 {
   if (db_config.m_dbType != SQLITE_DB)
   {
@@ -99,6 +437,10 @@ OdaiResult<void> OdaiSqliteDb::initialize_db()
     // create db object only after registering sqlite-vec extension
     m_db = std::make_unique<SQLite::Database>(m_dbConfig.m_dbPath, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
     m_db->exec("PRAGMA foreign_keys = ON");
+    // background re-embedding writes through a connection of its own: WAL lets other connections keep reading while it
+    // writes, and the busy timeout makes writers wait for each other instead of failing
+    m_db->exec("PRAGMA journal_mode = WAL");
+    m_db->setBusyTimeout(SQLITE_BUSY_TIMEOUT_MS);
 
     ODAI_LOG(ODAI_LOG_INFO, "Opened / created database successfully at {}", m_dbConfig.m_dbPath);
 
@@ -108,6 +450,8 @@ OdaiResult<void> OdaiSqliteDb::initialize_db()
       ODAI_LOG(ODAI_LOG_INFO, "initialized db with schema");
     }
 
+    attach_stored_knowledge_packs();
+
     return {};
   }
   catch (const std::exception& e)
@@ -130,8 +474,9 @@ OdaiResult<void> OdaiSqliteDb::begin_transaction()
     m_transactionDepth++;
     if (m_transactionDepth == 1)
     {
-      // Start the physical transaction
-      m_transaction = std::make_unique<SQLite::Transaction>(*m_db);
+      // Start the physical transaction. It takes the write lock upfront: a deferred transaction reading before it
+      // writes can't wait for another connection's write to finish, it fails with SQLITE_BUSY right away.
+      m_transaction = std::make_unique<SQLite::Transaction>(*m_db, SQLite::TransactionBehavior::IMMEDIATE);
     }
     return {};
   }
@@ -172,6 +517,7 @@ OdaiResult<void> OdaiSqliteDb::commit_transaction()
           m_transaction->commit();
           m_transaction.reset();
         }
+        sync_pending_vector_indexes();
       }
       return {};
     }
@@ -199,6 +545,8 @@ OdaiResult<void> OdaiSqliteDb::rollback_transaction()
 
     // Regardless of depth, we roll back everything
     // Destroying the Transaction object safely rolls it back if not committed
+    m_pendingIndexSpaces.clear();
+    m_pendingIndexRemovals.clear();
     m_transaction.reset();
     m_transactionDepth = 0;
     return {};
@@ -206,6 +554,8 @@ OdaiResult<void> OdaiSqliteDb::rollback_transaction()
   catch (const std::exception& e)
   {
     ODAI_LOG(ODAI_LOG_ERROR, "Failed to rollback transaction: {}", e.what());
+    m_pendingIndexSpaces.clear();
+    m_pendingIndexRemovals.clear();
     m_transactionDepth = 0;
     return unexpected_internal_error();
   }
@@ -277,12 +627,13 @@ OdaiResult<ModelFiles> OdaiSqliteDb::get_model_files(const ModelName& name)
       return unexpected_not_initialized();
     }
 
-    SQLite::Statement query(*m_db, "SELECT json(file_details) as file_details FROM models WHERE name = :name LIMIT 1");
-    query.bind(":name", name);
+    CachedStatement query =
+        cached_statement("SELECT json(file_details) as file_details FROM models WHERE name = :name LIMIT 1");
+    query->bind(":name", name);
 
-    if (query.executeStep())
+    if (query->executeStep())
     {
-      SQLite::Column file_details_col = query.getColumn("file_details");
+      SQLite::Column file_details_col = query->getColumn("file_details");
       nlohmann::json file_details_json = nlohmann::json::parse(file_details_col.getString());
       return file_details_json.get<ModelFiles>();
     }
@@ -307,12 +658,13 @@ OdaiResult<std::string> OdaiSqliteDb::get_model_checksums(const ModelName& name)
       return unexpected_not_initialized();
     }
 
-    SQLite::Statement query(*m_db, "SELECT json(checksums) as checksums FROM models WHERE name = :name LIMIT 1");
-    query.bind(":name", name);
+    CachedStatement query =
+        cached_statement("SELECT json(checksums) as checksums FROM models WHERE name = :name LIMIT 1");
+    query->bind(":name", name);
 
-    if (query.executeStep())
+    if (query->executeStep())
     {
-      return query.getColumn("checksums").getString();
+      return query->getColumn("checksums").getString();
     }
 
     ODAI_LOG(ODAI_LOG_ERROR, "Model checksums not found: {}", name);
@@ -475,17 +827,17 @@ OdaiResult<InputItem> OdaiSqliteDb::store_media_item(const InputItem& item)
       const std::string& checksum = checksum_res.value();
 
       // check in db if we already have a mapping for this checksum, if yes return that path instead of storing again
-      SQLite::Statement query(
-          *m_db, "SELECT mime_type, absolute_path FROM media_cache WHERE hash_xxhash = :hash_xxhash LIMIT 1");
-      query.bind(":hash_xxhash", checksum);
+      CachedStatement query =
+          cached_statement("SELECT mime_type, absolute_path FROM media_cache WHERE hash_xxhash = :hash_xxhash LIMIT 1");
+      query->bind(":hash_xxhash", checksum);
 
-      if (query.executeStep())
+      if (query->executeStep())
       {
-        std::string abs_path = query.getColumn("absolute_path").getString();
+        std::string abs_path = query->getColumn("absolute_path").getString();
         InputItem item_out;
         item_out.m_type = InputItemType::FILE_PATH;
         item_out.m_data = std::vector<uint8_t>(abs_path.begin(), abs_path.end());
-        item_out.m_mimeType = query.getColumn("mime_type").getString();
+        item_out.m_mimeType = query->getColumn("mime_type").getString();
         return item_out;
       }
 
@@ -524,14 +876,54 @@ OdaiResult<void> OdaiSqliteDb::create_semantic_space(const SemanticSpaceConfig&
       return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
     }
 
+    if (find_knowledge_pack(config.m_name) != nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Semantic space already exists as a knowledge pack: {}", config.m_name);
+      return tl::unexpected(OdaiResultEnum::ALREADY_EXISTS);
+    }
+
     nlohmann::json j = config;
     std::string config_json = j.dump();
 
-    SQLite::Statement insert(*m_db, "INSERT INTO semantic_spaces (name, config) VALUES (:name, jsonb(:config))");
-    insert.bind(":name", config.m_name);
-    insert.bind(":config", config_json);
+    OdaiResult<void> begin_res = begin_transaction();
+    if (!begin_res)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Failed to begin transaction for creating semantic space, error code: {}",
+               static_cast<std::uint32_t>(begin_res.error()));
+      return tl::unexpected(begin_res.error());
+    }
 
-    insert.exec();
+    try
+    {
+      SQLite::Statement insert(*m_db, "INSERT INTO semantic_spaces (name, config) VALUES (:name, jsonb(:config))");
+      insert.bind(":name", config.m_name);
+      insert.bind(":config", config_json);
+      insert.exec();
+
+      if (config.stored_dimensions() > 0)
+      {
+        create_vector_table(vector_table_name(m_db->getLastInsertRowid(), 0), config.stored_dimensions(),
+                            config.m_vectorIndexConfig.m_storageType, config.m_filterFields);
+      }
+
+      OdaiResult<void> commit_res = commit_transaction();
+      if (!commit_res)
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "Failed to commit transaction for creating semantic space, error code: {}",
+                 static_cast<std::uint32_t>(commit_res.error()));
+        return rollback_with_error(commit_res.error());
+      }
+    }
+    catch (...)
+    {
+      OdaiResult<void> rollback_res = rollback_transaction();
+      if (!rollback_res)
+      {
+        ODAI_LOG(ODAI_LOG_WARN, "Rollback during create_semantic_space exception path failed with error code: {}",
+                 static_cast<std::uint32_t>(rollback_res.error()));
+      }
+      throw; // Re-throw to be caught by outer catch
+    }
 
     return {};
   }
@@ -564,16 +956,27 @@ OdaiResult<SemanticSpaceConfig> OdaiSqliteDb::get_semantic_space_config(const Se
       return unexpected_not_initialized();
     }
 
-    SQLite::Statement query(*m_db, "SELECT json(config) as config FROM semantic_spaces WHERE name = :name LIMIT 1");
-    query.bind(":name", name);
+    if (AttachedKnowledgePack* pack = find_knowledge_pack(name))
+    {
+      OdaiResult<SemanticSpaceConfig> config_res = pack->m_db->get_semantic_space_config(pack->m_spaceName);
+      if (config_res)
+      {
+        config_res->m_name = name;
+      }
+      return config_res;
+    }
+
+    CachedStatement query =
+        cached_statement("SELECT json(config) as config FROM semantic_spaces WHERE name = :name LIMIT 1");
+    query->bind(":name", name);
 
-    if (!query.executeStep())
+    if (!query->executeStep())
     {
       ODAI_LOG(ODAI_LOG_ERROR, "Semantic space not found: {}", name);
       return tl::unexpected(OdaiResultEnum::NOT_FOUND);
     }
 
-    SQLite::Column config_col = query.getColumn("config");
+    SQLite::Column config_col = query->getColumn("config");
     nlohmann::json config_json = nlohmann::json::parse(config_col.getString());
     return config_json.get<SemanticSpaceConfig>();
   }
@@ -606,6 +1009,19 @@ OdaiResult<std::vector<SemanticSpaceConfig>> OdaiSqliteDb::list_semantic_spaces(
       spaces.push_back(config_json.get<SemanticSpaceConfig>());
     }
 
+    for (const auto& [name, pack] : m_knowledgePacks)
+    {
+      OdaiResult<SemanticSpaceConfig> config_res = pack.m_db->get_semantic_space_config(pack.m_spaceName);
+      if (!config_res)
+      {
+        return tl::unexpected(config_res.error());
+      }
+      config_res->m_name = name;
+      spaces.push_back(std::move(config_res.value()));
+    }
+    std::sort(spaces.begin(), spaces.end(),
+              [](const SemanticSpaceConfig& a, const SemanticSpaceConfig& b) { return a.m_name < b.m_name; });
+
     return spaces;
   }
   catch (const std::exception& e)
@@ -625,15 +1041,75 @@ OdaiResult<void> OdaiSqliteDb::delete_semantic_space(const SemanticSpaceName& na
       return unexpected_not_initialized();
     }
 
-    SQLite::Statement query(*m_db, "DELETE FROM semantic_spaces WHERE name = :name");
-    query.bind(":name", name);
+    auto pack_it = m_knowledgePacks.find(name);
+    if (pack_it != m_knowledgePacks.end())
+    {
+      // the pack file belongs to the app, detaching leaves it in place
+      SQLite::Statement query(*m_db, "DELETE FROM knowledge_pack WHERE name = :name");
+      query.bind(":name", name);
+      query.exec();
+      pack_it->second.m_db->close();
+      m_knowledgePacks.erase(pack_it);
+      ODAI_LOG(ODAI_LOG_INFO, "Detached knowledge pack of semantic space {}", name);
+      return {};
+    }
 
-    if (query.exec() == 0)
+    std::optional<int64_t> space_id = find_semantic_space_id(name);
+    if (!space_id.has_value())
     {
       ODAI_LOG(ODAI_LOG_ERROR, "Semantic space not found for deletion: {}", name);
       return tl::unexpected(OdaiResultEnum::NOT_FOUND);
     }
 
+    OdaiResult<void> begin_res = begin_transaction();
+    if (!begin_res)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Failed to begin transaction for deleting semantic space, error code: {}",
+               static_cast<std::uint32_t>(begin_res.error()));
+      return tl::unexpected(begin_res.error());
+    }
+
+    std::string vec_table;
+    try
+    {
+      const int64_t generation = get_vector_generation(space_id.value());
+      vec_table = vector_table_name(space_id.value(), generation);
+
+      SQLite::Statement query(*m_db, "DELETE FROM semantic_spaces WHERE id = :id");
+      query.bind(":id", space_id.value());
+      query.exec();
+
+      // the next generation's tables exist while the space is being re-embedded
+      for (const std::string& table : {vec_table, vector_table_name(space_id.value(), generation + 1)})
+      {
+        drop_vector_tables(table);
+      }
+
+      OdaiResult<void> commit_res = commit_transaction();
+      if (!commit_res)
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "Failed to commit transaction for deleting semantic space, error code: {}",
+                 static_cast<std::uint32_t>(commit_res.error()));
+        return rollback_with_error(commit_res.error());
+      }
+    }
+    catch (...)
+    {
+      OdaiResult<void> rollback_res = rollback_transaction();
+      if (!rollback_res)
+      {
+        ODAI_LOG(ODAI_LOG_WARN, "Rollback during delete_semantic_space exception path failed with error code: {}",
+                 static_cast<std::uint32_t>(rollback_res.error()));
+      }
+      throw; // Re-throw to be caught by outer catch
+    }
+
+    m_vectorIndexConfigs.erase(space_id.value());
+    m_filterFields.erase(space_id.value());
+    m_vectorIndexes.erase(space_id.value());
+    std::error_code ec;
+    std::filesystem::remove(vector_index_path(m_dbConfig.m_dbPath, vec_table), ec);
+
     return {};
   }
   catch (const std::exception& e)
@@ -643,44 +1119,2733 @@ OdaiResult<void> OdaiSqliteDb::delete_semantic_space(const SemanticSpaceName& na
   }
 }
 
-OdaiResult<bool> OdaiSqliteDb::chat_id_exists(const ChatId& chat_id)
+std::optional<int64_t> OdaiSqliteDb::find_semantic_space_id(const SemanticSpaceName& name)
+{
+  CachedStatement query = cached_statement("SELECT id FROM semantic_spaces WHERE name = :name LIMIT 1");
+  query->bind(":name", name);
+
+  if (!query->executeStep())
+  {
+    return std::nullopt;
+  }
+
+  return query->getColumn("id").getInt64();
+}
+
+OdaiSqliteDb::CachedStatement OdaiSqliteDb::cached_statement(const std::string& sql)
+{
+  return m_statementCache.borrow(*m_db, sql);
+}
+
+void OdaiSqliteDb::drop_vector_tables(const std::string& vec_table)
+{
+  m_statementCache.evict_containing(vec_table);
+  m_db->exec("DROP TABLE IF EXISTS " + vec_table);
+  m_db->exec("DROP TABLE IF EXISTS " + document_vector_table_name(vec_table));
+}
+
+OdaiSqliteDb::AttachedKnowledgePack* OdaiSqliteDb::find_knowledge_pack(const SemanticSpaceName& name)
+{
+  auto it = m_knowledgePacks.find(name);
+  return it != m_knowledgePacks.end() ? &it->second : nullptr;
+}
+
+OdaiResult<OdaiSqliteDb::AttachedKnowledgePack> OdaiSqliteDb::open_knowledge_pack(const std::string& pack_path)
 {
+  if (!std::filesystem::is_regular_file(pack_path))
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Knowledge pack not found: {}", pack_path);
+    return tl::unexpected(OdaiResultEnum::NOT_FOUND);
+  }
+
+  DBConfig pack_config = m_dbConfig;
+  pack_config.m_dbPath = pack_path;
+  AttachedKnowledgePack pack{std::make_unique<OdaiSqliteDb>(pack_config), {}};
+  SemanticSpaceConfig space_config;
   try
   {
-    if (m_db == nullptr)
+    pack.m_db->m_db = std::make_unique<SQLite::Database>(immutable_file_uri(pack_path),
+                                                         SQLite::OPEN_READONLY | SQLite::OPEN_URI);
+    SQLite::Database& db = *pack.m_db->m_db;
+    if (read_pragma(db, "application_id") != KNOWLEDGE_PACK_APPLICATION_ID ||
+        read_pragma(db, "user_version") != KNOWLEDGE_PACK_FORMAT_VERSION)
     {
-      ODAI_LOG(ODAI_LOG_ERROR, "Database not initialized");
-      return unexpected_not_initialized();
+      ODAI_LOG(ODAI_LOG_ERROR, "{} is not a version {} knowledge pack", pack_path, KNOWLEDGE_PACK_FORMAT_VERSION);
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
     }
 
-    // "SELECT 1" is enough. We limit to 1 so the DB stops searching immediately.
-    SQLite::Statement select_chat(*m_db, "SELECT 1 FROM chats WHERE chat_id = :chat_id LIMIT 1");
+    // the database pages end where an appended HNSW index starts. Mapping all of them lets queries read the pack
+    // through the OS page cache instead of copying pages into SQLite's own cache.
+    const auto image_size = static_cast<uint64_t>(read_pragma(db, "page_count") * read_pragma(db, "page_size"));
+    pack.m_db->m_knowledgePackIndexOffset = image_size;
+    db.exec("PRAGMA mmap_size = " + std::to_string(image_size));
 
-    // Bind the parameter, use named parameters instead of index based to avoid unexpected behaviour due to changes in
-    // future
-    select_chat.bind(":chat_id", chat_id);
-    return select_chat.executeStep();
+    SQLite::Statement space_query(db, "SELECT name, json(config) AS config FROM semantic_spaces WHERE id = :id");
+    space_query.bind(":id", KNOWLEDGE_PACK_SPACE_ID);
+    if (!space_query.executeStep())
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Knowledge pack {} holds no semantic space", pack_path);
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+    pack.m_spaceName = space_query.getColumn("name").getString();
+    space_config = nlohmann::json::parse(space_query.getColumn("config").getString()).get<SemanticSpaceConfig>();
   }
   catch (const SQLite::Exception& e)
   {
-    ODAI_LOG(ODAI_LOG_ERROR, "Check Exists SQLite Error for chat_id {}: {}", chat_id, e.what());
-    return unexpected_internal_error();
+    ODAI_LOG(ODAI_LOG_ERROR, "{} is not a knowledge pack, SQLite Error: {}", pack_path, e.what());
+    return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
   }
-  catch (const std::exception& e)
+
+  // the pack's vectors are only comparable with query embeddings of the same model files
+  const ModelName& model_name = space_config.m_embeddingModelConfig.m_modelName;
+  OdaiResult<std::string> checksums_res = get_model_checksums(model_name);
+  if (!checksums_res)
   {
-    ODAI_LOG(ODAI_LOG_ERROR, "Check Exists Error for chat_id {}: {}", chat_id, e.what());
-    return unexpected_internal_error();
+    ODAI_LOG(ODAI_LOG_ERROR, "Embedding model {} of knowledge pack {} isn't registered", model_name, pack_path);
+    return tl::unexpected(checksums_res.error());
+  }
+  OdaiResult<std::string> pack_checksums_res = pack.m_db->get_model_checksums(model_name);
+  if (!pack_checksums_res || pack_checksums_res.value() != checksums_res.value())
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Knowledge pack {} was embedded with other files of model {}", pack_path, model_name);
+    return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
   }
+
+  return pack;
 }
 
-OdaiResult<void> OdaiSqliteDb::create_chat(const ChatId& chat_id, const ChatConfig& chat_config)
+void OdaiSqliteDb::attach_stored_knowledge_packs()
 {
-  try
+  SQLite::Statement query(*m_db, "SELECT name, path FROM knowledge_pack");
+  while (query.executeStep())
   {
-    if (m_db == nullptr)
+    const SemanticSpaceName name = query.getColumn("name").getString();
+    const std::string path = query.getColumn("path").getString();
+    OdaiResult<AttachedKnowledgePack> pack_res = open_knowledge_pack(path);
+    if (!pack_res)
     {
-      ODAI_LOG(ODAI_LOG_ERROR, "Database not initialized");
-      return unexpected_not_initialized();
+      ODAI_LOG(ODAI_LOG_WARN, "Skipping knowledge pack {} of semantic space {}, error code: {}", path, name,
+               static_cast<std::uint32_t>(pack_res.error()));
+      continue;
+    }
+    m_knowledgePacks.insert_or_assign(name, std::move(pack_res.value()));
+  }
+}
+
+void OdaiSqliteDb::write_knowledge_pack(const std::string& pack_path, int64_t space_id,
+                                        const SemanticSpaceConfig& config, size_t dimensions)
+{
+  const std::string source_table = live_vector_table(space_id);
+  const std::string pack_table = vector_table_name(KNOWLEDGE_PACK_SPACE_ID, 0);
+  const std::string pack_space_id = std::to_string(KNOWLEDGE_PACK_SPACE_ID);
+
+  SQLite::Database pack(pack_path, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+  pack.exec(db_schema);
+  SQLite::Statement attach(pack, "ATTACH DATABASE :path AS source");
+  attach.bind(":path", m_dbConfig.m_dbPath);
+  attach.exec();
+
+  {
+    SQLite::Transaction transaction(pack);
+
+    // ids are kept, so vector rowids still match the space's HNSW index
+    const std::string space_documents = "SELECT id FROM source.document WHERE space_id = :space_id";
+    const std::vector<std::string> copies = {
+        "INSERT INTO semantic_spaces (id, name, config) SELECT " + pack_space_id +
+            ", name, config FROM source.semantic_spaces WHERE id = :space_id",
+        "INSERT INTO document (id, space_id, scope_id, source_uri, metadata, filter_key, created_at) SELECT id, " +
+            pack_space_id + ", scope_id, source_uri, metadata, filter_key, created_at FROM source.document "
+            "WHERE space_id = :space_id",
+        "INSERT INTO chunk (id, content_text, content_ref, metadata, content_hash, token_count) "
+        "SELECT id, content_text, content_ref, metadata, content_hash, token_count FROM source.chunk WHERE id IN ("
+        "SELECT chunk_id FROM source.doc_chunk_ref WHERE doc_id IN (" +
+            space_documents + ") UNION SELECT chunk_id FROM source.chunk_vector_ref WHERE space_id = :space_id)",
+        "INSERT INTO doc_chunk_ref (doc_id, chunk_id, sequence_index) SELECT doc_id, chunk_id, sequence_index "
+        "FROM source.doc_chunk_ref WHERE doc_id IN (" +
+            space_documents + ")",
+        "INSERT INTO chunk_vector_ref (vector_rowid, space_id, chunk_id, scope_id, filter_key) SELECT vector_rowid, " +
+            pack_space_id + ", chunk_id, scope_id, filter_key FROM source.chunk_vector_ref WHERE space_id = :space_id",
+        "INSERT INTO document_vector_ref (vector_rowid, doc_id) SELECT vector_rowid, doc_id "
+        "FROM source.document_vector_ref WHERE doc_id IN (" +
+            space_documents + ")"};
+    for (const std::string& sql : copies)
+    {
+      SQLite::Statement copy(pack, sql);
+      copy.bind(":space_id", space_id);
+      copy.exec();
+    }
+
+    // only the checksums are used, to check the importing device has the same model files
+    SQLite::Statement copy_model(pack, "INSERT INTO models (name, file_details, checksums, type, created_at) "
+                                       "SELECT name, file_details, checksums, type, created_at FROM source.models "
+                                       "WHERE name = :name");
+    copy_model.bind(":name", config.m_embeddingModelConfig.m_modelName);
+    copy_model.exec();
+
+    if (dimensions > 0)
+    {
+      const VectorStorageType storage_type = config.m_vectorIndexConfig.m_storageType;
+      const bool quantized = storage_type != VECTOR_STORAGE_FLOAT32;
+      const std::string filter_columns = filter_column_inserts(config.m_filterFields).first;
+      pack.exec(create_vector_table_sql(pack_table, dimensions, storage_type, config.m_filterFields));
+      pack.exec(create_document_vector_table_sql(pack_table, dimensions, config.m_filterFields));
+
+      // quantized vectors read back as plain blobs, which sqlite-vec would take for float32 vectors without the cast
+      pack.exec("INSERT INTO " + pack_table + " (rowid, embedding" + (quantized ? ", embedding_coarse" : "") +
+                ", scope_id" + filter_columns + ") SELECT rowid, embedding" +
+                (quantized ? ", " + coarse_vector_sql(storage_type, "embedding_coarse") : "") + ", scope_id" +
+                filter_columns + " FROM source." + source_table);
+      pack.exec("INSERT INTO " + document_vector_table_name(pack_table) + " (rowid, embedding, scope_id" +
+                filter_columns + ") SELECT rowid, embedding, scope_id" + filter_columns + " FROM source." +
+                document_vector_table_name(source_table));
+    }
+
+    pack.exec("INSERT INTO chunk_fts(chunk_fts) VALUES('rebuild')");
+    transaction.commit();
+  }
+
+  pack.exec("DETACH DATABASE source");
+  pack.exec("PRAGMA application_id = " + std::to_string(KNOWLEDGE_PACK_APPLICATION_ID));
+  pack.exec("PRAGMA user_version = " + std::to_string(KNOWLEDGE_PACK_FORMAT_VERSION));
+  // drops the free pages, the file then ends at page_count * page_size where the HNSW index gets appended
+  pack.exec("VACUUM");
+}
+
+OdaiResult<void> OdaiSqliteDb::export_knowledge_pack(const SemanticSpaceName& name, const std::string& pack_path,
+                                                     bool include_ann_index)
+{
+  try
+  {
+    if (m_db == nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Database not initialized");
+      return unexpected_not_initialized();
+    }
+
+    if (pack_path.empty())
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Empty knowledge pack path passed for semantic space: {}", name);
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+
+    if (find_knowledge_pack(name) != nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Semantic space {} is already a knowledge pack", name);
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+
+    std::optional<int64_t> space_id = find_semantic_space_id(name);
+    if (!space_id.has_value())
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Semantic space not found: {}", name);
+      return tl::unexpected(OdaiResultEnum::NOT_FOUND);
+    }
+
+    if (std::filesystem::exists(pack_path))
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Knowledge pack file already exists: {}", pack_path);
+      return tl::unexpected(OdaiResultEnum::ALREADY_EXISTS);
+    }
+
+    // the pack is written aside and renamed into place, a file already at the temporary path isn't ours to replace
+    const std::string temp_path = pack_path + ".tmp";
+    if (std::filesystem::exists(temp_path))
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Temporary knowledge pack file already exists: {}", temp_path);
+      return tl::unexpected(OdaiResultEnum::ALREADY_EXISTS);
+    }
+
+    OdaiResult<SemanticSpaceConfig> config_res = get_semantic_space_config(name);
+    if (!config_res)
+    {
+      return tl::unexpected(config_res.error());
+    }
+
+    const std::string vec_table = live_vector_table(space_id.value());
+    size_t dimensions = 0;
+    if (m_db->tableExists(vec_table))
+    {
+      SQLite::Statement dims_query(*m_db, "SELECT vec_length(embedding) AS dims FROM " + vec_table + " LIMIT 1");
+      dimensions = dims_query.executeStep() ? static_cast<size_t>(dims_query.getColumn("dims").getInt64())
+                                            : config_res->stored_dimensions();
+    }
+
+    // the index is synced with the committed vectors and saved next to the database, the pack gets a copy of the file
+    std::optional<std::filesystem::path> index_file;
+    if (include_ann_index)
+    {
+      OdaiHnswIndex* index = get_vector_index(space_id.value());
+      if (index != nullptr)
+      {
+        index_file = vector_index_path(m_dbConfig.m_dbPath, vec_table);
+        OdaiResult<void> save_res = index->save(index_file.value());
+        if (!save_res)
+        {
+          ODAI_LOG(ODAI_LOG_ERROR, "Failed to save HNSW index of {} for knowledge pack, error code: {}", vec_table,
+                   static_cast<std::uint32_t>(save_res.error()));
+          return tl::unexpected(save_res.error());
+        }
+      }
+    }
+
+    std::error_code ec;
+    try
+    {
+      write_knowledge_pack(temp_path, space_id.value(), config_res.value(), dimensions);
+      if (index_file.has_value())
+      {
+        std::ifstream index_in(index_file.value(), std::ios::binary);
+        std::ofstream pack_out(temp_path, std::ios::binary | std::ios::app);
+        pack_out << index_in.rdbuf();
+        pack_out.close();
+        if (!index_in || pack_out.fail())
+        {
+          throw std::runtime_error("failed to append HNSW index " + index_file->string());
+        }
+      }
+      std::filesystem::rename(temp_path, pack_path);
+    }
+    catch (...)
+    {
+      std::filesystem::remove(temp_path, ec);
+      throw; // Re-throw to be caught by outer catch
+    }
+
+    ODAI_LOG(ODAI_LOG_INFO, "Exported semantic space {} to knowledge pack {}{}", name, pack_path,
+             index_file.has_value() ? " with its HNSW index" : "");
+    return {};
+  }
+  catch (const std::exception& e)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to export semantic space {} to knowledge pack {}, Error: {}", name, pack_path,
+             e.what());
+    return unexpected_internal_error();
+  }
+}
+
+OdaiResult<SemanticSpaceConfig> OdaiSqliteDb::import_knowledge_pack(const std::string& pack_path,
+                                                                    const SemanticSpaceName& name)
+{
+  try
+  {
+    if (m_db == nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Database not initialized");
+      return unexpected_not_initialized();
+    }
+
+    if (pack_path.empty())
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Empty knowledge pack path passed");
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+
+    // the pack is attached again on every open, by a path that doesn't depend on the working directory
+    const std::string absolute_path = std::filesystem::absolute(pack_path).string();
+    OdaiResult<AttachedKnowledgePack> pack_res = open_knowledge_pack(absolute_path);
+    if (!pack_res)
+    {
+      return tl::unexpected(pack_res.error());
+    }
+    AttachedKnowledgePack& pack = pack_res.value();
+
+    const SemanticSpaceName space_name = name.empty() ? pack.m_spaceName : name;
+    if (find_knowledge_pack(space_name) != nullptr || find_semantic_space_id(space_name).has_value())
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Semantic space already exists: {}", space_name);
+      return tl::unexpected(OdaiResultEnum::ALREADY_EXISTS);
+    }
+
+    OdaiResult<SemanticSpaceConfig> config_res = pack.m_db->get_semantic_space_config(pack.m_spaceName);
+    if (!config_res)
+    {
+      return tl::unexpected(config_res.error());
+    }
+    config_res->m_name = space_name;
+
+    SQLite::Statement insert(*m_db, "INSERT INTO knowledge_pack (name, path) VALUES (:name, :path)");
+    insert.bind(":name", space_name);
+    insert.bind(":path", absolute_path);
+    insert.exec();
+    m_knowledgePacks.emplace(space_name, std::move(pack));
+
+    ODAI_LOG(ODAI_LOG_INFO, "Attached knowledge pack {} as semantic space {}", absolute_path, space_name);
+    return config_res.value();
+  }
+  catch (const std::exception& e)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to import knowledge pack {}, Error: {}", pack_path, e.what());
+    return unexpected_internal_error();
+  }
+}
+
+OdaiResult<std::unordered_set<uint64_t>>
+OdaiSqliteDb::get_unembedded_chunk_hashes(const SemanticSpaceName& semantic_space_name,
+                                          const std::vector<uint64_t>& content_hashes)
+{
+  try
+  {
+    if (m_db == nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Database not initialized");
+      return unexpected_not_initialized();
+    }
+
+    if (find_knowledge_pack(semantic_space_name) != nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Semantic space {} is a read-only knowledge pack", semantic_space_name);
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+
+    std::optional<int64_t> space_id = find_semantic_space_id(semantic_space_name);
+    if (!space_id.has_value())
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Semantic space not found: {}", semantic_space_name);
+      return tl::unexpected(OdaiResultEnum::NOT_FOUND);
+    }
+
+    std::unordered_set<uint64_t> unembedded_hashes;
+
+    // Prepare statement once, reuse for all hashes
+    CachedStatement query = cached_statement("SELECT 1 FROM chunk c JOIN chunk_vector_ref r ON r.chunk_id = c.id "
+                                             "WHERE c.content_hash = :content_hash AND r.space_id = :space_id LIMIT 1");
+
+    for (uint64_t content_hash : content_hashes)
+    {
+      query->bind(":content_hash", static_cast<int64_t>(content_hash));
+      query->bind(":space_id", space_id.value());
+
+      if (!query->executeStep())
+      {
+        unembedded_hashes.insert(content_hash);
+      }
+
+      query->reset();
+      query->clearBindings();
+    }
+
+    return unembedded_hashes;
+  }
+  catch (const std::exception& e)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to check embedded chunks for semantic space: {}, Error: {}", semantic_space_name,
+             e.what());
+    return unexpected_internal_error();
+  }
+}
+
+OdaiResult<std::unordered_map<uint64_t, std::vector<float>>>
+OdaiSqliteDb::get_stored_chunk_embeddings(const std::string& model_checksums,
+                                          const std::vector<uint64_t>& content_hashes)
+{
+  try
+  {
+    if (m_db == nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Database not initialized");
+      return unexpected_not_initialized();
+    }
+
+    std::unordered_map<uint64_t, std::vector<float>> embeddings;
+
+    CachedStatement query =
+        cached_statement("SELECT embedding FROM chunk_embedding "
+                         "WHERE content_hash = :content_hash AND model_checksums = :model_checksums");
+    for (uint64_t content_hash : content_hashes)
+    {
+      query->bind(":content_hash", static_cast<int64_t>(content_hash));
+      query->bind(":model_checksums", model_checksums);
+
+      if (query->executeStep())
+      {
+        const SQLite::Column embedding = query->getColumn("embedding");
+        std::vector<float>& stored = embeddings[content_hash];
+        stored.resize(static_cast<size_t>(embedding.getBytes()) / sizeof(float));
+        std::memcpy(stored.data(), embedding.getBlob(), stored.size() * sizeof(float));
+      }
+
+      query->reset();
+      query->clearBindings();
+    }
+
+    return embeddings;
+  }
+  catch (const std::exception& e)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to read stored chunk embeddings, Error: {}", e.what());
+    return unexpected_internal_error();
+  }
+}
+
+OdaiResult<void> OdaiSqliteDb::store_chunk_embeddings(const std::string& model_checksums,
+                                                      const std::vector<uint64_t>& content_hashes,
+                                                      const std::vector<std::vector<float>>& embeddings)
+{
+  try
+  {
+    if (m_db == nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Database not initialized");
+      return unexpected_not_initialized();
+    }
+
+    if (model_checksums.empty() || content_hashes.size() != embeddings.size() ||
+        std::ranges::any_of(embeddings, [](const std::vector<float>& embedding) { return embedding.empty(); }))
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Invalid chunk embeddings passed for storing");
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+
+    OdaiResult<void> begin_res = begin_transaction();
+    if (!begin_res)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Failed to begin transaction for storing chunk embeddings, error code: {}",
+               static_cast<std::uint32_t>(begin_res.error()));
+      return tl::unexpected(begin_res.error());
+    }
+
+    try
+    {
+      CachedStatement insert = cached_statement("INSERT OR IGNORE INTO chunk_embedding "
+                                                "(content_hash, model_checksums, embedding) "
+                                                "VALUES (:content_hash, :model_checksums, :embedding)");
+      for (size_t i = 0; i < content_hashes.size(); ++i)
+      {
+        insert->bind(":content_hash", static_cast<int64_t>(content_hashes[i]));
+        insert->bind(":model_checksums", model_checksums);
+        insert->bind(":embedding", embeddings[i].data(), static_cast<int>(embeddings[i].size() * sizeof(float)));
+        insert->exec();
+        insert->reset();
+        insert->clearBindings();
+      }
+
+      OdaiResult<void> commit_res = commit_transaction();
+      if (!commit_res)
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "Failed to commit transaction for storing chunk embeddings, error code: {}",
+                 static_cast<std::uint32_t>(commit_res.error()));
+        return rollback_with_error(commit_res.error());
+      }
+    }
+    catch (...)
+    {
+      OdaiResult<void> rollback_res = rollback_transaction();
+      if (!rollback_res)
+      {
+        ODAI_LOG(ODAI_LOG_WARN, "Rollback during store_chunk_embeddings exception path failed with error code: {}",
+                 static_cast<std::uint32_t>(rollback_res.error()));
+      }
+      throw;
+    }
+
+    return {};
+  }
+  catch (const std::exception& e)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to store chunk embeddings, Error: {}", e.what());
+    return unexpected_internal_error();
+  }
+}
+
+int64_t OdaiSqliteDb::get_vector_generation(int64_t space_id)
+{
+  CachedStatement query = cached_statement("SELECT vector_generation FROM semantic_spaces WHERE id = :id");
+  query->bind(":id", space_id);
+  if (!query->executeStep())
+  {
+    return 0;
+  }
+  return query->getColumn("vector_generation").getInt64();
+}
+
+std::string OdaiSqliteDb::live_vector_table(int64_t space_id)
+{
+  return vector_table_name(space_id, get_vector_generation(space_id));
+}
+
+void OdaiSqliteDb::create_vector_table(const std::string& vec_table, size_t dimensions,
+                                       VectorStorageType storage_type, const std::vector<std::string>& filter_fields)
+{
+  m_db->exec(create_vector_table_sql(vec_table, dimensions, storage_type, filter_fields));
+  m_db->exec(create_document_vector_table_sql(vec_table, dimensions, filter_fields));
+  ODAI_LOG(ODAI_LOG_INFO, "Created vector table {} with {} dimensions, storage type {}", vec_table, dimensions,
+           storage_type);
+}
+
+void OdaiSqliteDb::add_document_vector(int64_t space_id, const DocumentId& document_id, const ScopeId& scope_id,
+                                       const std::vector<std::string>& filter_values,
+                                       const std::vector<float>& chunk_vector_sum)
+{
+  const std::string vec_table = live_vector_table(space_id);
+  const std::string docs_table = document_vector_table_name(vec_table);
+  const std::vector<std::string>& filter_fields = get_filter_fields(space_id);
+
+  std::vector<float> document_vector = chunk_vector_sum;
+  CachedStatement select_ref = cached_statement("SELECT vector_rowid FROM document_vector_ref WHERE doc_id = :doc_id");
+  select_ref->bind(":doc_id", document_id);
+  if (select_ref->executeStep())
+  {
+    // appended chunks extend the sum of the chunks stored before
+    const int64_t vector_rowid = select_ref->getColumn("vector_rowid").getInt64();
+    CachedStatement select_vector = cached_statement("SELECT embedding FROM " + docs_table + " WHERE rowid = :rowid");
+    select_vector->bind(":rowid", vector_rowid);
+    if (select_vector->executeStep())
+    {
+      const SQLite::Column embedding = select_vector->getColumn("embedding");
+      if (static_cast<size_t>(embedding.getBytes()) == document_vector.size() * sizeof(float))
+      {
+        const auto* stored = static_cast<const float*>(embedding.getBlob());
+        for (size_t i = 0; i < document_vector.size(); ++i)
+        {
+          document_vector[i] += stored[i];
+        }
+      }
+    }
+
+    CachedStatement update =
+        cached_statement("UPDATE " + docs_table + " SET embedding = :embedding WHERE rowid = :rowid");
+    update->bind(":embedding", document_vector.data(), static_cast<int>(document_vector.size() * sizeof(float)));
+    update->bind(":rowid", vector_rowid);
+    update->exec();
+    return;
+  }
+
+  CachedStatement insert_ref = cached_statement("INSERT INTO document_vector_ref (doc_id) VALUES (:doc_id)");
+  insert_ref->bind(":doc_id", document_id);
+  insert_ref->exec();
+
+  CachedStatement insert = cached_statement(insert_document_vector_sql(vec_table, filter_fields));
+  insert->bind(":rowid", m_db->getLastInsertRowid());
+  insert->bind(":embedding", document_vector.data(), static_cast<int>(document_vector.size() * sizeof(float)));
+  insert->bind(":scope_id", scope_id);
+  bind_filter_values(*insert, filter_values);
+  insert->exec();
+}
+
+OdaiResult<void> OdaiSqliteDb::insert_document_chunks(int64_t space_id, const DocumentId& document_id,
+                                                      const ScopeId& scope_id, const std::vector<DocumentChunk>& chunks)
+{
+  size_t dimensions = 0;
+  for (const DocumentChunk& chunk : chunks)
+  {
+    if (chunk.m_embedding.empty())
+    {
+      continue;
+    }
+    if (dimensions == 0)
+    {
+      dimensions = chunk.m_embedding.size();
+    }
+    else if (chunk.m_embedding.size() != dimensions)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Chunk embeddings of document {} have mismatching dimensions", document_id);
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+  }
+
+  const VectorStorageType storage_type = get_vector_index_config(space_id).m_storageType;
+  const bool quantized = storage_type != VECTOR_STORAGE_FLOAT32;
+  const std::vector<std::string>& filter_fields = get_filter_fields(space_id);
+  const std::string vec_table = live_vector_table(space_id);
+  if (!m_db->tableExists(vec_table))
+  {
+    if (dimensions == 0)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "No embeddings passed and semantic space {} has no vectors to reuse", space_id);
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+
+    create_vector_table(vec_table, dimensions, storage_type, filter_fields);
+  }
+
+  // vectors carry the filter values of the documents they serve
+  std::string filter_key;
+  CachedStatement select_filter_key = cached_statement("SELECT filter_key FROM document WHERE id = :id");
+  select_filter_key->bind(":id", document_id);
+  if (select_filter_key->executeStep())
+  {
+    filter_key = select_filter_key->getColumn("filter_key").getString();
+  }
+  const std::vector<std::string> filter_values = parse_filter_key(filter_key, filter_fields.size());
+
+  // Statements are prepared once per connection and reused for all chunks
+  CachedStatement select_chunk =
+      cached_statement("SELECT id, token_count FROM chunk WHERE content_hash = :content_hash LIMIT 1");
+  CachedStatement insert_chunk = cached_statement("INSERT INTO chunk (content_text, content_hash, token_count) "
+                                                  "VALUES (:content_text, :content_hash, :token_count)");
+  // chunk_fts doesn't store the text, it only indexes the rowid it is given
+  CachedStatement insert_chunk_fts =
+      cached_statement("INSERT INTO chunk_fts (rowid, content_text) VALUES (:id, :content_text)");
+  CachedStatement update_token_count = cached_statement("UPDATE chunk SET token_count = :token_count WHERE id = :id");
+  CachedStatement insert_ref = cached_statement("INSERT INTO doc_chunk_ref (doc_id, chunk_id, sequence_index) "
+                                                "VALUES (:doc_id, :chunk_id, :sequence_index)");
+  CachedStatement select_vector_ref =
+      cached_statement("SELECT vector_rowid, scope_id, filter_key FROM chunk_vector_ref "
+                       "WHERE space_id = :space_id AND chunk_id = :chunk_id");
+  CachedStatement insert_vector_ref =
+      cached_statement("INSERT INTO chunk_vector_ref (space_id, chunk_id, scope_id, filter_key) "
+                       "VALUES (:space_id, :chunk_id, :scope_id, :filter_key)");
+  // quantized spaces store a quantized copy next to each float vector
+  CachedStatement insert_vector = cached_statement(insert_vector_sql(vec_table, storage_type, filter_fields));
+  // reused vectors are read and inserted again rather than copied with INSERT ... SELECT: selecting from the table
+  // being inserted into materializes the rows first, which drops the int8/bit subtype of the quantized copy
+  CachedStatement select_source_vector = cached_statement(
+      "SELECT embedding" + std::string(quantized ? ", embedding_coarse" : "") + " FROM " + vec_table +
+      " WHERE rowid = :source_rowid");
+
+  // sum of the chunks' normalized vectors, the document vector is their mean direction
+  std::vector<float> document_vector_sum;
+  CachedStatement select_vector = cached_statement("SELECT embedding FROM " + vec_table + " WHERE rowid = :rowid");
+  std::vector<float> stored_vector;
+  auto add_to_document_vector = [&](const DocumentChunk& chunk, int64_t vector_rowid)
+  {
+    const std::vector<float>* vector = &chunk.m_embedding;
+    if (chunk.m_embedding.empty())
+    {
+      select_vector->bind(":rowid", vector_rowid);
+      if (select_vector->executeStep())
+      {
+        const SQLite::Column embedding = select_vector->getColumn("embedding");
+        stored_vector.resize(static_cast<size_t>(embedding.getBytes()) / sizeof(float));
+        std::memcpy(stored_vector.data(), embedding.getBlob(), stored_vector.size() * sizeof(float));
+      }
+      select_vector->reset();
+      select_vector->clearBindings();
+      vector = &stored_vector;
+    }
+    add_normalized(document_vector_sum, *vector);
+  };
+
+  for (const DocumentChunk& chunk : chunks)
+  {
+    const auto content_hash = static_cast<int64_t>(chunk.m_contentHash);
+
+    int64_t chunk_id = 0;
+    select_chunk->bind(":content_hash", content_hash);
+    if (select_chunk->executeStep())
+    {
+      chunk_id = select_chunk->getColumn("id").getInt64();
+      // content stored by a strategy that didn't count tokens gets the count of the first one that does
+      if (chunk.m_tokenCount > 0 && select_chunk->getColumn("token_count").isNull())
+      {
+        update_token_count->bind(":token_count", static_cast<int64_t>(chunk.m_tokenCount));
+        update_token_count->bind(":id", chunk_id);
+        update_token_count->exec();
+        update_token_count->reset();
+        update_token_count->clearBindings();
+      }
+    }
+    else
+    {
+      insert_chunk->bind(":content_text", chunk.m_contentText);
+      insert_chunk->bind(":content_hash", content_hash);
+      if (chunk.m_tokenCount > 0)
+      {
+        insert_chunk->bind(":token_count", static_cast<int64_t>(chunk.m_tokenCount));
+      }
+      insert_chunk->exec();
+      insert_chunk->reset();
+      insert_chunk->clearBindings();
+      chunk_id = m_db->getLastInsertRowid();
+
+      insert_chunk_fts->bind(":id", chunk_id);
+      insert_chunk_fts->bind(":content_text", chunk.m_contentText);
+      insert_chunk_fts->exec();
+      insert_chunk_fts->reset();
+      insert_chunk_fts->clearBindings();
+    }
+    select_chunk->reset();
+    select_chunk->clearBindings();
+
+    insert_ref->bind(":doc_id", document_id);
+    insert_ref->bind(":chunk_id", chunk_id);
+    insert_ref->bind(":sequence_index", static_cast<int64_t>(chunk.m_sequenceIndex));
+    insert_ref->exec();
+    insert_ref->reset();
+    insert_ref->clearBindings();
+
+    // find whether this content already has a vector in this scope with these filter values, or one elsewhere we
+    // can copy
+    std::optional<int64_t> scope_vector_rowid;
+    std::optional<int64_t> reusable_vector_rowid;
+    select_vector_ref->bind(":space_id", space_id);
+    select_vector_ref->bind(":chunk_id", chunk_id);
+    while (select_vector_ref->executeStep())
+    {
+      if (select_vector_ref->getColumn("scope_id").getString() == scope_id &&
+          select_vector_ref->getColumn("filter_key").getString() == filter_key)
+      {
+        scope_vector_rowid = select_vector_ref->getColumn("vector_rowid").getInt64();
+        break;
+      }
+      reusable_vector_rowid = select_vector_ref->getColumn("vector_rowid").getInt64();
+    }
+    select_vector_ref->reset();
+    select_vector_ref->clearBindings();
+
+    if (scope_vector_rowid.has_value())
+    {
+      add_to_document_vector(chunk, scope_vector_rowid.value());
+      continue;
+    }
+
+    if (chunk.m_embedding.empty() && !reusable_vector_rowid.has_value())
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Chunk {} of document {} has no embedding and none can be reused",
+               chunk.m_sequenceIndex, document_id);
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+
+    insert_vector_ref->bind(":space_id", space_id);
+    insert_vector_ref->bind(":chunk_id", chunk_id);
+    insert_vector_ref->bind(":scope_id", scope_id);
+    insert_vector_ref->bind(":filter_key", filter_key);
+    insert_vector_ref->exec();
+    insert_vector_ref->reset();
+    insert_vector_ref->clearBindings();
+    const int64_t vector_rowid = m_db->getLastInsertRowid();
+
+    insert_vector->bind(":rowid", vector_rowid);
+    insert_vector->bind(":scope_id", scope_id);
+    bind_filter_values(*insert_vector, filter_values);
+    if (!chunk.m_embedding.empty())
+    {
+      insert_vector->bind(":embedding", chunk.m_embedding.data(),
+                         static_cast<int>(chunk.m_embedding.size() * sizeof(float)));
+      if (quantized)
+      {
+        const std::vector<uint8_t> coarse = quantize_vector(chunk.m_embedding, storage_type);
+        insert_vector->bind(":coarse", coarse.data(), static_cast<int>(coarse.size()));
+      }
+    }
+    else
+    {
+      select_source_vector->bind(":source_rowid", reusable_vector_rowid.value());
+      if (!select_source_vector->executeStep())
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "Vector {} referenced by chunk_vector_ref is missing from {}",
+                 reusable_vector_rowid.value(), vec_table);
+        return unexpected_internal_error();
+      }
+      // blobs are bound as transient copies, so the source row can be released before inserting
+      const SQLite::Column embedding = select_source_vector->getColumn("embedding");
+      insert_vector->bind(":embedding", embedding.getBlob(), embedding.getBytes());
+      if (quantized)
+      {
+        const SQLite::Column coarse = select_source_vector->getColumn("embedding_coarse");
+        insert_vector->bind(":coarse", coarse.getBlob(), coarse.getBytes());
+      }
+      select_source_vector->reset();
+      select_source_vector->clearBindings();
+    }
+    insert_vector->exec();
+    insert_vector->reset();
+    insert_vector->clearBindings();
+    add_to_document_vector(chunk, vector_rowid);
+  }
+
+  if (!document_vector_sum.empty())
+  {
+    add_document_vector(space_id, document_id, scope_id, filter_values, document_vector_sum);
+  }
+
+  if (get_vector_index_config(space_id).m_indexType == VECTOR_INDEX_HNSW)
+  {
+    m_pendingIndexSpaces.insert(space_id);
+  }
+
+  return {};
+}
+
+const VectorIndexConfig& OdaiSqliteDb::get_vector_index_config(int64_t space_id)
+{
+  auto it = m_vectorIndexConfigs.find(space_id);
+  if (it != m_vectorIndexConfigs.end())
+  {
+    return it->second;
+  }
+
+  VectorIndexConfig config{};
+  SQLite::Statement query(*m_db, "SELECT json(config) AS config FROM semantic_spaces WHERE id = :id LIMIT 1");
+  query.bind(":id", space_id);
+  if (query.executeStep())
+  {
+    nlohmann::json config_json = nlohmann::json::parse(query.getColumn("config").getString());
+    config = config_json.get<SemanticSpaceConfig>().m_vectorIndexConfig;
+  }
+
+  return m_vectorIndexConfigs.emplace(space_id, config).first->second;
+}
+
+const std::vector<std::string>& OdaiSqliteDb::get_filter_fields(int64_t space_id)
+{
+  auto it = m_filterFields.find(space_id);
+  if (it != m_filterFields.end())
+  {
+    return it->second;
+  }
+
+  std::vector<std::string> filter_fields;
+  SQLite::Statement query(*m_db, "SELECT json(config) AS config FROM semantic_spaces WHERE id = :id LIMIT 1");
+  query.bind(":id", space_id);
+  if (query.executeStep())
+  {
+    nlohmann::json config_json = nlohmann::json::parse(query.getColumn("config").getString());
+    filter_fields = config_json.get<SemanticSpaceConfig>().m_filterFields;
+  }
+
+  return m_filterFields.emplace(space_id, std::move(filter_fields)).first->second;
+}
+
+OdaiHnswIndex* OdaiSqliteDb::get_vector_index(int64_t space_id)
+{
+  // rowids of uncommitted vectors are reused if the transaction rolls back, so only committed vectors get indexed
+  if (m_transactionDepth > 0)
+  {
+    return nullptr;
+  }
+
+  const VectorIndexConfig& config = get_vector_index_config(space_id);
+  if (config.m_indexType != VECTOR_INDEX_HNSW)
+  {
+    return nullptr;
+  }
+
+  const std::string vec_table = live_vector_table(space_id);
+  // a knowledge pack carries its index after its database pages
+  const std::filesystem::path index_path = m_knowledgePackIndexOffset.has_value()
+                                               ? std::filesystem::path(m_dbConfig.m_dbPath)
+                                               : vector_index_path(m_dbConfig.m_dbPath, vec_table);
+
+  auto it = m_vectorIndexes.find(space_id);
+  if (it != m_vectorIndexes.end() && it->second.m_vectorTable != vec_table)
+  {
+    // a re-embedding job finished since the index was built, possibly through another connection
+    m_vectorIndexes.erase(it);
+    it = m_vectorIndexes.end();
+  }
+  if (it == m_vectorIndexes.end())
+  {
+    if (!m_db->tableExists(vec_table))
+    {
+      return nullptr;
+    }
+
+    SQLite::Statement dims_query(*m_db, "SELECT vec_length(embedding) AS dims FROM " + vec_table + " LIMIT 1");
+    if (!dims_query.executeStep())
+    {
+      return nullptr;
+    }
+    const auto dimensions = static_cast<uint32_t>(dims_query.getColumn("dims").getInt64());
+
+    std::unique_ptr<OdaiHnswIndex> index;
+    OdaiResult<std::unique_ptr<OdaiHnswIndex>> load_res =
+        OdaiHnswIndex::load(index_path, config, m_knowledgePackIndexOffset.value_or(0));
+    if (load_res && load_res.value()->dimensions() == dimensions)
+    {
+      // the saved index must hold every vector stored up to its last rowid, otherwise it belongs to another state of
+      // the database (e.g. a restored backup) and is rebuilt. Vectors removed since it was saved, e.g. by another
+      // connection, are marked deleted.
+      CachedStatement stored_query = cached_statement("SELECT vector_rowid FROM chunk_vector_ref WHERE space_id = "
+                                                      ":space_id AND vector_rowid <= :max_rowid ORDER BY vector_rowid");
+      stored_query->bind(":space_id", space_id);
+      stored_query->bind(":max_rowid", load_res.value()->max_rowid());
+      std::vector<int64_t> stored_rowids;
+      while (stored_query->executeStep())
+      {
+        stored_rowids.push_back(stored_query->getColumn("vector_rowid").getInt64());
+      }
+      if (load_res.value()->retain_only(stored_rowids).has_value())
+      {
+        index = std::move(load_res.value());
+      }
+    }
+
+    if (index == nullptr)
+    {
+      if (load_res || load_res.error() != OdaiResultEnum::NOT_FOUND)
+      {
+        ODAI_LOG(ODAI_LOG_WARN, "HNSW index {} doesn't match {}, rebuilding it", index_path.string(), vec_table);
+      }
+      index = std::make_unique<OdaiHnswIndex>(dimensions, config);
+    }
+
+    it = m_vectorIndexes.emplace(space_id, LoadedVectorIndex{vec_table, std::move(index)}).first;
+  }
+
+  OdaiHnswIndex* index = it->second.m_index.get();
+
+  // chunk_vector_ref rowids only grow, so vectors committed since the last sync are the ones past max_rowid
+  CachedStatement new_vectors = cached_statement("SELECT r.vector_rowid AS vector_rowid, r.scope_id AS scope_id, "
+                                                 "v.embedding AS embedding FROM chunk_vector_ref r "
+                                                 "JOIN " + vec_table + " v ON v.rowid = r.vector_rowid "
+                                                 "WHERE r.space_id = :space_id AND r.vector_rowid > :max_rowid "
+                                                 "ORDER BY r.vector_rowid");
+  new_vectors->bind(":space_id", space_id);
+  new_vectors->bind(":max_rowid", index->max_rowid());
+
+  size_t added = 0;
+  std::vector<float> embedding(index->dimensions());
+  while (new_vectors->executeStep())
+  {
+    SQLite::Column embedding_col = new_vectors->getColumn("embedding");
+    if (static_cast<size_t>(embedding_col.getBytes()) != embedding.size() * sizeof(float))
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Vector of {} doesn't match the HNSW index dimension", vec_table);
+      m_vectorIndexes.erase(it);
+      return nullptr;
+    }
+    std::memcpy(embedding.data(), embedding_col.getBlob(), embedding.size() * sizeof(float));
+
+    OdaiResult<void> add_res = index->add(new_vectors->getColumn("vector_rowid").getInt64(),
+                                          new_vectors->getColumn("scope_id").getString(), embedding);
+    if (!add_res)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Failed to insert into HNSW index of {}, error code: {}", vec_table,
+               static_cast<std::uint32_t>(add_res.error()));
+      m_vectorIndexes.erase(it);
+      return nullptr;
+    }
+    ++added;
+  }
+
+  if (added > 0)
+  {
+    ODAI_LOG(ODAI_LOG_DEBUG, "Inserted {} vectors into HNSW index of {}, {} indexed", added, vec_table, index->size());
+  }
+
+  return index;
+}
+
+void OdaiSqliteDb::sync_pending_vector_indexes()
+{
+  std::unordered_set<int64_t> space_ids;
+  space_ids.swap(m_pendingIndexSpaces);
+  std::unordered_map<int64_t, std::vector<int64_t>> removals;
+  removals.swap(m_pendingIndexRemovals);
+
+  for (int64_t space_id : space_ids)
+  {
+    try
+    {
+      // a loaded index marks the removed vectors, one loaded from its file below catches up by itself
+      auto removed_it = removals.find(space_id);
+      auto index_it = m_vectorIndexes.find(space_id);
+      if (removed_it != removals.end() && index_it != m_vectorIndexes.end())
+      {
+        for (int64_t vector_rowid : removed_it->second)
+        {
+          index_it->second.m_index->mark_deleted(vector_rowid);
+        }
+      }
+
+      OdaiHnswIndex* index = get_vector_index(space_id);
+      if (index == nullptr)
+      {
+        ODAI_LOG(ODAI_LOG_WARN, "HNSW index of semantic space {} not synced, it is rebuilt on next use", space_id);
+      }
+      else if (removed_it != removals.end() && index->needs_rebuild())
+      {
+        rebuild_vector_index(space_id);
+      }
+    }
+    catch (const std::exception& e)
+    {
+      ODAI_LOG(ODAI_LOG_WARN, "Failed to sync HNSW index of semantic space {}, Error: {}", space_id, e.what());
+      m_vectorIndexes.erase(space_id);
+    }
+  }
+}
+
+OdaiResult<void> OdaiSqliteDb::add_document(const DocumentId& document_id, const std::string& source_uri,
+                                            const SemanticSpaceName& semantic_space_name, const ScopeId& scope_id,
+                                            const std::vector<DocumentChunk>& chunks, const DocumentMetadata& metadata)
+{
+  try
+  {
+    if (m_db == nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Database not initialized");
+      return unexpected_not_initialized();
+    }
+
+    if (document_id.empty() || scope_id.empty() || chunks.empty())
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Invalid document passed for insertion");
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+
+    if (find_knowledge_pack(semantic_space_name) != nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Semantic space {} is a read-only knowledge pack", semantic_space_name);
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+
+    OdaiResult<void> begin_res = begin_transaction();
+    if (!begin_res)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Failed to begin transaction for adding document, error code: {}",
+               static_cast<std::uint32_t>(begin_res.error()));
+      return tl::unexpected(begin_res.error());
+    }
+
+    try
+    {
+      std::optional<int64_t> space_id = find_semantic_space_id(semantic_space_name);
+      if (!space_id.has_value())
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "Semantic space not found: {}", semantic_space_name);
+        return rollback_with_error(OdaiResultEnum::NOT_FOUND);
+      }
+
+      CachedStatement insert_document =
+          cached_statement("INSERT INTO document "
+                           "(id, space_id, scope_id, source_uri, metadata, filter_key) VALUES "
+                           "(:id, :space_id, :scope_id, :source_uri, :metadata, :filter_key)");
+      insert_document->bind(":id", document_id);
+      insert_document->bind(":space_id", space_id.value());
+      insert_document->bind(":scope_id", scope_id);
+      insert_document->bind(":source_uri", source_uri);
+      if (!metadata.empty())
+      {
+        insert_document->bind(":metadata", nlohmann::json(metadata).dump());
+      }
+      insert_document->bind(":filter_key",
+                            make_filter_key(document_filter_values(get_filter_fields(space_id.value()), metadata)));
+      insert_document->exec();
+
+      OdaiResult<void> insert_res = insert_document_chunks(space_id.value(), document_id, scope_id, chunks);
+      if (!insert_res)
+      {
+        return rollback_with_error(insert_res.error());
+      }
+
+      OdaiResult<void> commit_res = commit_transaction();
+      if (!commit_res)
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "Failed to commit transaction for adding document, error code: {}",
+                 static_cast<std::uint32_t>(commit_res.error()));
+        return rollback_with_error(commit_res.error());
+      }
+    }
+    catch (...)
+    {
+      OdaiResult<void> rollback_res = rollback_transaction();
+      if (!rollback_res)
+      {
+        ODAI_LOG(ODAI_LOG_WARN, "Rollback during add_document exception path failed with error code: {}",
+                 static_cast<std::uint32_t>(rollback_res.error()));
+      }
+      throw; // Re-throw to be caught by outer catch
+    }
+
+    ODAI_LOG(ODAI_LOG_DEBUG, "Added document {} with {} chunks to semantic space {}", document_id, chunks.size(),
+             semantic_space_name);
+    return {};
+  }
+  catch (const SQLite::Exception& e)
+  {
+    int ext_code = e.getExtendedErrorCode();
+    if (ext_code == SQLITE_CONSTRAINT_PRIMARYKEY || ext_code == SQLITE_CONSTRAINT_UNIQUE)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Document already exists: {}, SQLite Error: {}", document_id, e.what());
+      return tl::unexpected(OdaiResultEnum::ALREADY_EXISTS);
+    }
+
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to add document: {}, SQLite Error: {}", document_id, e.what());
+    return unexpected_internal_error();
+  }
+  catch (const std::exception& e)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to add document: {}, Error: {}", document_id, e.what());
+    return unexpected_internal_error();
+  }
+}
+
+OdaiResult<void> OdaiSqliteDb::append_document_chunks(const DocumentId& document_id,
+                                                      const std::vector<DocumentChunk>& chunks)
+{
+  try
+  {
+    if (m_db == nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Database not initialized");
+      return unexpected_not_initialized();
+    }
+
+    if (document_id.empty() || chunks.empty())
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Invalid document chunks passed for insertion");
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+
+    OdaiResult<void> begin_res = begin_transaction();
+    if (!begin_res)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Failed to begin transaction for appending document chunks, error code: {}",
+               static_cast<std::uint32_t>(begin_res.error()));
+      return tl::unexpected(begin_res.error());
+    }
+
+    try
+    {
+      CachedStatement query = cached_statement("SELECT space_id, scope_id FROM document WHERE id = :id LIMIT 1");
+      query->bind(":id", document_id);
+      if (!query->executeStep())
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "Document not found: {}", document_id);
+        return rollback_with_error(OdaiResultEnum::NOT_FOUND);
+      }
+      const int64_t space_id = query->getColumn("space_id").getInt64();
+      const ScopeId scope_id = query->getColumn("scope_id").getString();
+
+      OdaiResult<void> insert_res = insert_document_chunks(space_id, document_id, scope_id, chunks);
+      if (!insert_res)
+      {
+        return rollback_with_error(insert_res.error());
+      }
+
+      OdaiResult<void> commit_res = commit_transaction();
+      if (!commit_res)
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "Failed to commit transaction for appending document chunks, error code: {}",
+                 static_cast<std::uint32_t>(commit_res.error()));
+        return rollback_with_error(commit_res.error());
+      }
+    }
+    catch (...)
+    {
+      OdaiResult<void> rollback_res = rollback_transaction();
+      if (!rollback_res)
+      {
+        ODAI_LOG(ODAI_LOG_WARN, "Rollback during append_document_chunks exception path failed with error code: {}",
+                 static_cast<std::uint32_t>(rollback_res.error()));
+      }
+      throw; // Re-throw to be caught by outer catch
+    }
+
+    return {};
+  }
+  catch (const SQLite::Exception& e)
+  {
+    int ext_code = e.getExtendedErrorCode();
+    if (ext_code == SQLITE_CONSTRAINT_PRIMARYKEY || ext_code == SQLITE_CONSTRAINT_UNIQUE)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Chunk sequence index already exists for document: {}, SQLite Error: {}", document_id,
+               e.what());
+      return tl::unexpected(OdaiResultEnum::ALREADY_EXISTS);
+    }
+
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to append chunks to document: {}, SQLite Error: {}", document_id, e.what());
+    return unexpected_internal_error();
+  }
+  catch (const std::exception& e)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to append chunks to document: {}, Error: {}", document_id, e.what());
+    return unexpected_internal_error();
+  }
+}
+
+OdaiResult<void> OdaiSqliteDb::update_document(const DocumentId& document_id,
+                                               const SemanticSpaceName& semantic_space_name, const ScopeId& scope_id,
+                                               const std::vector<DocumentChunk>& chunks,
+                                               const DocumentMetadata& metadata)
+{
+  try
+  {
+    if (m_db == nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Database not initialized");
+      return unexpected_not_initialized();
+    }
+
+    if (document_id.empty() || scope_id.empty() || chunks.empty())
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Invalid document passed for update");
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+
+    if (find_knowledge_pack(semantic_space_name) != nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Semantic space {} is a read-only knowledge pack", semantic_space_name);
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+
+    OdaiResult<void> begin_res = begin_transaction();
+    if (!begin_res)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Failed to begin transaction for updating document, error code: {}",
+               static_cast<std::uint32_t>(begin_res.error()));
+      return tl::unexpected(begin_res.error());
+    }
+
+    size_t removed_vectors = 0;
+    int64_t space_id = 0;
+    try
+    {
+      std::optional<int64_t> found_space_id = find_semantic_space_id(semantic_space_name);
+      if (!found_space_id.has_value())
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "Semantic space not found: {}", semantic_space_name);
+        return rollback_with_error(OdaiResultEnum::NOT_FOUND);
+      }
+      space_id = found_space_id.value();
+
+      CachedStatement select_document =
+          cached_statement("SELECT filter_key FROM document "
+                           "WHERE id = :id AND space_id = :space_id AND scope_id = :scope_id");
+      select_document->bind(":id", document_id);
+      select_document->bind(":space_id", space_id);
+      select_document->bind(":scope_id", scope_id);
+      if (!select_document->executeStep())
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "Document {} not found in scope {} of semantic space {}", document_id, scope_id,
+                 semantic_space_name);
+        return rollback_with_error(OdaiResultEnum::NOT_FOUND);
+      }
+      const std::string old_filter_key = select_document->getColumn("filter_key").getString();
+      const std::string filter_key = make_filter_key(document_filter_values(get_filter_fields(space_id), metadata));
+
+      CachedStatement update_metadata = cached_statement("UPDATE document SET metadata = :metadata, "
+                                                         "filter_key = :filter_key WHERE id = :id");
+      if (!metadata.empty())
+      {
+        update_metadata->bind(":metadata", nlohmann::json(metadata).dump());
+      }
+      update_metadata->bind(":filter_key", filter_key);
+      update_metadata->bind(":id", document_id);
+      update_metadata->exec();
+
+      // the chunk rows and their vectors stay until the new version is stored, so unchanged chunks are reused from
+      // them and only get their new sequence index. The chunks the new version drops may lose their last reference.
+      const std::vector<int64_t> old_chunk_ids = remove_document_references(space_id, document_id);
+
+      // a re-embedding job already copied vectors with their filter values, there kept chunks get new vectors instead
+      if (filter_key != old_filter_key && !find_reembedding_job(semantic_space_name).has_value())
+      {
+        const size_t moved = move_kept_vectors(space_id, scope_id, old_filter_key, filter_key, old_chunk_ids, chunks);
+        ODAI_LOG(ODAI_LOG_DEBUG, "Moved {} vectors of document {} to its new filter values", moved, document_id);
+      }
+
+      OdaiResult<void> insert_res = insert_document_chunks(space_id, document_id, scope_id, chunks);
+      if (!insert_res)
+      {
+        return rollback_with_error(insert_res.error());
+      }
+
+      removed_vectors = remove_orphaned_chunks(space_id, scope_id, old_filter_key, old_chunk_ids);
+
+      OdaiResult<void> commit_res = commit_transaction();
+      if (!commit_res)
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "Failed to commit transaction for updating document, error code: {}",
+                 static_cast<std::uint32_t>(commit_res.error()));
+        return rollback_with_error(commit_res.error());
+      }
+    }
+    catch (...)
+    {
+      OdaiResult<void> rollback_res = rollback_transaction();
+      if (!rollback_res)
+      {
+        ODAI_LOG(ODAI_LOG_WARN, "Rollback during update_document exception path failed with error code: {}",
+                 static_cast<std::uint32_t>(rollback_res.error()));
+      }
+      throw; // Re-throw to be caught by outer catch
+    }
+
+    ODAI_LOG(ODAI_LOG_DEBUG, "Updated document {} to {} chunks in semantic space {}, removed {} orphaned vectors",
+             document_id, chunks.size(), semantic_space_name, removed_vectors);
+    return {};
+  }
+  catch (const SQLite::Exception& e)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to update document: {}, SQLite Error: {}", document_id, e.what());
+    return unexpected_internal_error();
+  }
+  catch (const std::exception& e)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to update document: {}, Error: {}", document_id, e.what());
+    return unexpected_internal_error();
+  }
+}
+
+OdaiResult<void> OdaiSqliteDb::delete_document(const DocumentId& document_id,
+                                               const SemanticSpaceName& semantic_space_name, const ScopeId& scope_id)
+{
+  try
+  {
+    if (m_db == nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Database not initialized");
+      return unexpected_not_initialized();
+    }
+
+    if (document_id.empty() || scope_id.empty())
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Invalid document passed for deletion");
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+
+    if (find_knowledge_pack(semantic_space_name) != nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Semantic space {} is a read-only knowledge pack", semantic_space_name);
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+
+    OdaiResult<void> begin_res = begin_transaction();
+    if (!begin_res)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Failed to begin transaction for deleting document, error code: {}",
+               static_cast<std::uint32_t>(begin_res.error()));
+      return tl::unexpected(begin_res.error());
+    }
+
+    size_t removed_vectors = 0;
+    int64_t space_id = 0;
+    try
+    {
+      std::optional<int64_t> found_space_id = find_semantic_space_id(semantic_space_name);
+      if (!found_space_id.has_value())
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "Semantic space not found: {}", semantic_space_name);
+        return rollback_with_error(OdaiResultEnum::NOT_FOUND);
+      }
+      space_id = found_space_id.value();
+
+      CachedStatement select_document =
+          cached_statement("SELECT filter_key FROM document "
+                           "WHERE id = :id AND space_id = :space_id AND scope_id = :scope_id");
+      select_document->bind(":id", document_id);
+      select_document->bind(":space_id", space_id);
+      select_document->bind(":scope_id", scope_id);
+      if (!select_document->executeStep())
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "Document {} not found in scope {} of semantic space {}", document_id, scope_id,
+                 semantic_space_name);
+        return rollback_with_error(OdaiResultEnum::NOT_FOUND);
+      }
+      const std::string filter_key = select_document->getColumn("filter_key").getString();
+      select_document->reset();
+
+      const std::vector<int64_t> chunk_ids = remove_document_references(space_id, document_id);
+      CachedStatement delete_document_row = cached_statement("DELETE FROM document WHERE id = :id");
+      delete_document_row->bind(":id", document_id);
+      delete_document_row->exec();
+
+      removed_vectors = remove_orphaned_chunks(space_id, scope_id, filter_key, chunk_ids);
+
+      OdaiResult<void> commit_res = commit_transaction();
+      if (!commit_res)
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "Failed to commit transaction for deleting document, error code: {}",
+                 static_cast<std::uint32_t>(commit_res.error()));
+        return rollback_with_error(commit_res.error());
+      }
+    }
+    catch (...)
+    {
+      OdaiResult<void> rollback_res = rollback_transaction();
+      if (!rollback_res)
+      {
+        ODAI_LOG(ODAI_LOG_WARN, "Rollback during delete_document exception path failed with error code: {}",
+                 static_cast<std::uint32_t>(rollback_res.error()));
+      }
+      throw; // Re-throw to be caught by outer catch
+    }
+
+    ODAI_LOG(ODAI_LOG_DEBUG, "Deleted document {} from semantic space {}, removed {} orphaned vectors", document_id,
+             semantic_space_name, removed_vectors);
+    return {};
+  }
+  catch (const SQLite::Exception& e)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to delete document: {}, SQLite Error: {}", document_id, e.what());
+    return unexpected_internal_error();
+  }
+  catch (const std::exception& e)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to delete document: {}, Error: {}", document_id, e.what());
+    return unexpected_internal_error();
+  }
+}
+
+std::vector<int64_t> OdaiSqliteDb::remove_document_references(int64_t space_id, const DocumentId& document_id)
+{
+  std::vector<int64_t> chunk_ids;
+  CachedStatement select_chunks =
+      cached_statement("SELECT DISTINCT chunk_id FROM doc_chunk_ref WHERE doc_id = :doc_id");
+  select_chunks->bind(":doc_id", document_id);
+  while (select_chunks->executeStep())
+  {
+    chunk_ids.push_back(select_chunks->getColumn("chunk_id").getInt64());
+  }
+
+  CachedStatement delete_refs = cached_statement("DELETE FROM doc_chunk_ref WHERE doc_id = :doc_id");
+  delete_refs->bind(":doc_id", document_id);
+  delete_refs->exec();
+
+  // a document vector can't be adjusted, an updated document gets a new one from its new chunks
+  CachedStatement select_document_vector =
+      cached_statement("SELECT vector_rowid FROM document_vector_ref WHERE doc_id = :doc_id");
+  select_document_vector->bind(":doc_id", document_id);
+  if (select_document_vector->executeStep())
+  {
+    const int64_t vector_rowid = select_document_vector->getColumn("vector_rowid").getInt64();
+    const std::string docs_table = document_vector_table_name(live_vector_table(space_id));
+    CachedStatement delete_vector = cached_statement("DELETE FROM " + docs_table + " WHERE rowid = :rowid");
+    delete_vector->bind(":rowid", vector_rowid);
+    delete_vector->exec();
+    CachedStatement delete_ref = cached_statement("DELETE FROM document_vector_ref WHERE vector_rowid = :rowid");
+    delete_ref->bind(":rowid", vector_rowid);
+    delete_ref->exec();
+  }
+
+  return chunk_ids;
+}
+
+size_t OdaiSqliteDb::move_kept_vectors(int64_t space_id, const ScopeId& scope_id, const std::string& old_filter_key,
+                                       const std::string& filter_key, const std::vector<int64_t>& chunk_ids,
+                                       const std::vector<DocumentChunk>& chunks)
+{
+  std::unordered_set<int64_t> kept_hashes;
+  for (const DocumentChunk& chunk : chunks)
+  {
+    kept_hashes.insert(static_cast<int64_t>(chunk.m_contentHash));
+  }
+
+  const std::vector<std::string>& filter_fields = get_filter_fields(space_id);
+  const std::vector<std::string> filter_values = parse_filter_key(filter_key, filter_fields.size());
+  CachedStatement select_hash = cached_statement("SELECT content_hash FROM chunk WHERE id = :chunk_id");
+  // the document's own references are already removed, any one found belongs to another document
+  CachedStatement select_scope_use =
+      cached_statement("SELECT 1 FROM doc_chunk_ref r JOIN document d ON d.id = r.doc_id "
+                       "WHERE r.chunk_id = :chunk_id AND d.space_id = :space_id "
+                       "AND d.scope_id = :scope_id AND d.filter_key = :filter_key LIMIT 1");
+  CachedStatement select_vector_ref =
+      cached_statement("SELECT vector_rowid FROM chunk_vector_ref WHERE space_id = :space_id "
+                       "AND chunk_id = :chunk_id AND scope_id = :scope_id AND filter_key = :filter_key");
+  CachedStatement update_vector_ref =
+      cached_statement("UPDATE chunk_vector_ref SET filter_key = :filter_key WHERE vector_rowid = :rowid");
+  CachedStatement update_vector = cached_statement("UPDATE " + live_vector_table(space_id) + " SET " +
+                                                   filter_column_updates(filter_fields) + " WHERE rowid = :rowid");
+
+  auto find_vector = [&](int64_t chunk_id, const std::string& key) -> std::optional<int64_t>
+  {
+    select_vector_ref->bind(":space_id", space_id);
+    select_vector_ref->bind(":chunk_id", chunk_id);
+    select_vector_ref->bind(":scope_id", scope_id);
+    select_vector_ref->bind(":filter_key", key);
+    std::optional<int64_t> vector_rowid;
+    if (select_vector_ref->executeStep())
+    {
+      vector_rowid = select_vector_ref->getColumn("vector_rowid").getInt64();
+    }
+    select_vector_ref->reset();
+    select_vector_ref->clearBindings();
+    return vector_rowid;
+  };
+
+  size_t moved = 0;
+  for (const int64_t chunk_id : chunk_ids)
+  {
+    select_hash->bind(":chunk_id", chunk_id);
+    const bool kept = select_hash->executeStep() && kept_hashes.contains(select_hash->getColumn(0).getInt64());
+    select_hash->reset();
+    select_hash->clearBindings();
+    if (!kept)
+    {
+      continue;
+    }
+
+    select_scope_use->bind(":chunk_id", chunk_id);
+    select_scope_use->bind(":space_id", space_id);
+    select_scope_use->bind(":scope_id", scope_id);
+    select_scope_use->bind(":filter_key", old_filter_key);
+    const bool shared = select_scope_use->executeStep();
+    select_scope_use->reset();
+    select_scope_use->clearBindings();
+    if (shared || find_vector(chunk_id, filter_key).has_value())
+    {
+      continue;
+    }
+
+    const std::optional<int64_t> vector_rowid = find_vector(chunk_id, old_filter_key);
+    if (!vector_rowid.has_value())
+    {
+      continue;
+    }
+    update_vector_ref->bind(":filter_key", filter_key);
+    update_vector_ref->bind(":rowid", vector_rowid.value());
+    update_vector_ref->exec();
+    update_vector_ref->reset();
+    update_vector_ref->clearBindings();
+    bind_filter_values(*update_vector, filter_values);
+    update_vector->bind(":rowid", vector_rowid.value());
+    update_vector->exec();
+    update_vector->reset();
+    update_vector->clearBindings();
+    ++moved;
+  }
+
+  return moved;
+}
+
+void OdaiSqliteDb::rebuild_vector_index(int64_t space_id)
+{
+  auto index_it = m_vectorIndexes.find(space_id);
+  if (index_it == m_vectorIndexes.end())
+  {
+    return;
+  }
+
+  const std::string vec_table = index_it->second.m_vectorTable;
+  const size_t deleted = index_it->second.m_index->deleted_count();
+  m_vectorIndexes.erase(index_it);
+  const std::filesystem::path index_path = vector_index_path(m_dbConfig.m_dbPath, vec_table);
+  std::error_code ec;
+  std::filesystem::remove(index_path, ec);
+
+  // built from the stored vectors and saved right away, so other connections load the new graph
+  OdaiHnswIndex* index = get_vector_index(space_id);
+  if (index == nullptr)
+  {
+    return;
+  }
+  ODAI_LOG(ODAI_LOG_INFO, "Rebuilt HNSW index of {} without its {} deleted vectors, {} indexed", vec_table, deleted,
+           index->size());
+  OdaiResult<void> save_res = index->save(index_path);
+  if (!save_res)
+  {
+    ODAI_LOG(ODAI_LOG_WARN, "Failed to save rebuilt HNSW index {}, error code: {}", index_path.string(),
+             static_cast<std::uint32_t>(save_res.error()));
+  }
+}
+
+size_t OdaiSqliteDb::remove_orphaned_chunks(int64_t space_id, const ScopeId& scope_id, const std::string& filter_key,
+                                            const std::vector<int64_t>& chunk_ids)
+{
+  const std::string vec_table = live_vector_table(space_id);
+  CachedStatement select_scope_use =
+      cached_statement("SELECT 1 FROM doc_chunk_ref r JOIN document d ON d.id = r.doc_id "
+                       "WHERE r.chunk_id = :chunk_id AND d.space_id = :space_id "
+                       "AND d.scope_id = :scope_id AND d.filter_key = :filter_key LIMIT 1");
+  CachedStatement select_vector_ref =
+      cached_statement("SELECT vector_rowid FROM chunk_vector_ref WHERE space_id = :space_id "
+                       "AND chunk_id = :chunk_id AND scope_id = :scope_id "
+                       "AND filter_key = :filter_key");
+  CachedStatement delete_vector_ref = cached_statement("DELETE FROM chunk_vector_ref WHERE vector_rowid = :rowid");
+  CachedStatement delete_vector = cached_statement("DELETE FROM " + vec_table + " WHERE rowid = :rowid");
+  CachedStatement select_any_use = cached_statement("SELECT 1 FROM doc_chunk_ref WHERE chunk_id = :chunk_id LIMIT 1");
+  // chunk_fts is an external content table, removing a row takes the 'delete' command with the indexed text
+  CachedStatement delete_chunk_fts =
+      cached_statement("INSERT INTO chunk_fts (chunk_fts, rowid, content_text) "
+                       "SELECT 'delete', id, content_text FROM chunk WHERE id = :chunk_id");
+  CachedStatement delete_chunk = cached_statement("DELETE FROM chunk WHERE id = :chunk_id");
+
+  // the HNSW graph marks removed vectors deleted once the transaction commits
+  const bool hnsw = get_vector_index_config(space_id).m_indexType == VECTOR_INDEX_HNSW;
+  if (hnsw)
+  {
+    m_pendingIndexSpaces.insert(space_id);
+  }
+
+  size_t removed_vectors = 0;
+  for (const int64_t chunk_id : chunk_ids)
+  {
+    select_scope_use->bind(":chunk_id", chunk_id);
+    select_scope_use->bind(":space_id", space_id);
+    select_scope_use->bind(":scope_id", scope_id);
+    select_scope_use->bind(":filter_key", filter_key);
+    const bool used_in_scope = select_scope_use->executeStep();
+    select_scope_use->reset();
+    select_scope_use->clearBindings();
+    if (used_in_scope)
+    {
+      continue;
+    }
+
+    select_vector_ref->bind(":space_id", space_id);
+    select_vector_ref->bind(":chunk_id", chunk_id);
+    select_vector_ref->bind(":scope_id", scope_id);
+    select_vector_ref->bind(":filter_key", filter_key);
+    std::optional<int64_t> vector_rowid;
+    if (select_vector_ref->executeStep())
+    {
+      vector_rowid = select_vector_ref->getColumn("vector_rowid").getInt64();
+    }
+    select_vector_ref->reset();
+    select_vector_ref->clearBindings();
+    if (vector_rowid.has_value())
+    {
+      delete_vector->bind(":rowid", vector_rowid.value());
+      delete_vector->exec();
+      delete_vector->reset();
+      delete_vector_ref->bind(":rowid", vector_rowid.value());
+      delete_vector_ref->exec();
+      delete_vector_ref->reset();
+      if (hnsw)
+      {
+        m_pendingIndexRemovals[space_id].push_back(vector_rowid.value());
+      }
+      ++removed_vectors;
+    }
+
+    // documents of other scopes or spaces may still reference the content, it is only dropped once none does
+    select_any_use->bind(":chunk_id", chunk_id);
+    const bool used_elsewhere = select_any_use->executeStep();
+    select_any_use->reset();
+    if (used_elsewhere)
+    {
+      continue;
+    }
+
+    delete_chunk_fts->bind(":chunk_id", chunk_id);
+    delete_chunk_fts->exec();
+    delete_chunk_fts->reset();
+    delete_chunk->bind(":chunk_id", chunk_id);
+    delete_chunk->exec();
+    delete_chunk->reset();
+  }
+
+  return removed_vectors;
+}
+
+void OdaiSqliteDb::rebuild_document_vectors(int64_t space_id, const std::string& vector_table)
+{
+  // a document vector sums the vectors of the document's positions, so doc_chunk_ref rows are joined one per position
+  SQLite::Statement select_vectors(*m_db, "SELECT dv.vector_rowid AS vector_rowid, d.scope_id AS scope_id, "
+                                          "d.filter_key AS filter_key, v.embedding AS embedding FROM document d "
+                                          "JOIN document_vector_ref dv ON dv.doc_id = d.id "
+                                          "JOIN doc_chunk_ref dr ON dr.doc_id = d.id "
+                                          "JOIN chunk_vector_ref r ON r.space_id = d.space_id "
+                                          "AND r.chunk_id = dr.chunk_id AND r.scope_id = d.scope_id "
+                                          "AND r.filter_key = d.filter_key "
+                                          "JOIN " + vector_table + " v ON v.rowid = r.vector_rowid "
+                                          "WHERE d.space_id = :space_id ORDER BY dv.vector_rowid");
+  select_vectors.bind(":space_id", space_id);
+  const std::vector<std::string>& filter_fields = get_filter_fields(space_id);
+  SQLite::Statement insert(*m_db, insert_document_vector_sql(vector_table, filter_fields));
+
+  std::optional<int64_t> document_rowid;
+  ScopeId document_scope;
+  std::vector<std::string> document_filter_values;
+  std::vector<float> document_vector;
+  auto insert_document_vector = [&]()
+  {
+    if (!document_rowid.has_value() || document_vector.empty())
+    {
+      return;
+    }
+    insert.bind(":rowid", document_rowid.value());
+    insert.bind(":embedding", document_vector.data(), static_cast<int>(document_vector.size() * sizeof(float)));
+    insert.bind(":scope_id", document_scope);
+    bind_filter_values(insert, document_filter_values);
+    insert.exec();
+    insert.reset();
+  };
+
+  std::vector<float> embedding;
+  while (select_vectors.executeStep())
+  {
+    const int64_t rowid = select_vectors.getColumn("vector_rowid").getInt64();
+    if (rowid != document_rowid)
+    {
+      insert_document_vector();
+      document_rowid = rowid;
+      document_scope = select_vectors.getColumn("scope_id").getString();
+      document_filter_values =
+          parse_filter_key(select_vectors.getColumn("filter_key").getString(), filter_fields.size());
+      document_vector.clear();
+    }
+
+    const SQLite::Column embedding_col = select_vectors.getColumn("embedding");
+    embedding.resize(static_cast<size_t>(embedding_col.getBytes()) / sizeof(float));
+    std::memcpy(embedding.data(), embedding_col.getBlob(), embedding.size() * sizeof(float));
+    add_normalized(document_vector, embedding);
+  }
+  insert_document_vector();
+}
+
+std::optional<OdaiSqliteDb::StoredReembedJob>
+OdaiSqliteDb::find_reembedding_job(const SemanticSpaceName& semantic_space_name)
+{
+  SQLite::Statement query(*m_db, "SELECT s.id AS space_id, s.vector_generation AS generation, "
+                                 "json(j.target_config) AS target_config, json(j.config) AS config, "
+                                 "j.last_vector_rowid AS last_vector_rowid FROM reembed_job j "
+                                 "JOIN semantic_spaces s ON s.id = j.space_id WHERE s.name = :name");
+  query.bind(":name", semantic_space_name);
+  if (!query.executeStep())
+  {
+    return std::nullopt;
+  }
+
+  StoredReembedJob stored;
+  stored.m_spaceId = query.getColumn("space_id").getInt64();
+  stored.m_targetGeneration = query.getColumn("generation").getInt64() + 1;
+  stored.m_lastVectorRowid = query.getColumn("last_vector_rowid").getInt64();
+  stored.m_job.m_targetConfig =
+      nlohmann::json::parse(query.getColumn("target_config").getString()).get<SemanticSpaceConfig>();
+  stored.m_job.m_config = nlohmann::json::parse(query.getColumn("config").getString()).get<ReembedConfig>();
+
+  SQLite::Statement progress(*m_db, "SELECT count(*) AS total, count(*) FILTER (WHERE vector_rowid <= :last_rowid) "
+                                    "AS done FROM chunk_vector_ref WHERE space_id = :space_id");
+  progress.bind(":last_rowid", stored.m_lastVectorRowid);
+  progress.bind(":space_id", stored.m_spaceId);
+  progress.executeStep();
+  stored.m_job.m_vectorsDone = static_cast<uint64_t>(progress.getColumn("done").getInt64());
+  stored.m_job.m_vectorsTotal = static_cast<uint64_t>(progress.getColumn("total").getInt64());
+  return stored;
+}
+
+OdaiResult<void> OdaiSqliteDb::start_reembedding(const SemanticSpaceConfig& target_config,
+                                                 const ReembedConfig& config)
+{
+  try
+  {
+    if (m_db == nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Database not initialized");
+      return unexpected_not_initialized();
+    }
+
+    if (!target_config.is_sane() || target_config.m_dimensions == 0 || !config.is_sane())
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Invalid re-embedding passed for semantic space: {}", target_config.m_name);
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+
+    if (find_knowledge_pack(target_config.m_name) != nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Semantic space {} is a read-only knowledge pack", target_config.m_name);
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+
+    OdaiResult<void> begin_res = begin_transaction();
+    if (!begin_res)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Failed to begin transaction for starting re-embedding, error code: {}",
+               static_cast<std::uint32_t>(begin_res.error()));
+      return tl::unexpected(begin_res.error());
+    }
+
+    try
+    {
+      SQLite::Statement select_space(*m_db, "SELECT id, json(config) AS config, vector_generation FROM semantic_spaces "
+                                            "WHERE name = :name");
+      select_space.bind(":name", target_config.m_name);
+      if (!select_space.executeStep())
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "Semantic space not found: {}", target_config.m_name);
+        return rollback_with_error(OdaiResultEnum::NOT_FOUND);
+      }
+      const int64_t space_id = select_space.getColumn("id").getInt64();
+      const int64_t generation = select_space.getColumn("vector_generation").getInt64();
+
+      // only what the new model decides may change, chunks and index settings are shared by both vector tables
+      SemanticSpaceConfig expected_config =
+          nlohmann::json::parse(select_space.getColumn("config").getString()).get<SemanticSpaceConfig>();
+      expected_config.m_embeddingModelConfig = target_config.m_embeddingModelConfig;
+      expected_config.m_dimensions = target_config.m_dimensions;
+      expected_config.m_truncatedDimensions = target_config.m_truncatedDimensions;
+      if (nlohmann::json(expected_config) != nlohmann::json(target_config))
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "Re-embedding of semantic space {} can only change its embedding model",
+                 target_config.m_name);
+        return rollback_with_error(OdaiResultEnum::VALIDATION_FAILED);
+      }
+
+      SQLite::Statement select_job(*m_db, "SELECT 1 FROM reembed_job WHERE space_id = :space_id");
+      select_job.bind(":space_id", space_id);
+      if (select_job.executeStep())
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "Semantic space {} is already being re-embedded", target_config.m_name);
+        return rollback_with_error(OdaiResultEnum::ALREADY_EXISTS);
+      }
+
+      SQLite::Statement insert(*m_db, "INSERT INTO reembed_job (space_id, target_config, config) "
+                                      "VALUES (:space_id, jsonb(:target_config), jsonb(:config))");
+      insert.bind(":space_id", space_id);
+      insert.bind(":target_config", nlohmann::json(target_config).dump());
+      insert.bind(":config", nlohmann::json(config).dump());
+      insert.exec();
+
+      create_vector_table(vector_table_name(space_id, generation + 1), target_config.stored_dimensions(),
+                          target_config.m_vectorIndexConfig.m_storageType, target_config.m_filterFields);
+
+      OdaiResult<void> commit_res = commit_transaction();
+      if (!commit_res)
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "Failed to commit transaction for starting re-embedding, error code: {}",
+                 static_cast<std::uint32_t>(commit_res.error()));
+        return rollback_with_error(commit_res.error());
+      }
+    }
+    catch (...)
+    {
+      OdaiResult<void> rollback_res = rollback_transaction();
+      if (!rollback_res)
+      {
+        ODAI_LOG(ODAI_LOG_WARN, "Rollback during start_reembedding exception path failed with error code: {}",
+                 static_cast<std::uint32_t>(rollback_res.error()));
+      }
+      throw; // Re-throw to be caught by outer catch
+    }
+
+    ODAI_LOG(ODAI_LOG_INFO, "Started re-embedding semantic space {} with model {}", target_config.m_name,
+             target_config.m_embeddingModelConfig.m_modelName);
+    return {};
+  }
+  catch (const std::exception& e)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to start re-embedding: {}, Error: {}", target_config.m_name, e.what());
+    return unexpected_internal_error();
+  }
+}
+
+OdaiResult<ReembedJob> OdaiSqliteDb::get_reembedding_job(const SemanticSpaceName& semantic_space_name)
+{
+  try
+  {
+    if (m_db == nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Database not initialized");
+      return unexpected_not_initialized();
+    }
+
+    std::optional<StoredReembedJob> stored = find_reembedding_job(semantic_space_name);
+    if (!stored.has_value())
+    {
+      ODAI_LOG(ODAI_LOG_DEBUG, "No re-embedding job for semantic space: {}", semantic_space_name);
+      return tl::unexpected(OdaiResultEnum::NOT_FOUND);
+    }
+    return stored->m_job;
+  }
+  catch (const std::exception& e)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to get re-embedding job: {}, Error: {}", semantic_space_name, e.what());
+    return unexpected_internal_error();
+  }
+}
+
+OdaiResult<std::vector<ReembedJob>> OdaiSqliteDb::list_reembedding_jobs()
+{
+  try
+  {
+    if (m_db == nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Database not initialized");
+      return unexpected_not_initialized();
+    }
+
+    std::vector<SemanticSpaceName> names;
+    SQLite::Statement query(*m_db, "SELECT s.name AS name FROM reembed_job j "
+                                   "JOIN semantic_spaces s ON s.id = j.space_id ORDER BY j.created_at, s.name");
+    while (query.executeStep())
+    {
+      names.push_back(query.getColumn("name").getString());
+    }
+
+    std::vector<ReembedJob> jobs;
+    for (const SemanticSpaceName& name : names)
+    {
+      std::optional<StoredReembedJob> stored = find_reembedding_job(name);
+      if (stored.has_value())
+      {
+        jobs.push_back(std::move(stored->m_job));
+      }
+    }
+    return jobs;
+  }
+  catch (const std::exception& e)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to list re-embedding jobs, Error: {}", e.what());
+    return unexpected_internal_error();
+  }
+}
+
+OdaiResult<std::vector<ReembedChunk>> OdaiSqliteDb::get_reembedding_batch(const SemanticSpaceName& semantic_space_name,
+                                                                          uint32_t limit)
+{
+  try
+  {
+    if (m_db == nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Database not initialized");
+      return unexpected_not_initialized();
+    }
+
+    if (limit == 0)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Invalid re-embedding batch size passed for semantic space: {}", semantic_space_name);
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+
+    std::optional<StoredReembedJob> stored = find_reembedding_job(semantic_space_name);
+    if (!stored.has_value())
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "No re-embedding job for semantic space: {}", semantic_space_name);
+      return tl::unexpected(OdaiResultEnum::NOT_FOUND);
+    }
+
+    SQLite::Statement query(*m_db, "SELECT r.vector_rowid AS vector_rowid, c.content_hash AS content_hash, "
+                                   "c.content_text AS content_text FROM chunk_vector_ref r "
+                                   "JOIN chunk c ON c.id = r.chunk_id "
+                                   "WHERE r.space_id = :space_id AND r.vector_rowid > :last_rowid "
+                                   "ORDER BY r.vector_rowid LIMIT :limit");
+    query.bind(":space_id", stored->m_spaceId);
+    query.bind(":last_rowid", stored->m_lastVectorRowid);
+    query.bind(":limit", static_cast<int64_t>(limit));
+
+    std::vector<ReembedChunk> chunks;
+    while (query.executeStep())
+    {
+      ReembedChunk chunk;
+      chunk.m_vectorId = query.getColumn("vector_rowid").getInt64();
+      chunk.m_contentHash = static_cast<uint64_t>(query.getColumn("content_hash").getInt64());
+      chunk.m_contentText = query.getColumn("content_text").getString();
+      chunks.push_back(std::move(chunk));
+    }
+    return chunks;
+  }
+  catch (const std::exception& e)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to get re-embedding batch: {}, Error: {}", semantic_space_name, e.what());
+    return unexpected_internal_error();
+  }
+}
+
+OdaiResult<void> OdaiSqliteDb::store_reembedded_vectors(const SemanticSpaceName& semantic_space_name,
+                                                        const std::vector<ReembedChunk>& chunks)
+{
+  try
+  {
+    if (m_db == nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Database not initialized");
+      return unexpected_not_initialized();
+    }
+
+    if (chunks.empty())
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Empty re-embedding batch passed for semantic space: {}", semantic_space_name);
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+
+    OdaiResult<void> begin_res = begin_transaction();
+    if (!begin_res)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Failed to begin transaction for storing re-embedded vectors, error code: {}",
+               static_cast<std::uint32_t>(begin_res.error()));
+      return tl::unexpected(begin_res.error());
+    }
+
+    try
+    {
+      std::optional<StoredReembedJob> stored = find_reembedding_job(semantic_space_name);
+      if (!stored.has_value())
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "No re-embedding job for semantic space: {}", semantic_space_name);
+        return rollback_with_error(OdaiResultEnum::NOT_FOUND);
+      }
+
+      const SemanticSpaceConfig& target_config = stored->m_job.m_targetConfig;
+      int64_t last_rowid = stored->m_lastVectorRowid;
+      for (const ReembedChunk& chunk : chunks)
+      {
+        // a batch stored twice would insert the same rowids again
+        if (chunk.m_vectorId <= last_rowid || chunk.m_embedding.size() != target_config.stored_dimensions())
+        {
+          ODAI_LOG(ODAI_LOG_ERROR, "Re-embedded vector {} of semantic space {} is out of order or has {} dimensions",
+                   chunk.m_vectorId, semantic_space_name, chunk.m_embedding.size());
+          return rollback_with_error(OdaiResultEnum::VALIDATION_FAILED);
+        }
+        last_rowid = chunk.m_vectorId;
+      }
+
+      const VectorStorageType storage_type = target_config.m_vectorIndexConfig.m_storageType;
+      const bool quantized = storage_type != VECTOR_STORAGE_FLOAT32;
+      const std::string vec_table = vector_table_name(stored->m_spaceId, stored->m_targetGeneration);
+      SQLite::Statement select_scope(*m_db, "SELECT scope_id, filter_key FROM chunk_vector_ref "
+                                            "WHERE vector_rowid = :rowid");
+      SQLite::Statement insert_vector(*m_db, insert_vector_sql(vec_table, storage_type, target_config.m_filterFields));
+
+      for (const ReembedChunk& chunk : chunks)
+      {
+        select_scope.bind(":rowid", chunk.m_vectorId);
+        std::optional<ScopeId> scope_id;
+        std::string filter_key;
+        if (select_scope.executeStep())
+        {
+          scope_id = select_scope.getColumn("scope_id").getString();
+          filter_key = select_scope.getColumn("filter_key").getString();
+        }
+        select_scope.reset();
+        if (!scope_id.has_value())
+        {
+          // the chunk was removed from the space after the batch was read
+          continue;
+        }
+
+        insert_vector.bind(":rowid", chunk.m_vectorId);
+        insert_vector.bind(":embedding", chunk.m_embedding.data(),
+                           static_cast<int>(chunk.m_embedding.size() * sizeof(float)));
+        std::vector<uint8_t> coarse;
+        if (quantized)
+        {
+          coarse = quantize_vector(chunk.m_embedding, storage_type);
+          insert_vector.bind(":coarse", coarse.data(), static_cast<int>(coarse.size()));
+        }
+        insert_vector.bind(":scope_id", scope_id.value());
+        bind_filter_values(insert_vector, parse_filter_key(filter_key, target_config.m_filterFields.size()));
+        insert_vector.exec();
+        insert_vector.reset();
+      }
+
+      SQLite::Statement update_job(*m_db,
+                                   "UPDATE reembed_job SET last_vector_rowid = :last_rowid WHERE space_id = :space_id");
+      update_job.bind(":last_rowid", last_rowid);
+      update_job.bind(":space_id", stored->m_spaceId);
+      update_job.exec();
+
+      OdaiResult<void> commit_res = commit_transaction();
+      if (!commit_res)
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "Failed to commit transaction for storing re-embedded vectors, error code: {}",
+                 static_cast<std::uint32_t>(commit_res.error()));
+        return rollback_with_error(commit_res.error());
+      }
+    }
+    catch (...)
+    {
+      OdaiResult<void> rollback_res = rollback_transaction();
+      if (!rollback_res)
+      {
+        ODAI_LOG(ODAI_LOG_WARN, "Rollback during store_reembedded_vectors exception path failed with error code: {}",
+                 static_cast<std::uint32_t>(rollback_res.error()));
+      }
+      throw; // Re-throw to be caught by outer catch
+    }
+
+    return {};
+  }
+  catch (const std::exception& e)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to store re-embedded vectors: {}, Error: {}", semantic_space_name, e.what());
+    return unexpected_internal_error();
+  }
+}
+
+OdaiResult<bool> OdaiSqliteDb::finish_reembedding(const SemanticSpaceName& semantic_space_name)
+{
+  try
+  {
+    if (m_db == nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Database not initialized");
+      return unexpected_not_initialized();
+    }
+
+    OdaiResult<void> begin_res = begin_transaction();
+    if (!begin_res)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Failed to begin transaction for finishing re-embedding, error code: {}",
+               static_cast<std::uint32_t>(begin_res.error()));
+      return tl::unexpected(begin_res.error());
+    }
+
+    std::string old_vec_table;
+    int64_t space_id = 0;
+    try
+    {
+      std::optional<StoredReembedJob> stored = find_reembedding_job(semantic_space_name);
+      if (!stored.has_value())
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "No re-embedding job for semantic space: {}", semantic_space_name);
+        OdaiResult<void> rollback_res = rollback_with_error(OdaiResultEnum::NOT_FOUND);
+        return tl::unexpected(rollback_res.error());
+      }
+      space_id = stored->m_spaceId;
+
+      if (stored->m_job.m_vectorsDone < stored->m_job.m_vectorsTotal)
+      {
+        // vectors were added while the last batch was embedded, nothing was written
+        OdaiResult<void> rollback_res = rollback_transaction();
+        if (!rollback_res)
+        {
+          return tl::unexpected(rollback_res.error());
+        }
+        return false;
+      }
+
+      const std::string vec_table = vector_table_name(space_id, stored->m_targetGeneration);
+      old_vec_table = vector_table_name(space_id, stored->m_targetGeneration - 1);
+
+      // vectors of chunks removed from the space after their batch was stored
+      SQLite::Statement delete_removed(*m_db, "DELETE FROM " + vec_table + " WHERE rowid NOT IN "
+                                              "(SELECT vector_rowid FROM chunk_vector_ref WHERE space_id = :space_id)");
+      delete_removed.bind(":space_id", space_id);
+      delete_removed.exec();
+
+      rebuild_document_vectors(space_id, vec_table);
+
+      SQLite::Statement update_space(*m_db, "UPDATE semantic_spaces SET config = jsonb(:config), "
+                                            "vector_generation = :generation WHERE id = :id");
+      update_space.bind(":config", nlohmann::json(stored->m_job.m_targetConfig).dump());
+      update_space.bind(":generation", stored->m_targetGeneration);
+      update_space.bind(":id", space_id);
+      update_space.exec();
+
+      SQLite::Statement delete_job(*m_db, "DELETE FROM reembed_job WHERE space_id = :space_id");
+      delete_job.bind(":space_id", space_id);
+      delete_job.exec();
+
+      drop_vector_tables(old_vec_table);
+
+      OdaiResult<void> commit_res = commit_transaction();
+      if (!commit_res)
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "Failed to commit transaction for finishing re-embedding, error code: {}",
+                 static_cast<std::uint32_t>(commit_res.error()));
+        OdaiResult<void> rollback_res = rollback_with_error(commit_res.error());
+        return tl::unexpected(rollback_res.error());
+      }
+    }
+    catch (...)
+    {
+      OdaiResult<void> rollback_res = rollback_transaction();
+      if (!rollback_res)
+      {
+        ODAI_LOG(ODAI_LOG_WARN, "Rollback during finish_reembedding exception path failed with error code: {}",
+                 static_cast<std::uint32_t>(rollback_res.error()));
+      }
+      throw; // Re-throw to be caught by outer catch
+    }
+
+    m_vectorIndexes.erase(space_id);
+    std::error_code ec;
+    std::filesystem::remove(vector_index_path(m_dbConfig.m_dbPath, old_vec_table), ec);
+
+    ODAI_LOG(ODAI_LOG_INFO, "Semantic space {} switched to its re-embedded vectors", semantic_space_name);
+    return true;
+  }
+  catch (const std::exception& e)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to finish re-embedding: {}, Error: {}", semantic_space_name, e.what());
+    return unexpected_internal_error();
+  }
+}
+
+OdaiResult<void> OdaiSqliteDb::cancel_reembedding(const SemanticSpaceName& semantic_space_name)
+{
+  try
+  {
+    if (m_db == nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Database not initialized");
+      return unexpected_not_initialized();
+    }
+
+    OdaiResult<void> begin_res = begin_transaction();
+    if (!begin_res)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Failed to begin transaction for cancelling re-embedding, error code: {}",
+               static_cast<std::uint32_t>(begin_res.error()));
+      return tl::unexpected(begin_res.error());
+    }
+
+    try
+    {
+      std::optional<StoredReembedJob> stored = find_reembedding_job(semantic_space_name);
+      if (!stored.has_value())
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "No re-embedding job for semantic space: {}", semantic_space_name);
+        return rollback_with_error(OdaiResultEnum::NOT_FOUND);
+      }
+
+      SQLite::Statement delete_job(*m_db, "DELETE FROM reembed_job WHERE space_id = :space_id");
+      delete_job.bind(":space_id", stored->m_spaceId);
+      delete_job.exec();
+
+      const std::string vec_table = vector_table_name(stored->m_spaceId, stored->m_targetGeneration);
+      drop_vector_tables(vec_table);
+
+      OdaiResult<void> commit_res = commit_transaction();
+      if (!commit_res)
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "Failed to commit transaction for cancelling re-embedding, error code: {}",
+                 static_cast<std::uint32_t>(commit_res.error()));
+        return rollback_with_error(commit_res.error());
+      }
+    }
+    catch (...)
+    {
+      OdaiResult<void> rollback_res = rollback_transaction();
+      if (!rollback_res)
+      {
+        ODAI_LOG(ODAI_LOG_WARN, "Rollback during cancel_reembedding exception path failed with error code: {}",
+                 static_cast<std::uint32_t>(rollback_res.error()));
+      }
+      throw; // Re-throw to be caught by outer catch
+    }
+
+    ODAI_LOG(ODAI_LOG_INFO, "Cancelled re-embedding of semantic space {}", semantic_space_name);
+    return {};
+  }
+  catch (const std::exception& e)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to cancel re-embedding: {}, Error: {}", semantic_space_name, e.what());
+    return unexpected_internal_error();
+  }
+}
+
+OdaiResult<std::vector<RetrievedChunk>> OdaiSqliteDb::search_chunks(const SemanticSpaceName& semantic_space_name,
+                                                                    const ScopeId& scope_id,
+                                                                    const std::vector<float>& query_embedding,
+                                                                    uint32_t limit, bool include_embeddings,
+                                                                    const MetadataFilter& filter)
+{
+  return search_vectors(semantic_space_name, scope_id, query_embedding, 0, limit, include_embeddings, filter);
+}
+
+OdaiResult<std::vector<RetrievedChunk>>
+OdaiSqliteDb::search_chunks_in_top_documents(const SemanticSpaceName& semantic_space_name, const ScopeId& scope_id,
+                                             const std::vector<float>& query_embedding, uint32_t document_limit,
+                                             uint32_t limit, bool include_embeddings, const MetadataFilter& filter)
+{
+  if (document_limit == 0)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Two-stage search needs a document limit, semantic space: {}", semantic_space_name);
+    return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+  }
+  return search_vectors(semantic_space_name, scope_id, query_embedding, document_limit, limit, include_embeddings,
+                        filter);
+}
+
+OdaiResult<std::vector<RetrievedChunk>> OdaiSqliteDb::search_vectors(const SemanticSpaceName& semantic_space_name,
+                                                                     const ScopeId& scope_id,
+                                                                     const std::vector<float>& query_embedding,
+                                                                     uint32_t document_limit, uint32_t limit,
+                                                                     bool include_embeddings,
+                                                                     const MetadataFilter& filter)
+{
+  try
+  {
+    if (m_db == nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Database not initialized");
+      return unexpected_not_initialized();
+    }
+
+    if (scope_id.empty() || query_embedding.empty() || limit == 0)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Invalid search passed for semantic space: {}", semantic_space_name);
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+
+    if (AttachedKnowledgePack* pack = find_knowledge_pack(semantic_space_name))
+    {
+      return pack->m_db->search_vectors(pack->m_spaceName, scope_id, query_embedding, document_limit, limit,
+                                        include_embeddings, filter);
+    }
+
+    std::optional<int64_t> space_id = find_semantic_space_id(semantic_space_name);
+    if (!space_id.has_value())
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Semantic space not found: {}", semantic_space_name);
+      return tl::unexpected(OdaiResultEnum::NOT_FOUND);
+    }
+
+    const std::optional<std::string> filter_sql =
+        metadata_filter_sql(get_filter_fields(space_id.value()), filter, "");
+    if (!filter_sql.has_value())
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Metadata filter uses a field semantic space {} doesn't declare", semantic_space_name);
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+
+    std::vector<RetrievedChunk> results;
+
+    // spaces created without dimensions only get their vector table on first ingestion
+    const std::string vec_table = live_vector_table(space_id.value());
+    if (!m_db->tableExists(vec_table))
+    {
+      return results;
+    }
+
+    CachedStatement dims_query =
+        cached_statement("SELECT vec_length(embedding) AS dims FROM " + vec_table + " LIMIT 1");
+    if (!dims_query->executeStep())
+    {
+      return results;
+    }
+    if (dims_query->getColumn("dims").getInt64() != static_cast<int64_t>(query_embedding.size()))
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Query embedding has {} dimensions but semantic space {} stores {}",
+               query_embedding.size(), semantic_space_name, dims_query->getColumn("dims").getInt64());
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+
+    if (limit > SQLITE_VEC_MAX_KNN_K)
+    {
+      ODAI_LOG(ODAI_LOG_WARN, "Search limit {} capped to {}", limit, SQLITE_VEC_MAX_KNN_K);
+      limit = SQLITE_VEC_MAX_KNN_K;
+    }
+
+    const std::string docs_table = document_vector_table_name(vec_table);
+    const bool two_stage = document_limit > 0;
+    document_limit = std::min<uint32_t>(document_limit, SQLITE_VEC_MAX_KNN_K);
+
+    // rowid lookups on the vector table, only prepared when embeddings are asked for
+    std::optional<CachedStatement> embedding_query;
+    if (include_embeddings)
+    {
+      embedding_query.emplace(cached_statement("SELECT embedding FROM " + vec_table + " WHERE rowid = :vector_rowid"));
+    }
+    auto read_embedding = [&embedding_query](int64_t vector_rowid, RetrievedChunk& chunk)
+    {
+      if (!embedding_query.has_value())
+      {
+        return;
+      }
+      (*embedding_query)->bind(":vector_rowid", vector_rowid);
+      if ((*embedding_query)->executeStep())
+      {
+        const SQLite::Column embedding = (*embedding_query)->getColumn("embedding");
+        chunk.m_embedding.resize(static_cast<size_t>(embedding.getBytes()) / sizeof(float));
+        std::memcpy(chunk.m_embedding.data(), embedding.getBlob(), chunk.m_embedding.size() * sizeof(float));
+      }
+      (*embedding_query)->reset();
+    };
+
+    // the graph holds the vectors of every filter value, a filtered search scans the matching vectors instead
+    OdaiHnswIndex* index = two_stage || !filter.empty() ? nullptr : get_vector_index(space_id.value());
+    if (index != nullptr && index->prefers_graph_search(scope_id))
+    {
+      // resolve the graph's hits one by one, they are already ordered by distance
+      CachedStatement resolve =
+          cached_statement(std::string("SELECT c.content_text AS content_text, d.id AS doc_id, "
+                                       "d.source_uri AS source_uri, dr.sequence_index AS sequence_index "
+                                       "FROM chunk_vector_ref r ") +
+                           CHUNK_SOURCE_JOINS + "WHERE r.vector_rowid = :vector_rowid");
+
+      for (const OdaiHnswIndex::SearchHit& hit : index->search(query_embedding, scope_id, limit))
+      {
+        resolve->bind(":vector_rowid", hit.m_vectorRowid);
+        resolve->bind(":scope_id", scope_id);
+        resolve->bind(":space_id", space_id.value());
+        if (resolve->executeStep())
+        {
+          RetrievedChunk chunk;
+          chunk.m_documentId = resolve->getColumn("doc_id").getString();
+          chunk.m_sourceUri = resolve->getColumn("source_uri").getString();
+          chunk.m_sequenceIndex = static_cast<uint32_t>(resolve->getColumn("sequence_index").getInt64());
+          chunk.m_contentText = resolve->getColumn("content_text").getString();
+          chunk.m_score = 1.0F - hit.m_distance;
+          read_embedding(hit.m_vectorRowid, chunk);
+          results.push_back(std::move(chunk));
+        }
+        resolve->reset();
+        resolve->clearBindings();
+      }
+
+      return results;
+    }
+
+    std::string knn_sql = "SELECT rowid, distance FROM " + vec_table +
+                          " WHERE embedding MATCH :embedding AND k = :k AND scope_id = :scope_id" + filter_sql.value();
+    const VectorIndexConfig& index_config = get_vector_index_config(space_id.value());
+    std::vector<uint8_t> coarse_query;
+    if (two_stage)
+    {
+      // exact distances to the in-scope vectors of the chunks of the nearest documents
+      knn_sql = "SELECT v.rowid AS rowid, vec_distance_cosine(v.embedding, :embedding) AS distance "
+                "FROM (SELECT DISTINCT r.vector_rowid AS vector_rowid FROM (SELECT rowid FROM " +
+                docs_table +
+                " WHERE embedding MATCH :embedding AND k = :document_k AND scope_id = :scope_id" +
+                filter_sql.value() +
+                ") top_docs "
+                "JOIN document_vector_ref dv ON dv.vector_rowid = top_docs.rowid "
+                "JOIN document td ON td.id = dv.doc_id "
+                "JOIN doc_chunk_ref dcr ON dcr.doc_id = dv.doc_id "
+                "JOIN chunk_vector_ref r ON r.space_id = :space_id AND r.chunk_id = dcr.chunk_id "
+                "AND r.scope_id = :scope_id AND r.filter_key = td.filter_key) candidates "
+                "JOIN " +
+                vec_table + " v ON v.rowid = candidates.vector_rowid ORDER BY distance LIMIT :k";
+    }
+    else if (index_config.m_storageType != VECTOR_STORAGE_FLOAT32)
+    {
+      // scan the quantized vectors for oversampled candidates, then rank those by their exact float distance
+      coarse_query = quantize_vector(query_embedding, index_config.m_storageType);
+      knn_sql = "SELECT v.rowid AS rowid, vec_distance_cosine(v.embedding, :embedding) AS distance "
+                "FROM (SELECT rowid FROM " +
+                vec_table + " WHERE embedding_coarse MATCH " +
+                coarse_vector_sql(index_config.m_storageType, ":coarse") +
+                " AND k = :coarse_k AND scope_id = :scope_id" + filter_sql.value() +
+                ") coarse "
+                "JOIN " +
+                vec_table + " v ON v.rowid = coarse.rowid ORDER BY distance LIMIT :k";
+    }
+
+    // KNN on the scope's partition first, then resolve each vector to its chunk and to the first document of the
+    // scope containing it
+    CachedStatement query = cached_statement("WITH knn AS (" + knn_sql +
+                                             ") "
+                                             "SELECT knn.rowid AS vector_rowid, knn.distance AS distance, "
+                                             "c.content_text AS content_text, "
+                                             "d.id AS doc_id, d.source_uri AS source_uri, "
+                                             "dr.sequence_index AS sequence_index "
+                                             "FROM knn "
+                                             "JOIN chunk_vector_ref r ON r.vector_rowid = knn.rowid " +
+                                             CHUNK_SOURCE_JOINS + "ORDER BY knn.distance");
+    query->bind(":embedding", query_embedding.data(), static_cast<int>(query_embedding.size() * sizeof(float)));
+    query->bind(":k", static_cast<int64_t>(limit));
+    query->bind(":scope_id", scope_id);
+    query->bind(":space_id", space_id.value());
+    bind_metadata_filter(*query, filter);
+    if (two_stage)
+    {
+      query->bind(":document_k", static_cast<int64_t>(document_limit));
+    }
+    if (!coarse_query.empty())
+    {
+      const uint64_t coarse_k = static_cast<uint64_t>(limit) * index_config.m_rescoreOversample;
+      query->bind(":coarse", coarse_query.data(), static_cast<int>(coarse_query.size()));
+      query->bind(":coarse_k", static_cast<int64_t>(std::min<uint64_t>(coarse_k, SQLITE_VEC_MAX_KNN_K)));
+    }
+
+    while (query->executeStep())
+    {
+      RetrievedChunk chunk;
+      chunk.m_documentId = query->getColumn("doc_id").getString();
+      chunk.m_sourceUri = query->getColumn("source_uri").getString();
+      chunk.m_sequenceIndex = static_cast<uint32_t>(query->getColumn("sequence_index").getInt64());
+      chunk.m_contentText = query->getColumn("content_text").getString();
+      // vector tables use cosine distance, which is 1 - cosine similarity
+      chunk.m_score = 1.0F - static_cast<float>(query->getColumn("distance").getDouble());
+      read_embedding(query->getColumn("vector_rowid").getInt64(), chunk);
+      results.push_back(std::move(chunk));
+    }
+
+    return results;
+  }
+  catch (const std::exception& e)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to search semantic space: {}, Error: {}", semantic_space_name, e.what());
+    return unexpected_internal_error();
+  }
+}
+
+OdaiResult<std::vector<RetrievedChunk>>
+OdaiSqliteDb::search_chunks_by_keywords(const SemanticSpaceName& semantic_space_name, const ScopeId& scope_id,
+                                        const std::string& query_text, uint32_t limit, const MetadataFilter& filter)
+{
+  try
+  {
+    if (m_db == nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Database not initialized");
+      return unexpected_not_initialized();
+    }
+
+    if (scope_id.empty() || query_text.empty() || limit == 0)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Invalid keyword search passed for semantic space: {}", semantic_space_name);
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+
+    if (AttachedKnowledgePack* pack = find_knowledge_pack(semantic_space_name))
+    {
+      return pack->m_db->search_chunks_by_keywords(pack->m_spaceName, scope_id, query_text, limit, filter);
+    }
+
+    std::optional<int64_t> space_id = find_semantic_space_id(semantic_space_name);
+    if (!space_id.has_value())
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Semantic space not found: {}", semantic_space_name);
+      return tl::unexpected(OdaiResultEnum::NOT_FOUND);
+    }
+
+    const std::optional<std::string> filter_sql =
+        metadata_filter_sql(get_filter_fields(space_id.value()), filter, "v.");
+    if (!filter_sql.has_value())
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Metadata filter uses a field semantic space {} doesn't declare", semantic_space_name);
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+
+    std::vector<RetrievedChunk> results;
+
+    const std::string match_expression = build_keyword_match_expression(query_text);
+    if (match_expression.empty())
+    {
+      ODAI_LOG(ODAI_LOG_DEBUG, "Keyword query has no searchable words, nothing to search");
+      return results;
+    }
+
+    // the filter values are only stored with the vectors, a matching chunk's vector row is looked up by rowid
+    std::string filter_join;
+    if (!filter.empty())
+    {
+      const std::string vec_table = live_vector_table(space_id.value());
+      if (!m_db->tableExists(vec_table))
+      {
+        return results;
+      }
+      filter_join = "JOIN " + vec_table + " v ON v.rowid = r.vector_rowid" + filter_sql.value() + " ";
+    }
+
+    // chunk_fts covers the chunks of every space, restrict the matches to the ones embedded in the searched scope
+    // before ranking. bm25() is negative, lower is better.
+    CachedStatement query =
+        cached_statement(std::string("WITH matches AS (SELECT rowid AS chunk_id, bm25(chunk_fts) AS rank "
+                                     "FROM chunk_fts WHERE chunk_fts MATCH :match) "
+                                     "SELECT m.rank AS rank, c.content_text AS content_text, "
+                                     "d.id AS doc_id, d.source_uri AS source_uri, "
+                                     "dr.sequence_index AS sequence_index "
+                                     "FROM matches m "
+                                     "JOIN chunk_vector_ref r ON r.chunk_id = m.chunk_id "
+                                     "AND r.space_id = :space_id AND r.scope_id = :scope_id ") +
+                         filter_join + CHUNK_SOURCE_JOINS + "ORDER BY m.rank LIMIT :limit");
+    query->bind(":match", match_expression);
+    query->bind(":space_id", space_id.value());
+    query->bind(":scope_id", scope_id);
+    query->bind(":limit", static_cast<int64_t>(limit));
+    bind_metadata_filter(*query, filter);
+
+    while (query->executeStep())
+    {
+      RetrievedChunk chunk;
+      chunk.m_documentId = query->getColumn("doc_id").getString();
+      chunk.m_sourceUri = query->getColumn("source_uri").getString();
+      chunk.m_sequenceIndex = static_cast<uint32_t>(query->getColumn("sequence_index").getInt64());
+      chunk.m_contentText = query->getColumn("content_text").getString();
+      // BM25 scores are unbounded, map them into [0, 1) keeping their order
+      const double bm25_score = std::max(0.0, -query->getColumn("rank").getDouble());
+      chunk.m_score = static_cast<float>(bm25_score / (1.0 + bm25_score));
+      results.push_back(std::move(chunk));
+    }
+
+    return results;
+  }
+  catch (const std::exception& e)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed keyword search in semantic space: {}, Error: {}", semantic_space_name,
+             e.what());
+    return unexpected_internal_error();
+  }
+}
+
+OdaiResult<std::vector<std::vector<DocumentChunk>>>
+OdaiSqliteDb::get_document_chunk_spans(const SemanticSpaceName& semantic_space_name,
+                                       const std::vector<DocumentChunkSpan>& spans)
+{
+  try
+  {
+    if (m_db == nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Database not initialized");
+      return unexpected_not_initialized();
+    }
+
+    for (const DocumentChunkSpan& span : spans)
+    {
+      if (span.m_documentId.empty() || span.m_lastSequenceIndex < span.m_firstSequenceIndex)
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "Invalid chunk span passed for document: {}", span.m_documentId);
+        return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+      }
+    }
+
+    if (AttachedKnowledgePack* pack = find_knowledge_pack(semantic_space_name))
+    {
+      return pack->m_db->get_document_chunk_spans(pack->m_spaceName, spans);
+    }
+
+    CachedStatement query =
+        cached_statement("SELECT dr.sequence_index AS sequence_index, c.content_text AS content_text "
+                         "FROM doc_chunk_ref dr INDEXED BY idx_doc_chunk_ref_doc_seq "
+                         "JOIN chunk c ON c.id = dr.chunk_id "
+                         "WHERE dr.doc_id = :doc_id AND dr.sequence_index BETWEEN :first AND :last "
+                         "ORDER BY dr.sequence_index");
+
+    std::vector<std::vector<DocumentChunk>> results;
+    results.reserve(spans.size());
+    for (const DocumentChunkSpan& span : spans)
+    {
+      query->reset();
+      query->bind(":doc_id", span.m_documentId);
+      query->bind(":first", static_cast<int64_t>(span.m_firstSequenceIndex));
+      query->bind(":last", static_cast<int64_t>(span.m_lastSequenceIndex));
+
+      std::vector<DocumentChunk>& span_chunks = results.emplace_back();
+      while (query->executeStep())
+      {
+        DocumentChunk chunk;
+        chunk.m_sequenceIndex = static_cast<uint32_t>(query->getColumn("sequence_index").getInt64());
+        chunk.m_contentText = query->getColumn("content_text").getString();
+        span_chunks.push_back(std::move(chunk));
+      }
+    }
+
+    return results;
+  }
+  catch (const std::exception& e)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to read document chunk spans, Error: {}", e.what());
+    return unexpected_internal_error();
+  }
+}
+
+OdaiResult<void> OdaiSqliteDb::rollback_with_error(OdaiResultEnum error)
+{
+  OdaiResult<void> rollback_res = rollback_transaction();
+  if (!rollback_res)
+  {
+    ODAI_LOG(ODAI_LOG_WARN, "Rollback after failed write also failed with error code: {}",
+             static_cast<std::uint32_t>(rollback_res.error()));
+  }
+  return tl::unexpected(error);
+}
+
+OdaiResult<bool> OdaiSqliteDb::chat_id_exists(const ChatId& chat_id)
+{
+  try
+  {
+    if (m_db == nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Database not initialized");
+      return unexpected_not_initialized();
+    }
+
+    // "SELECT 1" is enough. We limit to 1 so the DB stops searching immediately.
+    CachedStatement select_chat = cached_statement("SELECT 1 FROM chats WHERE chat_id = :chat_id LIMIT 1");
+
+    // Bind the parameter, use named parameters instead of index based to avoid unexpected behaviour due to changes in
+    // future
+    select_chat->bind(":chat_id", chat_id);
+    return select_chat->executeStep();
+  }
+  catch (const SQLite::Exception& e)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Check Exists SQLite Error for chat_id {}: {}", chat_id, e.what());
+    return unexpected_internal_error();
+  }
+  catch (const std::exception& e)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Check Exists Error for chat_id {}: {}", chat_id, e.what());
+    return unexpected_internal_error();
+  }
+}
+
+OdaiResult<void> OdaiSqliteDb::create_chat(const ChatId& chat_id, const ChatConfig& chat_config)
+{
+  try
+  {
+    if (m_db == nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Database not initialized");
+      return unexpected_not_initialized();
     }
 
     if (!chat_config.is_sane())
@@ -786,18 +3951,18 @@ OdaiResult<ChatConfig> OdaiSqliteDb::get_chat_config(const ChatId& chat_id)
     }
 
     // always use named fields to extract data instead of index
-    SQLite::Statement query(
-        *m_db, "SELECT title, json(chat_config) as chat_config FROM chats WHERE chat_id = :chat_id LIMIT 1");
+    CachedStatement query =
+        cached_statement("SELECT title, json(chat_config) as chat_config FROM chats WHERE chat_id = :chat_id LIMIT 1");
 
-    query.bind(":chat_id", chat_id);
+    query->bind(":chat_id", chat_id);
 
-    if (!query.executeStep())
+    if (!query->executeStep())
     {
       ODAI_LOG(ODAI_LOG_ERROR, "chat_id {} does not exist", chat_id);
       return tl::unexpected(OdaiResultEnum::NOT_FOUND);
     }
 
-    SQLite::Column chat_config_col = query.getColumn("chat_config");
+    SQLite::Column chat_config_col = query->getColumn("chat_config");
 
     if (chat_config_col.isNull())
     {
@@ -829,24 +3994,25 @@ OdaiResult<std::vector<ChatMessage>> OdaiSqliteDb::get_chat_history(const ChatId
     std::vector<ChatMessage> messages;
     messages.clear();
 
-    SQLite::Statement query(*m_db, "SELECT role, content, json(message_metadata) as message_metadata, created_at "
-                                   "FROM chat_messages "
-                                   "WHERE chat_id = :chat_id "
-                                   "ORDER BY sequence_index");
+    CachedStatement query =
+        cached_statement("SELECT role, content, json(message_metadata) as message_metadata, created_at "
+                         "FROM chat_messages "
+                         "WHERE chat_id = :chat_id "
+                         "ORDER BY sequence_index");
 
-    query.bind(":chat_id", chat_id);
+    query->bind(":chat_id", chat_id);
 
     bool has_results = false;
-    while (query.executeStep())
+    while (query->executeStep())
     {
       has_results = true;
 
       ChatMessage msg;
 
-      SQLite::Column role_col = query.getColumn("role");
-      SQLite::Column content_col = query.getColumn("content");
-      SQLite::Column metadata_col = query.getColumn("message_metadata");
-      SQLite::Column created_at_col = query.getColumn("created_at");
+      SQLite::Column role_col = query->getColumn("role");
+      SQLite::Column content_col = query->getColumn("content");
+      SQLite::Column metadata_col = query->getColumn("message_metadata");
+      SQLite::Column created_at_col = query->getColumn("created_at");
 
       msg.m_role = role_col.getString();
 
@@ -920,11 +4086,11 @@ OdaiResult<void> OdaiSqliteDb::insert_chat_messages(const ChatId& chat_id, const
 
     try
     {
-      // Prepare statement once, reuse for all messages
-      SQLite::Statement insert_message(
-          *m_db, "INSERT INTO chat_messages (chat_id, role, content, message_metadata, sequence_index) "
-                 "VALUES (:chat_id, :role, :content, jsonb(:message_metadata), "
-                 "COALESCE((SELECT MAX(sequence_index) + 1 FROM chat_messages WHERE chat_id = :chat_id), 0))");
+      // Prepared once per connection, reused for all messages
+      CachedStatement insert_message =
+          cached_statement("INSERT INTO chat_messages (chat_id, role, content, message_metadata, sequence_index) "
+                           "VALUES (:chat_id, :role, :content, jsonb(:message_metadata), COALESCE("
+                           "(SELECT MAX(sequence_index) + 1 FROM chat_messages WHERE chat_id = :chat_id), 0))");
 
       // this fn is given messages where message content items are coming from db's store_media_items
 
@@ -961,14 +4127,14 @@ OdaiResult<void> OdaiSqliteDb::insert_chat_messages(const ChatId& chat_id, const
           }
         }
 
-        insert_message.bind(":chat_id", chat_id);
-        insert_message.bind(":role", msg.m_role);
+        insert_message->bind(":chat_id", chat_id);
+        insert_message->bind(":role", msg.m_role);
         nlohmann::json content_json = msg.m_contentItems;
-        insert_message.bind(":content", content_json.dump());
-        insert_message.bind(":message_metadata", msg.m_messageMetadata.dump());
-        insert_message.exec();
-        insert_message.reset(); // Reset for next iteration
-        insert_message.clearBindings();
+        insert_message->bind(":content", content_json.dump());
+        insert_message->bind(":message_metadata", msg.m_messageMetadata.dump());
+        insert_message->exec();
+        insert_message->reset(); // Reset for next iteration
+        insert_message->clearBindings();
       }
 
       OdaiResult<void> commit_res = commit_transaction();
@@ -1019,6 +4185,50 @@ OdaiResult<void> OdaiSqliteDb::insert_chat_messages(const ChatId& chat_id, const
 
 void OdaiSqliteDb::close()
 {
+  for (const auto& [space_id, loaded] : m_vectorIndexes)
+  {
+    // a knowledge pack is read-only, an index built over one without a stored index lives in memory only
+    if (!loaded.m_index->is_dirty() || m_knowledgePackIndexOffset.has_value())
+    {
+      continue;
+    }
+
+    try
+    {
+      // a re-embedding job finished through another connection may have dropped the indexed table
+      if (m_db == nullptr || !m_db->tableExists(loaded.m_vectorTable))
+      {
+        continue;
+      }
+    }
+    catch (const std::exception& e)
+    {
+      ODAI_LOG(ODAI_LOG_WARN, "Failed to check vector table {} before saving its HNSW index, Error: {}",
+               loaded.m_vectorTable, e.what());
+      continue;
+    }
+
+    // a failed save only costs a rebuild of the missing vectors on next open
+    OdaiResult<void> save_res =
+        loaded.m_index->save(vector_index_path(m_dbConfig.m_dbPath, loaded.m_vectorTable));
+    if (!save_res)
+    {
+      ODAI_LOG(ODAI_LOG_WARN, "Failed to save HNSW index of {}, error code: {}", loaded.m_vectorTable,
+               static_cast<std::uint32_t>(save_res.error()));
+    }
+  }
+  m_vectorIndexes.clear();
+  m_vectorIndexConfigs.clear();
+  m_filterFields.clear();
+  m_pendingIndexSpaces.clear();
+
+  for (auto& [name, pack] : m_knowledgePacks)
+  {
+    pack.m_db->close();
+  }
+  m_knowledgePacks.clear();
+  m_statementCache.clear();
+
   try
   {
     if (m_db != nullptr)
@@ -0,0 +1,78 @@
+#include "db/odai_sqlite/odai_sqlite_statement_cache.h"
+
+#include <utility>
+
+OdaiSqliteStatementCache::CachedStatement::CachedStatement(SQLite::Statement& statement, bool& in_use)
+    : m_statement(&statement), m_inUse(&in_use)
+{
+  m_statement->clearBindings();
+  *m_inUse = true;
+}
+
+OdaiSqliteStatementCache::CachedStatement::CachedStatement(std::unique_ptr<SQLite::Statement> uncached)
+    : m_uncached(std::move(uncached)), m_statement(m_uncached.get())
+{
+}
+
+OdaiSqliteStatementCache::CachedStatement::CachedStatement(CachedStatement&& other) noexcept
+    : m_uncached(std::move(other.m_uncached)), m_statement(other.m_statement),
+      m_inUse(std::exchange(other.m_inUse, nullptr))
+{
+}
+
+OdaiSqliteStatementCache::CachedStatement::~CachedStatement()
+{
+  if (m_inUse != nullptr)
+  {
+    // the error of a failed last step is reported again by the reset, the borrower already got it
+    m_statement->tryReset();
+    *m_inUse = false;
+  }
+}
+
+OdaiSqliteStatementCache::OdaiSqliteStatementCache(size_t capacity) : m_capacity(capacity) {}
+
+OdaiSqliteStatementCache::CachedStatement OdaiSqliteStatementCache::borrow(SQLite::Database& db,
+                                                                           const std::string& sql)
+{
+  if (m_capacity == 0)
+  {
+    return CachedStatement(std::make_unique<SQLite::Statement>(db, sql));
+  }
+
+  auto it = m_entries.find(sql);
+  if (it == m_entries.end())
+  {
+    if (m_entries.size() >= m_capacity)
+    {
+      std::erase_if(m_entries, [](const auto& entry) { return !entry.second.m_inUse; });
+    }
+    it = m_entries.emplace(sql, Entry{std::make_unique<SQLite::Statement>(db, sql), false}).first;
+  }
+  else if (it->second.m_inUse)
+  {
+    return CachedStatement(std::make_unique<SQLite::Statement>(db, sql));
+  }
+  return CachedStatement(*it->second.m_statement, it->second.m_inUse);
+}
+
+void OdaiSqliteStatementCache::evict_containing(const std::string& text)
+{
+  std::erase_if(m_entries, [&text](const auto& entry)
+                { return !entry.second.m_inUse && entry.first.find(text) != std::string::npos; });
+}
+
+void OdaiSqliteStatementCache::clear()
+{
+  m_entries.clear();
+}
+
+size_t OdaiSqliteStatementCache::size() const
+{
+  return m_entries.size();
+}
+
+bool OdaiSqliteStatementCache::contains(const std::string& sql) const
+{
+  return m_entries.contains(sql);
+}
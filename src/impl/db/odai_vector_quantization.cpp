@@ -0,0 +1,53 @@
+#include "db/odai_vector_quantization.h"
+
+#include <algorithm>
+#include <cmath>
+
+std::vector<int8_t> quantize_int8(const std::vector<float>& vector)
+{
+  float max_abs = 0.0F;
+  for (const float value : vector)
+  {
+    max_abs = std::max(max_abs, std::fabs(value));
+  }
+
+  std::vector<int8_t> quantized(vector.size(), 0);
+  if (max_abs == 0.0F)
+  {
+    return quantized;
+  }
+
+  const float scale = 127.0F / max_abs;
+  for (size_t i = 0; i < vector.size(); ++i)
+  {
+    quantized[i] = static_cast<int8_t>(std::lround(std::clamp(vector[i] * scale, -127.0F, 127.0F)));
+  }
+  return quantized;
+}
+
+std::vector<uint8_t> quantize_binary(const std::vector<float>& vector)
+{
+  std::vector<uint8_t> quantized(binary_quantized_bytes(vector.size()), 0);
+  for (size_t i = 0; i < vector.size(); ++i)
+  {
+    if (vector[i] > 0.0F)
+    {
+      quantized[i / 8] |= static_cast<uint8_t>(1U << (i % 8));
+    }
+  }
+  return quantized;
+}
+
+std::vector<uint8_t> quantize_vector(const std::vector<float>& vector, VectorStorageType storage_type)
+{
+  if (storage_type == VECTOR_STORAGE_INT8)
+  {
+    const std::vector<int8_t> quantized = quantize_int8(vector);
+    return {quantized.begin(), quantized.end()};
+  }
+  if (storage_type == VECTOR_STORAGE_BINARY)
+  {
+    return quantize_binary(vector);
+  }
+  return {};
+}
@@ -286,24 +286,269 @@ c_OdaiResult odai_delete_semantic_space(const c_SemanticSpaceName name)
   ODAI_CATCH_RETURN(ODAI_INTERNAL_ERROR)
 }
 
+c_OdaiResult odai_export_knowledge_pack(const c_SemanticSpaceName name, const char* pack_path, bool include_ann_index)
+{
+  try
+  {
+    if (name == nullptr || pack_path == nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Invalid arguments passed to odai_export_knowledge_pack");
+      return ODAI_INVALID_ARGUMENT;
+    }
+
+    OdaiResult<void> res = OdaiSdk::get_instance().export_knowledge_pack(SemanticSpaceName(name),
+                                                                         std::string(pack_path), include_ann_index);
+    if (!res)
+    {
+      return to_c_result(res.error());
+    }
+
+    return ODAI_SUCCESS;
+  }
+  ODAI_CATCH_RETURN(ODAI_INTERNAL_ERROR)
+}
+
+c_OdaiResult odai_import_knowledge_pack(const char* pack_path, const c_SemanticSpaceName name,
+                                        c_SemanticSpaceConfig* config_out)
+{
+  try
+  {
+    if (pack_path == nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Invalid arguments passed to odai_import_knowledge_pack");
+      return ODAI_INVALID_ARGUMENT;
+    }
+
+    if (config_out != nullptr)
+    {
+      *config_out = {};
+    }
+
+    OdaiResult<SemanticSpaceConfig> res = OdaiSdk::get_instance().import_knowledge_pack(
+        std::string(pack_path), name == nullptr ? SemanticSpaceName() : SemanticSpaceName(name));
+    if (!res)
+    {
+      return to_c_result(res.error());
+    }
+
+    if (config_out != nullptr)
+    {
+      *config_out = to_c(res.value());
+    }
+    return ODAI_SUCCESS;
+  }
+  ODAI_CATCH_RETURN(ODAI_INTERNAL_ERROR)
+}
+
 c_OdaiResult odai_add_document(const char* content, const c_DocumentId document_id,
-                               const c_SemanticSpaceName semantic_space_name, const c_ScopeId scope_id)
+                               const c_SemanticSpaceName semantic_space_name, const c_ScopeId scope_id,
+                               const c_MetadataEntry* metadata, size_t metadata_count)
 {
   try
   {
-    if (content == nullptr || document_id == nullptr || semantic_space_name == nullptr || scope_id == nullptr)
+    if (content == nullptr || document_id == nullptr || semantic_space_name == nullptr || scope_id == nullptr ||
+        !is_sane(metadata, metadata_count))
     {
       ODAI_LOG(ODAI_LOG_ERROR, "Invalid arguments passed to odai_add_document");
       return ODAI_INVALID_ARGUMENT;
     }
 
     OdaiResult<void> res = OdaiSdk::get_instance().add_document(
-        std::string(content), DocumentId(document_id), SemanticSpaceName(semantic_space_name), ScopeId(scope_id));
+        std::string(content), DocumentId(document_id), SemanticSpaceName(semantic_space_name), ScopeId(scope_id),
+        to_cpp_document_metadata(metadata, metadata_count));
+    if (!res)
+    {
+      return to_c_result(res.error());
+    }
+
+    return ODAI_SUCCESS;
+  }
+  ODAI_CATCH_RETURN(ODAI_INTERNAL_ERROR)
+}
+
+c_OdaiResult odai_update_document(const char* content, const c_DocumentId document_id,
+                                  const c_SemanticSpaceName semantic_space_name, const c_ScopeId scope_id,
+                                  const c_MetadataEntry* metadata, size_t metadata_count)
+{
+  try
+  {
+    if (content == nullptr || document_id == nullptr || semantic_space_name == nullptr || scope_id == nullptr ||
+        !is_sane(metadata, metadata_count))
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Invalid arguments passed to odai_update_document");
+      return ODAI_INVALID_ARGUMENT;
+    }
+
+    OdaiResult<void> res = OdaiSdk::get_instance().update_document(
+        std::string(content), DocumentId(document_id), SemanticSpaceName(semantic_space_name), ScopeId(scope_id),
+        to_cpp_document_metadata(metadata, metadata_count));
+    if (!res)
+    {
+      return to_c_result(res.error());
+    }
+
+    return ODAI_SUCCESS;
+  }
+  ODAI_CATCH_RETURN(ODAI_INTERNAL_ERROR)
+}
+
+c_OdaiResult odai_add_document_from_file(const char* file_path, const c_DocumentId document_id,
+                                         const c_SemanticSpaceName semantic_space_name, const c_ScopeId scope_id,
+                                         const c_MetadataEntry* metadata, size_t metadata_count)
+{
+  try
+  {
+    if (file_path == nullptr || document_id == nullptr || semantic_space_name == nullptr || scope_id == nullptr ||
+        !is_sane(metadata, metadata_count))
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Invalid arguments passed to odai_add_document_from_file");
+      return ODAI_INVALID_ARGUMENT;
+    }
+
+    OdaiResult<void> res = OdaiSdk::get_instance().add_document_from_file(
+        std::string(file_path), DocumentId(document_id), SemanticSpaceName(semantic_space_name), ScopeId(scope_id),
+        to_cpp_document_metadata(metadata, metadata_count));
+    if (!res)
+    {
+      return to_c_result(res.error());
+    }
+
+    return ODAI_SUCCESS;
+  }
+  ODAI_CATCH_RETURN(ODAI_INTERNAL_ERROR)
+}
+
+c_OdaiResult odai_add_documents(const c_IngestDocumentSource* sources, size_t sources_count,
+                                const c_SemanticSpaceName semantic_space_name, const c_ScopeId scope_id,
+                                const c_BulkIngestConfig* config, c_BulkIngestStats* stats_out)
+{
+  try
+  {
+    if (sources == nullptr || sources_count == 0 || semantic_space_name == nullptr || scope_id == nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Invalid arguments passed to odai_add_documents");
+      return ODAI_INVALID_ARGUMENT;
+    }
+
+    std::vector<IngestDocumentSource> cpp_sources;
+    cpp_sources.reserve(sources_count);
+    for (size_t i = 0; i < sources_count; ++i)
+    {
+      if (!is_sane(&sources[i]))
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "invalid document source passed at index {}", i);
+        return ODAI_INVALID_ARGUMENT;
+      }
+      cpp_sources.push_back(to_cpp(sources[i]));
+    }
+
+    const BulkIngestConfig cpp_config = config != nullptr ? to_cpp(*config) : BulkIngestConfig{};
+
+    OdaiResult<BulkIngestStats> res = OdaiSdk::get_instance().add_documents(
+        cpp_sources, SemanticSpaceName(semantic_space_name), ScopeId(scope_id), cpp_config);
+    if (!res)
+    {
+      return to_c_result(res.error());
+    }
+
+    if (stats_out != nullptr)
+    {
+      *stats_out = to_c(res.value());
+    }
+
+    return ODAI_SUCCESS;
+  }
+  ODAI_CATCH_RETURN(ODAI_INTERNAL_ERROR)
+}
+
+c_OdaiResult odai_start_reembedding(const c_SemanticSpaceName semantic_space_name,
+                                    const c_EmbeddingModelConfig* embedding_model_config,
+                                    const c_ReembedConfig* config)
+{
+  try
+  {
+    if (semantic_space_name == nullptr || !is_sane(embedding_model_config))
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Invalid arguments passed to odai_start_reembedding");
+      return ODAI_INVALID_ARGUMENT;
+    }
+
+    const ReembedConfig cpp_config = config != nullptr ? to_cpp(*config) : ReembedConfig{};
+
+    OdaiResult<void> res = OdaiSdk::get_instance().start_reembedding(
+        SemanticSpaceName(semantic_space_name), to_cpp(*embedding_model_config), cpp_config);
+    if (!res)
+    {
+      return to_c_result(res.error());
+    }
+
+    return ODAI_SUCCESS;
+  }
+  ODAI_CATCH_RETURN(ODAI_INTERNAL_ERROR)
+}
+
+c_OdaiResult odai_get_reembedding_progress(const c_SemanticSpaceName semantic_space_name,
+                                           c_ReembedProgress* progress_out)
+{
+  try
+  {
+    if (semantic_space_name == nullptr || progress_out == nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Invalid arguments passed to odai_get_reembedding_progress");
+      return ODAI_INVALID_ARGUMENT;
+    }
+
+    OdaiResult<ReembedJob> res =
+        OdaiSdk::get_instance().get_reembedding_progress(SemanticSpaceName(semantic_space_name));
+    if (!res)
+    {
+      return to_c_result(res.error());
+    }
+
+    *progress_out = to_c(res.value());
+    return ODAI_SUCCESS;
+  }
+  ODAI_CATCH_RETURN(ODAI_INTERNAL_ERROR)
+}
+
+c_OdaiResult odai_cancel_reembedding(const c_SemanticSpaceName semantic_space_name)
+{
+  try
+  {
+    if (semantic_space_name == nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Invalid arguments passed to odai_cancel_reembedding");
+      return ODAI_INVALID_ARGUMENT;
+    }
+
+    OdaiResult<void> res = OdaiSdk::get_instance().cancel_reembedding(SemanticSpaceName(semantic_space_name));
+    if (!res)
+    {
+      return to_c_result(res.error());
+    }
+
+    return ODAI_SUCCESS;
+  }
+  ODAI_CATCH_RETURN(ODAI_INTERNAL_ERROR)
+}
+
+c_OdaiResult odai_get_cache_stats(c_CacheStats* stats_out)
+{
+  try
+  {
+    if (stats_out == nullptr)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Invalid arguments passed to odai_get_cache_stats");
+      return ODAI_INVALID_ARGUMENT;
+    }
+
+    OdaiResult<CacheStats> res = OdaiSdk::get_instance().get_cache_stats();
     if (!res)
     {
       return to_c_result(res.error());
     }
 
+    *stats_out = to_c(res.value());
     return ODAI_SUCCESS;
   }
   ODAI_CATCH_RETURN(ODAI_INTERNAL_ERROR)
@@ -246,8 +246,103 @@ OdaiResult<void> OdaiSdk::delete_semantic_space(const SemanticSpaceName& name)
   ODAI_CATCH_RETURN(unexpected_internal_error())
 }
 
+OdaiResult<void> OdaiSdk::export_knowledge_pack(const SemanticSpaceName& name, const std::string& pack_path,
+                                                bool include_ann_index)
+{
+  try
+  {
+    if (!m_sdkInitialized)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "SDK is not initialized");
+      return unexpected_not_initialized();
+    }
+
+    if (name.empty() || pack_path.empty())
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Empty semantic space name or knowledge pack path passed");
+      return tl::unexpected(OdaiResultEnum::INVALID_ARGUMENT);
+    }
+
+    OdaiResult<void> res = m_ragEngine->export_knowledge_pack(name, pack_path, include_ann_index);
+    if (!res)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Failed to export semantic space: {} to knowledge pack: {}, error code: {}", name,
+               pack_path, static_cast<std::uint32_t>(res.error()));
+      return tl::unexpected(res.error());
+    }
+
+    ODAI_LOG(ODAI_LOG_INFO, "Exported semantic space: {} to knowledge pack: {}", name, pack_path);
+    return {};
+  }
+  ODAI_CATCH_RETURN(unexpected_internal_error())
+}
+
+OdaiResult<SemanticSpaceConfig> OdaiSdk::import_knowledge_pack(const std::string& pack_path,
+                                                               const SemanticSpaceName& name)
+{
+  try
+  {
+    if (!m_sdkInitialized)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "SDK is not initialized");
+      return unexpected_not_initialized();
+    }
+
+    if (pack_path.empty())
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Empty knowledge pack path passed");
+      return tl::unexpected(OdaiResultEnum::INVALID_ARGUMENT);
+    }
+
+    OdaiResult<SemanticSpaceConfig> res = m_ragEngine->import_knowledge_pack(pack_path, name);
+    if (!res)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Failed to import knowledge pack: {}, error code: {}", pack_path,
+               static_cast<std::uint32_t>(res.error()));
+      return tl::unexpected(res.error());
+    }
+
+    ODAI_LOG(ODAI_LOG_INFO, "Imported knowledge pack: {} as semantic space: {}", pack_path, res->m_name);
+    return res;
+  }
+  ODAI_CATCH_RETURN(unexpected_internal_error())
+}
+
 OdaiResult<void> OdaiSdk::add_document(const std::string& content, const DocumentId& document_id,
-                                       const SemanticSpaceName& semantic_space_name, const ScopeId& scope_id) const
+                                       const SemanticSpaceName& semantic_space_name, const ScopeId& scope_id,
+                                       const DocumentMetadata& metadata) const
+{
+  try
+  {
+    if (!m_sdkInitialized)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "SDK is not initialized");
+      return unexpected_not_initialized();
+    }
+
+    if (content.empty() || document_id.empty() || semantic_space_name.empty() || scope_id.empty())
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Invalid document arguments passed");
+      return tl::unexpected(OdaiResultEnum::INVALID_ARGUMENT);
+    }
+
+    OdaiResult<void> res = m_ragEngine->add_document(content, document_id, semantic_space_name, scope_id, metadata);
+    if (!res)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Failed to add document: {}, error code: {}", document_id,
+               static_cast<std::uint32_t>(res.error()));
+      return tl::unexpected(res.error());
+    }
+
+    ODAI_LOG(ODAI_LOG_INFO, "Added document: {} to space: {}", document_id, semantic_space_name);
+    return {};
+  }
+  ODAI_CATCH_RETURN(unexpected_internal_error())
+}
+
+OdaiResult<void> OdaiSdk::update_document(const std::string& content, const DocumentId& document_id,
+                                          const SemanticSpaceName& semantic_space_name, const ScopeId& scope_id,
+                                          const DocumentMetadata& metadata) const
 {
   try
   {
@@ -263,15 +358,209 @@ OdaiResult<void> OdaiSdk::add_document(const std::string& content, const Documen
       return tl::unexpected(OdaiResultEnum::INVALID_ARGUMENT);
     }
 
-    // ToDo : call rag engine to add document
+    OdaiResult<void> res = m_ragEngine->update_document(content, document_id, semantic_space_name, scope_id, metadata);
+    if (!res)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Failed to update document: {}, error code: {}", document_id,
+               static_cast<std::uint32_t>(res.error()));
+      return tl::unexpected(res.error());
+    }
 
-    ODAI_LOG(ODAI_LOG_INFO, "Adding document to space: {}", semantic_space_name);
+    ODAI_LOG(ODAI_LOG_INFO, "Updated document: {} in space: {}", document_id, semantic_space_name);
+    return {};
+  }
+  ODAI_CATCH_RETURN(unexpected_internal_error())
+}
 
+OdaiResult<void> OdaiSdk::add_document_from_file(const std::string& file_path, const DocumentId& document_id,
+                                                 const SemanticSpaceName& semantic_space_name,
+                                                 const ScopeId& scope_id, const DocumentMetadata& metadata) const
+{
+  try
+  {
+    if (!m_sdkInitialized)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "SDK is not initialized");
+      return unexpected_not_initialized();
+    }
+
+    if (file_path.empty() || document_id.empty() || semantic_space_name.empty() || scope_id.empty())
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Invalid document arguments passed");
+      return tl::unexpected(OdaiResultEnum::INVALID_ARGUMENT);
+    }
+
+    OdaiResult<void> res =
+        m_ragEngine->add_document_from_file(file_path, document_id, semantic_space_name, scope_id, metadata);
+    if (!res)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Failed to add document: {} from file: {}, error code: {}", document_id, file_path,
+               static_cast<std::uint32_t>(res.error()));
+      return tl::unexpected(res.error());
+    }
+
+    ODAI_LOG(ODAI_LOG_INFO, "Added document: {} from file: {} to space: {}", document_id, file_path,
+             semantic_space_name);
     return {};
   }
   ODAI_CATCH_RETURN(unexpected_internal_error())
 }
 
+OdaiResult<BulkIngestStats> OdaiSdk::add_documents(const std::vector<IngestDocumentSource>& sources,
+                                                   const SemanticSpaceName& semantic_space_name,
+                                                   const ScopeId& scope_id, const BulkIngestConfig& config) const
+{
+  try
+  {
+    if (!m_sdkInitialized)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "SDK is not initialized");
+      return unexpected_not_initialized();
+    }
+
+    if (sources.empty() || semantic_space_name.empty() || scope_id.empty())
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Invalid bulk ingestion arguments passed");
+      return tl::unexpected(OdaiResultEnum::INVALID_ARGUMENT);
+    }
+
+    if (!config.is_sane())
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "invalid Bulk Ingest Config passed");
+      return tl::unexpected(OdaiResultEnum::INVALID_ARGUMENT);
+    }
+
+    for (const IngestDocumentSource& source : sources)
+    {
+      if (!source.is_sane())
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "invalid document source passed");
+        return tl::unexpected(OdaiResultEnum::INVALID_ARGUMENT);
+      }
+    }
+
+    OdaiResult<BulkIngestStats> res = m_ragEngine->add_documents(sources, semantic_space_name, scope_id, config);
+    if (!res)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Failed to ingest documents into space: {}, error code: {}", semantic_space_name,
+               static_cast<std::uint32_t>(res.error()));
+      return tl::unexpected(res.error());
+    }
+
+    return res;
+  }
+  ODAI_CATCH_RETURN(unexpected_internal_error())
+}
+
+OdaiResult<void> OdaiSdk::start_reembedding(const SemanticSpaceName& semantic_space_name,
+                                            const EmbeddingModelConfig& embedding_model_config,
+                                            const ReembedConfig& config) const
+{
+  try
+  {
+    if (!m_sdkInitialized)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "SDK is not initialized");
+      return unexpected_not_initialized();
+    }
+
+    if (semantic_space_name.empty() || !embedding_model_config.is_sane())
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Invalid re-embedding arguments passed");
+      return tl::unexpected(OdaiResultEnum::INVALID_ARGUMENT);
+    }
+
+    if (!config.is_sane())
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "invalid Reembed Config passed");
+      return tl::unexpected(OdaiResultEnum::INVALID_ARGUMENT);
+    }
+
+    OdaiResult<void> res = m_ragEngine->start_reembedding(semantic_space_name, embedding_model_config, config);
+    if (!res)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Failed to start re-embedding space: {}, error code: {}", semantic_space_name,
+               static_cast<std::uint32_t>(res.error()));
+      return tl::unexpected(res.error());
+    }
+
+    ODAI_LOG(ODAI_LOG_INFO, "Started re-embedding space: {} with model: {}", semantic_space_name,
+             embedding_model_config.m_modelName);
+    return {};
+  }
+  ODAI_CATCH_RETURN(unexpected_internal_error())
+}
+
+OdaiResult<ReembedJob> OdaiSdk::get_reembedding_progress(const SemanticSpaceName& semantic_space_name) const
+{
+  try
+  {
+    if (!m_sdkInitialized)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "SDK is not initialized");
+      return unexpected_not_initialized();
+    }
+
+    if (semantic_space_name.empty())
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Empty semantic space name passed");
+      return tl::unexpected(OdaiResultEnum::INVALID_ARGUMENT);
+    }
+
+    return m_ragEngine->get_reembedding_job(semantic_space_name);
+  }
+  ODAI_CATCH_RETURN(unexpected_internal_error())
+}
+
+OdaiResult<void> OdaiSdk::cancel_reembedding(const SemanticSpaceName& semantic_space_name) const
+{
+  try
+  {
+    if (!m_sdkInitialized)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "SDK is not initialized");
+      return unexpected_not_initialized();
+    }
+
+    if (semantic_space_name.empty())
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Empty semantic space name passed");
+      return tl::unexpected(OdaiResultEnum::INVALID_ARGUMENT);
+    }
+
+    OdaiResult<void> res = m_ragEngine->cancel_reembedding(semantic_space_name);
+    if (!res)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Failed to cancel re-embedding space: {}, error code: {}", semantic_space_name,
+               static_cast<std::uint32_t>(res.error()));
+      return tl::unexpected(res.error());
+    }
+
+    ODAI_LOG(ODAI_LOG_INFO, "Cancelled re-embedding space: {}", semantic_space_name);
+    return {};
+  }
+  ODAI_CATCH_RETURN(unexpected_internal_error())
+}
+
+OdaiResult<CacheStats> OdaiSdk::get_cache_stats() const
+{
+  try
+  {
+    if (!m_sdkInitialized)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "SDK is not initialized");
+      return unexpected_not_initialized();
+    }
+
+    CacheStats stats;
+    stats.m_queryEmbedding = m_ragEngine->get_query_embedding_cache_stats();
+    stats.m_retrieval = m_ragEngine->get_retrieval_cache_stats();
+    stats.m_tokenCount = m_ragEngine->get_token_count_cache_stats();
+    return stats;
+  }
+  ODAI_CATCH_RETURN(unexpected_internal_error())
+}
+
 OdaiResult<StreamingStats> OdaiSdk::generate_streaming_response(const LLMModelConfig& llm_model_config,
                                                                 const std::vector<InputItem>& prompt,
                                                                 const SamplerConfig& sampler_config,
@@ -452,8 +741,10 @@ OdaiResult<StreamingStats> OdaiSdk::generate_streaming_chat_response(const ChatI
 
     ODAI_LOG(ODAI_LOG_INFO,
              "Successfully generated streaming chat response for chat_id: {} "
-             "with {} tokens",
-             chat_id, stream_res->m_generatedTokens);
+             "with {} tokens in {:.3f}s, retrieved {} chunks of {} tokens in {:.3f}s ({} reranked in {:.3f}s)",
+             chat_id, stream_res->m_generatedTokens, stream_res->m_generationSeconds, stream_res->m_retrievedChunks,
+             stream_res->m_contextTokens, stream_res->m_retrievalSeconds, stream_res->m_rerankedCandidates,
+             stream_res->m_rerankSeconds);
 
     return stream_res;
   }
@@ -0,0 +1,562 @@
+#include "ragEngine/odai_chunker.h"
+
+#include "odai_logger.h"
+#include "xxhash.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <variant>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define ODAI_CHUNKER_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define ODAI_CHUNKER_NEON
+#endif
+
+namespace
+{
+bool is_utf8_continuation_byte(char byte)
+{
+  return (static_cast<unsigned char>(byte) & 0xC0) == 0x80;
+}
+
+/// Moves pos backwards until it sits on a UTF-8 character boundary (never below floor).
+size_t snap_to_char_boundary_backward(std::string_view content, size_t pos, size_t floor)
+{
+  while (pos > floor && pos < content.size() && is_utf8_continuation_byte(content[pos]))
+  {
+    pos--;
+  }
+  return pos;
+}
+
+/// Moves pos forwards until it sits on a UTF-8 character boundary (or the end of content).
+size_t snap_to_char_boundary_forward(std::string_view content, size_t pos)
+{
+  while (pos < content.size() && is_utf8_continuation_byte(content[pos]))
+  {
+    pos++;
+  }
+  return pos;
+}
+
+DocumentChunk make_chunk(std::string_view content, uint32_t sequence_index)
+{
+  DocumentChunk chunk;
+  chunk.m_contentText = std::string(content);
+  chunk.m_contentHash = XXH3_64bits(content.data(), content.size());
+  chunk.m_sequenceIndex = sequence_index;
+  return chunk;
+}
+
+/// Classes of chunk boundaries, in order of preference
+enum BoundaryClass : uint8_t
+{
+  BOUNDARY_PARAGRAPH = 0, ///< cut after a blank line
+  BOUNDARY_LINE,          ///< cut after a newline
+  BOUNDARY_SENTENCE,      ///< cut after sentence punctuation followed by a space
+  BOUNDARY_WORD,          ///< cut after a space
+  BOUNDARY_CHAR,          ///< cut before a UTF-8 lead byte
+  BOUNDARY_CLASS_COUNT
+};
+
+/// Number of cut positions classified per scan block, one bit per cut in a 64 bit mask
+constexpr size_t BOUNDARY_BLOCK_SIZE = 64;
+
+/// Boundary bit masks of one block, bit i of a mask is set if cutting at block start + i is a boundary of that class.
+using BoundaryMasks = std::array<uint64_t, BOUNDARY_CLASS_COUNT>;
+
+bool is_space_byte(char byte)
+{
+  return byte == ' ' || byte == '\t';
+}
+
+bool is_sentence_end_byte(char byte)
+{
+  return byte == '.' || byte == '!' || byte == '?';
+}
+
+/// Classifies the cuts [pos, pos + count) one byte at a time, used near content edges and when SIMD is unavailable.
+BoundaryMasks scan_boundaries_scalar(std::string_view content, size_t pos, size_t count)
+{
+  BoundaryMasks masks{};
+  for (size_t i = 0; i < count; ++i)
+  {
+    const size_t cut = pos + i;
+    const uint64_t bit = uint64_t{1} << i;
+    const char prev1 = cut >= 1 ? content[cut - 1] : '\0';
+    const char prev2 = cut >= 2 ? content[cut - 2] : '\0';
+
+    if (prev1 == '\n')
+    {
+      masks[BOUNDARY_LINE] |= bit;
+      if (prev2 == '\n')
+      {
+        masks[BOUNDARY_PARAGRAPH] |= bit;
+      }
+    }
+    if (is_space_byte(prev1))
+    {
+      masks[BOUNDARY_WORD] |= bit;
+      if (is_sentence_end_byte(prev2))
+      {
+        masks[BOUNDARY_SENTENCE] |= bit;
+      }
+    }
+    if (cut >= content.size() || !is_utf8_continuation_byte(content[cut]))
+    {
+      masks[BOUNDARY_CHAR] |= bit;
+    }
+  }
+  return masks;
+}
+
+#if defined(ODAI_CHUNKER_SSE2)
+/// Classifies the 16 cuts starting at data with SSE2, ORing them into masks at bit offset shift.
+void scan_lanes_simd(const char* data, unsigned shift, BoundaryMasks& masks)
+{
+  const __m128i prev2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data - 2));
+  const __m128i prev1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data - 1));
+  const __m128i cur = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+
+  const __m128i newline1 = _mm_cmpeq_epi8(prev1, _mm_set1_epi8('\n'));
+  const __m128i newline2 = _mm_cmpeq_epi8(prev2, _mm_set1_epi8('\n'));
+  const __m128i space1 =
+      _mm_or_si128(_mm_cmpeq_epi8(prev1, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(prev1, _mm_set1_epi8('\t')));
+  const __m128i sentence_end2 =
+      _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(prev2, _mm_set1_epi8('.')), _mm_cmpeq_epi8(prev2, _mm_set1_epi8('!'))),
+                   _mm_cmpeq_epi8(prev2, _mm_set1_epi8('?')));
+  // continuation bytes 0x80..0xBF are exactly the signed bytes below -64
+  const __m128i continuation = _mm_cmplt_epi8(cur, _mm_set1_epi8(-64));
+
+  auto to_mask = [shift](__m128i lanes) { return static_cast<uint64_t>(_mm_movemask_epi8(lanes)) << shift; };
+  masks[BOUNDARY_PARAGRAPH] |= to_mask(_mm_and_si128(newline1, newline2));
+  masks[BOUNDARY_LINE] |= to_mask(newline1);
+  masks[BOUNDARY_SENTENCE] |= to_mask(_mm_and_si128(space1, sentence_end2));
+  masks[BOUNDARY_WORD] |= to_mask(space1);
+  masks[BOUNDARY_CHAR] |= to_mask(_mm_xor_si128(continuation, _mm_set1_epi8(-1)));
+}
+#elif defined(ODAI_CHUNKER_NEON)
+/// Packs the top bit of each byte lane into a 16 bit mask, like _mm_movemask_epi8.
+uint64_t neon_movemask(uint8x16_t lanes)
+{
+  static const uint8_t LANE_BITS[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+  const uint8x16_t bits = vandq_u8(lanes, vld1q_u8(LANE_BITS));
+  const auto low = static_cast<uint64_t>(vaddv_u8(vget_low_u8(bits)));
+  const auto high = static_cast<uint64_t>(vaddv_u8(vget_high_u8(bits)));
+  return low | (high << 8);
+}
+
+/// Classifies the 16 cuts starting at data with NEON, ORing them into masks at bit offset shift.
+void scan_lanes_simd(const char* data, unsigned shift, BoundaryMasks& masks)
+{
+  const auto* bytes = reinterpret_cast<const uint8_t*>(data);
+  const uint8x16_t prev2 = vld1q_u8(bytes - 2);
+  const uint8x16_t prev1 = vld1q_u8(bytes - 1);
+  const uint8x16_t cur = vld1q_u8(bytes);
+
+  const uint8x16_t newline1 = vceqq_u8(prev1, vdupq_n_u8('\n'));
+  const uint8x16_t newline2 = vceqq_u8(prev2, vdupq_n_u8('\n'));
+  const uint8x16_t space1 = vorrq_u8(vceqq_u8(prev1, vdupq_n_u8(' ')), vceqq_u8(prev1, vdupq_n_u8('\t')));
+  const uint8x16_t sentence_end2 =
+      vorrq_u8(vorrq_u8(vceqq_u8(prev2, vdupq_n_u8('.')), vceqq_u8(prev2, vdupq_n_u8('!'))),
+               vceqq_u8(prev2, vdupq_n_u8('?')));
+  const uint8x16_t char_start = vmvnq_u8(vceqq_u8(vandq_u8(cur, vdupq_n_u8(0xC0)), vdupq_n_u8(0x80)));
+
+  masks[BOUNDARY_PARAGRAPH] |= neon_movemask(vandq_u8(newline1, newline2)) << shift;
+  masks[BOUNDARY_LINE] |= neon_movemask(newline1) << shift;
+  masks[BOUNDARY_SENTENCE] |= neon_movemask(vandq_u8(space1, sentence_end2)) << shift;
+  masks[BOUNDARY_WORD] |= neon_movemask(space1) << shift;
+  masks[BOUNDARY_CHAR] |= neon_movemask(char_start) << shift;
+}
+#endif
+
+/// Classifies the cuts [pos, pos + count), count <= BOUNDARY_BLOCK_SIZE, using SIMD whenever the loads stay in bounds.
+BoundaryMasks scan_boundaries(std::string_view content, size_t pos, size_t count)
+{
+#if defined(ODAI_CHUNKER_SSE2) || defined(ODAI_CHUNKER_NEON)
+  if (pos >= 2 && pos + BOUNDARY_BLOCK_SIZE <= content.size())
+  {
+    BoundaryMasks masks{};
+    for (unsigned lane = 0; lane < BOUNDARY_BLOCK_SIZE; lane += 16)
+    {
+      scan_lanes_simd(content.data() + pos + lane, lane, masks);
+    }
+
+    const uint64_t window = count >= BOUNDARY_BLOCK_SIZE ? ~uint64_t{0} : ((uint64_t{1} << count) - 1);
+    for (uint64_t& mask : masks)
+    {
+      mask &= window;
+    }
+    return masks;
+  }
+#endif
+  return scan_boundaries_scalar(content, pos, count);
+}
+
+/// Finds the preferred cut in [lo, hi]: the boundary of the best class present, the one nearest to hi.
+/// @return the cut position, or std::string_view::npos if [lo, hi] holds no boundary at all
+size_t find_boundary_backward(std::string_view content, size_t lo, size_t hi)
+{
+  std::array<size_t, BOUNDARY_CLASS_COUNT> best;
+  best.fill(std::string_view::npos);
+
+  // scan from hi down, so the first cut found in a class is the nearest one
+  size_t block_end = hi + 1;
+  while (block_end > lo)
+  {
+    const size_t block_start = block_end - std::min(BOUNDARY_BLOCK_SIZE, block_end - lo);
+    const BoundaryMasks masks = scan_boundaries(content, block_start, block_end - block_start);
+    for (size_t boundary_class = 0; boundary_class < BOUNDARY_CLASS_COUNT; ++boundary_class)
+    {
+      if (best[boundary_class] == std::string_view::npos && masks[boundary_class] != 0)
+      {
+        best[boundary_class] = block_start + (63 - std::countl_zero(masks[boundary_class]));
+      }
+    }
+    if (best[BOUNDARY_PARAGRAPH] != std::string_view::npos)
+    {
+      break;
+    }
+    block_end = block_start;
+  }
+
+  for (size_t cut : best)
+  {
+    if (cut != std::string_view::npos)
+    {
+      return cut;
+    }
+  }
+  return std::string_view::npos;
+}
+
+/// Finds the first word (or stronger) boundary in [lo, hi], falling back to the first UTF-8 character boundary.
+/// @return the cut position, or std::string_view::npos if [lo, hi] holds no boundary at all
+size_t find_boundary_forward(std::string_view content, size_t lo, size_t hi)
+{
+  size_t first_char_boundary = std::string_view::npos;
+  for (size_t block_start = lo; block_start <= hi; block_start += BOUNDARY_BLOCK_SIZE)
+  {
+    const size_t count = std::min(BOUNDARY_BLOCK_SIZE, hi + 1 - block_start);
+    const BoundaryMasks masks = scan_boundaries(content, block_start, count);
+    // every paragraph and sentence boundary is also a line or word boundary
+    const uint64_t word_or_stronger = masks[BOUNDARY_LINE] | masks[BOUNDARY_WORD];
+    if (word_or_stronger != 0)
+    {
+      return block_start + std::countr_zero(word_or_stronger);
+    }
+    if (first_char_boundary == std::string_view::npos && masks[BOUNDARY_CHAR] != 0)
+    {
+      first_char_boundary = block_start + std::countr_zero(masks[BOUNDARY_CHAR]);
+    }
+  }
+  return first_char_boundary;
+}
+
+/// Cuts fixed size chunks from content starting at start, advancing start and sequence_index past emitted chunks.
+/// Unless final_part is set, stops at the first chunk whose edges could still move once more content is appended.
+void emit_fixed_size_chunks(std::string_view content, bool final_part, size_t chunk_size, size_t overlap, size_t& start,
+                            uint32_t& sequence_index, std::vector<DocumentChunk>& out)
+{
+  if (chunk_size == 0)
+  {
+    return;
+  }
+
+  // Until the final part, a chunk is only cut when the buffer extends past its end by more than one UTF-8 character,
+  // so boundary snapping sees the same bytes it would see in the whole content.
+  constexpr size_t MAX_UTF8_CHAR_BYTES = 4;
+
+  while (start < content.size())
+  {
+    if (!final_part && content.size() - start <= chunk_size + MAX_UTF8_CHAR_BYTES)
+    {
+      return;
+    }
+
+    size_t end = std::min(start + chunk_size, content.size());
+    end = snap_to_char_boundary_backward(content, end, start);
+    if (end == start)
+    {
+      // chunk size smaller than a single character, take the whole character
+      end = snap_to_char_boundary_forward(content, start + 1);
+    }
+
+    out.push_back(make_chunk(content.substr(start, end - start), sequence_index++));
+
+    if (end == content.size())
+    {
+      start = content.size();
+      return;
+    }
+
+    size_t next_start = snap_to_char_boundary_forward(content, end - std::min(overlap, end - start));
+    // always make progress, even when the overlap covers the whole chunk after boundary snapping
+    start = std::max(next_start, start + 1);
+    start = snap_to_char_boundary_forward(content, start);
+  }
+}
+
+/// Longest piece of content tokenized on its own by token aware chunking, longer words are split
+constexpr size_t MAX_TOKEN_UNIT_BYTES = 64;
+
+bool is_whitespace_byte(char byte)
+{
+  return byte == ' ' || byte == '\t' || byte == '\n' || byte == '\r' || byte == '\f' || byte == '\v';
+}
+
+/// Splits content into consecutive units of a whitespace run followed by a word, each at most max_unit_bytes long
+/// unless a single UTF-8 character is longer. The units concatenate back to the content.
+std::vector<std::string> split_token_units(std::string_view content, size_t max_unit_bytes)
+{
+  std::vector<std::string> units;
+  size_t start = 0;
+  while (start < content.size())
+  {
+    size_t pos = start;
+    while (pos < content.size() && is_whitespace_byte(content[pos]))
+    {
+      pos++;
+    }
+    while (pos < content.size() && !is_whitespace_byte(content[pos]))
+    {
+      pos++;
+    }
+
+    size_t end = pos;
+    if (end - start > max_unit_bytes)
+    {
+      end = snap_to_char_boundary_backward(content, start + max_unit_bytes, start);
+      if (end == start)
+      {
+        end = snap_to_char_boundary_forward(content, start + 1);
+      }
+    }
+
+    units.emplace_back(content.substr(start, end - start));
+    start = end;
+  }
+  return units;
+}
+} // namespace
+
+FixedSizeChunker::FixedSizeChunker(const FixedSizeChunkingConfig& config)
+    : m_chunkSize(config.m_chunkSize),
+      m_overlap(config.m_chunkSize == 0 ? 0 : std::min<size_t>(config.m_chunkOverlap, config.m_chunkSize - 1))
+{
+}
+
+void FixedSizeChunker::feed(std::string_view content_part, std::vector<DocumentChunk>& out)
+{
+  m_buffer.append(content_part);
+  emit_fixed_size_chunks(m_buffer, false, m_chunkSize, m_overlap, m_start, m_nextSequenceIndex, out);
+
+  // compact once per part instead of once per chunk, keeps feeding linear in the content size
+  m_buffer.erase(0, m_start);
+  m_start = 0;
+}
+
+void FixedSizeChunker::finish(std::vector<DocumentChunk>& out)
+{
+  emit_fixed_size_chunks(m_buffer, true, m_chunkSize, m_overlap, m_start, m_nextSequenceIndex, out);
+
+  m_buffer.clear();
+  m_start = 0;
+  m_nextSequenceIndex = 0;
+}
+
+std::vector<DocumentChunk> chunk_fixed_size(std::string_view content, const FixedSizeChunkingConfig& config)
+{
+  std::vector<DocumentChunk> chunks;
+
+  if (content.empty() || config.m_chunkSize == 0)
+  {
+    return chunks;
+  }
+
+  const size_t chunk_size = config.m_chunkSize;
+  const size_t overlap = std::min<size_t>(config.m_chunkOverlap, chunk_size - 1);
+  chunks.reserve((content.size() / (chunk_size - overlap)) + 1);
+
+  size_t start = 0;
+  uint32_t sequence_index = 0;
+  emit_fixed_size_chunks(content, true, chunk_size, overlap, start, sequence_index, chunks);
+  return chunks;
+}
+
+std::vector<DocumentChunk> chunk_boundary_aware(std::string_view content, const BoundaryAwareChunkingConfig& config)
+{
+  std::vector<DocumentChunk> chunks;
+
+  if (content.empty() || config.m_chunkSize == 0)
+  {
+    return chunks;
+  }
+
+  const size_t chunk_size = config.m_chunkSize;
+  const size_t overlap = std::min<size_t>(config.m_chunkOverlap, chunk_size - 1);
+  const size_t tolerance = std::min<size_t>(config.m_boundaryTolerance, chunk_size - 1);
+  chunks.reserve((content.size() / (chunk_size - overlap)) + 1);
+
+  size_t start = 0;
+  while (start < content.size())
+  {
+    size_t end = content.size();
+    if (start + chunk_size < content.size())
+    {
+      const size_t target = start + chunk_size;
+      end = find_boundary_backward(content, std::max(start + 1, target - tolerance), target);
+      if (end == std::string_view::npos)
+      {
+        end = snap_to_char_boundary_backward(content, target, start);
+        if (end == start)
+        {
+          // chunk size smaller than a single character, take the whole character
+          end = snap_to_char_boundary_forward(content, start + 1);
+        }
+      }
+    }
+
+    chunks.push_back(make_chunk(content.substr(start, end - start), static_cast<uint32_t>(chunks.size())));
+
+    if (end == content.size())
+    {
+      break;
+    }
+
+    size_t next_start = end;
+    if (overlap > 0)
+    {
+      // start the overlap at a word boundary too, without moving it past the end of the previous chunk
+      const size_t overlap_start = end - std::min(overlap, end - start);
+      next_start = find_boundary_forward(content, overlap_start, std::min(overlap_start + tolerance, end - 1));
+      if (next_start == std::string_view::npos)
+      {
+        next_start = snap_to_char_boundary_forward(content, overlap_start);
+      }
+    }
+    // always make progress, even when the overlap covers the whole chunk after boundary snapping
+    start = std::max(next_start, start + 1);
+    start = snap_to_char_boundary_forward(content, start);
+  }
+
+  return chunks;
+}
+
+OdaiResult<std::vector<DocumentChunk>> chunk_token_aware(std::string_view content,
+                                                         const TokenAwareChunkingConfig& config,
+                                                         const ChunkTokenizerFn& tokenizer)
+{
+  std::vector<DocumentChunk> chunks;
+
+  if (content.empty() || config.m_chunkSize == 0)
+  {
+    return chunks;
+  }
+
+  if (!tokenizer)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Token aware chunking needs the embedding model's tokenizer");
+    return tl::unexpected(OdaiResultEnum::INVALID_ARGUMENT);
+  }
+
+  const size_t chunk_size = config.m_chunkSize;
+  const size_t overlap = std::min<size_t>(config.m_chunkOverlap, chunk_size - 1);
+
+  // a word usually has fewer tokens than bytes, capping units below the chunk size keeps every unit within one chunk
+  const std::vector<std::string> units =
+      split_token_units(content, std::clamp<size_t>(chunk_size - 1, 1, MAX_TOKEN_UNIT_BYTES));
+
+  OdaiResult<std::vector<std::vector<TokenId>>> tokens_res = tokenizer(units);
+  if (!tokens_res)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to tokenize content for token aware chunking, error code: {}",
+             static_cast<std::uint32_t>(tokens_res.error()));
+    return tl::unexpected(tokens_res.error());
+  }
+  const std::vector<std::vector<TokenId>>& unit_tokens = tokens_res.value();
+  if (unit_tokens.size() != units.size())
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Tokenizer returned {} token lists for {} texts", unit_tokens.size(), units.size());
+    return unexpected_internal_error();
+  }
+
+  // token_prefix[i] / byte_prefix[i] = tokens / bytes of units before unit i
+  std::vector<size_t> token_prefix(units.size() + 1, 0);
+  std::vector<size_t> byte_prefix(units.size() + 1, 0);
+  for (size_t i = 0; i < units.size(); ++i)
+  {
+    token_prefix[i + 1] = token_prefix[i] + unit_tokens[i].size();
+    byte_prefix[i + 1] = byte_prefix[i] + units[i].size();
+  }
+
+  size_t start = 0;
+  while (start < units.size())
+  {
+    // greedily take units while they fit, a unit larger than the chunk size still makes a chunk of its own
+    size_t end = start + 1;
+    while (end < units.size() && token_prefix[end + 1] - token_prefix[start] <= chunk_size)
+    {
+      end++;
+    }
+
+    const size_t token_count = token_prefix[end] - token_prefix[start];
+    if (token_count > 0)
+    {
+      DocumentChunk chunk = make_chunk(content.substr(byte_prefix[start], byte_prefix[end] - byte_prefix[start]),
+                                       static_cast<uint32_t>(chunks.size()));
+      chunk.m_tokenCount = static_cast<uint32_t>(token_count);
+      chunk.m_tokenIds.reserve(token_count);
+      for (size_t i = start; i < end; ++i)
+      {
+        chunk.m_tokenIds.insert(chunk.m_tokenIds.end(), unit_tokens[i].begin(), unit_tokens[i].end());
+      }
+      chunks.push_back(std::move(chunk));
+    }
+
+    if (end == units.size())
+    {
+      break;
+    }
+
+    // the next chunk repeats the trailing units of this one that fit in the overlap, always making progress
+    size_t next_start = end;
+    while (next_start - 1 > start && token_prefix[end] - token_prefix[next_start - 1] <= overlap)
+    {
+      next_start--;
+    }
+    start = next_start;
+  }
+
+  return chunks;
+}
+
+OdaiResult<std::vector<DocumentChunk>> chunk_document(std::string_view content, const ChunkingConfig& config,
+                                                      const ChunkTokenizerFn& tokenizer)
+{
+  if (!config.is_sane())
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Invalid chunking config passed");
+    return tl::unexpected(OdaiResultEnum::INVALID_ARGUMENT);
+  }
+
+  if (std::holds_alternative<FixedSizeChunkingConfig>(config.m_config))
+  {
+    return chunk_fixed_size(content, std::get<FixedSizeChunkingConfig>(config.m_config));
+  }
+  if (std::holds_alternative<BoundaryAwareChunkingConfig>(config.m_config))
+  {
+    return chunk_boundary_aware(content, std::get<BoundaryAwareChunkingConfig>(config.m_config));
+  }
+  if (std::holds_alternative<TokenAwareChunkingConfig>(config.m_config))
+  {
+    return chunk_token_aware(content, std::get<TokenAwareChunkingConfig>(config.m_config), tokenizer);
+  }
+
+  ODAI_LOG(ODAI_LOG_ERROR, "Unsupported chunking strategy");
+  return tl::unexpected(OdaiResultEnum::INVALID_ARGUMENT);
+}
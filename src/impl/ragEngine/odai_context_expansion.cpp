@@ -0,0 +1,162 @@
+#include "ragEngine/odai_context_expansion.h"
+
+#include "odai_logger.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+namespace
+{
+/// A merged window, with the position of the most relevant retrieved chunk inside it
+struct MergedSpan
+{
+  DocumentChunkSpan m_span;
+  size_t m_bestChunk{};
+};
+} // namespace
+
+void append_without_overlap(std::string& passage, std::string_view next_chunk)
+{
+  // the overlap can't be longer than the chunk, only the passage's tail of that length needs matching
+  const size_t tail_size = std::min(passage.size(), next_chunk.size());
+  if (tail_size == 0)
+  {
+    passage += next_chunk;
+    return;
+  }
+
+  // KMP failure function of the chunk, then match the chunk against the tail; the state after the last byte is the
+  // length of the longest chunk prefix ending the passage
+  std::vector<size_t> failure(tail_size, 0);
+  for (size_t i = 1, k = 0; i < tail_size; ++i)
+  {
+    while (k > 0 && next_chunk[i] != next_chunk[k])
+    {
+      k = failure[k - 1];
+    }
+    if (next_chunk[i] == next_chunk[k])
+    {
+      ++k;
+    }
+    failure[i] = k;
+  }
+
+  size_t matched = 0;
+  for (size_t i = passage.size() - tail_size; i < passage.size(); ++i)
+  {
+    while (matched > 0 && (matched == tail_size || passage[i] != next_chunk[matched]))
+    {
+      matched = failure[matched - 1];
+    }
+    if (passage[i] == next_chunk[matched])
+    {
+      ++matched;
+    }
+  }
+
+  passage += next_chunk.substr(matched);
+}
+
+OdaiResult<std::vector<RetrievedChunk>> expand_chunk_context(std::vector<RetrievedChunk> chunks, uint32_t context_window,
+                                                             bool chunks_overlap, const ChunkSpanReadFn& read_fn)
+{
+  if (context_window == 0 || chunks.empty())
+  {
+    return chunks;
+  }
+
+  // visit the windows grouped by document in position order, so overlapping ones are next to each other
+  std::vector<size_t> order(chunks.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+            [&](size_t a, size_t b)
+            {
+              if (chunks[a].m_documentId != chunks[b].m_documentId)
+              {
+                return chunks[a].m_documentId < chunks[b].m_documentId;
+              }
+              return chunks[a].m_sequenceIndex < chunks[b].m_sequenceIndex;
+            });
+
+  std::vector<MergedSpan> merged;
+  for (size_t index : order)
+  {
+    const RetrievedChunk& chunk = chunks[index];
+    const uint32_t first = chunk.m_sequenceIndex - std::min(chunk.m_sequenceIndex, context_window);
+    const uint32_t last =
+        chunk.m_sequenceIndex + std::min(context_window, std::numeric_limits<uint32_t>::max() - chunk.m_sequenceIndex);
+
+    // windows that touch are merged too, their chunks are consecutive in the document
+    if (!merged.empty() && merged.back().m_span.m_documentId == chunk.m_documentId &&
+        (merged.back().m_span.m_lastSequenceIndex == std::numeric_limits<uint32_t>::max() ||
+         first <= merged.back().m_span.m_lastSequenceIndex + 1))
+    {
+      MergedSpan& span = merged.back();
+      span.m_span.m_lastSequenceIndex = std::max(span.m_span.m_lastSequenceIndex, last);
+      span.m_bestChunk = std::min(span.m_bestChunk, index);
+      continue;
+    }
+    merged.push_back({{chunk.m_documentId, first, last}, index});
+  }
+
+  // passages keep the relevance order of their best chunks
+  std::sort(merged.begin(), merged.end(),
+            [](const MergedSpan& a, const MergedSpan& b) { return a.m_bestChunk < b.m_bestChunk; });
+
+  std::vector<DocumentChunkSpan> spans;
+  spans.reserve(merged.size());
+  for (const MergedSpan& span : merged)
+  {
+    spans.push_back(span.m_span);
+  }
+
+  OdaiResult<std::vector<std::vector<DocumentChunk>>> read_res = read_fn(spans);
+  if (!read_res)
+  {
+    return tl::unexpected(read_res.error());
+  }
+  if (read_res->size() != spans.size())
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Chunk span read returned {} spans for {} requested", read_res->size(), spans.size());
+    return unexpected_internal_error();
+  }
+
+  std::vector<RetrievedChunk> passages;
+  passages.reserve(merged.size());
+  for (size_t i = 0; i < merged.size(); ++i)
+  {
+    RetrievedChunk& best = chunks[merged[i].m_bestChunk];
+    const std::vector<DocumentChunk>& span_chunks = read_res.value()[i];
+    if (span_chunks.empty())
+    {
+      ODAI_LOG(ODAI_LOG_WARN, "No chunks left around chunk {} of document {}, keeping it alone", best.m_sequenceIndex,
+               best.m_documentId);
+      best.m_embedding = {};
+      passages.push_back(std::move(best));
+      continue;
+    }
+
+    RetrievedChunk passage;
+    passage.m_documentId = best.m_documentId;
+    passage.m_sourceUri = best.m_sourceUri;
+    passage.m_score = best.m_score;
+    passage.m_sequenceIndex = span_chunks.front().m_sequenceIndex;
+    passage.m_sequenceCount = static_cast<uint32_t>(span_chunks.size());
+    for (size_t c = 0; c < span_chunks.size(); ++c)
+    {
+      const bool consecutive = c > 0 && span_chunks[c].m_sequenceIndex == span_chunks[c - 1].m_sequenceIndex + 1;
+      if (chunks_overlap && consecutive)
+      {
+        append_without_overlap(passage.m_contentText, span_chunks[c].m_contentText);
+      }
+      else
+      {
+        passage.m_contentText += span_chunks[c].m_contentText;
+      }
+    }
+    passages.push_back(std::move(passage));
+  }
+
+  return passages;
+}
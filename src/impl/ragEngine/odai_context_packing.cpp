@@ -0,0 +1,24 @@
+#include "ragEngine/odai_context_packing.h"
+
+#include <algorithm>
+
+std::vector<RetrievedChunk> pack_chunks_into_budget(std::vector<RetrievedChunk> chunks,
+                                                    const std::vector<uint32_t>& token_counts, uint32_t token_budget,
+                                                    uint32_t& used_tokens)
+{
+  used_tokens = 0;
+  const size_t count = std::min(chunks.size(), token_counts.size());
+
+  std::vector<RetrievedChunk> packed;
+  packed.reserve(count);
+  for (size_t i = 0; i < count; ++i)
+  {
+    if (token_counts[i] > token_budget - used_tokens)
+    {
+      continue;
+    }
+    used_tokens += token_counts[i];
+    packed.push_back(std::move(chunks[i]));
+  }
+  return packed;
+}
@@ -0,0 +1,32 @@
+#include "ragEngine/odai_embedding_truncation.h"
+
+#include <cmath>
+
+bool truncate_embedding(std::vector<float>& embedding, uint32_t dimensions)
+{
+  // backends already normalize the full embedding
+  if (dimensions == 0 || dimensions == embedding.size())
+  {
+    return true;
+  }
+  if (dimensions > embedding.size())
+  {
+    return false;
+  }
+
+  embedding.resize(dimensions);
+  double sum = 0.0;
+  for (const float value : embedding)
+  {
+    sum += static_cast<double>(value) * value;
+  }
+  if (sum > 0.0)
+  {
+    const auto inverse_norm = static_cast<float>(1.0 / std::sqrt(sum));
+    for (float& value : embedding)
+    {
+      value *= inverse_norm;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,678 @@
+#include "ragEngine/odai_ingest_pipeline.h"
+
+#include "odai_logger.h"
+#include "ragEngine/odai_chunker.h"
+#include "ragEngine/odai_embedding_truncation.h"
+
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+OdaiIngestPipeline::OdaiIngestPipeline(IOdaiDb& db, IOdaiBackendEngine& backend_engine,
+                                       SemanticSpaceConfig space_config, ModelFiles embedding_model_files,
+                                       std::string embedding_model_checksums, ScopeId scope_id,
+                                       const BulkIngestConfig& config)
+    : m_db(db), m_backendEngine(backend_engine), m_spaceConfig(std::move(space_config)),
+      m_embeddingModelFiles(std::move(embedding_model_files)),
+      m_embeddingModelChecksums(std::move(embedding_model_checksums)), m_scopeId(std::move(scope_id)), m_config(config),
+      m_readQueue(config.m_queueCapacity), m_chunkQueue(config.m_queueCapacity),
+      m_dedupeQueue(config.m_queueCapacity), m_embedQueue(config.m_queueCapacity)
+{
+  uint32_t chunker_threads = m_config.m_chunkerThreads;
+  if (chunker_threads == 0)
+  {
+    chunker_threads = std::max(1U, std::thread::hardware_concurrency());
+  }
+
+  m_stageCounters[INGEST_STAGE_READ].m_workers = m_config.m_readerThreads;
+  m_stageCounters[INGEST_STAGE_CHUNK].m_workers = chunker_threads;
+  m_stageCounters[INGEST_STAGE_DEDUPE].m_workers = 1;
+  m_stageCounters[INGEST_STAGE_EMBED].m_workers = 1;
+  m_stageCounters[INGEST_STAGE_WRITE].m_workers = 1;
+}
+
+OdaiResult<BulkIngestStats> OdaiIngestPipeline::run(const std::vector<IngestDocumentSource>& sources)
+{
+  const auto start = std::chrono::steady_clock::now();
+
+  m_activeReaders = m_stageCounters[INGEST_STAGE_READ].m_workers;
+  m_activeChunkers = m_stageCounters[INGEST_STAGE_CHUNK].m_workers;
+
+  std::vector<std::thread> threads;
+  try
+  {
+    for (uint32_t i = 0; i < m_stageCounters[INGEST_STAGE_READ].m_workers; ++i)
+    {
+      threads.emplace_back([this, &sources] { run_worker("read", [this, &sources] { read_worker(sources); }); });
+    }
+    for (uint32_t i = 0; i < m_stageCounters[INGEST_STAGE_CHUNK].m_workers; ++i)
+    {
+      threads.emplace_back([this] { run_worker("chunk", [this] { chunk_worker(); }); });
+    }
+    threads.emplace_back([this] { run_worker("dedupe", [this] { dedupe_worker(); }); });
+    threads.emplace_back([this] { run_worker("embed", [this] { embed_worker(); }); });
+    threads.emplace_back([this] { run_worker("write", [this] { write_worker(); }); });
+  }
+  catch (const std::exception& e)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to start ingestion pipeline threads: {}", e.what());
+    abort();
+  }
+
+  for (std::thread& thread : threads)
+  {
+    thread.join();
+  }
+
+  if (m_aborted)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Ingestion pipeline aborted after ingesting {} documents", m_documentsIngested.load());
+    return unexpected_internal_error();
+  }
+
+  const double elapsed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  BulkIngestStats stats = collect_stats(elapsed_seconds);
+
+  ODAI_LOG(ODAI_LOG_INFO, "Bulk ingestion done: {} documents ingested, {} failed, {} chunks, {} embedded in {:.2f}s",
+           stats.m_documentsIngested, stats.m_documentsFailed, stats.m_chunksProcessed, stats.m_chunksEmbedded,
+           stats.m_elapsedSeconds);
+  return stats;
+}
+
+template <typename Fn>
+void OdaiIngestPipeline::run_worker(const char* stage_name, Fn&& worker_body)
+{
+  try
+  {
+    worker_body();
+  }
+  catch (const std::exception& e)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Ingestion {} worker failed: {}", stage_name, e.what());
+    abort();
+  }
+  catch (...)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Ingestion {} worker failed with unknown exception", stage_name);
+    abort();
+  }
+}
+
+void OdaiIngestPipeline::abort()
+{
+  m_aborted = true;
+  m_readQueue.close();
+  m_chunkQueue.close();
+  m_dedupeQueue.close();
+  m_embedQueue.close();
+}
+
+void OdaiIngestPipeline::read_worker(const std::vector<IngestDocumentSource>& sources)
+{
+  while (!m_aborted)
+  {
+    const size_t index = m_nextSourceIndex.fetch_add(1);
+    if (index >= sources.size())
+    {
+      break;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const IngestDocumentSource& source = sources[index];
+
+    std::ifstream file(source.m_filePath, std::ios::binary);
+    if (!file)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Failed to open document file: {}", source.m_filePath);
+      record_failure(source.m_documentId, OdaiResultEnum::NOT_FOUND);
+      continue;
+    }
+
+    PipelineDocument document;
+    document.m_documentId = source.m_documentId;
+    document.m_sourceUri = source.m_filePath;
+    document.m_metadata = source.m_metadata;
+    document.m_content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    record_busy(INGEST_STAGE_READ, start, 1);
+
+    if (!m_readQueue.push(std::move(document)))
+    {
+      break;
+    }
+  }
+
+  // last reader out closes the queue so chunkers can drain and stop
+  if (m_activeReaders.fetch_sub(1) == 1)
+  {
+    m_readQueue.close();
+  }
+}
+
+void OdaiIngestPipeline::chunk_worker()
+{
+  const ChunkTokenizerFn tokenizer =
+      [this](const std::vector<std::string>& texts) -> OdaiResult<std::vector<std::vector<TokenId>>>
+  {
+    std::lock_guard<std::mutex> lock(m_backendMutex);
+    return m_backendEngine.tokenize_embedding_texts(texts, m_spaceConfig.m_embeddingModelConfig,
+                                                    m_embeddingModelFiles);
+  };
+
+  while (std::optional<PipelineDocument> document = m_readQueue.pop())
+  {
+    const auto start = std::chrono::steady_clock::now();
+
+    OdaiResult<std::vector<DocumentChunk>> chunks_res =
+        chunk_document(document->m_content, m_spaceConfig.m_chunkingConfig, tokenizer);
+    if (!chunks_res || chunks_res->empty())
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Failed to chunk document: {}", document->m_documentId);
+      record_failure(document->m_documentId, chunks_res ? OdaiResultEnum::VALIDATION_FAILED : chunks_res.error());
+      continue;
+    }
+
+    document->m_chunks = std::move(chunks_res.value());
+    // the chunks own their text from here on, release the raw content early to keep the queues small
+    std::string().swap(document->m_content);
+    record_busy(INGEST_STAGE_CHUNK, start, 1);
+
+    if (!m_chunkQueue.push(std::move(document.value())))
+    {
+      break;
+    }
+  }
+
+  if (m_activeChunkers.fetch_sub(1) == 1)
+  {
+    m_chunkQueue.close();
+  }
+}
+
+void OdaiIngestPipeline::dedupe_worker()
+{
+  std::vector<uint64_t> content_hashes;
+
+  while (std::optional<PipelineDocument> document = m_chunkQueue.pop())
+  {
+    const auto start = std::chrono::steady_clock::now();
+
+    content_hashes.clear();
+    for (const DocumentChunk& chunk : document->m_chunks)
+    {
+      content_hashes.push_back(chunk.m_contentHash);
+    }
+
+    OdaiResult<std::unordered_set<uint64_t>> unembedded_res;
+    {
+      std::lock_guard<std::mutex> lock(m_dbMutex);
+      unembedded_res = m_db.get_unembedded_chunk_hashes(m_spaceConfig.m_name, content_hashes);
+    }
+    if (!unembedded_res)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Failed to look up embedded chunks for document: {}", document->m_documentId);
+      record_failure(document->m_documentId, unembedded_res.error());
+      continue;
+    }
+
+    // a content not embedded yet is embedded by the first document of this run that contains it, later documents
+    // reuse that embedding once it is written since the embed and write stages preserve this order
+    for (size_t i = 0; i < document->m_chunks.size(); ++i)
+    {
+      const uint64_t content_hash = document->m_chunks[i].m_contentHash;
+      if (unembedded_res->contains(content_hash) && m_claimedHashes.insert(content_hash).second)
+      {
+        document->m_chunksToEmbed.push_back(i);
+        document->m_claimedHashes.push_back(content_hash);
+      }
+    }
+    // no later document has seen the claims of a document failing here, the next one containing them claims them
+    auto unclaim = [this, &document]
+    {
+      for (uint64_t content_hash : document->m_claimedHashes)
+      {
+        m_claimedHashes.erase(content_hash);
+      }
+    };
+
+    // claimed contents the embedding model file embedded before skip the embed stage
+    OdaiResult<std::unordered_map<uint64_t, std::vector<float>>> stored_res;
+    if (!document->m_claimedHashes.empty())
+    {
+      std::lock_guard<std::mutex> lock(m_dbMutex);
+      stored_res = m_db.get_stored_chunk_embeddings(m_embeddingModelChecksums, document->m_claimedHashes);
+    }
+    if (!stored_res)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Failed to look up stored embeddings for document: {}", document->m_documentId);
+      unclaim();
+      record_failure(document->m_documentId, stored_res.error());
+      continue;
+    }
+    if (!stored_res->empty() && !take_stored_embeddings(document.value(), stored_res.value()))
+    {
+      unclaim();
+      record_failure(document->m_documentId, OdaiResultEnum::VALIDATION_FAILED);
+      continue;
+    }
+    m_chunksProcessed += document->m_chunks.size();
+    record_busy(INGEST_STAGE_DEDUPE, start, 1);
+
+    if (!m_dedupeQueue.push(std::move(document.value())))
+    {
+      break;
+    }
+  }
+
+  m_dedupeQueue.close();
+}
+
+bool OdaiIngestPipeline::take_stored_embeddings(PipelineDocument& document,
+                                                std::unordered_map<uint64_t, std::vector<float>>& stored_embeddings)
+{
+  bool fits = true;
+  std::erase_if(document.m_chunksToEmbed,
+                [&](size_t chunk_index)
+                {
+                  DocumentChunk& chunk = document.m_chunks[chunk_index];
+                  auto it = stored_embeddings.find(chunk.m_contentHash);
+                  if (it == stored_embeddings.end())
+                  {
+                    return false;
+                  }
+                  std::vector<float>& embedding = it->second;
+                  if ((m_spaceConfig.m_dimensions != 0 && embedding.size() != m_spaceConfig.m_dimensions) ||
+                      !truncate_embedding(embedding, m_spaceConfig.m_truncatedDimensions))
+                  {
+                    fits = false;
+                    return false;
+                  }
+                  chunk.m_embedding = std::move(embedding);
+                  return true;
+                });
+
+  if (!fits)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Stored embeddings of document {} don't fit semantic space {}", document.m_documentId,
+             m_spaceConfig.m_name);
+  }
+  return fits;
+}
+
+void OdaiIngestPipeline::embed_worker()
+{
+  std::vector<PipelineDocument> batch;
+
+  while (std::optional<PipelineDocument> document = m_dedupeQueue.pop())
+  {
+    if (m_aborted)
+    {
+      return;
+    }
+
+    // grow the batch with documents that are already waiting, never wait for more to fill it
+    size_t pending_chunks = document->m_chunksToEmbed.size();
+    batch.push_back(std::move(document.value()));
+    while (pending_chunks < m_config.m_embeddingBatchSize)
+    {
+      std::optional<PipelineDocument> next = m_dedupeQueue.try_pop();
+      if (!next)
+      {
+        break;
+      }
+      pending_chunks += next->m_chunksToEmbed.size();
+      batch.push_back(std::move(next.value()));
+    }
+
+    embed_batch(batch);
+
+    for (PipelineDocument& batch_document : batch)
+    {
+      if (!m_embedQueue.push(std::move(batch_document)))
+      {
+        return;
+      }
+    }
+    batch.clear();
+  }
+
+  m_embedQueue.close();
+}
+
+void OdaiIngestPipeline::embed_batch(std::vector<PipelineDocument>& batch)
+{
+  const auto start = std::chrono::steady_clock::now();
+
+  // token aware chunks carry their tokens, embedding those skips tokenizing the text a second time
+  const bool pre_tokenized = std::holds_alternative<TokenAwareChunkingConfig>(m_spaceConfig.m_chunkingConfig.m_config);
+  std::vector<std::string> texts;
+  std::vector<std::vector<TokenId>> token_sequences;
+  std::vector<uint64_t> content_hashes;
+  size_t embed_count = 0;
+  for (PipelineDocument& document : batch)
+  {
+    for (size_t chunk_index : document.m_chunksToEmbed)
+    {
+      content_hashes.push_back(document.m_chunks[chunk_index].m_contentHash);
+      if (pre_tokenized)
+      {
+        token_sequences.push_back(std::move(document.m_chunks[chunk_index].m_tokenIds));
+      }
+      else
+      {
+        texts.push_back(document.m_chunks[chunk_index].m_contentText);
+      }
+      embed_count++;
+    }
+  }
+
+  if (embed_count == 0)
+  {
+    return;
+  }
+
+  OdaiResult<std::vector<std::vector<float>>> embeddings_res;
+  {
+    std::lock_guard<std::mutex> lock(m_backendMutex);
+    embeddings_res = pre_tokenized ? m_backendEngine.generate_embeddings_from_tokens(
+                                         token_sequences, m_spaceConfig.m_embeddingModelConfig, m_embeddingModelFiles)
+                                   : m_backendEngine.generate_embeddings(texts, m_spaceConfig.m_embeddingModelConfig,
+                                                                         m_embeddingModelFiles);
+  }
+
+  OdaiResultEnum batch_error = OdaiResultEnum::INTERNAL_ERROR;
+  bool batch_ok = embeddings_res.has_value() && embeddings_res->size() == embed_count;
+  if (!embeddings_res)
+  {
+    batch_error = embeddings_res.error();
+  }
+  else if (batch_ok && m_spaceConfig.m_dimensions != 0 &&
+           embeddings_res->front().size() != m_spaceConfig.m_dimensions)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Embedding model produced {} dimensions but semantic space {} expects {}",
+             embeddings_res->front().size(), m_spaceConfig.m_name, m_spaceConfig.m_dimensions);
+    batch_ok = false;
+    batch_error = OdaiResultEnum::VALIDATION_FAILED;
+  }
+  else if (batch_ok && embeddings_res->front().size() < m_spaceConfig.m_truncatedDimensions)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Embedding of {} dimensions can't be truncated to {} for semantic space {}",
+             embeddings_res->front().size(), m_spaceConfig.m_truncatedDimensions, m_spaceConfig.m_name);
+    batch_ok = false;
+    batch_error = OdaiResultEnum::VALIDATION_FAILED;
+  }
+
+  if (batch_ok)
+  {
+    // full embeddings, before truncation, for later ingestions with the same model file. Losing them only costs a
+    // forward pass later, so a failure doesn't fail the documents.
+    std::lock_guard<std::mutex> lock(m_dbMutex);
+    OdaiResult<void> store_res =
+        m_db.store_chunk_embeddings(m_embeddingModelChecksums, content_hashes, embeddings_res.value());
+    if (!store_res)
+    {
+      ODAI_LOG(ODAI_LOG_WARN, "Failed to store {} embeddings for reuse, error code: {}", embed_count,
+               static_cast<std::uint32_t>(store_res.error()));
+    }
+  }
+
+  size_t embedding_index = 0;
+  for (PipelineDocument& document : batch)
+  {
+    if (document.m_chunksToEmbed.empty())
+    {
+      continue;
+    }
+
+    if (!batch_ok)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Failed to embed chunks of document: {}", document.m_documentId);
+      finish_claims(document, false);
+      record_failure(document.m_documentId, batch_error);
+      // the write stage skips documents without chunks
+      document.m_chunks.clear();
+      continue;
+    }
+
+    for (size_t chunk_index : document.m_chunksToEmbed)
+    {
+      document.m_chunks[chunk_index].m_embedding = std::move(embeddings_res.value()[embedding_index++]);
+      // the dimension checks above guarantee the truncation fits
+      truncate_embedding(document.m_chunks[chunk_index].m_embedding, m_spaceConfig.m_truncatedDimensions);
+    }
+  }
+
+  if (batch_ok)
+  {
+    m_chunksEmbedded += embed_count;
+  }
+  record_busy(INGEST_STAGE_EMBED, start, embed_count);
+}
+
+void OdaiIngestPipeline::write_worker()
+{
+  std::vector<PipelineDocument> batch;
+
+  while (std::optional<PipelineDocument> document = m_embedQueue.pop())
+  {
+    if (m_aborted)
+    {
+      return;
+    }
+
+    if (!document->m_chunks.empty())
+    {
+      batch.push_back(std::move(document.value()));
+    }
+
+    while (batch.size() < m_config.m_writeBatchSize)
+    {
+      std::optional<PipelineDocument> next = m_embedQueue.try_pop();
+      if (!next)
+      {
+        break;
+      }
+      if (!next->m_chunks.empty())
+      {
+        batch.push_back(std::move(next.value()));
+      }
+    }
+
+    if (!batch.empty())
+    {
+      write_batch(batch);
+      batch.clear();
+    }
+  }
+}
+
+void OdaiIngestPipeline::write_batch(std::vector<PipelineDocument>& batch)
+{
+  const auto start = std::chrono::steady_clock::now();
+  const size_t batch_size = batch.size();
+
+  std::erase_if(batch, [this](PipelineDocument& document) { return !embed_released_chunks(document); });
+
+  if (batch.size() > 1)
+  {
+    std::lock_guard<std::mutex> lock(m_dbMutex);
+    OdaiResult<void> begin_res = m_db.begin_transaction();
+    if (begin_res)
+    {
+      bool batch_ok = true;
+      for (const PipelineDocument& document : batch)
+      {
+        if (!m_db.add_document(document.m_documentId, document.m_sourceUri, m_spaceConfig.m_name, m_scopeId,
+                               document.m_chunks, document.m_metadata))
+        {
+          batch_ok = false;
+          break;
+        }
+      }
+
+      if (batch_ok && m_db.commit_transaction())
+      {
+        for (const PipelineDocument& document : batch)
+        {
+          finish_claims(document, true);
+        }
+        m_documentsIngested += batch.size();
+        record_busy(INGEST_STAGE_WRITE, start, batch_size);
+        return;
+      }
+
+      // a failed add_document already aborted the whole transaction, this also covers a failed commit
+      OdaiResult<void> rollback_res = m_db.rollback_transaction();
+      if (!rollback_res)
+      {
+        ODAI_LOG(ODAI_LOG_WARN, "Rollback of failed ingestion batch failed with error code: {}",
+                 static_cast<std::uint32_t>(rollback_res.error()));
+      }
+    }
+
+    ODAI_LOG(ODAI_LOG_WARN, "Writing a batch of {} documents failed, retrying them one by one", batch.size());
+  }
+
+  for (PipelineDocument& document : batch)
+  {
+    // a document failing before this one may have released contents this one relies on
+    if (!embed_released_chunks(document))
+    {
+      continue;
+    }
+
+    OdaiResult<void> add_res;
+    {
+      std::lock_guard<std::mutex> lock(m_dbMutex);
+      add_res = m_db.add_document(document.m_documentId, document.m_sourceUri, m_spaceConfig.m_name, m_scopeId,
+                                  document.m_chunks, document.m_metadata);
+    }
+    finish_claims(document, add_res.has_value());
+    if (!add_res)
+    {
+      record_failure(document.m_documentId, add_res.error());
+      continue;
+    }
+    m_documentsIngested++;
+  }
+  record_busy(INGEST_STAGE_WRITE, start, batch_size);
+}
+
+bool OdaiIngestPipeline::embed_released_chunks(PipelineDocument& document)
+{
+  document.m_chunksToEmbed.clear();
+  std::vector<uint64_t> released_hashes;
+  {
+    std::lock_guard<std::mutex> lock(m_claimMutex);
+    if (m_releasedHashes.empty())
+    {
+      return true;
+    }
+    for (size_t i = 0; i < document.m_chunks.size(); ++i)
+    {
+      const DocumentChunk& chunk = document.m_chunks[i];
+      if (chunk.m_embedding.empty() && m_releasedHashes.contains(chunk.m_contentHash))
+      {
+        document.m_chunksToEmbed.push_back(i);
+        released_hashes.push_back(chunk.m_contentHash);
+      }
+    }
+  }
+  if (released_hashes.empty())
+  {
+    return true;
+  }
+  // this document takes the claims over, its write settles them
+  document.m_claimedHashes.insert(document.m_claimedHashes.end(), released_hashes.begin(), released_hashes.end());
+
+  // a document failing in the write stage had its embeddings stored for the model already
+  OdaiResult<std::unordered_map<uint64_t, std::vector<float>>> stored_res;
+  {
+    std::lock_guard<std::mutex> lock(m_dbMutex);
+    stored_res = m_db.get_stored_chunk_embeddings(m_embeddingModelChecksums, released_hashes);
+  }
+  if (!stored_res || (!stored_res->empty() && !take_stored_embeddings(document, stored_res.value())))
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to reuse stored embeddings for document: {}", document.m_documentId);
+    finish_claims(document, false);
+    record_failure(document.m_documentId, stored_res ? OdaiResultEnum::VALIDATION_FAILED : stored_res.error());
+    return false;
+  }
+
+  // embed_batch records the failure and clears the chunks of a document it can't embed
+  std::vector<PipelineDocument> single(1);
+  single.front() = std::move(document);
+  embed_batch(single);
+  document = std::move(single.front());
+  return !document.m_chunks.empty();
+}
+
+void OdaiIngestPipeline::finish_claims(const PipelineDocument& document, bool written)
+{
+  if (document.m_claimedHashes.empty())
+  {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(m_claimMutex);
+  for (uint64_t content_hash : document.m_claimedHashes)
+  {
+    if (written)
+    {
+      m_releasedHashes.erase(content_hash);
+    }
+    else
+    {
+      m_releasedHashes.insert(content_hash);
+    }
+  }
+}
+
+void OdaiIngestPipeline::record_failure(const DocumentId& document_id, OdaiResultEnum error)
+{
+  ODAI_LOG(ODAI_LOG_ERROR, "Failed to ingest document: {}, error code: {}", document_id,
+           static_cast<std::uint32_t>(error));
+  m_documentsFailed++;
+}
+
+void OdaiIngestPipeline::record_busy(IngestStage stage, std::chrono::steady_clock::time_point start, uint64_t items)
+{
+  const auto busy = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+  m_stageCounters[stage].m_busyNanoseconds += busy.count();
+  m_stageCounters[stage].m_itemsProcessed += items;
+}
+
+BulkIngestStats OdaiIngestPipeline::collect_stats(double elapsed_seconds) const
+{
+  BulkIngestStats stats;
+  stats.m_documentsIngested = m_documentsIngested;
+  stats.m_documentsFailed = m_documentsFailed;
+  stats.m_chunksProcessed = m_chunksProcessed;
+  stats.m_chunksEmbedded = m_chunksEmbedded;
+  stats.m_elapsedSeconds = elapsed_seconds;
+
+  // the read stage pulls from the source list directly, every other stage has the previous queue as input
+  const std::array<const OdaiBoundedQueue<PipelineDocument>*, INGEST_STAGE_COUNT> input_queues = {
+      nullptr, &m_readQueue, &m_chunkQueue, &m_dedupeQueue, &m_embedQueue};
+
+  for (size_t i = 0; i < INGEST_STAGE_COUNT; ++i)
+  {
+    const StageCounters& counters = m_stageCounters[i];
+    IngestStageStats& stage = stats.m_stages[i];
+
+    stage.m_workers = counters.m_workers;
+    stage.m_itemsProcessed = counters.m_itemsProcessed;
+    stage.m_busySeconds = static_cast<double>(counters.m_busyNanoseconds) / 1e9;
+    if (elapsed_seconds > 0.0)
+    {
+      stage.m_itemsPerSecond = static_cast<double>(stage.m_itemsProcessed) / elapsed_seconds;
+      stage.m_utilization = stage.m_busySeconds / (elapsed_seconds * std::max(1U, stage.m_workers));
+    }
+    if (input_queues[i] != nullptr)
+    {
+      stage.m_maxQueueDepth = static_cast<uint32_t>(input_queues[i]->max_depth());
+      stage.m_avgQueueDepth = input_queues[i]->average_depth();
+    }
+  }
+
+  return stats;
+}
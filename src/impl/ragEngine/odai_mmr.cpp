@@ -0,0 +1,145 @@
+#include "ragEngine/odai_mmr.h"
+
+#include "odai_logger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#define ODAI_MMR_AVX2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define ODAI_MMR_NEON
+#endif
+
+namespace
+{
+/// Dot product of two float arrays of the given length.
+float dot_product(const float* a, const float* b, size_t dimensions)
+{
+  size_t i = 0;
+#if defined(ODAI_MMR_AVX2)
+  // two accumulators hide the fused multiply-add latency
+  __m256 sum0 = _mm256_setzero_ps();
+  __m256 sum1 = _mm256_setzero_ps();
+  for (; i + 16 <= dimensions; i += 16)
+  {
+    sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), sum0);
+    sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), sum1);
+  }
+  for (; i + 8 <= dimensions; i += 8)
+  {
+    sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), sum0);
+  }
+  const __m256 sum = _mm256_add_ps(sum0, sum1);
+  __m128 half = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+  half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+  half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+  float total = _mm_cvtss_f32(half);
+#elif defined(ODAI_MMR_NEON)
+  float32x4_t sum0 = vdupq_n_f32(0.0F);
+  float32x4_t sum1 = vdupq_n_f32(0.0F);
+  for (; i + 8 <= dimensions; i += 8)
+  {
+    sum0 = vfmaq_f32(sum0, vld1q_f32(a + i), vld1q_f32(b + i));
+    sum1 = vfmaq_f32(sum1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+  }
+  float total = vaddvq_f32(vaddq_f32(sum0, sum1));
+#else
+  // independent partial sums let the compiler vectorize the loop (SSE2 on any x86-64) without reordering a single sum
+  float sum0 = 0.0F;
+  float sum1 = 0.0F;
+  float sum2 = 0.0F;
+  float sum3 = 0.0F;
+  for (; i + 4 <= dimensions; i += 4)
+  {
+    sum0 += a[i] * b[i];
+    sum1 += a[i + 1] * b[i + 1];
+    sum2 += a[i + 2] * b[i + 2];
+    sum3 += a[i + 3] * b[i + 3];
+  }
+  float total = (sum0 + sum1) + (sum2 + sum3);
+#endif
+  for (; i < dimensions; ++i)
+  {
+    total += a[i] * b[i];
+  }
+  return total;
+}
+} // namespace
+
+OdaiResult<std::vector<RetrievedChunk>> select_diverse_chunks(std::vector<RetrievedChunk> candidates, uint32_t top_k,
+                                                              float lambda)
+{
+  if (candidates.empty() || top_k == 0)
+  {
+    return std::vector<RetrievedChunk>{};
+  }
+
+  const size_t dimensions = candidates.front().m_embedding.size();
+  for (const RetrievedChunk& candidate : candidates)
+  {
+    if (candidate.m_embedding.empty() || candidate.m_embedding.size() != dimensions)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "MMR candidate {}#{} has {} embedding dimensions, expected {}", candidate.m_documentId,
+               candidate.m_sequenceIndex, candidate.m_embedding.size(), dimensions);
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+  }
+
+  // normalized copies in one contiguous block, so every similarity is a plain dot product over adjacent memory
+  const size_t count = candidates.size();
+  std::vector<float> vectors(count * dimensions);
+  for (size_t c = 0; c < count; ++c)
+  {
+    const float* embedding = candidates[c].m_embedding.data();
+    const float norm = std::sqrt(dot_product(embedding, embedding, dimensions));
+    const float scale = norm > 0.0F ? 1.0F / norm : 0.0F;
+    for (size_t d = 0; d < dimensions; ++d)
+    {
+      vectors[c * dimensions + d] = embedding[d] * scale;
+    }
+  }
+
+  // redundancy of each candidate, updated against every new pick, so a pick costs one similarity per candidate
+  std::vector<float> redundancy(count, 0.0F);
+  std::vector<bool> picked(count, false);
+  std::vector<RetrievedChunk> selected;
+  const size_t pick_count = std::min<size_t>(top_k, count);
+  selected.reserve(pick_count);
+
+  while (selected.size() < pick_count)
+  {
+    size_t best = count;
+    float best_value = -std::numeric_limits<float>::infinity();
+    for (size_t c = 0; c < count; ++c)
+    {
+      if (picked[c])
+      {
+        continue;
+      }
+      const float value = lambda * candidates[c].m_score - (1.0F - lambda) * redundancy[c];
+      // strict comparison keeps the earlier, more relevant candidate on ties
+      if (value > best_value)
+      {
+        best = c;
+        best_value = value;
+      }
+    }
+
+    picked[best] = true;
+    const float* best_vector = vectors.data() + best * dimensions;
+    for (size_t c = 0; c < count; ++c)
+    {
+      if (!picked[c])
+      {
+        redundancy[c] = std::max(redundancy[c], dot_product(best_vector, vectors.data() + c * dimensions, dimensions));
+      }
+    }
+    selected.push_back(std::move(candidates[best]));
+  }
+
+  return selected;
+}
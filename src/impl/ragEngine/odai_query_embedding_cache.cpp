@@ -0,0 +1,105 @@
+#include "ragEngine/odai_query_embedding_cache.h"
+
+#include "xxhash.h"
+
+OdaiQueryEmbeddingCache::OdaiQueryEmbeddingCache(size_t capacity) : m_capacity(capacity) {}
+
+std::string OdaiQueryEmbeddingCache::normalize_query(std::string_view query)
+{
+  auto is_space = [](char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v'; };
+
+  std::string normalized;
+  normalized.reserve(query.size());
+  bool pending_space = false;
+  for (char c : query)
+  {
+    if (is_space(c))
+    {
+      pending_space = !normalized.empty();
+      continue;
+    }
+    if (pending_space)
+    {
+      normalized += ' ';
+      pending_space = false;
+    }
+    normalized += c;
+  }
+  return normalized;
+}
+
+OdaiQueryEmbeddingCache::Key OdaiQueryEmbeddingCache::make_key(const std::string& model_checksums,
+                                                               std::string_view query)
+{
+  const std::string normalized = normalize_query(query);
+  return {XXH3_64bits(model_checksums.data(), model_checksums.size()),
+          XXH3_64bits(normalized.data(), normalized.size())};
+}
+
+std::optional<std::vector<float>> OdaiQueryEmbeddingCache::find(const std::string& model_checksums,
+                                                                 std::string_view query)
+{
+  const Key key = make_key(model_checksums, query);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_index.find(key);
+  if (it == m_index.end())
+  {
+    ++m_misses;
+    return std::nullopt;
+  }
+
+  ++m_hits;
+  m_entries.splice(m_entries.begin(), m_entries, it->second);
+  return it->second->m_embedding;
+}
+
+void OdaiQueryEmbeddingCache::insert(const ModelName& model_name, const std::string& model_checksums,
+                                     std::string_view query, std::vector<float> embedding)
+{
+  if (m_capacity == 0)
+  {
+    return;
+  }
+  const Key key = make_key(model_checksums, query);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_index.find(key);
+  if (it != m_index.end())
+  {
+    it->second->m_embedding = std::move(embedding);
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return;
+  }
+
+  if (m_entries.size() >= m_capacity)
+  {
+    m_index.erase(m_entries.back().m_key);
+    m_entries.pop_back();
+  }
+  m_entries.push_front({key, model_name, std::move(embedding)});
+  m_index.emplace(key, m_entries.begin());
+}
+
+void OdaiQueryEmbeddingCache::invalidate_model(const ModelName& model_name)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (auto it = m_entries.begin(); it != m_entries.end();)
+  {
+    if (it->m_modelName == model_name)
+    {
+      m_index.erase(it->m_key);
+      it = m_entries.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+QueryEmbeddingCacheStats OdaiQueryEmbeddingCache::stats() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return {m_hits, m_misses, m_entries.size()};
+}
@@ -1,5 +1,24 @@
 #include "ragEngine/odai_rag_engine.h"
+#include "ragEngine/odai_chunker.h"
+#include "ragEngine/odai_context_expansion.h"
+#include "ragEngine/odai_context_packing.h"
+#include "ragEngine/odai_embedding_truncation.h"
+#include "ragEngine/odai_ingest_pipeline.h"
+#include "ragEngine/odai_mmr.h"
+#include "ragEngine/odai_rank_fusion.h"
+#include "ragEngine/odai_rerank.h"
 #include "types/odai_types.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <variant>
 #include <vector>
 
 #include "backendEngine/odai_backend_engine.h"
@@ -17,25 +36,143 @@
 #include "types/odai_type_conversions.h"
 #include "utils/odai_helpers.h"
 
-OdaiRagEngine::OdaiRagEngine(const DBConfig& db_config, const BackendEngineConfig& backend_config)
+namespace
+{
+/// Number of chunk sizes read from a file per streaming window, bounds the memory of add_document_from_file
+constexpr size_t STREAMING_WINDOW_CHUNKS = 64;
+
+/// Instruction placed before the retrieved chunks, the user's prompt follows the chunks
+constexpr const char* RAG_CONTEXT_HEADER =
+    "Use the following context to answer. If the context does not contain the answer, say so.\n\nContext:\n";
+constexpr const char* RAG_CONTEXT_FOOTER = "\nQuestion: ";
+/// Tokens a chunk takes in the context besides its text, its "[n] " number and the newline after it
+constexpr uint32_t RAG_CONTEXT_CHUNK_TEMPLATE_TOKENS = 6;
+/// Tokens the chat template wraps around each message, role markers and separators
+constexpr uint32_t CHAT_MESSAGE_TEMPLATE_TOKENS = 8;
+
+/// Joins the text items given as memory buffers, media and file items are left out.
+std::string collect_text(const std::vector<InputItem>& items)
+{
+  std::string text;
+  for (const InputItem& item : items)
+  {
+    if (item.get_media_type() == MediaType::TEXT && item.m_type == InputItemType::MEMORY_BUFFER)
+    {
+      text.append(item.m_data.begin(), item.m_data.end());
+    }
+  }
+  return text;
+}
+
+/// Builds the text item holding the retrieved chunks, numbered so the response can refer to them.
+InputItem build_context_item(const std::vector<RetrievedChunk>& chunks)
+{
+  std::string context = RAG_CONTEXT_HEADER;
+  for (size_t i = 0; i < chunks.size(); ++i)
+  {
+    context += "[" + std::to_string(i + 1) + "] " + chunks[i].m_contentText + "\n";
+  }
+  context += RAG_CONTEXT_FOOTER;
+
+  InputItem item;
+  item.m_type = InputItemType::MEMORY_BUFFER;
+  item.m_data.assign(context.begin(), context.end());
+  item.m_mimeType = "text/plain";
+  return item;
+}
+
+/// Builds the citations stored in the user message metadata, in the order the chunks were given to the model.
+nlohmann::json build_citations(const std::vector<RetrievedChunk>& chunks)
+{
+  nlohmann::json citations = nlohmann::json::array();
+  for (const RetrievedChunk& chunk : chunks)
+  {
+    citations.push_back({{"document_id", chunk.m_documentId},
+                         {"source_uri", chunk.m_sourceUri},
+                         {"sequence_index", chunk.m_sequenceIndex},
+                         {"sequence_count", chunk.m_sequenceCount},
+                         {"score", chunk.m_score}});
+  }
+  return citations;
+}
+
+/// Creates the database implementation selected by the config, nullptr for an unknown type.
+std::unique_ptr<IOdaiDb> create_db(const DBConfig& db_config)
 {
   if (db_config.m_dbType == SQLITE_DB)
   {
 #ifdef ODAI_ENABLE_SQLITE_DB
-    m_db = std::make_unique<OdaiSqliteDb>(db_config);
+    return std::make_unique<OdaiSqliteDb>(db_config);
 #else
     throw std::runtime_error("SQLite DB support not enabled");
 #endif
   }
+  return nullptr;
+}
 
+/// Creates the backend engine selected by the config, nullptr for an unknown type.
+std::unique_ptr<IOdaiBackendEngine> create_backend_engine(const BackendEngineConfig& backend_config)
+{
   if (backend_config.m_engineType == LLAMA_BACKEND_ENGINE)
   {
 #ifdef ODAI_ENABLE_LLAMA_BACKEND
-    m_backendEngine = std::make_unique<OdaiLlamaEngine>(backend_config);
+    return std::make_unique<OdaiLlamaEngine>(backend_config);
 #else
     throw std::runtime_error("Llama backend support not enabled");
 #endif
   }
+  return nullptr;
+}
+
+/// Opens and initializes a database connection for a background thread, next to the engine's own.
+OdaiResult<std::unique_ptr<IOdaiDb>> open_worker_db(const DBConfig& db_config)
+{
+  std::unique_ptr<IOdaiDb> db = create_db(db_config);
+  if (!db)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Database implementation is not available for a worker connection");
+    return unexpected_not_initialized();
+  }
+
+  OdaiResult<void> db_res = db->initialize_db();
+  if (!db_res)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to initialize worker db connection, error code: {}",
+             static_cast<std::uint32_t>(db_res.error()));
+    return tl::unexpected(db_res.error());
+  }
+  return db;
+}
+
+/// Creates and initializes a backend engine for a background thread, next to the engine's own.
+OdaiResult<std::unique_ptr<IOdaiBackendEngine>> open_worker_backend_engine(const BackendEngineConfig& backend_config)
+{
+  std::unique_ptr<IOdaiBackendEngine> backend_engine = create_backend_engine(backend_config);
+  if (!backend_engine)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Backend engine implementation is not available for a worker");
+    return unexpected_not_initialized();
+  }
+
+  OdaiResult<void> backend_res = backend_engine->initialize_engine();
+  if (!backend_res)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to initialize worker backend engine, error code: {}",
+             static_cast<std::uint32_t>(backend_res.error()));
+    return tl::unexpected(backend_res.error());
+  }
+  return backend_engine;
+}
+} // namespace
+
+OdaiRagEngine::OdaiRagEngine(const DBConfig& db_config, const BackendEngineConfig& backend_config)
+    : m_dbConfig(db_config), m_backendConfig(backend_config),
+      m_retrievalPool(
+          MAX_RETRIEVAL_WORKERS, [this]() { return open_worker_db(m_dbConfig); },
+          [this]() { return open_worker_backend_engine(m_backendConfig); })
+{
+  m_db = create_db(db_config);
+  m_backendEngine = create_backend_engine(backend_config);
 
   ODAI_LOG(ODAI_LOG_INFO, "RAG Engine successfully created");
 }
@@ -69,6 +206,18 @@ OdaiResult<void> OdaiRagEngine::initialize_rag_engine()
     return backend_res;
   }
 
+  // jobs interrupted by the last shutdown resume in the background, a failure to resume doesn't fail initialization
+  OdaiResult<std::vector<ReembedJob>> jobs_res = m_db->list_reembedding_jobs();
+  if (jobs_res && !jobs_res->empty())
+  {
+    OdaiResult<void> worker_res = run_reembed_worker();
+    if (!worker_res)
+    {
+      ODAI_LOG(ODAI_LOG_WARN, "Failed to resume {} re-embedding jobs, error code: {}", jobs_res->size(),
+               static_cast<std::uint32_t>(worker_res.error()));
+    }
+  }
+
   ODAI_LOG(ODAI_LOG_INFO, "RAG Engine successfully initialized");
   return {};
 }
@@ -190,6 +339,12 @@ OdaiResult<void> OdaiRagEngine::update_model_files(const ModelName& name, const
     return db_res;
   }
 
+  // embeddings of the old files are keyed by their checksums and would never hit again
+  m_queryEmbeddingCache.invalidate_model(name);
+  m_tokenCountCache.invalidate_model(name);
+  // cached results don't record the models that retrieved them
+  m_retrievalCache.clear();
+
   ODAI_LOG(ODAI_LOG_INFO, "Model files updated successfully for model: {}", name);
   return {};
 }
@@ -212,7 +367,7 @@ OdaiResult<StreamingStats> OdaiRagEngine::generate_streaming_response(const LLMM
     return tl::unexpected(OdaiResultEnum::INVALID_ARGUMENT);
   }
 
-  OdaiResult<ModelFiles> model_files_res = resolve_model_files(llm_model_config.m_modelName);
+  OdaiResult<ModelFiles> model_files_res = resolve_model_files(llm_model_config.m_modelName, *m_db);
   if (!model_files_res)
   {
     ODAI_LOG(ODAI_LOG_ERROR, "Failed to resolve file details for model: {}", llm_model_config.m_modelName);
@@ -222,8 +377,16 @@ OdaiResult<StreamingStats> OdaiRagEngine::generate_streaming_response(const LLMM
 
   const std::vector<InputItem>& processed_prompt = prompt;
 
-  return m_backendEngine->generate_streaming_response(processed_prompt, llm_model_config, model_files, sampler_config,
-                                                      callback, user_data);
+  const auto generation_start = std::chrono::steady_clock::now();
+  OdaiResult<StreamingStats> stream_res = m_backendEngine->generate_streaming_response(
+      processed_prompt, llm_model_config, model_files, sampler_config, callback, user_data);
+  if (stream_res)
+  {
+    stream_res->m_generationSeconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - generation_start).count();
+  }
+
+  return stream_res;
 }
 
 OdaiResult<StreamingStats> OdaiRagEngine::generate_streaming_chat_response(const ChatId& chat_id,
@@ -269,6 +432,10 @@ OdaiResult<StreamingStats> OdaiRagEngine::generate_streaming_chat_response(const
   }
   const ChatConfig& chat_config = chat_config_res.value();
 
+  std::vector<RetrievedChunk> retrieved_chunks;
+  double retrieval_seconds = 0.0;
+  RerankStats rerank_stats;
+
   // Check RAG settings: if RAG is enabled but scope_id is empty, return error
   if (generator_config.m_ragMode != RAG_MODE_NEVER)
   {
@@ -286,22 +453,44 @@ OdaiResult<StreamingStats> OdaiRagEngine::generate_streaming_chat_response(const
       return tl::unexpected(OdaiResultEnum::INVALID_ARGUMENT);
     }
 
-    // Retrieve and validate Semantic Space Config
-    OdaiResult<SemanticSpaceConfig> space_config_res = m_db->get_semantic_space_config(rag_config.m_semanticSpaceName);
-    if (!space_config_res)
+    const auto retrieval_start = std::chrono::steady_clock::now();
+    // the query is embedded with the model of the vectors it searches, even if the space switches meanwhile
+    std::shared_lock<std::shared_mutex> switch_lock(m_vectorSwitchMutex);
+
+    // Retrieve and validate the Semantic Space Configs, the primary space first
+    std::vector<SemanticSpaceName> space_names = {rag_config.m_semanticSpaceName};
+    space_names.insert(space_names.end(), rag_config.m_additionalSemanticSpaceNames.begin(),
+                       rag_config.m_additionalSemanticSpaceNames.end());
+    std::vector<SemanticSpaceConfig> space_configs;
+    for (const SemanticSpaceName& space_name : space_names)
     {
-      ODAI_LOG(ODAI_LOG_ERROR, "RAG is enabled but failed to retrieve semantic space config for: {}",
-               rag_config.m_semanticSpaceName);
-      return tl::unexpected(space_config_res.error());
+      OdaiResult<SemanticSpaceConfig> space_config_res = m_db->get_semantic_space_config(space_name);
+      if (!space_config_res)
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "RAG is enabled but failed to retrieve semantic space config for: {}", space_name);
+        return tl::unexpected(space_config_res.error());
+      }
+      space_configs.push_back(std::move(space_config_res.value()));
     }
 
-    // ToDo -> Implement context retrieval from knowledge base based on
-    // scope_id, using embedding model from spaceConfig Load embedding model
-    // from spaceConfig and do similarity check and retrieve according to
-    // retrieval strategy string context =
-    // retrieve_context_from_knowledge_base(scope_id, prompt, spaceConfig);
-    ODAI_LOG(ODAI_LOG_DEBUG, "RAG is enabled for chat_id: {} with space: {} and scope_id: {}", chat_id,
-             rag_config.m_semanticSpaceName, rag_config.m_scopeId);
+    OdaiResult<std::vector<RetrievedChunk>> retrieve_res =
+        space_configs.size() == 1
+            ? retrieve_context(rag_config, space_configs.front(), prompt, rerank_stats, *m_db, *m_backendEngine)
+            : retrieve_multi_space_context(rag_config, space_configs, prompt, rerank_stats);
+    if (!retrieve_res)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Failed to retrieve context for chat_id: {}, error code: {}", chat_id,
+               static_cast<std::uint32_t>(retrieve_res.error()));
+      return tl::unexpected(retrieve_res.error());
+    }
+    retrieved_chunks = std::move(retrieve_res.value());
+    switch_lock.unlock();
+    retrieval_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - retrieval_start).count();
+
+    ODAI_LOG(ODAI_LOG_DEBUG,
+             "Retrieved {} chunks for chat_id: {} from space: {} (+{} more) and scope_id: {} in {:.3f}s",
+             retrieved_chunks.size(), chat_id, rag_config.m_semanticSpaceName, space_configs.size() - 1,
+             rag_config.m_scopeId, retrieval_seconds);
   }
 
   OdaiResult<std::vector<ChatMessage>> chat_history_res = m_db->get_chat_history(chat_id);
@@ -312,7 +501,7 @@ OdaiResult<StreamingStats> OdaiRagEngine::generate_streaming_chat_response(const
   }
   const std::vector<ChatMessage>& chat_history = chat_history_res.value();
 
-  OdaiResult<ModelFiles> model_files_res = resolve_model_files(chat_config.m_llmModelConfig.m_modelName);
+  OdaiResult<ModelFiles> model_files_res = resolve_model_files(chat_config.m_llmModelConfig.m_modelName, *m_db);
   if (!model_files_res)
   {
     ODAI_LOG(ODAI_LOG_ERROR, "Failed to resolve details for model: {}", chat_config.m_llmModelConfig.m_modelName);
@@ -320,9 +509,20 @@ OdaiResult<StreamingStats> OdaiRagEngine::generate_streaming_chat_response(const
   }
   const ModelFiles& model_files = model_files_res.value();
 
-  const std::vector<InputItem>& prompt_with_context = prompt; // Placeholder until context retrieval is implemented
+  uint32_t context_tokens = 0;
+  if (!retrieved_chunks.empty())
+  {
+    OdaiResult<uint32_t> pack_res = pack_retrieved_context(*generator_config.m_ragConfig, chat_config.m_llmModelConfig,
+                                                           model_files, chat_history, prompt, retrieved_chunks);
+    if (!pack_res)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Failed to fit retrieved context into the context window for chat_id: {}", chat_id);
+      return tl::unexpected(pack_res.error());
+    }
+    context_tokens = pack_res.value();
+  }
 
-  std::vector<InputItem> final_prompt = prompt_with_context;
+  std::vector<InputItem> final_prompt = prompt;
 
   for (InputItem& item : final_prompt)
   {
@@ -335,9 +535,18 @@ OdaiResult<StreamingStats> OdaiRagEngine::generate_streaming_chat_response(const
     item = item_res.value();
   }
 
+  // the context is only given to the model, the chat history keeps the user's own prompt and cites the chunks
+  std::vector<InputItem> prompt_with_context;
+  if (!retrieved_chunks.empty())
+  {
+    prompt_with_context.push_back(build_context_item(retrieved_chunks));
+  }
+  prompt_with_context.insert(prompt_with_context.end(), final_prompt.begin(), final_prompt.end());
+
   // Generate streaming response with internal buffering callback
+  const auto generation_start = std::chrono::steady_clock::now();
   OdaiResult<StreamingStats> stream_res = m_backendEngine->generate_streaming_chat_response(
-      final_prompt, chat_history, chat_config.m_llmModelConfig, model_files, generator_config.m_samplerConfig,
+      prompt_with_context, chat_history, chat_config.m_llmModelConfig, model_files, generator_config.m_samplerConfig,
       internal_callback, &buffer_ctx);
   if (!stream_res)
   {
@@ -345,6 +554,13 @@ OdaiResult<StreamingStats> OdaiRagEngine::generate_streaming_chat_response(const
              static_cast<std::uint32_t>(stream_res.error()));
     return tl::unexpected(stream_res.error());
   }
+  stream_res->m_generationSeconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - generation_start).count();
+  stream_res->m_retrievalSeconds = retrieval_seconds;
+  stream_res->m_retrievedChunks = static_cast<uint32_t>(retrieved_chunks.size());
+  stream_res->m_contextTokens = context_tokens;
+  stream_res->m_rerankSeconds = rerank_stats.m_seconds;
+  stream_res->m_rerankedCandidates = rerank_stats.m_scoredCandidates;
 
   // Prepare messages to save
   std::vector<ChatMessage> messages_to_save;
@@ -354,12 +570,13 @@ OdaiResult<StreamingStats> OdaiRagEngine::generate_streaming_chat_response(const
   // we pass the modified prompt (here modification means we replace media item with item that we get from
   // store_media_items()) that way we only store and pass file path and not file themselves
   user_msg.m_contentItems = final_prompt;
-  // we should update message_metadata with citations if any from RAG context
   user_msg.m_messageMetadata = nlohmann::json::object();
+  if (!retrieved_chunks.empty())
+  {
+    user_msg.m_messageMetadata["citations"] = build_citations(retrieved_chunks);
+  }
   messages_to_save.push_back(user_msg);
 
-  // ToDo in message_metadata add citations if any from RAG context
-
   InputItem assistant_item;
   assistant_item.m_type = InputItemType::MEMORY_BUFFER;
   assistant_item.m_data.assign(buffer_ctx.m_bufferedResponse.begin(), buffer_ctx.m_bufferedResponse.end());
@@ -384,9 +601,9 @@ OdaiResult<StreamingStats> OdaiRagEngine::generate_streaming_chat_response(const
   return stream_res;
 }
 
-OdaiResult<ModelFiles> OdaiRagEngine::resolve_model_files(const ModelName& model_name)
+OdaiResult<ModelFiles> OdaiRagEngine::resolve_model_files(const ModelName& model_name, IOdaiDb& db)
 {
-  OdaiResult<ModelFiles> model_files_res = m_db->get_model_files(model_name);
+  OdaiResult<ModelFiles> model_files_res = db.get_model_files(model_name);
   if (!model_files_res)
   {
     ODAI_LOG(ODAI_LOG_ERROR, "Model not found in registry: {}", model_name);
@@ -396,9 +613,724 @@ OdaiResult<ModelFiles> OdaiRagEngine::resolve_model_files(const ModelName& model
   return model_files_res;
 }
 
+OdaiResult<std::vector<RetrievedChunk>> OdaiRagEngine::retrieve_context(const GeneratorRagConfig& rag_config,
+                                                                        const SemanticSpaceConfig& space_config,
+                                                                        const std::vector<InputItem>& prompt,
+                                                                        RerankStats& rerank_stats, IOdaiDb& db,
+                                                                        IOdaiBackendEngine& backend_engine)
+{
+  const RetrievalConfig& retrieval_config = rag_config.m_retrievalConfig;
+  const SearchType search_type = retrieval_config.m_searchType;
+  if (search_type != SEARCH_TYPE_VECTOR_ONLY && search_type != SEARCH_TYPE_KEYWORD_ONLY &&
+      search_type != SEARCH_TYPE_HYBRID && search_type != SEARCH_TYPE_MMR)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Unsupported search type: {}", static_cast<uint32_t>(search_type));
+    return tl::unexpected(OdaiResultEnum::INVALID_ARGUMENT);
+  }
+  const std::string query = collect_text(prompt);
+  if (query.empty())
+  {
+    ODAI_LOG(ODAI_LOG_DEBUG, "Prompt has no text to retrieve context for");
+    return std::vector<RetrievedChunk>{};
+  }
+
+  // read before searching, a document written to the scope meanwhile keeps the result out of the cache
+  const uint64_t generation = m_retrievalCache.generation(space_config.m_name, rag_config.m_scopeId);
+  std::optional<std::vector<RetrievedChunk>> cached_chunks =
+      m_retrievalCache.find(space_config.m_name, rag_config.m_scopeId, query, retrieval_config);
+  if (cached_chunks)
+  {
+    ODAI_LOG(ODAI_LOG_DEBUG, "Retrieval cache hit for space: {} and scope_id: {}", space_config.m_name,
+             rag_config.m_scopeId);
+    return std::move(cached_chunks.value());
+  }
+
+  OdaiResult<std::vector<RetrievedChunk>> search_res =
+      search_context(rag_config, space_config, query, rerank_stats, db, backend_engine);
+  if (search_res)
+  {
+    m_retrievalCache.insert(space_config.m_name, rag_config.m_scopeId, query, retrieval_config, generation,
+                            search_res.value());
+  }
+  return search_res;
+}
+
+OdaiResult<std::vector<RetrievedChunk>> OdaiRagEngine::retrieve_multi_space_context(
+    const GeneratorRagConfig& rag_config, const std::vector<SemanticSpaceConfig>& space_configs,
+    const std::vector<InputItem>& prompt, RerankStats& rerank_stats)
+{
+  const RetrievalConfig& retrieval_config = rag_config.m_retrievalConfig;
+  const std::string query = collect_text(prompt);
+  if (query.empty())
+  {
+    ODAI_LOG(ODAI_LOG_DEBUG, "Prompt has no text to retrieve context for");
+    return std::vector<RetrievedChunk>{};
+  }
+
+  // the spaces only deliver candidates, reranking and expansion run once on the merged ranking. A stage result is a
+  // plain single space retrieval with these settings, so it is cached like one.
+  GeneratorRagConfig stage_config = rag_config;
+  RetrievalConfig& stage_retrieval = stage_config.m_retrievalConfig;
+  stage_retrieval.m_useReranker = false;
+  stage_retrieval.m_contextWindow = 0;
+  if (retrieval_config.m_useReranker && retrieval_config.m_searchType != SEARCH_TYPE_MMR)
+  {
+    stage_retrieval.m_topK = std::max(retrieval_config.m_fetchK, retrieval_config.m_topK);
+  }
+
+  // spaces of one model run one after another on the same backend, sharing the query embedding through the cache
+  std::vector<ModelName> models;
+  std::unordered_map<ModelName, std::vector<size_t>> spaces_by_model;
+  for (size_t i = 0; i < space_configs.size(); ++i)
+  {
+    const ModelName& model_name = space_configs[i].m_embeddingModelConfig.m_modelName;
+    std::vector<size_t>& spaces = spaces_by_model[model_name];
+    if (spaces.empty())
+    {
+      models.push_back(model_name);
+    }
+    spaces.push_back(i);
+  }
+
+  std::vector<std::vector<RetrievedChunk>> rankings(space_configs.size());
+  auto search_spaces = [&](const std::vector<size_t>& spaces, IOdaiDb& db,
+                           IOdaiBackendEngine& backend_engine) -> OdaiResult<void>
+  {
+    for (size_t space : spaces)
+    {
+      RerankStats unused_stats;
+      OdaiResult<std::vector<RetrievedChunk>> retrieve_res =
+          retrieve_context(stage_config, space_configs[space], prompt, unused_stats, db, backend_engine);
+      if (!retrieve_res)
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "Failed to retrieve context from semantic space: {}, error code: {}",
+                 space_configs[space].m_name, static_cast<std::uint32_t>(retrieve_res.error()));
+        return tl::unexpected(retrieve_res.error());
+      }
+      rankings[space] = std::move(retrieve_res.value());
+    }
+    return {};
+  };
+
+  std::vector<std::future<OdaiResult<void>>> pending;
+  for (size_t m = 1; m < models.size(); ++m)
+  {
+    pending.push_back(m_retrievalPool.submit(
+        models[m], [&search_spaces, &spaces = spaces_by_model[models[m]]](RetrievalWorkerResources& resources)
+        { return search_spaces(spaces, *resources.m_db, *resources.m_backendEngine); }));
+  }
+  OdaiResult<void> search_res = search_spaces(spaces_by_model[models.front()], *m_db, *m_backendEngine);
+  // the workers write into rankings, every one is waited for even after a failure
+  for (std::future<OdaiResult<void>>& result : pending)
+  {
+    OdaiResult<void> worker_res = result.get();
+    if (search_res && !worker_res)
+    {
+      search_res = worker_res;
+    }
+  }
+  if (!search_res)
+  {
+    return tl::unexpected(search_res.error());
+  }
+
+  // each ranking's space is its origin, so chunks of two spaces sharing document ids (e.g. a knowledge pack exported
+  // from another one) stay apart and every chunk knows the space to read its neighbours from
+  std::vector<size_t> space_ordinals(rankings.size());
+  for (size_t space = 0; space < space_ordinals.size(); ++space)
+  {
+    space_ordinals[space] = space;
+  }
+  std::vector<MergedChunk> merged = rag_config.m_spaceMergeType == SPACE_MERGE_NORMALIZED_SCORE
+                                        ? merge_normalized_scores(rankings, space_ordinals)
+                                        : fuse_reciprocal_rank(rankings, space_ordinals);
+  if (merged.size() > stage_retrieval.m_topK)
+  {
+    merged.resize(stage_retrieval.m_topK);
+  }
+  std::vector<RetrievedChunk> chunks;
+  std::vector<size_t> chunk_spaces;
+  chunks.reserve(merged.size());
+  chunk_spaces.reserve(merged.size());
+  for (MergedChunk& chunk : merged)
+  {
+    chunks.push_back(std::move(chunk.m_chunk));
+    chunk_spaces.push_back(chunk.m_origin);
+  }
+
+  if (retrieval_config.m_useReranker && !chunks.empty())
+  {
+    // merged scores aren't on the reranker's scale, so they can't bound it like fused hybrid scores
+    std::vector<size_t> kept_positions;
+    OdaiResult<std::vector<RetrievedChunk>> rerank_res = rerank_candidates(
+        retrieval_config, query, std::move(chunks), true, rerank_stats, *m_db, *m_backendEngine, &kept_positions);
+    if (!rerank_res)
+    {
+      return rerank_res;
+    }
+    chunks = std::move(rerank_res.value());
+    std::vector<size_t> kept_spaces;
+    kept_spaces.reserve(kept_positions.size());
+    for (size_t position : kept_positions)
+    {
+      kept_spaces.push_back(chunk_spaces[position]);
+    }
+    chunk_spaces = std::move(kept_spaces);
+  }
+
+  if (retrieval_config.m_contextWindow == 0 || chunks.empty())
+  {
+    return chunks;
+  }
+
+  // neighbours are read per space, as the spaces may chunk with different overlaps
+  std::vector<std::vector<RetrievedChunk>> chunks_by_space(space_configs.size());
+  for (size_t i = 0; i < chunks.size(); ++i)
+  {
+    chunks_by_space[chunk_spaces[i]].push_back(std::move(chunks[i]));
+  }
+
+  std::vector<RetrievedChunk> expanded;
+  for (size_t space = 0; space < chunks_by_space.size(); ++space)
+  {
+    if (chunks_by_space[space].empty())
+    {
+      continue;
+    }
+    ChunkSpanReadFn read_fn = [this, &name = space_configs[space].m_name](const std::vector<DocumentChunkSpan>& spans)
+    { return m_db->get_document_chunk_spans(name, spans); };
+    const bool chunks_overlap = std::visit([](const auto& config) { return config.m_chunkOverlap > 0; },
+                                           space_configs[space].m_chunkingConfig.m_config);
+    OdaiResult<std::vector<RetrievedChunk>> expand_res = expand_chunk_context(
+        std::move(chunks_by_space[space]), retrieval_config.m_contextWindow, chunks_overlap, read_fn);
+    if (!expand_res)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Failed to expand context of chunks from semantic space: {}, error code: {}",
+               space_configs[space].m_name, static_cast<std::uint32_t>(expand_res.error()));
+      return expand_res;
+    }
+    std::move(expand_res->begin(), expand_res->end(), std::back_inserter(expanded));
+  }
+  std::stable_sort(expanded.begin(), expanded.end(),
+                   [](const RetrievedChunk& a, const RetrievedChunk& b) { return a.m_score > b.m_score; });
+  return expanded;
+}
+
+OdaiResult<uint32_t> OdaiRagEngine::pack_retrieved_context(const GeneratorRagConfig& rag_config,
+                                                           const LLMModelConfig& llm_model_config,
+                                                           const ModelFiles& model_files,
+                                                           const std::vector<ChatMessage>& chat_history,
+                                                           const std::vector<InputItem>& prompt,
+                                                           std::vector<RetrievedChunk>& chunks)
+{
+  const ModelName& model_name = llm_model_config.m_modelName;
+  OdaiResult<std::string> checksums_res = m_db->get_model_checksums(model_name);
+  if (!checksums_res)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to retrieve checksums of language model: {}, error code: {}", model_name,
+             static_cast<std::uint32_t>(checksums_res.error()));
+    return tl::unexpected(checksums_res.error());
+  }
+
+  // the chunks first, then everything else the model gets
+  std::vector<std::string> texts;
+  texts.reserve(chunks.size() + chat_history.size() + 2);
+  for (const RetrievedChunk& chunk : chunks)
+  {
+    texts.push_back(chunk.m_contentText);
+  }
+  for (const ChatMessage& message : chat_history)
+  {
+    texts.push_back(collect_text(message.m_contentItems));
+  }
+  texts.push_back(collect_text(prompt));
+  texts.push_back(std::string(RAG_CONTEXT_HEADER) + RAG_CONTEXT_FOOTER);
+
+  TokenCountFn count_fn = [&](const std::vector<std::string>& uncounted_texts)
+  { return m_backendEngine->count_llm_tokens(uncounted_texts, llm_model_config, model_files); };
+  OdaiResult<std::vector<uint32_t>> counts_res =
+      m_tokenCountCache.count(model_name, checksums_res.value(), texts, count_fn);
+  if (!counts_res)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to count tokens of retrieved context with model: {}, error code: {}", model_name,
+             static_cast<std::uint32_t>(counts_res.error()));
+    return tl::unexpected(counts_res.error());
+  }
+  const std::vector<uint32_t>& counts = counts_res.value();
+
+  // the new user message is templated like the history ones
+  uint64_t reserved_tokens =
+      static_cast<uint64_t>(chat_history.size() + 1) * CHAT_MESSAGE_TEMPLATE_TOKENS + RAG_RESPONSE_TOKEN_RESERVE;
+  for (size_t i = chunks.size(); i < counts.size(); ++i)
+  {
+    reserved_tokens += counts[i];
+  }
+  const uint32_t context_window = llm_model_config.m_contextWindow;
+  uint32_t token_budget = reserved_tokens < context_window ? static_cast<uint32_t>(context_window - reserved_tokens) : 0;
+  if (rag_config.m_contextTokenBudget != 0)
+  {
+    token_budget = std::min(token_budget, rag_config.m_contextTokenBudget);
+  }
+
+  std::vector<uint32_t> chunk_tokens(counts.begin(), counts.begin() + static_cast<std::ptrdiff_t>(chunks.size()));
+  for (uint32_t& tokens : chunk_tokens)
+  {
+    tokens += RAG_CONTEXT_CHUNK_TEMPLATE_TOKENS;
+  }
+
+  const size_t retrieved = chunks.size();
+  uint32_t used_tokens = 0;
+  chunks = pack_chunks_into_budget(std::move(chunks), chunk_tokens, token_budget, used_tokens);
+  if (chunks.size() < retrieved)
+  {
+    ODAI_LOG(ODAI_LOG_DEBUG, "Kept {} of {} retrieved chunks in a budget of {} tokens, {} tokens reserved", chunks.size(),
+             retrieved, token_budget, reserved_tokens);
+  }
+  return used_tokens;
+}
+
+OdaiResult<std::vector<RetrievedChunk>> OdaiRagEngine::search_context(const GeneratorRagConfig& rag_config,
+                                                                      const SemanticSpaceConfig& space_config,
+                                                                      const std::string& query,
+                                                                      RerankStats& rerank_stats, IOdaiDb& db,
+                                                                      IOdaiBackendEngine& backend_engine)
+{
+  const RetrievalConfig& retrieval_config = rag_config.m_retrievalConfig;
+  const SearchType search_type = retrieval_config.m_searchType;
+
+  // fetching more than topK candidates gives the reranker and MMR more to choose from, and otherwise gives the score
+  // threshold more to filter and hybrid search more candidates to fuse
+  const uint32_t fetch_k = std::max(retrieval_config.m_fetchK, retrieval_config.m_topK);
+  auto below_threshold = [&](const RetrievedChunk& chunk)
+  { return chunk.m_score < retrieval_config.m_scoreThreshold; };
+
+  std::vector<RetrievedChunk> vector_chunks;
+  if (search_type != SEARCH_TYPE_KEYWORD_ONLY)
+  {
+    OdaiResult<std::vector<RetrievedChunk>> search_res =
+        search_by_embedding(space_config, rag_config.m_scopeId, query, retrieval_config.m_documentLimit, fetch_k,
+                            search_type == SEARCH_TYPE_MMR, retrieval_config.m_metadataFilter, db, backend_engine);
+    if (!search_res)
+    {
+      return search_res;
+    }
+    vector_chunks = std::move(search_res.value());
+    std::erase_if(vector_chunks, below_threshold);
+  }
+
+  // keyword only search never touches the embedding model
+  std::vector<RetrievedChunk> keyword_chunks;
+  if (search_type == SEARCH_TYPE_KEYWORD_ONLY || search_type == SEARCH_TYPE_HYBRID)
+  {
+    OdaiResult<std::vector<RetrievedChunk>> search_res =
+        db.search_chunks_by_keywords(space_config.m_name, rag_config.m_scopeId, query, fetch_k,
+                                     retrieval_config.m_metadataFilter);
+    if (!search_res)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Failed keyword search in semantic space: {}, error code: {}", space_config.m_name,
+               static_cast<std::uint32_t>(search_res.error()));
+      return tl::unexpected(search_res.error());
+    }
+    keyword_chunks = std::move(search_res.value());
+    std::erase_if(keyword_chunks, below_threshold);
+  }
+
+  std::vector<RetrievedChunk> chunks;
+  if (search_type == SEARCH_TYPE_VECTOR_ONLY)
+  {
+    chunks = std::move(vector_chunks);
+  }
+  else if (search_type == SEARCH_TYPE_KEYWORD_ONLY)
+  {
+    chunks = std::move(keyword_chunks);
+  }
+  else if (search_type == SEARCH_TYPE_MMR)
+  {
+    // the reranker, if enabled, only reorders the diverse picks
+    OdaiResult<std::vector<RetrievedChunk>> mmr_res =
+        select_diverse_chunks(std::move(vector_chunks), retrieval_config.m_topK, retrieval_config.m_mmrLambda);
+    if (!mmr_res)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Failed to diversify candidates of semantic space: {}, error code: {}",
+               space_config.m_name, static_cast<std::uint32_t>(mmr_res.error()));
+      return tl::unexpected(mmr_res.error());
+    }
+    chunks = std::move(mmr_res.value());
+  }
+  else
+  {
+    // the threshold already applied to each search's own scores, fused scores only order the chunks
+    chunks = fuse_reciprocal_rank({vector_chunks, keyword_chunks});
+  }
+
+  if (retrieval_config.m_useReranker && !chunks.empty())
+  {
+    OdaiResult<std::vector<RetrievedChunk>> rerank_res =
+        rerank_candidates(retrieval_config, query, std::move(chunks), search_type == SEARCH_TYPE_HYBRID, rerank_stats,
+                          db, backend_engine);
+    if (!rerank_res)
+    {
+      return rerank_res;
+    }
+    chunks = std::move(rerank_res.value());
+  }
+  else if (chunks.size() > retrieval_config.m_topK)
+  {
+    chunks.resize(retrieval_config.m_topK);
+  }
+
+  if (retrieval_config.m_contextWindow == 0)
+  {
+    return chunks;
+  }
+
+  const bool chunks_overlap =
+      std::visit([](const auto& config) { return config.m_chunkOverlap > 0; }, space_config.m_chunkingConfig.m_config);
+  ChunkSpanReadFn read_fn = [&](const std::vector<DocumentChunkSpan>& spans)
+  { return db.get_document_chunk_spans(space_config.m_name, spans); };
+  OdaiResult<std::vector<RetrievedChunk>> expand_res =
+      expand_chunk_context(std::move(chunks), retrieval_config.m_contextWindow, chunks_overlap, read_fn);
+  if (!expand_res)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to expand context of chunks from semantic space: {}, error code: {}",
+             space_config.m_name, static_cast<std::uint32_t>(expand_res.error()));
+  }
+  return expand_res;
+}
+
+OdaiResult<std::vector<RetrievedChunk>> OdaiRagEngine::rerank_candidates(const RetrievalConfig& retrieval_config,
+                                                                         const std::string& query,
+                                                                         std::vector<RetrievedChunk> candidates,
+                                                                         bool fused_scores, RerankStats& rerank_stats,
+                                                                         IOdaiDb& db,
+                                                                         IOdaiBackendEngine& backend_engine,
+                                                                         std::vector<size_t>* candidate_positions)
+{
+  const RerankerModelConfig& reranker_config = retrieval_config.m_rerankerModelConfig;
+  OdaiResult<ModelFiles> model_files_res = resolve_model_files(reranker_config.m_modelName, db);
+  if (!model_files_res)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to resolve file details for reranker model: {}", reranker_config.m_modelName);
+    return tl::unexpected(model_files_res.error());
+  }
+  if (model_files_res->m_modelType != ModelType::RERANKER)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Model {} is not registered as a reranker", reranker_config.m_modelName);
+    return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+  }
+  const ModelFiles& model_files = model_files_res.value();
+
+  // fused scores only encode ranks, they can't bound reranker scores, so every candidate gets scored within the budget
+  RetrievalConfig rerank_config = retrieval_config;
+  if (fused_scores)
+  {
+    rerank_config.m_rerankEarlyStopMargin = 1.0F;
+  }
+
+  RerankScoreFn score_fn = [&](const std::vector<std::string>& texts)
+  { return backend_engine.rerank(query, texts, reranker_config, model_files); };
+  OdaiResult<std::vector<RetrievedChunk>> rerank_res =
+      rerank_chunks(std::move(candidates), rerank_config, score_fn, rerank_stats, candidate_positions);
+  if (!rerank_res)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to rerank candidates with model: {}, error code: {}", reranker_config.m_modelName,
+             static_cast<std::uint32_t>(rerank_res.error()));
+  }
+  return rerank_res;
+}
+
+OdaiResult<std::vector<RetrievedChunk>> OdaiRagEngine::search_by_embedding(const SemanticSpaceConfig& space_config,
+                                                                           const ScopeId& scope_id,
+                                                                           const std::string& query,
+                                                                           uint32_t document_limit, uint32_t limit,
+                                                                           bool include_embeddings,
+                                                                           const MetadataFilter& filter, IOdaiDb& db,
+                                                                           IOdaiBackendEngine& backend_engine)
+{
+  const ModelName& model_name = space_config.m_embeddingModelConfig.m_modelName;
+  OdaiResult<std::string> checksums_res = db.get_model_checksums(model_name);
+  if (!checksums_res)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to retrieve checksums of embedding model: {}, error code: {}", model_name,
+             static_cast<std::uint32_t>(checksums_res.error()));
+    return tl::unexpected(checksums_res.error());
+  }
+
+  std::optional<std::vector<float>> query_embedding = m_queryEmbeddingCache.find(checksums_res.value(), query);
+  if (query_embedding.has_value())
+  {
+    ODAI_LOG(ODAI_LOG_DEBUG, "Query embedding for semantic space: {} served from cache", space_config.m_name);
+  }
+  else
+  {
+    std::optional<ModelFiles> embedding_model_files;
+    OdaiResult<void> files_res =
+        resolve_embedding_model_files(space_config.m_embeddingModelConfig, embedding_model_files, db);
+    if (!files_res)
+    {
+      return tl::unexpected(files_res.error());
+    }
+
+    OdaiResult<std::vector<std::vector<float>>> embeddings_res = backend_engine.generate_embeddings(
+        {query}, space_config.m_embeddingModelConfig, embedding_model_files.value());
+    if (!embeddings_res)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Failed to embed query for semantic space: {}, error code: {}", space_config.m_name,
+               static_cast<std::uint32_t>(embeddings_res.error()));
+      return tl::unexpected(embeddings_res.error());
+    }
+    if (embeddings_res->size() != 1)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Backend returned {} embeddings for one query", embeddings_res->size());
+      return unexpected_internal_error();
+    }
+    query_embedding = std::move(embeddings_res->front());
+    m_queryEmbeddingCache.insert(model_name, checksums_res.value(), query, query_embedding.value());
+  }
+
+  // the cache holds full embeddings, spaces of the same model may truncate them differently
+  if (!truncate_embedding(query_embedding.value(), space_config.m_truncatedDimensions))
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Query embedding of {} dimensions can't be truncated to {} for semantic space {}",
+             query_embedding->size(), space_config.m_truncatedDimensions, space_config.m_name);
+    return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+  }
+
+  OdaiResult<std::vector<RetrievedChunk>> search_res =
+      document_limit > 0 ? db.search_chunks_in_top_documents(space_config.m_name, scope_id, query_embedding.value(),
+                                                             document_limit, limit, include_embeddings, filter)
+                         : db.search_chunks(space_config.m_name, scope_id, query_embedding.value(), limit,
+                                            include_embeddings, filter);
+  if (!search_res)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to search semantic space: {}, error code: {}", space_config.m_name,
+             static_cast<std::uint32_t>(search_res.error()));
+  }
+  return search_res;
+}
+
+OdaiResult<void> OdaiRagEngine::resolve_embedding_model_files(const EmbeddingModelConfig& embedding_config,
+                                                              std::optional<ModelFiles>& embedding_model_files,
+                                                              IOdaiDb& db)
+{
+  if (embedding_model_files.has_value())
+  {
+    return {};
+  }
+
+  OdaiResult<ModelFiles> model_files_res = resolve_model_files(embedding_config.m_modelName, db);
+  if (!model_files_res)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to resolve file details for embedding model: {}", embedding_config.m_modelName);
+    return tl::unexpected(model_files_res.error());
+  }
+  embedding_model_files = std::move(model_files_res.value());
+  return {};
+}
+
+OdaiResult<size_t> OdaiRagEngine::embed_new_chunks(const SemanticSpaceConfig& space_config,
+                                                  const DocumentId& document_id, std::vector<DocumentChunk>& chunks,
+                                                  std::optional<ModelFiles>& embedding_model_files)
+{
+  std::vector<uint64_t> content_hashes;
+  content_hashes.reserve(chunks.size());
+  for (const DocumentChunk& chunk : chunks)
+  {
+    content_hashes.push_back(chunk.m_contentHash);
+  }
+
+  OdaiResult<std::unordered_set<uint64_t>> unembedded_res =
+      m_db->get_unembedded_chunk_hashes(space_config.m_name, content_hashes);
+  if (!unembedded_res)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to look up embedded chunks for document: {}", document_id);
+    return tl::unexpected(unembedded_res.error());
+  }
+  const std::unordered_set<uint64_t>& unembedded_hashes = unembedded_res.value();
+
+  // every new content is embedded once, even if it repeats inside the document
+  std::unordered_map<uint64_t, size_t> chunk_to_embed_by_hash;
+  std::vector<uint64_t> new_hashes;
+  for (size_t i = 0; i < chunks.size(); ++i)
+  {
+    if (unembedded_hashes.contains(chunks[i].m_contentHash) &&
+        chunk_to_embed_by_hash.emplace(chunks[i].m_contentHash, i).second)
+    {
+      new_hashes.push_back(chunks[i].m_contentHash);
+    }
+  }
+  if (new_hashes.empty())
+  {
+    return 0;
+  }
+
+  auto set_embedding = [&](DocumentChunk& chunk, std::vector<float> embedding) -> OdaiResult<void>
+  {
+    if (space_config.m_dimensions != 0 && embedding.size() != space_config.m_dimensions)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Embedding model produced {} dimensions but semantic space {} expects {}",
+               embedding.size(), space_config.m_name, space_config.m_dimensions);
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+    if (!truncate_embedding(embedding, space_config.m_truncatedDimensions))
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Embedding of {} dimensions can't be truncated to {} for semantic space {}",
+               embedding.size(), space_config.m_truncatedDimensions, space_config.m_name);
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+    chunk.m_embedding = std::move(embedding);
+    return {};
+  };
+
+  // content the same model file embedded before, for this or another semantic space, is reused
+  const EmbeddingModelConfig& embedding_config = space_config.m_embeddingModelConfig;
+  OdaiResult<std::string> checksums_res = m_db->get_model_checksums(embedding_config.m_modelName);
+  if (!checksums_res)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to retrieve checksums of embedding model: {}, error code: {}",
+             embedding_config.m_modelName, static_cast<std::uint32_t>(checksums_res.error()));
+    return tl::unexpected(checksums_res.error());
+  }
+  OdaiResult<std::unordered_map<uint64_t, std::vector<float>>> stored_res =
+      m_db->get_stored_chunk_embeddings(checksums_res.value(), new_hashes);
+  if (!stored_res)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to look up stored embeddings for document: {}", document_id);
+    return tl::unexpected(stored_res.error());
+  }
+  for (auto& [content_hash, embedding] : stored_res.value())
+  {
+    auto it = chunk_to_embed_by_hash.find(content_hash);
+    OdaiResult<void> set_res = set_embedding(chunks[it->second], std::move(embedding));
+    if (!set_res)
+    {
+      return tl::unexpected(set_res.error());
+    }
+    chunk_to_embed_by_hash.erase(it);
+  }
+  if (!stored_res->empty())
+  {
+    ODAI_LOG(ODAI_LOG_DEBUG, "Reused {} stored embeddings for document: {}", stored_res->size(), document_id);
+  }
+
+  // Token aware chunks already carry their tokens, embedding those skips tokenizing the text a second time.
+  const bool pre_tokenized = std::holds_alternative<TokenAwareChunkingConfig>(space_config.m_chunkingConfig.m_config);
+  std::vector<uint64_t> hashes_to_embed;
+  std::vector<std::string> texts_to_embed;
+  std::vector<std::vector<TokenId>> tokens_to_embed;
+  for (size_t i = 0; i < chunks.size(); ++i)
+  {
+    auto it = chunk_to_embed_by_hash.find(chunks[i].m_contentHash);
+    if (it == chunk_to_embed_by_hash.end() || it->second != i)
+    {
+      continue;
+    }
+    hashes_to_embed.push_back(chunks[i].m_contentHash);
+    if (pre_tokenized)
+    {
+      tokens_to_embed.push_back(chunks[i].m_tokenIds);
+    }
+    else
+    {
+      texts_to_embed.push_back(chunks[i].m_contentText);
+    }
+  }
+
+  const size_t embed_count = hashes_to_embed.size();
+  if (embed_count == 0)
+  {
+    return 0;
+  }
+
+  OdaiResult<void> model_files_res = resolve_embedding_model_files(embedding_config, embedding_model_files, *m_db);
+  if (!model_files_res)
+  {
+    return tl::unexpected(model_files_res.error());
+  }
+
+  OdaiResult<std::vector<std::vector<float>>> embeddings_res =
+      pre_tokenized ? m_backendEngine->generate_embeddings_from_tokens(tokens_to_embed, embedding_config,
+                                                                       embedding_model_files.value())
+                    : m_backendEngine->generate_embeddings(texts_to_embed, embedding_config,
+                                                           embedding_model_files.value());
+  if (!embeddings_res)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to generate embeddings for document: {}, error code: {}", document_id,
+             static_cast<std::uint32_t>(embeddings_res.error()));
+    return tl::unexpected(embeddings_res.error());
+  }
+  std::vector<std::vector<float>>& embeddings = embeddings_res.value();
+
+  if (embeddings.size() != embed_count)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Backend returned {} embeddings for {} chunks", embeddings.size(), embed_count);
+    return unexpected_internal_error();
+  }
+
+  // stored before truncation, spaces of the same model may keep different prefixes of them
+  OdaiResult<void> store_res = m_db->store_chunk_embeddings(checksums_res.value(), hashes_to_embed, embeddings);
+  if (!store_res)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to store embeddings of document: {}, error code: {}", document_id,
+             static_cast<std::uint32_t>(store_res.error()));
+    return tl::unexpected(store_res.error());
+  }
+
+  for (size_t i = 0; i < embed_count; ++i)
+  {
+    OdaiResult<void> set_res =
+        set_embedding(chunks[chunk_to_embed_by_hash.at(hashes_to_embed[i])], std::move(embeddings[i]));
+    if (!set_res)
+    {
+      return tl::unexpected(set_res.error());
+    }
+  }
+
+  return embed_count;
+}
+
 OdaiResult<void> OdaiRagEngine::create_semantic_space(const SemanticSpaceConfig& config)
 {
-  return m_db->create_semantic_space(config);
+  if (!config.is_sane())
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Invalid semantic space config passed");
+    return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+  }
+
+  OdaiResult<ModelFiles> model_files_res = resolve_model_files(config.m_embeddingModelConfig.m_modelName, *m_db);
+  if (!model_files_res)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to resolve file details for embedding model: {}",
+             config.m_embeddingModelConfig.m_modelName);
+    return tl::unexpected(model_files_res.error());
+  }
+
+  OdaiResult<uint32_t> dimensions_res =
+      m_backendEngine->get_embedding_dimensions(config.m_embeddingModelConfig, model_files_res.value());
+  if (!dimensions_res)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to read embedding dimensions of model: {}",
+             config.m_embeddingModelConfig.m_modelName);
+    return tl::unexpected(dimensions_res.error());
+  }
+
+  if (config.m_dimensions != 0 && config.m_dimensions != dimensions_res.value())
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Semantic space {} asks for {} dimensions but embedding model {} produces {}",
+             config.m_name, config.m_dimensions, config.m_embeddingModelConfig.m_modelName, dimensions_res.value());
+    return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+  }
+
+  SemanticSpaceConfig resolved_config = config;
+  resolved_config.m_dimensions = dimensions_res.value();
+  if (!resolved_config.is_sane())
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Semantic space {} truncates embeddings to {} dimensions but embedding model {} produces {}",
+             config.m_name, config.m_truncatedDimensions, config.m_embeddingModelConfig.m_modelName,
+             dimensions_res.value());
+    return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+  }
+  return m_db->create_semantic_space(resolved_config);
 }
 
 OdaiResult<SemanticSpaceConfig> OdaiRagEngine::get_semantic_space_config(const SemanticSpaceName& name)
@@ -413,7 +1345,381 @@ OdaiResult<std::vector<SemanticSpaceConfig>> OdaiRagEngine::list_semantic_spaces
 
 OdaiResult<void> OdaiRagEngine::delete_semantic_space(const SemanticSpaceName& name)
 {
-  return m_db->delete_semantic_space(name);
+  OdaiResult<void> delete_res = m_db->delete_semantic_space(name);
+  if (delete_res)
+  {
+    m_retrievalCache.invalidate_space(name);
+    // the retrieval workers' connections keep a detached knowledge pack open
+    m_retrievalPool.reopen_databases();
+  }
+  return delete_res;
+}
+
+OdaiResult<void> OdaiRagEngine::export_knowledge_pack(const SemanticSpaceName& name, const std::string& pack_path,
+                                                      bool include_ann_index)
+{
+  return m_db->export_knowledge_pack(name, pack_path, include_ann_index);
+}
+
+OdaiResult<SemanticSpaceConfig> OdaiRagEngine::import_knowledge_pack(const std::string& pack_path,
+                                                                     const SemanticSpaceName& name)
+{
+  OdaiResult<SemanticSpaceConfig> import_res = m_db->import_knowledge_pack(pack_path, name);
+  if (import_res)
+  {
+    // the retrieval workers' connections only attach packs when opened
+    m_retrievalPool.reopen_databases();
+  }
+  return import_res;
+}
+
+OdaiResult<std::vector<DocumentChunk>>
+OdaiRagEngine::chunk_and_embed_document(const std::string& content, const DocumentId& document_id,
+                                        const SemanticSpaceName& semantic_space_name)
+{
+  OdaiResult<SemanticSpaceConfig> space_config_res = m_db->get_semantic_space_config(semantic_space_name);
+  if (!space_config_res)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to retrieve semantic space config for: {}", semantic_space_name);
+    return tl::unexpected(space_config_res.error());
+  }
+  const SemanticSpaceConfig& space_config = space_config_res.value();
+
+  std::optional<ModelFiles> embedding_model_files;
+  const ChunkTokenizerFn tokenizer =
+      [&](const std::vector<std::string>& texts) -> OdaiResult<std::vector<std::vector<TokenId>>>
+  {
+    OdaiResult<void> model_files_res =
+        resolve_embedding_model_files(space_config.m_embeddingModelConfig, embedding_model_files, *m_db);
+    if (!model_files_res)
+    {
+      return tl::unexpected(model_files_res.error());
+    }
+    return m_backendEngine->tokenize_embedding_texts(texts, space_config.m_embeddingModelConfig,
+                                                     embedding_model_files.value());
+  };
+
+  OdaiResult<std::vector<DocumentChunk>> chunks_res =
+      chunk_document(content, space_config.m_chunkingConfig, tokenizer);
+  if (!chunks_res)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to chunk document: {}", document_id);
+    return tl::unexpected(chunks_res.error());
+  }
+  std::vector<DocumentChunk> chunks = std::move(chunks_res.value());
+
+  if (chunks.empty())
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Document {} produced no chunks", document_id);
+    return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+  }
+
+  OdaiResult<size_t> embed_res = embed_new_chunks(space_config, document_id, chunks, embedding_model_files);
+  if (!embed_res)
+  {
+    return tl::unexpected(embed_res.error());
+  }
+
+  ODAI_LOG(ODAI_LOG_DEBUG, "Document {} split into {} chunks, {} newly embedded", document_id, chunks.size(),
+           embed_res.value());
+  return chunks;
+}
+
+OdaiResult<void> OdaiRagEngine::add_document(const std::string& content, const DocumentId& document_id,
+                                             const SemanticSpaceName& semantic_space_name, const ScopeId& scope_id,
+                                             const DocumentMetadata& metadata)
+{
+  std::shared_lock<std::shared_mutex> switch_lock(m_vectorSwitchMutex);
+  OdaiResult<std::vector<DocumentChunk>> chunks_res =
+      chunk_and_embed_document(content, document_id, semantic_space_name);
+  if (!chunks_res)
+  {
+    return tl::unexpected(chunks_res.error());
+  }
+
+  // content given from memory has no source location to record
+  OdaiResult<void> add_res =
+      m_db->add_document(document_id, "", semantic_space_name, scope_id, chunks_res.value(), metadata);
+  if (add_res)
+  {
+    m_retrievalCache.invalidate_scope(semantic_space_name, scope_id);
+  }
+  return add_res;
+}
+
+OdaiResult<void> OdaiRagEngine::update_document(const std::string& content, const DocumentId& document_id,
+                                                const SemanticSpaceName& semantic_space_name, const ScopeId& scope_id,
+                                                const DocumentMetadata& metadata)
+{
+  std::shared_lock<std::shared_mutex> switch_lock(m_vectorSwitchMutex);
+  // content the space already embedded, unchanged chunks included, is left unembedded and reuses the stored vector
+  OdaiResult<std::vector<DocumentChunk>> chunks_res =
+      chunk_and_embed_document(content, document_id, semantic_space_name);
+  if (!chunks_res)
+  {
+    return tl::unexpected(chunks_res.error());
+  }
+
+  OdaiResult<void> update_res =
+      m_db->update_document(document_id, semantic_space_name, scope_id, chunks_res.value(), metadata);
+  if (update_res)
+  {
+    m_retrievalCache.invalidate_scope(semantic_space_name, scope_id);
+    // removed vectors may stay in the HNSW graphs the retrieval workers' connections hold
+    m_retrievalPool.reopen_databases();
+  }
+  return update_res;
+}
+
+OdaiResult<void> OdaiRagEngine::add_document_from_file(const std::string& file_path, const DocumentId& document_id,
+                                                       const SemanticSpaceName& semantic_space_name,
+                                                       const ScopeId& scope_id, const DocumentMetadata& metadata)
+{
+  std::shared_lock<std::shared_mutex> switch_lock(m_vectorSwitchMutex);
+  OdaiResult<SemanticSpaceConfig> space_config_res = m_db->get_semantic_space_config(semantic_space_name);
+  if (!space_config_res)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to retrieve semantic space config for: {}", semantic_space_name);
+    return tl::unexpected(space_config_res.error());
+  }
+  const SemanticSpaceConfig& space_config = space_config_res.value();
+
+  if (!space_config.m_chunkingConfig.is_sane() ||
+      !std::holds_alternative<FixedSizeChunkingConfig>(space_config.m_chunkingConfig.m_config))
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Streaming ingestion needs a fixed size chunking config, semantic space: {}",
+             semantic_space_name);
+    return tl::unexpected(OdaiResultEnum::INVALID_ARGUMENT);
+  }
+  const auto& chunking_config = std::get<FixedSizeChunkingConfig>(space_config.m_chunkingConfig.m_config);
+
+  std::ifstream file(file_path, std::ios::binary);
+  if (!file)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to open document file: {}", file_path);
+    return tl::unexpected(OdaiResultEnum::NOT_FOUND);
+  }
+
+  // Each window is committed on its own, embedding runs outside any transaction. A failure removes the windows
+  // already stored so no partial document is left behind.
+  bool document_added = false;
+  auto fail_with_error = [&](OdaiResultEnum error) -> OdaiResult<void>
+  {
+    if (document_added)
+    {
+      OdaiResult<void> delete_res = m_db->delete_document(document_id, semantic_space_name, scope_id);
+      if (!delete_res)
+      {
+        ODAI_LOG(ODAI_LOG_WARN, "Removing partially stored document {} failed with error code: {}", document_id,
+                 static_cast<std::uint32_t>(delete_res.error()));
+      }
+      m_retrievalCache.invalidate_scope(semantic_space_name, scope_id);
+      // removed vectors may stay in the HNSW graphs the retrieval workers' connections hold
+      m_retrievalPool.reopen_databases();
+    }
+    return tl::unexpected(error);
+  };
+
+  // Read the file window by window, only the current window and the chunker's unfinished tail are held in memory
+  const size_t window_size = static_cast<size_t>(chunking_config.m_chunkSize) * STREAMING_WINDOW_CHUNKS;
+  std::string window(window_size, '\0');
+  FixedSizeChunker chunker(chunking_config);
+  std::optional<ModelFiles> embedding_model_files;
+  std::vector<DocumentChunk> chunks;
+  size_t total_chunks = 0;
+  size_t total_embedded = 0;
+
+  while (true)
+  {
+    file.read(window.data(), static_cast<std::streamsize>(window.size()));
+    const auto bytes_read = static_cast<size_t>(file.gcount());
+    if (file.bad())
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Failed to read document file: {}", file_path);
+      return fail_with_error(OdaiResultEnum::INTERNAL_ERROR);
+    }
+
+    const bool end_of_file = bytes_read < window.size();
+    chunker.feed(std::string_view(window.data(), bytes_read), chunks);
+    if (end_of_file)
+    {
+      chunker.finish(chunks);
+    }
+
+    if (!chunks.empty())
+    {
+      OdaiResult<size_t> embed_res = embed_new_chunks(space_config, document_id, chunks, embedding_model_files);
+      if (!embed_res)
+      {
+        return fail_with_error(embed_res.error());
+      }
+
+      OdaiResult<void> write_res = document_added ? m_db->append_document_chunks(document_id, chunks)
+                                                  : m_db->add_document(document_id, file_path, semantic_space_name,
+                                                                       scope_id, chunks, metadata);
+      if (!write_res)
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "Failed to store chunks of document: {}", document_id);
+        return fail_with_error(write_res.error());
+      }
+
+      document_added = true;
+      m_retrievalCache.invalidate_scope(semantic_space_name, scope_id);
+      total_chunks += chunks.size();
+      total_embedded += embed_res.value();
+      chunks.clear();
+    }
+
+    if (end_of_file)
+    {
+      break;
+    }
+  }
+
+  if (!document_added)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Document {} produced no chunks", document_id);
+    return fail_with_error(OdaiResultEnum::VALIDATION_FAILED);
+  }
+
+  ODAI_LOG(ODAI_LOG_DEBUG, "Document {} streamed from {} into {} chunks, {} newly embedded", document_id, file_path,
+           total_chunks, total_embedded);
+  return {};
+}
+
+OdaiResult<BulkIngestStats> OdaiRagEngine::add_documents(const std::vector<IngestDocumentSource>& sources,
+                                                         const SemanticSpaceName& semantic_space_name,
+                                                         const ScopeId& scope_id, const BulkIngestConfig& config)
+{
+  std::shared_lock<std::shared_mutex> switch_lock(m_vectorSwitchMutex);
+  OdaiResult<SemanticSpaceConfig> space_config_res = m_db->get_semantic_space_config(semantic_space_name);
+  if (!space_config_res)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to retrieve semantic space config for: {}", semantic_space_name);
+    return tl::unexpected(space_config_res.error());
+  }
+
+  OdaiResult<ModelFiles> model_files_res =
+      resolve_model_files(space_config_res->m_embeddingModelConfig.m_modelName, *m_db);
+  if (!model_files_res)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to resolve file details for embedding model: {}",
+             space_config_res->m_embeddingModelConfig.m_modelName);
+    return tl::unexpected(model_files_res.error());
+  }
+
+  OdaiResult<std::string> checksums_res =
+      m_db->get_model_checksums(space_config_res->m_embeddingModelConfig.m_modelName);
+  if (!checksums_res)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to retrieve checksums of embedding model: {}",
+             space_config_res->m_embeddingModelConfig.m_modelName);
+    return tl::unexpected(checksums_res.error());
+  }
+
+  OdaiIngestPipeline pipeline(*m_db, *m_backendEngine, std::move(space_config_res.value()),
+                              std::move(model_files_res.value()), std::move(checksums_res.value()), scope_id, config);
+  OdaiResult<BulkIngestStats> run_res = pipeline.run(sources);
+  // batches committed before a failure stay in the scope as well
+  m_retrievalCache.invalidate_scope(semantic_space_name, scope_id);
+  return run_res;
+}
+
+OdaiResult<void> OdaiRagEngine::start_reembedding(const SemanticSpaceName& semantic_space_name,
+                                                  const EmbeddingModelConfig& embedding_model_config,
+                                                  const ReembedConfig& config)
+{
+  if (!config.is_sane() || !embedding_model_config.is_sane())
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Invalid re-embedding config passed for semantic space: {}", semantic_space_name);
+    return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+  }
+
+  OdaiResult<SemanticSpaceConfig> space_config_res = m_db->get_semantic_space_config(semantic_space_name);
+  if (!space_config_res)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to retrieve semantic space config for: {}", semantic_space_name);
+    return tl::unexpected(space_config_res.error());
+  }
+
+  OdaiResult<ModelFiles> model_files_res = resolve_model_files(embedding_model_config.m_modelName, *m_db);
+  if (!model_files_res)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to resolve file details for embedding model: {}",
+             embedding_model_config.m_modelName);
+    return tl::unexpected(model_files_res.error());
+  }
+
+  OdaiResult<uint32_t> dimensions_res =
+      m_backendEngine->get_embedding_dimensions(embedding_model_config, model_files_res.value());
+  if (!dimensions_res)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to read embedding dimensions of model: {}", embedding_model_config.m_modelName);
+    return tl::unexpected(dimensions_res.error());
+  }
+
+  SemanticSpaceConfig target_config = std::move(space_config_res.value());
+  target_config.m_embeddingModelConfig = embedding_model_config;
+  target_config.m_dimensions = dimensions_res.value();
+  if (!target_config.is_sane())
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Semantic space {} truncates embeddings to {} dimensions but embedding model {} produces {}",
+             semantic_space_name, target_config.m_truncatedDimensions, embedding_model_config.m_modelName,
+             dimensions_res.value());
+    return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+  }
+
+  OdaiResult<void> start_res = m_db->start_reembedding(target_config, config);
+  if (!start_res)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to start re-embedding of semantic space: {}", semantic_space_name);
+    return start_res;
+  }
+
+  ODAI_LOG(ODAI_LOG_INFO, "Re-embedding semantic space {} with embedding model {}", semantic_space_name,
+           embedding_model_config.m_modelName);
+  // the job is stored, a worker failing to start now picks it up at the next initialization
+  return run_reembed_worker();
+}
+
+OdaiResult<ReembedJob> OdaiRagEngine::get_reembedding_job(const SemanticSpaceName& semantic_space_name)
+{
+  return m_db->get_reembedding_job(semantic_space_name);
+}
+
+OdaiResult<void> OdaiRagEngine::cancel_reembedding(const SemanticSpaceName& semantic_space_name)
+{
+  // a batch the worker is embedding meanwhile fails to store and the worker moves on
+  return m_db->cancel_reembedding(semantic_space_name);
+}
+
+OdaiResult<void> OdaiRagEngine::run_reembed_worker()
+{
+  if (m_reembedWorker != nullptr && m_reembedWorker->notify())
+  {
+    return {};
+  }
+  // joins the thread of a worker that ran out of jobs
+  m_reembedWorker.reset();
+
+  OdaiResult<std::unique_ptr<IOdaiDb>> db_res = open_worker_db(m_dbConfig);
+  if (!db_res)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to open re-embedding db connection");
+    return tl::unexpected(db_res.error());
+  }
+
+  OdaiResult<std::unique_ptr<IOdaiBackendEngine>> backend_res = open_worker_backend_engine(m_backendConfig);
+  if (!backend_res)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to create re-embedding backend engine");
+    return tl::unexpected(backend_res.error());
+  }
+
+  m_reembedWorker = std::make_unique<OdaiReembedWorker>(
+      std::move(db_res.value()), std::move(backend_res.value()), m_vectorSwitchMutex,
+      [this](const SemanticSpaceName& name) { m_retrievalCache.invalidate_space(name); });
+  return {};
 }
 
 OdaiResult<void> OdaiRagEngine::create_chat(const ChatId& chat_id, const ChatConfig& chat_config)
@@ -430,3 +1736,18 @@ OdaiResult<bool> OdaiRagEngine::chat_id_exists(const ChatId& chat_id)
 {
   return m_db->chat_id_exists(chat_id);
 }
+
+QueryEmbeddingCacheStats OdaiRagEngine::get_query_embedding_cache_stats() const
+{
+  return m_queryEmbeddingCache.stats();
+}
+
+RetrievalCacheStats OdaiRagEngine::get_retrieval_cache_stats() const
+{
+  return m_retrievalCache.stats();
+}
+
+TokenCountCacheStats OdaiRagEngine::get_token_count_cache_stats() const
+{
+  return m_tokenCountCache.stats();
+}
@@ -0,0 +1,139 @@
+#include "ragEngine/odai_rank_fusion.h"
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+
+namespace
+{
+std::string chunk_key(size_t origin, const RetrievedChunk& chunk)
+{
+  // document ids can't contain '\0' in practice, it keeps keys of different chunks apart
+  std::string key = std::to_string(origin);
+  key += '\0';
+  key += chunk.m_documentId;
+  key += '\0';
+  key += std::to_string(chunk.m_sequenceIndex);
+  return key;
+}
+
+/// Orders merged chunks by their scores, best first, keeping first appearance order on ties
+std::vector<MergedChunk> order_by_score(std::vector<MergedChunk> merged, const std::vector<double>& scores,
+                                        double scale)
+{
+  std::vector<size_t> order(merged.size());
+  for (size_t i = 0; i < order.size(); ++i)
+  {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [&scores](size_t a, size_t b) { return scores[a] > scores[b]; });
+
+  std::vector<MergedChunk> result;
+  result.reserve(merged.size());
+  for (size_t index : order)
+  {
+    merged[index].m_chunk.m_score = static_cast<float>(scores[index] / scale);
+    result.push_back(std::move(merged[index]));
+  }
+  return result;
+}
+
+/// Rankings of a single origin, whose chunks are merged by document id and sequence index alone
+std::vector<size_t> same_origin(size_t count)
+{
+  return std::vector<size_t>(count, 0);
+}
+
+std::vector<RetrievedChunk> without_origins(std::vector<MergedChunk> merged)
+{
+  std::vector<RetrievedChunk> chunks;
+  chunks.reserve(merged.size());
+  for (MergedChunk& chunk : merged)
+  {
+    chunks.push_back(std::move(chunk.m_chunk));
+  }
+  return chunks;
+}
+} // namespace
+
+std::vector<RetrievedChunk> fuse_reciprocal_rank(const std::vector<std::vector<RetrievedChunk>>& rankings,
+                                                 uint32_t rank_constant)
+{
+  return without_origins(fuse_reciprocal_rank(rankings, same_origin(rankings.size()), rank_constant));
+}
+
+std::vector<MergedChunk> fuse_reciprocal_rank(const std::vector<std::vector<RetrievedChunk>>& rankings,
+                                              const std::vector<size_t>& origins, uint32_t rank_constant)
+{
+  std::vector<MergedChunk> fused;
+  std::vector<double> scores;
+  std::unordered_map<std::string, size_t> position_by_chunk;
+
+  for (size_t r = 0; r < rankings.size(); ++r)
+  {
+    const std::vector<RetrievedChunk>& ranking = rankings[r];
+    for (size_t i = 0; i < ranking.size(); ++i)
+    {
+      const RetrievedChunk& chunk = ranking[i];
+      auto [it, inserted] = position_by_chunk.try_emplace(chunk_key(origins[r], chunk), fused.size());
+      if (inserted)
+      {
+        fused.push_back({chunk, origins[r]});
+        scores.push_back(0.0);
+      }
+      scores[it->second] += 1.0 / (static_cast<double>(rank_constant) + static_cast<double>(i + 1));
+    }
+  }
+
+  if (fused.empty())
+  {
+    return fused;
+  }
+
+  const double best_possible = static_cast<double>(rankings.size()) / (static_cast<double>(rank_constant) + 1.0);
+  return order_by_score(std::move(fused), scores, best_possible);
+}
+
+std::vector<RetrievedChunk> merge_normalized_scores(const std::vector<std::vector<RetrievedChunk>>& rankings)
+{
+  return without_origins(merge_normalized_scores(rankings, same_origin(rankings.size())));
+}
+
+std::vector<MergedChunk> merge_normalized_scores(const std::vector<std::vector<RetrievedChunk>>& rankings,
+                                                 const std::vector<size_t>& origins)
+{
+  std::vector<MergedChunk> merged;
+  std::vector<double> scores;
+  std::unordered_map<std::string, size_t> position_by_chunk;
+
+  for (size_t r = 0; r < rankings.size(); ++r)
+  {
+    const std::vector<RetrievedChunk>& ranking = rankings[r];
+    if (ranking.empty())
+    {
+      continue;
+    }
+    const auto [lowest, highest] = std::minmax_element(ranking.begin(), ranking.end(),
+                                                       [](const RetrievedChunk& a, const RetrievedChunk& b)
+                                                       { return a.m_score < b.m_score; });
+    const double low = lowest->m_score;
+    const double range = static_cast<double>(highest->m_score) - low;
+
+    for (const RetrievedChunk& chunk : ranking)
+    {
+      const double normalized = range > 0.0 ? (chunk.m_score - low) / range : 1.0;
+      auto [it, inserted] = position_by_chunk.try_emplace(chunk_key(origins[r], chunk), merged.size());
+      if (inserted)
+      {
+        merged.push_back({chunk, origins[r]});
+        scores.push_back(normalized);
+      }
+      else
+      {
+        scores[it->second] = std::max(scores[it->second], normalized);
+      }
+    }
+  }
+
+  return order_by_score(std::move(merged), scores, 1.0);
+}
@@ -0,0 +1,327 @@
+#include "ragEngine/odai_reembed_worker.h"
+
+#include "odai_logger.h"
+#include "ragEngine/odai_embedding_truncation.h"
+
+#include <algorithm>
+#include <exception>
+#include <unordered_set>
+
+namespace
+{
+/// Consecutive failed batches after which a worker leaves a job alone
+constexpr uint32_t REEMBED_MAX_CONSECUTIVE_FAILURES = 5;
+/// Minimum pause after a failed batch, failures are mostly a busy database or a model that failed to load
+constexpr std::chrono::seconds REEMBED_RETRY_DELAY{2};
+} // namespace
+
+std::chrono::nanoseconds reembed_pause(std::chrono::nanoseconds busy, float max_cpu_share)
+{
+  if (max_cpu_share >= 1.0F || max_cpu_share <= 0.0F || busy.count() <= 0)
+  {
+    return std::chrono::nanoseconds::zero();
+  }
+  // busy / (busy + pause) = share
+  const double pause = static_cast<double>(busy.count()) * (1.0 - max_cpu_share) / max_cpu_share;
+  return std::chrono::nanoseconds(static_cast<int64_t>(pause));
+}
+
+OdaiReembedWorker::OdaiReembedWorker(std::unique_ptr<IOdaiDb> db, std::unique_ptr<IOdaiBackendEngine> backend_engine,
+                                     std::shared_mutex& switch_mutex,
+                                     std::function<void(const SemanticSpaceName&)> on_switched)
+    : m_db(std::move(db)), m_backendEngine(std::move(backend_engine)), m_switchMutex(switch_mutex),
+      m_onSwitched(std::move(on_switched))
+{
+  m_thread = std::thread(&OdaiReembedWorker::run, this);
+}
+
+OdaiReembedWorker::~OdaiReembedWorker()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_wakeup.notify_all();
+  if (m_thread.joinable())
+  {
+    m_thread.join();
+  }
+}
+
+bool OdaiReembedWorker::notify()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_exited)
+  {
+    return false;
+  }
+  m_notified = true;
+  return true;
+}
+
+void OdaiReembedWorker::run()
+{
+  ODAI_LOG(ODAI_LOG_INFO, "Re-embedding worker started");
+  try
+  {
+    bool stopping = false;
+    while (!stopping)
+    {
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stopping)
+        {
+          break;
+        }
+        m_notified = false;
+      }
+
+      std::vector<ReembedJob> jobs;
+      OdaiResult<std::vector<ReembedJob>> jobs_res = m_db->list_reembedding_jobs();
+      if (!jobs_res)
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "Failed to list re-embedding jobs, error code: {}",
+                 static_cast<std::uint32_t>(jobs_res.error()));
+      }
+      else
+      {
+        for (ReembedJob& job : jobs_res.value())
+        {
+          auto it = m_failures.find(job.m_targetConfig.m_name);
+          if (it == m_failures.end() || it->second < REEMBED_MAX_CONSECUTIVE_FAILURES)
+          {
+            jobs.push_back(std::move(job));
+          }
+        }
+      }
+
+      if (jobs.empty())
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // a job started since the jobs were listed is picked up by another round
+        if (!m_notified)
+        {
+          m_exited = true;
+          break;
+        }
+        continue;
+      }
+
+      // jobs take turns batch by batch, a large space doesn't hold back the others
+      for (const ReembedJob& job : jobs)
+      {
+        const SemanticSpaceName& name = job.m_targetConfig.m_name;
+        const auto batch_start = std::chrono::steady_clock::now();
+        OdaiResult<bool> batch_res = run_batch(job);
+        std::chrono::nanoseconds pause =
+            reembed_pause(std::chrono::steady_clock::now() - batch_start, job.m_config.m_maxCpuShare);
+
+        if (batch_res)
+        {
+          m_failures.erase(name);
+        }
+        else
+        {
+          const uint32_t failures = ++m_failures[name];
+          ODAI_LOG(ODAI_LOG_WARN, "Re-embedding batch of semantic space {} failed ({} in a row), error code: {}", name,
+                   failures, static_cast<std::uint32_t>(batch_res.error()));
+          if (failures >= REEMBED_MAX_CONSECUTIVE_FAILURES)
+          {
+            ODAI_LOG(ODAI_LOG_ERROR, "Re-embedding of semantic space {} paused until the next restart or start", name);
+          }
+          pause = std::max<std::chrono::nanoseconds>(pause, REEMBED_RETRY_DELAY);
+        }
+
+        if (!sleep_for(pause))
+        {
+          stopping = true;
+          break;
+        }
+      }
+    }
+  }
+  catch (const std::exception& e)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Re-embedding worker failed: {}", e.what());
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_exited = true;
+  }
+  // the new models and the connection are only needed while jobs run
+  m_backendEngine.reset();
+  m_db.reset();
+  ODAI_LOG(ODAI_LOG_INFO, "Re-embedding worker stopped");
+}
+
+OdaiResult<bool> OdaiReembedWorker::run_batch(const ReembedJob& job)
+{
+  const SemanticSpaceConfig& target_config = job.m_targetConfig;
+  OdaiResult<std::vector<ReembedChunk>> batch_res =
+      m_db->get_reembedding_batch(target_config.m_name, job.m_config.m_batchSize);
+  if (!batch_res)
+  {
+    return tl::unexpected(batch_res.error());
+  }
+  std::vector<ReembedChunk>& batch = batch_res.value();
+
+  if (batch.empty())
+  {
+    std::unique_lock<std::shared_mutex> switch_lock(m_switchMutex);
+    OdaiResult<bool> finish_res = m_db->finish_reembedding(target_config.m_name);
+    if (!finish_res)
+    {
+      return tl::unexpected(finish_res.error());
+    }
+    if (!finish_res.value())
+    {
+      // vectors were added while the last batch ran, they are read by the next batch
+      return true;
+    }
+    m_onSwitched(target_config.m_name);
+    ODAI_LOG(ODAI_LOG_INFO, "Semantic space {} switched to embedding model {}", target_config.m_name,
+             target_config.m_embeddingModelConfig.m_modelName);
+    return false;
+  }
+
+  OdaiResult<void> embed_res = embed_batch(target_config, batch);
+  if (!embed_res)
+  {
+    return tl::unexpected(embed_res.error());
+  }
+
+  OdaiResult<void> store_res = m_db->store_reembedded_vectors(target_config.m_name, batch);
+  if (!store_res)
+  {
+    return tl::unexpected(store_res.error());
+  }
+  ODAI_LOG(ODAI_LOG_DEBUG, "Re-embedded {} vectors of semantic space {}", batch.size(), target_config.m_name);
+  return true;
+}
+
+OdaiResult<void> OdaiReembedWorker::embed_batch(const SemanticSpaceConfig& target_config,
+                                                std::vector<ReembedChunk>& batch)
+{
+  const EmbeddingModelConfig& embedding_config = target_config.m_embeddingModelConfig;
+  OdaiResult<const ResolvedModel*> model_res = resolve_model(embedding_config.m_modelName);
+  if (!model_res)
+  {
+    return tl::unexpected(model_res.error());
+  }
+  const ResolvedModel& model = *model_res.value();
+
+  std::vector<uint64_t> content_hashes;
+  std::unordered_set<uint64_t> seen_hashes;
+  for (const ReembedChunk& chunk : batch)
+  {
+    if (seen_hashes.insert(chunk.m_contentHash).second)
+    {
+      content_hashes.push_back(chunk.m_contentHash);
+    }
+  }
+
+  // content the new model embedded before, e.g. for another space, is reused
+  OdaiResult<std::unordered_map<uint64_t, std::vector<float>>> stored_res =
+      m_db->get_stored_chunk_embeddings(model.m_checksums, content_hashes);
+  if (!stored_res)
+  {
+    return tl::unexpected(stored_res.error());
+  }
+  std::unordered_map<uint64_t, std::vector<float>> embeddings_by_hash = std::move(stored_res.value());
+
+  std::vector<uint64_t> hashes_to_embed;
+  std::vector<std::string> texts_to_embed;
+  for (const ReembedChunk& chunk : batch)
+  {
+    if (!embeddings_by_hash.contains(chunk.m_contentHash) &&
+        std::find(hashes_to_embed.begin(), hashes_to_embed.end(), chunk.m_contentHash) == hashes_to_embed.end())
+    {
+      hashes_to_embed.push_back(chunk.m_contentHash);
+      texts_to_embed.push_back(chunk.m_contentText);
+    }
+  }
+
+  if (!texts_to_embed.empty())
+  {
+    // token aware spaces are embedded from the text too, the chunk boundaries stay those of the old tokenizer
+    OdaiResult<std::vector<std::vector<float>>> embeddings_res =
+        m_backendEngine->generate_embeddings(texts_to_embed, embedding_config, model.m_files);
+    if (!embeddings_res)
+    {
+      return tl::unexpected(embeddings_res.error());
+    }
+    std::vector<std::vector<float>>& embeddings = embeddings_res.value();
+    if (embeddings.size() != texts_to_embed.size())
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Backend returned {} embeddings for {} chunks", embeddings.size(),
+               texts_to_embed.size());
+      return tl::unexpected(OdaiResultEnum::INTERNAL_ERROR);
+    }
+
+    // the stored embeddings only save work later, a failed store doesn't fail the batch
+    OdaiResult<void> store_res = m_db->store_chunk_embeddings(model.m_checksums, hashes_to_embed, embeddings);
+    if (!store_res)
+    {
+      ODAI_LOG(ODAI_LOG_WARN, "Failed to store embeddings of model {}, error code: {}", embedding_config.m_modelName,
+               static_cast<std::uint32_t>(store_res.error()));
+    }
+
+    for (size_t i = 0; i < hashes_to_embed.size(); ++i)
+    {
+      embeddings_by_hash[hashes_to_embed[i]] = std::move(embeddings[i]);
+    }
+  }
+
+  for (ReembedChunk& chunk : batch)
+  {
+    std::vector<float> embedding = embeddings_by_hash.at(chunk.m_contentHash);
+    if (embedding.size() != target_config.m_dimensions)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Embedding model produced {} dimensions but semantic space {} expects {}",
+               embedding.size(), target_config.m_name, target_config.m_dimensions);
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+    if (!truncate_embedding(embedding, target_config.m_truncatedDimensions))
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Embedding of {} dimensions can't be truncated to {} for semantic space {}",
+               embedding.size(), target_config.m_truncatedDimensions, target_config.m_name);
+      return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+    }
+    chunk.m_embedding = std::move(embedding);
+  }
+  return {};
+}
+
+OdaiResult<const OdaiReembedWorker::ResolvedModel*> OdaiReembedWorker::resolve_model(const ModelName& model_name)
+{
+  auto it = m_resolvedModels.find(model_name);
+  if (it != m_resolvedModels.end())
+  {
+    return &it->second;
+  }
+
+  OdaiResult<ModelFiles> files_res = m_db->get_model_files(model_name);
+  if (!files_res)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to resolve file details for embedding model: {}", model_name);
+    return tl::unexpected(files_res.error());
+  }
+  OdaiResult<std::string> checksums_res = m_db->get_model_checksums(model_name);
+  if (!checksums_res)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to retrieve checksums of embedding model: {}", model_name);
+    return tl::unexpected(checksums_res.error());
+  }
+
+  it = m_resolvedModels
+           .emplace(model_name, ResolvedModel{std::move(files_res.value()), std::move(checksums_res.value())})
+           .first;
+  return &it->second;
+}
+
+bool OdaiReembedWorker::sleep_for(std::chrono::nanoseconds duration)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  return !m_wakeup.wait_for(lock, duration, [this] { return m_stopping; });
+}
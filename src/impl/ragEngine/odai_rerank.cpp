@@ -0,0 +1,94 @@
+#include "ragEngine/odai_rerank.h"
+
+#include "odai_logger.h"
+
+#include <algorithm>
+#include <chrono>
+
+OdaiResult<std::vector<RetrievedChunk>> rerank_chunks(std::vector<RetrievedChunk> candidates,
+                                                      const RetrievalConfig& config, const RerankScoreFn& score_fn,
+                                                      RerankStats& stats, std::vector<size_t>* candidate_positions)
+{
+  stats = {};
+  const auto start = std::chrono::steady_clock::now();
+  const auto budget = std::chrono::milliseconds(config.m_rerankTimeBudgetMs);
+  const size_t top_k = config.m_topK;
+
+  // scored candidates, kept ordered by reranker score; ties keep first stage order
+  std::vector<RetrievedChunk> reranked;
+  std::vector<size_t> positions;
+  size_t next = 0;
+  std::vector<std::string> texts;
+
+  while (next < candidates.size())
+  {
+    if (reranked.size() >= top_k)
+    {
+      const float upper_bound = std::min(1.0F, candidates[next].m_score + config.m_rerankEarlyStopMargin);
+      if (upper_bound <= reranked[top_k - 1].m_score)
+      {
+        stats.m_stoppedEarly = true;
+        break;
+      }
+    }
+    if (next > 0 && config.m_rerankTimeBudgetMs > 0 && std::chrono::steady_clock::now() - start >= budget)
+    {
+      stats.m_budgetExhausted = true;
+      break;
+    }
+
+    const size_t end = std::min(candidates.size(), next + RERANK_CANDIDATES_PER_ROUND);
+    texts.clear();
+    for (size_t i = next; i < end; ++i)
+    {
+      texts.push_back(candidates[i].m_contentText);
+    }
+
+    OdaiResult<std::vector<float>> scores_res = score_fn(texts);
+    if (!scores_res)
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Failed to score rerank candidates, error code: {}",
+               static_cast<std::uint32_t>(scores_res.error()));
+      return tl::unexpected(scores_res.error());
+    }
+    if (scores_res->size() != texts.size())
+    {
+      ODAI_LOG(ODAI_LOG_ERROR, "Reranker returned {} scores for {} candidates", scores_res->size(), texts.size());
+      return unexpected_internal_error();
+    }
+
+    for (size_t i = next; i < end; ++i)
+    {
+      RetrievedChunk& chunk = candidates[i];
+      chunk.m_score = scores_res.value()[i - next];
+      auto position = std::upper_bound(reranked.begin(), reranked.end(), chunk.m_score,
+                                       [](float score, const RetrievedChunk& other) { return score > other.m_score; });
+      positions.insert(positions.begin() + (position - reranked.begin()), i);
+      reranked.insert(position, std::move(chunk));
+    }
+    next = end;
+  }
+
+  stats.m_scoredCandidates = static_cast<uint32_t>(reranked.size());
+  if (reranked.size() > top_k)
+  {
+    reranked.resize(top_k);
+    positions.resize(top_k);
+  }
+  // only a budget stop can leave the top K short while candidates remain
+  for (; reranked.size() < top_k && next < candidates.size(); ++next)
+  {
+    reranked.push_back(std::move(candidates[next]));
+    positions.push_back(next);
+  }
+
+  stats.m_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  ODAI_LOG(ODAI_LOG_DEBUG, "Reranked {} of {} candidates in {:.3f}s, stopped early: {}, budget exhausted: {}",
+           stats.m_scoredCandidates, candidates.size(), stats.m_seconds, stats.m_stoppedEarly,
+           stats.m_budgetExhausted);
+  if (candidate_positions != nullptr)
+  {
+    *candidate_positions = std::move(positions);
+  }
+  return reranked;
+}
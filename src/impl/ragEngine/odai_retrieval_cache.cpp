@@ -0,0 +1,211 @@
+#include "ragEngine/odai_retrieval_cache.h"
+
+#include "ragEngine/odai_query_embedding_cache.h"
+
+#include "xxhash.h"
+
+namespace
+{
+std::string scope_generation_key(const SemanticSpaceName& space_name, const ScopeId& scope_id)
+{
+  std::string key = space_name;
+  key += '\0';
+  key += scope_id;
+  return key;
+}
+
+template <typename T>
+void hash_value(XXH3_state_t* state, const T& value)
+{
+  XXH3_64bits_update(state, &value, sizeof(value));
+}
+
+/// Hashes a string along with its length, so consecutive strings can't run into each other
+void hash_string(XXH3_state_t* state, std::string_view value)
+{
+  hash_value(state, static_cast<uint64_t>(value.size()));
+  XXH3_64bits_update(state, value.data(), value.size());
+}
+
+uint64_t estimate_bytes(const SemanticSpaceName& space_name, const ScopeId& scope_id,
+                        const std::vector<RetrievedChunk>& chunks)
+{
+  uint64_t bytes = space_name.size() + scope_id.size() + chunks.capacity() * sizeof(RetrievedChunk);
+  for (const RetrievedChunk& chunk : chunks)
+  {
+    bytes += chunk.m_documentId.size() + chunk.m_sourceUri.size() + chunk.m_contentText.size();
+  }
+  return bytes;
+}
+} // namespace
+
+OdaiRetrievalCache::OdaiRetrievalCache(uint64_t max_bytes) : m_maxBytes(max_bytes) {}
+
+uint64_t OdaiRetrievalCache::make_key(const SemanticSpaceName& space_name, const ScopeId& scope_id,
+                                      std::string_view query, const RetrievalConfig& config)
+{
+  XXH3_state_t state;
+  XXH3_64bits_reset(&state);
+  hash_string(&state, space_name);
+  hash_string(&state, scope_id);
+  hash_string(&state, OdaiQueryEmbeddingCache::normalize_query(query));
+
+  hash_value(&state, config.m_topK);
+  hash_value(&state, config.m_fetchK);
+  hash_value(&state, config.m_scoreThreshold);
+  hash_value(&state, config.m_searchType);
+  hash_value(&state, config.m_useReranker);
+  hash_value(&state, config.m_contextWindow);
+  hash_value(&state, config.m_documentLimit);
+  hash_value(&state, static_cast<uint64_t>(config.m_metadataFilter.size()));
+  for (const MetadataFilterCondition& condition : config.m_metadataFilter)
+  {
+    hash_string(&state, condition.m_field);
+    hash_value(&state, static_cast<uint64_t>(condition.m_values.size()));
+    for (const std::string& value : condition.m_values)
+    {
+      hash_string(&state, value);
+    }
+  }
+  if (config.m_useReranker)
+  {
+    hash_string(&state, config.m_rerankerModelConfig.m_modelName);
+    hash_value(&state, config.m_rerankEarlyStopMargin);
+    hash_value(&state, config.m_rerankTimeBudgetMs);
+  }
+  if (config.m_searchType == SEARCH_TYPE_MMR)
+  {
+    hash_value(&state, config.m_mmrLambda);
+  }
+  return XXH3_64bits_digest(&state);
+}
+
+uint64_t OdaiRetrievalCache::generation_locked(const SemanticSpaceName& space_name, const ScopeId& scope_id) const
+{
+  uint64_t generation = 0;
+  auto space_it = m_spaceGenerations.find(space_name);
+  if (space_it != m_spaceGenerations.end())
+  {
+    generation += space_it->second;
+  }
+  auto scope_it = m_scopeGenerations.find(scope_generation_key(space_name, scope_id));
+  if (scope_it != m_scopeGenerations.end())
+  {
+    generation += scope_it->second;
+  }
+  return generation;
+}
+
+uint64_t OdaiRetrievalCache::generation(const SemanticSpaceName& space_name, const ScopeId& scope_id) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return generation_locked(space_name, scope_id);
+}
+
+void OdaiRetrievalCache::erase_locked(std::list<Entry>::iterator it)
+{
+  m_bytes -= it->m_bytes;
+  m_index.erase(it->m_key);
+  m_entries.erase(it);
+}
+
+std::optional<std::vector<RetrievedChunk>> OdaiRetrievalCache::find(const SemanticSpaceName& space_name,
+                                                                    const ScopeId& scope_id, std::string_view query,
+                                                                    const RetrievalConfig& config)
+{
+  const uint64_t key = make_key(space_name, scope_id, query, config);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_index.find(key);
+  if (it == m_index.end())
+  {
+    ++m_misses;
+    return std::nullopt;
+  }
+
+  if (it->second->m_generation != generation_locked(space_name, scope_id))
+  {
+    ++m_misses;
+    ++m_staleEntries;
+    erase_locked(it->second);
+    return std::nullopt;
+  }
+
+  ++m_hits;
+  m_entries.splice(m_entries.begin(), m_entries, it->second);
+  return it->second->m_chunks;
+}
+
+void OdaiRetrievalCache::insert(const SemanticSpaceName& space_name, const ScopeId& scope_id, std::string_view query,
+                                const RetrievalConfig& config, uint64_t generation, std::vector<RetrievedChunk> chunks)
+{
+  for (RetrievedChunk& chunk : chunks)
+  {
+    chunk.m_embedding = {};
+  }
+  chunks.shrink_to_fit();
+  const uint64_t bytes = sizeof(Entry) + estimate_bytes(space_name, scope_id, chunks);
+  if (bytes > m_maxBytes)
+  {
+    return;
+  }
+  const uint64_t key = make_key(space_name, scope_id, query, config);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  // the scope was written to while this result was retrieved, it may already be outdated
+  if (generation != generation_locked(space_name, scope_id))
+  {
+    return;
+  }
+
+  auto it = m_index.find(key);
+  if (it != m_index.end())
+  {
+    erase_locked(it->second);
+  }
+  while (!m_entries.empty() && m_bytes + bytes > m_maxBytes)
+  {
+    erase_locked(std::prev(m_entries.end()));
+  }
+
+  m_entries.push_front({key, space_name, generation, bytes, std::move(chunks)});
+  m_index.emplace(key, m_entries.begin());
+  m_bytes += bytes;
+}
+
+void OdaiRetrievalCache::invalidate_scope(const SemanticSpaceName& space_name, const ScopeId& scope_id)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  ++m_scopeGenerations[scope_generation_key(space_name, scope_id)];
+}
+
+void OdaiRetrievalCache::invalidate_space(const SemanticSpaceName& space_name)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  ++m_spaceGenerations[space_name];
+
+  // none of the space's results can become current again, release them right away
+  for (auto it = m_entries.begin(); it != m_entries.end();)
+  {
+    auto next = std::next(it);
+    if (it->m_spaceName == space_name)
+    {
+      erase_locked(it);
+    }
+    it = next;
+  }
+}
+
+void OdaiRetrievalCache::clear()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_entries.clear();
+  m_index.clear();
+  m_bytes = 0;
+}
+
+RetrievalCacheStats OdaiRetrievalCache::stats() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return {m_hits, m_misses, m_staleEntries, m_entries.size(), m_bytes};
+}
@@ -0,0 +1,136 @@
+#include "ragEngine/odai_retrieval_pool.h"
+
+#include "odai_logger.h"
+
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+OdaiRetrievalPool::OdaiRetrievalPool(size_t max_workers, RetrievalDbFactory db_factory,
+                                     RetrievalBackendFactory backend_factory)
+    : m_maxWorkers(std::max<size_t>(max_workers, 1)), m_dbFactory(std::move(db_factory)),
+      m_backendFactory(std::move(backend_factory))
+{
+}
+
+OdaiRetrievalPool::~OdaiRetrievalPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_wakeup.notify_all();
+  for (const std::unique_ptr<Worker>& worker : m_workers)
+  {
+    if (worker->m_thread.joinable())
+    {
+      worker->m_thread.join();
+    }
+  }
+}
+
+std::future<OdaiResult<void>> OdaiRetrievalPool::submit(const ModelName& model_name, RetrievalTask task)
+{
+  PendingTask pending{std::move(task), {}};
+  std::future<OdaiResult<void>> result = pending.m_promise.get_future();
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_workerByModel.find(model_name);
+    if (it == m_workerByModel.end())
+    {
+      const size_t index = m_workerByModel.size() % m_maxWorkers;
+      if (index == m_workers.size())
+      {
+        m_workers.push_back(std::make_unique<Worker>());
+        Worker& worker = *m_workers.back();
+        worker.m_thread = std::thread(&OdaiRetrievalPool::run, this, std::ref(worker));
+      }
+      it = m_workerByModel.emplace(model_name, index).first;
+    }
+    m_workers[it->second]->m_queue.push_back(std::move(pending));
+  }
+  m_wakeup.notify_all();
+  return result;
+}
+
+void OdaiRetrievalPool::reopen_databases()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (const std::unique_ptr<Worker>& worker : m_workers)
+  {
+    worker->m_reopenDb = true;
+  }
+}
+
+size_t OdaiRetrievalPool::worker_count() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_workers.size();
+}
+
+void OdaiRetrievalPool::run(Worker& worker)
+{
+  RetrievalWorkerResources resources;
+  while (true)
+  {
+    PendingTask pending;
+    bool reopen_db = false;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_wakeup.wait(lock, [&] { return m_stopping || !worker.m_queue.empty(); });
+      if (m_stopping)
+      {
+        for (PendingTask& abandoned : worker.m_queue)
+        {
+          abandoned.m_promise.set_value(unexpected_not_initialized());
+        }
+        worker.m_queue.clear();
+        break;
+      }
+      pending = std::move(worker.m_queue.front());
+      worker.m_queue.pop_front();
+      reopen_db = std::exchange(worker.m_reopenDb, false);
+    }
+
+    if (reopen_db)
+    {
+      resources.m_db.reset();
+    }
+    pending.m_promise.set_value(run_task(pending.m_task, resources));
+  }
+}
+
+OdaiResult<void> OdaiRetrievalPool::run_task(RetrievalTask& task, RetrievalWorkerResources& resources)
+{
+  try
+  {
+    if (resources.m_db == nullptr)
+    {
+      OdaiResult<std::unique_ptr<IOdaiDb>> db_res = m_dbFactory();
+      if (!db_res)
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "Failed to open retrieval worker db connection, error code: {}",
+                 static_cast<std::uint32_t>(db_res.error()));
+        return tl::unexpected(db_res.error());
+      }
+      resources.m_db = std::move(db_res.value());
+    }
+    if (resources.m_backendEngine == nullptr)
+    {
+      OdaiResult<std::unique_ptr<IOdaiBackendEngine>> backend_res = m_backendFactory();
+      if (!backend_res)
+      {
+        ODAI_LOG(ODAI_LOG_ERROR, "Failed to create retrieval worker backend engine, error code: {}",
+                 static_cast<std::uint32_t>(backend_res.error()));
+        return tl::unexpected(backend_res.error());
+      }
+      resources.m_backendEngine = std::move(backend_res.value());
+    }
+    return task(resources);
+  }
+  catch (const std::exception& e)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Retrieval worker task failed: {}", e.what());
+    return unexpected_internal_error();
+  }
+}
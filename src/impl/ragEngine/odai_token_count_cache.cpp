@@ -0,0 +1,118 @@
+#include "ragEngine/odai_token_count_cache.h"
+
+#include "odai_logger.h"
+
+#include "xxhash.h"
+
+OdaiTokenCountCache::OdaiTokenCountCache(size_t capacity) : m_capacity(capacity) {}
+
+OdaiResult<std::vector<uint32_t>> OdaiTokenCountCache::count(const ModelName& model_name,
+                                                              const std::string& model_checksums,
+                                                              const std::vector<std::string>& texts,
+                                                              const TokenCountFn& count_fn)
+{
+  const uint64_t model_hash = XXH3_64bits(model_checksums.data(), model_checksums.size());
+  std::vector<Key> keys;
+  keys.reserve(texts.size());
+  for (const std::string& text : texts)
+  {
+    keys.push_back({model_hash, XXH3_64bits(text.data(), text.size())});
+  }
+
+  std::vector<uint32_t> counts(texts.size(), 0);
+  std::vector<size_t> missing;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+      auto it = m_index.find(keys[i]);
+      if (it == m_index.end())
+      {
+        ++m_misses;
+        missing.push_back(i);
+        continue;
+      }
+      ++m_hits;
+      m_entries.splice(m_entries.begin(), m_entries, it->second);
+      counts[i] = it->second->m_tokenCount;
+    }
+  }
+
+  if (missing.empty())
+  {
+    return counts;
+  }
+
+  // counted without the lock, another request counting the same texts meanwhile only repeats the work
+  std::vector<std::string> missing_texts;
+  missing_texts.reserve(missing.size());
+  for (size_t index : missing)
+  {
+    missing_texts.push_back(texts[index]);
+  }
+  OdaiResult<std::vector<uint32_t>> count_res = count_fn(missing_texts);
+  if (!count_res)
+  {
+    return tl::unexpected(count_res.error());
+  }
+  if (count_res->size() != missing.size())
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Token counter returned {} counts for {} texts", count_res->size(), missing.size());
+    return unexpected_internal_error();
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (size_t i = 0; i < missing.size(); ++i)
+  {
+    counts[missing[i]] = count_res.value()[i];
+    insert_locked(keys[missing[i]], model_name, count_res.value()[i]);
+  }
+  return counts;
+}
+
+void OdaiTokenCountCache::insert_locked(const Key& key, const ModelName& model_name, uint32_t token_count)
+{
+  if (m_capacity == 0)
+  {
+    return;
+  }
+
+  auto it = m_index.find(key);
+  if (it != m_index.end())
+  {
+    it->second->m_tokenCount = token_count;
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return;
+  }
+
+  if (m_entries.size() >= m_capacity)
+  {
+    m_index.erase(m_entries.back().m_key);
+    m_entries.pop_back();
+  }
+  m_entries.push_front({key, model_name, token_count});
+  m_index.emplace(key, m_entries.begin());
+}
+
+void OdaiTokenCountCache::invalidate_model(const ModelName& model_name)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (auto it = m_entries.begin(); it != m_entries.end();)
+  {
+    if (it->m_modelName == model_name)
+    {
+      m_index.erase(it->m_key);
+      it = m_entries.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+TokenCountCacheStats OdaiTokenCountCache::stats() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return {m_hits, m_misses, m_entries.size()};
+}
@@ -13,6 +13,10 @@ ModelType to_cpp_model_type(c_ModelType c)
   {
     return ModelType::EMBEDDING;
   }
+  if (c == ODAI_MODEL_TYPE_RERANKER)
+  {
+    return ModelType::RERANKER;
+  }
 
   // Default to LLM if unknown, or handle error appropriately.
   // Since we can't easily return error here, we assume valid input or handle at caller.
@@ -76,6 +80,23 @@ ModelFiles to_cpp(const c_ModelFiles& c)
   return model_file_details;
 }
 
+DocumentMetadata to_cpp_document_metadata(const c_MetadataEntry* entries, size_t count)
+{
+  DocumentMetadata metadata;
+  if (entries == nullptr)
+  {
+    return metadata;
+  }
+  for (size_t i = 0; i < count; ++i)
+  {
+    if ((entries[i].m_key != nullptr) && (entries[i].m_value != nullptr))
+    {
+      metadata[std::string(entries[i].m_key)] = std::string(entries[i].m_value);
+    }
+  }
+  return metadata;
+}
+
 InputItem to_cpp(const c_InputItem& c)
 {
   InputItem item;
@@ -113,6 +134,16 @@ EmbeddingModelConfig to_cpp(const c_EmbeddingModelConfig& c)
   return {std::string(c.m_modelName)};
 }
 
+RerankerModelConfig to_cpp(const c_RerankerModelConfig& c)
+{
+  RerankerModelConfig config;
+  if (c.m_modelName != nullptr)
+  {
+    config.m_modelName = std::string(c.m_modelName);
+  }
+  return config;
+}
+
 LLMModelConfig to_cpp(const c_LlmModelConfig& c)
 {
   return {std::string(c.m_modelName), c.m_contextWindow};
@@ -129,6 +160,33 @@ ChunkingConfig to_cpp(const c_ChunkingConfig& c)
     fcc.m_chunkOverlap = c.m_config.m_fixedSizeConfig.m_chunkOverlap;
     config.m_config = fcc;
   }
+  else if (c.m_strategy == BOUNDARY_AWARE_CHUNKING)
+  {
+    BoundaryAwareChunkingConfig bcc;
+    bcc.m_chunkSize = c.m_config.m_boundaryAwareConfig.m_chunkSize;
+    bcc.m_chunkOverlap = c.m_config.m_boundaryAwareConfig.m_chunkOverlap;
+    bcc.m_boundaryTolerance = c.m_config.m_boundaryAwareConfig.m_boundaryTolerance;
+    config.m_config = bcc;
+  }
+  else if (c.m_strategy == TOKEN_AWARE_CHUNKING)
+  {
+    TokenAwareChunkingConfig tcc;
+    tcc.m_chunkSize = c.m_config.m_tokenAwareConfig.m_chunkSize;
+    tcc.m_chunkOverlap = c.m_config.m_tokenAwareConfig.m_chunkOverlap;
+    config.m_config = tcc;
+  }
+  return config;
+}
+
+VectorIndexConfig to_cpp(const c_VectorIndexConfig& c)
+{
+  VectorIndexConfig config;
+  config.m_indexType = c.m_indexType;
+  config.m_hnswMaxConnections = c.m_hnswMaxConnections;
+  config.m_hnswEfConstruction = c.m_hnswEfConstruction;
+  config.m_hnswEfSearch = c.m_hnswEfSearch;
+  config.m_storageType = c.m_storageType;
+  config.m_rescoreOversample = c.m_rescoreOversample;
   return config;
 }
 
@@ -139,6 +197,15 @@ SemanticSpaceConfig to_cpp(const c_SemanticSpaceConfig& c)
   config.m_embeddingModelConfig = to_cpp(c.m_embeddingModelConfig);
   config.m_chunkingConfig = to_cpp(c.m_chunkingConfig);
   config.m_dimensions = c.m_dimensions;
+  config.m_vectorIndexConfig = to_cpp(c.m_vectorIndexConfig);
+  config.m_truncatedDimensions = c.m_truncatedDimensions;
+  if (c.m_filterFields != nullptr)
+  {
+    for (uint32_t i = 0; i < c.m_filterFieldsCount; ++i)
+    {
+      config.m_filterFields.emplace_back(c.m_filterFields[i]);
+    }
+  }
   return config;
 }
 
@@ -151,6 +218,60 @@ RetrievalConfig to_cpp(const c_RetrievalConfig& c)
   config.m_searchType = c.m_searchType;
   config.m_useReranker = c.m_useReranker;
   config.m_contextWindow = c.m_contextWindow;
+  config.m_rerankerModelConfig = to_cpp(c.m_rerankerModelConfig);
+  config.m_rerankEarlyStopMargin =
+      c.m_rerankEarlyStopMargin != 0.0F ? c.m_rerankEarlyStopMargin : DEFAULT_RERANK_EARLY_STOP_MARGIN;
+  config.m_rerankTimeBudgetMs = c.m_rerankTimeBudgetMs != 0 ? c.m_rerankTimeBudgetMs : DEFAULT_RERANK_TIME_BUDGET_MS;
+  config.m_mmrLambda = c.m_mmrLambda != 0.0F ? c.m_mmrLambda : DEFAULT_MMR_LAMBDA;
+  config.m_documentLimit = c.m_documentLimit;
+  if (c.m_metadataFilter != nullptr)
+  {
+    for (size_t i = 0; i < c.m_metadataFilterCount; ++i)
+    {
+      const c_MetadataFilterCondition& c_condition = c.m_metadataFilter[i];
+      MetadataFilterCondition& condition = config.m_metadataFilter.emplace_back();
+      condition.m_field = std::string(c_condition.m_field);
+      if (c_condition.m_values != nullptr)
+      {
+        condition.m_values.assign(c_condition.m_values, c_condition.m_values + c_condition.m_valuesCount);
+      }
+    }
+  }
+  return config;
+}
+
+IngestDocumentSource to_cpp(const c_IngestDocumentSource& c)
+{
+  IngestDocumentSource source;
+  if (c.m_documentId != nullptr)
+  {
+    source.m_documentId = std::string(c.m_documentId);
+  }
+  if (c.m_filePath != nullptr)
+  {
+    source.m_filePath = std::string(c.m_filePath);
+  }
+  source.m_metadata = to_cpp_document_metadata(c.m_metadata, c.m_metadataCount);
+  return source;
+}
+
+BulkIngestConfig to_cpp(const c_BulkIngestConfig& c)
+{
+  BulkIngestConfig config{};
+  config.m_readerThreads = c.m_readerThreads != 0 ? c.m_readerThreads : DEFAULT_INGEST_READER_THREADS;
+  config.m_chunkerThreads = c.m_chunkerThreads;
+  config.m_queueCapacity = c.m_queueCapacity != 0 ? c.m_queueCapacity : DEFAULT_INGEST_QUEUE_CAPACITY;
+  config.m_embeddingBatchSize =
+      c.m_embeddingBatchSize != 0 ? c.m_embeddingBatchSize : DEFAULT_INGEST_EMBEDDING_BATCH_SIZE;
+  config.m_writeBatchSize = c.m_writeBatchSize != 0 ? c.m_writeBatchSize : DEFAULT_INGEST_WRITE_BATCH_SIZE;
+  return config;
+}
+
+ReembedConfig to_cpp(const c_ReembedConfig& c)
+{
+  ReembedConfig config{};
+  config.m_batchSize = c.m_batchSize != 0 ? c.m_batchSize : DEFAULT_REEMBED_BATCH_SIZE;
+  config.m_maxCpuShare = c.m_maxCpuShare != 0.0F ? c.m_maxCpuShare : DEFAULT_REEMBED_MAX_CPU_SHARE;
   return config;
 }
 
@@ -171,6 +292,15 @@ GeneratorRagConfig to_cpp(const c_GeneratorRagConfig& source)
   {
     config.m_scopeId = std::string(source.m_scopeId);
   }
+  config.m_contextTokenBudget = source.m_contextTokenBudget;
+  if (source.m_additionalSemanticSpaceNames != nullptr)
+  {
+    for (size_t i = 0; i < source.m_additionalSemanticSpaceNamesCount; ++i)
+    {
+      config.m_additionalSemanticSpaceNames.emplace_back(source.m_additionalSemanticSpaceNames[i]);
+    }
+  }
+  config.m_spaceMergeType = source.m_spaceMergeType;
   return config;
 }
 
@@ -255,9 +385,30 @@ c_ChunkingConfig to_c(const ChunkingConfig& cpp)
     c.m_config.m_fixedSizeConfig.m_chunkSize = conf.m_chunkSize;
     c.m_config.m_fixedSizeConfig.m_chunkOverlap = conf.m_chunkOverlap;
   }
+  else if (std::holds_alternative<BoundaryAwareChunkingConfig>(cpp.m_config))
+  {
+    c.m_strategy = BOUNDARY_AWARE_CHUNKING;
+    const auto& conf = std::get<BoundaryAwareChunkingConfig>(cpp.m_config);
+    c.m_config.m_boundaryAwareConfig.m_chunkSize = conf.m_chunkSize;
+    c.m_config.m_boundaryAwareConfig.m_chunkOverlap = conf.m_chunkOverlap;
+    c.m_config.m_boundaryAwareConfig.m_boundaryTolerance = conf.m_boundaryTolerance;
+  }
+  else if (std::holds_alternative<TokenAwareChunkingConfig>(cpp.m_config))
+  {
+    c.m_strategy = TOKEN_AWARE_CHUNKING;
+    const auto& conf = std::get<TokenAwareChunkingConfig>(cpp.m_config);
+    c.m_config.m_tokenAwareConfig.m_chunkSize = conf.m_chunkSize;
+    c.m_config.m_tokenAwareConfig.m_chunkOverlap = conf.m_chunkOverlap;
+  }
   return c;
 }
 
+c_VectorIndexConfig to_c(const VectorIndexConfig& cpp)
+{
+  return {cpp.m_indexType, cpp.m_hnswMaxConnections, cpp.m_hnswEfConstruction,
+          cpp.m_hnswEfSearch, cpp.m_storageType, cpp.m_rescoreOversample};
+}
+
 c_SemanticSpaceConfig to_c(const SemanticSpaceConfig& cpp)
 {
   c_SemanticSpaceConfig c{};
@@ -265,9 +416,59 @@ c_SemanticSpaceConfig to_c(const SemanticSpaceConfig& cpp)
   c.m_embeddingModelConfig = to_c(cpp.m_embeddingModelConfig);
   c.m_chunkingConfig = to_c(cpp.m_chunkingConfig);
   c.m_dimensions = cpp.m_dimensions;
+  c.m_vectorIndexConfig = to_c(cpp.m_vectorIndexConfig);
+  c.m_truncatedDimensions = cpp.m_truncatedDimensions;
+  if (!cpp.m_filterFields.empty())
+  {
+    c.m_filterFields = static_cast<const char**>(malloc(cpp.m_filterFields.size() * sizeof(const char*)));
+    c.m_filterFieldsCount = static_cast<uint32_t>(cpp.m_filterFields.size());
+    for (size_t i = 0; i < cpp.m_filterFields.size(); ++i)
+    {
+      c.m_filterFields[i] = strdup(cpp.m_filterFields[i].c_str());
+    }
+  }
+  return c;
+}
+
+c_BulkIngestStats to_c(const BulkIngestStats& cpp)
+{
+  c_BulkIngestStats c{};
+  c.m_documentsIngested = cpp.m_documentsIngested;
+  c.m_documentsFailed = cpp.m_documentsFailed;
+  c.m_chunksProcessed = cpp.m_chunksProcessed;
+  c.m_chunksEmbedded = cpp.m_chunksEmbedded;
+  c.m_elapsedSeconds = cpp.m_elapsedSeconds;
+  for (size_t i = 0; i < INGEST_STAGE_COUNT; ++i)
+  {
+    const IngestStageStats& stage = cpp.m_stages[i];
+    c.m_stages[i] = {stage.m_workers,     stage.m_itemsProcessed, stage.m_busySeconds,   stage.m_itemsPerSecond,
+                     stage.m_utilization, stage.m_maxQueueDepth,  stage.m_avgQueueDepth};
+  }
   return c;
 }
 
+c_ReembedProgress to_c(const ReembedJob& cpp)
+{
+  return {cpp.m_vectorsDone, cpp.m_vectorsTotal};
+}
+
+c_CacheStats to_c(const CacheStats& cpp)
+{
+  c_CacheStats result{};
+  result.m_queryEmbeddingHits = cpp.m_queryEmbedding.m_hits;
+  result.m_queryEmbeddingMisses = cpp.m_queryEmbedding.m_misses;
+  result.m_queryEmbeddingEntries = cpp.m_queryEmbedding.m_entries;
+  result.m_retrievalHits = cpp.m_retrieval.m_hits;
+  result.m_retrievalMisses = cpp.m_retrieval.m_misses;
+  result.m_retrievalStaleEntries = cpp.m_retrieval.m_staleEntries;
+  result.m_retrievalEntries = cpp.m_retrieval.m_entries;
+  result.m_retrievalBytes = cpp.m_retrieval.m_bytes;
+  result.m_tokenCountHits = cpp.m_tokenCount.m_hits;
+  result.m_tokenCountMisses = cpp.m_tokenCount.m_misses;
+  result.m_tokenCountEntries = cpp.m_tokenCount.m_entries;
+  return result;
+}
+
 c_ChatMessage to_c(const ChatMessage& cpp)
 {
   c_ChatMessage result{};
@@ -312,6 +513,16 @@ void to_json(nlohmann::json& j, const ChunkingConfig& p)
     j = nlohmann::json{{"strategy", FIXED_SIZE_CHUNKING}};
     j["config"] = std::get<FixedSizeChunkingConfig>(p.m_config);
   }
+  else if (std::holds_alternative<BoundaryAwareChunkingConfig>(p.m_config))
+  {
+    j = nlohmann::json{{"strategy", BOUNDARY_AWARE_CHUNKING}};
+    j["config"] = std::get<BoundaryAwareChunkingConfig>(p.m_config);
+  }
+  else if (std::holds_alternative<TokenAwareChunkingConfig>(p.m_config))
+  {
+    j = nlohmann::json{{"strategy", TOKEN_AWARE_CHUNKING}};
+    j["config"] = std::get<TokenAwareChunkingConfig>(p.m_config);
+  }
 }
 
 void from_json(const nlohmann::json& j, ChunkingConfig& p)
@@ -327,4 +538,22 @@ void from_json(const nlohmann::json& j, ChunkingConfig& p)
       p.m_config = conf;
     }
   }
+  else if (strategy == BOUNDARY_AWARE_CHUNKING)
+  {
+    if (j.contains("config"))
+    {
+      BoundaryAwareChunkingConfig conf;
+      j.at("config").get_to(conf);
+      p.m_config = conf;
+    }
+  }
+  else if (strategy == TOKEN_AWARE_CHUNKING)
+  {
+    if (j.contains("config"))
+    {
+      TokenAwareChunkingConfig conf;
+      j.at("config").get_to(conf);
+      p.m_config = conf;
+    }
+  }
 }
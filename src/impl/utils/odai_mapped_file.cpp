@@ -0,0 +1,99 @@
+#include "utils/odai_mapped_file.h"
+#include "odai_logger.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+OdaiResult<std::unique_ptr<OdaiMappedFile>> OdaiMappedFile::open(const std::filesystem::path& path)
+{
+  std::error_code ec;
+  if (!std::filesystem::is_regular_file(path, ec))
+  {
+    return tl::unexpected(OdaiResultEnum::NOT_FOUND);
+  }
+
+  const uintmax_t file_size = std::filesystem::file_size(path, ec);
+  if (ec || file_size == 0)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Cannot map empty or unreadable file: {}", path.string());
+    return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+  }
+
+  std::unique_ptr<OdaiMappedFile> mapped(new OdaiMappedFile());
+  mapped->m_size = static_cast<size_t>(file_size);
+
+#ifdef _WIN32
+  HANDLE file = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to open file for mapping: {}", path.string());
+    return unexpected_internal_error();
+  }
+  mapped->m_fileHandle = file;
+
+  HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mapping == nullptr)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to create file mapping: {}", path.string());
+    return unexpected_internal_error();
+  }
+  mapped->m_mappingHandle = mapping;
+
+  void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (view == nullptr)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to map view of file: {}", path.string());
+    return unexpected_internal_error();
+  }
+  mapped->m_data = static_cast<const uint8_t*>(view);
+#else
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to open file for mapping: {}", path.string());
+    return unexpected_internal_error();
+  }
+
+  // the mapping keeps the file referenced, the descriptor isn't needed after mmap
+  void* view = mmap(nullptr, mapped->m_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (view == MAP_FAILED)
+  {
+    ODAI_LOG(ODAI_LOG_ERROR, "Failed to map file: {}", path.string());
+    return unexpected_internal_error();
+  }
+  mapped->m_data = static_cast<const uint8_t*>(view);
+#endif
+
+  return mapped;
+}
+
+OdaiMappedFile::~OdaiMappedFile()
+{
+#ifdef _WIN32
+  if (m_data != nullptr)
+  {
+    UnmapViewOfFile(m_data);
+  }
+  if (m_mappingHandle != nullptr)
+  {
+    CloseHandle(m_mappingHandle);
+  }
+  if (m_fileHandle != nullptr)
+  {
+    CloseHandle(m_fileHandle);
+  }
+#else
+  if (m_data != nullptr)
+  {
+    munmap(const_cast<uint8_t*>(m_data), m_size);
+  }
+#endif
+}
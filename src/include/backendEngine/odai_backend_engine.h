@@ -73,5 +73,68 @@ public:
                                    const SamplerConfig& sampler_config, OdaiStreamRespCallbackFn callback,
                                    void* user_data) = 0;
 
+  /// Generates embeddings for a batch of texts using the given embedding model.
+  /// Implementations should batch the texts internally so a large input does not cost one model call per text.
+  /// @param texts The texts to embed
+  /// @param embedding_model_config The embedding model configuration to use
+  /// @param model_files The model files of the embedding model
+  /// @return L2-normalized embeddings in the same order as texts, or an unexpected OdaiResultEnum indicating the error.
+  virtual OdaiResult<std::vector<std::vector<float>>>
+  generate_embeddings(const std::vector<std::string>& texts, const EmbeddingModelConfig& embedding_model_config,
+                      const ModelFiles& model_files) = 0;
+
+  /// Tokenizes consecutive pieces of a text with the given embedding model, without adding special tokens.
+  /// Each piece is tokenized as a continuation of the pieces before it, so that the tokens of consecutive pieces
+  /// concatenate to the tokens of the joined text wherever the pieces are split at whitespace.
+  /// Implementations should tokenize the pieces in parallel, this is called with every word of a document.
+  /// @param texts The pieces to tokenize
+  /// @param embedding_model_config The embedding model configuration to use
+  /// @param model_files The model files of the embedding model
+  /// @return token ids of each piece in the same order as texts, or an unexpected OdaiResultEnum indicating the error.
+  virtual OdaiResult<std::vector<std::vector<TokenId>>>
+  tokenize_embedding_texts(const std::vector<std::string>& texts, const EmbeddingModelConfig& embedding_model_config,
+                           const ModelFiles& model_files) = 0;
+
+  /// Generates embeddings for texts already tokenized with tokenize_embedding_texts, skipping tokenization.
+  /// Implementations add the special tokens the model expects around each sequence.
+  /// @param token_sequences Token ids of each text to embed, without special tokens
+  /// @param embedding_model_config The embedding model configuration to use
+  /// @param model_files The model files of the embedding model
+  /// @return L2-normalized embeddings in the same order as token_sequences, or an unexpected OdaiResultEnum indicating
+  /// the error.
+  virtual OdaiResult<std::vector<std::vector<float>>>
+  generate_embeddings_from_tokens(const std::vector<std::vector<TokenId>>& token_sequences,
+                                  const EmbeddingModelConfig& embedding_model_config,
+                                  const ModelFiles& model_files) = 0;
+
+  /// Reads the dimension of the embeddings produced by an embedding model from its metadata.
+  /// @param embedding_model_config The embedding model configuration to use
+  /// @param model_files The model files of the embedding model
+  /// @return the embedding dimension, or an unexpected OdaiResultEnum indicating the error.
+  virtual OdaiResult<uint32_t> get_embedding_dimensions(const EmbeddingModelConfig& embedding_model_config,
+                                                        const ModelFiles& model_files) = 0;
+
+  /// Counts the tokens of texts with the given language model's tokenizer, without adding special tokens.
+  /// Used to budget the prompt before generating, so it should not decode anything.
+  /// @param texts The texts to count
+  /// @param llm_model_config The LLM model configuration to use
+  /// @param model_files The model files of the LLM
+  /// @return token count of each text in the same order as texts, or an unexpected OdaiResultEnum indicating the error.
+  virtual OdaiResult<std::vector<uint32_t>> count_llm_tokens(const std::vector<std::string>& texts,
+                                                             const LLMModelConfig& llm_model_config,
+                                                             const ModelFiles& model_files) = 0;
+
+  /// Scores how relevant each document is to a query with a cross-encoder reranker model.
+  /// Implementations should score several documents per model call instead of one query and document pair at a time.
+  /// @param query The query the documents are scored against
+  /// @param documents The documents to score
+  /// @param reranker_model_config The reranker model configuration to use
+  /// @param model_files The model files of the reranker model
+  /// @return relevance scores between 0.0 and 1.0 (higher is more relevant) in the same order as documents, or an
+  /// unexpected OdaiResultEnum indicating the error.
+  virtual OdaiResult<std::vector<float>> rerank(const std::string& query, const std::vector<std::string>& documents,
+                                                const RerankerModelConfig& reranker_model_config,
+                                                const ModelFiles& model_files) = 0;
+
   virtual ~IOdaiBackendEngine() = default;
 };
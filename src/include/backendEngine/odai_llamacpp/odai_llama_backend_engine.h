@@ -131,6 +131,68 @@ public:
                                    const SamplerConfig& sampler_config, OdaiStreamRespCallbackFn callback,
                                    void* user_data) override;
 
+  /// Generates L2-normalized embeddings for a batch of texts with the given embedding model.
+  /// Texts are packed into multi-sequence decodes and each text is truncated to the embedding context window.
+  /// @param texts The texts to embed
+  /// @param embedding_model_config The embedding model configuration to use
+  /// @param model_files The model files of the embedding model
+  /// @return embeddings in the same order as texts, or an unexpected OdaiResultEnum indicating the error.
+  OdaiResult<std::vector<std::vector<float>>> generate_embeddings(const std::vector<std::string>& texts,
+                                                                  const EmbeddingModelConfig& embedding_model_config,
+                                                                  const ModelFiles& model_files) override;
+
+  /// Tokenizes consecutive pieces of a text with the given embedding model on a pool of threads, one per hardware
+  /// thread. No special tokens are added and special token text inside the pieces is not parsed. For vocabularies that
+  /// prepend a space to every text (SentencePiece style), one leading space of a piece is folded into that prefix.
+  /// @param texts The pieces to tokenize
+  /// @param embedding_model_config The embedding model configuration to use
+  /// @param model_files The model files of the embedding model
+  /// @return token ids of each piece in the same order as texts, or an unexpected OdaiResultEnum indicating the error.
+  OdaiResult<std::vector<std::vector<TokenId>>>
+  tokenize_embedding_texts(const std::vector<std::string>& texts, const EmbeddingModelConfig& embedding_model_config,
+                           const ModelFiles& model_files) override;
+
+  /// Generates L2-normalized embeddings for already tokenized texts.
+  /// Each sequence is wrapped in the model's special tokens, then packed and truncated like generate_embeddings does.
+  /// @param token_sequences Token ids of each text to embed, without special tokens
+  /// @param embedding_model_config The embedding model configuration to use
+  /// @param model_files The model files of the embedding model
+  /// @return embeddings in the same order as token_sequences, or an unexpected OdaiResultEnum indicating the error.
+  OdaiResult<std::vector<std::vector<float>>>
+  generate_embeddings_from_tokens(const std::vector<std::vector<TokenId>>& token_sequences,
+                                  const EmbeddingModelConfig& embedding_model_config,
+                                  const ModelFiles& model_files) override;
+
+  /// Reads the embedding dimension (n_embd) of the embedding model, loading the model if it isn't loaded.
+  /// @param embedding_model_config The embedding model configuration to use
+  /// @param model_files The model files of the embedding model
+  /// @return the embedding dimension, or an unexpected OdaiResultEnum indicating the error.
+  OdaiResult<uint32_t> get_embedding_dimensions(const EmbeddingModelConfig& embedding_model_config,
+                                                const ModelFiles& model_files) override;
+
+  /// Counts the tokens of texts with the language model's vocabulary, loading the model if it isn't loaded with this
+  /// config. Special token text inside the texts is not parsed, like the content of chat messages.
+  /// @param texts The texts to count
+  /// @param llm_model_config The LLM model configuration to use
+  /// @param model_files The model files of the LLM
+  /// @return token count of each text in the same order as texts, or an unexpected OdaiResultEnum indicating the error.
+  OdaiResult<std::vector<uint32_t>> count_llm_tokens(const std::vector<std::string>& texts,
+                                                     const LLMModelConfig& llm_model_config,
+                                                     const ModelFiles& model_files) override;
+
+  /// Scores documents against a query with a cross-encoder reranker model (rank pooling GGUF, e.g. bge-reranker).
+  /// Each pair is formatted with the model's rerank template if it has one, otherwise as query and document separated
+  /// by the model's EOS / SEP tokens. Pairs are packed into multi-sequence decodes and documents are truncated so a
+  /// pair fits the reranker context window. The model's relevance logit is mapped to [0, 1] with a sigmoid.
+  /// @param query The query the documents are scored against
+  /// @param documents The documents to score
+  /// @param reranker_model_config The reranker model configuration to use
+  /// @param model_files The model files of the reranker model
+  /// @return scores in the same order as documents, or an unexpected OdaiResultEnum indicating the error.
+  OdaiResult<std::vector<float>> rerank(const std::string& query, const std::vector<std::string>& documents,
+                                        const RerankerModelConfig& reranker_model_config,
+                                        const ModelFiles& model_files) override;
+
   /// Destructor that frees the llama backend resources.
   /// @note llama.cpp backends loaded via ggml_backend_load_all() are NOT intended to be unloaded
   /// manually during application lifecycle. Unloading graphics/compute DLLs mid-execution is
@@ -246,6 +308,27 @@ private:
   ModelFiles m_embeddingModelFiles{};
 
   std::unique_ptr<llama_model, LlamaModelDeleter> m_embeddingModel = nullptr;
+
+  /// How the loaded embedding model's tokenizer treats a whole text, detected when the model is loaded so that texts
+  /// tokenized piece by piece can be embedded like texts tokenized in one go.
+  struct EmbeddingTokenizerTraits
+  {
+    /// Special tokens added before every text (e.g. BOS / CLS)
+    std::vector<llama_token> m_prefixTokens;
+    /// Special tokens added after every text (e.g. EOS / SEP)
+    std::vector<llama_token> m_suffixTokens;
+    /// Whether the tokenizer prepends a space to every text
+    bool m_addsSpacePrefix = false;
+  };
+
+  EmbeddingTokenizerTraits m_embeddingTokenizerTraits{};
+
+  RerankerModelConfig m_rerankerModelConfig{};
+
+  ModelFiles m_rerankerModelFiles{};
+
+  std::unique_ptr<llama_model, LlamaModelDeleter> m_rerankerModel = nullptr;
+
   LoadedLanguageModelState m_loadedLlmState{};
 
   /// Registers ggml backends, then discovers candidate devices according to ODAI's runtime policy.
@@ -442,6 +525,13 @@ private:
   /// @return empty result on success, or an unexpected OdaiResultEnum on failure.
   OdaiResult<void> load_embedding_model(const ModelFiles& files, const EmbeddingModelConfig& config);
 
+  /// Loads a reranker model from the specified configuration.
+  /// If the same model is already loaded, only updates the configuration.
+  /// @param files The generic model files containing paths.
+  /// @param config Configuration containing parameters.
+  /// @return empty result on success, or an unexpected OdaiResultEnum on failure.
+  OdaiResult<void> load_reranker_model(const ModelFiles& files, const RerankerModelConfig& config);
+
   /// Loads a language model from the specified configuration.
   /// If the same model is already loaded, only updates the configuration.
   /// @param files The generic model files containing paths.
@@ -463,7 +553,7 @@ private:
   prepare_reusable_llm_context_for_request(const std::vector<ChatMessage>* chat_history = nullptr);
 
   /// Creates a new llama context for the specified model type.
-  /// @param model_type Type of model (LLM or EMBEDDING) to create context for
+  /// @param model_type Type of model (LLM, EMBEDDING or RERANKER) to create context for
   /// @return Unique pointer to the context, or nullptr on error
   std::unique_ptr<llama_context, LlamaContextDeleter> get_new_llama_context(ModelType model_type);
 
@@ -493,6 +583,64 @@ private:
   static void add_tokens_to_batch(const std::vector<llama_token>& tokens, llama_batch& batch, uint32_t& start_pos,
                                   llama_seq_id seq_id, bool set_logit_request_for_last_token);
 
+  /// Detects the special tokens and space prefix handling of an embedding model's tokenizer.
+  /// @param vocab Vocabulary of the embedding model
+  /// @return the detected traits, or an unexpected OdaiResultEnum if tokenization failed.
+  static OdaiResult<EmbeddingTokenizerTraits> detect_embedding_tokenizer_traits(const llama_vocab* vocab);
+
+  /// Validates the embedding model files and loads the model if it isn't loaded yet.
+  /// @param model_files The model files of the embedding model
+  /// @param embedding_model_config The embedding model configuration to use
+  /// @return empty result on success, or an unexpected OdaiResultEnum on failure.
+  OdaiResult<void> prepare_embedding_model(const ModelFiles& model_files,
+                                           const EmbeddingModelConfig& embedding_model_config);
+
+  /// Embeds token sequences with the loaded embedding model, packing them into multi-sequence decodes.
+  /// Sequences longer than the embedding context window are truncated.
+  /// @param token_sequences Token ids of each text including special tokens, every sequence must be non-empty
+  /// @return embeddings in the same order as token_sequences, or an unexpected OdaiResultEnum on failure.
+  OdaiResult<std::vector<std::vector<float>>>
+  embed_token_sequences(std::vector<std::vector<llama_token>>& token_sequences);
+
+  /// Decodes one packed embedding batch and appends the pooled, normalized embedding of each sequence.
+  /// Sequences are expected to use ids 0..n_sequences-1 in the batch.
+  /// @param context Embedding context to decode with, its memory is cleared before decoding
+  /// @param batch The packed batch to decode
+  /// @param n_sequences Number of sequences packed in the batch
+  /// @param n_embd Embedding dimension of the model
+  /// @param embeddings_out Vector the embeddings are appended to (modified in place)
+  /// @return empty result on success, or an unexpected OdaiResultEnum on failure.
+  static OdaiResult<void> decode_embedding_batch(llama_context& context, const llama_batch& batch, int32_t n_sequences,
+                                                 int32_t n_embd, std::vector<std::vector<float>>& embeddings_out);
+
+  /// Part of the token sequence the loaded reranker scores for each query and document pair.
+  struct RerankLayoutSegment
+  {
+    /// Whether the segment stands for the document, otherwise it holds fixed tokens (template text, special tokens,
+    /// query)
+    bool m_isDocument = false;
+    std::vector<llama_token> m_tokens;
+  };
+
+  /// Builds the layout of the pairs the loaded reranker scores for one query.
+  /// Follows the model's rerank template if it has one ({query} and {document} placeholders), otherwise lays out
+  /// [BOS] query [EOS] [SEP] document [EOS] with the special tokens the vocabulary adds.
+  /// @param query The query, its text is never parsed for special tokens
+  /// @param max_query_tokens The query is truncated to this many tokens
+  /// @return the segments in sequence order, or an unexpected OdaiResultEnum if tokenization failed
+  OdaiResult<std::vector<RerankLayoutSegment>> build_rerank_layout(const std::string& query,
+                                                                   size_t max_query_tokens) const;
+
+  /// Decodes one packed rerank batch and appends the relevance score of each sequence.
+  /// Sequences are expected to use ids 0..n_sequences-1 in the batch.
+  /// @param context Reranker context to decode with, its memory is cleared before decoding
+  /// @param batch The packed batch to decode
+  /// @param n_sequences Number of sequences packed in the batch
+  /// @param scores_out Vector the scores are appended to (modified in place)
+  /// @return empty result on success, or an unexpected OdaiResultEnum on failure.
+  static OdaiResult<void> decode_rerank_batch(llama_context& context, const llama_batch& batch, int32_t n_sequences,
+                                              std::vector<float>& scores_out);
+
   /// Converts a vector of tokens back into a string.
   /// @param tokens Vector of tokens to detokenize
   /// @return Detokenized string on success, or an unexpected OdaiResultEnum on failure.
@@ -2,7 +2,10 @@
 
 #include "types/odai_result.h"
 #include "types/odai_types.h"
+#include <cstdint>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <nlohmann/json.hpp>
@@ -105,7 +108,8 @@ public:
   /// @return stored item details on success, or an unexpected OdaiResultEnum indicating the error
   virtual OdaiResult<InputItem> store_media_item(const InputItem& item) = 0;
 
-  /// Creates a new semantic space.
+  /// Creates a new semantic space, with its vector storage when config.m_dimensions is set. Otherwise the storage is
+  /// sized by the first embeddings added to the space.
   /// @param config The configuration for the semantic space.
   /// @return empty expected if created successfully, or an unexpected OdaiResultEnum indicating the error.
   virtual OdaiResult<void> create_semantic_space(const SemanticSpaceConfig& config) = 0;
@@ -119,11 +123,227 @@ public:
   /// @return semantic space configurations on success, or an unexpected OdaiResultEnum indicating the error.
   virtual OdaiResult<std::vector<SemanticSpaceConfig>> list_semantic_spaces() = 0;
 
-  /// Deletes a semantic space.
+  /// Deletes a semantic space along with its vector storage. An imported knowledge pack is detached, its file is kept.
   /// @param name The name of the semantic space to delete.
   /// @return empty expected if deleted successfully, or an unexpected OdaiResultEnum indicating the error.
   virtual OdaiResult<void> delete_semantic_space(const SemanticSpaceName& name) = 0;
 
+  /// Writes a semantic space to a knowledge pack: a single versioned file holding the space's config, documents,
+  /// chunks and vectors, and optionally its approximate nearest neighbour index, that import_knowledge_pack() attaches
+  /// on another device without re-embedding anything.
+  /// @param name The semantic space to export.
+  /// @param pack_path File to create.
+  /// @param include_ann_index Whether to store the space's HNSW index in the pack, ignored for flat spaces. Without it
+  /// the index is built in memory on the pack's first search.
+  /// @return empty expected if written, or an unexpected OdaiResultEnum indicating the error (NOT_FOUND for a missing
+  /// space, ALREADY_EXISTS if pack_path exists or pack_path + ".tmp", where the pack is written first, does,
+  /// VALIDATION_FAILED for a space that is itself a knowledge pack).
+  virtual OdaiResult<void> export_knowledge_pack(const SemanticSpaceName& name, const std::string& pack_path,
+                                                 bool include_ann_index) = 0;
+
+  /// Attaches a knowledge pack as a read-only semantic space. The pack is searched in place, nothing is copied into the
+  /// database, and it stays attached across restarts until the space is deleted.
+  /// @param pack_path The pack file, written by export_knowledge_pack().
+  /// @param name Name of the attached space, empty keeps the name the space was exported with.
+  /// @return the attached space's config, or an unexpected OdaiResultEnum indicating the error (NOT_FOUND for a missing
+  /// file or an embedding model that isn't registered, VALIDATION_FAILED for a file that isn't a pack of this format
+  /// version or a model registered with other files than the pack was embedded with, ALREADY_EXISTS if the name is
+  /// taken).
+  virtual OdaiResult<SemanticSpaceConfig> import_knowledge_pack(const std::string& pack_path,
+                                                                const SemanticSpaceName& name) = 0;
+
+  /// Finds which of the given chunk content hashes don't have an embedding stored in the semantic space yet.
+  /// Used during ingestion so only new content gets embedded.
+  /// @param semantic_space_name The semantic space to check.
+  /// @param content_hashes Content hashes of the chunks to check.
+  /// @return hashes that still need an embedding on success, or an unexpected OdaiResultEnum indicating the error.
+  virtual OdaiResult<std::unordered_set<uint64_t>>
+  get_unembedded_chunk_hashes(const SemanticSpaceName& semantic_space_name,
+                              const std::vector<uint64_t>& content_hashes) = 0;
+
+  /// Reads embeddings an embedding model already made for chunk contents, whichever semantic space they were made for.
+  /// Lets ingestion skip the forward pass for content embedded before with the same model file.
+  /// @param model_checksums Checksums of the embedding model, as returned by get_model_checksums().
+  /// @param content_hashes Content hashes of the chunks to look up.
+  /// @return the stored embeddings by content hash, only for contents that have one, or an unexpected OdaiResultEnum
+  /// indicating the error.
+  virtual OdaiResult<std::unordered_map<uint64_t, std::vector<float>>>
+  get_stored_chunk_embeddings(const std::string& model_checksums, const std::vector<uint64_t>& content_hashes) = 0;
+
+  /// Stores embeddings made by an embedding model for later get_stored_chunk_embeddings() calls. Contents that already
+  /// have an embedding for the model keep it.
+  /// @param model_checksums Checksums of the embedding model, as returned by get_model_checksums().
+  /// @param content_hashes Content hashes of the embedded chunks.
+  /// @param embeddings The full embeddings output by the model, before any truncation, one per content hash.
+  /// @return empty expected if stored, or an unexpected OdaiResultEnum indicating the error (VALIDATION_FAILED if the
+  /// counts differ or an embedding is empty).
+  virtual OdaiResult<void> store_chunk_embeddings(const std::string& model_checksums,
+                                                  const std::vector<uint64_t>& content_hashes,
+                                                  const std::vector<std::vector<float>>& embeddings) = 0;
+
+  /// Adds a document with its chunks and their embeddings to a semantic space, all in a single transaction.
+  /// Chunks are deduplicated by content hash. A chunk with an empty embedding reuses the embedding the semantic space
+  /// already stores for the same content.
+  /// @param document_id Unique identifier for the document.
+  /// @param source_uri App-side identifier of the document source (file path, message range, etc.), empty for
+  /// documents without one such as content added from memory.
+  /// @param semantic_space_name The semantic space to add the document to.
+  /// @param scope_id Scope the document belongs to.
+  /// @param chunks The document chunks in document order.
+  /// @param metadata Metadata of the document, the values of the space's filter fields are stored with its vectors.
+  /// @return empty expected if the document was stored, or an unexpected OdaiResultEnum indicating the error
+  /// (ALREADY_EXISTS for a duplicate document id, NOT_FOUND for a missing semantic space, VALIDATION_FAILED if a chunk
+  /// has no embedding and none can be reused).
+  virtual OdaiResult<void> add_document(const DocumentId& document_id, const std::string& source_uri,
+                                        const SemanticSpaceName& semantic_space_name, const ScopeId& scope_id,
+                                        const std::vector<DocumentChunk>& chunks,
+                                        const DocumentMetadata& metadata) = 0;
+
+  /// Appends chunks to an existing document, storing them in the document's semantic space, scope and metadata.
+  /// Lets large documents be ingested in parts: the caller adds the first part with add_document and appends the rest,
+  /// wrapping all calls in one transaction to keep the document atomic.
+  /// @param document_id The existing document
+  /// @param chunks The chunks to append, with sequence indexes continuing the ones already stored
+  /// @return empty expected if the chunks were stored, or an unexpected OdaiResultEnum indicating the error
+  /// (NOT_FOUND if the document doesn't exist, VALIDATION_FAILED if a chunk has no embedding and none can be reused).
+  virtual OdaiResult<void> append_document_chunks(const DocumentId& document_id,
+                                                  const std::vector<DocumentChunk>& chunks) = 0;
+
+  /// Replaces the chunks and metadata of an existing document with the ones of its new version, all in a single
+  /// transaction.
+  /// Chunks whose content the document or its scope already stores keep their chunk row and vector and only take their
+  /// new sequence index, the others are stored like in add_document. Kept vectors take the new filter values. Chunks
+  /// and vectors no document references anymore are removed.
+  /// @param document_id The existing document.
+  /// @param semantic_space_name The semantic space the document was added to.
+  /// @param scope_id Scope the document belongs to.
+  /// @param chunks The chunks of the new version in document order.
+  /// @param metadata Metadata of the new version, replacing the stored one like in add_document.
+  /// @return empty expected if the document was updated, or an unexpected OdaiResultEnum indicating the error
+  /// (NOT_FOUND if the document doesn't exist in that space and scope, VALIDATION_FAILED if a chunk has no embedding
+  /// and none can be reused).
+  virtual OdaiResult<void> update_document(const DocumentId& document_id, const SemanticSpaceName& semantic_space_name,
+                                           const ScopeId& scope_id, const std::vector<DocumentChunk>& chunks,
+                                           const DocumentMetadata& metadata) = 0;
+
+  /// Removes a document with its chunk references and document vector, all in a single transaction. Chunks and vectors
+  /// no document references anymore are removed.
+  /// @param document_id The existing document.
+  /// @param semantic_space_name The semantic space the document was added to.
+  /// @param scope_id Scope the document belongs to.
+  /// @return empty expected if the document was removed, or an unexpected OdaiResultEnum indicating the error
+  /// (NOT_FOUND if the document doesn't exist in that space and scope).
+  virtual OdaiResult<void> delete_document(const DocumentId& document_id, const SemanticSpaceName& semantic_space_name,
+                                           const ScopeId& scope_id) = 0;
+
+  /// Starts re-embedding a semantic space with a new embedding model. The space keeps serving its current vectors
+  /// while new ones are written aside by store_reembedded_vectors(), finish_reembedding() then switches the space to
+  /// them at once. The job is persisted, so it can be resumed from another connection or after a restart.
+  /// @param target_config The space's config with the new embedding model and dimensions (and optionally a new
+  /// truncation), every other setting must be unchanged.
+  /// @param config Batching and pacing of the job, stored with it.
+  /// @return empty expected if the job was created, or an unexpected OdaiResultEnum indicating the error (NOT_FOUND
+  /// for a missing space, ALREADY_EXISTS if the space already has a job, VALIDATION_FAILED for an invalid target).
+  virtual OdaiResult<void> start_reembedding(const SemanticSpaceConfig& target_config,
+                                             const ReembedConfig& config) = 0;
+
+  /// @param semantic_space_name The semantic space.
+  /// @return the space's re-embedding job with its progress, or an unexpected OdaiResultEnum indicating the error
+  /// (NOT_FOUND if the space has no job).
+  virtual OdaiResult<ReembedJob> get_reembedding_job(const SemanticSpaceName& semantic_space_name) = 0;
+
+  /// @return all pending re-embedding jobs with their progress, or an unexpected OdaiResultEnum indicating the error.
+  virtual OdaiResult<std::vector<ReembedJob>> list_reembedding_jobs() = 0;
+
+  /// Reads the next vectors of a space to re-embed, with the content of their chunks.
+  /// @param semantic_space_name The semantic space being re-embedded.
+  /// @param limit Maximum number of vectors to return.
+  /// @return the vectors following the last stored batch in increasing id order (empty once all are re-embedded), or
+  /// an unexpected OdaiResultEnum indicating the error (NOT_FOUND if the space has no job).
+  virtual OdaiResult<std::vector<ReembedChunk>> get_reembedding_batch(const SemanticSpaceName& semantic_space_name,
+                                                                      uint32_t limit) = 0;
+
+  /// Stores re-embedded vectors of a batch and records the job's progress in the same transaction. Vectors removed
+  /// since the batch was read are skipped.
+  /// @param semantic_space_name The semantic space being re-embedded.
+  /// @param chunks A batch from get_reembedding_batch() with their m_embedding filled.
+  /// @return empty expected if stored, or an unexpected OdaiResultEnum indicating the error (NOT_FOUND if the space
+  /// has no job, e.g. it was cancelled, VALIDATION_FAILED if the batch was already stored or embeddings don't match
+  /// the target dimensions).
+  virtual OdaiResult<void> store_reembedded_vectors(const SemanticSpaceName& semantic_space_name,
+                                                    const std::vector<ReembedChunk>& chunks) = 0;
+
+  /// Switches a space to its re-embedded vectors and target config, rebuilds its document vectors from them and drops
+  /// the old vectors, all in one transaction.
+  /// @param semantic_space_name The semantic space being re-embedded.
+  /// @return true if the space switched, false if vectors were added since the last batch and still need to be
+  /// re-embedded, or an unexpected OdaiResultEnum indicating the error (NOT_FOUND if the space has no job).
+  virtual OdaiResult<bool> finish_reembedding(const SemanticSpaceName& semantic_space_name) = 0;
+
+  /// Cancels a space's re-embedding job and drops the vectors it stored, the space keeps its current config.
+  /// @param semantic_space_name The semantic space being re-embedded.
+  /// @return empty expected if cancelled, or an unexpected OdaiResultEnum indicating the error (NOT_FOUND if the space
+  /// has no job).
+  virtual OdaiResult<void> cancel_reembedding(const SemanticSpaceName& semantic_space_name) = 0;
+
+  /// Finds the chunks of a scope whose embeddings are nearest to the query embedding in a semantic space.
+  /// @param semantic_space_name The semantic space to search.
+  /// @param scope_id Only chunks of documents in this scope are returned.
+  /// @param query_embedding Embedding of the query, made with the semantic space's embedding model.
+  /// @param limit Maximum number of chunks to return.
+  /// @param include_embeddings Whether to fill each chunk's m_embedding with its stored embedding.
+  /// @param filter Only chunks of documents matching it are compared with the query, the filter is applied by the
+  /// vector scan so the limit is filled with matching chunks.
+  /// @return chunks ordered from most to least similar (empty if the scope has none), or an unexpected OdaiResultEnum
+  /// indicating the error (NOT_FOUND for a missing semantic space, VALIDATION_FAILED if the query embedding doesn't
+  /// match the stored dimensions or the filter uses a field the space doesn't declare).
+  virtual OdaiResult<std::vector<RetrievedChunk>> search_chunks(const SemanticSpaceName& semantic_space_name,
+                                                                const ScopeId& scope_id,
+                                                                const std::vector<float>& query_embedding,
+                                                                uint32_t limit, bool include_embeddings,
+                                                                const MetadataFilter& filter) = 0;
+
+  /// Two-stage variant of search_chunks(): first picks the documents of the scope whose document vectors (the mean
+  /// direction of their chunk embeddings) are nearest to the query, then only compares the chunks of those documents.
+  /// @param semantic_space_name The semantic space to search.
+  /// @param scope_id Only chunks of documents in this scope are returned.
+  /// @param query_embedding Embedding of the query, made with the semantic space's embedding model.
+  /// @param document_limit Number of documents whose chunks are compared with the query.
+  /// @param limit Maximum number of chunks to return.
+  /// @param include_embeddings Whether to fill each chunk's m_embedding with its stored embedding.
+  /// @param filter Only documents matching it are picked.
+  /// @return chunks ordered from most to least similar, or an unexpected OdaiResultEnum indicating the error
+  /// (NOT_FOUND for a missing semantic space, VALIDATION_FAILED if the query embedding doesn't match the stored
+  /// dimensions, document_limit is 0 or the filter uses a field the space doesn't declare).
+  virtual OdaiResult<std::vector<RetrievedChunk>>
+  search_chunks_in_top_documents(const SemanticSpaceName& semantic_space_name, const ScopeId& scope_id,
+                                 const std::vector<float>& query_embedding, uint32_t document_limit, uint32_t limit,
+                                 bool include_embeddings, const MetadataFilter& filter) = 0;
+
+  /// Finds the chunks of a scope best matching the words of a query with full text search, ranked by BM25.
+  /// A chunk matches if it contains any of the query's words, chunks containing more or rarer query words rank higher.
+  /// @param semantic_space_name The semantic space to search.
+  /// @param scope_id Only chunks of documents in this scope are returned.
+  /// @param query_text The query, searched word by word without any query syntax.
+  /// @param limit Maximum number of chunks to return.
+  /// @param filter Only chunks of documents matching it are returned.
+  /// @return chunks ordered from best to worst match (empty if nothing matches or the query has no words), or an
+  /// unexpected OdaiResultEnum indicating the error (NOT_FOUND for a missing semantic space, VALIDATION_FAILED if the
+  /// filter uses a field the space doesn't declare).
+  virtual OdaiResult<std::vector<RetrievedChunk>>
+  search_chunks_by_keywords(const SemanticSpaceName& semantic_space_name, const ScopeId& scope_id,
+                            const std::string& query_text, uint32_t limit, const MetadataFilter& filter) = 0;
+
+  /// Reads spans of consecutive chunks of documents, in document order.
+  /// @param semantic_space_name The semantic space of the documents.
+  /// @param spans The spans to read.
+  /// @return for each span, its chunks with m_contentText and m_sequenceIndex filled, ordered by sequence index.
+  /// Positions past the document's end are skipped, a missing document gives an empty span. Or an unexpected
+  /// OdaiResultEnum indicating the error (VALIDATION_FAILED for a span ending before it starts).
+  virtual OdaiResult<std::vector<std::vector<DocumentChunk>>>
+  get_document_chunk_spans(const SemanticSpaceName& semantic_space_name,
+                           const std::vector<DocumentChunkSpan>& spans) = 0;
+
   /// Checks if a chat session with the given chat_id exists in the database.
   /// @param chat_id The chat identifier to check
   /// @return true/false on success, or an unexpected OdaiResultEnum indicating the error
@@ -0,0 +1,236 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "types/odai_result.h"
+#include "types/odai_types.h"
+#include "utils/odai_mapped_file.h"
+
+/// Approximate nearest neighbour index (HNSW graph) over the vectors of one semantic space.
+/// Vectors are L2-normalized on insertion and compared by cosine distance, and each one is identified by its rowid in
+/// the space's vector table. Every vector belongs to a scope: a search walks the whole graph but only returns vectors
+/// of the requested scope.
+/// The graph is stored as flat arrays with fixed size link lists, so a saved index is memory-mapped by load() and
+/// searched in place without reading the file up front. The first insertion after a load copies the arrays into
+/// memory.
+/// Nodes can't be unlinked from the graph, a removed vector is marked deleted instead: searches still walk through it
+/// to reach its neighbours but never return it. needs_rebuild() tells when enough nodes are deleted that the graph
+/// should be built again from the remaining vectors.
+/// Not thread safe.
+class OdaiHnswIndex
+{
+public:
+  /// A vector found by search()
+  struct SearchHit
+  {
+    int64_t m_vectorRowid{};
+    /// Cosine distance to the query, 0 for identical directions
+    float m_distance{};
+  };
+
+  /// Creates an empty index.
+  /// @param dimensions Dimension of the indexed vectors
+  /// @param config Vector index configuration of the space, expected to be a sane VECTOR_INDEX_HNSW config
+  OdaiHnswIndex(uint32_t dimensions, const VectorIndexConfig& config);
+
+  OdaiHnswIndex(const OdaiHnswIndex&) = delete;
+  OdaiHnswIndex& operator=(const OdaiHnswIndex&) = delete;
+  OdaiHnswIndex(OdaiHnswIndex&&) = delete;
+  OdaiHnswIndex& operator=(OdaiHnswIndex&&) = delete;
+
+  /// Maps an index saved by save().
+  /// @param path The index file
+  /// @param config Vector index configuration of the space, its search settings replace the saved ones
+  /// @param offset Byte offset of the index in the file, for an index appended to another file. Must keep the mapped
+  /// sections aligned, i.e. be a multiple of 64.
+  /// @return the index on success, or an unexpected OdaiResultEnum (NOT_FOUND if there is no file or nothing past
+  /// offset, VALIDATION_FAILED if the file is corrupt, from another format version or was built with different graph
+  /// settings)
+  static OdaiResult<std::unique_ptr<OdaiHnswIndex>> load(const std::filesystem::path& path,
+                                                         const VectorIndexConfig& config, uint64_t offset = 0);
+
+  /// Writes the index to a file, replacing it atomically.
+  /// @param path The index file
+  /// @return empty expected on success, or an unexpected OdaiResultEnum indicating the error
+  OdaiResult<void> save(const std::filesystem::path& path);
+
+  /// Inserts a vector.
+  /// @param vector_rowid Rowid of the vector, must be greater than every rowid already in the index
+  /// @param scope_id Scope of the vector
+  /// @param embedding The vector, normalized before it is stored
+  /// @return empty expected on success, or VALIDATION_FAILED for a wrong dimension or a rowid out of order
+  OdaiResult<void> add(int64_t vector_rowid, const ScopeId& scope_id, const std::vector<float>& embedding);
+
+  /// Marks the node of a vector deleted, searches no longer return it.
+  /// @param vector_rowid Rowid of the removed vector
+  /// @return true if a node was marked, false if the rowid isn't indexed or already deleted
+  bool mark_deleted(int64_t vector_rowid);
+
+  /// Marks deleted every node whose vector isn't among the given ones, e.g. to catch a saved index up with vectors
+  /// removed since it was saved.
+  /// @param vector_rowids Rowids of the vectors still stored up to max_rowid(), ascending
+  /// @return number of nodes marked, or VALIDATION_FAILED if a rowid has no live node (the index belongs to another
+  /// state of the vectors)
+  OdaiResult<size_t> retain_only(const std::vector<int64_t>& vector_rowids);
+
+  /// Finds the vectors of a scope nearest to the query.
+  /// @param query The query vector, must have the index's dimension
+  /// @param scope_id Only vectors of this scope are returned
+  /// @param k Maximum number of vectors to return
+  /// @return up to k hits ordered from nearest to farthest
+  std::vector<SearchHit> search(const std::vector<float>& query, const ScopeId& scope_id, uint32_t k) const;
+
+  /// Tells whether searching a scope through the graph beats scanning its vectors.
+  /// Walking the graph for a scope holding a small share of the index visits many vectors of other scopes, an exact
+  /// scan of the scope alone is then faster and exact.
+  /// @param scope_id The scope to search
+  /// @return true if search() should be used for this scope
+  bool prefers_graph_search(const ScopeId& scope_id) const;
+
+  /// @return true once more than 1 / HNSW_MAX_DELETED_SHARE of the nodes are deleted, searches then walk through
+  /// enough dead nodes that building the graph again pays off
+  bool needs_rebuild() const;
+
+  /// @return number of live (not deleted) vectors
+  size_t size() const { return m_count - m_deletedCount; }
+  size_t deleted_count() const { return m_deletedCount; }
+  uint32_t dimensions() const { return m_dimensions; }
+  /// @return the greatest indexed rowid, 0 for an empty index
+  int64_t max_rowid() const { return m_maxRowid; }
+  /// @return true if the index changed since it was created, loaded or saved
+  bool is_dirty() const { return m_dirty; }
+
+private:
+  /// Array viewing the mapped index file, or owning its elements once the index is modified.
+  template <typename T>
+  class Storage
+  {
+  public:
+    void view(const T* data, size_t size)
+    {
+      m_owned.clear();
+      m_view = data;
+      m_size = size;
+    }
+
+    /// @return the owned elements, copying the viewed ones first if needed
+    std::vector<T>& own()
+    {
+      if (m_view != nullptr)
+      {
+        m_owned.assign(m_view, m_view + m_size);
+        m_view = nullptr;
+        m_size = 0;
+      }
+      return m_owned;
+    }
+
+    const T* data() const { return m_view != nullptr ? m_view : m_owned.data(); }
+    size_t size() const { return m_view != nullptr ? m_size : m_owned.size(); }
+
+  private:
+    const T* m_view = nullptr;
+    size_t m_size = 0;
+    std::vector<T> m_owned;
+  };
+
+  /// Distance and node id pair, ordered by distance
+  using Candidate = std::pair<float, uint32_t>;
+
+  uint32_t max_links(uint32_t level) const { return level == 0 ? m_maxLinksLevel0 : m_maxLinks; }
+
+  /// @return the link list of a node on a level, the first element is the number of links
+  const uint32_t* links(uint32_t node, uint32_t level) const;
+  uint32_t* mutable_links(uint32_t node, uint32_t level);
+
+  const float* vector(uint32_t node) const { return m_vectors.data() + static_cast<size_t>(node) * m_dimensions; }
+
+  float distance(const float* a, const float* b) const;
+
+  bool is_deleted(uint32_t node) const { return (m_deleted.data()[node / 64] >> (node % 64)) & 1U; }
+
+  /// @return the node of a vector, or NO_NODE if it isn't indexed
+  uint32_t find_node(int64_t vector_rowid) const;
+
+  /// Marks a live node deleted.
+  void mark_node_deleted(uint32_t node);
+
+  /// Checks a loaded graph before it is walked: rowid order, link counts, link targets and their levels, scope
+  /// ordinals, upper level blocks and deletion marks, one pass over every link list.
+  /// @param upper_block_count Number of upper level link blocks in the file
+  /// @return true if no walk of the graph can read outside its arrays
+  bool has_consistent_graph(uint64_t upper_block_count) const;
+
+  /// Copies every mapped array into memory and releases the mapping.
+  void materialize();
+
+  /// Greedily walks one level towards the query.
+  /// @return the closest node found and its distance
+  Candidate greedy_closest(const float* query, Candidate entry, uint32_t level) const;
+
+  /// Beam search on one level, walking through nodes of every scope and deleted ones.
+  /// @param scope_ordinal Only live nodes of this scope are collected, or SCOPE_ANY for all nodes, deleted ones
+  /// included, which insertions still link to so the graph stays connected
+  /// @return up to ef collected nodes, nearest first
+  std::vector<Candidate> search_level(const float* query, Candidate entry, uint32_t ef, uint32_t level,
+                                      uint32_t scope_ordinal) const;
+
+  /// Picks up to max_count diverse neighbours among candidates sorted nearest first (HNSW neighbour heuristic).
+  std::vector<uint32_t> select_neighbors(const std::vector<Candidate>& sorted_candidates, size_t max_count) const;
+
+  /// Links node to neighbor on a level, pruning the neighbour's links if it has too many.
+  void connect(uint32_t neighbor, uint32_t node, uint32_t level);
+
+  /// Prepares the visited markers for a new search.
+  /// @return the tag marking nodes visited by this search
+  uint32_t next_visit_tag() const;
+
+  static constexpr uint32_t NO_NODE = UINT32_MAX;
+  static constexpr uint32_t SCOPE_ANY = UINT32_MAX;
+
+  uint32_t m_dimensions;
+  VectorIndexConfig m_config;
+  uint32_t m_maxLinks;
+  uint32_t m_maxLinksLevel0;
+  double m_levelMultiplier;
+
+  /// Nodes in the graph, deleted ones included
+  size_t m_count = 0;
+  size_t m_deletedCount = 0;
+  int64_t m_maxRowid = 0;
+  uint32_t m_entryPoint = NO_NODE;
+  uint32_t m_maxLevel = 0;
+  bool m_dirty = false;
+
+  /// Normalized vectors, m_dimensions floats per node
+  Storage<float> m_vectors;
+  Storage<int64_t> m_rowids;
+  /// Scope ordinal of each node, indexing m_scopes
+  Storage<uint32_t> m_nodeScopes;
+  Storage<uint32_t> m_levels;
+  /// Level 0 link lists, (m_maxLinksLevel0 + 1) entries per node
+  Storage<uint32_t> m_level0Links;
+  /// Index of the node's first upper level block in m_upperLinks, one block of (m_maxLinks + 1) entries per level
+  Storage<uint32_t> m_upperLinkOffsets;
+  Storage<uint32_t> m_upperLinks;
+  /// Deletion marks, one bit per node
+  Storage<uint64_t> m_deleted;
+
+  std::vector<ScopeId> m_scopes;
+  /// Live nodes of each scope
+  std::vector<uint64_t> m_scopeSizes;
+  std::unordered_map<ScopeId, uint32_t> m_scopeOrdinalByName;
+
+  std::unique_ptr<OdaiMappedFile> m_mappedFile;
+  std::mt19937_64 m_levelGenerator;
+
+  mutable std::vector<uint32_t> m_visitTags;
+  mutable uint32_t m_visitTag = 0;
+};
@@ -3,13 +3,18 @@
 #ifdef ODAI_ENABLE_SQLITE_DB
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <SQLiteCpp/SQLiteCpp.h>
 #include <nlohmann/json.hpp>
 
 #include "db/odai_db.h"
+#include "db/odai_hnsw_index.h"
+#include "db/odai_sqlite/odai_sqlite_statement_cache.h"
 #include "types/odai_types.h"
 
 /// SQLite implementation of ODAIDb interface for managing RAG
@@ -24,6 +29,45 @@ private:
   uint16_t m_transactionDepth = 0;
   std::unique_ptr<SQLite::Transaction> m_transaction = nullptr;
 
+  /// Vector index configuration of each semantic space id seen so far, space ids are never reused
+  std::unordered_map<int64_t, VectorIndexConfig> m_vectorIndexConfigs;
+  /// Filter fields of each semantic space id seen so far, fixed once a space is created
+  std::unordered_map<int64_t, std::vector<std::string>> m_filterFields;
+  /// An HNSW index loaded from or built over a vector table
+  struct LoadedVectorIndex
+  {
+    /// Vector table the index was built over, a re-embedded space switches to another table
+    std::string m_vectorTable;
+    std::unique_ptr<OdaiHnswIndex> m_index;
+  };
+  /// HNSW indexes loaded so far, by semantic space id
+  std::unordered_map<int64_t, LoadedVectorIndex> m_vectorIndexes;
+  /// HNSW semantic spaces that got or lost vectors in the active transaction, their indexes are synced once it commits
+  std::unordered_set<int64_t> m_pendingIndexSpaces;
+  /// Vector rowids removed from HNSW semantic spaces in the active transaction, by space id. Their graph nodes are
+  /// marked deleted once it commits.
+  std::unordered_map<int64_t, std::vector<int64_t>> m_pendingIndexRemovals;
+
+  /// Set on a connection to a knowledge pack, opened read-only by open_knowledge_pack(): byte offset of the HNSW index
+  /// appended to the pack file, which is mapped from there instead of from a file next to the database. Indexes built
+  /// over a pack without one stay in memory.
+  std::optional<uint64_t> m_knowledgePackIndexOffset;
+  /// A knowledge pack attached as a read-only semantic space
+  struct AttachedKnowledgePack
+  {
+    std::unique_ptr<OdaiSqliteDb> m_db;
+    /// Name of the space inside the pack, the one it was exported with
+    SemanticSpaceName m_spaceName;
+  };
+  /// Attached knowledge packs, by the name of their space in this database. Searches of these spaces are delegated to
+  /// the pack's connection.
+  std::unordered_map<SemanticSpaceName, AttachedKnowledgePack> m_knowledgePacks;
+
+  /// Prepared statements of this connection, see cached_statement(). Declared after m_db so they are finalized
+  /// before the connection is closed.
+  OdaiSqliteStatementCache m_statementCache;
+  using CachedStatement = OdaiSqliteStatementCache::CachedStatement;
+
   /// Registers the sqlite-vec extension and opens the database connection.
   /// The extension is registered before creating the database object to enable
   /// vector operations.
@@ -39,11 +83,204 @@ private:
   /// @return stored item details on success, or an unexpected OdaiResultEnum indicating the error.
   OdaiResult<InputItem> store_media_item_impl(const InputItem& item, const std::string& checksum);
 
+  /// Looks up the internal id of a semantic space.
+  /// @note Throws SQLite::Exception on database errors, callers are expected to be inside a try block.
+  /// @param name The name of the semantic space.
+  /// @return The space id, or std::nullopt if the space doesn't exist.
+  std::optional<int64_t> find_semantic_space_id(const SemanticSpaceName& name);
+
+  /// Borrows the prepared statement of a SQL text from this connection's statement cache, see
+  /// OdaiSqliteStatementCache::borrow().
+  /// @note Throws SQLite::Exception on database errors, callers are expected to be inside a try block.
+  /// @param sql The statement's SQL, also its cache key. SQL naming vector tables is cached too, those statements are
+  /// evicted by drop_vector_tables().
+  CachedStatement cached_statement(const std::string& sql);
+
+  /// Drops a chunk vector table and its document vector table, evicting the cached statements using them first.
+  /// @note Throws SQLite::Exception on database errors, callers are expected to be inside a try block.
+  void drop_vector_tables(const std::string& vec_table);
+
+  /// @return the attached knowledge pack of a semantic space, or nullptr if the space isn't one
+  AttachedKnowledgePack* find_knowledge_pack(const SemanticSpaceName& name);
+
+  /// Opens a knowledge pack read-only with its pages memory-mapped, and checks that its embedding model is registered
+  /// in this database with the same files.
+  /// @param pack_path The pack file.
+  /// @return the opened pack, or an unexpected OdaiResultEnum indicating the error (see import_knowledge_pack()).
+  OdaiResult<AttachedKnowledgePack> open_knowledge_pack(const std::string& pack_path);
+
+  /// Re-attaches the knowledge packs recorded in the knowledge_pack table. A pack that fails to open is skipped with a
+  /// warning and stays recorded, so it is attached again once its file is back.
+  /// @note Throws SQLite::Exception on database errors, callers are expected to be inside a try block.
+  void attach_stored_knowledge_packs();
+
+  /// Writes the rows of a semantic space to a new database file laid out as a knowledge pack: the space becomes space
+  /// 1 of generation 0 and keeps its vector rowids, so the space's HNSW index stays valid for the pack.
+  /// @note Throws SQLite::Exception on database errors, callers are expected to be inside a try block.
+  /// @param pack_path The file to write, must not exist.
+  /// @param space_id Internal id of the exported space.
+  /// @param config Config of the exported space.
+  /// @param dimensions Dimension of the space's stored vectors, 0 if it has none.
+  void write_knowledge_pack(const std::string& pack_path, int64_t space_id, const SemanticSpaceConfig& config,
+                            size_t dimensions);
+
+  /// Reads the current vector generation of a semantic space, bumped each time a re-embedding job switches the space
+  /// to new vector tables. Read on every use rather than cached, another connection may finish a job.
+  /// @note Throws SQLite::Exception on database errors, callers are expected to be inside a try block.
+  /// @param space_id Internal id of the semantic space.
+  /// @return The space's vector generation, 0 if the space doesn't exist.
+  int64_t get_vector_generation(int64_t space_id);
+
+  /// @note Throws SQLite::Exception on database errors, callers are expected to be inside a try block.
+  /// @param space_id Internal id of the semantic space.
+  /// @return Name of the vector table the space currently stores and searches its chunk vectors in.
+  std::string live_vector_table(int64_t space_id);
+
+  /// Creates a sqlite-vec table for the chunk vectors of a semantic space, partitioned by scope_id, and the document
+  /// vector table next to it. Quantized storage adds an embedding_coarse column holding the quantized copy of each
+  /// vector, each filter field adds a filter_<field> metadata column to both tables.
+  /// @note Throws SQLite::Exception on database errors, callers are expected to be inside a try block.
+  /// @param vector_table Name of the chunk vector table.
+  /// @param dimensions Dimension of the space's embeddings.
+  /// @param storage_type Vector storage type of the space.
+  /// @param filter_fields Filter fields of the space.
+  void create_vector_table(const std::string& vector_table, size_t dimensions, VectorStorageType storage_type,
+                           const std::vector<std::string>& filter_fields);
+
+  /// A reembed_job row with the ids it applies to
+  struct StoredReembedJob
+  {
+    int64_t m_spaceId{};
+    /// Vector generation the job writes to, the one after the space's current generation
+    int64_t m_targetGeneration{};
+    /// Vectors up to this rowid are re-embedded
+    int64_t m_lastVectorRowid{};
+    ReembedJob m_job;
+  };
+
+  /// Reads the re-embedding job of a semantic space with its progress.
+  /// @note Throws SQLite::Exception on database errors, callers are expected to be inside a try block.
+  /// @param semantic_space_name The semantic space.
+  /// @return The job, or std::nullopt if the space doesn't exist or has no job.
+  std::optional<StoredReembedJob> find_reembedding_job(const SemanticSpaceName& semantic_space_name);
+
+  /// Stores chunks of an already inserted document: chunk rows (deduplicated by content hash), doc_chunk_ref rows and
+  /// one vector per (space, chunk, scope), creating the space's vector table if the space was created without
+  /// dimensions. The chunks' vectors are added to the document vector.
+  /// @note Must run inside a transaction and throws SQLite::Exception on database errors, the caller rolls back.
+  /// @param space_id Internal id of the document's semantic space.
+  /// @param document_id The document the chunks belong to.
+  /// @param scope_id Scope of the document.
+  /// @param chunks The chunks to store.
+  /// @return empty expected if stored, or VALIDATION_FAILED if a chunk has neither an embedding nor one to reuse.
+  OdaiResult<void> insert_document_chunks(int64_t space_id, const DocumentId& document_id, const ScopeId& scope_id,
+                                          const std::vector<DocumentChunk>& chunks);
+
+  /// Shared body of search_chunks() and search_chunks_in_top_documents().
+  /// @param document_limit Documents to restrict the search to, 0 searches every chunk of the scope.
+  OdaiResult<std::vector<RetrievedChunk>> search_vectors(const SemanticSpaceName& semantic_space_name,
+                                                         const ScopeId& scope_id,
+                                                         const std::vector<float>& query_embedding,
+                                                         uint32_t document_limit, uint32_t limit,
+                                                         bool include_embeddings, const MetadataFilter& filter);
+
+  /// Adds the vectors of a document's newly stored chunks to its document vector, creating the space's document vector
+  /// table and the document's vector if needed.
+  /// @note Throws SQLite::Exception on database errors, callers are expected to be inside a try block.
+  /// @param space_id Internal id of the document's semantic space.
+  /// @param document_id The document.
+  /// @param scope_id Scope of the document.
+  /// @param filter_values Values of the space's filter fields for the document, in field order.
+  /// @param chunk_vector_sum Sum of the L2-normalized vectors of the chunks.
+  void add_document_vector(int64_t space_id, const DocumentId& document_id, const ScopeId& scope_id,
+                           const std::vector<std::string>& filter_values, const std::vector<float>& chunk_vector_sum);
+
+  /// Rebuilds the document vectors of a semantic space into the document vector table next to a chunk vector table,
+  /// from the chunk vectors stored in that table.
+  /// @note Throws SQLite::Exception on database errors, callers are expected to be inside a try block.
+  /// @param space_id Internal id of the semantic space.
+  /// @param vector_table The chunk vector table, its document vector table must exist and be empty.
+  void rebuild_document_vectors(int64_t space_id, const std::string& vector_table);
+
+  /// Removes the vectors of chunks no document of the scope with the same filter values references anymore, and the
+  /// chunks themselves once no document references them at all.
+  /// @note Throws SQLite::Exception on database errors, callers are expected to be inside a try block.
+  /// @param space_id Internal id of the semantic space.
+  /// @param scope_id The scope that stopped referencing the chunks.
+  /// @param filter_key The filter_key of the documents that stopped referencing the chunks.
+  /// @param chunk_ids Chunks that may have lost their last reference.
+  /// @return number of vectors removed from the space's vector table.
+  size_t remove_orphaned_chunks(int64_t space_id, const ScopeId& scope_id, const std::string& filter_key,
+                                const std::vector<int64_t>& chunk_ids);
+
+  /// Moves the vectors of chunks an updated document keeps to the document's new filter values, rewriting the
+  /// chunk_vector_ref rows and the vector table's filter columns in place. Vectors other documents of the scope still
+  /// use with the old values, and vectors of chunks already stored with the new values, are left for
+  /// insert_document_chunks() to copy and remove_orphaned_chunks() to drop.
+  /// @note Throws SQLite::Exception on database errors, callers are expected to be inside a try block.
+  /// @param space_id Internal id of the semantic space.
+  /// @param scope_id Scope of the document.
+  /// @param old_filter_key The document's filter_key before the update, its references already removed.
+  /// @param filter_key The document's new filter_key.
+  /// @param chunk_ids Chunks the document referenced before the update.
+  /// @param chunks The chunks of the new version, the old chunks whose content they contain are the kept ones.
+  /// @return number of vectors moved.
+  size_t move_kept_vectors(int64_t space_id, const ScopeId& scope_id, const std::string& old_filter_key,
+                           const std::string& filter_key, const std::vector<int64_t>& chunk_ids,
+                           const std::vector<DocumentChunk>& chunks);
+
+  /// Removes a document's chunk references and document vector, returning the chunks it referenced.
+  /// @note Throws SQLite::Exception on database errors, callers are expected to be inside a try block.
+  /// @param space_id Internal id of the document's semantic space.
+  /// @param document_id The document.
+  /// @return ids of the chunks the document referenced, to pass to remove_orphaned_chunks().
+  std::vector<int64_t> remove_document_references(int64_t space_id, const DocumentId& document_id);
+
+  /// Builds the loaded HNSW graph of a space again from its stored vectors, dropping the nodes marked deleted, and
+  /// saves it. Runs after a write left too many deleted nodes (OdaiHnswIndex::needs_rebuild()), never from a search.
+  /// @note Throws SQLite::Exception on database errors, callers are expected to be inside a try block.
+  /// @param space_id Internal id of the semantic space.
+  void rebuild_vector_index(int64_t space_id);
+
+  /// Reads the vector index configuration of a semantic space, cached per space id.
+  /// @note Throws SQLite::Exception on database errors, callers are expected to be inside a try block.
+  /// @param space_id Internal id of the semantic space.
+  /// @return The space's vector index configuration, a flat one if the space doesn't exist.
+  const VectorIndexConfig& get_vector_index_config(int64_t space_id);
+
+  /// Reads the filter fields of a semantic space, cached per space id.
+  /// @note Throws SQLite::Exception on database errors, callers are expected to be inside a try block.
+  /// @param space_id Internal id of the semantic space.
+  /// @return The space's filter fields, none if the space doesn't exist.
+  const std::vector<std::string>& get_filter_fields(int64_t space_id);
+
+  /// Returns the HNSW index of a semantic space synced with its committed vectors, loading the saved index or
+  /// building a new one on first use. Vectors committed since the index was last synced are inserted in rowid order.
+  /// A saved index missing stored vectors is rebuilt, its vectors removed since it was saved are marked deleted.
+  /// @note Throws SQLite::Exception on database errors, callers are expected to be inside a try block.
+  /// @param space_id Internal id of the semantic space.
+  /// @return The index, or nullptr if the space is flat, has no vectors yet, a transaction is active (uncommitted
+  /// vectors can't be indexed) or the index couldn't be synced. Callers then search the vector table directly.
+  OdaiHnswIndex* get_vector_index(int64_t space_id);
+
+  /// Syncs the indexes of the HNSW spaces written by the transaction that just committed: marks removed vectors
+  /// deleted, inserts added ones and rebuilds a graph left with too many deleted nodes.
+  /// Failures are logged and leave the index to be rebuilt on next use, the committed data is unaffected.
+  void sync_pending_vector_indexes();
+
+  /// Rolls back the active transaction, logging a warning if the rollback itself fails.
+  /// @param error The error to return.
+  /// @return always an unexpected holding error.
+  OdaiResult<void> rollback_with_error(OdaiResultEnum error);
+
 public:
   /// Constructs a new ODAISqliteDb instance with the specified database
   /// configuration. The database is not opened until initialize_db() is called.
   /// @param dbConfig Database configuration object.
-  OdaiSqliteDb(const DBConfig& db_config);
+  /// @param statement_cache_capacity Statements the connection keeps prepared, 0 prepares every statement per call
+  /// (used by benchmarks to measure the cache).
+  OdaiSqliteDb(const DBConfig& db_config,
+               size_t statement_cache_capacity = OdaiSqliteStatementCache::DEFAULT_CAPACITY);
 
   /// Destructor that cleans up database resources.
   /// ToDo : Not yet implemented
@@ -110,7 +347,8 @@ public:
   /// @return stored item details on success, or an unexpected OdaiResultEnum indicating the error
   OdaiResult<InputItem> store_media_item(const InputItem& item) override;
 
-  /// Creates a new semantic space configuration in the database.
+  /// Creates a new semantic space configuration in the database, along with its vector table when the config gives the
+  /// embedding dimensions. Without dimensions the table is created by the first document added to the space.
   /// @param config The semantic space configuration to store.
   /// @return empty expected if created successfully, or an unexpected OdaiResultEnum indicating the error.
   OdaiResult<void> create_semantic_space(const SemanticSpaceConfig& config) override;
@@ -124,11 +362,201 @@ public:
   /// @return semantic space configurations on success, or an unexpected OdaiResultEnum indicating the error.
   OdaiResult<std::vector<SemanticSpaceConfig>> list_semantic_spaces() override;
 
-  /// Deletes a semantic space configuration from the database.
+  /// Deletes a semantic space configuration from the database, dropping its vector table and HNSW index.
   /// @param name The name of the semantic space to delete.
   /// @return empty expected if deleted successfully, or an unexpected OdaiResultEnum indicating the error.
   OdaiResult<void> delete_semantic_space(const SemanticSpaceName& name) override;
 
+  /// Builds the pack in a temporary file next to pack_path and renames it once complete: the space's rows are copied
+  /// through an ATTACH of this database into a new database with the full schema, which is then vacuumed so its pages
+  /// are packed and end at page_count * page_size. The HNSW index, synced and saved next to this database first, is
+  /// appended after the last page. SQLite ignores bytes past its pages.
+  /// @param name The semantic space to export.
+  /// @param pack_path File to create.
+  /// @param include_ann_index Whether to append the space's HNSW index.
+  /// @return empty expected if written, or an unexpected OdaiResultEnum indicating the error.
+  OdaiResult<void> export_knowledge_pack(const SemanticSpaceName& name, const std::string& pack_path,
+                                         bool include_ann_index) override;
+
+  /// Opens the pack through an immutable read-only URI with PRAGMA mmap_size covering its pages, so queries read the
+  /// mapped file without locking or copying it, and records it in the knowledge_pack table.
+  /// @param pack_path The pack file.
+  /// @param name Name of the attached space, empty keeps the pack's.
+  /// @return the attached space's config, or an unexpected OdaiResultEnum indicating the error.
+  OdaiResult<SemanticSpaceConfig> import_knowledge_pack(const std::string& pack_path,
+                                                        const SemanticSpaceName& name) override;
+
+  /// Finds which of the given chunk content hashes don't have an embedding stored in the semantic space yet.
+  /// @param semantic_space_name The semantic space to check.
+  /// @param content_hashes Content hashes of the chunks to check.
+  /// @return hashes that still need an embedding on success, or an unexpected OdaiResultEnum indicating the error.
+  OdaiResult<std::unordered_set<uint64_t>>
+  get_unembedded_chunk_hashes(const SemanticSpaceName& semantic_space_name,
+                              const std::vector<uint64_t>& content_hashes) override;
+
+  /// Reads stored model embeddings from chunk_embedding, one primary key lookup per content hash.
+  /// @param model_checksums Checksums of the embedding model.
+  /// @param content_hashes Content hashes of the chunks to look up.
+  /// @return the stored embeddings by content hash, or an unexpected OdaiResultEnum indicating the error.
+  OdaiResult<std::unordered_map<uint64_t, std::vector<float>>>
+  get_stored_chunk_embeddings(const std::string& model_checksums,
+                              const std::vector<uint64_t>& content_hashes) override;
+
+  /// Inserts model embeddings into chunk_embedding in a single transaction, ignoring contents already stored.
+  /// @param model_checksums Checksums of the embedding model.
+  /// @param content_hashes Content hashes of the embedded chunks.
+  /// @param embeddings The full model embeddings, one per content hash.
+  /// @return empty expected if stored, or an unexpected OdaiResultEnum indicating the error.
+  OdaiResult<void> store_chunk_embeddings(const std::string& model_checksums,
+                                          const std::vector<uint64_t>& content_hashes,
+                                          const std::vector<std::vector<float>>& embeddings) override;
+
+  /// Adds a document with its chunks and embeddings to a semantic space in a single transaction.
+  /// Writes the document, chunk, doc_chunk_ref, chunk_vector_ref and vector rows with statements prepared once per
+  /// call. The space's vector table is created on first ingestion using the dimension of the given embeddings.
+  /// @param document_id Unique identifier for the document.
+  /// @param source_uri App-side identifier of the document source, empty if it has none.
+  /// @param semantic_space_name The semantic space to add the document to.
+  /// @param scope_id Scope the document belongs to, used as the vector table partition key.
+  /// @param chunks The document chunks in document order.
+  /// @param metadata Metadata of the document, stored as JSON. Its filter field values become the document's
+  /// filter_key and are written to the metadata columns of its vectors.
+  /// @return empty expected if the document was stored, or an unexpected OdaiResultEnum indicating the error.
+  OdaiResult<void> add_document(const DocumentId& document_id, const std::string& source_uri,
+                                const SemanticSpaceName& semantic_space_name, const ScopeId& scope_id,
+                                const std::vector<DocumentChunk>& chunks, const DocumentMetadata& metadata) override;
+
+  /// Appends chunks to an existing document, in the document's semantic space and scope.
+  /// Used to ingest a document in several parts, callers keep the sequence indexes increasing across calls.
+  /// @param document_id The existing document.
+  /// @param chunks The chunks to append.
+  /// @return empty expected if the chunks were stored, or an unexpected OdaiResultEnum indicating the error.
+  OdaiResult<void> append_document_chunks(const DocumentId& document_id,
+                                          const std::vector<DocumentChunk>& chunks) override;
+
+  /// Replaces the chunks and metadata of a document with the ones of its new version in a single transaction.
+  /// The old chunk references are dropped first, so insert_document_chunks() finds the unchanged content's chunk rows
+  /// and scope vectors and reuses them. New filter values move the kept chunks' vectors first (move_kept_vectors()).
+  /// Afterwards the old chunks the scope no longer references lose their vector, and the ones no document references
+  /// lose their chunk and full text rows. Removed vectors are marked deleted in the space's HNSW graph after commit.
+  /// @param document_id The existing document.
+  /// @param semantic_space_name The semantic space of the document.
+  /// @param scope_id Scope of the document.
+  /// @param chunks The chunks of the new version.
+  /// @param metadata Metadata of the new version, replacing the stored metadata and filter_key.
+  /// @return empty expected if the document was updated, or an unexpected OdaiResultEnum indicating the error.
+  OdaiResult<void> update_document(const DocumentId& document_id, const SemanticSpaceName& semantic_space_name,
+                                   const ScopeId& scope_id, const std::vector<DocumentChunk>& chunks,
+                                   const DocumentMetadata& metadata) override;
+
+  /// Removes a document in a single transaction. Its chunks the scope no longer references lose their vector, the ones
+  /// no document references lose their chunk and full text rows, like the chunks an update drops.
+  /// @param document_id The existing document.
+  /// @param semantic_space_name The semantic space of the document.
+  /// @param scope_id Scope of the document.
+  /// @return empty expected if the document was removed, or an unexpected OdaiResultEnum indicating the error.
+  OdaiResult<void> delete_document(const DocumentId& document_id, const SemanticSpaceName& semantic_space_name,
+                                   const ScopeId& scope_id) override;
+
+  /// Creates the reembed_job row and the vector tables of the space's next vector generation, which the job fills
+  /// under the same rowids as the live vectors.
+  /// @param target_config The space's config with the new embedding model and dimensions.
+  /// @param config Batching and pacing of the job.
+  /// @return empty expected if the job was created, or an unexpected OdaiResultEnum indicating the error.
+  OdaiResult<void> start_reembedding(const SemanticSpaceConfig& target_config, const ReembedConfig& config) override;
+
+  /// @param semantic_space_name The semantic space.
+  /// @return the space's job with its progress counted from chunk_vector_ref, or an unexpected OdaiResultEnum.
+  OdaiResult<ReembedJob> get_reembedding_job(const SemanticSpaceName& semantic_space_name) override;
+
+  /// @return all pending jobs with their progress, or an unexpected OdaiResultEnum indicating the error.
+  OdaiResult<std::vector<ReembedJob>> list_reembedding_jobs() override;
+
+  /// Reads the chunk_vector_ref rows of the space past the job's last stored rowid, in rowid order.
+  /// @param semantic_space_name The semantic space being re-embedded.
+  /// @param limit Maximum number of vectors to return.
+  /// @return the next vectors to re-embed, or an unexpected OdaiResultEnum indicating the error.
+  OdaiResult<std::vector<ReembedChunk>> get_reembedding_batch(const SemanticSpaceName& semantic_space_name,
+                                                              uint32_t limit) override;
+
+  /// Inserts the vectors into the next generation's vector table under their live rowids, with quantized copies for
+  /// quantized spaces, and moves the job's last rowid to the batch's last one.
+  /// @param semantic_space_name The semantic space being re-embedded.
+  /// @param chunks The re-embedded batch.
+  /// @return empty expected if stored, or an unexpected OdaiResultEnum indicating the error.
+  OdaiResult<void> store_reembedded_vectors(const SemanticSpaceName& semantic_space_name,
+                                            const std::vector<ReembedChunk>& chunks) override;
+
+  /// Drops new vectors whose chunks were removed meanwhile, rebuilds the document vectors, stores the target config,
+  /// bumps the space's vector generation and drops the old tables in one transaction. The old HNSW index file is
+  /// removed after the commit, the new table's index is built on next use.
+  /// @param semantic_space_name The semantic space being re-embedded.
+  /// @return true if switched, false if vectors remain to re-embed, or an unexpected OdaiResultEnum.
+  OdaiResult<bool> finish_reembedding(const SemanticSpaceName& semantic_space_name) override;
+
+  /// Deletes the job and drops the next generation's vector tables.
+  /// @param semantic_space_name The semantic space being re-embedded.
+  /// @return empty expected if cancelled, or an unexpected OdaiResultEnum indicating the error.
+  OdaiResult<void> cancel_reembedding(const SemanticSpaceName& semantic_space_name) override;
+
+  /// Finds the chunks of a scope nearest to the query embedding with a KNN query on the space's vector table.
+  /// The scope is matched on the vector table's partition key, so only that scope's vectors are scanned.
+  /// Spaces configured with VECTOR_INDEX_HNSW search their HNSW index instead when the scope is large enough for the
+  /// graph to beat the exact scan (see OdaiHnswIndex::prefers_graph_search()).
+  /// @param semantic_space_name The semantic space to search.
+  /// @param scope_id Scope to search in.
+  /// @param query_embedding Embedding of the query.
+  /// @param limit Maximum number of chunks to return, capped to the KNN limit of sqlite-vec.
+  /// @param include_embeddings Whether to read each chunk's stored embedding back from the vector table.
+  /// @param filter Added to the KNN query as constraints on the vector table's metadata columns. A filtered search of
+  /// an HNSW space scans the vector table instead of the graph.
+  /// @return chunks ordered from most to least similar, or an unexpected OdaiResultEnum indicating the error.
+  OdaiResult<std::vector<RetrievedChunk>> search_chunks(const SemanticSpaceName& semantic_space_name,
+                                                        const ScopeId& scope_id,
+                                                        const std::vector<float>& query_embedding, uint32_t limit,
+                                                        bool include_embeddings, const MetadataFilter& filter) override;
+
+  /// Runs a KNN query with document_limit on the space's document vector table, then ranks the in-scope vectors of
+  /// those documents' chunks by exact cosine distance. The HNSW index and quantized vectors are not used, the
+  /// candidate set is small enough to compare in full.
+  /// @param semantic_space_name The semantic space to search.
+  /// @param scope_id Scope to search in.
+  /// @param query_embedding Embedding of the query.
+  /// @param document_limit Number of documents to pick, capped to the KNN limit of sqlite-vec.
+  /// @param limit Maximum number of chunks to return.
+  /// @param include_embeddings Whether to read each chunk's stored embedding back from the vector table.
+  /// @param filter Added to the document KNN query as constraints on the document vector table's metadata columns.
+  /// @return chunks ordered from most to least similar, or an unexpected OdaiResultEnum indicating the error.
+  OdaiResult<std::vector<RetrievedChunk>>
+  search_chunks_in_top_documents(const SemanticSpaceName& semantic_space_name, const ScopeId& scope_id,
+                                 const std::vector<float>& query_embedding, uint32_t document_limit, uint32_t limit,
+                                 bool include_embeddings, const MetadataFilter& filter) override;
+
+  /// Finds the chunks of a scope best matching the words of a query with the chunk_fts FTS5 index, ranked by bm25().
+  /// Each word of the query is matched as a quoted FTS5 phrase, so punctuation and FTS5 operators in the query are
+  /// taken literally. Words are OR-ed together.
+  /// @param semantic_space_name The semantic space to search.
+  /// @param scope_id Scope to search in.
+  /// @param query_text The query text.
+  /// @param limit Maximum number of chunks to return.
+  /// @param filter Checked on the metadata columns of the matching chunks' vectors, read by rowid.
+  /// @return chunks ordered from best to worst match, or an unexpected OdaiResultEnum indicating the error.
+  OdaiResult<std::vector<RetrievedChunk>> search_chunks_by_keywords(const SemanticSpaceName& semantic_space_name,
+                                                                    const ScopeId& scope_id,
+                                                                    const std::string& query_text, uint32_t limit,
+                                                                    const MetadataFilter& filter) override;
+
+  /// Reads spans of consecutive chunks, one ordered range query over doc_chunk_ref per span.
+  /// The range is served by idx_doc_chunk_ref_doc_seq, which covers the chunk ids so only chunk rows inside the span
+  /// are visited. The statement is prepared once for all spans.
+  /// @param semantic_space_name The semantic space of the documents, only used to read a knowledge pack's documents
+  /// from the pack. Document ids are unique in the database.
+  /// @param spans The spans to read.
+  /// @return for each span, its chunks ordered by sequence index, or an unexpected OdaiResultEnum indicating the error.
+  OdaiResult<std::vector<std::vector<DocumentChunk>>>
+  get_document_chunk_spans(const SemanticSpaceName& semantic_space_name,
+                           const std::vector<DocumentChunkSpan>& spans) override;
+
   /// Checks if a chat session with the given chat_id exists in the database.
   /// @param chat_id The chat identifier to check
   /// @return true/false on success, or an unexpected OdaiResultEnum indicating the error
@@ -174,7 +602,8 @@ public:
   /// error.
   OdaiResult<void> insert_chat_messages(const ChatId& chat_id, const std::vector<ChatMessage>& messages) override;
 
-  /// Closes the database connection and releases resources.
+  /// Saves modified HNSW indexes next to the database file, closes the attached knowledge packs, then closes the
+  /// database connection and releases resources.
   void close() override;
 
 private:
@@ -212,13 +641,36 @@ CREATE TABLE chat_messages (
 CREATE INDEX idx_chat_messages_chat_id_seq 
 ON chat_messages(chat_id, sequence_index);
 
+CREATE TABLE semantic_spaces (
+    id INTEGER NOT NULL PRIMARY KEY AUTOINCREMENT, -- Never reused, names the space's vector table (vec_space_<id>)
+    name TEXT NOT NULL UNIQUE,
+    config BLOB NOT NULL,       -- JSON stored SemanticSpaceConfig
+    vector_generation INTEGER NOT NULL DEFAULT 0, -- Bumped by each finished re-embedding, suffixes the vector table
+    created_at INTEGER NOT NULL DEFAULT (unixepoch())
+);
+
+-- Re-embedding of a semantic space with a new embedding model, at most one per space. The job writes the new vectors
+-- to the tables of the space's next vector generation (vec_space_<id>_g<generation>) under the rowids of the live
+-- vectors, in rowid order, and the space switches to them once it has caught up.
+CREATE TABLE reembed_job (
+    space_id INTEGER NOT NULL PRIMARY KEY,
+    target_config BLOB NOT NULL,   -- JSON SemanticSpaceConfig the space switches to
+    config BLOB NOT NULL,          -- JSON ReembedConfig
+    last_vector_rowid INTEGER NOT NULL DEFAULT 0, -- Vectors up to this chunk_vector_ref rowid are re-embedded
+    created_at INTEGER NOT NULL DEFAULT (unixepoch()),
+    FOREIGN KEY (space_id) REFERENCES semantic_spaces(id) ON DELETE CASCADE
+);
+
 -- Documents: The source of truth (File, Chat Thread, etc.)
 CREATE TABLE document (
     id TEXT NOT NULL PRIMARY KEY DEFAULT (lower(hex(randomblob(16)))),
+    space_id INTEGER NOT NULL,  -- Semantic space the document was ingested into
     scope_id TEXT NOT NULL,     -- Partition key (e.g., 'user_1', 'workspace_A', 'chat_x')
-    source_uri TEXT NOT NULL,   -- File path or any ID that app can use to identify the document (e.g., chat_k)
+    source_uri TEXT NOT NULL,   -- File path or any ID that app can use to identify the document, '' if it has none
     metadata TEXT,              -- JSON blob for flexibility
-    created_at INTEGER NOT NULL
+    filter_key TEXT NOT NULL DEFAULT '', -- JSON array of the document's values of its space's filter fields, '' if none
+    created_at INTEGER NOT NULL DEFAULT (unixepoch()),
+    FOREIGN KEY (space_id) REFERENCES semantic_spaces(id) ON DELETE CASCADE
 );
 
 -- Chunks: The unique content blobs.
@@ -228,23 +680,73 @@ CREATE TABLE chunk (
     content_text TEXT NOT NULL,     -- The chunk content
     content_ref TEXT,               -- Optional app reference to map this chunk back to source (e.g. msg12_16, means msg 12 to 16, or any format)
     metadata TEXT,                  -- JSON blob for flexibility
-    content_hash INTEGER NOT NULL UNIQUE -- Fast integer hash for deduplication checks
+    content_hash INTEGER NOT NULL UNIQUE, -- Fast integer hash for deduplication checks
+    token_count INTEGER             -- Embedding model tokens in the chunk for prompt budgeting, NULL if not counted
     );
     
 -- Provenance: The Many-to-Many link.
--- Maps which Documents contain which Chunks.
+-- Maps which Documents contain which Chunks. A chunk repeated inside a document is referenced once per position.
 CREATE TABLE doc_chunk_ref (
     doc_id TEXT NOT NULL,
     chunk_id INTEGER NOT NULL,
     sequence_index INTEGER NOT NULL, -- Order of chunk in the doc
-    PRIMARY KEY (doc_id, chunk_id),
+    PRIMARY KEY (doc_id, sequence_index),
     FOREIGN KEY (doc_id) REFERENCES document(id) ON DELETE CASCADE,
     FOREIGN KEY (chunk_id) REFERENCES chunk(id) ON DELETE CASCADE
     );
 
-CREATE TABLE semantic_spaces (
-    name TEXT NOT NULL PRIMARY KEY,
-    config BLOB NOT NULL,       -- JSON stored SemanticSpaceConfig
+CREATE INDEX idx_doc_chunk_ref_chunk_id ON doc_chunk_ref(chunk_id);
+-- Covers context expansion's range reads of a document's chunks by position without visiting the table rows
+CREATE INDEX idx_doc_chunk_ref_doc_seq ON doc_chunk_ref(doc_id, sequence_index, chunk_id);
+
+-- Full text index over chunk contents for keyword (BM25) search. External content table: the text stays in chunk only,
+-- ingestion inserts a chunk_fts row with the chunk's id whenever it inserts a chunk.
+CREATE VIRTUAL TABLE chunk_fts USING fts5(
+    content_text,
+    content='chunk',
+    content_rowid='id',
+    tokenize='unicode61 remove_diacritics 2'
+);
+
+-- Maps a chunk embedded in a semantic space to its row in that space's vector table.
+-- A chunk shared by several scopes gets one vector row per scope, since scope_id partitions the vector table. Likewise
+-- documents of a scope with different filter values get their own vector rows, holding those values.
+CREATE TABLE chunk_vector_ref (
+    vector_rowid INTEGER NOT NULL PRIMARY KEY AUTOINCREMENT, -- rowid in vec_space_<space_id>
+    space_id INTEGER NOT NULL,
+    chunk_id INTEGER NOT NULL,
+    scope_id TEXT NOT NULL,
+    filter_key TEXT NOT NULL DEFAULT '', -- filter_key of the documents the vector serves
+    UNIQUE (space_id, chunk_id, scope_id, filter_key),
+    FOREIGN KEY (space_id) REFERENCES semantic_spaces(id) ON DELETE CASCADE,
+    FOREIGN KEY (chunk_id) REFERENCES chunk(id) ON DELETE CASCADE
+);
+
+-- Embeddings as output by an embedding model, before any truncation, keyed by chunk content and the model's checksums.
+-- Every semantic space using the same model file reuses them instead of embedding the content again. Keyed by
+-- content_hash rather than chunk id, as content is embedded before its chunk row is written; content_hash identifies
+-- a chunk row just as well (chunk.content_hash is UNIQUE).
+CREATE TABLE chunk_embedding (
+    content_hash INTEGER NOT NULL,
+    model_checksums TEXT NOT NULL, -- see get_model_checksums()
+    embedding BLOB NOT NULL,       -- float32 vector
+    PRIMARY KEY (content_hash, model_checksums)
+) WITHOUT ROWID;
+
+-- Maps a document to its row in its space's document vector table (vec_space_<space_id>_docs). A document vector is
+-- the sum of the document's L2-normalized chunk vectors, whose direction is their mean, and picks the documents whose
+-- chunks a two-stage search compares with the query.
+CREATE TABLE document_vector_ref (
+    vector_rowid INTEGER NOT NULL PRIMARY KEY AUTOINCREMENT, -- rowid in vec_space_<space_id>_docs
+    doc_id TEXT NOT NULL UNIQUE,
+    FOREIGN KEY (doc_id) REFERENCES document(id) ON DELETE CASCADE
+);
+
+-- Knowledge packs attached as read-only semantic spaces (see import_knowledge_pack()), re-attached on every open.
+-- The pack file holds the space's rows, nothing of it is copied here.
+CREATE TABLE knowledge_pack (
+    name TEXT NOT NULL PRIMARY KEY, -- Name of the attached space, unique among semantic_spaces names too
+    path TEXT NOT NULL,             -- Absolute path of the pack file
     created_at INTEGER NOT NULL DEFAULT (unixepoch())
 );
 
@@ -252,16 +754,27 @@ CREATE TABLE models (
     name TEXT NOT NULL PRIMARY KEY,
     file_details BLOB NOT NULL,
     checksums BLOB NOT NULL,
-    type TEXT NOT NULL CHECK(type IN ('LLM', 'EMBEDDING')),
+    type TEXT NOT NULL CHECK(type IN ('LLM', 'EMBEDDING', 'RERANKER')),
     created_at INTEGER NOT NULL DEFAULT (unixepoch())
 );
 
-    -- Vector Store: The 'sqlite-vec' Virtual Table.
--- We use scope_id as a PARTITION KEY for fast filtering.
--- CREATE VIRTUAL TABLE vec_items USING vec0(
---    chunk_id INTEGER PRIMARY KEY, -- Maps 1:1 to chunk.id
---    embedding FLOAT[384],         -- Dimension depends on your model (384 is common for mobile/all-minilm)
---    scope_id TEXT PARTITION KEY
+-- Vector Store: one 'sqlite-vec' virtual table per semantic space, created with the space (or on first ingestion for
+-- spaces created without dimensions) and dropped with it. We use scope_id as a PARTITION KEY for fast filtering.
+-- Spaces re-embedded at least once name their tables vec_space_<id>_g<vector_generation> instead.
+-- CREATE VIRTUAL TABLE vec_space_<id> USING vec0(
+--    embedding FLOAT[<dims>] distance_metric=cosine,
+--    -- only with VECTOR_STORAGE_INT8 (INT8[<dims>] distance_metric=cosine) or VECTOR_STORAGE_BINARY (BIT[<dims>]
+--    -- rounded up to a multiple of 8), scanned by flat searches before rescoring with embedding
+--    embedding_coarse INT8[<dims>] | BIT[<dims>],
+--    scope_id TEXT PARTITION KEY,
+--    -- one metadata column per filter field of the space, '' for documents without the field. KNN queries constrain
+--    -- them, so sqlite-vec only compares the matching vectors.
+--    filter_<field> TEXT, ...
+--);
+-- CREATE VIRTUAL TABLE vec_space_<id>_docs USING vec0(
+--    embedding FLOAT[<dims>] distance_metric=cosine,
+--    scope_id TEXT PARTITION KEY,
+--    filter_<field> TEXT, ...
 --);
 
 )";
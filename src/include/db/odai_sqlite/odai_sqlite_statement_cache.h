@@ -0,0 +1,81 @@
+#pragma once
+
+#ifdef ODAI_ENABLE_SQLITE_DB
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include <SQLiteCpp/SQLiteCpp.h>
+
+/// Prepared statements of one SQLite connection, by their SQL text. Statements are borrowed through a
+/// CachedStatement handle, preparing them on first use. SQLite re-prepares a cached statement by itself after schema
+/// changes.
+/// Not thread safe, like the connection its statements belong to.
+class OdaiSqliteStatementCache
+{
+public:
+  /// Statements a connection keeps prepared by default. SQL naming vector tables or embedding filter values varies,
+  /// once the cache is full the statements not in use are finalized and it fills up again with the ones still used.
+  static constexpr size_t DEFAULT_CAPACITY = 256;
+
+  /// A statement borrowed from the cache, used like a SQLite::Statement through ->. Its bindings are cleared when
+  /// borrowed and it is reset when released, so a cached statement never keeps a read transaction open between calls.
+  class CachedStatement
+  {
+  public:
+    CachedStatement(SQLite::Statement& statement, bool& in_use);
+    explicit CachedStatement(std::unique_ptr<SQLite::Statement> uncached);
+    ~CachedStatement();
+
+    CachedStatement(const CachedStatement&) = delete;
+    CachedStatement& operator=(const CachedStatement&) = delete;
+    CachedStatement(CachedStatement&& other) noexcept;
+    CachedStatement& operator=(CachedStatement&&) = delete;
+
+    SQLite::Statement* operator->() const { return m_statement; }
+    SQLite::Statement& operator*() const { return *m_statement; }
+
+  private:
+    std::unique_ptr<SQLite::Statement> m_uncached;
+    SQLite::Statement* m_statement;
+    bool* m_inUse = nullptr;
+  };
+
+  /// @param capacity Statements kept prepared before the idle ones are dropped, 0 prepares every borrowed statement
+  /// uncached
+  explicit OdaiSqliteStatementCache(size_t capacity = DEFAULT_CAPACITY);
+
+  /// Borrows the prepared statement of a SQL text, preparing it on first use. A statement borrowed again while held
+  /// (a nested call running the same SQL) is prepared uncached instead.
+  /// @note Throws SQLite::Exception on database errors, callers are expected to be inside a try block.
+  /// @param db The connection, the same one for every borrow until clear()
+  /// @param sql The statement's SQL, also its cache key
+  CachedStatement borrow(SQLite::Database& db, const std::string& sql);
+
+  /// Finalizes the statements not in use whose SQL contains text, e.g. the ones naming a table about to be dropped.
+  /// A held statement is only reset when released, it can't be finalized under its borrower.
+  void evict_containing(const std::string& text);
+
+  /// Finalizes every statement, expected to be called with none in use before the connection is closed.
+  void clear();
+
+  /// @return number of statements kept prepared
+  size_t size() const;
+
+  /// @return true if the statement of the SQL text is kept prepared
+  bool contains(const std::string& sql) const;
+
+private:
+  /// A prepared statement of the cache
+  struct Entry
+  {
+    std::unique_ptr<SQLite::Statement> m_statement;
+    /// Set while a CachedStatement holds the statement
+    bool m_inUse = false;
+  };
+
+  size_t m_capacity;
+  std::unordered_map<std::string, Entry> m_entries;
+};
+#endif
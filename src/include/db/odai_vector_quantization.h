@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "types/odai_types.h"
+
+/// Quantized copies of float vectors, in the blob layouts sqlite-vec reads for int8[] and bit[] columns.
+/// They only rank candidates for a rescoring pass with the float vectors, so they keep directions, not magnitudes.
+
+/// Scales a vector so its largest component maps to +-127 and rounds each component to an int8.
+/// Cosine distance doesn't depend on the scale, so each vector uses its full int8 range.
+/// @param vector The float vector
+/// @return one int8 per component, all zeros for a zero vector
+std::vector<int8_t> quantize_int8(const std::vector<float>& vector);
+
+/// Keeps the sign of each component as one bit, set for positive components. Bits are packed least significant bit
+/// first and the last byte is padded with zero bits, which leave hamming distances unchanged.
+/// @param vector The float vector
+/// @return binary_quantized_bytes(vector.size()) bytes
+std::vector<uint8_t> quantize_binary(const std::vector<float>& vector);
+
+/// @return number of bytes quantize_binary() packs a vector of this dimension into
+constexpr size_t binary_quantized_bytes(size_t dimensions) { return (dimensions + 7) / 8; }
+
+/// Quantizes a vector for the given storage type.
+/// @param vector The float vector
+/// @param storage_type VECTOR_STORAGE_INT8 or VECTOR_STORAGE_BINARY
+/// @return the quantized blob, empty for VECTOR_STORAGE_FLOAT32
+std::vector<uint8_t> quantize_vector(const std::vector<float>& vector, VectorStorageType storage_type);
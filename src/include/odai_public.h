@@ -95,17 +95,125 @@ extern "C"
   /// @return ODAI_SUCCESS if deleted successfully, or an error code such as ODAI_NOT_FOUND or ODAI_INVALID_ARGUMENT.
   c_OdaiResult odai_delete_semantic_space(c_SemanticSpaceName name);
 
+  /// Exports a semantic space into a standalone knowledge pack file: a read-only database holding the space's
+  /// documents, chunks and vectors, optionally followed by its HNSW graph. Another device with the same embedding model
+  /// files registered can import it with odai_import_knowledge_pack.
+  /// @param name The name of the semantic space to export.
+  /// @param pack_path Path of the pack file to create, it must not exist yet.
+  /// @param include_ann_index Whether to append the space's HNSW graph, so importers search it without rebuilding it.
+  /// Ignored for spaces that don't use an HNSW index.
+  /// @return ODAI_SUCCESS if exported, or an error code such as ODAI_NOT_FOUND or ODAI_ALREADY_EXISTS.
+  c_OdaiResult odai_export_knowledge_pack(c_SemanticSpaceName name, const char* pack_path, bool include_ann_index);
+
+  /// Attaches a knowledge pack file as a read-only semantic space. The pack is memory-mapped and searched in place,
+  /// nothing is copied, so the file must stay in place while attached. It is attached again at every initialization
+  /// until the space is deleted, which detaches it and keeps the file.
+  /// Caller is responsible for freeing config_out using odai_free_semantic_space_config.
+  /// @param pack_path Path of the pack file.
+  /// @param name Name of the attached space, NULL or empty to keep the name the pack was exported with.
+  /// @param config_out Optional output parameter: configuration of the attached space, may be NULL.
+  /// @return ODAI_SUCCESS if attached, or an error code such as ODAI_NOT_FOUND, ODAI_ALREADY_EXISTS (a space with the
+  /// name exists) or ODAI_VALIDATION_FAILED (not a pack, or made with other embedding model files).
+  c_OdaiResult odai_import_knowledge_pack(const char* pack_path, c_SemanticSpaceName name,
+                                          c_SemanticSpaceConfig* config_out);
+
   /// Adds a document to the RAG knowledge base for retrieval during generation.
-  /// The document content is embedded and stored in the database for later retrieval.
-  /// ToDo: Implementation not yet defined.
+  /// The document content is chunked using the semantic space's chunking config, chunks whose content is already
+  /// embedded in the space are reused, and only new chunks are embedded before everything is stored in one transaction.
   /// @param content The text content of the document to add
   /// @param document_id Unique identifier for this document (used for updates/deletion)
   /// @param semantic_space_name Name of the semantic space to use
   /// @param scope_id Scope identifier to group documents (used for filtering during retrieval)
-  /// @return ODAI_SUCCESS if the document was added successfully, or an error code such as ODAI_VALIDATION_FAILED or
-  /// ODAI_INVALID_ARGUMENT.
+  /// @param metadata Array of key value metadata entries, values of the space's filter fields can be matched by the
+  /// metadata filter of a retrieval config. May be NULL when metadata_count is 0
+  /// @param metadata_count Number of metadata entries
+  /// @return ODAI_SUCCESS if the document was added successfully, or an error code such as ODAI_ALREADY_EXISTS,
+  /// ODAI_NOT_FOUND, ODAI_VALIDATION_FAILED or ODAI_INVALID_ARGUMENT.
   c_OdaiResult odai_add_document(const char* content, c_DocumentId document_id, c_SemanticSpaceName semantic_space_name,
-                                 c_ScopeId scope_id);
+                                 c_ScopeId scope_id, const struct c_MetadataEntry* metadata, size_t metadata_count);
+
+  /// Replaces a document added with odai_add_document by a new version of its content.
+  /// The new content is chunked like in odai_add_document and only chunks whose content the space hasn't embedded yet
+  /// are embedded. Unchanged chunks keep their stored vectors under their new positions, and chunks the new version
+  /// dropped are removed with their vectors, all in one transaction. The metadata replaces the stored one, so filtered
+  /// retrievals match the kept chunks on the new version's filter field values.
+  /// @param content The new text content of the document
+  /// @param document_id The document to update
+  /// @param semantic_space_name Name of the semantic space the document was added to
+  /// @param scope_id Scope of the document
+  /// @param metadata Array of key value metadata entries of the new version, see odai_add_document. May be NULL when
+  /// metadata_count is 0
+  /// @param metadata_count Number of metadata entries
+  /// @return ODAI_SUCCESS if the document was updated successfully, or an error code such as ODAI_NOT_FOUND,
+  /// ODAI_VALIDATION_FAILED or ODAI_INVALID_ARGUMENT.
+  c_OdaiResult odai_update_document(const char* content, c_DocumentId document_id,
+                                    c_SemanticSpaceName semantic_space_name, c_ScopeId scope_id,
+                                    const struct c_MetadataEntry* metadata, size_t metadata_count);
+
+  /// Adds a document read from a UTF-8 text file, without loading the whole file in memory.
+  /// The file is read in windows and chunked incrementally, so peak memory stays around a few dozen chunks whatever the
+  /// file size. Chunking, deduplication and storage behave like odai_add_document, the file path is stored as the
+  /// document source. The semantic space must use fixed size chunking.
+  /// @param file_path Path of the text file to ingest
+  /// @param document_id Unique identifier for this document (used for updates/deletion)
+  /// @param semantic_space_name Name of the semantic space to use
+  /// @param scope_id Scope identifier to group documents (used for filtering during retrieval)
+  /// @param metadata Array of key value metadata entries, see odai_add_document. May be NULL when metadata_count is 0
+  /// @param metadata_count Number of metadata entries
+  /// @return ODAI_SUCCESS if the document was added successfully, or an error code such as ODAI_ALREADY_EXISTS,
+  /// ODAI_NOT_FOUND (missing file or semantic space), ODAI_VALIDATION_FAILED (empty file) or ODAI_INVALID_ARGUMENT.
+  c_OdaiResult odai_add_document_from_file(const char* file_path, c_DocumentId document_id,
+                                           c_SemanticSpaceName semantic_space_name, c_ScopeId scope_id,
+                                           const struct c_MetadataEntry* metadata, size_t metadata_count);
+
+  /// Ingests many documents read from UTF-8 text files into one scope of a semantic space.
+  /// Files are read, chunked, deduplicated, embedded and written by concurrent pipeline stages connected by bounded
+  /// queues. A document that fails is logged and counted in stats_out, the remaining documents are still ingested.
+  /// @param sources Array of documents (id + file path) to ingest
+  /// @param sources_count Number of documents in the array
+  /// @param semantic_space_name Name of the semantic space to use
+  /// @param scope_id Scope identifier to group documents (used for filtering during retrieval)
+  /// @param config Optional pipeline configuration, nullptr (or zero fields) selects the defaults
+  /// @param stats_out Output parameter: ingestion counts, and throughput / queue depth of each stage indexed by
+  /// IngestStage. Can be nullptr.
+  /// @return ODAI_SUCCESS if the pipeline ran to completion, or an error code such as ODAI_NOT_FOUND or
+  /// ODAI_INVALID_ARGUMENT.
+  c_OdaiResult odai_add_documents(const struct c_IngestDocumentSource* sources, size_t sources_count,
+                                  c_SemanticSpaceName semantic_space_name, c_ScopeId scope_id,
+                                  const struct c_BulkIngestConfig* config, struct c_BulkIngestStats* stats_out);
+
+  /// Starts re-embedding a semantic space with a new embedding model in the background.
+  /// The space keeps answering queries with its current model and vectors while its chunks are re-embedded in batches,
+  /// paced to the configured CPU share, then switches to the new model at once. Progress is saved after each batch, an
+  /// interrupted job resumes after the next odai_initialize_sdk. Chunk boundaries are kept, the space's chunking and
+  /// truncation settings are unchanged.
+  /// @param semantic_space_name Name of the semantic space to re-embed
+  /// @param embedding_model_config The new embedding model (must be registered)
+  /// @param config Optional batch size and CPU share, nullptr (or zero fields) selects the defaults
+  /// @return ODAI_SUCCESS if the job started, or an error code such as ODAI_NOT_FOUND, ODAI_ALREADY_EXISTS (a job is
+  /// already running for the space), ODAI_VALIDATION_FAILED or ODAI_INVALID_ARGUMENT.
+  c_OdaiResult odai_start_reembedding(c_SemanticSpaceName semantic_space_name,
+                                      const struct c_EmbeddingModelConfig* embedding_model_config,
+                                      const struct c_ReembedConfig* config);
+
+  /// Retrieves the progress of a semantic space's re-embedding.
+  /// @param semantic_space_name Name of the semantic space being re-embedded
+  /// @param progress_out Output parameter: vectors re-embedded so far and vectors of the space
+  /// @return ODAI_SUCCESS if the job is still pending, ODAI_NOT_FOUND if the space has no job (e.g. it already
+  /// switched to the new model), or another error code.
+  c_OdaiResult odai_get_reembedding_progress(c_SemanticSpaceName semantic_space_name,
+                                             struct c_ReembedProgress* progress_out);
+
+  /// Cancels a semantic space's re-embedding and drops the vectors it made, the space keeps its current model.
+  /// @param semantic_space_name Name of the semantic space being re-embedded
+  /// @return ODAI_SUCCESS if cancelled, or an error code such as ODAI_NOT_FOUND.
+  c_OdaiResult odai_cancel_reembedding(c_SemanticSpaceName semantic_space_name);
+
+  /// Retrieves the hit and miss counters of the caches in front of retrieval and prompt packing, e.g. to check how
+  /// often repeated questions skip the embedding model or the whole search.
+  /// @param stats_out Output parameter: the counters
+  /// @return ODAI_SUCCESS if retrieved, or an error code such as ODAI_NOT_INITIALIZED or ODAI_INVALID_ARGUMENT.
+  c_OdaiResult odai_get_cache_stats(struct c_CacheStats* stats_out);
 
   /// Generates a streaming response for a single query using the specified LLM Model.
   /// @param llm_model_config Configuration of the LLM model to use
@@ -86,15 +86,90 @@ public:
   /// @return empty expected if deleted successfully, or an unexpected OdaiResultEnum indicating the error.
   OdaiResult<void> delete_semantic_space(const SemanticSpaceName& name);
 
+  /// Exports a semantic space into a standalone knowledge pack file other devices can import.
+  /// @param name The name of the semantic space to export.
+  /// @param pack_path Path of the pack file to create, it must not exist yet.
+  /// @param include_ann_index Whether to append the space's HNSW graph so importers don't rebuild it.
+  /// @return empty expected if exported successfully, or an unexpected OdaiResultEnum indicating the error.
+  OdaiResult<void> export_knowledge_pack(const SemanticSpaceName& name, const std::string& pack_path,
+                                         bool include_ann_index);
+
+  /// Attaches a knowledge pack file as a read-only semantic space.
+  /// @param pack_path Path of the pack file, it must stay in place while attached.
+  /// @param name Name of the attached space, empty to keep the name the pack was exported with.
+  /// @return the attached space's configuration, or an unexpected OdaiResultEnum indicating the error.
+  OdaiResult<SemanticSpaceConfig> import_knowledge_pack(const std::string& pack_path, const SemanticSpaceName& name);
+
   /// Adds a document to the RAG knowledge base for retrieval during generation.
   /// @param content The text content of the document to add
   /// @param documentId Unique identifier for this document
   /// @param semanticSpaceName Name of the semantic space to use
   /// @param scopeId Scope identifier to group documents
+  /// @param metadata Key value metadata of the document, its filter fields can be used in retrieval filters
   /// @return empty expected if the document was added successfully, or an unexpected OdaiResultEnum indicating the
   /// error.
   OdaiResult<void> add_document(const std::string& content, const DocumentId& document_id,
-                                const SemanticSpaceName& semantic_space_name, const ScopeId& scope_id) const;
+                                const SemanticSpaceName& semantic_space_name, const ScopeId& scope_id,
+                                const DocumentMetadata& metadata) const;
+
+  /// Replaces an existing document with a new version of its content, embedding only the chunks that changed.
+  /// @param content The new text content of the document
+  /// @param document_id The document to update
+  /// @param semantic_space_name Name of the semantic space the document was added to
+  /// @param scope_id Scope of the document
+  /// @param metadata Key value metadata of the new version, replacing the stored metadata
+  /// @return empty expected if the document was updated successfully, or an unexpected OdaiResultEnum indicating the
+  /// error.
+  OdaiResult<void> update_document(const std::string& content, const DocumentId& document_id,
+                                   const SemanticSpaceName& semantic_space_name, const ScopeId& scope_id,
+                                   const DocumentMetadata& metadata) const;
+
+  /// Adds a document streamed from a text file, keeping memory bounded regardless of the file size.
+  /// @param file_path Path of the text file to ingest
+  /// @param document_id Unique identifier for this document
+  /// @param semantic_space_name Name of the semantic space to use
+  /// @param scope_id Scope identifier to group documents
+  /// @param metadata Key value metadata of the document, its filter fields can be used in retrieval filters
+  /// @return empty expected if the document was added successfully, or an unexpected OdaiResultEnum indicating the
+  /// error.
+  OdaiResult<void> add_document_from_file(const std::string& file_path, const DocumentId& document_id,
+                                          const SemanticSpaceName& semantic_space_name, const ScopeId& scope_id,
+                                          const DocumentMetadata& metadata) const;
+
+  /// Ingests many documents read from files into one scope of a semantic space using a staged, parallel pipeline.
+  /// @param sources The documents to ingest
+  /// @param semantic_space_name Name of the semantic space to use
+  /// @param scope_id Scope identifier to group documents
+  /// @param config Worker counts, queue bounds and batch sizes of the ingestion pipeline
+  /// @return ingestion statistics on success, or an unexpected OdaiResultEnum indicating the error.
+  OdaiResult<BulkIngestStats> add_documents(const std::vector<IngestDocumentSource>& sources,
+                                            const SemanticSpaceName& semantic_space_name, const ScopeId& scope_id,
+                                            const BulkIngestConfig& config) const;
+
+  /// Starts re-embedding a semantic space with a new embedding model in the background. The space keeps serving its
+  /// current model until all of its chunks are re-embedded, then switches at once. The job resumes after a restart.
+  /// @param semantic_space_name Name of the semantic space to re-embed
+  /// @param embedding_model_config The new embedding model
+  /// @param config Batch size and CPU share of the job
+  /// @return empty expected if the job started, or an unexpected OdaiResultEnum indicating the error.
+  OdaiResult<void> start_reembedding(const SemanticSpaceName& semantic_space_name,
+                                     const EmbeddingModelConfig& embedding_model_config,
+                                     const ReembedConfig& config) const;
+
+  /// Retrieves the progress of a semantic space's re-embedding.
+  /// @param semantic_space_name Name of the semantic space being re-embedded
+  /// @return the pending job with its progress, or an unexpected OdaiResultEnum indicating the error (NOT_FOUND once
+  /// the space switched to the new model).
+  OdaiResult<ReembedJob> get_reembedding_progress(const SemanticSpaceName& semantic_space_name) const;
+
+  /// Cancels a semantic space's re-embedding, the space keeps its current model.
+  /// @param semantic_space_name Name of the semantic space being re-embedded
+  /// @return empty expected if cancelled, or an unexpected OdaiResultEnum indicating the error.
+  OdaiResult<void> cancel_reembedding(const SemanticSpaceName& semantic_space_name) const;
+
+  /// Retrieves the hit and miss counters of the caches in front of retrieval and prompt packing.
+  /// @return the counters on success, or an unexpected OdaiResultEnum indicating the error.
+  OdaiResult<CacheStats> get_cache_stats() const;
 
   /// Generates a streaming response for the given query.
   /// Its like a Completion API, and won't use RAG
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "types/odai_result.h"
+#include "types/odai_types.h"
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// Tokenizes texts with the semantic space's embedding model.
+/// Receives consecutive pieces of a document and returns the token ids of each piece, without special tokens, in the
+/// same order as the pieces.
+using ChunkTokenizerFn =
+    std::function<OdaiResult<std::vector<std::vector<TokenId>>>(const std::vector<std::string>& texts)>;
+
+/// Splits document content into chunks according to the given chunking configuration.
+/// Each returned chunk has its content hash and sequence index filled, embeddings are left empty.
+/// @param content The document content to split
+/// @param config The chunking configuration of the semantic space
+/// @param tokenizer Tokenizer of the space's embedding model, only needed by token aware chunking
+/// @return chunks in document order on success, or an unexpected OdaiResultEnum indicating the error
+OdaiResult<std::vector<DocumentChunk>> chunk_document(std::string_view content, const ChunkingConfig& config,
+                                                      const ChunkTokenizerFn& tokenizer = nullptr);
+
+/// Splits content into chunks of at most m_chunkSize bytes, where consecutive chunks share m_chunkOverlap bytes.
+/// Chunk edges are moved to the nearest UTF-8 character boundary so no multi-byte character is split.
+/// @param content The content to split
+/// @param config The fixed size chunking configuration, expected to be sane
+/// @return chunks in document order, or empty vector if content is empty
+std::vector<DocumentChunk> chunk_fixed_size(std::string_view content, const FixedSizeChunkingConfig& config);
+
+/// Splits content into chunks of at most m_chunkSize bytes, moving each chunk end back by up to m_boundaryTolerance
+/// bytes to the nearest paragraph, line, sentence or word boundary, preferring them in that order. The overlap of the
+/// next chunk likewise starts at the first word boundary within the tolerance. Edges fall back to the nearest UTF-8
+/// character boundary when no boundary lies within the tolerance. Boundaries are found with SSE2 / NEON byte scans.
+/// @param content The content to split
+/// @param config The boundary aware chunking configuration, expected to be sane
+/// @return chunks in document order, or empty vector if content is empty
+std::vector<DocumentChunk> chunk_boundary_aware(std::string_view content, const BoundaryAwareChunkingConfig& config);
+
+/// Splits content into chunks of at most m_chunkSize embedding model tokens, where consecutive chunks share up to
+/// m_chunkOverlap tokens. The content is split into words, each with its leading whitespace, which are tokenized in a
+/// single tokenizer call and packed greedily into chunks, so chunks are cut between words and the whole content is
+/// tokenized only once. Overly long words are split at UTF-8 character boundaries first.
+/// Each chunk keeps the token ids of its words and their count. Chunks without any token are dropped.
+/// @param content The content to split
+/// @param config The token aware chunking configuration, expected to be sane
+/// @param tokenizer Tokenizer of the embedding model
+/// @return chunks in document order (empty if content has no tokens), or an unexpected OdaiResultEnum if tokenization
+/// failed
+OdaiResult<std::vector<DocumentChunk>> chunk_token_aware(std::string_view content,
+                                                         const TokenAwareChunkingConfig& config,
+                                                         const ChunkTokenizerFn& tokenizer);
+
+/// Incremental version of chunk_fixed_size for content that arrives in parts, e.g. a file read window by window.
+/// Only keeps the not yet chunked tail of the content (at most about one chunk plus the last fed part), so memory stays
+/// bounded regardless of the document size. The overlap between consecutive chunks is carried across parts, feeding
+/// content in any split produces exactly the chunks chunk_fixed_size produces for the whole content.
+class FixedSizeChunker
+{
+public:
+  /// @param config The fixed size chunking configuration, expected to be sane
+  explicit FixedSizeChunker(const FixedSizeChunkingConfig& config);
+
+  /// Appends the next part of the content and emits every chunk that is fully determined by the content seen so far.
+  /// @param content_part The next part of the content, may end in the middle of a UTF-8 character
+  /// @param out Emitted chunks are appended here, with sequence indexes continuing across calls
+  void feed(std::string_view content_part, std::vector<DocumentChunk>& out);
+
+  /// Emits the remaining chunks once the whole content was fed. The chunker is reset afterwards.
+  /// @param out Emitted chunks are appended here
+  void finish(std::vector<DocumentChunk>& out);
+
+  /// @return number of chunks emitted so far
+  uint32_t emitted_chunks() const { return m_nextSequenceIndex; }
+
+private:
+  size_t m_chunkSize = 0;
+  size_t m_overlap = 0;
+  /// Content not yet fully chunked, chunking resumes at m_start
+  std::string m_buffer;
+  size_t m_start = 0;
+  uint32_t m_nextSequenceIndex = 0;
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "types/odai_result.h"
+#include "types/odai_types.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// Reads spans of consecutive document chunks, see IOdaiDb::get_document_chunk_spans().
+/// Returns one list of chunks per span, in the same order as the spans.
+using ChunkSpanReadFn =
+    std::function<OdaiResult<std::vector<std::vector<DocumentChunk>>>(const std::vector<DocumentChunkSpan>& spans)>;
+
+/// Appends the next chunk of a document to a passage ending with the previous chunk, dropping the longest prefix of
+/// the chunk the passage already ends with, which is the text the two chunks overlap on.
+/// @param passage The passage, extended in place
+/// @param next_chunk The chunk following the passage's last chunk in its document
+void append_without_overlap(std::string& passage, std::string_view next_chunk);
+
+/// Widens retrieved chunks with the chunks around them in their documents.
+/// Every chunk covers the positions up to context_window before and after it. Windows of one document that overlap or
+/// touch are merged, so each merged span becomes one passage holding every chunk of the span once. All spans are read
+/// with a single read_fn call.
+/// @param chunks Retrieved chunks ordered from most to least relevant
+/// @param context_window Neighbours to add on each side of a chunk, 0 returns the chunks unchanged
+/// @param chunks_overlap Whether consecutive chunks of the space repeat text, dropped when joining them
+/// @param read_fn Reads the chunks of the merged spans
+/// @return one passage per merged span, ordered and scored by the most relevant chunk it contains, or an unexpected
+/// OdaiResultEnum if reading failed. A span whose document is gone keeps that chunk alone.
+OdaiResult<std::vector<RetrievedChunk>> expand_chunk_context(std::vector<RetrievedChunk> chunks, uint32_t context_window,
+                                                             bool chunks_overlap, const ChunkSpanReadFn& read_fn);
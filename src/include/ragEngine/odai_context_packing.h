@@ -0,0 +1,17 @@
+#pragma once
+
+#include "types/odai_types.h"
+#include <cstdint>
+#include <vector>
+
+/// Keeps the most relevant retrieved chunks that fit a token budget.
+/// Chunks are taken from most to least relevant, one that doesn't fit what is left of the budget is skipped so that a
+/// shorter, less relevant chunk can still use the room.
+/// @param chunks Retrieved chunks ordered from most to least relevant
+/// @param token_counts Tokens each chunk takes in the prompt, in the same order as chunks
+/// @param token_budget Tokens the kept chunks may take in total
+/// @param used_tokens Set to the tokens the kept chunks take (modified in place)
+/// @return the kept chunks, still ordered from most to least relevant
+std::vector<RetrievedChunk> pack_chunks_into_budget(std::vector<RetrievedChunk> chunks,
+                                                    const std::vector<uint32_t>& token_counts, uint32_t token_budget,
+                                                    uint32_t& used_tokens);
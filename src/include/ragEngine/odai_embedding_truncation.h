@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/// Truncates an embedding to a prefix of its components and L2-normalizes the prefix again.
+/// Matryoshka trained embedding models front-load their information, so a prefix stays a usable embedding of the
+/// same text while taking proportionally less storage and search time.
+/// @param embedding The embedding to truncate (modified in place)
+/// @param dimensions Components to keep, 0 leaves the embedding unchanged
+/// @return false if the embedding has fewer than dimensions components, it is then left unchanged
+bool truncate_embedding(std::vector<float>& embedding, uint32_t dimensions);
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "backendEngine/odai_backend_engine.h"
+#include "db/odai_db.h"
+#include "types/odai_result.h"
+#include "types/odai_types.h"
+#include "utils/odai_bounded_queue.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/// Staged pipeline ingesting many documents into one semantic space scope.
+/// Runs read -> chunk -> hash/dedupe -> embed -> write as concurrent stages connected by bounded queues, so the memory
+/// held by in-flight documents stays bounded and I/O, chunking, embedding and DB writes overlap.
+///  - read and chunk stages run a worker pool each. Token aware chunking tokenizes through the backend, one chunk
+///    worker at a time.
+///  - dedupe runs on one thread, it decides which chunk contents still need an embedding and must see documents in
+///    a single order so a content repeated across documents is embedded once. Contents the embedding model file
+///    embedded before, for any space, take their stored embedding there.
+///  - embed runs on one thread batching chunks of several documents per backend call, as backend engines are not
+///    thread safe and already parallelize a single call internally.
+///  - write runs on one thread, committing several documents per transaction.
+/// A document failing in any stage is logged and counted, the remaining documents are still ingested. A failed document
+/// releases the contents it claimed for embedding, documents of the run relying on them embed those contents
+/// themselves before they are written.
+/// A pipeline object runs once, create a new one per bulk ingestion.
+class OdaiIngestPipeline
+{
+public:
+  /// @param db Database to write into, must stay valid while run() executes
+  /// @param backend_engine Backend engine used to embed chunks, must stay valid while run() executes
+  /// @param space_config Configuration of the target semantic space
+  /// @param embedding_model_files Resolved model files of the space's embedding model
+  /// @param embedding_model_checksums Checksums of the space's embedding model, keying its stored embeddings
+  /// @param scope_id Scope of the ingested documents
+  /// @param config Pipeline configuration, expected to be sane
+  OdaiIngestPipeline(IOdaiDb& db, IOdaiBackendEngine& backend_engine, SemanticSpaceConfig space_config,
+                     ModelFiles embedding_model_files, std::string embedding_model_checksums, ScopeId scope_id,
+                     const BulkIngestConfig& config);
+
+  OdaiIngestPipeline(const OdaiIngestPipeline&) = delete;
+  OdaiIngestPipeline& operator=(const OdaiIngestPipeline&) = delete;
+  OdaiIngestPipeline(OdaiIngestPipeline&&) = delete;
+  OdaiIngestPipeline& operator=(OdaiIngestPipeline&&) = delete;
+
+  /// Ingests the given documents and blocks until all stages are drained.
+  /// @param sources The documents to ingest
+  /// @return ingestion statistics on success (including per document failures), or an unexpected OdaiResultEnum if
+  /// the pipeline itself failed
+  OdaiResult<BulkIngestStats> run(const std::vector<IngestDocumentSource>& sources);
+
+private:
+  /// A document travelling through the pipeline
+  struct PipelineDocument
+  {
+    DocumentId m_documentId;
+    std::string m_sourceUri;
+    DocumentMetadata m_metadata;
+    std::string m_content;
+    std::vector<DocumentChunk> m_chunks;
+    /// Indexes into m_chunks of the chunks this document has to embed
+    std::vector<size_t> m_chunksToEmbed;
+    /// Content hashes this document claimed, later documents containing them rely on it writing their vectors
+    std::vector<uint64_t> m_claimedHashes;
+  };
+
+  struct StageCounters
+  {
+    uint32_t m_workers{};
+    std::atomic<uint64_t> m_itemsProcessed{0};
+    std::atomic<int64_t> m_busyNanoseconds{0};
+  };
+
+  void read_worker(const std::vector<IngestDocumentSource>& sources);
+  void chunk_worker();
+  void dedupe_worker();
+  void embed_worker();
+  void write_worker();
+
+  /// Fills the chunks a document has to embed from embeddings stored for the space's model and drops them from its
+  /// chunks to embed. Stored embeddings are truncated like fresh ones.
+  /// @return false if a stored embedding doesn't match the space's dimensions
+  bool take_stored_embeddings(PipelineDocument& document,
+                              std::unordered_map<uint64_t, std::vector<float>>& stored_embeddings);
+
+  /// Embeds the pending chunks of a batch of documents in one backend call and forwards them to the write stage.
+  void embed_batch(std::vector<PipelineDocument>& batch);
+
+  /// Writes a batch of documents in one transaction, falling back to one transaction per document if any fails.
+  void write_batch(std::vector<PipelineDocument>& batch);
+
+  /// Embeds the chunks of a document whose content was claimed by a document that failed, from the embeddings stored
+  /// for the model if the failed document got that far and with the backend otherwise. Called right before writing.
+  /// @return false if the document failed, the failure is already recorded
+  bool embed_released_chunks(PipelineDocument& document);
+
+  /// Settles the claims of a document once it was written or failed. A failed document's claims are released, a
+  /// written one's vectors serve every later document.
+  void finish_claims(const PipelineDocument& document, bool written);
+
+  /// Runs a worker body, aborting the whole pipeline if it throws.
+  template <typename Fn>
+  void run_worker(const char* stage_name, Fn&& worker_body);
+
+  /// Closes every queue so all workers stop as soon as possible.
+  void abort();
+
+  void record_failure(const DocumentId& document_id, OdaiResultEnum error);
+  void record_busy(IngestStage stage, std::chrono::steady_clock::time_point start, uint64_t items);
+
+  BulkIngestStats collect_stats(double elapsed_seconds) const;
+
+  IOdaiDb& m_db;
+  IOdaiBackendEngine& m_backendEngine;
+  const SemanticSpaceConfig m_spaceConfig;
+  const ModelFiles m_embeddingModelFiles;
+  const std::string m_embeddingModelChecksums;
+  const ScopeId m_scopeId;
+  const BulkIngestConfig m_config;
+
+  /// Queues between stages, the queue at index N is the input queue of stage N + 1
+  OdaiBoundedQueue<PipelineDocument> m_readQueue;
+  OdaiBoundedQueue<PipelineDocument> m_chunkQueue;
+  OdaiBoundedQueue<PipelineDocument> m_dedupeQueue;
+  OdaiBoundedQueue<PipelineDocument> m_embedQueue;
+
+  std::array<StageCounters, INGEST_STAGE_COUNT> m_stageCounters;
+
+  /// Serializes DB access between the dedupe and write stages, IOdaiDb is not thread safe
+  std::mutex m_dbMutex;
+
+  /// Serializes backend access between the chunk stage (tokenizing for token aware chunking) and the embed stage,
+  /// backend engines are not thread safe. Tokenization is parallelized inside the backend call.
+  std::mutex m_backendMutex;
+
+  /// Content hashes claimed for embedding by a document of this run, only touched by the dedupe stage
+  std::unordered_set<uint64_t> m_claimedHashes;
+
+  /// Guards m_releasedHashes, shared by the embed and write stages
+  std::mutex m_claimMutex;
+  /// Claimed content hashes whose document failed before writing them, and that no document wrote since
+  std::unordered_set<uint64_t> m_releasedHashes;
+
+  std::atomic<size_t> m_nextSourceIndex{0};
+  std::atomic<uint32_t> m_activeReaders{0};
+  std::atomic<uint32_t> m_activeChunkers{0};
+  std::atomic<bool> m_aborted{false};
+
+  std::atomic<uint64_t> m_documentsIngested{0};
+  std::atomic<uint64_t> m_documentsFailed{0};
+  std::atomic<uint64_t> m_chunksProcessed{0};
+  std::atomic<uint64_t> m_chunksEmbedded{0};
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "types/odai_result.h"
+#include "types/odai_types.h"
+#include <cstdint>
+#include <vector>
+
+/// Picks diverse chunks among vector search candidates with maximal marginal relevance.
+/// Chunks are picked greedily, each time the candidate maximizing lambda * relevance - (1 - lambda) * redundancy, where
+/// relevance is the candidate's m_score and redundancy its highest cosine similarity to an already picked chunk. The
+/// first pick is thus the most relevant candidate, later picks skip near duplicates of earlier ones.
+/// @param candidates Vector search candidates with their embeddings (see IOdaiDb::search_chunks())
+/// @param top_k Maximum number of chunks to pick
+/// @param lambda Weight of relevance against redundancy between 0.0 and 1.0, 1.0 keeps the candidates' order
+/// @return up to top_k chunks in pick order keeping their search scores, or VALIDATION_FAILED if a candidate has no
+/// embedding or embeddings differ in dimension
+OdaiResult<std::vector<RetrievedChunk>> select_diverse_chunks(std::vector<RetrievedChunk> candidates, uint32_t top_k,
+                                                              float lambda);
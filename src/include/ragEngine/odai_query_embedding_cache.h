@@ -0,0 +1,77 @@
+#pragma once
+
+#include "types/odai_types.h"
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/// Bounded LRU cache of query embeddings, keyed by the embedding model's checksums and the normalized query text.
+/// Keying on checksums rather than the model name means re-registered model files never serve stale embeddings, even
+/// before invalidate_model() drops them. Queries are keyed by a 64-bit hash of their normalized text.
+/// Thread safe.
+class OdaiQueryEmbeddingCache
+{
+public:
+  /// @param capacity Maximum number of cached embeddings, 0 disables caching
+  explicit OdaiQueryEmbeddingCache(size_t capacity);
+
+  /// Normalizes a query for cache keys: trims it and collapses every run of whitespace to one space, so retries
+  /// differing only in spacing share an entry. Case is kept, as embedding models may be case sensitive.
+  static std::string normalize_query(std::string_view query);
+
+  /// Looks up a query's embedding and counts a hit or a miss.
+  /// @param model_checksums Checksums of the embedding model's files, as stored when the model was registered
+  /// @param query The query text, normalized by the cache
+  /// @return the cached embedding, or nullopt on a miss
+  std::optional<std::vector<float>> find(const std::string& model_checksums, std::string_view query);
+
+  /// Caches a query's embedding, evicting the least recently used one when full.
+  /// @param model_name Name of the embedding model, used by invalidate_model()
+  /// @param model_checksums Checksums of the embedding model's files
+  /// @param query The query text, normalized by the cache
+  /// @param embedding The query's embedding
+  void insert(const ModelName& model_name, const std::string& model_checksums, std::string_view query,
+              std::vector<float> embedding);
+
+  /// Drops every embedding made with a model, called when the model's files change.
+  void invalidate_model(const ModelName& model_name);
+
+  QueryEmbeddingCacheStats stats() const;
+
+private:
+  struct Key
+  {
+    uint64_t m_modelHash{};
+    uint64_t m_queryHash{};
+
+    bool operator==(const Key&) const = default;
+  };
+
+  struct KeyHash
+  {
+    size_t operator()(const Key& key) const { return static_cast<size_t>(key.m_modelHash ^ (key.m_queryHash * 31)); }
+  };
+
+  struct Entry
+  {
+    Key m_key;
+    ModelName m_modelName;
+    std::vector<float> m_embedding;
+  };
+
+  static Key make_key(const std::string& model_checksums, std::string_view query);
+
+  size_t m_capacity;
+  /// Most recently used first
+  std::list<Entry> m_entries;
+  std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> m_index;
+  uint64_t m_hits = 0;
+  uint64_t m_misses = 0;
+  mutable std::mutex m_mutex;
+};
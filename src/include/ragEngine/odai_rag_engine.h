@@ -2,8 +2,17 @@
 
 #include "backendEngine/odai_backend_engine.h"
 #include "db/odai_db.h"
+#include "ragEngine/odai_query_embedding_cache.h"
+#include "ragEngine/odai_reembed_worker.h"
+#include "ragEngine/odai_rerank.h"
+#include "ragEngine/odai_retrieval_cache.h"
+#include "ragEngine/odai_retrieval_pool.h"
+#include "ragEngine/odai_token_count_cache.h"
 #include "types/odai_result.h"
 #include "types/odai_types.h"
+#include <memory>
+#include <optional>
+#include <shared_mutex>
 #include <vector>
 
 // Forward declarations
@@ -62,7 +71,8 @@ public:
   /// Generates a streaming response for the given query for the given chat.
   /// Uses the previously loaded chat if cached, else will load chat and then
   /// generates a response. If RAG is enabled for the chat, retrieves relevant
-  /// context from the knowledge base.
+  /// context from the knowledge base and places the chunks fitting the LLM context window before the prompt. The chat
+  /// history stores the prompt without the context, citing the retrieved chunks in the user message metadata.
   /// @param chat_id Unique identifier for the chat session
   /// @param query The input query/message to generate a response for
   /// @param generator_config (Sampler, RAG settings, etc.)
@@ -77,7 +87,9 @@ public:
                                                               OdaiStreamRespCallbackFn callback, void* user_data);
 
   /// Creates a new semantic space for vector embeddings in the database.
-  /// @param config The configuration for the semantic space to be created
+  /// The embedding dimensions are read from the embedding model, so the space's vector table is created up front.
+  /// @param config The configuration for the semantic space to be created, m_dimensions 0 infers it and any other
+  /// value must match the embedding model
   /// @return empty expected if semantic space creation succeeds, or an unexpected OdaiResultEnum indicating the error
   OdaiResult<void> create_semantic_space(const SemanticSpaceConfig& config);
 
@@ -95,6 +107,98 @@ public:
   /// @return empty expected if deletion succeeds, or an unexpected OdaiResultEnum indicating the error
   OdaiResult<void> delete_semantic_space(const SemanticSpaceName& name);
 
+  /// Writes a semantic space with its documents, chunks and vectors into a standalone knowledge pack file.
+  /// @param name The semantic space to export
+  /// @param pack_path Path of the pack file to create
+  /// @param include_ann_index Whether to append the space's HNSW graph, so importers don't rebuild it
+  /// @return empty expected if the pack was written, or an unexpected OdaiResultEnum indicating the error
+  OdaiResult<void> export_knowledge_pack(const SemanticSpaceName& name, const std::string& pack_path,
+                                         bool include_ann_index);
+
+  /// Attaches a knowledge pack file as a read-only semantic space, searched in place without copying its contents.
+  /// @param pack_path Path of the pack file, it must stay in place while attached
+  /// @param name Name of the attached space, empty to keep the name the pack was exported with
+  /// @return the attached space's configuration, or an unexpected OdaiResultEnum indicating the error
+  OdaiResult<SemanticSpaceConfig> import_knowledge_pack(const std::string& pack_path, const SemanticSpaceName& name);
+
+  /// Chunks the document according to the semantic space config, embeds the chunks whose content is not yet embedded
+  /// in the space in one batched call and stores the document with all its chunks. Token aware spaces tokenize the
+  /// content once with the embedding model and embed the chunks from those tokens. The document is stored without a
+  /// source uri, its retrieved chunks and citations report an empty one.
+  /// @param content The text content of the document
+  /// @param document_id Unique identifier for the document
+  /// @param semantic_space_name Name of the semantic space to add the document to
+  /// @param scope_id Scope identifier to group documents
+  /// @param metadata Metadata of the document, searches can filter on the space's filter fields
+  /// @return empty expected if the document was added, or an unexpected OdaiResultEnum indicating the error
+  OdaiResult<void> add_document(const std::string& content, const DocumentId& document_id,
+                                const SemanticSpaceName& semantic_space_name, const ScopeId& scope_id,
+                                const DocumentMetadata& metadata);
+
+  /// Replaces an existing document with a new version of its content. The content is chunked like in add_document and
+  /// only chunks whose content the space hasn't embedded yet are embedded. Unchanged chunks keep their stored vectors
+  /// under their new positions, and chunks the new version dropped are removed with their vectors.
+  /// @param content The new text content of the document
+  /// @param document_id The document to update
+  /// @param semantic_space_name Name of the semantic space the document was added to
+  /// @param scope_id Scope of the document
+  /// @param metadata Metadata of the new version, replacing the stored one. Kept chunks take its filter field values.
+  /// @return empty expected if the document was updated, or an unexpected OdaiResultEnum indicating the error
+  OdaiResult<void> update_document(const std::string& content, const DocumentId& document_id,
+                                   const SemanticSpaceName& semantic_space_name, const ScopeId& scope_id,
+                                   const DocumentMetadata& metadata);
+
+  /// Streams a document from a file into a semantic space without loading the whole file in memory.
+  /// The file is read in windows of a few dozen chunks, chunked incrementally with the overlap carried across windows,
+  /// and each window is embedded and stored before the next is read. Each window is committed on its own and embedded
+  /// outside any transaction, so other writers are only held off for one window's write. The trade-off is that searches
+  /// running meanwhile can see the windows stored so far; a failure removes them again, leaving no partial document.
+  /// Requires the space to use fixed size chunking.
+  /// @param file_path Path of the text file to ingest, also stored as the document's source uri
+  /// @param document_id Unique identifier for the document
+  /// @param semantic_space_name Name of the semantic space to add the document to
+  /// @param scope_id Scope identifier to group documents
+  /// @param metadata Metadata of the document, searches can filter on the space's filter fields
+  /// @return empty expected if the document was added, or an unexpected OdaiResultEnum indicating the error
+  OdaiResult<void> add_document_from_file(const std::string& file_path, const DocumentId& document_id,
+                                          const SemanticSpaceName& semantic_space_name, const ScopeId& scope_id,
+                                          const DocumentMetadata& metadata);
+
+  /// Ingests many documents read from files into one scope of a semantic space through the staged ingestion pipeline.
+  /// Documents that fail are logged and counted in the returned stats, the others are still ingested.
+  /// @param sources The documents to ingest
+  /// @param semantic_space_name Name of the semantic space to add the documents to
+  /// @param scope_id Scope identifier to group the documents
+  /// @param config Worker counts, queue bounds and batch sizes of the pipeline
+  /// @return ingestion statistics on success, or an unexpected OdaiResultEnum indicating the error
+  OdaiResult<BulkIngestStats> add_documents(const std::vector<IngestDocumentSource>& sources,
+                                            const SemanticSpaceName& semantic_space_name, const ScopeId& scope_id,
+                                            const BulkIngestConfig& config);
+
+  /// Starts re-embedding a semantic space with a new embedding model in the background. The space keeps serving its
+  /// current model and vectors while a worker thread re-embeds its chunks in paced batches, then switches to the new
+  /// ones at once. Progress is persisted after each batch, a job interrupted by a shutdown resumes after the next
+  /// initialize_rag_engine().
+  /// @param semantic_space_name Name of the semantic space to re-embed
+  /// @param embedding_model_config The new embedding model, its dimensions are read from the model. The space's
+  /// truncation must fit them.
+  /// @param config Batch size and CPU share of the job
+  /// @return empty expected if the job started, or an unexpected OdaiResultEnum indicating the error (ALREADY_EXISTS
+  /// if the space is already being re-embedded)
+  OdaiResult<void> start_reembedding(const SemanticSpaceName& semantic_space_name,
+                                     const EmbeddingModelConfig& embedding_model_config, const ReembedConfig& config);
+
+  /// @param semantic_space_name Name of the semantic space being re-embedded
+  /// @return the space's re-embedding job with its progress, or an unexpected OdaiResultEnum indicating the error
+  /// (NOT_FOUND if the space has no pending job, e.g. it already switched)
+  OdaiResult<ReembedJob> get_reembedding_job(const SemanticSpaceName& semantic_space_name);
+
+  /// Cancels a space's re-embedding, the space keeps its current model and vectors.
+  /// @param semantic_space_name Name of the semantic space being re-embedded
+  /// @return empty expected if cancelled, or an unexpected OdaiResultEnum indicating the error (NOT_FOUND if the space
+  /// has no pending job)
+  OdaiResult<void> cancel_reembedding(const SemanticSpaceName& semantic_space_name);
+
   /// Creates a new chat session in the database with the provided identifier and configuration.
   /// @param chat_id Unique identifier for the new chat session
   /// @param chat_config Configuration parameters for the chat session
@@ -111,13 +215,180 @@ public:
   /// @return true/false on success, or an unexpected OdaiResultEnum indicating the error
   OdaiResult<bool> chat_id_exists(const ChatId& chat_id);
 
+  /// @return hit and miss counters of the query embedding cache
+  QueryEmbeddingCacheStats get_query_embedding_cache_stats() const;
+
+  /// @return hit and miss counters and memory use of the retrieval result cache
+  RetrievalCacheStats get_retrieval_cache_stats() const;
+
+  /// @return hit and miss counters of the LLM token count cache
+  TokenCountCacheStats get_token_count_cache_stats() const;
+
 private:
   /// Resolves the file system path for a given model name using cache or
   /// database.
   /// @param model_name The name of the model.
+  /// @param db Database connection to read the registry with
   /// @return resolved file details on success, or an unexpected OdaiResultEnum indicating the error.
-  OdaiResult<ModelFiles> resolve_model_files(const ModelName& model_name);
+  OdaiResult<ModelFiles> resolve_model_files(const ModelName& model_name, IOdaiDb& db);
+
+  /// Retrieves the chunks of the RAG scope most relevant to the text of the prompt.
+  /// The result comes from the retrieval cache when the same query was retrieved with the same settings and the scope
+  /// hasn't been written to since, otherwise it is searched with search_context() and cached.
+  /// @param rag_config RAG settings of the generation call
+  /// @param space_config Configuration of the semantic space to search
+  /// @param prompt The user prompt, only its text items are used as the query
+  /// @param rerank_stats Filled with what the reranker did, left untouched when it isn't used or the result is cached
+  /// (modified in place)
+  /// @param db Database connection to search with, the engine's own or a retrieval worker's
+  /// @param backend_engine Backend engine to embed the query and rerank with, owned like db
+  /// @return retrieved chunks from most to least relevant (empty if none qualify or the prompt has no text), or an
+  /// unexpected OdaiResultEnum indicating the error (INVALID_ARGUMENT for an unknown search type)
+  OdaiResult<std::vector<RetrievedChunk>> retrieve_context(const GeneratorRagConfig& rag_config,
+                                                           const SemanticSpaceConfig& space_config,
+                                                           const std::vector<InputItem>& prompt,
+                                                           RerankStats& rerank_stats, IOdaiDb& db,
+                                                           IOdaiBackendEngine& backend_engine);
+
+  /// Retrieves the chunks most relevant to the text of the prompt from several semantic spaces and merges them into
+  /// one ranking. Each space is searched like retrieve_context() but without reranking and context expansion, keeping
+  /// fetchK candidates when the reranker is enabled. Spaces of the embedding model of the first space are searched on
+  /// the calling thread, the others on the retrieval pool worker of their model, so spaces of different models embed
+  /// and search concurrently. The rankings are merged by rag_config's merge type, then reranked and expanded once.
+  /// @param rag_config RAG settings of the generation call
+  /// @param space_configs Configurations of the semantic spaces to search, the primary space first
+  /// @param prompt The user prompt, only its text items are used as the query
+  /// @param rerank_stats Filled with what the reranker did, left untouched when it isn't used (modified in place)
+  /// @return retrieved chunks from most to least relevant (empty if none qualify or the prompt has no text), or an
+  /// unexpected OdaiResultEnum indicating the error of the first space that failed
+  OdaiResult<std::vector<RetrievedChunk>> retrieve_multi_space_context(
+      const GeneratorRagConfig& rag_config, const std::vector<SemanticSpaceConfig>& space_configs,
+      const std::vector<InputItem>& prompt, RerankStats& rerank_stats);
+
+  /// Keeps the most relevant retrieved chunks that fit the LLM context window next to the chat history and the prompt,
+  /// within the configured context token budget (see pack_chunks_into_budget()).
+  /// Chunks, history messages and the prompt are counted through the token count cache, so a text is only tokenized
+  /// the first time it is packed for the model. Only text items are counted, media items aren't.
+  /// @param rag_config RAG settings of the generation call, provide the context token budget
+  /// @param llm_model_config The LLM generating the response, provides the context window
+  /// @param model_files The model files of the LLM
+  /// @param chat_history The chat history loaded before the prompt
+  /// @param prompt The user prompt
+  /// @param chunks Retrieved chunks from most to least relevant, the ones that don't fit are removed (modified in place)
+  /// @return LLM tokens the kept chunks take, or an unexpected OdaiResultEnum indicating the error
+  OdaiResult<uint32_t> pack_retrieved_context(const GeneratorRagConfig& rag_config,
+                                              const LLMModelConfig& llm_model_config, const ModelFiles& model_files,
+                                              const std::vector<ChatMessage>& chat_history,
+                                              const std::vector<InputItem>& prompt,
+                                              std::vector<RetrievedChunk>& chunks);
+
+  /// Searches the chunks of the RAG scope most relevant to a query.
+  /// Depending on the search type, fetches the max(fetchK, topK) best chunks of the scope by vector similarity to the
+  /// embedded query, by BM25 keyword match (without embedding the query), or both. Each search drops the chunks
+  /// scoring under the score threshold, hybrid search then fuses both rankings with reciprocal rank fusion and MMR
+  /// search picks topK diverse chunks among the vector candidates. With the reranker enabled the candidates are
+  /// reranked, otherwise the topK best chunks are kept. A context window then widens the chunks with their neighbours,
+  /// merging the ones of a document that overlap into one passage (see expand_chunk_context()).
+  /// @param rag_config RAG settings of the generation call
+  /// @param space_config Configuration of the semantic space to search
+  /// @param query The query text, not empty
+  /// @param rerank_stats Filled with what the reranker did, left untouched when it isn't used (modified in place)
+  /// @param db Database connection to search with
+  /// @param backend_engine Backend engine to embed the query and rerank with
+  /// @return retrieved chunks from most to least relevant (empty if none qualify), or an unexpected OdaiResultEnum
+  /// indicating the error
+  OdaiResult<std::vector<RetrievedChunk>> search_context(const GeneratorRagConfig& rag_config,
+                                                         const SemanticSpaceConfig& space_config,
+                                                         const std::string& query, RerankStats& rerank_stats,
+                                                         IOdaiDb& db, IOdaiBackendEngine& backend_engine);
+
+  /// Reranks first stage candidates with the configured reranker model and keeps the topK best, see rerank_chunks().
+  /// @param retrieval_config Retrieval settings, provide the reranker model, topK, early stop margin and time budget
+  /// @param query The query text the candidates are scored against
+  /// @param candidates Candidates ordered by first stage score, best first
+  /// @param fused_scores Whether candidate scores come from rank fusion, which disables the early stop
+  /// @param rerank_stats Filled with what the rerank did (modified in place)
+  /// @param db Database connection to resolve the reranker model with
+  /// @param backend_engine Backend engine to rerank with
+  /// @param candidate_positions If not null, filled with the position in candidates of each returned chunk
+  /// @return reranked chunks from most to least relevant, or an unexpected OdaiResultEnum indicating the error
+  /// (VALIDATION_FAILED if the model isn't registered as a reranker)
+  OdaiResult<std::vector<RetrievedChunk>> rerank_candidates(const RetrievalConfig& retrieval_config,
+                                                            const std::string& query,
+                                                            std::vector<RetrievedChunk> candidates, bool fused_scores,
+                                                            RerankStats& rerank_stats, IOdaiDb& db,
+                                                            IOdaiBackendEngine& backend_engine,
+                                                            std::vector<size_t>* candidate_positions = nullptr);
+
+  /// Embeds a query with the space's embedding model and finds the scope's chunks nearest to it.
+  /// The query embedding comes from the query embedding cache when the same model embedded the same query before.
+  /// @param space_config Configuration of the semantic space to search
+  /// @param scope_id Scope to search in
+  /// @param query The query text
+  /// @param document_limit Only search the chunks of this many documents nearest to the query, 0 searches all chunks
+  /// @param limit Maximum number of chunks to return
+  /// @param include_embeddings Whether the chunks carry their stored embeddings
+  /// @param filter Only chunks of documents matching it are searched
+  /// @param db Database connection to search with
+  /// @param backend_engine Backend engine to embed the query with
+  /// @return chunks from most to least similar, or an unexpected OdaiResultEnum indicating the error
+  OdaiResult<std::vector<RetrievedChunk>> search_by_embedding(const SemanticSpaceConfig& space_config,
+                                                              const ScopeId& scope_id, const std::string& query,
+                                                              uint32_t document_limit, uint32_t limit,
+                                                              bool include_embeddings, const MetadataFilter& filter,
+                                                              IOdaiDb& db, IOdaiBackendEngine& backend_engine);
+
+  /// Resolves the embedding model files of a semantic space once, later calls reuse the cached files.
+  /// @param embedding_config The embedding model configuration of the semantic space
+  /// @param embedding_model_files Cached model files, filled on first call
+  /// @param db Database connection to read the registry with
+  /// @return empty expected if the files are available, or an unexpected OdaiResultEnum indicating the error
+  OdaiResult<void> resolve_embedding_model_files(const EmbeddingModelConfig& embedding_config,
+                                                 std::optional<ModelFiles>& embedding_model_files, IOdaiDb& db);
+
+  /// Embeds, in one batched backend call, the chunks whose content the semantic space has not embedded yet.
+  /// A content repeated inside chunks is embedded once, the other chunks are left to reuse it when stored.
+  /// Content the same embedding model file embedded before, for any space, takes its stored embedding instead, and
+  /// new embeddings are stored for later reuse (see IOdaiDb::get_stored_chunk_embeddings()).
+  /// Chunks of token aware spaces are embedded from their token ids instead of their text.
+  /// @param space_config Configuration of the semantic space the chunks are added to
+  /// @param document_id The document the chunks belong to, used for logging
+  /// @param chunks The chunks, embeddings are filled in place
+  /// @param embedding_model_files Cached model files of the embedding model, resolved on first use
+  /// @return number of chunks embedded by the backend on success, or an unexpected OdaiResultEnum indicating the error
+  OdaiResult<size_t> embed_new_chunks(const SemanticSpaceConfig& space_config, const DocumentId& document_id,
+                                      std::vector<DocumentChunk>& chunks,
+                                      std::optional<ModelFiles>& embedding_model_files);
+
+  /// Chunks a document's content with its semantic space's chunking config and embeds the new chunks (see
+  /// embed_new_chunks()).
+  /// @param content The text content of the document
+  /// @param document_id The document, for logging
+  /// @param semantic_space_name Name of the semantic space the document is stored in
+  /// @return the chunks ready to be stored, or an unexpected OdaiResultEnum indicating the error (VALIDATION_FAILED if
+  /// the content produced no chunks)
+  OdaiResult<std::vector<DocumentChunk>> chunk_and_embed_document(const std::string& content,
+                                                                  const DocumentId& document_id,
+                                                                  const SemanticSpaceName& semantic_space_name);
+
+  /// Wakes the re-embedding worker for a new job, or starts a worker with its own database connection and backend
+  /// engine if none is running.
+  /// @return empty expected if a worker runs the pending jobs, or an unexpected OdaiResultEnum indicating the error
+  OdaiResult<void> run_reembed_worker();
 
+  DBConfig m_dbConfig;
+  BackendEngineConfig m_backendConfig;
   std::unique_ptr<IOdaiDb> m_db;
   std::unique_ptr<IOdaiBackendEngine> m_backendEngine;
+  OdaiQueryEmbeddingCache m_queryEmbeddingCache{QUERY_EMBEDDING_CACHE_CAPACITY};
+  OdaiRetrievalCache m_retrievalCache{RETRIEVAL_CACHE_MAX_BYTES};
+  OdaiTokenCountCache m_tokenCountCache{TOKEN_COUNT_CACHE_CAPACITY};
+  /// Held shared while a space's config is used to embed and then write or search its vectors, and exclusively by the
+  /// re-embedding worker while a space switches to its new model
+  std::shared_mutex m_vectorSwitchMutex;
+  /// Searches the spaces of further embedding models in multi-space retrievals, declared after the caches its tasks
+  /// use so its threads stop first
+  OdaiRetrievalPool m_retrievalPool;
+  /// Declared last, so its thread stops before the members it uses are destroyed
+  std::unique_ptr<OdaiReembedWorker> m_reembedWorker;
 };
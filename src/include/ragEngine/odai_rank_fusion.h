@@ -0,0 +1,56 @@
+#pragma once
+
+#include "types/odai_types.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// Rank constant of reciprocal rank fusion, the usual value from the original paper. Larger values flatten the gap
+/// between top and lower ranks.
+constexpr uint32_t RRF_DEFAULT_RANK_CONSTANT = 60;
+
+/// A chunk of merged rankings with the origin of the rankings it was found in, e.g. the ordinal of its semantic space.
+struct MergedChunk
+{
+  RetrievedChunk m_chunk;
+  size_t m_origin{};
+};
+
+/// Merges rankings of the same query from different searches with reciprocal rank fusion.
+/// A chunk scores the sum of 1 / (rank_constant + rank) over the rankings containing it, rank starting at 1, so only
+/// positions matter and scores of different searches never need to be comparable. Scores are divided by the score of
+/// a chunk ranked first everywhere, which scores 1.0.
+/// Chunks are identified by document id and sequence index, the first occurrence's content and source are kept.
+/// @param rankings The rankings to fuse, each ordered from best to worst
+/// @param rank_constant The rank constant k
+/// @return every chunk of the rankings once, ordered by fused score (ties keep first appearance order)
+std::vector<RetrievedChunk> fuse_reciprocal_rank(const std::vector<std::vector<RetrievedChunk>>& rankings,
+                                                 uint32_t rank_constant = RRF_DEFAULT_RANK_CONSTANT);
+
+/// Fuses rankings of different origins like fuse_reciprocal_rank(), e.g. searches of several semantic spaces whose
+/// document ids may collide. Chunks are identified by origin, document id and sequence index, so only chunks of
+/// rankings with the same origin are merged.
+/// @param rankings The rankings to fuse, each ordered from best to worst
+/// @param origins The origin of each ranking
+/// @param rank_constant The rank constant k
+/// @return every chunk of the rankings once per origin with that origin, ordered by fused score
+std::vector<MergedChunk> fuse_reciprocal_rank(const std::vector<std::vector<RetrievedChunk>>& rankings,
+                                              const std::vector<size_t>& origins,
+                                              uint32_t rank_constant = RRF_DEFAULT_RANK_CONSTANT);
+
+/// Merges rankings of the same query whose scores lie on different scales, e.g. searches of semantic spaces with
+/// different embedding models. Each ranking's scores are min-max normalized over that ranking, so its best chunk
+/// scores 1.0 and its worst 0.0, a ranking whose chunks all score the same scores them 1.0. Unlike reciprocal rank
+/// fusion, a ranking with a clear winner and a long flat tail keeps that gap.
+/// Chunks are identified like in fuse_reciprocal_rank(), a chunk of several rankings keeps its best normalized score.
+/// @param rankings The rankings to merge, each ordered from best to worst
+/// @return every chunk of the rankings once, ordered by normalized score (ties keep first appearance order)
+std::vector<RetrievedChunk> merge_normalized_scores(const std::vector<std::vector<RetrievedChunk>>& rankings);
+
+/// Merges rankings of different origins like merge_normalized_scores(), identifying chunks by origin, document id and
+/// sequence index.
+/// @param rankings The rankings to merge, each ordered from best to worst
+/// @param origins The origin of each ranking
+/// @return every chunk of the rankings once per origin with that origin, ordered by normalized score
+std::vector<MergedChunk> merge_normalized_scores(const std::vector<std::vector<RetrievedChunk>>& rankings,
+                                                 const std::vector<size_t>& origins);
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "backendEngine/odai_backend_engine.h"
+#include "db/odai_db.h"
+#include "types/odai_result.h"
+#include "types/odai_types.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+/// Pause to take after a re-embedding batch so the job uses at most max_cpu_share of the wall time.
+/// @param busy Time the batch took
+/// @param max_cpu_share Fraction of wall time the job may use, in (0, 1]
+/// @return time to sleep before the next batch, zero for a share of 1
+std::chrono::nanoseconds reembed_pause(std::chrono::nanoseconds busy, float max_cpu_share);
+
+/// Background thread running the re-embedding jobs stored in the database (see IOdaiDb::start_reembedding()).
+/// Jobs take turns one batch at a time: a batch is read, embedded with the job's new model and stored together with
+/// the job's progress, so a job interrupted by a shutdown or a crash resumes after its last stored batch the next time
+/// a worker runs. After each batch the worker sleeps long enough to keep the job under its CPU share.
+/// The worker owns its database connection and backend engine, as neither is thread safe. A separate backend also
+/// keeps the new embedding model loaded without evicting the models interactive requests use.
+/// A job that caught up switches its space to the new vectors while holding the switch mutex exclusively. Requests
+/// reading a space's config and then its vectors hold it shared, so they see either the old model and vectors or the
+/// new ones.
+/// The thread exits once no job is left, releasing its connection and backend.
+class OdaiReembedWorker
+{
+public:
+  /// Starts the worker thread.
+  /// @param db Initialized database connection, used by the worker only
+  /// @param backend_engine Initialized backend engine, used by the worker only
+  /// @param switch_mutex Held exclusively while a space switches to its re-embedded vectors
+  /// @param on_switched Called with a space's name after it switched, while the switch mutex is still held
+  OdaiReembedWorker(std::unique_ptr<IOdaiDb> db, std::unique_ptr<IOdaiBackendEngine> backend_engine,
+                    std::shared_mutex& switch_mutex, std::function<void(const SemanticSpaceName&)> on_switched);
+
+  /// Stops the worker after its current batch and joins its thread. Unfinished jobs stay stored.
+  ~OdaiReembedWorker();
+
+  OdaiReembedWorker(const OdaiReembedWorker&) = delete;
+  OdaiReembedWorker& operator=(const OdaiReembedWorker&) = delete;
+  OdaiReembedWorker(OdaiReembedWorker&&) = delete;
+  OdaiReembedWorker& operator=(OdaiReembedWorker&&) = delete;
+
+  /// Tells the worker a job was started, so it doesn't exit before picking it up.
+  /// @return false if the worker already ran out of jobs and exited, a new worker has to run the job
+  bool notify();
+
+private:
+  /// Embedding model files resolved for a job's new model
+  struct ResolvedModel
+  {
+    ModelFiles m_files;
+    std::string m_checksums;
+  };
+
+  void run();
+
+  /// Re-embeds and stores the next batch of a job, or switches its space once no vectors are left.
+  /// @return true if the job is still pending, false if its space switched, or an unexpected OdaiResultEnum
+  /// indicating the error
+  OdaiResult<bool> run_batch(const ReembedJob& job);
+
+  /// Embeds a batch with the job's new model, reusing embeddings the model stored before.
+  /// @return empty expected if every chunk got its embedding, or an unexpected OdaiResultEnum indicating the error
+  OdaiResult<void> embed_batch(const SemanticSpaceConfig& target_config, std::vector<ReembedChunk>& batch);
+
+  /// @return the files and checksums of an embedding model, resolved once per worker
+  OdaiResult<const ResolvedModel*> resolve_model(const ModelName& model_name);
+
+  /// Sleeps unless the worker is stopped meanwhile.
+  /// @return false if the worker is stopping
+  bool sleep_for(std::chrono::nanoseconds duration);
+
+  std::unique_ptr<IOdaiDb> m_db;
+  std::unique_ptr<IOdaiBackendEngine> m_backendEngine;
+  std::shared_mutex& m_switchMutex;
+  std::function<void(const SemanticSpaceName&)> m_onSwitched;
+  std::unordered_map<ModelName, ResolvedModel> m_resolvedModels;
+  /// Consecutive failed batches by space, a space failing too often is left alone until the next worker
+  std::unordered_map<SemanticSpaceName, uint32_t> m_failures;
+
+  std::mutex m_mutex;
+  std::condition_variable m_wakeup;
+  bool m_stopping = false;
+  bool m_notified = false;
+  bool m_exited = false;
+  std::thread m_thread;
+};
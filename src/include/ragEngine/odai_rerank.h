@@ -0,0 +1,50 @@
+#pragma once
+
+#include "types/odai_result.h"
+#include "types/odai_types.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/// Scores texts against the query being reranked.
+/// Returns one relevance score between 0.0 and 1.0 per text, in the same order as the texts.
+using RerankScoreFn = std::function<OdaiResult<std::vector<float>>(const std::vector<std::string>& texts)>;
+
+/// Candidates scored per RerankScoreFn call. Early stop and the time budget are checked between calls, so this bounds
+/// how much scoring work is done past either.
+constexpr uint32_t RERANK_CANDIDATES_PER_ROUND = 16;
+
+/// Outcome of one rerank_chunks() call.
+struct RerankStats
+{
+  /// Number of candidates scored by the reranker
+  uint32_t m_scoredCandidates{};
+  /// Seconds spent reranking
+  double m_seconds{};
+  /// Whether scoring stopped because no remaining candidate could enter the top K
+  bool m_stoppedEarly{};
+  /// Whether scoring stopped because the time budget ran out
+  bool m_budgetExhausted{};
+};
+
+/// Reranks first stage candidates with a cross-encoder and keeps the topK best.
+/// Candidates are scored in rounds of RERANK_CANDIDATES_PER_ROUND in first stage order. Before each round, scoring
+/// stops if the topK is full and the best remaining candidate can't beat its worst chunk, bounding a candidate's
+/// reranker score by its first stage score plus config.m_rerankEarlyStopMargin. Scoring also stops once
+/// config.m_rerankTimeBudgetMs ran out; the first round is always scored. When the budget runs out before topK
+/// candidates are scored, the next unscored candidates fill the result after the scored ones, keeping their first stage
+/// scores.
+/// @param candidates Candidates ordered by first stage score, best first
+/// @param config Retrieval configuration, provides topK, the early stop margin and the time budget
+/// @param score_fn Scores candidate texts with the reranker
+/// @param stats Filled with what the rerank did (modified in place)
+/// @param candidate_positions If not null, filled with the position in candidates of each returned chunk, for callers
+/// keeping data of their own per candidate
+/// @return up to topK chunks, reranked ones ordered by reranker score with it as their m_score, or an unexpected
+/// OdaiResultEnum if scoring failed
+OdaiResult<std::vector<RetrievedChunk>> rerank_chunks(std::vector<RetrievedChunk> candidates,
+                                                      const RetrievalConfig& config, const RerankScoreFn& score_fn,
+                                                      RerankStats& stats,
+                                                      std::vector<size_t>* candidate_positions = nullptr);
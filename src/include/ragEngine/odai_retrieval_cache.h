@@ -0,0 +1,80 @@
+#pragma once
+
+#include "types/odai_types.h"
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/// Cache of retrieval results bounded by memory, evicting least recently used results first.
+/// Results are keyed by semantic space, scope, normalized query text and every RetrievalConfig field. Each scope has a
+/// generation, bumped by writes to the scope or to its whole space; a result is only served while the generation it
+/// was computed at is current.
+/// Thread safe.
+class OdaiRetrievalCache
+{
+public:
+  /// @param max_bytes Memory the cached results may hold, 0 disables caching
+  explicit OdaiRetrievalCache(uint64_t max_bytes);
+
+  /// Reads a scope's generation, to be taken before retrieving the result later passed to insert(). A write during
+  /// the retrieval then leaves the inserted result stale instead of serving it.
+  uint64_t generation(const SemanticSpaceName& space_name, const ScopeId& scope_id) const;
+
+  /// Looks up a retrieval result and counts a hit or a miss.
+  /// @return the cached chunks, or nullopt if there is no current result
+  std::optional<std::vector<RetrievedChunk>> find(const SemanticSpaceName& space_name, const ScopeId& scope_id,
+                                                  std::string_view query, const RetrievalConfig& config);
+
+  /// Caches a retrieval result, evicting least recently used results until it fits. Chunk embeddings aren't kept.
+  /// @param generation The scope's generation read before the retrieval started
+  void insert(const SemanticSpaceName& space_name, const ScopeId& scope_id, std::string_view query,
+              const RetrievalConfig& config, uint64_t generation, std::vector<RetrievedChunk> chunks);
+
+  /// Marks every cached result of a scope stale, called after documents are written to it.
+  void invalidate_scope(const SemanticSpaceName& space_name, const ScopeId& scope_id);
+
+  /// Marks every cached result of a space stale, called after the space is deleted.
+  void invalidate_space(const SemanticSpaceName& space_name);
+
+  /// Drops every cached result, called when model files change.
+  void clear();
+
+  RetrievalCacheStats stats() const;
+
+private:
+  struct Entry
+  {
+    uint64_t m_key{};
+    SemanticSpaceName m_spaceName;
+    uint64_t m_generation{};
+    uint64_t m_bytes{};
+    std::vector<RetrievedChunk> m_chunks;
+  };
+
+  static uint64_t make_key(const SemanticSpaceName& space_name, const ScopeId& scope_id, std::string_view query,
+                           const RetrievalConfig& config);
+
+  /// Generation of a scope, the sum of its own and its space's write counters so a bump of either changes it.
+  uint64_t generation_locked(const SemanticSpaceName& space_name, const ScopeId& scope_id) const;
+
+  void erase_locked(std::list<Entry>::iterator it);
+
+  uint64_t m_maxBytes;
+  /// Most recently used first
+  std::list<Entry> m_entries;
+  std::unordered_map<uint64_t, std::list<Entry>::iterator> m_index;
+  /// Write counters by space name, and by space name and scope id joined with a NUL
+  std::unordered_map<std::string, uint64_t> m_spaceGenerations;
+  std::unordered_map<std::string, uint64_t> m_scopeGenerations;
+  uint64_t m_bytes = 0;
+  uint64_t m_hits = 0;
+  uint64_t m_misses = 0;
+  uint64_t m_staleEntries = 0;
+  mutable std::mutex m_mutex;
+};
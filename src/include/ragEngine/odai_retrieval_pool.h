@@ -0,0 +1,98 @@
+#pragma once
+
+#include "backendEngine/odai_backend_engine.h"
+#include "db/odai_db.h"
+#include "types/odai_result.h"
+#include "types/odai_types.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/// Database connection and backend engine owned by one retrieval worker
+struct RetrievalWorkerResources
+{
+  std::unique_ptr<IOdaiDb> m_db;
+  std::unique_ptr<IOdaiBackendEngine> m_backendEngine;
+};
+
+/// Work run on a retrieval worker with the worker's own resources
+using RetrievalTask = std::function<OdaiResult<void>(RetrievalWorkerResources& resources)>;
+/// Opens and initializes a worker's database connection
+using RetrievalDbFactory = std::function<OdaiResult<std::unique_ptr<IOdaiDb>>()>;
+/// Creates and initializes a worker's backend engine
+using RetrievalBackendFactory = std::function<OdaiResult<std::unique_ptr<IOdaiBackendEngine>>()>;
+
+/// Threads searching semantic spaces next to the calling thread, for retrievals spanning spaces of several embedding
+/// models. Neither the database connection nor the backend engine is thread safe, so every worker creates its own on
+/// its first task. Tasks are routed by embedding model: a model runs on the worker it was first given to, so each
+/// worker's backend keeps its models loaded instead of swapping them with every request. New models are spread
+/// round-robin over up to max_workers workers.
+/// Workers start lazily and keep their resources until the pool is destroyed, a failed factory fails the task and is
+/// retried with the next one.
+class OdaiRetrievalPool
+{
+public:
+  /// @param max_workers Maximum number of worker threads, at least 1
+  /// @param db_factory Called on a worker thread to open its database connection
+  /// @param backend_factory Called on a worker thread to create its backend engine
+  OdaiRetrievalPool(size_t max_workers, RetrievalDbFactory db_factory, RetrievalBackendFactory backend_factory);
+
+  /// Stops the workers after their current task and joins them. Tasks still queued fail with NOT_INITIALIZED.
+  ~OdaiRetrievalPool();
+
+  OdaiRetrievalPool(const OdaiRetrievalPool&) = delete;
+  OdaiRetrievalPool& operator=(const OdaiRetrievalPool&) = delete;
+  OdaiRetrievalPool(OdaiRetrievalPool&&) = delete;
+  OdaiRetrievalPool& operator=(OdaiRetrievalPool&&) = delete;
+
+  /// Queues a task on the worker of an embedding model, starting a worker if the model has none yet.
+  /// @param model_name Embedding model the task embeds with, decides the worker
+  /// @param task The work, called on the worker thread
+  /// @return the task's result once it ran, or an unexpected OdaiResultEnum if the worker's resources couldn't be
+  /// created or the task threw
+  std::future<OdaiResult<void>> submit(const ModelName& model_name, RetrievalTask task);
+
+  /// Makes every worker reopen its database connection before its next task. A connection's HNSW graphs only pick
+  /// up added vectors, a write that removed vectors through another connection leaves them stale.
+  void reopen_databases();
+
+  /// @return number of workers started so far
+  size_t worker_count() const;
+
+private:
+  struct PendingTask
+  {
+    RetrievalTask m_task;
+    std::promise<OdaiResult<void>> m_promise;
+  };
+
+  struct Worker
+  {
+    std::deque<PendingTask> m_queue;
+    bool m_reopenDb = false;
+    std::thread m_thread;
+  };
+
+  void run(Worker& worker);
+
+  /// Creates the resources the worker doesn't have yet, then runs the task.
+  OdaiResult<void> run_task(RetrievalTask& task, RetrievalWorkerResources& resources);
+
+  size_t m_maxWorkers;
+  RetrievalDbFactory m_dbFactory;
+  RetrievalBackendFactory m_backendFactory;
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_wakeup;
+  bool m_stopping = false;
+  std::vector<std::unique_ptr<Worker>> m_workers;
+  std::unordered_map<ModelName, size_t> m_workerByModel;
+};
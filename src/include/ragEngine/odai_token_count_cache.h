@@ -0,0 +1,74 @@
+#pragma once
+
+#include "types/odai_result.h"
+#include "types/odai_types.h"
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/// Counts the LLM tokens of texts, see IOdaiBackendEngine::count_llm_tokens().
+/// Returns one count per text, in the same order as the texts.
+using TokenCountFn = std::function<OdaiResult<std::vector<uint32_t>>(const std::vector<std::string>& texts)>;
+
+/// Bounded LRU memo of LLM token counts, keyed by the LLM's checksums and a 64-bit hash of the counted text.
+/// Retrieved chunks come back across requests, so each chunk text is tokenized once per model instead of on every
+/// request that packs it into a prompt.
+/// Thread safe.
+class OdaiTokenCountCache
+{
+public:
+  /// @param capacity Maximum number of cached counts, 0 disables caching
+  explicit OdaiTokenCountCache(size_t capacity);
+
+  /// Counts the tokens of texts, the ones missing from the cache with a single count_fn call whose counts are cached.
+  /// @param model_name Name of the LLM, used by invalidate_model()
+  /// @param model_checksums Checksums of the LLM's files, as stored when the model was registered
+  /// @param texts The texts to count
+  /// @param count_fn Counts the texts missing from the cache, not called when every text is cached
+  /// @return token count of each text in the same order as texts, or an unexpected OdaiResultEnum if counting failed
+  OdaiResult<std::vector<uint32_t>> count(const ModelName& model_name, const std::string& model_checksums,
+                                          const std::vector<std::string>& texts, const TokenCountFn& count_fn);
+
+  /// Drops every count made with a model, called when the model's files change.
+  void invalidate_model(const ModelName& model_name);
+
+  TokenCountCacheStats stats() const;
+
+private:
+  struct Key
+  {
+    uint64_t m_modelHash{};
+    uint64_t m_textHash{};
+
+    bool operator==(const Key&) const = default;
+  };
+
+  struct KeyHash
+  {
+    size_t operator()(const Key& key) const { return static_cast<size_t>(key.m_modelHash ^ (key.m_textHash * 31)); }
+  };
+
+  struct Entry
+  {
+    Key m_key;
+    ModelName m_modelName;
+    uint32_t m_tokenCount{};
+  };
+
+  /// Caches a count, evicting the least recently used one when full. Requires m_mutex to be held.
+  void insert_locked(const Key& key, const ModelName& model_name, uint32_t token_count);
+
+  size_t m_capacity;
+  /// Most recently used first
+  std::list<Entry> m_entries;
+  std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> m_index;
+  uint64_t m_hits = 0;
+  uint64_t m_misses = 0;
+  mutable std::mutex m_mutex;
+};
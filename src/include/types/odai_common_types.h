@@ -45,12 +45,33 @@ typedef uint8_t c_BackendDeviceType;
 /// Strategy for Chunking
 typedef uint8_t ChunkingStrategy;
 #define FIXED_SIZE_CHUNKING (ChunkingStrategy)0
+#define BOUNDARY_AWARE_CHUNKING (ChunkingStrategy)1
+#define TOKEN_AWARE_CHUNKING (ChunkingStrategy)2
 
 /// Search Type for Retrieval
 typedef uint8_t SearchType;
 #define SEARCH_TYPE_VECTOR_ONLY (SearchType)0
 #define SEARCH_TYPE_KEYWORD_ONLY (SearchType)1
 #define SEARCH_TYPE_HYBRID (SearchType)2
+#define SEARCH_TYPE_MMR (SearchType)3
+
+/// How the rankings of several semantic spaces searched for one query are merged
+typedef uint8_t SpaceMergeType;
+/// Reciprocal rank fusion, only the positions in each space's ranking count
+#define SPACE_MERGE_RRF (SpaceMergeType)0
+/// Scores min-max normalized within each space's ranking, then compared across spaces
+#define SPACE_MERGE_NORMALIZED_SCORE (SpaceMergeType)1
+
+/// Vector index used to search a semantic space
+typedef uint8_t VectorIndexType;
+#define VECTOR_INDEX_FLAT (VectorIndexType)0
+#define VECTOR_INDEX_HNSW (VectorIndexType)1
+
+/// Encoding of the vectors a semantic space's flat search scans
+typedef uint8_t VectorStorageType;
+#define VECTOR_STORAGE_FLOAT32 (VectorStorageType)0
+#define VECTOR_STORAGE_INT8 (VectorStorageType)1
+#define VECTOR_STORAGE_BINARY (VectorStorageType)2
 
 /// RAG Mode
 typedef uint8_t RagMode;
@@ -60,13 +81,67 @@ typedef uint8_t RagMode;
 
 constexpr uint32_t DEFAULT_CHUNKING_SIZE = 512;
 constexpr uint32_t DEFAULT_CHUNKING_OVERLAP = 50;
+constexpr uint32_t DEFAULT_CHUNKING_BOUNDARY_TOLERANCE = 128;
+constexpr uint32_t DEFAULT_TOKEN_CHUNKING_SIZE = 256;
+constexpr uint32_t DEFAULT_TOKEN_CHUNKING_OVERLAP = 32;
+
+constexpr uint32_t DEFAULT_HNSW_MAX_CONNECTIONS = 16;
+constexpr uint32_t DEFAULT_HNSW_EF_CONSTRUCTION = 200;
+constexpr uint32_t DEFAULT_HNSW_EF_SEARCH = 64;
+/// Upper bound of HNSW links per node, keeps the fixed size link lists of the index file small
+constexpr uint32_t MAX_HNSW_MAX_CONNECTIONS = 128;
+/// Quantized candidates scanned per requested result before rescoring them with float vectors
+constexpr uint32_t DEFAULT_QUANTIZED_RESCORE_OVERSAMPLE = 4;
+/// Filterable metadata fields a semantic space may declare, sqlite-vec allows 16 metadata columns per vector table
+constexpr uint32_t MAX_FILTER_FIELDS = 16;
+
+/// Stages of the bulk ingestion pipeline, in pipeline order
+typedef uint8_t IngestStage;
+#define INGEST_STAGE_READ (IngestStage)0
+#define INGEST_STAGE_CHUNK (IngestStage)1
+#define INGEST_STAGE_DEDUPE (IngestStage)2
+#define INGEST_STAGE_EMBED (IngestStage)3
+#define INGEST_STAGE_WRITE (IngestStage)4
+#define INGEST_STAGE_COUNT 5
+
+constexpr uint32_t DEFAULT_INGEST_READER_THREADS = 2;
+constexpr uint32_t DEFAULT_INGEST_QUEUE_CAPACITY = 32;
+constexpr uint32_t DEFAULT_INGEST_EMBEDDING_BATCH_SIZE = 64;
+constexpr uint32_t DEFAULT_INGEST_WRITE_BATCH_SIZE = 16;
+
+constexpr uint32_t DEFAULT_REEMBED_BATCH_SIZE = 64;
+/// Fraction of wall time a background re-embedding job spends embedding, the rest is left to interactive requests
+constexpr float DEFAULT_REEMBED_MAX_CPU_SHARE = 0.25F;
 
 constexpr uint32_t DEFAULT_MAX_TOKENS = 4096;
 constexpr float DEFAULT_TOP_P = 0.95F;
 constexpr uint32_t DEFAULT_TOP_K = 40;
 constexpr uint32_t DEFAULT_LLM_CONTEXT_WINDOW = 2048;
 constexpr uint32_t DEFAULT_EMBEDDING_CONTEXT_WINDOW = 512;
+/// Tokens of the embedding context window kept free for the special tokens (e.g. CLS / SEP) wrapped around each text
+constexpr uint32_t EMBEDDING_SPECIAL_TOKENS_RESERVE = 4;
+/// Tokens of one query and candidate pair scored by a reranker, longer candidates are truncated
+constexpr uint32_t DEFAULT_RERANKER_CONTEXT_WINDOW = 512;
+/// How much a candidate's reranker score is assumed to exceed its first stage score at most
+constexpr float DEFAULT_RERANK_EARLY_STOP_MARGIN = 0.25F;
+constexpr uint32_t DEFAULT_RERANK_TIME_BUDGET_MS = 2000;
+/// Weight of relevance against diversity in maximal marginal relevance, 1.0 ignores diversity
+constexpr float DEFAULT_MMR_LAMBDA = 0.5F;
+/// Query embeddings kept by the RAG engine, so repeated retrieval queries skip the embedding model
+constexpr uint32_t QUERY_EMBEDDING_CACHE_CAPACITY = 256;
+/// LLM token counts of texts kept by the RAG engine, so retrieved chunks are tokenized once per model
+constexpr uint32_t TOKEN_COUNT_CACHE_CAPACITY = 8192;
+/// Tokens of the LLM context window retrieved chunks never take, left for the response to start in
+constexpr uint32_t RAG_RESPONSE_TOKEN_RESERVE = 256;
+/// Semantic spaces one generation call may retrieve from
+constexpr uint32_t MAX_RAG_SEMANTIC_SPACES = 8;
+/// Worker threads searching semantic spaces of other embedding models next to the calling thread, each keeps its own
+/// database connection and backend engine with the models of its spaces loaded
+constexpr uint32_t MAX_RETRIEVAL_WORKERS = 3;
 
 constexpr uint64_t BYTES_PER_KB = 1024ULL;
 constexpr uint64_t BYTES_PER_MB = 1024ULL * BYTES_PER_KB;
 constexpr uint64_t BYTES_PER_GB = 1024ULL * BYTES_PER_MB;
+
+/// Memory the RAG engine's retrieval result cache may hold, so repeated questions skip retrieval entirely
+constexpr uint64_t RETRIEVAL_CACHE_MAX_BYTES = 4ULL * BYTES_PER_MB;
@@ -22,6 +22,7 @@ typedef char* c_ModelName;
 typedef uint32_t c_ModelType;
 #define ODAI_MODEL_TYPE_EMBEDDING (c_ModelType)0
 #define ODAI_MODEL_TYPE_LLM (c_ModelType)1
+#define ODAI_MODEL_TYPE_RERANKER (c_ModelType)2
 
 /// Flags for updating model registration details
 typedef uint32_t c_UpdateModelFlag;
@@ -167,6 +168,24 @@ struct c_FixedSizeChunkingConfig
   uint32_t m_chunkOverlap;
 };
 
+/// C-style configuration for Boundary Aware Chunking Strategy
+struct c_BoundaryAwareChunkingConfig
+{
+  uint32_t m_chunkSize;
+  uint32_t m_chunkOverlap;
+  /// Maximum number of bytes a chunk edge may move to land on a paragraph, line, sentence or word boundary
+  uint32_t m_boundaryTolerance;
+};
+
+/// C-style configuration for Token Aware Chunking Strategy
+struct c_TokenAwareChunkingConfig
+{
+  /// Chunk size in embedding model tokens
+  uint32_t m_chunkSize;
+  /// Tokens shared by consecutive chunks
+  uint32_t m_chunkOverlap;
+};
+
 /// C-style configuration for Chunking Strategy
 struct c_ChunkingConfig
 {
@@ -174,6 +193,8 @@ struct c_ChunkingConfig
   union
   {
     struct c_FixedSizeChunkingConfig m_fixedSizeConfig;
+    struct c_BoundaryAwareChunkingConfig m_boundaryAwareConfig;
+    struct c_TokenAwareChunkingConfig m_tokenAwareConfig;
   } m_config;
 };
 
@@ -182,13 +203,37 @@ inline void free_members(c_ChunkingConfig* config)
   // No dynamic memory currently
 }
 
+/// C-style configuration of the vector index of a Semantic Space.
+struct c_VectorIndexConfig
+{
+  /// VECTOR_INDEX_FLAT (exact) or VECTOR_INDEX_HNSW (approximate nearest neighbour graph)
+  VectorIndexType m_indexType;
+  /// HNSW links per node (M), only used by VECTOR_INDEX_HNSW
+  uint32_t m_hnswMaxConnections;
+  /// HNSW candidate list size while inserting, only used by VECTOR_INDEX_HNSW
+  uint32_t m_hnswEfConstruction;
+  /// HNSW candidate list size while searching, only used by VECTOR_INDEX_HNSW
+  uint32_t m_hnswEfSearch;
+  /// VECTOR_STORAGE_FLOAT32, VECTOR_STORAGE_INT8 or VECTOR_STORAGE_BINARY (quantized flat scan, rescored with floats)
+  VectorStorageType m_storageType;
+  /// Quantized candidates per requested result rescored with floats, only used by quantized storage
+  uint32_t m_rescoreOversample;
+};
+
 /// C-style configuration structure for Semantic Space.
 struct c_SemanticSpaceConfig
 {
   c_SemanticSpaceName m_name;
   struct c_EmbeddingModelConfig m_embeddingModelConfig;
   struct c_ChunkingConfig m_chunkingConfig;
+  /// Dimension of the embeddings, 0 infers it from the embedding model when the space is created
   uint32_t m_dimensions;
+  struct c_VectorIndexConfig m_vectorIndexConfig;
+  /// Matryoshka truncation of stored and searched embeddings, 0 keeps full embeddings
+  uint32_t m_truncatedDimensions;
+  /// Document metadata fields searches can filter on, null if none
+  const char** m_filterFields;
+  uint32_t m_filterFieldsCount;
 };
 
 inline void free_members(c_SemanticSpaceConfig* config)
@@ -204,8 +249,131 @@ inline void free_members(c_SemanticSpaceConfig* config)
   }
   free_members(&config->m_embeddingModelConfig);
   free_members(&config->m_chunkingConfig);
+  if (config->m_filterFields != nullptr)
+  {
+    for (uint32_t i = 0; i < config->m_filterFieldsCount; ++i)
+    {
+      free(const_cast<char*>(config->m_filterFields[i]));
+    }
+    free(static_cast<void*>(config->m_filterFields));
+    config->m_filterFields = nullptr;
+    config->m_filterFieldsCount = 0;
+  }
 }
 
+/// Key-Value entry of a document's metadata
+struct c_MetadataEntry
+{
+  const char* m_key;
+  const char* m_value;
+};
+
+/// C-style description of a document to ingest in bulk.
+struct c_IngestDocumentSource
+{
+  /// Unique identifier for the document
+  c_DocumentId m_documentId;
+  /// Full file system path of the UTF-8 text file holding the document content
+  const char* m_filePath;
+  /// Metadata stored with the document, null if none
+  const struct c_MetadataEntry* m_metadata;
+  size_t m_metadataCount;
+};
+
+/// C-style configuration for bulk document ingestion. Zero values select the defaults.
+struct c_BulkIngestConfig
+{
+  /// Number of threads reading files
+  uint32_t m_readerThreads;
+  /// Number of threads chunking documents (0 = number of hardware threads)
+  uint32_t m_chunkerThreads;
+  /// Maximum number of documents waiting between two stages
+  uint32_t m_queueCapacity;
+  /// Maximum number of chunks embedded in one backend call
+  uint32_t m_embeddingBatchSize;
+  /// Maximum number of documents written in one transaction
+  uint32_t m_writeBatchSize;
+};
+
+/// C-style statistics of one bulk ingestion stage.
+struct c_IngestStageStats
+{
+  uint32_t m_workers;
+  uint64_t m_itemsProcessed;
+  double m_busySeconds;
+  double m_itemsPerSecond;
+  double m_utilization;
+  uint32_t m_maxQueueDepth;
+  double m_avgQueueDepth;
+};
+
+/// C-style statistics of a bulk ingestion call, m_stages is indexed by IngestStage.
+struct c_BulkIngestStats
+{
+  uint64_t m_documentsIngested;
+  uint64_t m_documentsFailed;
+  uint64_t m_chunksProcessed;
+  uint64_t m_chunksEmbedded;
+  double m_elapsedSeconds;
+  struct c_IngestStageStats m_stages[INGEST_STAGE_COUNT];
+};
+
+/// C-style configuration of a background re-embedding job. Zero values select the defaults.
+struct c_ReembedConfig
+{
+  /// Number of vectors embedded and written per batch
+  uint32_t m_batchSize;
+  /// Fraction of wall time the job may spend embedding, in (0, 1]
+  float m_maxCpuShare;
+};
+
+/// C-style progress of a background re-embedding job.
+struct c_ReembedProgress
+{
+  /// Vectors of the semantic space re-embedded so far
+  uint64_t m_vectorsDone;
+  /// Vectors of the semantic space, including the ones added since the job started
+  uint64_t m_vectorsTotal;
+};
+
+/// C-style counters of the SDK's caches. Hits and misses count lookups since the SDK was initialized, entries are the
+/// values cached now.
+struct c_CacheStats
+{
+  /// Query embeddings reused instead of running the embedding model
+  uint64_t m_queryEmbeddingHits;
+  uint64_t m_queryEmbeddingMisses;
+  uint64_t m_queryEmbeddingEntries;
+  /// Whole retrieval results reused instead of searching again
+  uint64_t m_retrievalHits;
+  /// Retrieval lookups without a usable result, including stale ones
+  uint64_t m_retrievalMisses;
+  /// Results dropped because their scope was written to after they were cached
+  uint64_t m_retrievalStaleEntries;
+  uint64_t m_retrievalEntries;
+  /// Estimated memory held by the cached retrieval results
+  uint64_t m_retrievalBytes;
+  /// LLM token counts of chunks and history messages reused instead of tokenizing again
+  uint64_t m_tokenCountHits;
+  uint64_t m_tokenCountMisses;
+  uint64_t m_tokenCountEntries;
+};
+
+/// C-style configuration structure for reranker models.
+struct c_RerankerModelConfig
+{
+  /// Name of the reranker model (must be registered).
+  c_ModelName m_modelName;
+};
+
+/// C-style condition of a metadata filter, matching documents whose value of m_field is one of m_values.
+struct c_MetadataFilterCondition
+{
+  const char* m_field;
+  const char* const* m_values;
+  size_t m_valuesCount;
+};
+
 /// C-style configuration structure for Retrieval system.
 /// Used for C API compatibility.
 struct c_RetrievalConfig
@@ -215,7 +383,21 @@ struct c_RetrievalConfig
   float m_scoreThreshold;
   SearchType m_searchType;
   bool m_useReranker;
+  /// Neighbouring chunks added on each side of a retrieved chunk, 0 keeps retrieved chunks alone
   uint32_t m_contextWindow;
+  /// Reranker scoring the candidates, only used with m_useReranker
+  struct c_RerankerModelConfig m_rerankerModelConfig;
+  /// Reranking early stop margin, 0 selects the default
+  float m_rerankEarlyStopMargin;
+  /// Reranking time budget in milliseconds, 0 selects the default
+  uint32_t m_rerankTimeBudgetMs;
+  /// Relevance weight of MMR search (0.0 to 1.0), 0 selects the default
+  float m_mmrLambda;
+  /// Documents picked by their document vectors before searching their chunks, 0 searches every chunk
+  uint32_t m_documentLimit;
+  /// Conditions the searched documents must all match, null if none
+  const struct c_MetadataFilterCondition* m_metadataFilter;
+  size_t m_metadataFilterCount;
 };
 
 /// C-style configuration for RAG Generation (Runtime/Generator use)
@@ -224,6 +406,13 @@ struct c_GeneratorRagConfig
   struct c_RetrievalConfig m_retrievalConfig;
   c_SemanticSpaceName m_semanticSpaceName;
   c_ScopeId m_scopeId;
+  /// LLM tokens the retrieved chunks may take in the prompt, 0 lets them fill the room the context window leaves
+  uint32_t m_contextTokenBudget;
+  /// Further semantic spaces searched in the same scope, may be NULL when m_additionalSemanticSpaceNamesCount is 0
+  const c_SemanticSpaceName* m_additionalSemanticSpaceNames;
+  size_t m_additionalSemanticSpaceNamesCount;
+  /// How the rankings of the searched spaces are merged (SPACE_MERGE_*)
+  SpaceMergeType m_spaceMergeType;
 };
 
 /// C-style configuration structure for Sampler (LLM generation parameters).
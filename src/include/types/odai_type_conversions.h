@@ -23,6 +23,11 @@ InputItemType to_cpp_input_item_type(c_InputItemType c);
 /// Converts a C-style ModelFiles to C++ style
 ModelFiles to_cpp(const c_ModelFiles& c);
 
+/// Converts C-style document metadata entries to C++ DocumentMetadata, a repeated key keeps its last value
+/// @param entries The entries, may be null if count is 0
+/// @param count Number of entries
+DocumentMetadata to_cpp_document_metadata(const c_MetadataEntry* entries, size_t count);
+
 /// Converts a C-style input item to C++ style
 InputItem to_cpp(const c_InputItem& c);
 
@@ -47,6 +52,11 @@ BackendEngineConfig to_cpp(const c_BackendEngineConfig& c);
 /// @return C++ EmbeddingModelConfig with the converted configuration
 EmbeddingModelConfig to_cpp(const c_EmbeddingModelConfig& c);
 
+/// Converts a C-style reranker model configuration to C++ style.
+/// @param c C-style reranker model configuration to convert, its model name may be null when no reranker is used
+/// @return C++ RerankerModelConfig with the converted configuration
+RerankerModelConfig to_cpp(const c_RerankerModelConfig& c);
+
 /// Converts a C-style language model configuration to C++ style.
 /// Creates a new C++ LLMModelConfig by copying the model path from the C
 /// struct.
@@ -59,6 +69,11 @@ LLMModelConfig to_cpp(const c_LlmModelConfig& c);
 /// @return C++ ChunkingConfig with the converted configuration
 ChunkingConfig to_cpp(const c_ChunkingConfig& c);
 
+/// Converts a C-style vector index configuration to C++ style.
+/// @param c C-style vector index configuration to convert
+/// @return C++ VectorIndexConfig with the converted configuration
+VectorIndexConfig to_cpp(const c_VectorIndexConfig& c);
+
 /// Converts a C-style semantic space configuration to C++ style.
 /// @param c C-style semantic space configuration to convert
 /// @return C++ SemanticSpaceConfig with the converted configuration
@@ -90,6 +105,23 @@ GeneratorConfig to_cpp(const c_GeneratorConfig& source);
 /// @return C++ ChatConfig with the converted configuration
 ChatConfig to_cpp(const c_ChatConfig& c);
 
+/// Converts a C-style bulk ingestion document source to C++ style.
+/// @param c C-style document source to convert
+/// @return C++ IngestDocumentSource with the converted source
+IngestDocumentSource to_cpp(const c_IngestDocumentSource& c);
+
+/// Converts a C-style bulk ingestion configuration to C++ style.
+/// Zero valued fields (other than m_chunkerThreads) are replaced by their defaults.
+/// @param c C-style bulk ingestion configuration to convert
+/// @return C++ BulkIngestConfig with the converted configuration
+BulkIngestConfig to_cpp(const c_BulkIngestConfig& c);
+
+/// Converts a C-style re-embedding job configuration to C++ style.
+/// Zero valued fields are replaced by their defaults.
+/// @param c C-style re-embedding job configuration to convert
+/// @return C++ ReembedConfig with the converted configuration
+ReembedConfig to_cpp(const c_ReembedConfig& c);
+
 /// Converts a C++ EmbeddingModelConfig to C-style c_EmbeddingModelConfig.
 /// Allocates memory for string fields that must be freed by the caller.
 c_EmbeddingModelConfig to_c(const EmbeddingModelConfig& cpp);
@@ -103,10 +135,22 @@ c_InputItem to_c(const InputItem& cpp);
 /// Converts a C++ ChunkingConfig to C-style c_ChunkingConfig.
 c_ChunkingConfig to_c(const ChunkingConfig& cpp);
 
+/// Converts a C++ VectorIndexConfig to C-style c_VectorIndexConfig.
+c_VectorIndexConfig to_c(const VectorIndexConfig& cpp);
+
 /// Converts a C++ SemanticSpaceConfig to C-style c_SemanticSpaceConfig.
 /// Allocates memory for string fields that must be freed by the caller.
 c_SemanticSpaceConfig to_c(const SemanticSpaceConfig& cpp);
 
+/// Converts C++ BulkIngestStats to C-style c_BulkIngestStats.
+c_BulkIngestStats to_c(const BulkIngestStats& cpp);
+
+/// Converts the progress of a C++ ReembedJob to C-style c_ReembedProgress.
+c_ReembedProgress to_c(const ReembedJob& cpp);
+
+/// Converts C++ CacheStats to C-style c_CacheStats.
+c_CacheStats to_c(const CacheStats& cpp);
+
 /// Converts a C++ ChatMessage to C-style c_ChatMessage.
 /// Allocates memory for content and message_metadata strings that must be freed
 /// by the caller.
@@ -122,12 +166,21 @@ std::string byte_vector_to_string(const std::vector<uint8_t>& bytes);
 NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(LLMModelConfig, m_modelName, m_contextWindow)
 NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(EmbeddingModelConfig, m_modelName)
 NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(FixedSizeChunkingConfig, m_chunkSize, m_chunkOverlap)
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(BoundaryAwareChunkingConfig, m_chunkSize, m_chunkOverlap, m_boundaryTolerance)
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TokenAwareChunkingConfig, m_chunkSize, m_chunkOverlap)
 
 void to_json(nlohmann::json& j, const ChunkingConfig& p);
 void from_json(const nlohmann::json& j, ChunkingConfig& p);
 
 NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(InputItem, m_type, m_data, m_mimeType)
-NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(SemanticSpaceConfig, m_name, m_embeddingModelConfig, m_chunkingConfig, m_dimensions)
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(VectorIndexConfig, m_indexType, m_hnswMaxConnections,
+                                                m_hnswEfConstruction, m_hnswEfSearch, m_storageType,
+                                                m_rescoreOversample)
+// with defaults so spaces stored before the vector index config existed load as flat spaces
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(SemanticSpaceConfig, m_name, m_embeddingModelConfig, m_chunkingConfig,
+                                                m_dimensions, m_vectorIndexConfig, m_truncatedDimensions,
+                                                m_filterFields)
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(ReembedConfig, m_batchSize, m_maxCpuShare)
 NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(ChatConfig, m_persistence, m_systemPrompt, m_llmModelConfig)
 NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(BackendEngineConfig, m_engineType, m_preferredDeviceType)
 NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(ModelFiles, m_modelType, m_engineType, m_entries)
@@ -3,7 +3,10 @@
 #include "odai_ctypes.h"
 #include "types/odai_common_types.h"
 #include "utils/string_utils.h"
+#include <array>
+#include <algorithm>
 #include <cstdint>
+#include <map>
 #include <nlohmann/json.hpp>
 #include <optional>
 #include <string>
@@ -30,10 +33,18 @@ typedef std::string SemanticSpaceName;
 /// Strong type for model names.
 typedef std::string ModelName;
 
+/// Token id in a model's vocabulary.
+typedef int32_t TokenId;
+
+/// App-defined metadata of a document, field name to value.
+typedef std::map<std::string, std::string> DocumentMetadata;
+
 enum ModelType : std::uint8_t
 {
   EMBEDDING = 0,
-  LLM = 1
+  LLM = 1,
+  /// Cross-encoder scoring how relevant a text is to a query
+  RERANKER = 2
 };
 
 enum UpdateModelFlag : std::uint8_t
@@ -195,6 +206,18 @@ struct StreamingStats
 {
   int32_t m_generatedTokens{};
   bool m_wasCancelled{};
+  /// Seconds spent retrieving RAG context (query embedding, search and reranking), 0 when no context was retrieved
+  double m_retrievalSeconds{};
+  /// Seconds of m_retrievalSeconds spent reranking candidates, 0 when the reranker wasn't used
+  double m_rerankSeconds{};
+  /// Number of candidates scored by the reranker
+  uint32_t m_rerankedCandidates{};
+  /// Seconds spent generating the response, excluding retrieval
+  double m_generationSeconds{};
+  /// Number of retrieved chunks injected into the prompt
+  uint32_t m_retrievedChunks{};
+  /// LLM tokens taken by the injected chunks, without the context header
+  uint32_t m_contextTokens{};
 };
 
 /// Configuration structure for backend engine (LLM runtime).
@@ -222,6 +245,16 @@ struct EmbeddingModelConfig
   bool is_sane() const { return !m_modelName.empty(); }
 };
 
+/// Configuration structure for reranker (cross-encoder) models.
+struct RerankerModelConfig
+{
+  /// Name of the reranker model to use (must be registered via
+  /// odai_register_model_files with the RERANKER model type).
+  ModelName m_modelName;
+
+  bool is_sane() const { return !m_modelName.empty(); }
+};
+
 /// Configuration structure for language models (LLMs).
 struct LLMModelConfig
 {
@@ -257,11 +290,60 @@ struct FixedSizeChunkingConfig
   }
 };
 
+/// Configuration for Boundary Aware Chunking Strategy
+/// Like fixed size chunking, but each chunk edge may move back by up to m_boundaryTolerance bytes to land on the
+/// nearest paragraph, line, sentence or word boundary (in that order of preference).
+struct BoundaryAwareChunkingConfig
+{
+  uint32_t m_chunkSize = DEFAULT_CHUNKING_SIZE;
+  uint32_t m_chunkOverlap = DEFAULT_CHUNKING_OVERLAP;
+  uint32_t m_boundaryTolerance = DEFAULT_CHUNKING_BOUNDARY_TOLERANCE;
+
+  bool is_sane() const
+  {
+    if (m_chunkSize == 0)
+    {
+      return false;
+    }
+    if (m_chunkOverlap >= m_chunkSize)
+    {
+      return false;
+    }
+    if (m_boundaryTolerance >= m_chunkSize)
+    {
+      return false;
+    }
+    return true;
+  }
+};
+
+/// Configuration for Token Aware Chunking Strategy
+/// Sizes are measured in tokens of the semantic space's embedding model, so every chunk fits the embedding context
+/// window. Chunks are cut between words.
+struct TokenAwareChunkingConfig
+{
+  uint32_t m_chunkSize = DEFAULT_TOKEN_CHUNKING_SIZE;
+  uint32_t m_chunkOverlap = DEFAULT_TOKEN_CHUNKING_OVERLAP;
+
+  bool is_sane() const
+  {
+    if (m_chunkSize == 0 || m_chunkSize > DEFAULT_EMBEDDING_CONTEXT_WINDOW - EMBEDDING_SPECIAL_TOKENS_RESERVE)
+    {
+      return false;
+    }
+    if (m_chunkOverlap >= m_chunkSize)
+    {
+      return false;
+    }
+    return true;
+  }
+};
+
 /// Configuration for Chunking Strategy
 /// Contains the strategy type and union of specific configuration parameters.
 struct ChunkingConfig
 {
-  std::variant<FixedSizeChunkingConfig> m_config;
+  std::variant<FixedSizeChunkingConfig, BoundaryAwareChunkingConfig, TokenAwareChunkingConfig> m_config;
 
   bool is_sane() const
   {
@@ -270,6 +352,16 @@ struct ChunkingConfig
       const auto& conf = std::get<FixedSizeChunkingConfig>(m_config);
       return conf.is_sane();
     }
+    if (std::holds_alternative<BoundaryAwareChunkingConfig>(m_config))
+    {
+      const auto& conf = std::get<BoundaryAwareChunkingConfig>(m_config);
+      return conf.is_sane();
+    }
+    if (std::holds_alternative<TokenAwareChunkingConfig>(m_config))
+    {
+      const auto& conf = std::get<TokenAwareChunkingConfig>(m_config);
+      return conf.is_sane();
+    }
 
     return false;
   }
@@ -277,14 +369,67 @@ struct ChunkingConfig
   ChunkingConfig() { m_config = FixedSizeChunkingConfig(); }
 };
 
+/// Configuration of the vector index a semantic space is searched with.
+struct VectorIndexConfig
+{
+  /// VECTOR_INDEX_FLAT compares the query with every vector of the scope (exact), VECTOR_INDEX_HNSW walks an
+  /// approximate nearest neighbour graph kept alongside the stored vectors (sub-linear, for large scopes)
+  VectorIndexType m_indexType = VECTOR_INDEX_FLAT;
+  /// HNSW links per node on upper layers (M), layer 0 keeps twice as many
+  uint32_t m_hnswMaxConnections = DEFAULT_HNSW_MAX_CONNECTIONS;
+  /// HNSW candidate list size while inserting, higher builds a better graph more slowly
+  uint32_t m_hnswEfConstruction = DEFAULT_HNSW_EF_CONSTRUCTION;
+  /// HNSW candidate list size while searching, higher trades latency for recall
+  uint32_t m_hnswEfSearch = DEFAULT_HNSW_EF_SEARCH;
+  /// VECTOR_STORAGE_INT8 or VECTOR_STORAGE_BINARY also store a quantized copy of each vector, which the flat search
+  /// scans before rescoring the best candidates with the float vectors. The HNSW graph always searches float vectors.
+  VectorStorageType m_storageType = VECTOR_STORAGE_FLOAT32;
+  /// Quantized storage only: candidates taken from the quantized scan per requested result, higher trades latency for
+  /// recall
+  uint32_t m_rescoreOversample = DEFAULT_QUANTIZED_RESCORE_OVERSAMPLE;
+
+  bool is_sane() const
+  {
+    if (m_storageType > VECTOR_STORAGE_BINARY ||
+        (m_storageType != VECTOR_STORAGE_FLOAT32 && m_rescoreOversample == 0))
+    {
+      return false;
+    }
+    if (m_indexType == VECTOR_INDEX_FLAT)
+    {
+      return true;
+    }
+    if (m_indexType != VECTOR_INDEX_HNSW)
+    {
+      return false;
+    }
+    return m_hnswMaxConnections >= 2 && m_hnswMaxConnections <= MAX_HNSW_MAX_CONNECTIONS &&
+           m_hnswEfConstruction >= m_hnswMaxConnections && m_hnswEfSearch > 0;
+  }
+
+  bool operator==(const VectorIndexConfig&) const = default;
+};
+
 /// Configuration structure for Semantic Space.
-/// Defines the Embedding Model, Chunking Strategy, and Embedding Dimensions.
+/// Defines the Embedding Model, Chunking Strategy, Embedding Dimensions and Vector Index.
 struct SemanticSpaceConfig
 {
   SemanticSpaceName m_name;
   EmbeddingModelConfig m_embeddingModelConfig;
   ChunkingConfig m_chunkingConfig;
+  /// Dimension of the embeddings, 0 infers it from the embedding model when the space is created
   uint32_t m_dimensions{};
+  VectorIndexConfig m_vectorIndexConfig{};
+  /// Matryoshka truncation: embeddings are cut to their first m_truncatedDimensions components and renormalized before
+  /// being stored or searched. Only for models trained for it, 0 stores full embeddings.
+  uint32_t m_truncatedDimensions{};
+  /// Document metadata fields searches can filter on. Their values are stored next to each vector so a filter narrows
+  /// the vector scan itself. Names are identifiers (letters, digits and '_', not starting with a digit), at most
+  /// MAX_FILTER_FIELDS, fixed once the space is created.
+  std::vector<std::string> m_filterFields;
+
+  /// @return dimension of the vectors the space stores, 0 while unknown
+  uint32_t stored_dimensions() const { return m_truncatedDimensions != 0 ? m_truncatedDimensions : m_dimensions; }
 
   bool is_sane() const
   {
@@ -300,12 +445,260 @@ struct SemanticSpaceConfig
     {
       return false;
     }
+    if (!m_vectorIndexConfig.is_sane())
+    {
+      return false;
+    }
     // dimensions == 0 means auto-infer from model
+    if (m_dimensions != 0 && m_truncatedDimensions > m_dimensions)
+    {
+      return false;
+    }
+    if (m_filterFields.size() > MAX_FILTER_FIELDS)
+    {
+      return false;
+    }
+    // field names become column names of the vector tables
+    const auto is_identifier_char = [](char c)
+    { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_'; };
+    for (size_t i = 0; i < m_filterFields.size(); ++i)
+    {
+      const std::string& field = m_filterFields[i];
+      if (field.empty() || (field[0] >= '0' && field[0] <= '9') ||
+          !std::all_of(field.begin(), field.end(), is_identifier_char))
+      {
+        return false;
+      }
+      if (std::find(m_filterFields.begin(), m_filterFields.begin() + static_cast<std::ptrdiff_t>(i), field) !=
+          m_filterFields.begin() + static_cast<std::ptrdiff_t>(i))
+      {
+        return false;
+      }
+    }
 
     return true;
   }
 };
 
+/// A single chunk of document content produced by a chunking strategy, ready for ingestion.
+struct DocumentChunk
+{
+  /// The chunk text content
+  std::string m_contentText;
+  /// XXH3 64-bit hash of m_contentText, used to deduplicate chunks across documents
+  uint64_t m_contentHash{};
+  /// Position of the chunk inside its document (0-indexed)
+  uint32_t m_sequenceIndex{};
+  /// Embedding of the chunk. Left empty when the semantic space already holds an embedding for this content.
+  std::vector<float> m_embedding;
+  /// Number of embedding model tokens in the chunk, 0 when the chunking strategy didn't tokenize it
+  uint32_t m_tokenCount{};
+  /// Embedding model token ids of the chunk, without special tokens. Only filled by token aware chunking, the backend
+  /// embeds them directly so the chunk text isn't tokenized a second time.
+  std::vector<TokenId> m_tokenIds;
+};
+
+/// A chunk retrieved from a semantic space as context for a query.
+struct RetrievedChunk
+{
+  /// A document of the searched scope containing the chunk
+  DocumentId m_documentId;
+  /// Source uri of that document
+  std::string m_sourceUri;
+  /// Position of the chunk inside that document, the first position when context expansion joined several chunks
+  uint32_t m_sequenceIndex{};
+  /// Number of consecutive chunks of the document joined into m_contentText, see RetrievalConfig::m_contextWindow
+  uint32_t m_sequenceCount = 1;
+  std::string m_contentText;
+  /// Relevance of the chunk between 0.0 and 1.0, higher is more relevant. Its meaning depends on the search:
+  ///  - vector search: cosine similarity between the query and the chunk, 1.0 for identical directions
+  ///  - keyword search: BM25 score b mapped to b / (1 + b), comparable only between results of one query
+  ///  - hybrid search: reciprocal rank fusion score, 1.0 if the chunk ranked first in both searches
+  ///  - reranked: the reranker's relevance probability
+  float m_score{};
+  /// Stored embedding of the chunk, only filled by vector searches asked to include embeddings
+  std::vector<float> m_embedding;
+};
+
+/// Consecutive chunks of a document, read back to expand retrieved chunks with their neighbours.
+struct DocumentChunkSpan
+{
+  DocumentId m_documentId;
+  /// Position of the first chunk of the span
+  uint32_t m_firstSequenceIndex{};
+  /// Position of the last chunk of the span, inclusive
+  uint32_t m_lastSequenceIndex{};
+};
+
+/// A document to ingest through the bulk ingestion pipeline.
+struct IngestDocumentSource
+{
+  /// Unique identifier for the document
+  DocumentId m_documentId;
+  /// Path of the UTF-8 text file holding the document content
+  std::string m_filePath;
+  /// Metadata stored with the document, see SemanticSpaceConfig::m_filterFields
+  DocumentMetadata m_metadata;
+
+  bool is_sane() const { return !m_documentId.empty() && !m_filePath.empty(); }
+};
+
+/// Configuration for the bulk ingestion pipeline.
+/// Controls the worker count of the parallel stages and the bounds of the queues between stages.
+struct BulkIngestConfig
+{
+  /// Number of threads reading files
+  uint32_t m_readerThreads = DEFAULT_INGEST_READER_THREADS;
+  /// Number of threads chunking documents (0 = number of hardware threads)
+  uint32_t m_chunkerThreads{};
+  /// Maximum number of documents waiting between two stages, bounds the memory of the pipeline
+  uint32_t m_queueCapacity = DEFAULT_INGEST_QUEUE_CAPACITY;
+  /// Maximum number of chunks embedded in one backend call
+  uint32_t m_embeddingBatchSize = DEFAULT_INGEST_EMBEDDING_BATCH_SIZE;
+  /// Maximum number of documents written in one transaction
+  uint32_t m_writeBatchSize = DEFAULT_INGEST_WRITE_BATCH_SIZE;
+
+  bool is_sane() const
+  {
+    return m_readerThreads > 0 && m_queueCapacity > 0 && m_embeddingBatchSize > 0 && m_writeBatchSize > 0;
+  }
+};
+
+/// Statistics of one stage of the bulk ingestion pipeline.
+/// The stage with utilization close to 1 and a full input queue is the bottleneck.
+struct IngestStageStats
+{
+  /// Number of worker threads of the stage
+  uint32_t m_workers{};
+  /// Documents handled by the stage (chunks for the embed stage)
+  uint64_t m_itemsProcessed{};
+  /// Time spent working summed over all workers, excluding time blocked on queues
+  double m_busySeconds{};
+  /// Items processed per second of pipeline wall time
+  double m_itemsPerSecond{};
+  /// Fraction of the available worker time spent working (m_busySeconds / (m_workers * elapsed))
+  double m_utilization{};
+  /// Maximum number of documents observed waiting in the input queue of the stage
+  uint32_t m_maxQueueDepth{};
+  /// Average number of documents waiting in the input queue of the stage, sampled on each push
+  double m_avgQueueDepth{};
+};
+
+/// Summary of a bulk ingestion call.
+struct BulkIngestStats
+{
+  uint64_t m_documentsIngested{};
+  uint64_t m_documentsFailed{};
+  uint64_t m_chunksProcessed{};
+  uint64_t m_chunksEmbedded{};
+  double m_elapsedSeconds{};
+  /// Per stage statistics, indexed by IngestStage
+  std::array<IngestStageStats, INGEST_STAGE_COUNT> m_stages{};
+};
+
+/// Configuration of a background re-embedding job, see OdaiRagEngine::start_reembedding().
+struct ReembedConfig
+{
+  /// Number of vectors embedded and written per batch, the job's progress is persisted after each batch
+  uint32_t m_batchSize = DEFAULT_REEMBED_BATCH_SIZE;
+  /// Fraction of wall time the job may spend embedding, in (0, 1]. The job sleeps between batches to stay under it.
+  float m_maxCpuShare = DEFAULT_REEMBED_MAX_CPU_SHARE;
+
+  bool is_sane() const { return m_batchSize > 0 && m_maxCpuShare > 0.0F && m_maxCpuShare <= 1.0F; }
+};
+
+/// A pending re-embedding of a semantic space with a new embedding model, and its progress.
+struct ReembedJob
+{
+  /// Config the space switches to once all of its vectors are re-embedded
+  SemanticSpaceConfig m_targetConfig;
+  ReembedConfig m_config;
+  /// Vectors of the space re-embedded so far
+  uint64_t m_vectorsDone{};
+  /// Vectors of the space, including the ones added since the job started
+  uint64_t m_vectorsTotal{};
+};
+
+/// A stored vector of a semantic space being re-embedded, see IOdaiDb::get_reembedding_batch().
+struct ReembedChunk
+{
+  /// Identifier of the vector in the space, vectors are re-embedded in increasing id order
+  int64_t m_vectorId{};
+  /// XXH3 64-bit hash of m_contentText
+  uint64_t m_contentHash{};
+  std::string m_contentText;
+  /// Embedding by the new model as the space stores it, i.e. truncated per the target config
+  std::vector<float> m_embedding;
+};
+
+/// Counters of an OdaiQueryEmbeddingCache
+struct QueryEmbeddingCacheStats
+{
+  uint64_t m_hits{};
+  uint64_t m_misses{};
+  /// Number of cached embeddings
+  size_t m_entries{};
+
+  /// @return share of lookups answered from the cache, 0 before the first lookup
+  double hit_rate() const
+  {
+    const uint64_t lookups = m_hits + m_misses;
+    return lookups == 0 ? 0.0 : static_cast<double>(m_hits) / static_cast<double>(lookups);
+  }
+};
+
+/// Counters of an OdaiRetrievalCache
+struct RetrievalCacheStats
+{
+  uint64_t m_hits{};
+  /// Lookups without an entry, including entries found stale
+  uint64_t m_misses{};
+  /// Entries dropped because their scope was written to after they were cached
+  uint64_t m_staleEntries{};
+  /// Number of cached results
+  size_t m_entries{};
+  /// Estimated memory held by the cached results
+  uint64_t m_bytes{};
+
+  /// @return share of lookups answered from the cache, 0 before the first lookup
+  double hit_rate() const
+  {
+    const uint64_t lookups = m_hits + m_misses;
+    return lookups == 0 ? 0.0 : static_cast<double>(m_hits) / static_cast<double>(lookups);
+  }
+};
+
+/// Counters of an OdaiTokenCountCache
+struct TokenCountCacheStats
+{
+  uint64_t m_hits{};
+  uint64_t m_misses{};
+  /// Number of cached counts
+  size_t m_entries{};
+};
+
+/// Counters of the SDK's caches, see OdaiSdk::get_cache_stats().
+struct CacheStats
+{
+  QueryEmbeddingCacheStats m_queryEmbedding;
+  RetrievalCacheStats m_retrieval;
+  TokenCountCacheStats m_tokenCount;
+};
+
+/// Condition of a metadata filter: matches documents whose value of m_field is one of m_values. Documents without the
+/// field have an empty value.
+struct MetadataFilterCondition
+{
+  /// One of the searched space's SemanticSpaceConfig::m_filterFields
+  std::string m_field;
+  std::vector<std::string> m_values;
+
+  bool operator==(const MetadataFilterCondition&) const = default;
+};
+
+/// Metadata filter of a search, matching documents that match all of its conditions. Empty matches every document.
+typedef std::vector<MetadataFilterCondition> MetadataFilter;
+
 /// Configuration structure for Retrieval (RAG) system.
 /// Defines the search strategy and parameters for retrieving context.
 struct RetrievalConfig
@@ -314,14 +707,33 @@ struct RetrievalConfig
   uint32_t m_topK;
   /// How many maximum candidates to fetch initially (before reranking)?
   uint32_t m_fetchK;
-  /// Minimum similarity score (0.0 to 1.0). Discard irrelevant noise.
+  /// Minimum score (0.0 to 1.0) a chunk needs in its search, see RetrievedChunk::m_score. Discard irrelevant noise.
+  /// Hybrid search applies it to the vector and keyword scores before fusing them.
   float m_scoreThreshold;
-  /// Search Strategy type (VECTOR_ONLY, KEYWORD_ONLY, or HYBRID).
+  /// Search Strategy type (VECTOR_ONLY, KEYWORD_ONLY, HYBRID or MMR).
+  /// MMR runs the vector search and picks diverse chunks among the candidates, skipping near duplicates.
   SearchType m_searchType;
   /// Should we run a cross-encoder? (Expensive but accurate)
   bool m_useReranker;
-  /// If Chunk 5 is a hit, do we also grab Chunk 4 and 6?
+  /// Neighbours on each side of a retrieved chunk added to it, 1 turns a hit on chunk 5 into chunks 4 to 6.
+  /// Overlapping windows of one document are merged into a single passage. 0 keeps the retrieved chunks alone.
   uint32_t m_contextWindow;
+  /// Reranker scoring the candidates, only used with m_useReranker
+  RerankerModelConfig m_rerankerModelConfig{};
+  /// Reranking stops once no remaining candidate can enter the topK, assuming a candidate's reranker score exceeds its
+  /// first stage score by at most this margin. 1.0 or more scores every candidate.
+  float m_rerankEarlyStopMargin = DEFAULT_RERANK_EARLY_STOP_MARGIN;
+  /// Reranking stops scoring new candidates after this many milliseconds, 0 for no limit
+  uint32_t m_rerankTimeBudgetMs = DEFAULT_RERANK_TIME_BUDGET_MS;
+  /// MMR search only: 1.0 ranks by relevance alone, lower values favour chunks unlike those already picked
+  float m_mmrLambda = DEFAULT_MMR_LAMBDA;
+  /// Two-stage vector search: first picks this many documents by their document vectors, then only searches their
+  /// chunks. 0 searches every chunk of the scope.
+  uint32_t m_documentLimit = 0;
+  /// Only chunks of documents matching this filter are searched, the filter narrows the vector scan rather than the
+  /// fetched candidates
+  MetadataFilter m_metadataFilter;
+  // a new field changing the retrieved chunks must also join the retrieval cache key, see OdaiRetrievalCache
 
   bool is_sane() const
   {
@@ -333,6 +745,21 @@ struct RetrievalConfig
     {
       return false;
     }
+    if (m_useReranker && (!m_rerankerModelConfig.is_sane() || m_rerankEarlyStopMargin < 0.0F))
+    {
+      return false;
+    }
+    if (m_mmrLambda < 0.0F || m_mmrLambda > 1.0F)
+    {
+      return false;
+    }
+    for (const MetadataFilterCondition& condition : m_metadataFilter)
+    {
+      if (condition.m_field.empty() || condition.m_values.empty())
+      {
+        return false;
+      }
+    }
 
     return true;
   }
@@ -345,6 +772,14 @@ struct GeneratorRagConfig
   RetrievalConfig m_retrievalConfig{};
   SemanticSpaceName m_semanticSpaceName;
   ScopeId m_scopeId;
+  /// LLM tokens the retrieved chunks may take in the prompt, 0 lets them fill whatever the LLM context window leaves
+  /// after the chat history, the prompt and RAG_RESPONSE_TOKEN_RESERVE. A set budget is still capped by that room.
+  uint32_t m_contextTokenBudget{};
+  /// Further semantic spaces searched in the same scope next to m_semanticSpaceName, concurrently when they use other
+  /// embedding models. Each space is searched with m_retrievalConfig, their rankings are merged before reranking.
+  std::vector<SemanticSpaceName> m_additionalSemanticSpaceNames;
+  /// How the rankings of the searched spaces are merged, unused with a single space
+  SpaceMergeType m_spaceMergeType = SPACE_MERGE_RRF;
 
   bool is_sane() const
   {
@@ -360,6 +795,24 @@ struct GeneratorRagConfig
     {
       return false;
     }
+    if (m_additionalSemanticSpaceNames.size() + 1 > MAX_RAG_SEMANTIC_SPACES)
+    {
+      return false;
+    }
+    for (size_t i = 0; i < m_additionalSemanticSpaceNames.size(); ++i)
+    {
+      const SemanticSpaceName& name = m_additionalSemanticSpaceNames[i];
+      if (name.empty() || name == m_semanticSpaceName ||
+          std::find(m_additionalSemanticSpaceNames.begin() + static_cast<std::ptrdiff_t>(i) + 1,
+                    m_additionalSemanticSpaceNames.end(), name) != m_additionalSemanticSpaceNames.end())
+      {
+        return false;
+      }
+    }
+    if (m_spaceMergeType != SPACE_MERGE_RRF && m_spaceMergeType != SPACE_MERGE_NORMALIZED_SCORE)
+    {
+      return false;
+    }
     return true;
   }
 };
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+/// Blocking multi-producer multi-consumer FIFO queue holding at most `capacity` items.
+/// Producers block while the queue is full, consumers block while it is empty. Once closed, pushes are rejected and
+/// consumers drain the remaining items before pop() returns std::nullopt.
+/// Also records the queue depth seen on every push so pipeline stages can report back pressure.
+template <typename T>
+class OdaiBoundedQueue
+{
+public:
+  explicit OdaiBoundedQueue(size_t capacity) : m_capacity(std::max<size_t>(capacity, 1)) {}
+
+  OdaiBoundedQueue(const OdaiBoundedQueue&) = delete;
+  OdaiBoundedQueue& operator=(const OdaiBoundedQueue&) = delete;
+  OdaiBoundedQueue(OdaiBoundedQueue&&) = delete;
+  OdaiBoundedQueue& operator=(OdaiBoundedQueue&&) = delete;
+
+  /// Pushes an item, blocking while the queue is full.
+  /// @return true if the item was queued, false if the queue was closed
+  bool push(T item)
+  {
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_notFull.wait(lock, [this] { return m_closed || m_items.size() < m_capacity; });
+      if (m_closed)
+      {
+        return false;
+      }
+
+      m_items.push_back(std::move(item));
+      m_maxDepth = std::max(m_maxDepth, m_items.size());
+      m_depthSum += m_items.size();
+      m_pushCount++;
+    }
+    m_notEmpty.notify_one();
+    return true;
+  }
+
+  /// Pops the oldest item, blocking while the queue is empty and open.
+  /// @return the item, or std::nullopt once the queue is closed and drained
+  std::optional<T> pop()
+  {
+    std::optional<T> item;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_notEmpty.wait(lock, [this] { return m_closed || !m_items.empty(); });
+      if (m_items.empty())
+      {
+        return std::nullopt;
+      }
+
+      item = std::move(m_items.front());
+      m_items.pop_front();
+    }
+    m_notFull.notify_one();
+    return item;
+  }
+
+  /// Pops the oldest item only if one is immediately available.
+  /// @return the item, or std::nullopt if the queue is currently empty
+  std::optional<T> try_pop()
+  {
+    std::optional<T> item;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (m_items.empty())
+      {
+        return std::nullopt;
+      }
+
+      item = std::move(m_items.front());
+      m_items.pop_front();
+    }
+    m_notFull.notify_one();
+    return item;
+  }
+
+  /// Closes the queue, waking all blocked producers and consumers.
+  void close()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_closed = true;
+    }
+    m_notFull.notify_all();
+    m_notEmpty.notify_all();
+  }
+
+  /// @return the maximum number of items observed in the queue
+  size_t max_depth() const
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_maxDepth;
+  }
+
+  /// @return the average number of items in the queue sampled on each push, 0 if nothing was pushed
+  double average_depth() const
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pushCount == 0 ? 0.0 : static_cast<double>(m_depthSum) / static_cast<double>(m_pushCount);
+  }
+
+private:
+  const size_t m_capacity;
+  mutable std::mutex m_mutex;
+  std::condition_variable m_notFull;
+  std::condition_variable m_notEmpty;
+  std::deque<T> m_items;
+  bool m_closed = false;
+
+  size_t m_maxDepth = 0;
+  uint64_t m_depthSum = 0;
+  uint64_t m_pushCount = 0;
+};
@@ -2,7 +2,7 @@
 
 inline bool is_sane(c_ModelType type)
 {
-  return (type == ODAI_MODEL_TYPE_EMBEDDING || type == ODAI_MODEL_TYPE_LLM);
+  return (type == ODAI_MODEL_TYPE_EMBEDDING || type == ODAI_MODEL_TYPE_LLM || type == ODAI_MODEL_TYPE_RERANKER);
 }
 
 inline bool is_sane(const c_ModelFiles* model_file_details)
@@ -11,7 +11,7 @@ inline bool is_sane(const c_ModelFiles* model_file_details)
   {
     return false;
   }
-  if (model_file_details->m_modelType > ODAI_MODEL_TYPE_LLM)
+  if (model_file_details->m_modelType > ODAI_MODEL_TYPE_RERANKER)
   {
     return false;
   }
@@ -108,7 +108,8 @@ inline bool is_sane(const c_ChunkingConfig* config)
     return false;
   }
 
-  if (config->m_strategy != FIXED_SIZE_CHUNKING)
+  if (config->m_strategy != FIXED_SIZE_CHUNKING && config->m_strategy != BOUNDARY_AWARE_CHUNKING &&
+      config->m_strategy != TOKEN_AWARE_CHUNKING)
   {
     return false;
   }
@@ -116,13 +117,61 @@ inline bool is_sane(const c_ChunkingConfig* config)
   return true;
 }
 
+/// Validates that an array of C strings is readable.
+/// @param strings The array, may be null if count is 0
+/// @param count Number of strings
+/// @return true if the array and each of its strings are non-null
+inline bool is_sane(const char* const* strings, size_t count)
+{
+  if (count == 0)
+  {
+    return true;
+  }
+  if (strings == nullptr)
+  {
+    return false;
+  }
+  for (size_t i = 0; i < count; ++i)
+  {
+    if (strings[i] == nullptr)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Validates that document metadata entries are readable.
+/// @param entries The entries, may be null if count is 0
+/// @param count Number of entries
+/// @return true if the entries and each of their keys and values are non-null
+inline bool is_sane(const c_MetadataEntry* entries, size_t count)
+{
+  if (count == 0)
+  {
+    return true;
+  }
+  if (entries == nullptr)
+  {
+    return false;
+  }
+  for (size_t i = 0; i < count; ++i)
+  {
+    if (entries[i].m_key == nullptr || entries[i].m_value == nullptr)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
 /// Validates that a semantic space configuration is sane.
 /// @param config The semantic space configuration to validate
 /// @return true of the configuration is valid
 inline bool is_sane(const c_SemanticSpaceConfig* config)
 {
   return config != nullptr && config->m_name != nullptr && is_sane(&config->m_embeddingModelConfig) &&
-         is_sane(&config->m_chunkingConfig);
+         is_sane(&config->m_chunkingConfig) && is_sane(config->m_filterFields, config->m_filterFieldsCount);
 }
 
 /// Validates that a Retrieval configuration is sane and usable.
@@ -131,7 +180,23 @@ inline bool is_sane(const c_SemanticSpaceConfig* config)
 inline bool is_sane(const c_RetrievalConfig* config)
 {
   // Minimal check here, detailed check in C++ type
-  return config != nullptr;
+  if (config == nullptr)
+  {
+    return false;
+  }
+  if (config->m_metadataFilterCount > 0 && config->m_metadataFilter == nullptr)
+  {
+    return false;
+  }
+  for (size_t i = 0; i < config->m_metadataFilterCount; ++i)
+  {
+    const c_MetadataFilterCondition& condition = config->m_metadataFilter[i];
+    if (condition.m_field == nullptr || !is_sane(condition.m_values, condition.m_valuesCount))
+    {
+      return false;
+    }
+  }
+  return true;
 }
 
 /// Validates that a Sampler configuration is sane.
@@ -160,6 +225,10 @@ inline bool is_sane(const struct c_GeneratorRagConfig* config)
   {
     return false;
   }
+  if (!is_sane(config->m_additionalSemanticSpaceNames, config->m_additionalSemanticSpaceNamesCount))
+  {
+    return false;
+  }
   return true;
 }
 
@@ -204,3 +273,13 @@ inline bool is_sane(const c_ChatConfig* config)
 {
   return config != nullptr && config->m_systemPrompt != nullptr && is_sane(&config->m_llmModelConfig);
 }
+
+/// Validates that a bulk ingestion document source is sane and usable.
+/// @param source The document source to validate
+/// @return true if the source has a non-empty document id and file path and readable metadata, false otherwise
+inline bool is_sane(const c_IngestDocumentSource* source)
+{
+  return source != nullptr && source->m_documentId != nullptr && source->m_documentId[0] != '\0' &&
+         source->m_filePath != nullptr && source->m_filePath[0] != '\0' &&
+         is_sane(source->m_metadata, source->m_metadataCount);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+
+#include "types/odai_result.h"
+
+/// Read-only memory mapping of a whole file.
+/// Pages are loaded lazily by the OS on first access, so opening a large file costs no reads. The mapping stays valid
+/// until the object is destroyed.
+class OdaiMappedFile
+{
+public:
+  /// Maps a file read-only.
+  /// @param path The file to map
+  /// @return the mapping on success, or an unexpected OdaiResultEnum (NOT_FOUND if the file doesn't exist,
+  /// VALIDATION_FAILED if it is empty, INTERNAL_ERROR if mapping failed)
+  static OdaiResult<std::unique_ptr<OdaiMappedFile>> open(const std::filesystem::path& path);
+
+  OdaiMappedFile(const OdaiMappedFile&) = delete;
+  OdaiMappedFile& operator=(const OdaiMappedFile&) = delete;
+  OdaiMappedFile(OdaiMappedFile&&) = delete;
+  OdaiMappedFile& operator=(OdaiMappedFile&&) = delete;
+
+  ~OdaiMappedFile();
+
+  const uint8_t* data() const { return m_data; }
+  size_t size() const { return m_size; }
+
+private:
+  OdaiMappedFile() = default;
+
+  const uint8_t* m_data = nullptr;
+  size_t m_size = 0;
+
+#ifdef _WIN32
+  void* m_fileHandle = nullptr;
+  void* m_mappingHandle = nullptr;
+#endif
+};
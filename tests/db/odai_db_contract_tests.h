@@ -2,8 +2,14 @@
 
 #include "odai_db_test_helpers.h"
 
+#include <filesystem>
+#include <fstream>
+#include <iterator>
 #include <memory>
+#include <set>
 #include <string>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include <gtest/gtest.h>
@@ -39,6 +45,30 @@ TYPED_TEST_P(IOdaiDbContractTest, AllMethodsReturnNotInitializedBeforeInitialize
   expect_error(db->get_semantic_space_config("space-a"), OdaiResultEnum::NOT_INITIALIZED);
   expect_error(db->list_semantic_spaces(), OdaiResultEnum::NOT_INITIALIZED);
   expect_error(db->delete_semantic_space("space-a"), OdaiResultEnum::NOT_INITIALIZED);
+  expect_error(db->export_knowledge_pack("space-a", "space-a.pack", true), OdaiResultEnum::NOT_INITIALIZED);
+  expect_error(db->import_knowledge_pack("space-a.pack", ""), OdaiResultEnum::NOT_INITIALIZED);
+  expect_error(db->get_unembedded_chunk_hashes("space-a", {1}), OdaiResultEnum::NOT_INITIALIZED);
+  expect_error(db->get_stored_chunk_embeddings(checksums, {1}), OdaiResultEnum::NOT_INITIALIZED);
+  expect_error(db->store_chunk_embeddings(checksums, {1}, {{1.0F}}), OdaiResultEnum::NOT_INITIALIZED);
+  expect_error(
+      db->add_document("doc-a", "doc-a", "space-a", "scope-a", {make_document_chunk("text", 1, 0, {1.0F})}, {}),
+      OdaiResultEnum::NOT_INITIALIZED);
+  expect_error(db->append_document_chunks("doc-a", {make_document_chunk("text", 1, 1, {1.0F})}),
+               OdaiResultEnum::NOT_INITIALIZED);
+  expect_error(db->update_document("doc-a", "space-a", "scope-a", {make_document_chunk("text", 1, 0, {1.0F})}, {}),
+               OdaiResultEnum::NOT_INITIALIZED);
+  expect_error(db->delete_document("doc-a", "space-a", "scope-a"), OdaiResultEnum::NOT_INITIALIZED);
+  expect_error(db->start_reembedding(space, ReembedConfig{}), OdaiResultEnum::NOT_INITIALIZED);
+  expect_error(db->get_reembedding_job("space-a"), OdaiResultEnum::NOT_INITIALIZED);
+  expect_error(db->list_reembedding_jobs(), OdaiResultEnum::NOT_INITIALIZED);
+  expect_error(db->get_reembedding_batch("space-a", 1), OdaiResultEnum::NOT_INITIALIZED);
+  expect_error(db->store_reembedded_vectors("space-a", {ReembedChunk{1, 1, "text", {1.0F}}}),
+               OdaiResultEnum::NOT_INITIALIZED);
+  expect_error(db->finish_reembedding("space-a"), OdaiResultEnum::NOT_INITIALIZED);
+  expect_error(db->cancel_reembedding("space-a"), OdaiResultEnum::NOT_INITIALIZED);
+  expect_error(db->search_chunks("space-a", "scope-a", {1.0F}, 1, false, {}), OdaiResultEnum::NOT_INITIALIZED);
+  expect_error(db->search_chunks_by_keywords("space-a", "scope-a", "query", 1, {}), OdaiResultEnum::NOT_INITIALIZED);
+  expect_error(db->get_document_chunk_spans("space-a", {{"doc-a", 0, 1}}), OdaiResultEnum::NOT_INITIALIZED);
   expect_error(db->chat_id_exists("chat-a"), OdaiResultEnum::NOT_INITIALIZED);
   expect_error(db->create_chat("chat-a", chat_config), OdaiResultEnum::NOT_INITIALIZED);
   expect_error(db->get_chat_config("chat-a"), OdaiResultEnum::NOT_INITIALIZED);
@@ -155,6 +185,764 @@ TYPED_TEST_P(IOdaiDbContractTest, ListSemanticSpacesReturnsEmptyWhenNoneExist)
   EXPECT_TRUE(spaces->empty());
 }
 
+TYPED_TEST_P(IOdaiDbContractTest, AddDocumentMarksStoredChunksAsEmbedded)
+{
+  IOdaiDb& db = this->initialized_db();
+  ASSERT_TRUE(db.create_semantic_space(make_semantic_space("alpha")).has_value());
+
+  OdaiResult<std::unordered_set<uint64_t>> before = db.get_unembedded_chunk_hashes("alpha", {11, 12, 13});
+  ASSERT_TRUE(before.has_value());
+  EXPECT_EQ(before.value(), (std::unordered_set<uint64_t>{11, 12, 13}));
+
+  const std::vector<DocumentChunk> chunks = {make_document_chunk("first", 11, 0, {1.0F, 0.0F}),
+                                             make_document_chunk("second", 12, 1, {0.0F, 1.0F})};
+  ASSERT_TRUE(db.add_document("doc-a", "file://doc-a", "alpha", "scope-a", chunks, {}).has_value());
+
+  OdaiResult<std::unordered_set<uint64_t>> after = db.get_unembedded_chunk_hashes("alpha", {11, 12, 13});
+  ASSERT_TRUE(after.has_value());
+  EXPECT_EQ(after.value(), (std::unordered_set<uint64_t>{13}));
+}
+
+TYPED_TEST_P(IOdaiDbContractTest, AddDocumentReusesEmbeddingOfExistingContentAcrossScopes)
+{
+  IOdaiDb& db = this->initialized_db();
+  ASSERT_TRUE(db.create_semantic_space(make_semantic_space("alpha")).has_value());
+  ASSERT_TRUE(
+      db.add_document("doc-a", "doc-a", "alpha", "scope-a", {make_document_chunk("shared", 21, 0, {1.0F, 0.0F})}, {})
+          .has_value());
+
+  // same content in another scope and repeated inside the document, without a fresh embedding
+  const std::vector<DocumentChunk> chunks = {make_document_chunk("shared", 21, 0, {}),
+                                             make_document_chunk("shared", 21, 1, {})};
+  EXPECT_TRUE(db.add_document("doc-b", "doc-b", "alpha", "scope-b", chunks, {}).has_value());
+}
+
+TYPED_TEST_P(IOdaiDbContractTest, StoredChunkEmbeddingsAreKeyedByContentAndModelChecksums)
+{
+  IOdaiDb& db = this->initialized_db();
+  const std::string model_a = R"({"base_model_path":"aaa"})";
+  const std::string model_b = R"({"base_model_path":"bbb"})";
+
+  ASSERT_TRUE(db.store_chunk_embeddings(model_a, {71, 72}, {{1.0F, 0.0F, 0.5F}, {0.0F, 1.0F, 0.5F}}).has_value());
+  // a content keeps the embedding stored first
+  ASSERT_TRUE(db.store_chunk_embeddings(model_a, {71}, {{9.0F, 9.0F, 9.0F}}).has_value());
+
+  OdaiResult<std::unordered_map<uint64_t, std::vector<float>>> stored =
+      db.get_stored_chunk_embeddings(model_a, {71, 72, 73});
+  ASSERT_TRUE(stored.has_value());
+  ASSERT_EQ(stored.value().size(), 2U);
+  EXPECT_EQ(stored.value().at(71), (std::vector<float>{1.0F, 0.0F, 0.5F}));
+  EXPECT_EQ(stored.value().at(72), (std::vector<float>{0.0F, 1.0F, 0.5F}));
+
+  OdaiResult<std::unordered_map<uint64_t, std::vector<float>>> other_model =
+      db.get_stored_chunk_embeddings(model_b, {71, 72});
+  ASSERT_TRUE(other_model.has_value());
+  EXPECT_TRUE(other_model.value().empty());
+
+  expect_error(db.store_chunk_embeddings(model_a, {74, 75}, {{1.0F}}), OdaiResultEnum::VALIDATION_FAILED);
+  expect_error(db.store_chunk_embeddings(model_a, {74}, {{}}), OdaiResultEnum::VALIDATION_FAILED);
+}
+
+TYPED_TEST_P(IOdaiDbContractTest, AddDocumentReportsDuplicateMissingAndValidationErrors)
+{
+  IOdaiDb& db = this->initialized_db();
+  ASSERT_TRUE(db.create_semantic_space(make_semantic_space("alpha")).has_value());
+  const std::vector<DocumentChunk> chunks = {make_document_chunk("first", 31, 0, {1.0F, 0.0F})};
+
+  ASSERT_TRUE(db.add_document("doc-a", "doc-a", "alpha", "scope-a", chunks, {}).has_value());
+  expect_error(db.add_document("doc-a", "doc-a", "alpha", "scope-a", chunks, {}), OdaiResultEnum::ALREADY_EXISTS);
+  expect_error(db.add_document("doc-b", "doc-b", "missing-space", "scope-a", chunks, {}), OdaiResultEnum::NOT_FOUND);
+  expect_error(db.get_unembedded_chunk_hashes("missing-space", {31}), OdaiResultEnum::NOT_FOUND);
+  expect_error(db.add_document("doc-c", "doc-c", "alpha", "scope-a", {}, {}), OdaiResultEnum::VALIDATION_FAILED);
+  expect_error(
+      db.add_document("doc-d", "doc-d", "alpha", "scope-a", {make_document_chunk("unembedded", 32, 0, {})}, {}),
+      OdaiResultEnum::VALIDATION_FAILED);
+}
+
+TYPED_TEST_P(IOdaiDbContractTest, AddDocumentRollsBackWhenOneChunkCannotBeEmbedded)
+{
+  IOdaiDb& db = this->initialized_db();
+  ASSERT_TRUE(db.create_semantic_space(make_semantic_space("alpha")).has_value());
+  const std::vector<DocumentChunk> chunks = {make_document_chunk("embedded", 41, 0, {1.0F, 0.0F}),
+                                             make_document_chunk("unembedded", 42, 1, {})};
+
+  expect_error(db.add_document("doc-a", "doc-a", "alpha", "scope-a", chunks, {}), OdaiResultEnum::VALIDATION_FAILED);
+
+  OdaiResult<std::unordered_set<uint64_t>> unembedded = db.get_unembedded_chunk_hashes("alpha", {41});
+  ASSERT_TRUE(unembedded.has_value());
+  EXPECT_EQ(unembedded.value(), (std::unordered_set<uint64_t>{41}));
+}
+
+TYPED_TEST_P(IOdaiDbContractTest, AppendDocumentChunksExtendsDocumentInItsSpaceAndScope)
+{
+  IOdaiDb& db = this->initialized_db();
+  ASSERT_TRUE(db.create_semantic_space(make_semantic_space("alpha")).has_value());
+  ASSERT_TRUE(
+      db.add_document("doc-a", "doc-a", "alpha", "scope-a", {make_document_chunk("first", 51, 0, {1.0F, 0.0F})}, {})
+          .has_value());
+
+  // second part reuses the first part's content and adds a new one
+  const std::vector<DocumentChunk> chunks = {make_document_chunk("first", 51, 1, {}),
+                                             make_document_chunk("second", 52, 2, {0.0F, 1.0F})};
+  ASSERT_TRUE(db.append_document_chunks("doc-a", chunks).has_value());
+
+  OdaiResult<std::unordered_set<uint64_t>> unembedded = db.get_unembedded_chunk_hashes("alpha", {51, 52, 53});
+  ASSERT_TRUE(unembedded.has_value());
+  EXPECT_EQ(unembedded.value(), (std::unordered_set<uint64_t>{53}));
+}
+
+TYPED_TEST_P(IOdaiDbContractTest, AppendDocumentChunksReportsMissingDuplicateAndValidationErrors)
+{
+  IOdaiDb& db = this->initialized_db();
+  ASSERT_TRUE(db.create_semantic_space(make_semantic_space("alpha")).has_value());
+  ASSERT_TRUE(
+      db.add_document("doc-a", "doc-a", "alpha", "scope-a", {make_document_chunk("first", 61, 0, {1.0F, 0.0F})}, {})
+          .has_value());
+
+  expect_error(db.append_document_chunks("missing-doc", {make_document_chunk("second", 62, 1, {0.0F, 1.0F})}),
+               OdaiResultEnum::NOT_FOUND);
+  expect_error(db.append_document_chunks("doc-a", {make_document_chunk("second", 62, 0, {0.0F, 1.0F})}),
+               OdaiResultEnum::ALREADY_EXISTS);
+  expect_error(db.append_document_chunks("doc-a", {}), OdaiResultEnum::VALIDATION_FAILED);
+  expect_error(db.append_document_chunks("doc-a", {make_document_chunk("unembedded", 63, 1, {})}),
+               OdaiResultEnum::VALIDATION_FAILED);
+
+  OdaiResult<std::unordered_set<uint64_t>> unembedded = db.get_unembedded_chunk_hashes("alpha", {62});
+  ASSERT_TRUE(unembedded.has_value());
+  EXPECT_EQ(unembedded.value(), (std::unordered_set<uint64_t>{62}));
+}
+
+TYPED_TEST_P(IOdaiDbContractTest, UpdateDocumentReusesUnchangedChunksAndDropsRemovedOnes)
+{
+  IOdaiDb& db = this->initialized_db();
+  ASSERT_TRUE(db.create_semantic_space(make_semantic_space("alpha")).has_value());
+  ASSERT_TRUE(db.add_document("doc-a", "doc-a", "alpha", "scope-a",
+                              {make_document_chunk("kept", 71, 0, {1.0F, 0.0F}),
+                               make_document_chunk("removed", 72, 1, {0.0F, 1.0F})}, {})
+                  .has_value());
+
+  // the kept chunk moves behind a new one and reuses its stored embedding
+  ASSERT_TRUE(db.update_document("doc-a", "alpha", "scope-a",
+                                 {make_document_chunk("added", 73, 0, {0.6F, 0.8F}),
+                                  make_document_chunk("kept", 71, 1, {})},
+                                 {})
+                  .has_value());
+
+  OdaiResult<std::unordered_set<uint64_t>> unembedded = db.get_unembedded_chunk_hashes("alpha", {71, 72, 73});
+  ASSERT_TRUE(unembedded.has_value());
+  EXPECT_EQ(unembedded.value(), (std::unordered_set<uint64_t>{72}));
+
+  OdaiResult<std::vector<std::vector<DocumentChunk>>> spans = db.get_document_chunk_spans("alpha", {{"doc-a", 0, 1}});
+  ASSERT_TRUE(spans.has_value());
+  ASSERT_EQ(spans.value().size(), 1U);
+  ASSERT_EQ(spans.value()[0].size(), 2U);
+  EXPECT_EQ(spans.value()[0][0].m_contentText, "added");
+  EXPECT_EQ(spans.value()[0][1].m_contentText, "kept");
+
+  OdaiResult<std::vector<RetrievedChunk>> removed = db.search_chunks_by_keywords("alpha", "scope-a", "removed", 5, {});
+  ASSERT_TRUE(removed.has_value());
+  EXPECT_TRUE(removed.value().empty());
+
+  OdaiResult<std::vector<RetrievedChunk>> nearest = db.search_chunks("alpha", "scope-a", {0.0F, 1.0F}, 5, false, {});
+  ASSERT_TRUE(nearest.has_value());
+  ASSERT_EQ(nearest.value().size(), 2U);
+  EXPECT_EQ(nearest.value()[0].m_contentText, "added");
+  EXPECT_EQ(nearest.value()[1].m_sequenceIndex, 1U);
+}
+
+TYPED_TEST_P(IOdaiDbContractTest, UpdateDocumentReportsMissingDocumentAndKeepsOldVersionOnFailure)
+{
+  IOdaiDb& db = this->initialized_db();
+  ASSERT_TRUE(db.create_semantic_space(make_semantic_space("alpha")).has_value());
+  ASSERT_TRUE(
+      db.add_document("doc-a", "doc-a", "alpha", "scope-a", {make_document_chunk("first", 81, 0, {1.0F, 0.0F})}, {})
+          .has_value());
+
+  const std::vector<DocumentChunk> chunks = {make_document_chunk("second", 82, 0, {0.0F, 1.0F})};
+  expect_error(db.update_document("missing-doc", "alpha", "scope-a", chunks, {}), OdaiResultEnum::NOT_FOUND);
+  expect_error(db.update_document("doc-a", "alpha", "scope-b", chunks, {}), OdaiResultEnum::NOT_FOUND);
+  expect_error(db.update_document("doc-a", "missing-space", "scope-a", chunks, {}), OdaiResultEnum::NOT_FOUND);
+  expect_error(db.update_document("doc-a", "alpha", "scope-a", {}, {}), OdaiResultEnum::VALIDATION_FAILED);
+  expect_error(db.update_document("doc-a", "alpha", "scope-a", {make_document_chunk("unembedded", 83, 0, {})}, {}),
+               OdaiResultEnum::VALIDATION_FAILED);
+
+  OdaiResult<std::vector<std::vector<DocumentChunk>>> spans = db.get_document_chunk_spans("alpha", {{"doc-a", 0, 1}});
+  ASSERT_TRUE(spans.has_value());
+  ASSERT_EQ(spans.value().size(), 1U);
+  ASSERT_EQ(spans.value()[0].size(), 1U);
+  EXPECT_EQ(spans.value()[0][0].m_contentText, "first");
+}
+
+TYPED_TEST_P(IOdaiDbContractTest, DeleteDocumentRemovesChunksNoOtherDocumentReferences)
+{
+  IOdaiDb& db = this->initialized_db();
+  ASSERT_TRUE(db.create_semantic_space(make_semantic_space("alpha")).has_value());
+  ASSERT_TRUE(db.add_document("doc-a", "doc-a", "alpha", "scope-a",
+                              {make_document_chunk("shared", 91, 0, {1.0F, 0.0F}),
+                               make_document_chunk("own", 92, 1, {0.0F, 1.0F})}, {})
+                  .has_value());
+  ASSERT_TRUE(db.add_document("doc-b", "doc-b", "alpha", "scope-a", {make_document_chunk("shared", 91, 0, {})}, {})
+                  .has_value());
+
+  expect_error(db.delete_document("missing-doc", "alpha", "scope-a"), OdaiResultEnum::NOT_FOUND);
+  expect_error(db.delete_document("doc-a", "alpha", "scope-b"), OdaiResultEnum::NOT_FOUND);
+  expect_error(db.delete_document("doc-a", "missing-space", "scope-a"), OdaiResultEnum::NOT_FOUND);
+  ASSERT_TRUE(db.delete_document("doc-a", "alpha", "scope-a").has_value());
+
+  // the shared content keeps serving doc-b, the content only doc-a had is gone
+  OdaiResult<std::unordered_set<uint64_t>> unembedded = db.get_unembedded_chunk_hashes("alpha", {91, 92});
+  ASSERT_TRUE(unembedded.has_value());
+  EXPECT_EQ(unembedded.value(), (std::unordered_set<uint64_t>{92}));
+
+  OdaiResult<std::vector<RetrievedChunk>> nearest = db.search_chunks("alpha", "scope-a", {0.0F, 1.0F}, 5, false, {});
+  ASSERT_TRUE(nearest.has_value());
+  ASSERT_EQ(nearest.value().size(), 1U);
+  EXPECT_EQ(nearest.value()[0].m_documentId, "doc-b");
+
+  OdaiResult<std::vector<RetrievedChunk>> removed = db.search_chunks_by_keywords("alpha", "scope-a", "own", 5, {});
+  ASSERT_TRUE(removed.has_value());
+  EXPECT_TRUE(removed.value().empty());
+
+  // the id is free again
+  EXPECT_TRUE(
+      db.add_document("doc-a", "doc-a", "alpha", "scope-a", {make_document_chunk("own", 92, 0, {0.0F, 1.0F})}, {})
+          .has_value());
+}
+
+TYPED_TEST_P(IOdaiDbContractTest, ReembeddingServesOldVectorsUntilFinishedThenSwitches)
+{
+  IOdaiDb& db = this->initialized_db();
+  ASSERT_TRUE(db.create_semantic_space(make_semantic_space("alpha")).has_value());
+  ASSERT_TRUE(db.add_document("doc-a", "doc-a", "alpha", "scope-a",
+                              {make_document_chunk("one", 91, 0, {1.0F, 0.0F}),
+                               make_document_chunk("two", 92, 1, {0.0F, 1.0F})}, {})
+                  .has_value());
+
+  SemanticSpaceConfig target = make_semantic_space("alpha");
+  target.m_embeddingModelConfig = {"embedding-model-v2"};
+  target.m_dimensions = 3;
+  ASSERT_TRUE(db.start_reembedding(target, ReembedConfig{}).has_value());
+  expect_error(db.start_reembedding(target, ReembedConfig{}), OdaiResultEnum::ALREADY_EXISTS);
+
+  OdaiResult<std::vector<ReembedChunk>> batch = db.get_reembedding_batch("alpha", 1);
+  ASSERT_TRUE(batch.has_value());
+  ASSERT_EQ(batch.value().size(), 1U);
+  EXPECT_EQ(batch.value()[0].m_contentText, "one");
+  EXPECT_EQ(batch.value()[0].m_contentHash, 91U);
+  batch.value()[0].m_embedding = {0.0F, 0.0F, 1.0F};
+  ASSERT_TRUE(db.store_reembedded_vectors("alpha", batch.value()).has_value());
+  expect_error(db.store_reembedded_vectors("alpha", batch.value()), OdaiResultEnum::VALIDATION_FAILED);
+
+  // the space keeps its old model and vectors, and takes new documents embedded with it
+  ASSERT_TRUE(
+      db.add_document("doc-b", "doc-b", "alpha", "scope-a", {make_document_chunk("three", 93, 0, {0.6F, 0.8F})}, {})
+          .has_value());
+  OdaiResult<std::vector<RetrievedChunk>> old_search = db.search_chunks("alpha", "scope-a", {1.0F, 0.0F}, 5, false, {});
+  ASSERT_TRUE(old_search.has_value());
+  ASSERT_EQ(old_search.value().size(), 3U);
+  EXPECT_EQ(old_search.value()[0].m_contentText, "one");
+
+  OdaiResult<ReembedJob> job = db.get_reembedding_job("alpha");
+  ASSERT_TRUE(job.has_value());
+  EXPECT_EQ(job.value().m_targetConfig.m_embeddingModelConfig.m_modelName, "embedding-model-v2");
+  EXPECT_EQ(job.value().m_vectorsDone, 1U);
+  EXPECT_EQ(job.value().m_vectorsTotal, 3U);
+
+  OdaiResult<bool> finished = db.finish_reembedding("alpha");
+  ASSERT_TRUE(finished.has_value());
+  EXPECT_FALSE(finished.value());
+
+  batch = db.get_reembedding_batch("alpha", 10);
+  ASSERT_TRUE(batch.has_value());
+  ASSERT_EQ(batch.value().size(), 2U);
+  EXPECT_EQ(batch.value()[0].m_contentText, "two");
+  EXPECT_EQ(batch.value()[1].m_contentText, "three");
+  batch.value()[0].m_embedding = {0.0F, 1.0F, 0.0F};
+  batch.value()[1].m_embedding = {1.0F, 0.0F};
+  expect_error(db.store_reembedded_vectors("alpha", batch.value()), OdaiResultEnum::VALIDATION_FAILED);
+  batch.value()[1].m_embedding = {1.0F, 0.0F, 0.0F};
+  ASSERT_TRUE(db.store_reembedded_vectors("alpha", batch.value()).has_value());
+
+  finished = db.finish_reembedding("alpha");
+  ASSERT_TRUE(finished.has_value());
+  EXPECT_TRUE(finished.value());
+  expect_error(db.get_reembedding_job("alpha"), OdaiResultEnum::NOT_FOUND);
+
+  OdaiResult<SemanticSpaceConfig> config = db.get_semantic_space_config("alpha");
+  ASSERT_TRUE(config.has_value());
+  EXPECT_EQ(config.value().m_embeddingModelConfig.m_modelName, "embedding-model-v2");
+  EXPECT_EQ(config.value().m_dimensions, 3U);
+
+  expect_error(db.search_chunks("alpha", "scope-a", {1.0F, 0.0F}, 5, false, {}), OdaiResultEnum::VALIDATION_FAILED);
+  OdaiResult<std::vector<RetrievedChunk>> new_search =
+      db.search_chunks("alpha", "scope-a", {0.0F, 0.0F, 1.0F}, 5, false, {});
+  ASSERT_TRUE(new_search.has_value());
+  ASSERT_EQ(new_search.value().size(), 3U);
+  EXPECT_EQ(new_search.value()[0].m_contentText, "one");
+
+  // document vectors are rebuilt from the new vectors
+  OdaiResult<std::vector<RetrievedChunk>> two_stage =
+      db.search_chunks_in_top_documents("alpha", "scope-a", {1.0F, 0.0F, 0.0F}, 1, 5, false, {});
+  ASSERT_TRUE(two_stage.has_value());
+  ASSERT_EQ(two_stage.value().size(), 1U);
+  EXPECT_EQ(two_stage.value()[0].m_contentText, "three");
+
+  // new documents are stored with the new model's dimensions
+  ASSERT_TRUE(
+      db.add_document("doc-c", "doc-c", "alpha", "scope-a",
+                      {make_document_chunk("four", 94, 0, {0.0F, 0.6F, 0.8F})}, {})
+          .has_value());
+}
+
+TYPED_TEST_P(IOdaiDbContractTest, ReembeddingReportsInvalidJobsAndCanBeCancelled)
+{
+  IOdaiDb& db = this->initialized_db();
+  ASSERT_TRUE(db.create_semantic_space(make_semantic_space("alpha")).has_value());
+  ASSERT_TRUE(
+      db.add_document("doc-a", "doc-a", "alpha", "scope-a", {make_document_chunk("one", 95, 0, {1.0F, 0.0F})}, {})
+          .has_value());
+
+  SemanticSpaceConfig target = make_semantic_space("alpha");
+  target.m_embeddingModelConfig = {"embedding-model-v2"};
+  target.m_dimensions = 3;
+  SemanticSpaceConfig missing_target = target;
+  missing_target.m_name = "missing-space";
+  expect_error(db.start_reembedding(missing_target, ReembedConfig{}), OdaiResultEnum::NOT_FOUND);
+  SemanticSpaceConfig rechunked_target = target;
+  std::get<FixedSizeChunkingConfig>(rechunked_target.m_chunkingConfig.m_config).m_chunkSize = 128;
+  expect_error(db.start_reembedding(rechunked_target, ReembedConfig{}), OdaiResultEnum::VALIDATION_FAILED);
+  expect_error(db.start_reembedding(target, ReembedConfig{0, 0.5F}), OdaiResultEnum::VALIDATION_FAILED);
+
+  expect_error(db.get_reembedding_job("alpha"), OdaiResultEnum::NOT_FOUND);
+  expect_error(db.get_reembedding_batch("alpha", 1), OdaiResultEnum::NOT_FOUND);
+  ReembedChunk chunk{1, 95, "one", {1.0F, 0.0F, 0.0F}};
+  expect_error(db.store_reembedded_vectors("alpha", {chunk}), OdaiResultEnum::NOT_FOUND);
+  expect_error(db.finish_reembedding("alpha"), OdaiResultEnum::NOT_FOUND);
+  expect_error(db.cancel_reembedding("alpha"), OdaiResultEnum::NOT_FOUND);
+
+  ASSERT_TRUE(db.start_reembedding(target, ReembedConfig{}).has_value());
+  ASSERT_TRUE(db.cancel_reembedding("alpha").has_value());
+  expect_error(db.get_reembedding_job("alpha"), OdaiResultEnum::NOT_FOUND);
+  OdaiResult<std::vector<ReembedJob>> jobs = db.list_reembedding_jobs();
+  ASSERT_TRUE(jobs.has_value());
+  EXPECT_TRUE(jobs.value().empty());
+
+  OdaiResult<SemanticSpaceConfig> config = db.get_semantic_space_config("alpha");
+  ASSERT_TRUE(config.has_value());
+  EXPECT_EQ(config.value().m_dimensions, 2U);
+  OdaiResult<std::vector<RetrievedChunk>> search = db.search_chunks("alpha", "scope-a", {1.0F, 0.0F}, 5, false, {});
+  ASSERT_TRUE(search.has_value());
+  EXPECT_EQ(search.value().size(), 1U);
+
+  // a cancelled job can be started again
+  ASSERT_TRUE(db.start_reembedding(target, ReembedConfig{}).has_value());
+}
+
+TYPED_TEST_P(IOdaiDbContractTest, ReembeddingProgressSurvivesCloseAndReopen)
+{
+  IOdaiDb& db = this->initialized_db();
+  ASSERT_TRUE(db.create_semantic_space(make_semantic_space("alpha")).has_value());
+  ASSERT_TRUE(db.add_document("doc-a", "doc-a", "alpha", "scope-a",
+                              {make_document_chunk("one", 96, 0, {1.0F, 0.0F}),
+                               make_document_chunk("two", 97, 1, {0.0F, 1.0F})}, {})
+                  .has_value());
+  SemanticSpaceConfig target = make_semantic_space("alpha");
+  target.m_embeddingModelConfig = {"embedding-model-v2"};
+  ASSERT_TRUE(db.start_reembedding(target, ReembedConfig{1, 0.5F}).has_value());
+  OdaiResult<std::vector<ReembedChunk>> batch = db.get_reembedding_batch("alpha", 1);
+  ASSERT_TRUE(batch.has_value());
+  ASSERT_EQ(batch.value().size(), 1U);
+  batch.value()[0].m_embedding = {0.0F, 1.0F};
+  ASSERT_TRUE(db.store_reembedded_vectors("alpha", batch.value()).has_value());
+
+  this->reopen_db();
+
+  OdaiResult<std::vector<ReembedJob>> jobs = this->initialized_db().list_reembedding_jobs();
+  ASSERT_TRUE(jobs.has_value());
+  ASSERT_EQ(jobs.value().size(), 1U);
+  EXPECT_EQ(jobs.value()[0].m_targetConfig.m_name, "alpha");
+  EXPECT_EQ(jobs.value()[0].m_config.m_batchSize, 1U);
+  EXPECT_FLOAT_EQ(jobs.value()[0].m_config.m_maxCpuShare, 0.5F);
+  EXPECT_EQ(jobs.value()[0].m_vectorsDone, 1U);
+  EXPECT_EQ(jobs.value()[0].m_vectorsTotal, 2U);
+
+  batch = this->initialized_db().get_reembedding_batch("alpha", 5);
+  ASSERT_TRUE(batch.has_value());
+  ASSERT_EQ(batch.value().size(), 1U);
+  EXPECT_EQ(batch.value()[0].m_contentText, "two");
+}
+
+TYPED_TEST_P(IOdaiDbContractTest, SearchChunksReturnsNearestChunksOfTheScopeOnly)
+{
+  IOdaiDb& db = this->initialized_db();
+  ASSERT_TRUE(db.create_semantic_space(make_semantic_space("alpha")).has_value());
+
+  OdaiResult<std::vector<RetrievedChunk>> before = db.search_chunks("alpha", "scope-a", {1.0F, 0.0F}, 5, false, {});
+  ASSERT_TRUE(before.has_value());
+  EXPECT_TRUE(before->empty());
+
+  const std::vector<DocumentChunk> chunks = {make_document_chunk("east", 71, 0, {1.0F, 0.0F}),
+                                             make_document_chunk("north", 72, 1, {0.0F, 1.0F}),
+                                             make_document_chunk("north east", 73, 2, {1.0F, 1.0F})};
+  ASSERT_TRUE(db.add_document("doc-a", "file://doc-a", "alpha", "scope-a", chunks, {}).has_value());
+  // a document added from memory has no source location
+  ASSERT_TRUE(
+      db.add_document("doc-b", "", "alpha", "scope-b", {make_document_chunk("other", 74, 0, {1.0F, 0.0F})}, {})
+          .has_value());
+
+  OdaiResult<std::vector<RetrievedChunk>> results = db.search_chunks("alpha", "scope-a", {1.0F, 0.1F}, 2, false, {});
+  ASSERT_TRUE(results.has_value());
+  ASSERT_EQ(results->size(), 2U);
+  EXPECT_EQ(results->at(0).m_contentText, "east");
+  EXPECT_EQ(results->at(0).m_documentId, "doc-a");
+  EXPECT_EQ(results->at(0).m_sourceUri, "file://doc-a");
+  EXPECT_EQ(results->at(0).m_sequenceIndex, 0U);
+  EXPECT_EQ(results->at(1).m_contentText, "north east");
+  EXPECT_EQ(results->at(1).m_sequenceIndex, 2U);
+  EXPECT_GT(results->at(0).m_score, results->at(1).m_score);
+  EXPECT_LE(results->at(0).m_score, 1.0F);
+  EXPECT_TRUE(results->at(0).m_embedding.empty());
+
+  OdaiResult<std::vector<RetrievedChunk>> with_embeddings =
+      db.search_chunks("alpha", "scope-a", {1.0F, 0.1F}, 2, true, {});
+  ASSERT_TRUE(with_embeddings.has_value());
+  ASSERT_EQ(with_embeddings->size(), 2U);
+  EXPECT_EQ(with_embeddings->at(0).m_embedding, (std::vector<float>{1.0F, 0.0F}));
+  EXPECT_EQ(with_embeddings->at(1).m_embedding, (std::vector<float>{1.0F, 1.0F}));
+
+  OdaiResult<std::vector<RetrievedChunk>> other_scope =
+      db.search_chunks("alpha", "scope-b", {1.0F, 0.0F}, 5, false, {});
+  ASSERT_TRUE(other_scope.has_value());
+  ASSERT_EQ(other_scope->size(), 1U);
+  EXPECT_EQ(other_scope->front().m_documentId, "doc-b");
+  EXPECT_TRUE(other_scope->front().m_sourceUri.empty());
+  EXPECT_NEAR(other_scope->front().m_score, 1.0F, 1e-5F);
+
+  OdaiResult<std::vector<RetrievedChunk>> missing_scope =
+      db.search_chunks("alpha", "scope-c", {1.0F, 0.0F}, 5, false, {});
+  ASSERT_TRUE(missing_scope.has_value());
+  EXPECT_TRUE(missing_scope->empty());
+}
+
+TYPED_TEST_P(IOdaiDbContractTest, SearchChunksReportsMissingSpaceAndInvalidQuery)
+{
+  IOdaiDb& db = this->initialized_db();
+  ASSERT_TRUE(db.create_semantic_space(make_semantic_space("alpha")).has_value());
+  ASSERT_TRUE(
+      db.add_document("doc-a", "doc-a", "alpha", "scope-a", {make_document_chunk("first", 81, 0, {1.0F, 0.0F})}, {})
+          .has_value());
+
+  expect_error(db.search_chunks("missing-space", "scope-a", {1.0F, 0.0F}, 5, false, {}), OdaiResultEnum::NOT_FOUND);
+  expect_error(db.search_chunks("alpha", "scope-a", {1.0F, 0.0F, 0.0F}, 5, false, {}),
+               OdaiResultEnum::VALIDATION_FAILED);
+  expect_error(db.search_chunks("alpha", "scope-a", {}, 5, false, {}), OdaiResultEnum::VALIDATION_FAILED);
+  expect_error(db.search_chunks("alpha", "scope-a", {1.0F, 0.0F}, 0, false, {}), OdaiResultEnum::VALIDATION_FAILED);
+}
+
+TYPED_TEST_P(IOdaiDbContractTest, SearchChunksByKeywordsRanksMatchingChunksOfTheScopeOnly)
+{
+  IOdaiDb& db = this->initialized_db();
+  ASSERT_TRUE(db.create_semantic_space(make_semantic_space("alpha")).has_value());
+  ASSERT_TRUE(db.create_semantic_space(make_semantic_space("beta")).has_value());
+
+  const std::vector<DocumentChunk> chunks = {
+      make_document_chunk("The kernel schedules threads.", 91, 0, {1.0F, 0.0F}),
+      make_document_chunk("Threads share memory, the kernel isolates processes.", 92, 1, {0.0F, 1.0F}),
+      make_document_chunk("Unrelated notes about gardening.", 93, 2, {1.0F, 1.0F})};
+  ASSERT_TRUE(db.add_document("doc-a", "file://doc-a", "alpha", "scope-a", chunks, {}).has_value());
+  ASSERT_TRUE(db.add_document("doc-b", "file://doc-b", "alpha", "scope-b",
+                              {make_document_chunk("The kernel in scope b.", 94, 0, {1.0F, 0.0F})}, {})
+                  .has_value());
+  ASSERT_TRUE(db.add_document("doc-c", "file://doc-c", "beta", "scope-a",
+                              {make_document_chunk("A kernel in another space.", 95, 0, {1.0F, 0.0F})}, {})
+                  .has_value());
+
+  OdaiResult<std::vector<RetrievedChunk>> results = db.search_chunks_by_keywords("alpha", "scope-a", "kernel", 5, {});
+  ASSERT_TRUE(results.has_value());
+  ASSERT_EQ(results->size(), 2U);
+  for (const RetrievedChunk& chunk : results.value())
+  {
+    EXPECT_EQ(chunk.m_documentId, "doc-a");
+    EXPECT_EQ(chunk.m_sourceUri, "file://doc-a");
+    EXPECT_GT(chunk.m_score, 0.0F);
+    EXPECT_LT(chunk.m_score, 1.0F);
+  }
+  EXPECT_GE(results->at(0).m_score, results->at(1).m_score);
+
+  // matching more of the query's words ranks higher, matching is case insensitive
+  OdaiResult<std::vector<RetrievedChunk>> ranked =
+      db.search_chunks_by_keywords("alpha", "scope-a", "SHARE memory of threads", 5, {});
+  ASSERT_TRUE(ranked.has_value());
+  ASSERT_EQ(ranked->size(), 2U);
+  EXPECT_EQ(ranked->at(0).m_sequenceIndex, 1U);
+  EXPECT_EQ(ranked->at(1).m_sequenceIndex, 0U);
+
+  OdaiResult<std::vector<RetrievedChunk>> limited = db.search_chunks_by_keywords("alpha", "scope-a", "kernel", 1, {});
+  ASSERT_TRUE(limited.has_value());
+  EXPECT_EQ(limited->size(), 1U);
+
+  OdaiResult<std::vector<RetrievedChunk>> no_match = db.search_chunks_by_keywords("alpha", "scope-a", "volcano", 5, {});
+  ASSERT_TRUE(no_match.has_value());
+  EXPECT_TRUE(no_match->empty());
+}
+
+TYPED_TEST_P(IOdaiDbContractTest, SearchChunksByKeywordsTakesQuerySyntaxLiterallyAndReportsErrors)
+{
+  IOdaiDb& db = this->initialized_db();
+  ASSERT_TRUE(db.create_semantic_space(make_semantic_space("alpha")).has_value());
+  ASSERT_TRUE(db.add_document("doc-a", "doc-a", "alpha", "scope-a",
+                              {make_document_chunk("near the \"quoted\" end", 96, 0, {1.0F, 0.0F})}, {})
+                  .has_value());
+
+  // FTS query operators and punctuation in a query must neither fail nor change its meaning
+  OdaiResult<std::vector<RetrievedChunk>> operators =
+      db.search_chunks_by_keywords("alpha", "scope-a", "NEAR(\"quoted* content_text: end) AND -", 5, {});
+  ASSERT_TRUE(operators.has_value());
+  EXPECT_EQ(operators->size(), 1U);
+
+  OdaiResult<std::vector<RetrievedChunk>> punctuation =
+      db.search_chunks_by_keywords("alpha", "scope-a", "?! ... -", 5, {});
+  ASSERT_TRUE(punctuation.has_value());
+  EXPECT_TRUE(punctuation->empty());
+
+  expect_error(db.search_chunks_by_keywords("missing-space", "scope-a", "quoted", 5, {}), OdaiResultEnum::NOT_FOUND);
+  expect_error(db.search_chunks_by_keywords("alpha", "", "quoted", 5, {}), OdaiResultEnum::VALIDATION_FAILED);
+  expect_error(db.search_chunks_by_keywords("alpha", "scope-a", "", 5, {}), OdaiResultEnum::VALIDATION_FAILED);
+  expect_error(db.search_chunks_by_keywords("alpha", "scope-a", "quoted", 0, {}), OdaiResultEnum::VALIDATION_FAILED);
+}
+
+TYPED_TEST_P(IOdaiDbContractTest, SearchesOnlyReturnChunksOfDocumentsMatchingTheMetadataFilter)
+{
+  IOdaiDb& db = this->initialized_db();
+  SemanticSpaceConfig space = make_semantic_space("alpha");
+  space.m_filterFields = {"lang", "kind"};
+  ASSERT_TRUE(db.create_semantic_space(space).has_value());
+
+  ASSERT_TRUE(db.add_document("doc-en", "doc-en", "alpha", "scope-a",
+                              {make_document_chunk("shared kernel notes", 111, 0, {1.0F, 0.0F}),
+                               make_document_chunk("english kernel notes", 112, 1, {0.8F, 0.6F})},
+                              {{"lang", "en"}, {"kind", "guide"}, {"author", "not a filter field"}})
+                  .has_value());
+  // the same content under other filter values reuses its embedding
+  ASSERT_TRUE(db.add_document("doc-fr", "doc-fr", "alpha", "scope-a",
+                              {make_document_chunk("shared kernel notes", 111, 0, {}),
+                               make_document_chunk("french kernel notes", 113, 1, {0.0F, 1.0F})},
+                              {{"lang", "fr"}})
+                  .has_value());
+
+  auto document_ids = [](const OdaiResult<std::vector<RetrievedChunk>>& results)
+  {
+    std::multiset<std::string> ids;
+    if (results.has_value())
+    {
+      for (const RetrievedChunk& chunk : results.value())
+      {
+        ids.insert(chunk.m_documentId);
+      }
+    }
+    return ids;
+  };
+  using Ids = std::multiset<std::string>;
+  const MetadataFilter english = {{"lang", {"en"}}};
+  const MetadataFilter french = {{"lang", {"fr"}}};
+
+  EXPECT_EQ(document_ids(db.search_chunks("alpha", "scope-a", {1.0F, 0.0F}, 5, false, {})),
+            (Ids{"doc-en", "doc-en", "doc-fr", "doc-fr"}));
+  EXPECT_EQ(document_ids(db.search_chunks("alpha", "scope-a", {1.0F, 0.0F}, 5, false, english)),
+            (Ids{"doc-en", "doc-en"}));
+  EXPECT_EQ(document_ids(db.search_chunks("alpha", "scope-a", {1.0F, 0.0F}, 1, false, french)), (Ids{"doc-fr"}));
+  EXPECT_EQ(document_ids(db.search_chunks("alpha", "scope-a", {1.0F, 0.0F}, 5, false, {{"lang", {"en", "fr"}}})),
+            (Ids{"doc-en", "doc-en", "doc-fr", "doc-fr"}));
+  EXPECT_EQ(document_ids(db.search_chunks("alpha", "scope-a", {1.0F, 0.0F}, 5, false,
+                                          {{"lang", {"en", "fr"}}, {"kind", {"guide"}}})),
+            (Ids{"doc-en", "doc-en"}));
+  EXPECT_TRUE(document_ids(db.search_chunks("alpha", "scope-a", {1.0F, 0.0F}, 5, false, {{"lang", {"de"}}})).empty());
+
+  EXPECT_EQ(document_ids(db.search_chunks_in_top_documents("alpha", "scope-a", {1.0F, 0.0F}, 2, 5, false, french)),
+            (Ids{"doc-fr", "doc-fr"}));
+  EXPECT_EQ(document_ids(db.search_chunks_by_keywords("alpha", "scope-a", "shared", 5, french)), (Ids{"doc-fr"}));
+  EXPECT_EQ(document_ids(db.search_chunks_by_keywords("alpha", "scope-a", "notes", 5, english)),
+            (Ids{"doc-en", "doc-en"}));
+
+  // an updated document takes the metadata of its new version
+  ASSERT_TRUE(db.update_document("doc-fr", "alpha", "scope-a",
+                                 {make_document_chunk("updated french notes", 114, 0, {0.6F, 0.8F})}, {{"lang", "fr"}})
+                  .has_value());
+  OdaiResult<std::vector<RetrievedChunk>> updated =
+      db.search_chunks("alpha", "scope-a", {1.0F, 0.0F}, 5, false, french);
+  ASSERT_TRUE(updated.has_value());
+  ASSERT_EQ(updated->size(), 1U);
+  EXPECT_EQ(updated->at(0).m_contentText, "updated french notes");
+  EXPECT_EQ(document_ids(db.search_chunks("alpha", "scope-a", {1.0F, 0.0F}, 5, false, english)),
+            (Ids{"doc-en", "doc-en"}));
+
+  // kept chunks follow new filter values: a vector another document uses with the old ones is copied, first
+  ASSERT_TRUE(db.add_document("doc-fr-copy", "doc-fr-copy", "alpha", "scope-a",
+                              {make_document_chunk("updated french notes", 114, 0, {})}, {{"lang", "fr"}})
+                  .has_value());
+  const std::vector<DocumentChunk> german_chunks = {make_document_chunk("updated french notes", 114, 0, {}),
+                                                    make_document_chunk("german kernel notes", 115, 1, {0.8F, 0.6F})};
+  ASSERT_TRUE(
+      db.update_document("doc-fr", "alpha", "scope-a", german_chunks, {{"lang", "de"}, {"kind", "guide"}}).has_value());
+  // then the document's own vectors are moved
+  ASSERT_TRUE(db.update_document("doc-fr", "alpha", "scope-a", german_chunks, {{"lang", "de"}}).has_value());
+  const MetadataFilter german = {{"lang", {"de"}}};
+  EXPECT_EQ(document_ids(db.search_chunks("alpha", "scope-a", {1.0F, 0.0F}, 5, false, german)),
+            (Ids{"doc-fr", "doc-fr"}));
+  EXPECT_EQ(document_ids(db.search_chunks("alpha", "scope-a", {1.0F, 0.0F}, 5, false, {{"kind", {"guide"}}})),
+            (Ids{"doc-en", "doc-en"}));
+  EXPECT_EQ(document_ids(db.search_chunks_by_keywords("alpha", "scope-a", "notes", 5, german)),
+            (Ids{"doc-fr", "doc-fr"}));
+  EXPECT_EQ(document_ids(db.search_chunks_in_top_documents("alpha", "scope-a", {1.0F, 0.0F}, 2, 5, false, german)),
+            (Ids{"doc-fr", "doc-fr"}));
+  EXPECT_EQ(document_ids(db.search_chunks("alpha", "scope-a", {1.0F, 0.0F}, 5, false, french)), (Ids{"doc-fr-copy"}));
+  EXPECT_EQ(document_ids(db.search_chunks("alpha", "scope-a", {1.0F, 0.0F}, 5, false, {})),
+            (Ids{"doc-en", "doc-en", "doc-fr", "doc-fr", "doc-fr-copy"}));
+
+  // only the space's filter fields can be filtered on
+  expect_error(db.search_chunks("alpha", "scope-a", {1.0F, 0.0F}, 5, false, {{"author", {"x"}}}),
+               OdaiResultEnum::VALIDATION_FAILED);
+  expect_error(db.search_chunks("alpha", "scope-a", {1.0F, 0.0F}, 5, false, {{"lang", {}}}),
+               OdaiResultEnum::VALIDATION_FAILED);
+  expect_error(db.search_chunks_by_keywords("alpha", "scope-a", "notes", 5, {{"author", {"x"}}}),
+               OdaiResultEnum::VALIDATION_FAILED);
+}
+
+TYPED_TEST_P(IOdaiDbContractTest, GetDocumentChunkSpansReadsOrderedRangesOfDocuments)
+{
+  IOdaiDb& db = this->initialized_db();
+  ASSERT_TRUE(db.create_semantic_space(make_semantic_space("alpha")).has_value());
+  const std::vector<DocumentChunk> chunks = {
+      make_document_chunk("zero", 101, 0, {1.0F, 0.0F}), make_document_chunk("one", 102, 1, {0.0F, 1.0F}),
+      make_document_chunk("two", 103, 2, {1.0F, 1.0F}), make_document_chunk("one", 102, 3, {}),
+      make_document_chunk("four", 104, 4, {1.0F, 0.5F})};
+  ASSERT_TRUE(db.add_document("doc-a", "doc-a", "alpha", "scope-a", chunks, {}).has_value());
+  ASSERT_TRUE(
+      db.add_document("doc-b", "doc-b", "alpha", "scope-b", {make_document_chunk("other", 105, 0, {0.5F, 1.0F})}, {})
+          .has_value());
+
+  auto texts = [](const std::vector<DocumentChunk>& span)
+  {
+    std::vector<std::pair<uint32_t, std::string>> result;
+    for (const DocumentChunk& chunk : span)
+    {
+      result.emplace_back(chunk.m_sequenceIndex, chunk.m_contentText);
+    }
+    return result;
+  };
+
+  // a repeated content is read at each of its positions, positions past the end and missing documents are skipped
+  OdaiResult<std::vector<std::vector<DocumentChunk>>> spans =
+      db.get_document_chunk_spans("alpha", {{"doc-a", 1, 3}, {"doc-b", 0, 2}, {"doc-a", 4, 9}, {"missing-doc", 0, 1}});
+  ASSERT_TRUE(spans.has_value());
+  ASSERT_EQ(spans->size(), 4U);
+  using Texts = std::vector<std::pair<uint32_t, std::string>>;
+  EXPECT_EQ(texts(spans->at(0)), (Texts{{1, "one"}, {2, "two"}, {3, "one"}}));
+  EXPECT_EQ(texts(spans->at(1)), (Texts{{0, "other"}}));
+  EXPECT_EQ(texts(spans->at(2)), (Texts{{4, "four"}}));
+  EXPECT_TRUE(spans->at(3).empty());
+
+  OdaiResult<std::vector<std::vector<DocumentChunk>>> none = db.get_document_chunk_spans("alpha", {});
+  ASSERT_TRUE(none.has_value());
+  EXPECT_TRUE(none->empty());
+
+  expect_error(db.get_document_chunk_spans("alpha", {{"doc-a", 3, 2}}), OdaiResultEnum::VALIDATION_FAILED);
+  expect_error(db.get_document_chunk_spans("alpha", {{"", 0, 2}}), OdaiResultEnum::VALIDATION_FAILED);
+}
+
+TYPED_TEST_P(IOdaiDbContractTest, KnowledgePacksAreExportedAndAttachedAsReadOnlySpaces)
+{
+  IOdaiDb& db = this->initialized_db();
+  const ModelFiles files = make_model_files(ModelType::EMBEDDING, {{"base_model_path", "/tmp/embed.gguf"}});
+  ASSERT_TRUE(db.register_model_files("embedding-model", files, R"({"base_model_path":"embed"})").has_value());
+  ASSERT_TRUE(db.create_semantic_space(make_semantic_space("alpha")).has_value());
+  const std::vector<DocumentChunk> chunks = {make_document_chunk("red apples", 101, 0, {1.0F, 0.0F}),
+                                             make_document_chunk("green pears", 102, 1, {0.0F, 1.0F}),
+                                             make_document_chunk("ripe plums", 103, 2, {1.0F, 1.0F})};
+  ASSERT_TRUE(db.add_document("doc-a", "doc-a", "alpha", "scope-a", chunks, {}).has_value());
+  ASSERT_TRUE(
+      db.add_document("doc-b", "doc-b", "alpha", "scope-b", {make_document_chunk("sour lemons", 104, 0, {0.5F, 1.0F})},
+                      {})
+          .has_value());
+
+  const std::string pack_path = this->temp_file_path("alpha.pack");
+  ASSERT_TRUE(db.export_knowledge_pack("alpha", pack_path, true).has_value());
+  expect_error(db.export_knowledge_pack("alpha", pack_path, true), OdaiResultEnum::ALREADY_EXISTS);
+  expect_error(db.export_knowledge_pack("missing-space", this->temp_file_path("missing.pack"), true),
+               OdaiResultEnum::NOT_FOUND);
+  // a file already at the path the pack is written to first is left alone
+  const std::string blocked_path = this->temp_file_path("blocked.pack");
+  std::ofstream(blocked_path + ".tmp") << "user file";
+  expect_error(db.export_knowledge_pack("alpha", blocked_path, true), OdaiResultEnum::ALREADY_EXISTS);
+  EXPECT_FALSE(std::filesystem::exists(blocked_path));
+  std::ifstream blocked_in(blocked_path + ".tmp");
+  EXPECT_EQ(std::string(std::istreambuf_iterator<char>(blocked_in), {}), "user file");
+
+  // the exported name is taken by the original space here
+  expect_error(db.import_knowledge_pack(pack_path, ""), OdaiResultEnum::ALREADY_EXISTS);
+  expect_error(db.import_knowledge_pack(this->temp_file_path("missing.pack"), "beta"), OdaiResultEnum::NOT_FOUND);
+  OdaiResult<SemanticSpaceConfig> imported = db.import_knowledge_pack(pack_path, "beta");
+  ASSERT_TRUE(imported.has_value());
+  EXPECT_EQ(imported->m_name, "beta");
+  EXPECT_EQ(imported->m_dimensions, 2U);
+  expect_error(db.import_knowledge_pack(pack_path, "beta"), OdaiResultEnum::ALREADY_EXISTS);
+  expect_error(db.create_semantic_space(make_semantic_space("beta")), OdaiResultEnum::ALREADY_EXISTS);
+
+  OdaiResult<std::vector<SemanticSpaceConfig>> spaces = db.list_semantic_spaces();
+  ASSERT_TRUE(spaces.has_value());
+  ASSERT_EQ(spaces->size(), 2U);
+  EXPECT_EQ(spaces->at(0).m_name, "alpha");
+  EXPECT_EQ(spaces->at(1).m_name, "beta");
+
+  auto keys = [](const OdaiResult<std::vector<RetrievedChunk>>& results)
+  {
+    std::vector<std::pair<std::string, uint32_t>> result;
+    for (const RetrievedChunk& chunk : results.value())
+    {
+      result.emplace_back(chunk.m_documentId, chunk.m_sequenceIndex);
+    }
+    return result;
+  };
+  OdaiResult<std::vector<RetrievedChunk>> expected = db.search_chunks("alpha", "scope-a", {1.0F, 0.2F}, 3, false, {});
+  ASSERT_TRUE(expected.has_value());
+  ASSERT_EQ(expected->size(), 3U);
+
+  // the original is independent of its pack
+  ASSERT_TRUE(db.delete_semantic_space("alpha").has_value());
+  OdaiResult<std::vector<RetrievedChunk>> results = db.search_chunks("beta", "scope-a", {1.0F, 0.2F}, 3, false, {});
+  ASSERT_TRUE(results.has_value());
+  EXPECT_EQ(keys(results), keys(expected));
+  OdaiResult<std::vector<RetrievedChunk>> keyword_results =
+      db.search_chunks_by_keywords("beta", "scope-b", "lemons", 3, {});
+  ASSERT_TRUE(keyword_results.has_value());
+  ASSERT_EQ(keyword_results->size(), 1U);
+  EXPECT_EQ(keyword_results->at(0).m_documentId, "doc-b");
+  OdaiResult<std::vector<std::vector<DocumentChunk>>> spans = db.get_document_chunk_spans("beta", {{"doc-a", 1, 2}});
+  ASSERT_TRUE(spans.has_value());
+  ASSERT_EQ(spans->at(0).size(), 2U);
+  EXPECT_EQ(spans->at(0).at(1).m_contentText, "ripe plums");
+
+  expect_error(db.add_document("doc-c", "doc-c", "beta", "scope-a", {make_document_chunk("new", 105, 0, {1.0F, 0.0F})},
+                               {}),
+               OdaiResultEnum::VALIDATION_FAILED);
+  expect_error(db.update_document("doc-a", "beta", "scope-a", chunks, {}), OdaiResultEnum::VALIDATION_FAILED);
+  expect_error(db.get_unembedded_chunk_hashes("beta", {101}), OdaiResultEnum::VALIDATION_FAILED);
+
+  // attached again on open
+  this->reopen_db();
+  IOdaiDb& reopened = this->initialized_db();
+  EXPECT_EQ(keys(reopened.search_chunks("beta", "scope-a", {1.0F, 0.2F}, 3, false, {})), keys(expected));
+
+  // deleting the space detaches the pack
+  ASSERT_TRUE(reopened.delete_semantic_space("beta").has_value());
+  expect_error(reopened.get_semantic_space_config("beta"), OdaiResultEnum::NOT_FOUND);
+  expect_error(reopened.search_chunks("beta", "scope-a", {1.0F, 0.2F}, 3, false, {}), OdaiResultEnum::NOT_FOUND);
+
+  // the pack is only attached next to the model files it was embedded with
+  ASSERT_TRUE(reopened.update_model_files("embedding-model", files, R"({"base_model_path":"other"})").has_value());
+  expect_error(reopened.import_knowledge_pack(pack_path, "beta"), OdaiResultEnum::VALIDATION_FAILED);
+}
+
 TYPED_TEST_P(IOdaiDbContractTest, StoreMediaItemLeavesTextMemoryBufferUnchangedAndPreservesMimeCase)
 {
   IOdaiDb& db = this->initialized_db();
@@ -323,6 +1111,26 @@ REGISTER_TYPED_TEST_SUITE_P(IOdaiDbContractTest, AllMethodsReturnNotInitializedB
                             UpdateModelFilesReplacesStoredRecord, ModelFileLookupsReturnNotFoundForMissingModel,
                             SemanticSpacesCanBeCreatedListedReadAndDeleted,
                             SemanticSpacesReportDuplicateAndMissingErrors, ListSemanticSpacesReturnsEmptyWhenNoneExist,
+                            AddDocumentMarksStoredChunksAsEmbedded,
+                            AddDocumentReusesEmbeddingOfExistingContentAcrossScopes,
+                            StoredChunkEmbeddingsAreKeyedByContentAndModelChecksums,
+                            AddDocumentReportsDuplicateMissingAndValidationErrors,
+                            AddDocumentRollsBackWhenOneChunkCannotBeEmbedded,
+                            AppendDocumentChunksExtendsDocumentInItsSpaceAndScope,
+                            AppendDocumentChunksReportsMissingDuplicateAndValidationErrors,
+                            UpdateDocumentReusesUnchangedChunksAndDropsRemovedOnes,
+                            UpdateDocumentReportsMissingDocumentAndKeepsOldVersionOnFailure,
+                            DeleteDocumentRemovesChunksNoOtherDocumentReferences,
+                            ReembeddingServesOldVectorsUntilFinishedThenSwitches,
+                            ReembeddingReportsInvalidJobsAndCanBeCancelled,
+                            ReembeddingProgressSurvivesCloseAndReopen,
+                            SearchChunksReturnsNearestChunksOfTheScopeOnly,
+                            SearchChunksReportsMissingSpaceAndInvalidQuery,
+                            SearchChunksByKeywordsRanksMatchingChunksOfTheScopeOnly,
+                            SearchChunksByKeywordsTakesQuerySyntaxLiterallyAndReportsErrors,
+                            SearchesOnlyReturnChunksOfDocumentsMatchingTheMetadataFilter,
+                            GetDocumentChunkSpansReadsOrderedRangesOfDocuments,
+                            KnowledgePacksAreExportedAndAttachedAsReadOnlySpaces,
                             StoreMediaItemLeavesTextMemoryBufferUnchangedAndPreservesMimeCase,
                             StoreMediaItemCachesBinaryMemoryBufferAndDeduplicates,
                             StoreMediaItemCachesSourceFileAndDeduplicates,
@@ -3,8 +3,11 @@
 #include "db/odai_db.h"
 #include "odai_test_helpers.h"
 
+#include <chrono>
+#include <cmath>
 #include <cstdint>
 #include <filesystem>
+#include <random>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -36,10 +39,21 @@ inline SemanticSpaceConfig make_semantic_space(const std::string& name)
   fixed_config.m_chunkSize = 256;
   fixed_config.m_chunkOverlap = 32;
   config.m_chunkingConfig.m_config = fixed_config;
-  config.m_dimensions = 384;
+  config.m_dimensions = 2;
   return config;
 }
 
+inline DocumentChunk make_document_chunk(const std::string& text, uint64_t content_hash, uint32_t sequence_index,
+                                         std::vector<float> embedding)
+{
+  DocumentChunk chunk{};
+  chunk.m_contentText = text;
+  chunk.m_contentHash = content_hash;
+  chunk.m_sequenceIndex = sequence_index;
+  chunk.m_embedding = std::move(embedding);
+  return chunk;
+}
+
 inline ChatConfig make_chat_config()
 {
   ChatConfig config{};
@@ -62,4 +76,75 @@ inline ChatMessage make_chat_message(const std::string& role, const std::string&
   message.m_messageMetadata = {{"source", role}};
   return message;
 }
+
+/// Temporary directory holding a database file and its media directory, removed with everything in it when destroyed.
+/// Declare it before the database using it, so the database is closed first.
+class TempDbDirectory
+{
+public:
+  explicit TempDbDirectory(const std::string& prefix)
+      : m_rootPath(fs::temp_directory_path() /
+                   (prefix + "_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + "_" +
+                    std::to_string(reinterpret_cast<std::uintptr_t>(this))))
+  {
+    fs::create_directories(m_rootPath / "media");
+  }
+
+  ~TempDbDirectory()
+  {
+    std::error_code ec;
+    fs::remove_all(m_rootPath, ec);
+  }
+
+  TempDbDirectory(const TempDbDirectory&) = delete;
+  TempDbDirectory& operator=(const TempDbDirectory&) = delete;
+
+  const fs::path& path() const { return m_rootPath; }
+
+  DBConfig db_config(DBType type = SQLITE_DB) const
+  {
+    return {type, (m_rootPath / "odai.db").string(), (m_rootPath / "media").string()};
+  }
+
+private:
+  const fs::path m_rootPath;
+};
+
+/// Unit vectors spread around random topic centroids, like embeddings of documents about a limited set of subjects
+inline std::vector<std::vector<float>> make_clustered_vectors(size_t count, uint32_t dimensions, size_t clusters,
+                                                              float spread, uint64_t seed)
+{
+  std::mt19937_64 generator(seed);
+  std::normal_distribution<float> normal(0.0F, 1.0F);
+  std::vector<std::vector<float>> centroids(clusters, std::vector<float>(dimensions));
+  for (std::vector<float>& centroid : centroids)
+  {
+    for (float& value : centroid)
+    {
+      value = normal(generator);
+    }
+  }
+
+  std::vector<std::vector<float>> vectors(count, std::vector<float>(dimensions));
+  for (std::vector<float>& vector : vectors)
+  {
+    const std::vector<float>& centroid = centroids[generator() % clusters];
+    float norm = 0.0F;
+    for (uint32_t d = 0; d < dimensions; ++d)
+    {
+      vector[d] = centroid[d] + spread * normal(generator);
+      norm += vector[d] * vector[d];
+    }
+    for (float& value : vector)
+    {
+      value /= std::sqrt(norm);
+    }
+  }
+  return vectors;
+}
+
+inline double seconds_since(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
 } // namespace odai::test::db_contract
@@ -0,0 +1,118 @@
+#include "db/odai_hnsw_index.h"
+
+#include "odai_db_test_helpers.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using odai::test::db_contract::make_clustered_vectors;
+using odai::test::db_contract::seconds_since;
+using odai::test::db_contract::TempDbDirectory;
+
+namespace
+{
+constexpr size_t BENCHMARK_VECTORS = 20000;
+constexpr uint32_t BENCHMARK_DIMENSIONS = 128;
+constexpr size_t BENCHMARK_QUERIES = 200;
+constexpr uint32_t BENCHMARK_K = 10;
+constexpr size_t BENCHMARK_CLUSTERS = 100;
+constexpr float BENCHMARK_CLUSTER_SPREAD = 0.75F;
+/// Search candidate list sizes to measure, search settings apply to a saved index without rebuilding it
+constexpr uint32_t BENCHMARK_EF_SEARCH[] = {16, 32, 64, 128, 256};
+
+/// Exact scan, the flat search every semantic space falls back to
+std::vector<int64_t> brute_force_nearest(const std::vector<std::vector<float>>& vectors,
+                                         const std::vector<float>& query)
+{
+  std::vector<std::pair<float, int64_t>> scored(vectors.size());
+  for (size_t i = 0; i < vectors.size(); ++i)
+  {
+    float dot = 0.0F;
+    for (uint32_t d = 0; d < BENCHMARK_DIMENSIONS; ++d)
+    {
+      dot += vectors[i][d] * query[d];
+    }
+    scored[i] = {-dot, static_cast<int64_t>(i + 1)};
+  }
+  std::partial_sort(scored.begin(), scored.begin() + BENCHMARK_K, scored.end());
+
+  std::vector<int64_t> rowids;
+  for (uint32_t i = 0; i < BENCHMARK_K; ++i)
+  {
+    rowids.push_back(scored[i].second);
+  }
+  return rowids;
+}
+} // namespace
+
+TEST(OdaiHnswIndexBenchmark, RecallAndLatencyAgainstExactScan)
+{
+  const std::vector<std::vector<float>> vectors =
+      make_clustered_vectors(BENCHMARK_VECTORS, BENCHMARK_DIMENSIONS, BENCHMARK_CLUSTERS, BENCHMARK_CLUSTER_SPREAD, 1);
+  const std::vector<std::vector<float>> queries =
+      make_clustered_vectors(BENCHMARK_QUERIES, BENCHMARK_DIMENSIONS, BENCHMARK_CLUSTERS, BENCHMARK_CLUSTER_SPREAD, 2);
+
+  VectorIndexConfig config{};
+  config.m_indexType = VECTOR_INDEX_HNSW;
+
+  auto start = std::chrono::steady_clock::now();
+  OdaiHnswIndex index(BENCHMARK_DIMENSIONS, config);
+  for (size_t i = 0; i < vectors.size(); ++i)
+  {
+    ASSERT_TRUE(index.add(static_cast<int64_t>(i + 1), "scope", vectors[i]).has_value());
+  }
+  const double build_seconds = seconds_since(start);
+
+  const TempDbDirectory directory("odai_hnsw_index_benchmark");
+  const std::filesystem::path index_path = directory.path() / "index.hnsw";
+  ASSERT_TRUE(index.save(index_path).has_value());
+
+  std::vector<std::vector<int64_t>> expected;
+  start = std::chrono::steady_clock::now();
+  for (const std::vector<float>& query : queries)
+  {
+    expected.push_back(brute_force_nearest(vectors, query));
+  }
+  const double exact_ms = seconds_since(start) * 1000.0 / static_cast<double>(queries.size());
+  std::cout << "[ BENCHMARK ] " << BENCHMARK_VECTORS << " x " << BENCHMARK_DIMENSIONS << " vectors, build: "
+            << build_seconds << " s, exact scan query: " << exact_ms << " ms\n";
+  RecordProperty("exact_query_ms", std::to_string(exact_ms));
+
+  double best_recall = 0.0;
+  for (const uint32_t ef_search : BENCHMARK_EF_SEARCH)
+  {
+    config.m_hnswEfSearch = ef_search;
+    start = std::chrono::steady_clock::now();
+    auto load_res = OdaiHnswIndex::load(index_path, config);
+    const double load_ms = seconds_since(start) * 1000.0;
+    ASSERT_TRUE(load_res.has_value());
+
+    // searches the mapped index, as a reopened database does
+    size_t found = 0;
+    start = std::chrono::steady_clock::now();
+    for (size_t q = 0; q < queries.size(); ++q)
+    {
+      for (const OdaiHnswIndex::SearchHit& hit : load_res.value()->search(queries[q], "scope", BENCHMARK_K))
+      {
+        found += std::count(expected[q].begin(), expected[q].end(), hit.m_vectorRowid);
+      }
+    }
+    const double hnsw_ms = seconds_since(start) * 1000.0 / static_cast<double>(queries.size());
+    const double recall = static_cast<double>(found) / static_cast<double>(queries.size() * BENCHMARK_K);
+    best_recall = std::max(best_recall, recall);
+
+    RecordProperty("recall_at_10_ef_" + std::to_string(ef_search), std::to_string(recall));
+    RecordProperty("hnsw_query_ms_ef_" + std::to_string(ef_search), std::to_string(hnsw_ms));
+    std::cout << "[ BENCHMARK ] ef search " << ef_search << ", load: " << load_ms << " ms, recall@" << BENCHMARK_K
+              << ": " << recall << ", query: " << hnsw_ms << " ms\n";
+  }
+
+  EXPECT_GT(best_recall, 0.9);
+}
@@ -0,0 +1,411 @@
+#include "db/odai_hnsw_index.h"
+
+#include "odai_test_helpers.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace fs = std::filesystem;
+using odai::test::expect_error;
+
+namespace
+{
+VectorIndexConfig make_hnsw_config()
+{
+  VectorIndexConfig config{};
+  config.m_indexType = VECTOR_INDEX_HNSW;
+  return config;
+}
+
+std::vector<std::vector<float>> make_random_vectors(size_t count, uint32_t dimensions, uint64_t seed)
+{
+  std::mt19937_64 generator(seed);
+  std::normal_distribution<float> normal(0.0F, 1.0F);
+  std::vector<std::vector<float>> vectors(count, std::vector<float>(dimensions));
+  for (std::vector<float>& vector : vectors)
+  {
+    for (float& value : vector)
+    {
+      value = normal(generator);
+    }
+  }
+  return vectors;
+}
+
+std::vector<int64_t> hit_rowids(const std::vector<OdaiHnswIndex::SearchHit>& hits)
+{
+  std::vector<int64_t> rowids;
+  rowids.reserve(hits.size());
+  for (const OdaiHnswIndex::SearchHit& hit : hits)
+  {
+    rowids.push_back(hit.m_vectorRowid);
+  }
+  return rowids;
+}
+
+/// Rowids (1 based positions) of the k vectors with the highest cosine similarity to the query.
+std::vector<int64_t> exact_nearest(const std::vector<std::vector<float>>& vectors, const std::vector<float>& query,
+                                   size_t k)
+{
+  auto cosine = [](const std::vector<float>& a, const std::vector<float>& b)
+  {
+    double dot = 0.0;
+    double norm_a = 0.0;
+    double norm_b = 0.0;
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+      dot += static_cast<double>(a[i]) * b[i];
+      norm_a += static_cast<double>(a[i]) * a[i];
+      norm_b += static_cast<double>(b[i]) * b[i];
+    }
+    return dot / std::sqrt(norm_a * norm_b);
+  };
+
+  std::vector<std::pair<double, int64_t>> scored;
+  scored.reserve(vectors.size());
+  for (size_t i = 0; i < vectors.size(); ++i)
+  {
+    scored.emplace_back(-cosine(vectors[i], query), static_cast<int64_t>(i + 1));
+  }
+  std::partial_sort(scored.begin(), scored.begin() + static_cast<std::ptrdiff_t>(k), scored.end());
+
+  std::vector<int64_t> rowids;
+  for (size_t i = 0; i < k; ++i)
+  {
+    rowids.push_back(scored[i].second);
+  }
+  return rowids;
+}
+
+class OdaiHnswIndexTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    const auto suffix = std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + "_" +
+                        std::to_string(reinterpret_cast<std::uintptr_t>(this));
+    m_rootPath = fs::temp_directory_path() / ("odai_hnsw_index_test_" + suffix);
+    fs::create_directories(m_rootPath);
+  }
+
+  void TearDown() override
+  {
+    std::error_code ec;
+    fs::remove_all(m_rootPath, ec);
+  }
+
+  fs::path index_path() const { return m_rootPath / "index.hnsw"; }
+
+  fs::path m_rootPath;
+};
+} // namespace
+
+TEST_F(OdaiHnswIndexTest, SearchReturnsNearestVectorsInOrder)
+{
+  OdaiHnswIndex index(3, make_hnsw_config());
+  ASSERT_TRUE(index.add(1, "scope", {1.0F, 0.0F, 0.0F}).has_value());
+  ASSERT_TRUE(index.add(2, "scope", {0.0F, 1.0F, 0.0F}).has_value());
+  ASSERT_TRUE(index.add(3, "scope", {0.0F, 0.0F, 1.0F}).has_value());
+  ASSERT_TRUE(index.add(4, "scope", {2.0F, 2.0F, 0.0F}).has_value());
+
+  const std::vector<OdaiHnswIndex::SearchHit> hits = index.search({3.0F, 1.0F, 0.0F}, "scope", 3);
+
+  EXPECT_EQ(hit_rowids(hits), (std::vector<int64_t>{1, 4, 2}));
+  ASSERT_EQ(hits.size(), 3U);
+  EXPECT_LT(hits[0].m_distance, hits[1].m_distance);
+  EXPECT_LT(hits[1].m_distance, hits[2].m_distance);
+  EXPECT_EQ(index.size(), 4U);
+  EXPECT_EQ(index.max_rowid(), 4);
+}
+
+TEST_F(OdaiHnswIndexTest, SearchFindsTheExactNeighboursOfASmallIndex)
+{
+  const std::vector<std::vector<float>> vectors = make_random_vectors(1000, 16, 7);
+  OdaiHnswIndex index(16, make_hnsw_config());
+  for (size_t i = 0; i < vectors.size(); ++i)
+  {
+    ASSERT_TRUE(index.add(static_cast<int64_t>(i + 1), "scope", vectors[i]).has_value());
+  }
+
+  size_t found = 0;
+  const std::vector<std::vector<float>> queries = make_random_vectors(20, 16, 11);
+  for (const std::vector<float>& query : queries)
+  {
+    const std::vector<int64_t> expected = exact_nearest(vectors, query, 10);
+    const std::vector<int64_t> actual = hit_rowids(index.search(query, "scope", 10));
+    for (int64_t rowid : actual)
+    {
+      found += std::count(expected.begin(), expected.end(), rowid);
+    }
+  }
+
+  // ef search is well above the index size's needs, the graph search should be practically exact
+  EXPECT_GE(found, queries.size() * 10 * 98 / 100);
+}
+
+TEST_F(OdaiHnswIndexTest, SearchOnlyReturnsVectorsOfTheRequestedScope)
+{
+  const std::vector<std::vector<float>> vectors = make_random_vectors(300, 8, 3);
+  OdaiHnswIndex index(8, make_hnsw_config());
+  for (size_t i = 0; i < vectors.size(); ++i)
+  {
+    ASSERT_TRUE(index.add(static_cast<int64_t>(i + 1), i % 3 == 0 ? "rare" : "common", vectors[i]).has_value());
+  }
+
+  const std::vector<OdaiHnswIndex::SearchHit> hits = index.search(vectors[1], "rare", 20);
+
+  ASSERT_EQ(hits.size(), 20U);
+  for (const OdaiHnswIndex::SearchHit& hit : hits)
+  {
+    EXPECT_EQ((hit.m_vectorRowid - 1) % 3, 0) << "rowid " << hit.m_vectorRowid << " is not in the rare scope";
+  }
+  EXPECT_TRUE(index.search(vectors[1], "missing", 20).empty());
+}
+
+TEST_F(OdaiHnswIndexTest, DeletedVectorsAreWalkedThroughButNeverReturned)
+{
+  const std::vector<std::vector<float>> vectors = make_random_vectors(1000, 16, 17);
+  OdaiHnswIndex index(16, make_hnsw_config());
+  for (size_t i = 0; i < vectors.size(); ++i)
+  {
+    ASSERT_TRUE(index.add(static_cast<int64_t>(i + 1), "scope", vectors[i]).has_value());
+  }
+
+  // even rowids up to 400 are removed, a fifth of the nodes stays under the rebuild threshold
+  std::vector<std::vector<float>> kept_vectors;
+  std::vector<int64_t> kept_rowids;
+  for (size_t i = 0; i < vectors.size(); ++i)
+  {
+    const auto rowid = static_cast<int64_t>(i + 1);
+    if (rowid % 2 == 0 && rowid <= 400)
+    {
+      EXPECT_TRUE(index.mark_deleted(rowid));
+      continue;
+    }
+    kept_vectors.push_back(vectors[i]);
+    kept_rowids.push_back(rowid);
+  }
+  EXPECT_FALSE(index.mark_deleted(2));
+  EXPECT_FALSE(index.mark_deleted(5000));
+  EXPECT_EQ(index.size(), 800U);
+  EXPECT_EQ(index.deleted_count(), 200U);
+  EXPECT_FALSE(index.needs_rebuild());
+
+  size_t found = 0;
+  const std::vector<std::vector<float>> queries = make_random_vectors(20, 16, 19);
+  for (const std::vector<float>& query : queries)
+  {
+    std::vector<int64_t> expected;
+    for (int64_t position : exact_nearest(kept_vectors, query, 10))
+    {
+      expected.push_back(kept_rowids[static_cast<size_t>(position - 1)]);
+    }
+    for (int64_t rowid : hit_rowids(index.search(query, "scope", 10)))
+    {
+      EXPECT_FALSE(rowid % 2 == 0 && rowid <= 400) << "deleted rowid " << rowid << " returned";
+      found += std::count(expected.begin(), expected.end(), rowid);
+    }
+  }
+  EXPECT_GE(found, queries.size() * 10 * 98 / 100);
+
+  // the marks are saved with the graph
+  ASSERT_TRUE(index.save(index_path()).has_value());
+  auto load_res = OdaiHnswIndex::load(index_path(), make_hnsw_config());
+  ASSERT_TRUE(load_res.has_value());
+  OdaiHnswIndex& loaded = *load_res.value();
+  EXPECT_EQ(loaded.size(), 800U);
+  EXPECT_EQ(loaded.deleted_count(), 200U);
+  for (const std::vector<float>& query : queries)
+  {
+    EXPECT_EQ(hit_rowids(loaded.search(query, "scope", 10)), hit_rowids(index.search(query, "scope", 10)));
+  }
+
+  // a loaded index catches up with vectors removed since it was saved, past a quarter deleted it wants a rebuild
+  std::vector<int64_t> still_stored(kept_rowids.begin() + 100, kept_rowids.end());
+  OdaiResult<size_t> retained = loaded.retain_only(still_stored);
+  ASSERT_TRUE(retained.has_value());
+  EXPECT_EQ(retained.value(), 100U);
+  EXPECT_EQ(loaded.size(), 700U);
+  EXPECT_TRUE(loaded.needs_rebuild());
+
+  // a stored vector the index has no live node for means the index belongs to other vectors
+  still_stored.insert(still_stored.begin(), 2);
+  expect_error(loaded.retain_only(still_stored), OdaiResultEnum::VALIDATION_FAILED);
+}
+
+TEST_F(OdaiHnswIndexTest, AddRejectsWrongDimensionAndRowidsOutOfOrder)
+{
+  OdaiHnswIndex index(2, make_hnsw_config());
+  ASSERT_TRUE(index.add(5, "scope", {1.0F, 0.0F}).has_value());
+
+  expect_error(index.add(6, "scope", {1.0F, 0.0F, 0.0F}), OdaiResultEnum::VALIDATION_FAILED);
+  expect_error(index.add(5, "scope", {0.0F, 1.0F}), OdaiResultEnum::VALIDATION_FAILED);
+  expect_error(index.add(4, "scope", {0.0F, 1.0F}), OdaiResultEnum::VALIDATION_FAILED);
+  EXPECT_EQ(index.size(), 1U);
+  EXPECT_EQ(index.max_rowid(), 5);
+}
+
+TEST_F(OdaiHnswIndexTest, SavedIndexLoadsWithIdenticalResultsAndAcceptsNewVectors)
+{
+  const std::vector<std::vector<float>> vectors = make_random_vectors(500, 12, 5);
+  OdaiHnswIndex index(12, make_hnsw_config());
+  for (size_t i = 0; i < vectors.size(); ++i)
+  {
+    ASSERT_TRUE(index.add(static_cast<int64_t>(i + 1), i % 2 == 0 ? "even" : "odd", vectors[i]).has_value());
+  }
+  EXPECT_TRUE(index.is_dirty());
+  ASSERT_TRUE(index.save(index_path()).has_value());
+  EXPECT_FALSE(index.is_dirty());
+
+  auto load_res = OdaiHnswIndex::load(index_path(), make_hnsw_config());
+  ASSERT_TRUE(load_res.has_value());
+  OdaiHnswIndex& loaded = *load_res.value();
+  EXPECT_EQ(loaded.size(), index.size());
+  EXPECT_EQ(loaded.dimensions(), 12U);
+  EXPECT_EQ(loaded.max_rowid(), 500);
+  EXPECT_FALSE(loaded.is_dirty());
+
+  for (const std::vector<float>& query : make_random_vectors(10, 12, 9))
+  {
+    EXPECT_EQ(hit_rowids(loaded.search(query, "even", 10)), hit_rowids(index.search(query, "even", 10)));
+    EXPECT_EQ(hit_rowids(loaded.search(query, "odd", 10)), hit_rowids(index.search(query, "odd", 10)));
+  }
+
+  // inserting into a mapped index copies it into memory first
+  const std::vector<float> added = {1.0F, 2.0F, 3.0F, 4.0F, 5.0F, 6.0F, 7.0F, 8.0F, 9.0F, 10.0F, 11.0F, 12.0F};
+  ASSERT_TRUE(loaded.add(501, "new", added).has_value());
+  EXPECT_TRUE(loaded.is_dirty());
+  EXPECT_EQ(hit_rowids(loaded.search(added, "new", 10)), (std::vector<int64_t>{501}));
+  ASSERT_TRUE(loaded.save(index_path()).has_value());
+
+  auto reloaded = OdaiHnswIndex::load(index_path(), make_hnsw_config());
+  ASSERT_TRUE(reloaded.has_value());
+  EXPECT_EQ(reloaded.value()->size(), 501U);
+  EXPECT_EQ(hit_rowids(reloaded.value()->search(added, "new", 10)), (std::vector<int64_t>{501}));
+}
+
+TEST_F(OdaiHnswIndexTest, LoadRejectsMissingCorruptAndMismatchedFiles)
+{
+  expect_error(OdaiHnswIndex::load(index_path(), make_hnsw_config()), OdaiResultEnum::NOT_FOUND);
+
+  OdaiHnswIndex index(4, make_hnsw_config());
+  ASSERT_TRUE(index.add(1, "scope", {1.0F, 2.0F, 3.0F, 4.0F}).has_value());
+  ASSERT_TRUE(index.save(index_path()).has_value());
+
+  VectorIndexConfig other_graph = make_hnsw_config();
+  other_graph.m_hnswMaxConnections = 8;
+  expect_error(OdaiHnswIndex::load(index_path(), other_graph), OdaiResultEnum::VALIDATION_FAILED);
+
+  // search settings aren't part of the graph, changing them keeps the saved index usable
+  VectorIndexConfig other_search = make_hnsw_config();
+  other_search.m_hnswEfSearch = 16;
+  EXPECT_TRUE(OdaiHnswIndex::load(index_path(), other_search).has_value());
+
+  fs::resize_file(index_path(), fs::file_size(index_path()) - 1);
+  expect_error(OdaiHnswIndex::load(index_path(), make_hnsw_config()), OdaiResultEnum::VALIDATION_FAILED);
+
+  std::ofstream(index_path(), std::ios::binary | std::ios::trunc) << "not an index file, just some text";
+  expect_error(OdaiHnswIndex::load(index_path(), make_hnsw_config()), OdaiResultEnum::VALIDATION_FAILED);
+}
+
+TEST_F(OdaiHnswIndexTest, LoadRejectsGraphsReachingOutsideTheirArrays)
+{
+  constexpr uint32_t DIMENSIONS = 4;
+  constexpr size_t COUNT = 3;
+  OdaiHnswIndex index(DIMENSIONS, make_hnsw_config());
+  const std::vector<std::vector<float>> vectors = make_random_vectors(COUNT, DIMENSIONS, 21);
+  for (size_t i = 0; i < COUNT; ++i)
+  {
+    ASSERT_TRUE(index.add(static_cast<int64_t>(i + 1), "scope", vectors[i]).has_value());
+  }
+  ASSERT_TRUE(index.save(index_path()).has_value());
+  std::string saved;
+  {
+    std::ifstream in(index_path(), std::ios::binary);
+    saved.assign(std::istreambuf_iterator<char>(in), {});
+  }
+
+  // section offsets of a file holding COUNT nodes, mirroring the layout written by save()
+  auto align = [](size_t offset) { return (offset + 63) / 64 * 64; };
+  const size_t max_links_level0 = 2 * DEFAULT_HNSW_MAX_CONNECTIONS;
+  const size_t rowids = align(128 + COUNT * DIMENSIONS * sizeof(float));
+  const size_t node_scopes = align(rowids + COUNT * sizeof(int64_t));
+  const size_t levels = align(node_scopes + COUNT * sizeof(uint32_t));
+  const size_t level0_links = align(levels + COUNT * sizeof(uint32_t));
+  const size_t upper_link_offsets = align(level0_links + COUNT * (max_links_level0 + 1) * sizeof(uint32_t));
+
+  // the file size and header stay valid, only the graph is wrong: more links than a list holds, a link past the last
+  // node, a scope past the scope table, a level without upper link blocks, upper link blocks past the end
+  const std::vector<std::pair<size_t, uint32_t>> corruptions = {
+      {level0_links, static_cast<uint32_t>(max_links_level0 + 1)},
+      {level0_links + sizeof(uint32_t), static_cast<uint32_t>(COUNT)},
+      {node_scopes, 1U},
+      {levels, 5U},
+      {upper_link_offsets, UINT32_MAX}};
+  ASSERT_TRUE(OdaiHnswIndex::load(index_path(), make_hnsw_config()).has_value());
+  for (const auto& [offset, value] : corruptions)
+  {
+    std::string corrupt = saved;
+    std::memcpy(corrupt.data() + offset, &value, sizeof(value));
+    std::ofstream(index_path(), std::ios::binary | std::ios::trunc) << corrupt;
+    expect_error(OdaiHnswIndex::load(index_path(), make_hnsw_config()), OdaiResultEnum::VALIDATION_FAILED);
+  }
+}
+
+TEST_F(OdaiHnswIndexTest, IndexAppendedToAnotherFileLoadsAtItsOffset)
+{
+  const std::vector<std::vector<float>> vectors = make_random_vectors(200, 8, 3);
+  OdaiHnswIndex index(8, make_hnsw_config());
+  for (size_t i = 0; i < vectors.size(); ++i)
+  {
+    ASSERT_TRUE(index.add(static_cast<int64_t>(i + 1), "scope", vectors[i]).has_value());
+  }
+  const fs::path saved_path = m_rootPath / "saved.hnsw";
+  ASSERT_TRUE(index.save(saved_path).has_value());
+
+  // a knowledge pack puts the index after its database pages
+  constexpr uint64_t PREFIX_SIZE = 4096;
+  {
+    std::ofstream out(index_path(), std::ios::binary);
+    out << std::string(PREFIX_SIZE, 'x');
+    std::ifstream in(saved_path, std::ios::binary);
+    out << in.rdbuf();
+  }
+
+  auto load_res = OdaiHnswIndex::load(index_path(), make_hnsw_config(), PREFIX_SIZE);
+  ASSERT_TRUE(load_res.has_value());
+  for (const std::vector<float>& query : make_random_vectors(5, 8, 4))
+  {
+    EXPECT_EQ(hit_rowids(load_res.value()->search(query, "scope", 10)), hit_rowids(index.search(query, "scope", 10)));
+  }
+
+  expect_error(OdaiHnswIndex::load(index_path(), make_hnsw_config(), PREFIX_SIZE + 8),
+               OdaiResultEnum::VALIDATION_FAILED);
+  expect_error(OdaiHnswIndex::load(index_path(), make_hnsw_config(), fs::file_size(index_path())),
+               OdaiResultEnum::NOT_FOUND);
+}
+
+TEST_F(OdaiHnswIndexTest, PrefersGraphSearchOnlyForLargeScopes)
+{
+  const std::vector<std::vector<float>> vectors = make_random_vectors(4200, 4, 13);
+  OdaiHnswIndex index(4, make_hnsw_config());
+  for (size_t i = 0; i < vectors.size(); ++i)
+  {
+    ASSERT_TRUE(index.add(static_cast<int64_t>(i + 1), i < 100 ? "small" : "large", vectors[i]).has_value());
+  }
+
+  EXPECT_TRUE(index.prefers_graph_search("large"));
+  EXPECT_FALSE(index.prefers_graph_search("small"));
+  EXPECT_FALSE(index.prefers_graph_search("missing"));
+}
@@ -60,6 +60,8 @@ protected:
     ASSERT_TRUE(m_db->initialize_db().has_value());
   }
 
+  std::string temp_file_path(const std::string& file_name) const { return (m_rootPath / file_name).string(); }
+
   InputItem make_source_file_item(const std::string& file_name, const std::string& contents,
                                   const std::string& mime_type)
   {
@@ -7,6 +7,8 @@
 #include <filesystem>
 #include <fstream>
 #include <memory>
+#include <optional>
+#include <random>
 #include <string>
 #include <vector>
 
@@ -19,6 +21,7 @@ using odai::test::string_to_bytes;
 using odai::test::db_contract::expect_error;
 using odai::test::db_contract::make_chat_config;
 using odai::test::db_contract::make_chat_message;
+using odai::test::db_contract::make_document_chunk;
 using odai::test::db_contract::make_model_files;
 using odai::test::db_contract::make_semantic_space;
 
@@ -36,6 +39,65 @@ std::string read_stored_model_type(const DBConfig& db_config, const ModelName& n
   return query.getColumn("type").getString();
 }
 
+int64_t count_rows(const DBConfig& db_config, const std::string& table)
+{
+  SQLite::Database db(db_config.m_dbPath, SQLite::OPEN_READONLY);
+  SQLite::Statement query(db, "SELECT COUNT(*) AS row_count FROM " + table);
+  query.executeStep();
+  return query.getColumn("row_count").getInt64();
+}
+
+std::optional<int64_t> read_chunk_token_count(const DBConfig& db_config, uint64_t content_hash)
+{
+  SQLite::Database db(db_config.m_dbPath, SQLite::OPEN_READONLY);
+  SQLite::Statement query(db, "SELECT token_count FROM chunk WHERE content_hash = :content_hash");
+  query.bind(":content_hash", static_cast<int64_t>(content_hash));
+  if (!query.executeStep() || query.getColumn("token_count").isNull())
+  {
+    return std::nullopt;
+  }
+  return query.getColumn("token_count").getInt64();
+}
+
+bool table_exists(const DBConfig& db_config, const std::string& table_name)
+{
+  SQLite::Database db(db_config.m_dbPath, SQLite::OPEN_READONLY);
+  return db.tableExists(table_name);
+}
+
+/// Deterministic pseudo random chunks, enough of them for an HNSW space to search its graph
+std::vector<DocumentChunk> make_random_chunks(size_t count, uint32_t dimensions, uint64_t first_content_hash)
+{
+  std::mt19937_64 generator(first_content_hash);
+  std::normal_distribution<float> normal(0.0F, 1.0F);
+  std::vector<DocumentChunk> chunks;
+  chunks.reserve(count);
+  for (size_t i = 0; i < count; ++i)
+  {
+    std::vector<float> embedding(dimensions);
+    for (float& value : embedding)
+    {
+      value = normal(generator);
+    }
+    chunks.push_back(make_document_chunk("chunk-" + std::to_string(first_content_hash + i), first_content_hash + i,
+                                         static_cast<uint32_t>(i), std::move(embedding)));
+  }
+  return chunks;
+}
+
+std::vector<uint32_t> retrieved_sequence_indexes(const OdaiResult<std::vector<RetrievedChunk>>& results)
+{
+  std::vector<uint32_t> indexes;
+  if (results.has_value())
+  {
+    for (const RetrievedChunk& chunk : results.value())
+    {
+      indexes.push_back(chunk.m_sequenceIndex);
+    }
+  }
+  return indexes;
+}
+
 class OdaiSqliteDbTest : public ::testing::Test
 {
 protected:
@@ -145,6 +207,20 @@ TEST_F(OdaiSqliteDbTest, RegisterEmbeddingModelFilesPersistsSqliteType)
   EXPECT_EQ(read_stored_model_type(db_config(), "embed-model"), "EMBEDDING");
 }
 
+TEST_F(OdaiSqliteDbTest, RegisterRerankerModelFilesPersistsSqliteType)
+{
+  OdaiSqliteDb& db = initialized_db();
+  const ModelFiles files = make_model_files(ModelType::RERANKER, {{"base_model_path", "/tmp/rerank.gguf"}});
+  const std::string checksums = R"({"base_model_path":"rerank_hash"})";
+
+  ASSERT_TRUE(db.register_model_files("rerank-model", files, checksums).has_value());
+
+  OdaiResult<ModelFiles> loaded = db.get_model_files("rerank-model");
+  ASSERT_TRUE(loaded.has_value());
+  EXPECT_EQ(loaded->m_modelType, ModelType::RERANKER);
+  EXPECT_EQ(read_stored_model_type(db_config(), "rerank-model"), "RERANKER");
+}
+
 TEST_F(OdaiSqliteDbTest, UpdateModelFilesReplacesStoredSqliteType)
 {
   OdaiSqliteDb& db = initialized_db();
@@ -223,6 +299,595 @@ TEST_F(OdaiSqliteDbTest, CreateSemanticSpaceRejectsEmptyName)
   expect_error(db.create_semantic_space(invalid_space), OdaiResultEnum::VALIDATION_FAILED);
 }
 
+TEST_F(OdaiSqliteDbTest, SemanticSpaceOwnsItsVectorTable)
+{
+  OdaiSqliteDb& db = initialized_db();
+  ASSERT_TRUE(db.create_semantic_space(make_semantic_space("alpha")).has_value());
+  EXPECT_TRUE(table_exists(db_config(), "vec_space_1"));
+
+  // without dimensions the table waits for the first embeddings
+  SemanticSpaceConfig lazy_space = make_semantic_space("lazy");
+  lazy_space.m_dimensions = 0;
+  ASSERT_TRUE(db.create_semantic_space(lazy_space).has_value());
+  EXPECT_FALSE(table_exists(db_config(), "vec_space_2"));
+  ASSERT_TRUE(
+      db.add_document("doc-a", "doc-a", "lazy", "scope-a", {make_document_chunk("first", 1, 0, {1.0F, 0.0F, 0.0F})}, {})
+          .has_value());
+  EXPECT_TRUE(table_exists(db_config(), "vec_space_2"));
+
+  // a failed creation leaves no table behind
+  expect_error(db.create_semantic_space(make_semantic_space("alpha")), OdaiResultEnum::ALREADY_EXISTS);
+  EXPECT_FALSE(table_exists(db_config(), "vec_space_3"));
+
+  ASSERT_TRUE(db.delete_semantic_space("alpha").has_value());
+  ASSERT_TRUE(db.delete_semantic_space("lazy").has_value());
+  EXPECT_FALSE(table_exists(db_config(), "vec_space_1"));
+  EXPECT_FALSE(table_exists(db_config(), "vec_space_2"));
+}
+
+TEST_F(OdaiSqliteDbTest, TruncatedSpaceSizesItsVectorTableToTheTruncatedDimensions)
+{
+  OdaiSqliteDb& db = initialized_db();
+  SemanticSpaceConfig space = make_semantic_space("truncated");
+  space.m_dimensions = 4;
+  space.m_truncatedDimensions = 2;
+  ASSERT_TRUE(db.create_semantic_space(space).has_value());
+
+  ASSERT_TRUE(
+      db.add_document("doc-a", "doc-a", "truncated", "scope-a", {make_document_chunk("prefix", 1, 0, {0.0F, 1.0F})}, {})
+          .has_value());
+  expect_error(db.search_chunks("truncated", "scope-a", {0.0F, 1.0F, 0.0F, 0.0F}, 1, false, {}),
+               OdaiResultEnum::VALIDATION_FAILED);
+  OdaiResult<std::vector<RetrievedChunk>> results =
+      db.search_chunks("truncated", "scope-a", {0.0F, 1.0F}, 1, false, {});
+  ASSERT_TRUE(results.has_value());
+  ASSERT_EQ(results.value().size(), 1U);
+  EXPECT_EQ(results.value()[0].m_documentId, "doc-a");
+
+  SemanticSpaceConfig too_long = make_semantic_space("too-long");
+  too_long.m_dimensions = 4;
+  too_long.m_truncatedDimensions = 8;
+  expect_error(db.create_semantic_space(too_long), OdaiResultEnum::VALIDATION_FAILED);
+}
+
+TEST_F(OdaiSqliteDbTest, TwoStageSearchOnlyRanksChunksOfTheNearestDocuments)
+{
+  OdaiSqliteDb& db = initialized_db();
+  ASSERT_TRUE(db.create_semantic_space(make_semantic_space("alpha")).has_value());
+
+  // doc-b holds the single nearest chunk, but on average points away from the query
+  ASSERT_TRUE(db.add_document("doc-a", "doc-a", "alpha", "scope-a",
+                              {make_document_chunk("a-0", 1, 0, {0.8F, 0.6F}),
+                               make_document_chunk("a-1", 2, 1, {0.6F, 0.8F})}, {})
+                  .has_value());
+  ASSERT_TRUE(db.add_document("doc-b", "doc-b", "alpha", "scope-a",
+                              {make_document_chunk("b-0", 3, 0, {1.0F, 0.0F}),
+                               make_document_chunk("b-1", 4, 1, {0.0F, 1.0F}),
+                               make_document_chunk("b-2", 5, 2, {0.0F, 2.0F})}, {})
+                  .has_value());
+  // appended chunks join the existing document vector
+  ASSERT_TRUE(db.append_document_chunks("doc-a", {make_document_chunk("a-2", 6, 2, {0.7F, 0.7F})}).has_value());
+  EXPECT_EQ(count_rows(db_config(), "document_vector_ref"), 2);
+  EXPECT_EQ(count_rows(db_config(), "vec_space_1_docs"), 2);
+
+  const std::vector<float> query = {1.0F, 0.3F};
+  OdaiResult<std::vector<RetrievedChunk>> flat = db.search_chunks("alpha", "scope-a", query, 1, false, {});
+  ASSERT_TRUE(flat.has_value());
+  ASSERT_EQ(flat.value().size(), 1U);
+  EXPECT_EQ(flat.value()[0].m_documentId, "doc-b");
+
+  OdaiResult<std::vector<RetrievedChunk>> two_stage =
+      db.search_chunks_in_top_documents("alpha", "scope-a", query, 1, 10, true, {});
+  ASSERT_TRUE(two_stage.has_value());
+  ASSERT_EQ(two_stage.value().size(), 3U);
+  for (const RetrievedChunk& chunk : two_stage.value())
+  {
+    EXPECT_EQ(chunk.m_documentId, "doc-a");
+  }
+  EXPECT_EQ(two_stage.value()[0].m_contentText, "a-0");
+  EXPECT_EQ(two_stage.value()[0].m_embedding, (std::vector<float>{0.8F, 0.6F}));
+
+  OdaiResult<std::vector<RetrievedChunk>> both =
+      db.search_chunks_in_top_documents("alpha", "scope-a", query, 2, 1, false, {});
+  ASSERT_TRUE(both.has_value());
+  ASSERT_EQ(both.value().size(), 1U);
+  EXPECT_EQ(both.value()[0].m_documentId, "doc-b");
+
+  OdaiResult<std::vector<RetrievedChunk>> other_scope =
+      db.search_chunks_in_top_documents("alpha", "scope-b", query, 1, 10, false, {});
+  ASSERT_TRUE(other_scope.has_value());
+  EXPECT_TRUE(other_scope.value().empty());
+  expect_error(db.search_chunks_in_top_documents("alpha", "scope-a", query, 0, 10, false, {}),
+               OdaiResultEnum::VALIDATION_FAILED);
+
+  ASSERT_TRUE(db.delete_semantic_space("alpha").has_value());
+  EXPECT_FALSE(table_exists(db_config(), "vec_space_1_docs"));
+}
+
+TEST_F(OdaiSqliteDbTest, AddDocumentStoresSharedContentOnceWithOneVectorPerScope)
+{
+  OdaiSqliteDb& db = initialized_db();
+  ASSERT_TRUE(db.create_semantic_space(make_semantic_space("alpha")).has_value());
+
+  ASSERT_TRUE(db.add_document("doc-a", "doc-a", "alpha", "scope-a",
+                              {make_document_chunk("shared", 1, 0, {1.0F, 0.0F}),
+                               make_document_chunk("only-a", 2, 1, {0.0F, 1.0F})}, {})
+                  .has_value());
+  ASSERT_TRUE(
+      db.add_document("doc-b", "doc-b", "alpha", "scope-b", {make_document_chunk("shared", 1, 0, {})}, {}).has_value());
+
+  EXPECT_EQ(count_rows(db_config(), "chunk"), 2);
+  EXPECT_EQ(count_rows(db_config(), "doc_chunk_ref"), 3);
+  EXPECT_EQ(count_rows(db_config(), "vec_space_1"), 3);
+}
+
+TEST_F(OdaiSqliteDbTest, UpdateDocumentRemovesOrphanedChunksAndVectorsOnly)
+{
+  OdaiSqliteDb& db = initialized_db();
+  ASSERT_TRUE(db.create_semantic_space(make_semantic_space("alpha")).has_value());
+  ASSERT_TRUE(db.add_document("doc-a", "doc-a", "alpha", "scope-a",
+                              {make_document_chunk("kept", 1, 0, {1.0F, 0.0F}),
+                               make_document_chunk("shared", 2, 1, {0.0F, 1.0F}),
+                               make_document_chunk("dropped", 3, 2, {0.6F, 0.8F})}, {})
+                  .has_value());
+  ASSERT_TRUE(
+      db.add_document("doc-b", "doc-b", "alpha", "scope-b", {make_document_chunk("shared", 2, 0, {})}, {}).has_value());
+  ASSERT_EQ(count_rows(db_config(), "vec_space_1"), 4);
+
+  ASSERT_TRUE(db.update_document("doc-a", "alpha", "scope-a", {make_document_chunk("kept", 1, 0, {})}, {}).has_value());
+
+  // scope-a lost the vectors of "shared" and "dropped", scope-b still references "shared"
+  EXPECT_EQ(count_rows(db_config(), "chunk"), 2);
+  EXPECT_EQ(count_rows(db_config(), "doc_chunk_ref"), 2);
+  EXPECT_EQ(count_rows(db_config(), "chunk_vector_ref"), 2);
+  EXPECT_EQ(count_rows(db_config(), "vec_space_1"), 2);
+  EXPECT_EQ(count_rows(db_config(), "vec_space_1_docs"), 2);
+  EXPECT_EQ(count_rows(db_config(), "chunk_fts WHERE chunk_fts MATCH 'dropped'"), 0);
+  EXPECT_EQ(count_rows(db_config(), "chunk_fts WHERE chunk_fts MATCH 'shared'"), 1);
+}
+
+TEST_F(OdaiSqliteDbTest, UpdateDocumentMovesKeptVectorsToItsNewFilterValuesInPlace)
+{
+  OdaiSqliteDb& db = initialized_db();
+  SemanticSpaceConfig space = make_semantic_space("alpha");
+  space.m_filterFields = {"lang"};
+  ASSERT_TRUE(db.create_semantic_space(space).has_value());
+  ASSERT_TRUE(db.add_document("doc-a", "doc-a", "alpha", "scope-a",
+                              {make_document_chunk("kept", 1, 0, {1.0F, 0.0F}),
+                               make_document_chunk("dropped", 2, 1, {0.0F, 1.0F})},
+                              {{"lang", "en"}})
+                  .has_value());
+
+  ASSERT_TRUE(
+      db.update_document("doc-a", "alpha", "scope-a", {make_document_chunk("kept", 1, 0, {})}, {{"lang", "fr"}})
+          .has_value());
+
+  // "kept" keeps its vector row, only its filter values change
+  EXPECT_EQ(count_rows(db_config(), "chunk_vector_ref WHERE vector_rowid = 1 AND filter_key = '[\"fr\"]'"), 1);
+  EXPECT_EQ(count_rows(db_config(), "chunk_vector_ref"), 1);
+  EXPECT_EQ(count_rows(db_config(), "vec_space_1"), 1);
+  EXPECT_EQ(count_rows(db_config(), "document WHERE metadata ->> 'lang' = 'fr'"), 1);
+  OdaiResult<std::vector<RetrievedChunk>> french =
+      db.search_chunks("alpha", "scope-a", {1.0F, 0.0F}, 5, false, {{"lang", {"fr"}}});
+  ASSERT_TRUE(french.has_value());
+  ASSERT_EQ(french->size(), 1U);
+  EXPECT_EQ(french->at(0).m_contentText, "kept");
+  OdaiResult<std::vector<RetrievedChunk>> english =
+      db.search_chunks("alpha", "scope-a", {1.0F, 0.0F}, 5, false, {{"lang", {"en"}}});
+  ASSERT_TRUE(english.has_value());
+  EXPECT_TRUE(english->empty());
+}
+
+TEST_F(OdaiSqliteDbTest, ReembeddingSwitchesVectorTablesAndDropsVectorsOfRemovedChunks)
+{
+  OdaiSqliteDb& db = initialized_db();
+  SemanticSpaceConfig space = make_semantic_space("alpha");
+  space.m_filterFields = {"lang"};
+  ASSERT_TRUE(db.create_semantic_space(space).has_value());
+  ASSERT_TRUE(db.add_document("doc-a", "doc-a", "alpha", "scope-a",
+                              {make_document_chunk("kept", 1, 0, {1.0F, 0.0F}),
+                               make_document_chunk("dropped", 2, 1, {0.0F, 1.0F})},
+                              {{"lang", "en"}})
+                  .has_value());
+
+  SemanticSpaceConfig target = space;
+  target.m_embeddingModelConfig = {"embedding-model-v2"};
+  target.m_dimensions = 3;
+  ASSERT_TRUE(db.start_reembedding(target, ReembedConfig{}).has_value());
+  OdaiResult<std::vector<ReembedChunk>> batch = db.get_reembedding_batch("alpha", 10);
+  ASSERT_TRUE(batch.has_value());
+  ASSERT_EQ(batch.value().size(), 2U);
+  batch.value()[0].m_embedding = {0.0F, 0.0F, 1.0F};
+  batch.value()[1].m_embedding = {0.0F, 1.0F, 0.0F};
+  ASSERT_TRUE(db.store_reembedded_vectors("alpha", batch.value()).has_value());
+  EXPECT_EQ(count_rows(db_config(), "vec_space_1_g1"), 2);
+
+  // the update removes the live vector of "dropped", its re-embedded copy goes when the job finishes
+  ASSERT_TRUE(
+      db.update_document("doc-a", "alpha", "scope-a", {make_document_chunk("kept", 1, 0, {})}, {{"lang", "en"}})
+          .has_value());
+  OdaiResult<bool> finished = db.finish_reembedding("alpha");
+  ASSERT_TRUE(finished.has_value());
+  EXPECT_TRUE(finished.value());
+
+  EXPECT_FALSE(table_exists(db_config(), "vec_space_1"));
+  EXPECT_FALSE(table_exists(db_config(), "vec_space_1_docs"));
+  EXPECT_EQ(count_rows(db_config(), "vec_space_1_g1"), 1);
+  EXPECT_EQ(count_rows(db_config(), "vec_space_1_g1_docs"), 1);
+  // re-embedded vectors keep the filter values of their documents
+  OdaiResult<std::vector<RetrievedChunk>> filtered =
+      db.search_chunks("alpha", "scope-a", {0.0F, 0.0F, 1.0F}, 5, false, {{"lang", {"en"}}});
+  ASSERT_TRUE(filtered.has_value());
+  ASSERT_EQ(filtered.value().size(), 1U);
+  EXPECT_EQ(filtered.value()[0].m_contentText, "kept");
+
+  // a space deleted mid job drops the job's tables with its own
+  SemanticSpaceConfig beta = space;
+  beta.m_name = "beta";
+  ASSERT_TRUE(db.create_semantic_space(beta).has_value());
+  SemanticSpaceConfig beta_target = target;
+  beta_target.m_name = "beta";
+  ASSERT_TRUE(db.start_reembedding(beta_target, ReembedConfig{}).has_value());
+  EXPECT_TRUE(table_exists(db_config(), "vec_space_2_g1"));
+  ASSERT_TRUE(db.delete_semantic_space("beta").has_value());
+  ASSERT_TRUE(db.delete_semantic_space("alpha").has_value());
+  EXPECT_FALSE(table_exists(db_config(), "vec_space_2"));
+  EXPECT_FALSE(table_exists(db_config(), "vec_space_2_g1"));
+  EXPECT_FALSE(table_exists(db_config(), "vec_space_1_g1"));
+  EXPECT_EQ(count_rows(db_config(), "reembed_job"), 0);
+}
+
+TEST_F(OdaiSqliteDbTest, ReembeddingRestartedAfterCancelWritesTheRecreatedVectorTable)
+{
+  OdaiSqliteDb& db = initialized_db();
+  ASSERT_TRUE(db.create_semantic_space(make_semantic_space("alpha")).has_value());
+  ASSERT_TRUE(db.add_document("doc-a", "doc-a", "alpha", "scope-a", {make_document_chunk("one", 1, 0, {1.0F, 0.0F})},
+                              {})
+                  .has_value());
+
+  // the cancelled job cached its statements on vec_space_1_g1, the restarted one recreates the table wider
+  SemanticSpaceConfig target = make_semantic_space("alpha");
+  target.m_embeddingModelConfig = {"embedding-model-v2"};
+  for (const uint32_t dimensions : {3U, 4U})
+  {
+    target.m_dimensions = dimensions;
+    ASSERT_TRUE(db.start_reembedding(target, ReembedConfig{}).has_value());
+    OdaiResult<std::vector<ReembedChunk>> batch = db.get_reembedding_batch("alpha", 10);
+    ASSERT_TRUE(batch.has_value());
+    ASSERT_EQ(batch.value().size(), 1U);
+    batch.value()[0].m_embedding.assign(dimensions, 0.0F);
+    batch.value()[0].m_embedding.back() = 1.0F;
+    ASSERT_TRUE(db.store_reembedded_vectors("alpha", batch.value()).has_value());
+    if (dimensions == 3U)
+    {
+      ASSERT_TRUE(db.cancel_reembedding("alpha").has_value());
+      EXPECT_FALSE(table_exists(db_config(), "vec_space_1_g1"));
+    }
+  }
+
+  OdaiResult<bool> finished = db.finish_reembedding("alpha");
+  ASSERT_TRUE(finished.has_value());
+  EXPECT_TRUE(finished.value());
+  OdaiResult<std::vector<RetrievedChunk>> results =
+      db.search_chunks("alpha", "scope-a", {0.0F, 0.0F, 0.0F, 1.0F}, 5, false, {});
+  ASSERT_TRUE(results.has_value());
+  ASSERT_EQ(results.value().size(), 1U);
+  EXPECT_EQ(results.value()[0].m_contentText, "one");
+}
+
+TEST_F(OdaiSqliteDbTest, AddDocumentStoresChunkTokenCountsOnceCounted)
+{
+  OdaiSqliteDb& db = initialized_db();
+  ASSERT_TRUE(db.create_semantic_space(make_semantic_space("alpha")).has_value());
+
+  DocumentChunk counted = make_document_chunk("counted", 1, 0, {1.0F, 0.0F});
+  counted.m_tokenCount = 7;
+  ASSERT_TRUE(db.add_document("doc-a", "doc-a", "alpha", "scope-a",
+                              {counted, make_document_chunk("uncounted", 2, 1, {0.0F, 1.0F})}, {})
+                  .has_value());
+  EXPECT_EQ(read_chunk_token_count(db_config(), 1), std::optional<int64_t>{7});
+  EXPECT_EQ(read_chunk_token_count(db_config(), 2), std::nullopt);
+
+  // content stored without a count gets one when a token counting strategy stores it again
+  DocumentChunk recounted = make_document_chunk("uncounted", 2, 0, {});
+  recounted.m_tokenCount = 3;
+  ASSERT_TRUE(db.add_document("doc-b", "doc-b", "alpha", "scope-a", {recounted}, {}).has_value());
+  EXPECT_EQ(read_chunk_token_count(db_config(), 2), std::optional<int64_t>{3});
+}
+
+TEST_F(OdaiSqliteDbTest, HnswSpaceSearchMatchesFlatSpaceAndPersistsItsIndex)
+{
+  OdaiSqliteDb& db = initialized_db();
+  SemanticSpaceConfig flat_space = make_semantic_space("flat");
+  flat_space.m_dimensions = 4;
+  SemanticSpaceConfig graph_space = make_semantic_space("graph");
+  graph_space.m_dimensions = 4;
+  graph_space.m_vectorIndexConfig.m_indexType = VECTOR_INDEX_HNSW;
+  ASSERT_TRUE(db.create_semantic_space(flat_space).has_value());
+  ASSERT_TRUE(db.create_semantic_space(graph_space).has_value());
+
+  // enough vectors in one scope for the graph to be searched instead of the vector table
+  const std::vector<DocumentChunk> chunks = make_random_chunks(4200, 4, 1);
+  ASSERT_TRUE(db.add_document("doc-flat", "doc-flat", "flat", "scope-a", chunks, {}).has_value());
+  ASSERT_TRUE(db.add_document("doc-graph", "doc-graph", "graph", "scope-a", chunks, {}).has_value());
+
+  const std::vector<float> query = {0.3F, -1.0F, 0.5F, 2.0F};
+  const std::vector<uint32_t> expected =
+      retrieved_sequence_indexes(db.search_chunks("flat", "scope-a", query, 5, false, {}));
+  ASSERT_EQ(expected.size(), 5U);
+  EXPECT_EQ(retrieved_sequence_indexes(db.search_chunks("graph", "scope-a", query, 5, false, {})), expected);
+
+  db.close();
+  const fs::path index_path = db_config().m_dbPath + ".vec_space_2.hnsw";
+  EXPECT_TRUE(fs::exists(index_path));
+  EXPECT_FALSE(fs::exists(db_config().m_dbPath + ".vec_space_1.hnsw"));
+
+  ASSERT_TRUE(db.initialize_db().has_value());
+  EXPECT_EQ(retrieved_sequence_indexes(db.search_chunks("graph", "scope-a", query, 5, false, {})), expected);
+
+  // vectors committed after the index was saved are inserted into it
+  ASSERT_TRUE(db.add_document("doc-new", "doc-new", "graph", "scope-a",
+                              {make_document_chunk("new", 100000, 7, {0.3F, -1.0F, 0.5F, 2.0F})}, {})
+                  .has_value());
+  auto results = db.search_chunks("graph", "scope-a", query, 1, true, {});
+  ASSERT_TRUE(results.has_value());
+  ASSERT_EQ(results.value().size(), 1U);
+  EXPECT_EQ(results.value()[0].m_documentId, "doc-new");
+  EXPECT_NEAR(results.value()[0].m_score, 1.0F, 1e-5F);
+  // the stored embedding, not the normalized copy held by the graph
+  EXPECT_EQ(results.value()[0].m_embedding, query);
+
+  ASSERT_TRUE(db.delete_semantic_space("graph").has_value());
+  EXPECT_FALSE(fs::exists(index_path));
+}
+
+TEST_F(OdaiSqliteDbTest, HnswSpaceMarksRemovedVectorsDeletedAndRebuildsOnlyPastTheThreshold)
+{
+  OdaiSqliteDb& db = initialized_db();
+  SemanticSpaceConfig flat_space = make_semantic_space("flat");
+  flat_space.m_dimensions = 4;
+  SemanticSpaceConfig graph_space = flat_space;
+  graph_space.m_name = "graph";
+  graph_space.m_vectorIndexConfig.m_indexType = VECTOR_INDEX_HNSW;
+  ASSERT_TRUE(db.create_semantic_space(flat_space).has_value());
+  ASSERT_TRUE(db.create_semantic_space(graph_space).has_value());
+
+  const std::vector<DocumentChunk> chunks = make_random_chunks(4200, 4, 1);
+  auto update_both = [&](size_t first_kept)
+  {
+    const std::vector<DocumentChunk> kept(chunks.begin() + static_cast<std::ptrdiff_t>(first_kept), chunks.end());
+    ASSERT_TRUE(db.update_document("doc-flat", "flat", "scope-a", kept, {}).has_value());
+    ASSERT_TRUE(db.update_document("doc-graph", "graph", "scope-a", kept, {}).has_value());
+  };
+  // queries on removed vectors, a deleted node returned by the graph would come first
+  auto expect_graph_matches_flat = [&]()
+  {
+    for (size_t i : {10U, 150U, 1000U, 3000U})
+    {
+      const std::vector<float>& query = chunks[i].m_embedding;
+      EXPECT_EQ(retrieved_sequence_indexes(db.search_chunks("graph", "scope-a", query, 5, false, {})),
+                retrieved_sequence_indexes(db.search_chunks("flat", "scope-a", query, 5, false, {})))
+          << "query " << i;
+    }
+  };
+  ASSERT_TRUE(db.add_document("doc-flat", "doc-flat", "flat", "scope-a", chunks, {}).has_value());
+  ASSERT_TRUE(db.add_document("doc-graph", "doc-graph", "graph", "scope-a", chunks, {}).has_value());
+  expect_graph_matches_flat();
+  db.close();
+  const fs::path index_path = db_config().m_dbPath + ".vec_space_2.hnsw";
+  const uintmax_t full_size = fs::file_size(index_path);
+
+  // the update marks the loaded graph's nodes deleted instead of dropping the graph
+  ASSERT_TRUE(db.initialize_db().has_value());
+  expect_graph_matches_flat();
+  update_both(200);
+  EXPECT_TRUE(fs::exists(index_path));
+  expect_graph_matches_flat();
+  db.close();
+
+  // removed while the graph isn't loaded, the saved graph catches up when loaded instead of being rebuilt
+  ASSERT_TRUE(db.initialize_db().has_value());
+  update_both(600);
+  EXPECT_EQ(fs::file_size(index_path), full_size);
+  expect_graph_matches_flat();
+
+  // past a quarter of deleted nodes the write rebuilds and saves the graph from the remaining vectors
+  update_both(1200);
+  EXPECT_LT(fs::file_size(index_path), full_size);
+  expect_graph_matches_flat();
+  db.close();
+  ASSERT_TRUE(db.initialize_db().has_value());
+  expect_graph_matches_flat();
+}
+
+TEST_F(OdaiSqliteDbTest, QuantizedSpacesRescoreCandidatesWithFloatVectors)
+{
+  OdaiSqliteDb& db = initialized_db();
+  SemanticSpaceConfig float_space = make_semantic_space("float");
+  float_space.m_dimensions = 12;
+  ASSERT_TRUE(db.create_semantic_space(float_space).has_value());
+  for (const VectorStorageType storage_type : {VECTOR_STORAGE_INT8, VECTOR_STORAGE_BINARY})
+  {
+    SemanticSpaceConfig quantized_space = float_space;
+    quantized_space.m_name = storage_type == VECTOR_STORAGE_INT8 ? "int8" : "binary";
+    quantized_space.m_vectorIndexConfig.m_storageType = storage_type;
+    // enough candidates to cover the whole scope, so rescoring must give back the exact ranking
+    quantized_space.m_vectorIndexConfig.m_rescoreOversample = 40;
+    ASSERT_TRUE(db.create_semantic_space(quantized_space).has_value());
+  }
+
+  const std::vector<DocumentChunk> chunks = make_random_chunks(200, 12, 1);
+  const std::vector<float>& query = chunks[17].m_embedding;
+  for (const std::string space : {"float", "int8", "binary"})
+  {
+    ASSERT_TRUE(db.add_document("doc-" + space, "doc-" + space, space, "scope-a", chunks, {}).has_value());
+  }
+  const OdaiResult<std::vector<RetrievedChunk>> expected = db.search_chunks("float", "scope-a", query, 5, false, {});
+  ASSERT_TRUE(expected.has_value());
+  ASSERT_EQ(expected.value().size(), 5U);
+
+  for (const std::string space : {"int8", "binary"})
+  {
+    OdaiResult<std::vector<RetrievedChunk>> results = db.search_chunks(space, "scope-a", query, 5, true, {});
+    ASSERT_TRUE(results.has_value()) << space;
+    EXPECT_EQ(retrieved_sequence_indexes(results), retrieved_sequence_indexes(expected)) << space;
+    ASSERT_EQ(results.value().size(), 5U) << space;
+    // exact float scores and the stored float embedding, not quantized ones
+    for (size_t i = 0; i < results.value().size(); ++i)
+    {
+      EXPECT_NEAR(results.value()[i].m_score, expected.value()[i].m_score, 1e-5F) << space;
+    }
+    EXPECT_EQ(results.value()[0].m_embedding, query) << space;
+
+    // reused vectors keep their quantized copy
+    ASSERT_TRUE(db.add_document("reuse-" + space, "reuse-" + space, space, "scope-b",
+                                {make_document_chunk(chunks[17].m_contentText, chunks[17].m_contentHash, 0, {})}, {})
+                    .has_value());
+    OdaiResult<std::vector<RetrievedChunk>> reused = db.search_chunks(space, "scope-b", query, 1, false, {});
+    ASSERT_TRUE(reused.has_value()) << space;
+    ASSERT_EQ(reused.value().size(), 1U) << space;
+    EXPECT_EQ(reused.value()[0].m_documentId, "reuse-" + space);
+  }
+}
+
+TEST_F(OdaiSqliteDbTest, FilteredSearchOfGraphAndQuantizedSpacesMatchesFilteredFlatSearch)
+{
+  OdaiSqliteDb& db = initialized_db();
+  SemanticSpaceConfig flat_space = make_semantic_space("flat");
+  flat_space.m_dimensions = 4;
+  flat_space.m_filterFields = {"lang"};
+  ASSERT_TRUE(db.create_semantic_space(flat_space).has_value());
+  SemanticSpaceConfig graph_space = flat_space;
+  graph_space.m_name = "graph";
+  graph_space.m_vectorIndexConfig.m_indexType = VECTOR_INDEX_HNSW;
+  ASSERT_TRUE(db.create_semantic_space(graph_space).has_value());
+  SemanticSpaceConfig int8_space = flat_space;
+  int8_space.m_name = "int8";
+  int8_space.m_vectorIndexConfig.m_storageType = VECTOR_STORAGE_INT8;
+  int8_space.m_vectorIndexConfig.m_rescoreOversample = 1000;
+  ASSERT_TRUE(db.create_semantic_space(int8_space).has_value());
+
+  // enough vectors for the graph to be searched when no filter is given
+  const std::vector<DocumentChunk> english = make_random_chunks(4200, 4, 1);
+  const std::vector<DocumentChunk> french = make_random_chunks(50, 4, 100000);
+  for (const std::string space : {"flat", "graph", "int8"})
+  {
+    ASSERT_TRUE(db.add_document("en-" + space, "en-" + space, space, "scope-a", english, {{"lang", "en"}}).has_value());
+    ASSERT_TRUE(db.add_document("fr-" + space, "fr-" + space, space, "scope-a", french, {{"lang", "fr"}}).has_value());
+  }
+
+  const std::vector<float> query = {0.3F, -1.0F, 0.5F, 2.0F};
+  const MetadataFilter filter = {{"lang", {"fr"}}};
+  const std::vector<uint32_t> expected =
+      retrieved_sequence_indexes(db.search_chunks("flat", "scope-a", query, 5, false, filter));
+  ASSERT_EQ(expected.size(), 5U);
+  EXPECT_EQ(retrieved_sequence_indexes(db.search_chunks("graph", "scope-a", query, 5, false, filter)), expected);
+  EXPECT_EQ(retrieved_sequence_indexes(db.search_chunks("int8", "scope-a", query, 5, false, filter)), expected);
+
+  // the filter fields of a space are read back after a restart
+  db.close();
+  ASSERT_TRUE(db.initialize_db().has_value());
+  OdaiResult<std::vector<RetrievedChunk>> results = db.search_chunks("graph", "scope-a", query, 5, false, filter);
+  EXPECT_EQ(retrieved_sequence_indexes(results), expected);
+  ASSERT_TRUE(results.has_value());
+  for (const RetrievedChunk& chunk : results.value())
+  {
+    EXPECT_EQ(chunk.m_documentId, "fr-graph");
+  }
+}
+
+TEST_F(OdaiSqliteDbTest, KnowledgePacksOfGraphAndQuantizedSpacesSearchLikeTheirSources)
+{
+  OdaiSqliteDb& db = initialized_db();
+  // a pack is only attached next to the embedding model it was made with
+  ASSERT_TRUE(db.register_model_files("embedding-model",
+                                      make_model_files(ModelType::EMBEDDING, {{"base_model_path", "/tmp/embed.gguf"}}),
+                                      R"({"base_model_path":"embed"})")
+                  .has_value());
+  SemanticSpaceConfig graph_space = make_semantic_space("graph");
+  graph_space.m_dimensions = 4;
+  graph_space.m_filterFields = {"lang"};
+  graph_space.m_vectorIndexConfig.m_indexType = VECTOR_INDEX_HNSW;
+  ASSERT_TRUE(db.create_semantic_space(graph_space).has_value());
+  SemanticSpaceConfig int8_space = graph_space;
+  int8_space.m_name = "int8";
+  int8_space.m_vectorIndexConfig.m_indexType = VECTOR_INDEX_FLAT;
+  int8_space.m_vectorIndexConfig.m_storageType = VECTOR_STORAGE_INT8;
+  int8_space.m_vectorIndexConfig.m_rescoreOversample = 1000;
+  ASSERT_TRUE(db.create_semantic_space(int8_space).has_value());
+
+  const std::vector<DocumentChunk> english = make_random_chunks(4200, 4, 1);
+  const std::vector<DocumentChunk> french = make_random_chunks(50, 4, 100000);
+  for (const std::string space : {"graph", "int8"})
+  {
+    ASSERT_TRUE(db.add_document("en-" + space, "en-" + space, space, "scope-a", english, {{"lang", "en"}}).has_value());
+    ASSERT_TRUE(db.add_document("fr-" + space, "fr-" + space, space, "scope-a", french, {{"lang", "fr"}}).has_value());
+  }
+
+  const fs::path graph_pack = m_rootPath / "graph.pack";
+  const fs::path bare_graph_pack = m_rootPath / "bare-graph.pack";
+  const fs::path int8_pack = m_rootPath / "int8.pack";
+  ASSERT_TRUE(db.export_knowledge_pack("graph", graph_pack.string(), true).has_value());
+  ASSERT_TRUE(db.export_knowledge_pack("graph", bare_graph_pack.string(), false).has_value());
+  ASSERT_TRUE(db.export_knowledge_pack("int8", int8_pack.string(), true).has_value());
+  EXPECT_FALSE(fs::exists(m_rootPath / "graph.pack.tmp"));
+
+  // the graph is appended after the database pages, a pack without it ends with its last page
+  auto database_size = [](const fs::path& path)
+  {
+    SQLite::Database pack(path.string(), SQLite::OPEN_READONLY);
+    SQLite::Statement query(pack, "SELECT page_count * page_size FROM pragma_page_count(), pragma_page_size()");
+    query.executeStep();
+    return query.getColumn(0).getInt64();
+  };
+  EXPECT_GT(fs::file_size(graph_pack), static_cast<uintmax_t>(database_size(graph_pack)));
+  EXPECT_EQ(fs::file_size(bare_graph_pack), static_cast<uintmax_t>(database_size(bare_graph_pack)));
+
+  ASSERT_TRUE(db.import_knowledge_pack(graph_pack.string(), "graph-pack").has_value());
+  ASSERT_TRUE(db.import_knowledge_pack(bare_graph_pack.string(), "bare-graph-pack").has_value());
+  ASSERT_TRUE(db.import_knowledge_pack(int8_pack.string(), "int8-pack").has_value());
+  OdaiResult<SemanticSpaceConfig> int8_config = db.get_semantic_space_config("int8-pack");
+  ASSERT_TRUE(int8_config.has_value());
+  EXPECT_EQ(int8_config->m_vectorIndexConfig.m_storageType, VECTOR_STORAGE_INT8);
+
+  const std::vector<float> query = {0.3F, -1.0F, 0.5F, 2.0F};
+  const MetadataFilter filter = {{"lang", {"fr"}}};
+  for (const MetadataFilter& search_filter : {MetadataFilter{}, filter})
+  {
+    const std::vector<uint32_t> graph_expected =
+        retrieved_sequence_indexes(db.search_chunks("graph", "scope-a", query, 5, false, search_filter));
+    ASSERT_EQ(graph_expected.size(), 5U);
+    EXPECT_EQ(retrieved_sequence_indexes(db.search_chunks("graph-pack", "scope-a", query, 5, false, search_filter)),
+              graph_expected);
+    EXPECT_EQ(
+        retrieved_sequence_indexes(db.search_chunks("bare-graph-pack", "scope-a", query, 5, false, search_filter)),
+        graph_expected);
+    const std::vector<uint32_t> int8_expected =
+        retrieved_sequence_indexes(db.search_chunks("int8", "scope-a", query, 5, false, search_filter));
+    ASSERT_EQ(int8_expected.size(), 5U);
+    EXPECT_EQ(retrieved_sequence_indexes(db.search_chunks("int8-pack", "scope-a", query, 5, false, search_filter)),
+              int8_expected);
+  }
+
+  // searching and closing never writes to a pack
+  const uintmax_t pack_size = fs::file_size(graph_pack);
+  const fs::file_time_type pack_time = fs::last_write_time(graph_pack);
+  db.close();
+  EXPECT_EQ(fs::file_size(graph_pack), pack_size);
+  EXPECT_EQ(fs::last_write_time(graph_pack), pack_time);
+  // importing added no vector table to the main database
+  EXPECT_FALSE(table_exists(db_config(), "vec_space_3"));
+
+  ASSERT_TRUE(db.initialize_db().has_value());
+  OdaiResult<std::vector<RetrievedChunk>> results = db.search_chunks("graph-pack", "scope-a", query, 5, false, filter);
+  ASSERT_TRUE(results.has_value());
+  ASSERT_EQ(results->size(), 5U);
+  for (const RetrievedChunk& chunk : results.value())
+  {
+    EXPECT_EQ(chunk.m_documentId, "fr-graph");
+  }
+}
+
 TEST_F(OdaiSqliteDbTest, CreateChatRejectsInvalidLlmModelConfig)
 {
   OdaiSqliteDb& db = initialized_db();
@@ -0,0 +1,209 @@
+#include "db/odai_sqlite/odai_sqlite_db.h"
+
+#include "odai_db_test_helpers.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using odai::test::db_contract::make_document_chunk;
+using odai::test::db_contract::make_semantic_space;
+using odai::test::db_contract::seconds_since;
+using odai::test::db_contract::TempDbDirectory;
+
+namespace
+{
+constexpr size_t BENCHMARK_DOCUMENTS = 200;
+constexpr size_t BENCHMARK_CHUNKS_PER_DOCUMENT = 100;
+constexpr uint32_t BENCHMARK_DIMENSIONS = 128;
+constexpr size_t BENCHMARK_QUERIES = 50;
+constexpr uint32_t BENCHMARK_K = 10;
+/// Documents get one of this many values of the filtered field, a filter on one value keeps 1% of the chunks
+constexpr size_t BENCHMARK_FIELD_VALUES = 100;
+/// Candidates fetched per wanted chunk when post-filtering an unfiltered search
+constexpr uint32_t BENCHMARK_POST_FILTER_OVERSAMPLE = 10;
+
+/// Identifies a chunk by its document and position
+using ChunkKey = std::pair<std::string, uint32_t>;
+
+std::vector<std::vector<float>> make_unit_vectors(size_t count, uint64_t seed)
+{
+  std::mt19937_64 generator(seed);
+  std::normal_distribution<float> normal(0.0F, 1.0F);
+  std::vector<std::vector<float>> vectors(count, std::vector<float>(BENCHMARK_DIMENSIONS));
+  for (std::vector<float>& vector : vectors)
+  {
+    float norm = 0.0F;
+    for (float& value : vector)
+    {
+      value = normal(generator);
+      norm += value * value;
+    }
+    for (float& value : vector)
+    {
+      value /= std::sqrt(norm);
+    }
+  }
+  return vectors;
+}
+
+std::string document_id(size_t document)
+{
+  return "doc-" + std::to_string(document);
+}
+
+std::string field_value(size_t document)
+{
+  return "value-" + std::to_string(document % BENCHMARK_FIELD_VALUES);
+}
+
+/// Nearest chunks of the documents whose field value is one of the given ones, by brute force
+std::vector<ChunkKey> exact_nearest(const std::vector<std::vector<float>>& vectors, const std::vector<float>& query,
+                                    const std::vector<std::string>& values)
+{
+  std::vector<std::pair<float, ChunkKey>> scored;
+  for (size_t i = 0; i < vectors.size(); ++i)
+  {
+    const size_t document = i / BENCHMARK_CHUNKS_PER_DOCUMENT;
+    if (std::find(values.begin(), values.end(), field_value(document)) == values.end())
+    {
+      continue;
+    }
+    float dot = 0.0F;
+    for (uint32_t d = 0; d < BENCHMARK_DIMENSIONS; ++d)
+    {
+      dot += vectors[i][d] * query[d];
+    }
+    scored.emplace_back(dot, ChunkKey{document_id(document), static_cast<uint32_t>(i % BENCHMARK_CHUNKS_PER_DOCUMENT)});
+  }
+  const size_t k = std::min<size_t>(BENCHMARK_K, scored.size());
+  std::partial_sort(scored.begin(), scored.begin() + static_cast<std::ptrdiff_t>(k), scored.end(),
+                    [](const auto& a, const auto& b) { return a.first > b.first; });
+  std::vector<ChunkKey> nearest;
+  for (size_t i = 0; i < k; ++i)
+  {
+    nearest.push_back(scored[i].second);
+  }
+  return nearest;
+}
+
+size_t count_found(const std::vector<ChunkKey>& expected, const std::vector<RetrievedChunk>& results)
+{
+  size_t found = 0;
+  for (const RetrievedChunk& chunk : results)
+  {
+    found += std::count(expected.begin(), expected.end(), ChunkKey{chunk.m_documentId, chunk.m_sequenceIndex});
+  }
+  return found;
+}
+} // namespace
+
+TEST(OdaiSqliteMetadataFilterBenchmark, PushdownAgainstPostFiltering)
+{
+  const TempDbDirectory directory("odai_sqlite_metadata_filter_benchmark");
+  OdaiSqliteDb db(directory.db_config());
+  ASSERT_TRUE(db.initialize_db().has_value());
+
+  SemanticSpaceConfig config = make_semantic_space("space");
+  config.m_dimensions = BENCHMARK_DIMENSIONS;
+  config.m_filterFields = {"category"};
+  ASSERT_TRUE(db.create_semantic_space(config).has_value());
+
+  const std::vector<std::vector<float>> vectors =
+      make_unit_vectors(BENCHMARK_DOCUMENTS * BENCHMARK_CHUNKS_PER_DOCUMENT, 1);
+  const std::vector<std::vector<float>> queries = make_unit_vectors(BENCHMARK_QUERIES, 2);
+  std::unordered_map<std::string, std::string> values_by_document;
+  for (size_t document = 0; document < BENCHMARK_DOCUMENTS; ++document)
+  {
+    std::vector<DocumentChunk> chunks;
+    for (size_t c = 0; c < BENCHMARK_CHUNKS_PER_DOCUMENT; ++c)
+    {
+      const size_t i = document * BENCHMARK_CHUNKS_PER_DOCUMENT + c;
+      chunks.push_back(make_document_chunk("chunk-" + std::to_string(i), i + 1, static_cast<uint32_t>(c), vectors[i]));
+    }
+    values_by_document[document_id(document)] = field_value(document);
+    ASSERT_TRUE(db.add_document(document_id(document), document_id(document), "space", "scope", chunks,
+                                {{"category", field_value(document)}})
+                    .has_value());
+  }
+
+  // one value keeps 1% of the chunks, ten values keep 10%
+  std::vector<std::string> ten_values;
+  for (size_t v = 0; v < 10; ++v)
+  {
+    ten_values.push_back(field_value(v));
+  }
+  const std::vector<std::pair<std::string, std::vector<std::string>>> filters = {{"1pct", {field_value(0)}},
+                                                                                {"10pct", ten_values}};
+
+  double pushdown_recall_sum = 0.0;
+  for (const auto& [name, values] : filters)
+  {
+    const MetadataFilter filter = {{"category", values}};
+    std::vector<std::vector<ChunkKey>> expected;
+    for (const std::vector<float>& query : queries)
+    {
+      expected.push_back(exact_nearest(vectors, query, values));
+    }
+
+    size_t pushdown_found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t q = 0; q < queries.size(); ++q)
+    {
+      OdaiResult<std::vector<RetrievedChunk>> results =
+          db.search_chunks("space", "scope", queries[q], BENCHMARK_K, false, filter);
+      ASSERT_TRUE(results.has_value());
+      pushdown_found += count_found(expected[q], results.value());
+    }
+    const double pushdown_ms = seconds_since(start) * 1000.0 / static_cast<double>(queries.size());
+
+    // the alternative to a pushed down filter: oversample an unfiltered search and drop what doesn't match
+    size_t post_filter_found = 0;
+    start = std::chrono::steady_clock::now();
+    for (size_t q = 0; q < queries.size(); ++q)
+    {
+      OdaiResult<std::vector<RetrievedChunk>> results = db.search_chunks(
+          "space", "scope", queries[q], BENCHMARK_K * BENCHMARK_POST_FILTER_OVERSAMPLE, false, {});
+      ASSERT_TRUE(results.has_value());
+      std::vector<RetrievedChunk> kept;
+      for (RetrievedChunk& chunk : results.value())
+      {
+        if (kept.size() < BENCHMARK_K &&
+            std::find(values.begin(), values.end(), values_by_document[chunk.m_documentId]) != values.end())
+        {
+          kept.push_back(std::move(chunk));
+        }
+      }
+      post_filter_found += count_found(expected[q], kept);
+    }
+    const double post_filter_ms = seconds_since(start) * 1000.0 / static_cast<double>(queries.size());
+
+    const double total = static_cast<double>(queries.size() * BENCHMARK_K);
+    const double pushdown_recall = static_cast<double>(pushdown_found) / total;
+    const double post_filter_recall = static_cast<double>(post_filter_found) / total;
+    pushdown_recall_sum += pushdown_recall;
+
+    RecordProperty("pushdown_recall_at_10_" + name, std::to_string(pushdown_recall));
+    RecordProperty("pushdown_query_ms_" + name, std::to_string(pushdown_ms));
+    RecordProperty("post_filter_recall_at_10_" + name, std::to_string(post_filter_recall));
+    RecordProperty("post_filter_query_ms_" + name, std::to_string(post_filter_ms));
+    std::cout << "[ BENCHMARK ] filter keeping " << name << " of " << vectors.size() << " x " << BENCHMARK_DIMENSIONS
+              << " vectors, pushdown recall@" << BENCHMARK_K << ": " << pushdown_recall << ", query: " << pushdown_ms
+              << " ms; post-filter x" << BENCHMARK_POST_FILTER_OVERSAMPLE << " recall@" << BENCHMARK_K << ": "
+              << post_filter_recall << ", query: " << post_filter_ms << " ms\n";
+  }
+
+  db.close();
+
+  // the pushed down filter searches the matching vectors exhaustively
+  EXPECT_GT(pushdown_recall_sum / static_cast<double>(filters.size()), 0.99);
+}
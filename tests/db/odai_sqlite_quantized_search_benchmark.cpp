@@ -0,0 +1,122 @@
+#include "db/odai_sqlite/odai_sqlite_db.h"
+
+#include "odai_db_test_helpers.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using odai::test::db_contract::make_clustered_vectors;
+using odai::test::db_contract::make_document_chunk;
+using odai::test::db_contract::make_semantic_space;
+using odai::test::db_contract::seconds_since;
+using odai::test::db_contract::TempDbDirectory;
+
+namespace
+{
+constexpr size_t BENCHMARK_VECTORS = 20000;
+constexpr uint32_t BENCHMARK_DIMENSIONS = 384;
+constexpr size_t BENCHMARK_QUERIES = 100;
+constexpr uint32_t BENCHMARK_K = 10;
+constexpr size_t BENCHMARK_CLUSTERS = 100;
+constexpr float BENCHMARK_CLUSTER_SPREAD = 0.75F;
+/// Rescore oversampling factors to measure for each quantized storage type
+constexpr uint32_t BENCHMARK_OVERSAMPLE[] = {1, 4, 16};
+
+std::vector<uint32_t> search_sequence_indexes(OdaiSqliteDb& db, const std::string& space,
+                                              const std::vector<float>& query)
+{
+  std::vector<uint32_t> indexes;
+  OdaiResult<std::vector<RetrievedChunk>> results = db.search_chunks(space, "scope", query, BENCHMARK_K, false, {});
+  if (results.has_value())
+  {
+    for (const RetrievedChunk& chunk : results.value())
+    {
+      indexes.push_back(chunk.m_sequenceIndex);
+    }
+  }
+  return indexes;
+}
+} // namespace
+
+TEST(OdaiSqliteQuantizedSearchBenchmark, RecallAndLatencyAgainstFloatStorage)
+{
+  const TempDbDirectory directory("odai_sqlite_quantized_search_benchmark");
+  OdaiSqliteDb db(directory.db_config());
+  ASSERT_TRUE(db.initialize_db().has_value());
+
+  const std::vector<std::vector<float>> vectors =
+      make_clustered_vectors(BENCHMARK_VECTORS, BENCHMARK_DIMENSIONS, BENCHMARK_CLUSTERS, BENCHMARK_CLUSTER_SPREAD, 1);
+  const std::vector<std::vector<float>> queries =
+      make_clustered_vectors(BENCHMARK_QUERIES, BENCHMARK_DIMENSIONS, BENCHMARK_CLUSTERS, BENCHMARK_CLUSTER_SPREAD, 2);
+  std::vector<DocumentChunk> chunks;
+  chunks.reserve(vectors.size());
+  for (size_t i = 0; i < vectors.size(); ++i)
+  {
+    chunks.push_back(make_document_chunk("chunk-" + std::to_string(i), i + 1, static_cast<uint32_t>(i), vectors[i]));
+  }
+
+  SemanticSpaceConfig float_config = make_semantic_space("float32");
+  float_config.m_dimensions = BENCHMARK_DIMENSIONS;
+  ASSERT_TRUE(db.create_semantic_space(float_config).has_value());
+  ASSERT_TRUE(db.add_document("doc-float32", "doc-float32", "float32", "scope", chunks, {}).has_value());
+
+  std::vector<std::vector<uint32_t>> expected;
+  auto start = std::chrono::steady_clock::now();
+  for (const std::vector<float>& query : queries)
+  {
+    expected.push_back(search_sequence_indexes(db, "float32", query));
+  }
+  const double float_ms = seconds_since(start) * 1000.0 / static_cast<double>(queries.size());
+  std::cout << "[ BENCHMARK ] " << BENCHMARK_VECTORS << " x " << BENCHMARK_DIMENSIONS
+            << " vectors, float32 query: " << float_ms << " ms\n";
+  RecordProperty("float32_query_ms", std::to_string(float_ms));
+
+  double best_int8_recall = 0.0;
+  const std::vector<std::pair<std::string, VectorStorageType>> quantized_spaces = {{"int8", VECTOR_STORAGE_INT8},
+                                                                                  {"binary", VECTOR_STORAGE_BINARY}};
+  for (const auto& [name, storage_type] : quantized_spaces)
+  {
+    for (const uint32_t oversample : BENCHMARK_OVERSAMPLE)
+    {
+      // the oversampling is part of the stored space config, so each setting gets its own space
+      SemanticSpaceConfig config = make_semantic_space(name + "-" + std::to_string(oversample));
+      config.m_dimensions = BENCHMARK_DIMENSIONS;
+      config.m_vectorIndexConfig.m_storageType = storage_type;
+      config.m_vectorIndexConfig.m_rescoreOversample = oversample;
+      ASSERT_TRUE(db.create_semantic_space(config).has_value());
+      ASSERT_TRUE(db.add_document("doc-" + config.m_name, "doc-" + config.m_name, config.m_name, "scope", chunks, {})
+                      .has_value());
+
+      size_t found = 0;
+      start = std::chrono::steady_clock::now();
+      for (size_t q = 0; q < queries.size(); ++q)
+      {
+        for (const uint32_t index : search_sequence_indexes(db, config.m_name, queries[q]))
+        {
+          found += std::count(expected[q].begin(), expected[q].end(), index);
+        }
+      }
+      const double query_ms = seconds_since(start) * 1000.0 / static_cast<double>(queries.size());
+      const double recall = static_cast<double>(found) / static_cast<double>(queries.size() * BENCHMARK_K);
+      if (storage_type == VECTOR_STORAGE_INT8)
+      {
+        best_int8_recall = std::max(best_int8_recall, recall);
+      }
+
+      RecordProperty(name + "_recall_at_10_oversample_" + std::to_string(oversample), std::to_string(recall));
+      RecordProperty(name + "_query_ms_oversample_" + std::to_string(oversample), std::to_string(query_ms));
+      std::cout << "[ BENCHMARK ] " << name << " oversample " << oversample << ", recall@" << BENCHMARK_K << ": "
+                << recall << ", query: " << query_ms << " ms\n";
+    }
+  }
+
+  db.close();
+
+  EXPECT_GT(best_int8_recall, 0.9);
+}
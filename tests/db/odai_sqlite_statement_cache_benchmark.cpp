@@ -0,0 +1,185 @@
+#include "db/odai_sqlite/odai_sqlite_db.h"
+
+#include "odai_db_test_helpers.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using odai::test::db_contract::make_chat_config;
+using odai::test::db_contract::make_clustered_vectors;
+using odai::test::db_contract::make_document_chunk;
+using odai::test::db_contract::make_semantic_space;
+using odai::test::db_contract::seconds_since;
+using odai::test::db_contract::TempDbDirectory;
+
+namespace
+{
+// enough vectors for a scope to search the HNSW graph
+constexpr size_t BENCHMARK_DOCUMENTS = 520;
+constexpr size_t BENCHMARK_CHUNKS_PER_DOCUMENT = 8;
+constexpr uint32_t BENCHMARK_DIMENSIONS = 64;
+constexpr size_t BENCHMARK_CLUSTERS = 16;
+constexpr size_t BENCHMARK_QUERIES = 1000;
+constexpr uint32_t BENCHMARK_K = 10;
+constexpr size_t BENCHMARK_CHATS = 100;
+constexpr size_t BENCHMARK_CHAT_LOOKUPS = 20000;
+constexpr const char* BENCHMARK_MODEL_CHECKSUMS = "benchmark-model";
+
+/// Per call latencies of the hot paths of one database
+struct HotPathTimings
+{
+  double m_addDocumentUs = 0.0;
+  double m_ingestDocumentUs = 0.0;
+  double m_searchChunksUs = 0.0;
+  double m_hnswSearchChunksUs = 0.0;
+  double m_getChatConfigUs = 0.0;
+  /// Texts of the chunks found by every query, in order, to check both runs return the same results
+  std::vector<std::string> m_foundTexts;
+};
+
+double microseconds_per_call(std::chrono::steady_clock::time_point start, size_t calls)
+{
+  return seconds_since(start) * 1000000.0 / static_cast<double>(calls);
+}
+
+std::string chat_id(size_t chat)
+{
+  return "chat-" + std::to_string(chat);
+}
+
+std::vector<DocumentChunk> document_chunks(size_t document, const std::vector<std::vector<float>>& vectors)
+{
+  std::vector<DocumentChunk> chunks;
+  for (size_t c = 0; c < BENCHMARK_CHUNKS_PER_DOCUMENT; ++c)
+  {
+    const size_t i = document * BENCHMARK_CHUNKS_PER_DOCUMENT + c;
+    chunks.push_back(make_document_chunk("chunk-" + std::to_string(i), i + 1, static_cast<uint32_t>(c), vectors[i]));
+  }
+  return chunks;
+}
+
+/// Searches every query in a space
+/// @return the microseconds per search
+double time_searches(OdaiSqliteDb& db, const SemanticSpaceName& space, const std::vector<std::vector<float>>& queries,
+                     HotPathTimings& timings)
+{
+  const auto start = std::chrono::steady_clock::now();
+  for (const std::vector<float>& query : queries)
+  {
+    OdaiResult<std::vector<RetrievedChunk>> results = db.search_chunks(space, "scope", query, BENCHMARK_K, false, {});
+    EXPECT_TRUE(results.has_value());
+    if (results.has_value())
+    {
+      for (const RetrievedChunk& chunk : results.value())
+      {
+        timings.m_foundTexts.push_back(chunk.m_contentText);
+      }
+    }
+  }
+  return microseconds_per_call(start, queries.size());
+}
+
+/// Fills a flat space with add_document and an HNSW space through the ingest path, then times searches of both and
+/// chat lookups
+void run_hot_paths(size_t statement_cache_capacity, const std::vector<std::vector<float>>& vectors,
+                   const std::vector<std::vector<float>>& queries, HotPathTimings& timings)
+{
+  const TempDbDirectory directory("odai_sqlite_statement_cache_benchmark");
+  OdaiSqliteDb db(directory.db_config(), statement_cache_capacity);
+  ASSERT_TRUE(db.initialize_db().has_value());
+
+  SemanticSpaceConfig config = make_semantic_space("flat");
+  config.m_dimensions = BENCHMARK_DIMENSIONS;
+  ASSERT_TRUE(db.create_semantic_space(config).has_value());
+  config.m_name = "graph";
+  config.m_vectorIndexConfig.m_indexType = VECTOR_INDEX_HNSW;
+  ASSERT_TRUE(db.create_semantic_space(config).has_value());
+  for (size_t chat = 0; chat < BENCHMARK_CHATS; ++chat)
+  {
+    ASSERT_TRUE(db.create_chat(chat_id(chat), make_chat_config()).has_value());
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t document = 0; document < BENCHMARK_DOCUMENTS; ++document)
+  {
+    const std::string document_id = "doc-" + std::to_string(document);
+    ASSERT_TRUE(db.add_document(document_id, document_id, "flat", "scope", document_chunks(document, vectors), {})
+                    .has_value());
+  }
+  timings.m_addDocumentUs = microseconds_per_call(start, BENCHMARK_DOCUMENTS);
+
+  // the calls OdaiRagEngine makes per document: find the content to embed, look up stored embeddings, store the new
+  // ones, then the document. Each commit also inserts the new vectors into the graph.
+  start = std::chrono::steady_clock::now();
+  for (size_t document = 0; document < BENCHMARK_DOCUMENTS; ++document)
+  {
+    const std::vector<DocumentChunk> chunks = document_chunks(document, vectors);
+    std::vector<uint64_t> hashes;
+    std::vector<std::vector<float>> embeddings;
+    for (const DocumentChunk& chunk : chunks)
+    {
+      hashes.push_back(chunk.m_contentHash);
+      embeddings.push_back(chunk.m_embedding);
+    }
+    ASSERT_TRUE(db.get_unembedded_chunk_hashes("graph", hashes).has_value());
+    ASSERT_TRUE(db.get_stored_chunk_embeddings(BENCHMARK_MODEL_CHECKSUMS, hashes).has_value());
+    ASSERT_TRUE(db.store_chunk_embeddings(BENCHMARK_MODEL_CHECKSUMS, hashes, embeddings).has_value());
+    const std::string document_id = "graph-doc-" + std::to_string(document);
+    ASSERT_TRUE(db.add_document(document_id, document_id, "graph", "scope", chunks, {}).has_value());
+  }
+  timings.m_ingestDocumentUs = microseconds_per_call(start, BENCHMARK_DOCUMENTS);
+
+  timings.m_searchChunksUs = time_searches(db, "flat", queries, timings);
+  timings.m_hnswSearchChunksUs = time_searches(db, "graph", queries, timings);
+
+  start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < BENCHMARK_CHAT_LOOKUPS; ++i)
+  {
+    ASSERT_TRUE(db.get_chat_config(chat_id(i % BENCHMARK_CHATS)).has_value());
+  }
+  timings.m_getChatConfigUs = microseconds_per_call(start, BENCHMARK_CHAT_LOOKUPS);
+
+  db.close();
+}
+} // namespace
+
+TEST(OdaiSqliteStatementCacheBenchmark, HotPathsWithAndWithoutTheCache)
+{
+  const std::vector<std::vector<float>> vectors = make_clustered_vectors(
+      BENCHMARK_DOCUMENTS * BENCHMARK_CHUNKS_PER_DOCUMENT, BENCHMARK_DIMENSIONS, BENCHMARK_CLUSTERS, 0.5F, 1);
+  const std::vector<std::vector<float>> queries =
+      make_clustered_vectors(BENCHMARK_QUERIES, BENCHMARK_DIMENSIONS, BENCHMARK_CLUSTERS, 0.5F, 2);
+
+  // a capacity of 0 prepares every statement per call, as every call did before the cache
+  HotPathTimings uncached;
+  ASSERT_NO_FATAL_FAILURE(run_hot_paths(0, vectors, queries, uncached));
+  HotPathTimings cached;
+  ASSERT_NO_FATAL_FAILURE(run_hot_paths(OdaiSqliteStatementCache::DEFAULT_CAPACITY, vectors, queries, cached));
+
+  RecordProperty("uncached_add_document_us", std::to_string(uncached.m_addDocumentUs));
+  RecordProperty("cached_add_document_us", std::to_string(cached.m_addDocumentUs));
+  RecordProperty("uncached_ingest_document_us", std::to_string(uncached.m_ingestDocumentUs));
+  RecordProperty("cached_ingest_document_us", std::to_string(cached.m_ingestDocumentUs));
+  RecordProperty("uncached_search_chunks_us", std::to_string(uncached.m_searchChunksUs));
+  RecordProperty("cached_search_chunks_us", std::to_string(cached.m_searchChunksUs));
+  RecordProperty("uncached_hnsw_search_chunks_us", std::to_string(uncached.m_hnswSearchChunksUs));
+  RecordProperty("cached_hnsw_search_chunks_us", std::to_string(cached.m_hnswSearchChunksUs));
+  RecordProperty("uncached_get_chat_config_us", std::to_string(uncached.m_getChatConfigUs));
+  RecordProperty("cached_get_chat_config_us", std::to_string(cached.m_getChatConfigUs));
+  std::cout << "[ BENCHMARK ] uncached / cached statements, add_document of " << BENCHMARK_CHUNKS_PER_DOCUMENT
+            << " chunks: " << uncached.m_addDocumentUs << " / " << cached.m_addDocumentUs
+            << " us, ingest into an HNSW space: " << uncached.m_ingestDocumentUs << " / " << cached.m_ingestDocumentUs
+            << " us, search_chunks over " << vectors.size() << " x " << BENCHMARK_DIMENSIONS
+            << " vectors: " << uncached.m_searchChunksUs << " / " << cached.m_searchChunksUs
+            << " us, through the HNSW graph: " << uncached.m_hnswSearchChunksUs << " / " << cached.m_hnswSearchChunksUs
+            << " us, get_chat_config: " << uncached.m_getChatConfigUs << " / " << cached.m_getChatConfigUs << " us\n";
+
+  // reused statements return what freshly prepared ones do
+  EXPECT_EQ(cached.m_foundTexts.size(), 2 * BENCHMARK_QUERIES * BENCHMARK_K);
+  EXPECT_EQ(cached.m_foundTexts, uncached.m_foundTexts);
+}
@@ -0,0 +1,144 @@
+#include "db/odai_sqlite/odai_sqlite_statement_cache.h"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <SQLiteCpp/SQLiteCpp.h>
+#include <gtest/gtest.h>
+
+namespace
+{
+using CachedStatement = OdaiSqliteStatementCache::CachedStatement;
+
+constexpr const char* SELECT_ROWS_SQL = "SELECT value FROM rows ORDER BY value";
+
+class OdaiSqliteStatementCacheTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_db.exec("CREATE TABLE rows (value INTEGER)");
+    m_db.exec("INSERT INTO rows (value) VALUES (1), (2), (3)");
+  }
+
+  /// @return first value of a borrowed statement, std::nullopt if it has no row or the value is NULL
+  static std::optional<int64_t> first_value(CachedStatement& statement)
+  {
+    if (!statement->executeStep() || statement->getColumn(0).isNull())
+    {
+      return std::nullopt;
+    }
+    return statement->getColumn(0).getInt64();
+  }
+
+  SQLite::Database m_db{":memory:", SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE};
+};
+} // namespace
+
+TEST_F(OdaiSqliteStatementCacheTest, ReleasedStatementIsReusedResetAndWithoutBindings)
+{
+  OdaiSqliteStatementCache cache;
+  const SQLite::Statement* prepared = nullptr;
+  {
+    CachedStatement statement = cache.borrow(m_db, "SELECT :value");
+    prepared = &*statement;
+    statement->bind(":value", 7);
+    EXPECT_EQ(first_value(statement), std::optional<int64_t>{7});
+  }
+  {
+    // the bindings of the previous borrower are cleared, the statement is the prepared one
+    CachedStatement statement = cache.borrow(m_db, "SELECT :value");
+    EXPECT_EQ(&*statement, prepared);
+    EXPECT_EQ(first_value(statement), std::nullopt);
+  }
+
+  {
+    // released mid step
+    CachedStatement statement = cache.borrow(m_db, SELECT_ROWS_SQL);
+    EXPECT_EQ(first_value(statement), std::optional<int64_t>{1});
+  }
+  {
+    CachedStatement statement = cache.borrow(m_db, SELECT_ROWS_SQL);
+    EXPECT_EQ(first_value(statement), std::optional<int64_t>{1});
+    EXPECT_EQ(first_value(statement), std::optional<int64_t>{2});
+  }
+  EXPECT_EQ(cache.size(), 2U);
+
+  // no released statement keeps reading the table, it can be dropped
+  EXPECT_NO_THROW(m_db.exec("DROP TABLE rows"));
+}
+
+TEST_F(OdaiSqliteStatementCacheTest, StatementBorrowedWhileInUseIsPreparedUncached)
+{
+  OdaiSqliteStatementCache cache;
+  CachedStatement outer = cache.borrow(m_db, SELECT_ROWS_SQL);
+  EXPECT_EQ(first_value(outer), std::optional<int64_t>{1});
+  const SQLite::Statement* prepared = &*outer;
+
+  {
+    // a nested call running the same SQL steps its own statement and leaves the outer one where it was
+    CachedStatement nested = cache.borrow(m_db, SELECT_ROWS_SQL);
+    EXPECT_NE(&*nested, prepared);
+    EXPECT_EQ(first_value(nested), std::optional<int64_t>{1});
+    EXPECT_EQ(cache.size(), 1U);
+  }
+  EXPECT_EQ(first_value(outer), std::optional<int64_t>{2});
+}
+
+TEST_F(OdaiSqliteStatementCacheTest, FullCacheDropsItsIdleStatements)
+{
+  OdaiSqliteStatementCache cache;
+  CachedStatement held = cache.borrow(m_db, SELECT_ROWS_SQL);
+  for (size_t i = 1; i < OdaiSqliteStatementCache::DEFAULT_CAPACITY; ++i)
+  {
+    CachedStatement statement = cache.borrow(m_db, "SELECT " + std::to_string(i));
+  }
+  EXPECT_EQ(cache.size(), OdaiSqliteStatementCache::DEFAULT_CAPACITY);
+
+  // the statement past the capacity finalizes the idle ones, the held one stays usable
+  CachedStatement statement = cache.borrow(m_db, "SELECT 0");
+  EXPECT_EQ(cache.size(), 2U);
+  EXPECT_TRUE(cache.contains(SELECT_ROWS_SQL));
+  EXPECT_TRUE(cache.contains("SELECT 0"));
+  EXPECT_FALSE(cache.contains("SELECT 1"));
+  EXPECT_EQ(first_value(held), std::optional<int64_t>{1});
+}
+
+TEST_F(OdaiSqliteStatementCacheTest, ZeroCapacityPreparesEveryStatementUncached)
+{
+  OdaiSqliteStatementCache cache(0);
+  {
+    CachedStatement statement = cache.borrow(m_db, SELECT_ROWS_SQL);
+    EXPECT_EQ(first_value(statement), std::optional<int64_t>{1});
+  }
+  EXPECT_EQ(cache.size(), 0U);
+}
+
+TEST_F(OdaiSqliteStatementCacheTest, EvictedStatementsOfADroppedTableAreNotReusedForItsRecreation)
+{
+  OdaiSqliteStatementCache cache;
+  const std::string select_vectors = "SELECT * FROM vec_space_1";
+  m_db.exec("CREATE TABLE vec_space_1 (a INTEGER)");
+  m_db.exec("CREATE TABLE vec_space_10 (a INTEGER)");
+  {
+    CachedStatement statement = cache.borrow(m_db, select_vectors);
+    EXPECT_EQ(statement->getColumnCount(), 1);
+  }
+  {
+    CachedStatement other = cache.borrow(m_db, SELECT_ROWS_SQL);
+  }
+
+  // a held statement naming the table survives the eviction, the idle ones go
+  CachedStatement held = cache.borrow(m_db, "SELECT * FROM vec_space_10");
+  cache.evict_containing("vec_space_1");
+  EXPECT_FALSE(cache.contains(select_vectors));
+  EXPECT_TRUE(cache.contains("SELECT * FROM vec_space_10"));
+  EXPECT_TRUE(cache.contains(SELECT_ROWS_SQL));
+
+  // the table comes back with other columns, the statement is prepared against the new one
+  m_db.exec("DROP TABLE vec_space_1");
+  m_db.exec("CREATE TABLE vec_space_1 (a INTEGER, b INTEGER)");
+  CachedStatement statement = cache.borrow(m_db, select_vectors);
+  EXPECT_EQ(statement->getColumnCount(), 2);
+}
@@ -0,0 +1,33 @@
+#include "db/odai_vector_quantization.h"
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(OdaiVectorQuantizationTest, Int8ScalesLargestComponentToFullRange)
+{
+  EXPECT_EQ(quantize_int8({0.5F, -0.25F, 0.0F, 0.125F}), (std::vector<int8_t>{127, -64, 0, 32}));
+  // only the direction matters
+  EXPECT_EQ(quantize_int8({4.0F, -2.0F}), quantize_int8({0.5F, -0.25F}));
+  EXPECT_EQ(quantize_int8({0.0F, 0.0F}), (std::vector<int8_t>{0, 0}));
+  EXPECT_TRUE(quantize_int8({}).empty());
+}
+
+TEST(OdaiVectorQuantizationTest, BinaryPacksSignsLeastSignificantBitFirst)
+{
+  EXPECT_EQ(quantize_binary({1.0F, -1.0F, 0.5F, 0.0F, 0.0F, 0.0F, 0.0F, 2.0F}), (std::vector<uint8_t>{0x85}));
+  // a partial last byte is padded with zero bits
+  EXPECT_EQ(quantize_binary({-1.0F, -1.0F, -1.0F, -1.0F, -1.0F, -1.0F, -1.0F, -1.0F, 3.0F, 1.0F}),
+            (std::vector<uint8_t>{0x00, 0x03}));
+  EXPECT_EQ(binary_quantized_bytes(10), 2U);
+  EXPECT_EQ(binary_quantized_bytes(1024), 128U);
+}
+
+TEST(OdaiVectorQuantizationTest, QuantizeVectorFollowsStorageType)
+{
+  const std::vector<float> vector = {0.5F, -0.25F};
+  EXPECT_TRUE(quantize_vector(vector, VECTOR_STORAGE_FLOAT32).empty());
+  EXPECT_EQ(quantize_vector(vector, VECTOR_STORAGE_INT8), (std::vector<uint8_t>{127, 192}));
+  EXPECT_EQ(quantize_vector(vector, VECTOR_STORAGE_BINARY), (std::vector<uint8_t>{0x01}));
+}
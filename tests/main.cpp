@@ -485,6 +485,28 @@ static bool test_chat_multimodal(const char* model_name)
   return true;
 }
 
+static bool test_cache_stats()
+{
+  std::cout << "\n--- Testing Cache Stats ---\n";
+
+  c_CacheStats stats{};
+  c_OdaiResult res = odai_get_cache_stats(&stats);
+  if (res != ODAI_SUCCESS)
+  {
+    std::cerr << "Failed to get cache stats: " << odai_result_to_string(res) << " (" << res << ")\n";
+    return false;
+  }
+
+  std::cout << "Query embeddings: " << stats.m_queryEmbeddingHits << " hits, " << stats.m_queryEmbeddingMisses
+            << " misses, " << stats.m_queryEmbeddingEntries << " cached\n";
+  std::cout << "Retrieval results: " << stats.m_retrievalHits << " hits, " << stats.m_retrievalMisses << " misses, "
+            << stats.m_retrievalStaleEntries << " stale, " << stats.m_retrievalEntries << " cached in "
+            << stats.m_retrievalBytes << " bytes\n";
+  std::cout << "Token counts: " << stats.m_tokenCountHits << " hits, " << stats.m_tokenCountMisses << " misses, "
+            << stats.m_tokenCountEntries << " cached\n";
+  return true;
+}
+
 static bool test_shutdown_reinitialize()
 {
   std::cout << "\n--- Testing Shutdown And Reinitialize ---\n";
@@ -602,6 +624,8 @@ int main(int argc, char** argv)
     test_chat_multimodal(QWEN_OMNI_MODEL_NAME);
   }
 
+  test_cache_stats();
+
   // if (!test_shutdown_reinitialize())
   // {
   //   return 1;
@@ -0,0 +1,95 @@
+#include "utils/odai_bounded_queue.h"
+
+#include <chrono>
+#include <future>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+TEST(OdaiBoundedQueueTest, ItemsArePoppedInPushOrderAndDepthIsSampled)
+{
+  OdaiBoundedQueue<int> queue(4);
+  EXPECT_TRUE(queue.push(1));
+  EXPECT_TRUE(queue.push(2));
+  EXPECT_TRUE(queue.push(3));
+
+  EXPECT_EQ(queue.pop(), 1);
+  EXPECT_EQ(queue.try_pop(), 2);
+  EXPECT_EQ(queue.pop(), 3);
+  EXPECT_EQ(queue.try_pop(), std::nullopt);
+
+  // depths seen by the pushes were 1, 2 and 3
+  EXPECT_EQ(queue.max_depth(), 3U);
+  EXPECT_DOUBLE_EQ(queue.average_depth(), 2.0);
+}
+
+TEST(OdaiBoundedQueueTest, FullQueueBlocksProducersUntilAnItemIsPopped)
+{
+  OdaiBoundedQueue<int> queue(1);
+  ASSERT_TRUE(queue.push(1));
+
+  std::future<bool> blocked = std::async(std::launch::async, [&queue] { return queue.push(2); });
+  EXPECT_EQ(blocked.wait_for(50ms), std::future_status::timeout);
+
+  EXPECT_EQ(queue.try_pop(), 1);
+  EXPECT_TRUE(blocked.get());
+  EXPECT_EQ(queue.pop(), 2);
+  EXPECT_EQ(queue.max_depth(), 1U);
+}
+
+TEST(OdaiBoundedQueueTest, ClosedQueueRejectsPushesAndDrainsRemainingItems)
+{
+  OdaiBoundedQueue<int> queue(4);
+  ASSERT_TRUE(queue.push(1));
+  ASSERT_TRUE(queue.push(2));
+  queue.close();
+
+  EXPECT_FALSE(queue.push(3));
+  EXPECT_EQ(queue.pop(), 1);
+  EXPECT_EQ(queue.pop(), 2);
+  EXPECT_EQ(queue.pop(), std::nullopt);
+  EXPECT_EQ(queue.try_pop(), std::nullopt);
+}
+
+TEST(OdaiBoundedQueueTest, CloseWakesBlockedProducersAndConsumers)
+{
+  // a pipeline aborting closes its queues while producers wait on full ones and consumers on empty ones
+  OdaiBoundedQueue<int> full(1);
+  ASSERT_TRUE(full.push(1));
+  OdaiBoundedQueue<int> empty(1);
+
+  std::vector<std::future<bool>> producers;
+  for (int i = 0; i < 3; ++i)
+  {
+    producers.push_back(std::async(std::launch::async, [&full, i] { return full.push(i + 2); }));
+  }
+  std::future<std::optional<int>> consumer = std::async(std::launch::async, [&empty] { return empty.pop(); });
+  for (std::future<bool>& producer : producers)
+  {
+    EXPECT_EQ(producer.wait_for(20ms), std::future_status::timeout);
+  }
+  EXPECT_EQ(consumer.wait_for(20ms), std::future_status::timeout);
+
+  full.close();
+  empty.close();
+  for (std::future<bool>& producer : producers)
+  {
+    EXPECT_FALSE(producer.get());
+  }
+  EXPECT_EQ(consumer.get(), std::nullopt);
+
+  // the item queued before closing is still handed out
+  EXPECT_EQ(full.pop(), 1);
+  EXPECT_EQ(full.pop(), std::nullopt);
+}
+
+TEST(OdaiBoundedQueueTest, CapacityIsAtLeastOne)
+{
+  OdaiBoundedQueue<int> queue(0);
+  EXPECT_TRUE(queue.push(1));
+  EXPECT_EQ(queue.pop(), 1);
+}
@@ -0,0 +1,86 @@
+#include "ragEngine/odai_chunker.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+constexpr size_t BENCHMARK_CONTENT_BYTES = size_t{64} << 20;
+constexpr int BENCHMARK_REPETITIONS = 3;
+
+/// Builds prose-like text with words, sentences, paragraphs and multi-byte characters.
+std::string make_benchmark_text(size_t min_size)
+{
+  const std::vector<std::string> words = {"the", "chunker", "héllo", "wörld", "€uro", "vector", "embedding", "token"};
+  std::string text;
+  text.reserve(min_size + 64);
+  uint32_t state = 12345;
+  while (text.size() < min_size)
+  {
+    state = state * 1103515245U + 12345U;
+    text += words[(state >> 16) % words.size()];
+    switch ((state >> 8) % 16)
+    {
+    case 0:
+      text += ". ";
+      break;
+    case 1:
+      text += "\n";
+      break;
+    case 2:
+      text += ".\n\n";
+      break;
+    default:
+      text += " ";
+      break;
+    }
+  }
+  return text;
+}
+
+/// Runs fn BENCHMARK_REPETITIONS times and returns the best throughput in GB/s.
+template <typename Fn>
+double best_throughput_gbps(size_t bytes, Fn&& fn)
+{
+  double best_seconds = 0.0;
+  for (int i = 0; i < BENCHMARK_REPETITIONS; ++i)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (i == 0 || seconds < best_seconds)
+    {
+      best_seconds = seconds;
+    }
+  }
+  return static_cast<double>(bytes) / best_seconds / 1e9;
+}
+} // namespace
+
+TEST(OdaiChunkerBenchmark, BoundaryAwareChunkingThroughput)
+{
+  const std::string content = make_benchmark_text(BENCHMARK_CONTENT_BYTES);
+
+  FixedSizeChunkingConfig fixed_config;
+  BoundaryAwareChunkingConfig boundary_config;
+  size_t fixed_chunks = 0;
+  size_t boundary_chunks = 0;
+
+  const double fixed_gbps =
+      best_throughput_gbps(content.size(), [&] { fixed_chunks = chunk_fixed_size(content, fixed_config).size(); });
+  const double boundary_gbps = best_throughput_gbps(
+      content.size(), [&] { boundary_chunks = chunk_boundary_aware(content, boundary_config).size(); });
+
+  ASSERT_GT(fixed_chunks, 0U);
+  ASSERT_GT(boundary_chunks, 0U);
+  // chunking includes copying and hashing every chunk, the boundary scan itself only reads the tolerance windows
+  RecordProperty("fixed_size_gbps", std::to_string(fixed_gbps));
+  RecordProperty("boundary_aware_gbps", std::to_string(boundary_gbps));
+  std::cout << "[ BENCHMARK ] " << content.size() << " bytes, fixed size: " << fixed_gbps << " GB/s (" << fixed_chunks
+            << " chunks), boundary aware: " << boundary_gbps << " GB/s (" << boundary_chunks << " chunks)\n";
+}
@@ -0,0 +1,238 @@
+#include "ragEngine/odai_chunker.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+std::vector<std::string> chunk_texts(const std::vector<DocumentChunk>& chunks)
+{
+  std::vector<std::string> texts;
+  texts.reserve(chunks.size());
+  for (const DocumentChunk& chunk : chunks)
+  {
+    texts.push_back(chunk.m_contentText);
+  }
+  return texts;
+}
+
+bool starts_mid_character(const std::string& text)
+{
+  return !text.empty() && (static_cast<unsigned char>(text.front()) & 0xC0) == 0x80;
+}
+
+/// Builds text longer than a SIMD block, mixing words, sentences, newlines and multi-byte characters.
+std::string make_mixed_text(size_t min_size)
+{
+  const std::vector<std::string> pieces = {"alpha ", "héllo wörld. ", "€uro\n", "𝄞 note! ", "line\n\n", "why? ", "x"};
+  std::string text;
+  for (size_t i = 0; text.size() < min_size; ++i)
+  {
+    text += pieces[(i * 7 + i / 3) % pieces.size()];
+  }
+  return text;
+}
+
+BoundaryAwareChunkingConfig make_boundary_config(uint32_t chunk_size, uint32_t overlap, uint32_t tolerance)
+{
+  BoundaryAwareChunkingConfig config;
+  config.m_chunkSize = chunk_size;
+  config.m_chunkOverlap = overlap;
+  config.m_boundaryTolerance = tolerance;
+  return config;
+}
+
+TokenAwareChunkingConfig make_token_config(uint32_t chunk_size, uint32_t overlap)
+{
+  TokenAwareChunkingConfig config;
+  config.m_chunkSize = chunk_size;
+  config.m_chunkOverlap = overlap;
+  return config;
+}
+
+/// Stand-in tokenizer producing one token per non-whitespace byte, the token id being the byte value
+std::vector<TokenId> byte_tokens(std::string_view text)
+{
+  std::vector<TokenId> tokens;
+  for (char byte : text)
+  {
+    if (byte != ' ' && byte != '\n')
+    {
+      tokens.push_back(static_cast<unsigned char>(byte));
+    }
+  }
+  return tokens;
+}
+
+ChunkTokenizerFn make_byte_tokenizer(size_t& calls)
+{
+  return [&calls](const std::vector<std::string>& texts) -> OdaiResult<std::vector<std::vector<TokenId>>>
+  {
+    calls++;
+    std::vector<std::vector<TokenId>> tokens;
+    for (const std::string& text : texts)
+    {
+      tokens.push_back(byte_tokens(text));
+    }
+    return tokens;
+  };
+}
+} // namespace
+
+TEST(OdaiChunkerTest, FixedSizeChunkerMatchesWholeContentChunkingForAnyPartSplit)
+{
+  const std::string content = make_mixed_text(5000);
+  FixedSizeChunkingConfig config;
+  config.m_chunkSize = 37;
+  config.m_chunkOverlap = 9;
+  const std::vector<std::string> expected = chunk_texts(chunk_fixed_size(content, config));
+
+  for (size_t part_size : {1U, 3U, 40U, 41U, 1000U})
+  {
+    FixedSizeChunker chunker(config);
+    std::vector<DocumentChunk> chunks;
+    for (size_t pos = 0; pos < content.size(); pos += part_size)
+    {
+      chunker.feed(std::string_view(content).substr(pos, part_size), chunks);
+    }
+    chunker.finish(chunks);
+
+    EXPECT_EQ(chunk_texts(chunks), expected) << "part size " << part_size;
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+      EXPECT_EQ(chunks[i].m_sequenceIndex, i);
+    }
+  }
+}
+
+TEST(OdaiChunkerTest, BoundaryAwareChunkingPrefersParagraphThenSentenceThenWord)
+{
+  const BoundaryAwareChunkingConfig config = make_boundary_config(20, 0, 12);
+
+  EXPECT_EQ(chunk_texts(chunk_boundary_aware("First para.\n\nNext one here", config)),
+            (std::vector<std::string>{"First para.\n\n", "Next one here"}));
+  EXPECT_EQ(chunk_texts(chunk_boundary_aware("One two. Three four five six", config)),
+            (std::vector<std::string>{"One two. ", "Three four five six"}));
+  EXPECT_EQ(chunk_texts(chunk_boundary_aware("One two three four five six", config)),
+            (std::vector<std::string>{"One two three four ", "five six"}));
+}
+
+TEST(OdaiChunkerTest, BoundaryAwareChunkingFallsBackToCharacterBoundaryOutsideTolerance)
+{
+  // no space within the tolerance, the edge must still not split the 3 byte euro signs
+  const std::string content = "word " + std::string(30, 'a') + "€€€€€€€€";
+  const std::vector<DocumentChunk> chunks = chunk_boundary_aware(content, make_boundary_config(40, 0, 4));
+
+  ASSERT_GE(chunks.size(), 2U);
+  std::string rebuilt;
+  for (const DocumentChunk& chunk : chunks)
+  {
+    EXPECT_LE(chunk.m_contentText.size(), 40U);
+    EXPECT_FALSE(starts_mid_character(chunk.m_contentText));
+    rebuilt += chunk.m_contentText;
+  }
+  EXPECT_EQ(rebuilt, content);
+}
+
+TEST(OdaiChunkerTest, BoundaryAwareChunkingKeepsOverlapAndCoversLongContent)
+{
+  const std::string content = make_mixed_text(20000);
+  const std::vector<DocumentChunk> chunks = chunk_boundary_aware(content, make_boundary_config(200, 40, 64));
+
+  ASSERT_GT(chunks.size(), 1U);
+  size_t search_from = 0;
+  for (size_t i = 0; i < chunks.size(); ++i)
+  {
+    const std::string& text = chunks[i].m_contentText;
+    EXPECT_EQ(chunks[i].m_sequenceIndex, i);
+    EXPECT_LE(text.size(), 200U);
+    EXPECT_FALSE(starts_mid_character(text));
+
+    const size_t pos = content.find(text, search_from);
+    ASSERT_NE(pos, std::string::npos) << "chunk " << i << " is not a slice of the content";
+    if (i + 1 < chunks.size())
+    {
+      // every chunk but the last ends right after whitespace, its end was snapped to a boundary
+      const char last = text.back();
+      EXPECT_TRUE(last == ' ' || last == '\n') << "chunk " << i;
+    }
+    search_from = pos + 1;
+  }
+  EXPECT_TRUE(content.ends_with(chunks.back().m_contentText));
+}
+
+TEST(OdaiChunkerTest, ChunkDocumentDispatchesStrategiesAndRejectsInvalidConfigs)
+{
+  ChunkingConfig config;
+  config.m_config = make_boundary_config(20, 0, 12);
+  OdaiResult<std::vector<DocumentChunk>> chunks = chunk_document("One two. Three four five six", config);
+  ASSERT_TRUE(chunks.has_value());
+  EXPECT_EQ(chunk_texts(chunks.value()), (std::vector<std::string>{"One two. ", "Three four five six"}));
+
+  config.m_config = make_boundary_config(20, 0, 20);
+  OdaiResult<std::vector<DocumentChunk>> invalid = chunk_document("text", config);
+  ASSERT_FALSE(invalid.has_value());
+  EXPECT_EQ(invalid.error(), OdaiResultEnum::INVALID_ARGUMENT);
+}
+
+TEST(OdaiChunkerTest, TokenAwareChunkingFitsTokenBudgetAndKeepsTokensOfWholeWords)
+{
+  const std::string content = make_mixed_text(5000);
+  size_t tokenizer_calls = 0;
+  OdaiResult<std::vector<DocumentChunk>> chunks =
+      chunk_token_aware(content, make_token_config(50, 0), make_byte_tokenizer(tokenizer_calls));
+
+  ASSERT_TRUE(chunks.has_value());
+  ASSERT_GT(chunks->size(), 1U);
+  EXPECT_EQ(tokenizer_calls, 1U);
+
+  std::string rebuilt;
+  for (size_t i = 0; i < chunks->size(); ++i)
+  {
+    const DocumentChunk& chunk = chunks->at(i);
+    EXPECT_EQ(chunk.m_sequenceIndex, i);
+    EXPECT_LE(chunk.m_tokenCount, 50U);
+    EXPECT_EQ(chunk.m_tokenIds.size(), chunk.m_tokenCount);
+    // cut between words, so the kept tokens are exactly the tokens of the chunk text
+    EXPECT_EQ(chunk.m_tokenIds, byte_tokens(chunk.m_contentText)) << "chunk " << i;
+    EXPECT_FALSE(starts_mid_character(chunk.m_contentText));
+    rebuilt += chunk.m_contentText;
+  }
+  EXPECT_EQ(rebuilt, content);
+}
+
+TEST(OdaiChunkerTest, TokenAwareChunkingOverlapsTrailingWordsWithinOverlapTokens)
+{
+  size_t tokenizer_calls = 0;
+  OdaiResult<std::vector<DocumentChunk>> chunks =
+      chunk_token_aware("aa bb cc dd ee ff", make_token_config(6, 4), make_byte_tokenizer(tokenizer_calls));
+
+  ASSERT_TRUE(chunks.has_value());
+  EXPECT_EQ(chunk_texts(chunks.value()), (std::vector<std::string>{"aa bb cc", " bb cc dd", " cc dd ee", " dd ee ff"}));
+}
+
+TEST(OdaiChunkerTest, TokenAwareChunkingNeedsWorkingTokenizer)
+{
+  ChunkingConfig config;
+  config.m_config = make_token_config(50, 10);
+  OdaiResult<std::vector<DocumentChunk>> without_tokenizer = chunk_document("some text", config);
+  ASSERT_FALSE(without_tokenizer.has_value());
+  EXPECT_EQ(without_tokenizer.error(), OdaiResultEnum::INVALID_ARGUMENT);
+
+  const ChunkTokenizerFn failing_tokenizer =
+      [](const std::vector<std::string>&) -> OdaiResult<std::vector<std::vector<TokenId>>>
+  { return tl::unexpected(OdaiResultEnum::NOT_INITIALIZED); };
+  OdaiResult<std::vector<DocumentChunk>> failed = chunk_document("some text", config, failing_tokenizer);
+  ASSERT_FALSE(failed.has_value());
+  EXPECT_EQ(failed.error(), OdaiResultEnum::NOT_INITIALIZED);
+
+  // chunks must leave room for the special tokens inside the embedding context window
+  config.m_config = make_token_config(DEFAULT_EMBEDDING_CONTEXT_WINDOW, 10);
+  OdaiResult<std::vector<DocumentChunk>> oversized = chunk_document("some text", config, failing_tokenizer);
+  ASSERT_FALSE(oversized.has_value());
+  EXPECT_EQ(oversized.error(), OdaiResultEnum::INVALID_ARGUMENT);
+}
@@ -0,0 +1,159 @@
+#include "ragEngine/odai_context_expansion.h"
+
+#include "odai_test_helpers.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using odai::test::expect_error;
+
+namespace
+{
+RetrievedChunk make_hit(const DocumentId& document_id, uint32_t sequence_index, float score)
+{
+  RetrievedChunk chunk;
+  chunk.m_documentId = document_id;
+  chunk.m_sourceUri = "file://" + document_id;
+  chunk.m_sequenceIndex = sequence_index;
+  chunk.m_contentText = document_id + ":" + std::to_string(sequence_index);
+  chunk.m_score = score;
+  return chunk;
+}
+
+/// Fake document store holding chunk texts by document and position, recording every read's spans
+struct FakeChunkStore
+{
+  OdaiResult<std::vector<std::vector<DocumentChunk>>> operator()(const std::vector<DocumentChunkSpan>& spans)
+  {
+    m_reads.push_back(spans);
+    std::vector<std::vector<DocumentChunk>> result;
+    for (const DocumentChunkSpan& span : spans)
+    {
+      std::vector<DocumentChunk>& span_chunks = result.emplace_back();
+      const std::vector<std::string>& texts = m_documents[span.m_documentId];
+      for (uint32_t i = span.m_firstSequenceIndex; i <= span.m_lastSequenceIndex && i < texts.size(); ++i)
+      {
+        DocumentChunk chunk;
+        chunk.m_sequenceIndex = i;
+        chunk.m_contentText = texts[i];
+        span_chunks.push_back(chunk);
+      }
+    }
+    return result;
+  }
+
+  std::map<DocumentId, std::vector<std::string>> m_documents;
+  std::vector<std::vector<DocumentChunkSpan>> m_reads;
+};
+
+FakeChunkStore make_store()
+{
+  FakeChunkStore store;
+  store.m_documents["a"] = {"a0 ", "a1 ", "a2 ", "a3 ", "a4 ", "a5 ", "a6 ", "a7 ", "a8 ", "a9 "};
+  store.m_documents["b"] = {"b0 ", "b1 ", "b2 "};
+  return store;
+}
+} // namespace
+
+TEST(OdaiContextExpansionTest, OverlappingWindowsMergeIntoOnePassagePerSpan)
+{
+  FakeChunkStore store = make_store();
+  const std::vector<RetrievedChunk> hits = {make_hit("a", 5, 0.9F), make_hit("b", 0, 0.8F), make_hit("a", 3, 0.7F),
+                                            make_hit("a", 9, 0.6F)};
+
+  OdaiResult<std::vector<RetrievedChunk>> res = expand_chunk_context(hits, 1, false, std::ref(store));
+
+  ASSERT_TRUE(res.has_value());
+  ASSERT_EQ(res->size(), 3U);
+  // windows 2-4 and 4-6 overlap into one passage, window 8-10 is apart from both
+  EXPECT_EQ(res->at(0).m_contentText, "a2 a3 a4 a5 a6 ");
+  EXPECT_EQ(res->at(0).m_sequenceIndex, 2U);
+  EXPECT_EQ(res->at(0).m_sequenceCount, 5U);
+  EXPECT_FLOAT_EQ(res->at(0).m_score, 0.9F);
+  EXPECT_EQ(res->at(0).m_sourceUri, "file://a");
+  EXPECT_EQ(res->at(1).m_contentText, "b0 b1 ");
+  EXPECT_EQ(res->at(1).m_sequenceIndex, 0U);
+  EXPECT_FLOAT_EQ(res->at(1).m_score, 0.8F);
+  EXPECT_EQ(res->at(2).m_contentText, "a8 a9 ");
+  EXPECT_EQ(res->at(2).m_sequenceCount, 2U);
+  EXPECT_FLOAT_EQ(res->at(2).m_score, 0.6F);
+
+  // every span is read in one call
+  ASSERT_EQ(store.m_reads.size(), 1U);
+  EXPECT_EQ(store.m_reads[0].size(), 3U);
+}
+
+TEST(OdaiContextExpansionTest, TouchingWindowsJoinWithoutDuplicatingText)
+{
+  FakeChunkStore store = make_store();
+  const std::vector<RetrievedChunk> hits = {make_hit("a", 7, 0.9F), make_hit("a", 4, 0.5F)};
+
+  // windows 3-5 and 6-8 are consecutive in the document
+  OdaiResult<std::vector<RetrievedChunk>> res = expand_chunk_context(hits, 1, false, std::ref(store));
+
+  ASSERT_TRUE(res.has_value());
+  ASSERT_EQ(res->size(), 1U);
+  EXPECT_EQ(res->front().m_contentText, "a3 a4 a5 a6 a7 a8 ");
+  EXPECT_FLOAT_EQ(res->front().m_score, 0.9F);
+}
+
+TEST(OdaiContextExpansionTest, OverlappingChunksAreJoinedOnTheirSharedText)
+{
+  FakeChunkStore store;
+  store.m_documents["a"] = {"The quick brown ", "brown fox jumps ", "jumps over"};
+
+  OdaiResult<std::vector<RetrievedChunk>> res =
+      expand_chunk_context({make_hit("a", 1, 0.9F)}, 1, true, std::ref(store));
+
+  ASSERT_TRUE(res.has_value());
+  ASSERT_EQ(res->size(), 1U);
+  EXPECT_EQ(res->front().m_contentText, "The quick brown fox jumps over");
+  EXPECT_EQ(res->front().m_sequenceCount, 3U);
+}
+
+TEST(OdaiContextExpansionTest, AppendWithoutOverlapDropsTheLongestSharedPrefix)
+{
+  std::string passage = "abcabca";
+  append_without_overlap(passage, "bcabcd");
+  EXPECT_EQ(passage, "abcabcabcd");
+
+  std::string no_overlap = "hello ";
+  append_without_overlap(no_overlap, "world");
+  EXPECT_EQ(no_overlap, "hello world");
+
+  std::string contained = "one two";
+  append_without_overlap(contained, "two");
+  EXPECT_EQ(contained, "one two");
+
+  std::string empty;
+  append_without_overlap(empty, "first");
+  EXPECT_EQ(empty, "first");
+}
+
+TEST(OdaiContextExpansionTest, ZeroWindowMissingDocumentsAndReadErrors)
+{
+  FakeChunkStore store = make_store();
+  const std::vector<RetrievedChunk> hits = {make_hit("gone", 2, 0.9F), make_hit("b", 2, 0.5F)};
+
+  OdaiResult<std::vector<RetrievedChunk>> unchanged = expand_chunk_context(hits, 0, false, std::ref(store));
+  ASSERT_TRUE(unchanged.has_value());
+  EXPECT_EQ(unchanged->size(), 2U);
+  EXPECT_TRUE(store.m_reads.empty());
+
+  // a document deleted since the search keeps its hit alone
+  OdaiResult<std::vector<RetrievedChunk>> res = expand_chunk_context(hits, 2, false, std::ref(store));
+  ASSERT_TRUE(res.has_value());
+  ASSERT_EQ(res->size(), 2U);
+  EXPECT_EQ(res->at(0).m_contentText, "gone:2");
+  EXPECT_EQ(res->at(0).m_sequenceCount, 1U);
+  EXPECT_EQ(res->at(1).m_contentText, "b0 b1 b2 ");
+  EXPECT_EQ(store.m_reads[0][1].m_firstSequenceIndex, 0U);
+  EXPECT_EQ(store.m_reads[0][1].m_lastSequenceIndex, 4U);
+
+  ChunkSpanReadFn failing = [](const std::vector<DocumentChunkSpan>&)
+      -> OdaiResult<std::vector<std::vector<DocumentChunk>>> { return tl::unexpected(OdaiResultEnum::NOT_FOUND); };
+  expect_error(expand_chunk_context(hits, 1, false, failing), OdaiResultEnum::NOT_FOUND);
+}
@@ -0,0 +1,61 @@
+#include "ragEngine/odai_context_packing.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+std::vector<RetrievedChunk> make_chunks(const std::vector<std::string>& texts)
+{
+  std::vector<RetrievedChunk> chunks;
+  float score = 1.0F;
+  for (const std::string& text : texts)
+  {
+    RetrievedChunk chunk;
+    chunk.m_documentId = "doc";
+    chunk.m_contentText = text;
+    chunk.m_score = score;
+    score -= 0.1F;
+    chunks.push_back(chunk);
+  }
+  return chunks;
+}
+
+std::vector<std::string> texts_of(const std::vector<RetrievedChunk>& chunks)
+{
+  std::vector<std::string> texts;
+  for (const RetrievedChunk& chunk : chunks)
+  {
+    texts.push_back(chunk.m_contentText);
+  }
+  return texts;
+}
+} // namespace
+
+TEST(OdaiContextPackingTest, KeepsChunksByRelevanceAndSkipsThoseThatDontFit)
+{
+  uint32_t used_tokens = 0;
+  std::vector<RetrievedChunk> packed =
+      pack_chunks_into_budget(make_chunks({"best", "long", "short", "tiny"}), {40, 50, 30, 5}, 80, used_tokens);
+
+  // long doesn't fit after best, the less relevant short and tiny still use the room
+  EXPECT_EQ(texts_of(packed), (std::vector<std::string>{"best", "short", "tiny"}));
+  EXPECT_EQ(used_tokens, 75U);
+}
+
+TEST(OdaiContextPackingTest, ExactFitAndEmptyBudget)
+{
+  uint32_t used_tokens = 0;
+  std::vector<RetrievedChunk> packed = pack_chunks_into_budget(make_chunks({"a", "b"}), {10, 20}, 30, used_tokens);
+  EXPECT_EQ(texts_of(packed), (std::vector<std::string>{"a", "b"}));
+  EXPECT_EQ(used_tokens, 30U);
+
+  packed = pack_chunks_into_budget(make_chunks({"a", "b"}), {10, 20}, 0, used_tokens);
+  EXPECT_TRUE(packed.empty());
+  EXPECT_EQ(used_tokens, 0U);
+
+  packed = pack_chunks_into_budget({}, {}, 100, used_tokens);
+  EXPECT_TRUE(packed.empty());
+}
@@ -0,0 +1,40 @@
+#include "ragEngine/odai_embedding_truncation.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(OdaiEmbeddingTruncationTest, KeepsPrefixAndRenormalizesIt)
+{
+  std::vector<float> embedding = {0.6F, 0.0F, 0.8F, 0.0F};
+  ASSERT_TRUE(truncate_embedding(embedding, 2));
+  ASSERT_EQ(embedding.size(), 2U);
+  EXPECT_NEAR(embedding[0], 1.0F, 1e-6F);
+  EXPECT_NEAR(embedding[1], 0.0F, 1e-6F);
+
+  std::vector<float> mixed = {3.0F, -4.0F, 12.0F};
+  ASSERT_TRUE(truncate_embedding(mixed, 2));
+  EXPECT_NEAR(mixed[0], 0.6F, 1e-6F);
+  EXPECT_NEAR(mixed[1], -0.8F, 1e-6F);
+}
+
+TEST(OdaiEmbeddingTruncationTest, LeavesFullOrZeroDimensionsUnchanged)
+{
+  const std::vector<float> original = {2.0F, 1.0F};
+  std::vector<float> embedding = original;
+  EXPECT_TRUE(truncate_embedding(embedding, 0));
+  EXPECT_EQ(embedding, original);
+  EXPECT_TRUE(truncate_embedding(embedding, 2));
+  EXPECT_EQ(embedding, original);
+
+  std::vector<float> zero = {0.0F, 0.0F, 1.0F};
+  ASSERT_TRUE(truncate_embedding(zero, 2));
+  EXPECT_EQ(zero, (std::vector<float>{0.0F, 0.0F}));
+}
+
+TEST(OdaiEmbeddingTruncationTest, RejectsDimensionsBeyondEmbedding)
+{
+  std::vector<float> embedding = {1.0F, 0.0F};
+  EXPECT_FALSE(truncate_embedding(embedding, 3));
+  EXPECT_EQ(embedding, (std::vector<float>{1.0F, 0.0F}));
+}
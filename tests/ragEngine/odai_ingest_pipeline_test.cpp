@@ -0,0 +1,284 @@
+#include "ragEngine/odai_ingest_pipeline.h"
+
+#include "db/odai_db_test_helpers.h"
+#include "db/odai_sqlite/odai_sqlite_db.h"
+#include "odai_rag_test_helpers.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace fs = std::filesystem;
+using odai::test::db_contract::make_model_files;
+using odai::test::db_contract::make_semantic_space;
+using odai::test::rag_engine::FakeEmbeddingBackend;
+
+namespace
+{
+/// SQLite database recording every add_document call and failing those of chosen documents
+class RecordingDb : public OdaiSqliteDb
+{
+public:
+  using OdaiSqliteDb::OdaiSqliteDb;
+
+  OdaiResult<void> add_document(const DocumentId& document_id, const std::string& source_uri,
+                                const SemanticSpaceName& semantic_space_name, const ScopeId& scope_id,
+                                const std::vector<DocumentChunk>& chunks, const DocumentMetadata& metadata) override
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_addedDocuments.push_back(document_id);
+      if (m_failingDocuments.contains(document_id))
+      {
+        return tl::unexpected(OdaiResultEnum::VALIDATION_FAILED);
+      }
+    }
+    if (m_firstAddDelay.count() > 0)
+    {
+      std::this_thread::sleep_for(std::exchange(m_firstAddDelay, std::chrono::milliseconds(0)));
+    }
+    return OdaiSqliteDb::add_document(document_id, source_uri, semantic_space_name, scope_id, chunks, metadata);
+  }
+
+  /// @return the documents add_document was called with, in call order
+  std::vector<DocumentId> added_documents()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_addedDocuments;
+  }
+
+  std::unordered_set<DocumentId> m_failingDocuments;
+  /// Sleep of the first add_document call, lets the documents behind it queue up into one write batch
+  std::chrono::milliseconds m_firstAddDelay{0};
+
+private:
+  std::mutex m_mutex;
+  std::vector<DocumentId> m_addedDocuments;
+};
+
+class OdaiIngestPipelineTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_rootPath = fs::temp_directory_path() /
+                 ("odai_ingest_pipeline_test_" +
+                  std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    fs::create_directories(m_rootPath / "media");
+    m_db = std::make_unique<RecordingDb>(
+        DBConfig{SQLITE_DB, (m_rootPath / "odai.db").string(), (m_rootPath / "media").string()});
+    ASSERT_TRUE(m_db->initialize_db().has_value());
+
+    // 8 byte chunks without overlap, so a document's chunks are the 8 byte pieces of its content
+    m_spaceConfig = make_semantic_space("space");
+    FixedSizeChunkingConfig chunking{};
+    chunking.m_chunkSize = 8;
+    chunking.m_chunkOverlap = 0;
+    m_spaceConfig.m_chunkingConfig.m_config = chunking;
+    ASSERT_TRUE(m_db->create_semantic_space(m_spaceConfig).has_value());
+
+    m_config.m_readerThreads = 1;
+    m_config.m_chunkerThreads = 1;
+    m_config.m_queueCapacity = 4;
+    m_config.m_embeddingBatchSize = 16;
+    m_config.m_writeBatchSize = 8;
+  }
+
+  void TearDown() override
+  {
+    m_db.reset();
+    std::error_code ec;
+    fs::remove_all(m_rootPath, ec);
+  }
+
+  IngestDocumentSource write_source(const DocumentId& document_id, const std::string& content)
+  {
+    const fs::path path = m_rootPath / (document_id + ".txt");
+    std::ofstream(path, std::ios::binary) << content;
+    return {document_id, path.string(), {}};
+  }
+
+  OdaiResult<BulkIngestStats> ingest(const std::vector<IngestDocumentSource>& sources)
+  {
+    OdaiIngestPipeline pipeline(*m_db, m_backend, m_spaceConfig,
+                                make_model_files(ModelType::EMBEDDING, {{"base_model_path", "/tmp/embed.gguf"}}),
+                                R"({"base_model_path":"embed"})", "scope", m_config);
+    return pipeline.run(sources);
+  }
+
+  /// @return the stored chunk texts of a document, empty if it wasn't written
+  std::vector<std::string> stored_chunks(const DocumentId& document_id)
+  {
+    OdaiResult<std::vector<std::vector<DocumentChunk>>> spans =
+        m_db->get_document_chunk_spans("space", {{document_id, 0, 100}});
+    EXPECT_TRUE(spans.has_value());
+    std::vector<std::string> texts;
+    if (spans.has_value())
+    {
+      for (const DocumentChunk& chunk : spans->front())
+      {
+        texts.push_back(chunk.m_contentText);
+      }
+    }
+    return texts;
+  }
+
+  fs::path m_rootPath;
+  std::unique_ptr<RecordingDb> m_db;
+  FakeEmbeddingBackend m_backend;
+  SemanticSpaceConfig m_spaceConfig;
+  BulkIngestConfig m_config;
+};
+} // namespace
+
+TEST_F(OdaiIngestPipelineTest, DocumentsLeaveTheStagesInTheirSourceOrder)
+{
+  std::vector<IngestDocumentSource> sources;
+  std::vector<DocumentId> expected;
+  for (size_t i = 0; i < 20; ++i)
+  {
+    const DocumentId document_id = "doc-" + std::to_string(i);
+    sources.push_back(write_source(document_id, "content" + std::to_string(i % 10) + "-document-" + document_id));
+    expected.push_back(document_id);
+  }
+  m_config.m_queueCapacity = 1;
+  m_config.m_writeBatchSize = 1;
+
+  OdaiResult<BulkIngestStats> stats = ingest(sources);
+  ASSERT_TRUE(stats.has_value());
+  EXPECT_EQ(stats->m_documentsIngested, 20U);
+  EXPECT_EQ(m_db->added_documents(), expected);
+  EXPECT_EQ(stored_chunks("doc-3"), (std::vector<std::string>{"content3", "-documen", "t-doc-3"}));
+}
+
+TEST_F(OdaiIngestPipelineTest, StatsCountIngestedAndFailedDocumentsAndTheirChunks)
+{
+  const std::vector<IngestDocumentSource> sources = {
+      write_source("doc-a", "aaaaaaaabbbbbbbb"), {"doc-missing", (m_rootPath / "missing.txt").string(), {}},
+      write_source("doc-empty", ""), write_source("doc-b", "cccccccc")};
+
+  OdaiResult<BulkIngestStats> stats = ingest(sources);
+  ASSERT_TRUE(stats.has_value());
+  EXPECT_EQ(stats->m_documentsIngested, 2U);
+  EXPECT_EQ(stats->m_documentsFailed, 2U);
+  EXPECT_EQ(stats->m_chunksProcessed, 3U);
+  EXPECT_EQ(stats->m_chunksEmbedded, 3U);
+  EXPECT_EQ(stats->m_stages[INGEST_STAGE_READ].m_itemsProcessed, 3U);
+  EXPECT_EQ(stats->m_stages[INGEST_STAGE_CHUNK].m_itemsProcessed, 2U);
+  EXPECT_EQ(stats->m_stages[INGEST_STAGE_WRITE].m_itemsProcessed, 2U);
+  EXPECT_EQ(stored_chunks("doc-a"), (std::vector<std::string>{"aaaaaaaa", "bbbbbbbb"}));
+  EXPECT_TRUE(stored_chunks("doc-missing").empty());
+}
+
+TEST_F(OdaiIngestPipelineTest, ContentRepeatedAcrossDocumentsIsEmbeddedOnce)
+{
+  OdaiResult<BulkIngestStats> first =
+      ingest({write_source("doc-a", "sharedAAuniqueAA"), write_source("doc-b", "sharedAAuniqueBB"),
+              write_source("doc-c", "uniqueBBsharedAA")});
+  ASSERT_TRUE(first.has_value());
+  EXPECT_EQ(first->m_documentsIngested, 3U);
+  EXPECT_EQ(first->m_chunksProcessed, 6U);
+  EXPECT_EQ(first->m_chunksEmbedded, 3U);
+
+  // content the space already holds isn't embedded by a later run either
+  OdaiResult<BulkIngestStats> second = ingest({write_source("doc-d", "sharedAAuniqueDD")});
+  ASSERT_TRUE(second.has_value());
+  EXPECT_EQ(second->m_chunksEmbedded, 1U);
+
+  std::vector<std::string> embedded = m_backend.embedded_texts();
+  std::sort(embedded.begin(), embedded.end());
+  EXPECT_EQ(embedded, (std::vector<std::string>{"sharedAA", "uniqueAA", "uniqueBB", "uniqueDD"}));
+  EXPECT_EQ(stored_chunks("doc-c"), (std::vector<std::string>{"uniqueBB", "sharedAA"}));
+}
+
+TEST_F(OdaiIngestPipelineTest, FailedWriteBatchIsRetriedOneDocumentPerTransaction)
+{
+  std::vector<IngestDocumentSource> sources;
+  for (size_t i = 0; i < 6; ++i)
+  {
+    sources.push_back(write_source("doc-" + std::to_string(i), "content" + std::to_string(i)));
+  }
+  m_db->m_failingDocuments = {"doc-3"};
+  // the documents not in the first write queue up behind it and are written as one batch, so doc-3 is written in a
+  // batch with others whichever way the first one was cut
+  m_db->m_firstAddDelay = std::chrono::milliseconds(300);
+  m_config.m_queueCapacity = 8;
+
+  OdaiResult<BulkIngestStats> stats = ingest(sources);
+  ASSERT_TRUE(stats.has_value());
+  EXPECT_EQ(stats->m_documentsIngested, 5U);
+  EXPECT_EQ(stats->m_documentsFailed, 1U);
+  // the batch stops at the failing document, rolls back and is written again one document at a time
+  const std::vector<DocumentId> added = m_db->added_documents();
+  EXPECT_EQ(std::count(added.begin(), added.end(), "doc-3"), 2);
+  ASSERT_GE(added.size(), 3U);
+  EXPECT_EQ(std::vector<DocumentId>(added.end() - 3, added.end()),
+            (std::vector<DocumentId>{"doc-3", "doc-4", "doc-5"}));
+  for (const DocumentId& document_id : {"doc-0", "doc-1", "doc-2", "doc-4", "doc-5"})
+  {
+    EXPECT_EQ(stored_chunks(document_id).size(), 1U) << document_id;
+  }
+  EXPECT_TRUE(stored_chunks("doc-3").empty());
+}
+
+TEST_F(OdaiIngestPipelineTest, ContentOfADocumentFailingToWriteIsTakenOverByTheNextHolder)
+{
+  m_db->m_failingDocuments = {"doc-a"};
+
+  OdaiResult<BulkIngestStats> stats = ingest({write_source("doc-a", "sharedAAuniqueAA"),
+                                              write_source("doc-b", "sharedAA"), write_source("doc-c", "sharedAA")});
+  ASSERT_TRUE(stats.has_value());
+  EXPECT_EQ(stats->m_documentsIngested, 2U);
+  EXPECT_EQ(stats->m_documentsFailed, 1U);
+  EXPECT_EQ(stored_chunks("doc-b"), (std::vector<std::string>{"sharedAA"}));
+  EXPECT_EQ(stored_chunks("doc-c"), (std::vector<std::string>{"sharedAA"}));
+  // doc-a's embedding was stored for the model before its write failed, doc-b takes it from there
+  std::vector<std::string> embedded = m_backend.embedded_texts();
+  EXPECT_EQ(std::count(embedded.begin(), embedded.end(), "sharedAA"), 1);
+}
+
+TEST_F(OdaiIngestPipelineTest, ContentOfADocumentFailingToEmbedIsEmbeddedByTheNextHolder)
+{
+  m_backend.fail_texts({"poisonAA"});
+
+  OdaiResult<BulkIngestStats> stats = ingest({write_source("doc-a", "sharedAApoisonAA"),
+                                              write_source("doc-b", "sharedAA"), write_source("doc-c", "sharedAA")});
+  ASSERT_TRUE(stats.has_value());
+  EXPECT_EQ(stats->m_documentsIngested, 2U);
+  EXPECT_EQ(stats->m_documentsFailed, 1U);
+  EXPECT_TRUE(stored_chunks("doc-a").empty());
+  EXPECT_EQ(stored_chunks("doc-b"), (std::vector<std::string>{"sharedAA"}));
+  EXPECT_EQ(stored_chunks("doc-c"), (std::vector<std::string>{"sharedAA"}));
+  std::vector<std::string> embedded = m_backend.embedded_texts();
+  EXPECT_EQ(std::count(embedded.begin(), embedded.end(), "sharedAA"), 1);
+}
+
+TEST_F(OdaiIngestPipelineTest, ThrowingStageAbortsThePipelineWithItsProducersBlocked)
+{
+  std::vector<IngestDocumentSource> sources;
+  for (size_t i = 0; i < 50; ++i)
+  {
+    sources.push_back(write_source("doc-" + std::to_string(i), "content" + std::to_string(i % 10)));
+  }
+  m_backend.throw_on_texts({"content0"});
+  // readers and chunkers fill their single slot queues and block until the abort closes them
+  m_config.m_queueCapacity = 1;
+  m_config.m_readerThreads = 2;
+  m_config.m_chunkerThreads = 2;
+
+  OdaiResult<BulkIngestStats> stats = ingest(sources);
+  ASSERT_FALSE(stats.has_value());
+  EXPECT_EQ(stats.error(), OdaiResultEnum::INTERNAL_ERROR);
+  EXPECT_LT(m_db->added_documents().size(), sources.size());
+}
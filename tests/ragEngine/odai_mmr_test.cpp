@@ -0,0 +1,101 @@
+#include "ragEngine/odai_mmr.h"
+
+#include "odai_test_helpers.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using odai::test::expect_error;
+
+namespace
+{
+RetrievedChunk make_candidate(const std::string& text, float score, std::vector<float> embedding)
+{
+  RetrievedChunk chunk;
+  chunk.m_documentId = "doc";
+  chunk.m_contentText = text;
+  chunk.m_score = score;
+  chunk.m_embedding = std::move(embedding);
+  return chunk;
+}
+
+std::vector<std::string> chunk_texts(const std::vector<RetrievedChunk>& chunks)
+{
+  std::vector<std::string> texts;
+  for (const RetrievedChunk& chunk : chunks)
+  {
+    texts.push_back(chunk.m_contentText);
+  }
+  return texts;
+}
+
+/// Two near duplicate candidates followed by a less relevant but different one
+std::vector<RetrievedChunk> make_duplicate_candidates()
+{
+  return {make_candidate("original", 0.90F, {1.0F, 0.0F, 0.0F}), make_candidate("copy", 0.89F, {0.99F, 0.05F, 0.0F}),
+          make_candidate("other", 0.70F, {0.0F, 1.0F, 0.0F})};
+}
+} // namespace
+
+TEST(OdaiMmrTest, SkipsNearDuplicatesOfEarlierPicks)
+{
+  auto result = select_diverse_chunks(make_duplicate_candidates(), 2, 0.5F);
+
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(chunk_texts(result.value()), (std::vector<std::string>{"original", "other"}));
+  // picks keep their search scores
+  EXPECT_FLOAT_EQ(result.value()[1].m_score, 0.70F);
+}
+
+TEST(OdaiMmrTest, LambdaOneKeepsRelevanceOrder)
+{
+  auto result = select_diverse_chunks(make_duplicate_candidates(), 3, 1.0F);
+
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(chunk_texts(result.value()), (std::vector<std::string>{"original", "copy", "other"}));
+}
+
+TEST(OdaiMmrTest, SimilarityIgnoresEmbeddingLengthAndOddDimensions)
+{
+  // 19 dimensions exercise both the vectorized loop and its scalar tail
+  std::vector<float> base(19, 0.0F);
+  base[18] = 1.0F;
+  std::vector<float> scaled = base;
+  for (float& value : scaled)
+  {
+    value *= 40.0F;
+  }
+  std::vector<float> different(19, 0.0F);
+  different[0] = 1.0F;
+
+  auto result = select_diverse_chunks({make_candidate("base", 0.9F, base), make_candidate("scaled", 0.8F, scaled),
+                                       make_candidate("diff", 0.6F, different)},
+                                      2, 0.5F);
+
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(chunk_texts(result.value()), (std::vector<std::string>{"base", "diff"}));
+}
+
+TEST(OdaiMmrTest, ReturnsAllCandidatesWhenFewerThanTopK)
+{
+  auto result = select_diverse_chunks(make_duplicate_candidates(), 10, 0.5F);
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(result.value().size(), 3U);
+
+  auto empty = select_diverse_chunks({}, 10, 0.5F);
+  ASSERT_TRUE(empty.has_value());
+  EXPECT_TRUE(empty.value().empty());
+}
+
+TEST(OdaiMmrTest, RejectsCandidatesWithoutMatchingEmbeddings)
+{
+  std::vector<RetrievedChunk> missing = make_duplicate_candidates();
+  missing[1].m_embedding.clear();
+  expect_error(select_diverse_chunks(missing, 2, 0.5F), OdaiResultEnum::VALIDATION_FAILED);
+
+  std::vector<RetrievedChunk> mismatched = make_duplicate_candidates();
+  mismatched[2].m_embedding.push_back(1.0F);
+  expect_error(select_diverse_chunks(mismatched, 2, 0.5F), OdaiResultEnum::VALIDATION_FAILED);
+}
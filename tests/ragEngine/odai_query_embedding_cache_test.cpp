@@ -0,0 +1,81 @@
+#include "ragEngine/odai_query_embedding_cache.h"
+#include "types/odai_type_conversions.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+constexpr const char* MODEL_CHECKSUMS = R"({"base_model_path":"1234"})";
+} // namespace
+
+TEST(OdaiQueryEmbeddingCacheTest, RepeatedQueryHitsRegardlessOfSpacing)
+{
+  OdaiQueryEmbeddingCache cache(4);
+  EXPECT_FALSE(cache.find(MODEL_CHECKSUMS, "what is odai?").has_value());
+  cache.insert("embedder", MODEL_CHECKSUMS, "what is odai?", {1.0F, 2.0F});
+
+  EXPECT_EQ(cache.find(MODEL_CHECKSUMS, "what is odai?"), (std::vector<float>{1.0F, 2.0F}));
+  EXPECT_EQ(cache.find(MODEL_CHECKSUMS, "  what  is\n odai?\t"), (std::vector<float>{1.0F, 2.0F}));
+  // case changes the text an embedding model sees
+  EXPECT_FALSE(cache.find(MODEL_CHECKSUMS, "What is odai?").has_value());
+
+  const QueryEmbeddingCacheStats stats = cache.stats();
+  EXPECT_EQ(stats.m_hits, 2U);
+  EXPECT_EQ(stats.m_misses, 2U);
+  EXPECT_EQ(stats.m_entries, 1U);
+  EXPECT_DOUBLE_EQ(stats.hit_rate(), 0.5);
+
+  // the counters odai_get_cache_stats() reports
+  const c_CacheStats c_stats = to_c(CacheStats{stats});
+  EXPECT_EQ(c_stats.m_queryEmbeddingHits, 2U);
+  EXPECT_EQ(c_stats.m_queryEmbeddingMisses, 2U);
+  EXPECT_EQ(c_stats.m_queryEmbeddingEntries, 1U);
+}
+
+TEST(OdaiQueryEmbeddingCacheTest, NormalizeQueryTrimsAndCollapsesWhitespace)
+{
+  EXPECT_EQ(OdaiQueryEmbeddingCache::normalize_query("\t a \n\n b  c \r\n"), "a b c");
+  EXPECT_EQ(OdaiQueryEmbeddingCache::normalize_query("   "), "");
+  EXPECT_EQ(OdaiQueryEmbeddingCache::normalize_query("héllo wörld"), "héllo wörld");
+}
+
+TEST(OdaiQueryEmbeddingCacheTest, EvictsTheLeastRecentlyUsedQuery)
+{
+  OdaiQueryEmbeddingCache cache(2);
+  cache.insert("embedder", MODEL_CHECKSUMS, "first", {1.0F});
+  cache.insert("embedder", MODEL_CHECKSUMS, "second", {2.0F});
+  // using first makes second the least recently used
+  ASSERT_TRUE(cache.find(MODEL_CHECKSUMS, "first").has_value());
+  cache.insert("embedder", MODEL_CHECKSUMS, "third", {3.0F});
+
+  EXPECT_TRUE(cache.find(MODEL_CHECKSUMS, "first").has_value());
+  EXPECT_FALSE(cache.find(MODEL_CHECKSUMS, "second").has_value());
+  EXPECT_TRUE(cache.find(MODEL_CHECKSUMS, "third").has_value());
+  EXPECT_EQ(cache.stats().m_entries, 2U);
+}
+
+TEST(OdaiQueryEmbeddingCacheTest, ChangedModelFilesNeverServeOldEmbeddings)
+{
+  OdaiQueryEmbeddingCache cache(4);
+  cache.insert("embedder", MODEL_CHECKSUMS, "query", {1.0F});
+  cache.insert("other", R"({"base_model_path":"5678"})", "query", {2.0F});
+
+  // new files mean new checksums, which never match the old entries
+  EXPECT_FALSE(cache.find(R"({"base_model_path":"9999"})", "query").has_value());
+
+  cache.invalidate_model("embedder");
+  EXPECT_FALSE(cache.find(MODEL_CHECKSUMS, "query").has_value());
+  EXPECT_EQ(cache.find(R"({"base_model_path":"5678"})", "query"), (std::vector<float>{2.0F}));
+  EXPECT_EQ(cache.stats().m_entries, 1U);
+}
+
+TEST(OdaiQueryEmbeddingCacheTest, ZeroCapacityDisablesCaching)
+{
+  OdaiQueryEmbeddingCache cache(0);
+  cache.insert("embedder", MODEL_CHECKSUMS, "query", {1.0F});
+  EXPECT_FALSE(cache.find(MODEL_CHECKSUMS, "query").has_value());
+  EXPECT_EQ(cache.stats().m_entries, 0U);
+}
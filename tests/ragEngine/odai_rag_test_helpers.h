@@ -0,0 +1,158 @@
+#pragma once
+
+#include "backendEngine/odai_backend_engine.h"
+#include "types/odai_result.h"
+#include "types/odai_types.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace odai::test::rag_engine
+{
+/// Backend that only embeds, turning each text into a deterministic unit vector of its model and text.
+/// Texts can be made to fail or throw, which fails or throws the whole call like a real backend batch.
+class FakeEmbeddingBackend : public IOdaiBackendEngine
+{
+public:
+  explicit FakeEmbeddingBackend(uint32_t dimensions = 2)
+      : IOdaiBackendEngine({LLAMA_BACKEND_ENGINE, BackendDeviceType::CPU}), m_dimensions(dimensions)
+  {
+  }
+
+  /// The embedding this backend produces for a text with a model
+  static std::vector<float> embedding_of(const ModelName& model_name, const std::string& text, uint32_t dimensions)
+  {
+    std::vector<float> embedding(dimensions);
+    float norm = 0.0F;
+    for (uint32_t d = 0; d < dimensions; ++d)
+    {
+      const size_t seed = std::hash<std::string>{}(model_name + '\n' + text + '\n' + std::to_string(d));
+      embedding[d] = static_cast<float>(seed % 2001) / 1000.0F - 0.999F;
+      norm += embedding[d] * embedding[d];
+    }
+    for (float& value : embedding)
+    {
+      value /= std::sqrt(norm);
+    }
+    return embedding;
+  }
+
+  /// Calls embedding any of these texts fail with INTERNAL_ERROR
+  void fail_texts(std::unordered_set<std::string> texts)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_failingTexts = std::move(texts);
+  }
+
+  /// Calls embedding any of these texts throw
+  void throw_on_texts(std::unordered_set<std::string> texts)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_throwingTexts = std::move(texts);
+  }
+
+  /// @return every text embedded successfully so far, in call order
+  std::vector<std::string> embedded_texts() const
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_embeddedTexts;
+  }
+
+  /// @return number of generate_embeddings calls, failed ones included
+  size_t embed_calls() const
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_embedCalls;
+  }
+
+  OdaiResult<void> initialize_engine() override { return {}; }
+
+  OdaiResult<std::vector<BackendDevice>> get_candidate_devices() override { return std::vector<BackendDevice>{}; }
+
+  OdaiResult<bool> validate_model_files(const ModelFiles&) override { return true; }
+
+  OdaiResult<StreamingStats> generate_streaming_response(const std::vector<InputItem>&, const LLMModelConfig&,
+                                                         const ModelFiles&, const SamplerConfig&,
+                                                         OdaiStreamRespCallbackFn, void*) override
+  {
+    return tl::unexpected(OdaiResultEnum::INTERNAL_ERROR);
+  }
+
+  OdaiResult<StreamingStats> generate_streaming_chat_response(const std::vector<InputItem>&,
+                                                              const std::vector<ChatMessage>&, const LLMModelConfig&,
+                                                              const ModelFiles&, const SamplerConfig&,
+                                                              OdaiStreamRespCallbackFn, void*) override
+  {
+    return tl::unexpected(OdaiResultEnum::INTERNAL_ERROR);
+  }
+
+  OdaiResult<std::vector<std::vector<float>>> generate_embeddings(const std::vector<std::string>& texts,
+                                                                  const EmbeddingModelConfig& embedding_model_config,
+                                                                  const ModelFiles&) override
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_embedCalls++;
+    std::vector<std::vector<float>> embeddings;
+    for (const std::string& text : texts)
+    {
+      if (m_throwingTexts.contains(text))
+      {
+        throw std::runtime_error("embedding failed");
+      }
+      if (m_failingTexts.contains(text))
+      {
+        return tl::unexpected(OdaiResultEnum::INTERNAL_ERROR);
+      }
+      embeddings.push_back(embedding_of(embedding_model_config.m_modelName, text, m_dimensions));
+    }
+    m_embeddedTexts.insert(m_embeddedTexts.end(), texts.begin(), texts.end());
+    return embeddings;
+  }
+
+  OdaiResult<std::vector<std::vector<TokenId>>> tokenize_embedding_texts(const std::vector<std::string>&,
+                                                                         const EmbeddingModelConfig&,
+                                                                         const ModelFiles&) override
+  {
+    return tl::unexpected(OdaiResultEnum::INTERNAL_ERROR);
+  }
+
+  OdaiResult<std::vector<std::vector<float>>> generate_embeddings_from_tokens(const std::vector<std::vector<TokenId>>&,
+                                                                              const EmbeddingModelConfig&,
+                                                                              const ModelFiles&) override
+  {
+    return tl::unexpected(OdaiResultEnum::INTERNAL_ERROR);
+  }
+
+  OdaiResult<uint32_t> get_embedding_dimensions(const EmbeddingModelConfig&, const ModelFiles&) override
+  {
+    return m_dimensions;
+  }
+
+  OdaiResult<std::vector<uint32_t>> count_llm_tokens(const std::vector<std::string>&, const LLMModelConfig&,
+                                                     const ModelFiles&) override
+  {
+    return tl::unexpected(OdaiResultEnum::INTERNAL_ERROR);
+  }
+
+  OdaiResult<std::vector<float>> rerank(const std::string&, const std::vector<std::string>&,
+                                        const RerankerModelConfig&, const ModelFiles&) override
+  {
+    return tl::unexpected(OdaiResultEnum::INTERNAL_ERROR);
+  }
+
+private:
+  const uint32_t m_dimensions;
+  mutable std::mutex m_mutex;
+  std::unordered_set<std::string> m_failingTexts;
+  std::unordered_set<std::string> m_throwingTexts;
+  std::vector<std::string> m_embeddedTexts;
+  size_t m_embedCalls = 0;
+};
+} // namespace odai::test::rag_engine
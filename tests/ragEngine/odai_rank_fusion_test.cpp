@@ -0,0 +1,134 @@
+#include "ragEngine/odai_rank_fusion.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+RetrievedChunk make_chunk(const std::string& document_id, uint32_t sequence_index, float score = 0.0F)
+{
+  RetrievedChunk chunk;
+  chunk.m_documentId = document_id;
+  chunk.m_sequenceIndex = sequence_index;
+  chunk.m_contentText = document_id + "#" + std::to_string(sequence_index);
+  chunk.m_score = score;
+  return chunk;
+}
+
+std::vector<std::string> chunk_texts(const std::vector<RetrievedChunk>& chunks)
+{
+  std::vector<std::string> texts;
+  texts.reserve(chunks.size());
+  for (const RetrievedChunk& chunk : chunks)
+  {
+    texts.push_back(chunk.m_contentText);
+  }
+  return texts;
+}
+} // namespace
+
+TEST(OdaiRankFusionTest, ChunksRankedHighByBothSearchesComeFirst)
+{
+  const std::vector<RetrievedChunk> vector_ranking = {make_chunk("a", 0, 0.9F), make_chunk("b", 0, 0.8F),
+                                                      make_chunk("c", 0, 0.7F)};
+  const std::vector<RetrievedChunk> keyword_ranking = {make_chunk("c", 0, 0.99F), make_chunk("b", 0, 0.5F),
+                                                       make_chunk("d", 0, 0.1F)};
+
+  const std::vector<RetrievedChunk> fused = fuse_reciprocal_rank({vector_ranking, keyword_ranking});
+
+  // b and c are found by both searches and beat a's single first place, c's ranks (3, 1) edge out b's (2, 2)
+  EXPECT_EQ(chunk_texts(fused), (std::vector<std::string>{"c#0", "b#0", "a#0", "d#0"}));
+}
+
+TEST(OdaiRankFusionTest, ScoresDependOnlyOnRanksAndTopEverywhereScoresOne)
+{
+  const std::vector<RetrievedChunk> first = {make_chunk("a", 1, 0.2F), make_chunk("b", 2, 0.1F)};
+  const std::vector<RetrievedChunk> second = {make_chunk("a", 1, 40.0F)};
+
+  const std::vector<RetrievedChunk> fused = fuse_reciprocal_rank({first, second}, 60);
+
+  ASSERT_EQ(fused.size(), 2U);
+  EXPECT_FLOAT_EQ(fused[0].m_score, 1.0F);
+  EXPECT_FLOAT_EQ(fused[1].m_score, (1.0F / 62.0F) / (2.0F / 61.0F));
+}
+
+TEST(OdaiRankFusionTest, SameDocumentDifferentPositionsAreDifferentChunks)
+{
+  const std::vector<RetrievedChunk> first = {make_chunk("a", 0), make_chunk("a", 1)};
+  const std::vector<RetrievedChunk> second = {make_chunk("a", 1)};
+
+  const std::vector<RetrievedChunk> fused = fuse_reciprocal_rank({first, second});
+
+  EXPECT_EQ(chunk_texts(fused), (std::vector<std::string>{"a#1", "a#0"}));
+}
+
+TEST(OdaiRankFusionTest, TiesKeepFirstAppearanceOrderAndEmptyInputsFuseToNothing)
+{
+  const std::vector<RetrievedChunk> first = {make_chunk("a", 0), make_chunk("b", 0)};
+  const std::vector<RetrievedChunk> second = {make_chunk("b", 0), make_chunk("a", 0)};
+
+  EXPECT_EQ(chunk_texts(fuse_reciprocal_rank({first, second})), (std::vector<std::string>{"a#0", "b#0"}));
+  EXPECT_TRUE(fuse_reciprocal_rank({}).empty());
+  EXPECT_TRUE(fuse_reciprocal_rank({{}, {}}).empty());
+}
+
+TEST(OdaiRankFusionTest, NormalizedScoresPutEachRankingOnTheSameScale)
+{
+  // cosine similarities of one model and scores of a model with a much narrower range
+  const std::vector<RetrievedChunk> wide = {make_chunk("a", 0, 0.9F), make_chunk("b", 0, 0.5F),
+                                            make_chunk("c", 0, 0.1F)};
+  const std::vector<RetrievedChunk> narrow = {make_chunk("d", 0, 0.32F), make_chunk("e", 0, 0.31F),
+                                              make_chunk("f", 0, 0.30F)};
+
+  const std::vector<RetrievedChunk> merged = merge_normalized_scores({wide, narrow});
+
+  ASSERT_EQ(merged.size(), 6U);
+  EXPECT_EQ(chunk_texts(merged), (std::vector<std::string>{"a#0", "d#0", "b#0", "e#0", "c#0", "f#0"}));
+  EXPECT_FLOAT_EQ(merged[0].m_score, 1.0F);
+  EXPECT_FLOAT_EQ(merged[1].m_score, 1.0F);
+  EXPECT_NEAR(merged[2].m_score, 0.5F, 1e-5F);
+  EXPECT_NEAR(merged[3].m_score, 0.5F, 1e-5F);
+  EXPECT_FLOAT_EQ(merged[5].m_score, 0.0F);
+}
+
+TEST(OdaiRankFusionTest, NormalizedScoresKeepTheBestScoreOfAChunkAndFlatRankingsScoreOne)
+{
+  const std::vector<RetrievedChunk> first = {make_chunk("a", 0, 0.8F), make_chunk("b", 0, 0.4F)};
+  const std::vector<RetrievedChunk> flat = {make_chunk("b", 0, 0.2F), make_chunk("c", 0, 0.2F)};
+
+  const std::vector<RetrievedChunk> merged = merge_normalized_scores({first, flat});
+
+  EXPECT_EQ(chunk_texts(merged), (std::vector<std::string>{"a#0", "b#0", "c#0"}));
+  for (const RetrievedChunk& chunk : merged)
+  {
+    EXPECT_FLOAT_EQ(chunk.m_score, 1.0F);
+  }
+  EXPECT_TRUE(merge_normalized_scores({}).empty());
+  EXPECT_TRUE(merge_normalized_scores({{}, {}}).empty());
+}
+
+TEST(OdaiRankFusionTest, RankingsOfDifferentOriginsNeverMergeTheirChunks)
+{
+  // two spaces holding documents with the same ids, e.g. a knowledge pack exported from the other space
+  const std::vector<RetrievedChunk> first = {make_chunk("a", 0, 0.9F), make_chunk("b", 0, 0.1F)};
+  const std::vector<RetrievedChunk> second = {make_chunk("a", 0, 0.5F)};
+
+  const std::vector<MergedChunk> fused = fuse_reciprocal_rank({first, second}, {0, 1});
+  ASSERT_EQ(fused.size(), 3U);
+  EXPECT_EQ(fused[0].m_origin, 0U);
+  EXPECT_EQ(fused[1].m_origin, 1U);
+  EXPECT_EQ(fused[1].m_chunk.m_documentId, "a");
+  EXPECT_FLOAT_EQ(fused[0].m_chunk.m_score, fused[1].m_chunk.m_score);
+  EXPECT_EQ(fused[2].m_origin, 0U);
+
+  const std::vector<MergedChunk> merged = merge_normalized_scores({first, second}, {0, 1});
+  ASSERT_EQ(merged.size(), 3U);
+  EXPECT_EQ(merged[0].m_origin, 0U);
+  EXPECT_EQ(merged[1].m_origin, 1U);
+  EXPECT_EQ(merged[2].m_chunk.m_documentId, "b");
+
+  // rankings of one origin still merge
+  EXPECT_EQ(fuse_reciprocal_rank({first, second}, {1, 1}).size(), 2U);
+}
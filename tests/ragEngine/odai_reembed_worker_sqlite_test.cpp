@@ -0,0 +1,178 @@
+#include "ragEngine/odai_reembed_worker.h"
+
+#include "db/odai_db_test_helpers.h"
+#include "db/odai_sqlite/odai_sqlite_db.h"
+#include "odai_rag_test_helpers.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+using odai::test::db_contract::make_document_chunk;
+using odai::test::db_contract::make_model_files;
+using odai::test::db_contract::make_semantic_space;
+using odai::test::db_contract::TempDbDirectory;
+using odai::test::expect_error;
+using odai::test::rag_engine::FakeEmbeddingBackend;
+
+namespace
+{
+constexpr const char* NEW_MODEL = "embedding-model-v2";
+constexpr uint32_t NEW_DIMENSIONS = 3;
+/// Longer than the worker's retry delay after a failed batch
+constexpr std::chrono::seconds SWITCH_TIMEOUT{20};
+
+class OdaiReembedWorkerSqliteTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_db = make_db();
+    ASSERT_TRUE(m_db->create_semantic_space(make_semantic_space("space")).has_value());
+    const ModelFiles new_model_files = make_model_files(ModelType::EMBEDDING, {{"base_model_path", "/tmp/v2.gguf"}});
+    ASSERT_TRUE(m_db->register_model_files(NEW_MODEL, new_model_files, R"({"base_model_path":"v2"})").has_value());
+    ASSERT_TRUE(m_db->add_document("doc", "", "space", "scope",
+                                   {make_document_chunk("one", 1, 0, {1.0F, 0.0F}),
+                                    make_document_chunk("two", 2, 1, {0.0F, 1.0F}),
+                                    make_document_chunk("three", 3, 2, {0.6F, 0.8F})}, {})
+                    .has_value());
+
+    m_target = make_semantic_space("space");
+    m_target.m_embeddingModelConfig = {NEW_MODEL};
+    m_target.m_dimensions = NEW_DIMENSIONS;
+    ASSERT_TRUE(m_db->start_reembedding(m_target, ReembedConfig{1, 1.0F}).has_value());
+  }
+
+  std::unique_ptr<OdaiSqliteDb> make_db()
+  {
+    auto db = std::make_unique<OdaiSqliteDb>(m_directory.db_config());
+    EXPECT_TRUE(db->initialize_db().has_value());
+    return db;
+  }
+
+  /// Starts a worker on its own connection, recording the spaces it switches and the texts its backend embedded by
+  /// then. The worker releases the backend when it exits, it is only read while the worker switches a space.
+  std::unique_ptr<OdaiReembedWorker> start_worker(std::unique_ptr<FakeEmbeddingBackend> backend)
+  {
+    const FakeEmbeddingBackend* backend_view = backend.get();
+    return std::make_unique<OdaiReembedWorker>(make_db(), std::move(backend), m_switchMutex,
+                                               [this, backend_view](const SemanticSpaceName& name)
+                                               {
+                                                 std::lock_guard<std::mutex> lock(m_mutex);
+                                                 m_switched.push_back(name);
+                                                 m_embeddedBeforeSwitch = backend_view->embedded_texts();
+                                                 m_switchedCondition.notify_all();
+                                               });
+  }
+
+  bool wait_for_switch()
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return m_switchedCondition.wait_for(lock, SWITCH_TIMEOUT, [this] { return !m_switched.empty(); });
+  }
+
+  std::vector<SemanticSpaceName> switched()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_switched;
+  }
+
+  std::vector<std::string> embedded_before_switch()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_embeddedBeforeSwitch;
+  }
+
+  /// @return text of the chunk nearest to the query, empty if the search failed or found nothing
+  std::string nearest_text(const std::vector<float>& query)
+  {
+    OdaiResult<std::vector<RetrievedChunk>> results = m_db->search_chunks("space", "scope", query, 1, false, {});
+    return results.has_value() && !results->empty() ? results->front().m_contentText : "";
+  }
+
+  TempDbDirectory m_directory{"odai_reembed_worker_sqlite_test"};
+  std::unique_ptr<OdaiSqliteDb> m_db;
+  SemanticSpaceConfig m_target;
+  std::shared_mutex m_switchMutex;
+
+private:
+  std::mutex m_mutex;
+  std::condition_variable m_switchedCondition;
+  std::vector<SemanticSpaceName> m_switched;
+  std::vector<std::string> m_embeddedBeforeSwitch;
+};
+} // namespace
+
+TEST_F(OdaiReembedWorkerSqliteTest, InterruptedJobResumesAfterItsStoredProgress)
+{
+  // a previous run stored the first batch, with a vector the fake backend never produces, then was interrupted
+  OdaiResult<std::vector<ReembedChunk>> batch = m_db->get_reembedding_batch("space", 1);
+  ASSERT_TRUE(batch.has_value());
+  ASSERT_EQ(batch->size(), 1U);
+  ASSERT_EQ(batch->front().m_contentText, "one");
+  batch->front().m_embedding = {0.0F, 0.0F, 1.0F};
+  ASSERT_TRUE(m_db->store_reembedded_vectors("space", batch.value()).has_value());
+  m_db->close();
+  m_db = make_db();
+
+  std::unique_ptr<OdaiReembedWorker> worker = start_worker(std::make_unique<FakeEmbeddingBackend>(NEW_DIMENSIONS));
+  ASSERT_TRUE(wait_for_switch());
+  worker.reset();
+
+  // only the vectors after the stored cursor were embedded, the stored one was kept
+  EXPECT_EQ(embedded_before_switch(), (std::vector<std::string>{"two", "three"}));
+  EXPECT_EQ(switched(), (std::vector<SemanticSpaceName>{"space"}));
+  EXPECT_EQ(nearest_text({0.0F, 0.0F, 1.0F}), "one");
+  EXPECT_EQ(nearest_text(FakeEmbeddingBackend::embedding_of(NEW_MODEL, "three", NEW_DIMENSIONS)), "three");
+}
+
+TEST_F(OdaiReembedWorkerSqliteTest, SpaceSwitchesOnlyOnceEveryVectorIsReembedded)
+{
+  // the last vector fails until released, the job stops one vector short of complete
+  auto backend = std::make_unique<FakeEmbeddingBackend>(NEW_DIMENSIONS);
+  backend->fail_texts({"three"});
+  FakeEmbeddingBackend* backend_view = backend.get();
+  std::unique_ptr<OdaiReembedWorker> worker = start_worker(std::move(backend));
+
+  OdaiResult<ReembedJob> job = m_db->get_reembedding_job("space");
+  const auto deadline = std::chrono::steady_clock::now() + SWITCH_TIMEOUT;
+  while (job.has_value() && job->m_vectorsDone < 2 && std::chrono::steady_clock::now() < deadline)
+  {
+    std::this_thread::sleep_for(10ms);
+    job = m_db->get_reembedding_job("space");
+  }
+  ASSERT_TRUE(job.has_value());
+  ASSERT_EQ(job->m_vectorsDone, 2U);
+  EXPECT_EQ(job->m_vectorsTotal, 3U);
+
+  // the space keeps serving its old model and vectors
+  EXPECT_TRUE(switched().empty());
+  OdaiResult<SemanticSpaceConfig> config = m_db->get_semantic_space_config("space");
+  ASSERT_TRUE(config.has_value());
+  EXPECT_EQ(config->m_embeddingModelConfig.m_modelName, "embedding-model");
+  EXPECT_EQ(nearest_text({1.0F, 0.0F}), "one");
+
+  // the worker retries the failed batch after a pause, it is still running and holds the backend
+  backend_view->fail_texts({});
+  ASSERT_TRUE(wait_for_switch());
+  worker.reset();
+  EXPECT_EQ(embedded_before_switch(), (std::vector<std::string>{"one", "two", "three"}));
+
+  config = m_db->get_semantic_space_config("space");
+  ASSERT_TRUE(config.has_value());
+  EXPECT_EQ(config->m_embeddingModelConfig.m_modelName, NEW_MODEL);
+  EXPECT_EQ(config->m_dimensions, NEW_DIMENSIONS);
+  expect_error(m_db->get_reembedding_job("space"), OdaiResultEnum::NOT_FOUND);
+  for (const std::string& text : std::vector<std::string>{"one", "two", "three"})
+  {
+    EXPECT_EQ(nearest_text(FakeEmbeddingBackend::embedding_of(NEW_MODEL, text, NEW_DIMENSIONS)), text);
+  }
+}
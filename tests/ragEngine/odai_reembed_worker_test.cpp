@@ -0,0 +1,25 @@
+#include "ragEngine/odai_reembed_worker.h"
+
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+TEST(OdaiReembedWorkerTest, PauseKeepsBatchesUnderTheirCpuShare)
+{
+  EXPECT_EQ(reembed_pause(100ms, 0.25F), 300ms);
+  EXPECT_EQ(reembed_pause(100ms, 0.5F), 100ms);
+
+  const std::chrono::nanoseconds busy = 40ms;
+  const std::chrono::nanoseconds pause = reembed_pause(busy, 0.1F);
+  const double share = static_cast<double>(busy.count()) / static_cast<double>((busy + pause).count());
+  EXPECT_NEAR(share, 0.1, 1e-6);
+}
+
+TEST(OdaiReembedWorkerTest, NoPauseForAFullShareOrAnEmptyBatch)
+{
+  EXPECT_EQ(reembed_pause(100ms, 1.0F), 0ns);
+  EXPECT_EQ(reembed_pause(0ns, 0.25F), 0ns);
+  EXPECT_EQ(reembed_pause(100ms, 0.0F), 0ns);
+}
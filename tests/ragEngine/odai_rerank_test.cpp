@@ -0,0 +1,175 @@
+#include "ragEngine/odai_rerank.h"
+
+#include "odai_test_helpers.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using odai::test::expect_error;
+
+namespace
+{
+/// Candidates "c0".."c<count-1>" with first stage scores falling from start by step
+std::vector<RetrievedChunk> make_candidates(size_t count, float start, float step)
+{
+  std::vector<RetrievedChunk> candidates;
+  for (size_t i = 0; i < count; ++i)
+  {
+    RetrievedChunk chunk;
+    chunk.m_documentId = "doc";
+    chunk.m_sequenceIndex = static_cast<uint32_t>(i);
+    chunk.m_contentText = "c" + std::to_string(i);
+    chunk.m_score = start - step * static_cast<float>(i);
+    candidates.push_back(chunk);
+  }
+  return candidates;
+}
+
+RetrievalConfig make_config(uint32_t top_k, float margin, uint32_t time_budget_ms)
+{
+  RetrievalConfig config;
+  config.m_topK = top_k;
+  config.m_fetchK = top_k;
+  config.m_useReranker = true;
+  config.m_rerankEarlyStopMargin = margin;
+  config.m_rerankTimeBudgetMs = time_budget_ms;
+  return config;
+}
+
+/// Fake reranker scoring texts from a table, 0.5 for unknown ones, recording every call's batch size
+struct FakeReranker
+{
+  OdaiResult<std::vector<float>> operator()(const std::vector<std::string>& texts)
+  {
+    m_batchSizes.push_back(texts.size());
+    std::vector<float> scores;
+    for (const std::string& text : texts)
+    {
+      auto it = m_scores.find(text);
+      scores.push_back(it != m_scores.end() ? it->second : 0.5F);
+    }
+    return scores;
+  }
+
+  std::unordered_map<std::string, float> m_scores;
+  std::vector<size_t> m_batchSizes;
+};
+
+std::vector<std::string> chunk_texts(const std::vector<RetrievedChunk>& chunks)
+{
+  std::vector<std::string> texts;
+  for (const RetrievedChunk& chunk : chunks)
+  {
+    texts.push_back(chunk.m_contentText);
+  }
+  return texts;
+}
+} // namespace
+
+TEST(OdaiRerankTest, OrdersByRerankerScoreAndKeepsTopK)
+{
+  FakeReranker reranker;
+  reranker.m_scores = {{"c0", 0.2F}, {"c1", 0.9F}, {"c2", 0.1F}, {"c3", 0.7F}};
+  RerankStats stats;
+
+  std::vector<size_t> positions;
+
+  auto result =
+      rerank_chunks(make_candidates(4, 0.9F, 0.1F), make_config(2, 1.0F, 0), std::ref(reranker), stats, &positions);
+
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(chunk_texts(result.value()), (std::vector<std::string>{"c1", "c3"}));
+  EXPECT_EQ(positions, (std::vector<size_t>{1, 3}));
+  EXPECT_FLOAT_EQ(result.value()[0].m_score, 0.9F);
+  EXPECT_FLOAT_EQ(result.value()[1].m_score, 0.7F);
+  EXPECT_EQ(stats.m_scoredCandidates, 4U);
+  EXPECT_FALSE(stats.m_stoppedEarly);
+  EXPECT_FALSE(stats.m_budgetExhausted);
+}
+
+TEST(OdaiRerankTest, ScoresCandidatesInRounds)
+{
+  FakeReranker reranker;
+  RerankStats stats;
+
+  auto result = rerank_chunks(make_candidates(2 * RERANK_CANDIDATES_PER_ROUND + 3, 0.9F, 0.01F),
+                              make_config(5, 1.0F, 0), std::ref(reranker), stats);
+
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(reranker.m_batchSizes,
+            (std::vector<size_t>{RERANK_CANDIDATES_PER_ROUND, RERANK_CANDIDATES_PER_ROUND, 3}));
+  // equal reranker scores keep first stage order
+  EXPECT_EQ(chunk_texts(result.value()), (std::vector<std::string>{"c0", "c1", "c2", "c3", "c4"}));
+}
+
+TEST(OdaiRerankTest, StopsOnceRemainingCandidatesCannotEnterTopK)
+{
+  // the first round scores 0.5 everywhere, later candidates have first stage scores of at most 0.2
+  std::vector<RetrievedChunk> candidates = make_candidates(3 * RERANK_CANDIDATES_PER_ROUND, 0.9F, 0.0F);
+  for (size_t i = RERANK_CANDIDATES_PER_ROUND; i < candidates.size(); ++i)
+  {
+    candidates[i].m_score = 0.2F;
+  }
+  FakeReranker reranker;
+  RerankStats stats;
+
+  auto result = rerank_chunks(candidates, make_config(4, 0.25F, 0), std::ref(reranker), stats);
+
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(reranker.m_batchSizes.size(), 1U);
+  EXPECT_EQ(stats.m_scoredCandidates, RERANK_CANDIDATES_PER_ROUND);
+  EXPECT_TRUE(stats.m_stoppedEarly);
+  EXPECT_EQ(result.value().size(), 4U);
+
+  // a wider margin lets the same candidates still beat the top K
+  FakeReranker wide_reranker;
+  ASSERT_TRUE(rerank_chunks(candidates, make_config(4, 0.4F, 0), std::ref(wide_reranker), stats).has_value());
+  EXPECT_EQ(wide_reranker.m_batchSizes.size(), 3U);
+  EXPECT_FALSE(stats.m_stoppedEarly);
+}
+
+TEST(OdaiRerankTest, TimeBudgetStopsScoringAndFillsWithFirstStageOrder)
+{
+  FakeReranker reranker;
+  RerankScoreFn slow_reranker = [&reranker](const std::vector<std::string>& texts)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    return reranker(texts);
+  };
+  RerankStats stats;
+  std::vector<size_t> positions;
+
+  auto result = rerank_chunks(make_candidates(3 * RERANK_CANDIDATES_PER_ROUND, 0.9F, 0.01F),
+                              make_config(RERANK_CANDIDATES_PER_ROUND + 2, 1.0F, 1), slow_reranker, stats, &positions);
+
+  ASSERT_TRUE(result.has_value());
+  EXPECT_TRUE(stats.m_budgetExhausted);
+  EXPECT_EQ(stats.m_scoredCandidates, RERANK_CANDIDATES_PER_ROUND);
+  ASSERT_EQ(result.value().size(), RERANK_CANDIDATES_PER_ROUND + 2);
+  // the unscored candidates follow the scored ones with their first stage scores
+  const RetrievedChunk& filler = result.value()[RERANK_CANDIDATES_PER_ROUND];
+  EXPECT_EQ(filler.m_contentText, "c" + std::to_string(RERANK_CANDIDATES_PER_ROUND));
+  EXPECT_FLOAT_EQ(filler.m_score, 0.9F - 0.01F * static_cast<float>(RERANK_CANDIDATES_PER_ROUND));
+  ASSERT_EQ(positions.size(), result.value().size());
+  EXPECT_EQ(positions[RERANK_CANDIDATES_PER_ROUND], RERANK_CANDIDATES_PER_ROUND);
+  EXPECT_GT(stats.m_seconds, 0.0);
+}
+
+TEST(OdaiRerankTest, ScoringFailuresAreReturned)
+{
+  RerankStats stats;
+  RerankScoreFn failing = [](const std::vector<std::string>&) -> OdaiResult<std::vector<float>>
+  { return tl::unexpected(OdaiResultEnum::NOT_FOUND); };
+  expect_error(rerank_chunks(make_candidates(3, 0.9F, 0.1F), make_config(2, 1.0F, 0), failing, stats),
+               OdaiResultEnum::NOT_FOUND);
+
+  RerankScoreFn short_scores = [](const std::vector<std::string>&) -> OdaiResult<std::vector<float>>
+  { return std::vector<float>{0.5F}; };
+  expect_error(rerank_chunks(make_candidates(3, 0.9F, 0.1F), make_config(2, 1.0F, 0), short_scores, stats),
+               OdaiResultEnum::INTERNAL_ERROR);
+}
@@ -0,0 +1,185 @@
+#include "ragEngine/odai_retrieval_cache.h"
+#include "types/odai_type_conversions.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+RetrievalConfig make_retrieval_config()
+{
+  RetrievalConfig config{};
+  config.m_topK = 3;
+  config.m_fetchK = 10;
+  config.m_searchType = SEARCH_TYPE_VECTOR_ONLY;
+  return config;
+}
+
+std::vector<RetrievedChunk> make_chunks(const std::string& text)
+{
+  RetrievedChunk chunk{};
+  chunk.m_documentId = "doc";
+  chunk.m_contentText = text;
+  chunk.m_score = 0.75F;
+  chunk.m_embedding = {1.0F, 0.0F};
+  return {chunk};
+}
+
+std::vector<std::string> texts(const std::vector<RetrievedChunk>& chunks)
+{
+  std::vector<std::string> result;
+  for (const RetrievedChunk& chunk : chunks)
+  {
+    result.push_back(chunk.m_contentText);
+  }
+  return result;
+}
+} // namespace
+
+TEST(OdaiRetrievalCacheTest, RepeatedQueryHitsWithTheSameSettings)
+{
+  OdaiRetrievalCache cache(BYTES_PER_MB);
+  const RetrievalConfig config = make_retrieval_config();
+  EXPECT_FALSE(cache.find("space", "scope", "what is odai?", config).has_value());
+  cache.insert("space", "scope", "what is odai?", config, cache.generation("space", "scope"), make_chunks("answer"));
+
+  std::optional<std::vector<RetrievedChunk>> cached = cache.find("space", "scope", " what is  odai? ", config);
+  ASSERT_TRUE(cached.has_value());
+  EXPECT_EQ(texts(cached.value()), (std::vector<std::string>{"answer"}));
+  EXPECT_FLOAT_EQ(cached->front().m_score, 0.75F);
+  // embeddings are only needed while retrieving, they aren't kept
+  EXPECT_TRUE(cached->front().m_embedding.empty());
+
+  const RetrievalCacheStats stats = cache.stats();
+  EXPECT_EQ(stats.m_hits, 1U);
+  EXPECT_EQ(stats.m_misses, 1U);
+  EXPECT_EQ(stats.m_entries, 1U);
+  EXPECT_GT(stats.m_bytes, 0U);
+  EXPECT_DOUBLE_EQ(stats.hit_rate(), 0.5);
+
+  // the counters odai_get_cache_stats() reports
+  CacheStats cache_stats;
+  cache_stats.m_retrieval = stats;
+  const c_CacheStats c_stats = to_c(cache_stats);
+  EXPECT_EQ(c_stats.m_retrievalHits, 1U);
+  EXPECT_EQ(c_stats.m_retrievalMisses, 1U);
+  EXPECT_EQ(c_stats.m_retrievalStaleEntries, 0U);
+  EXPECT_EQ(c_stats.m_retrievalEntries, 1U);
+  EXPECT_EQ(c_stats.m_retrievalBytes, stats.m_bytes);
+}
+
+TEST(OdaiRetrievalCacheTest, EverySettingAndLocationIsPartOfTheKey)
+{
+  OdaiRetrievalCache cache(BYTES_PER_MB);
+  const RetrievalConfig config = make_retrieval_config();
+  cache.insert("space", "scope", "query", config, cache.generation("space", "scope"), make_chunks("answer"));
+
+  RetrievalConfig other_top_k = config;
+  other_top_k.m_topK = 4;
+  RetrievalConfig other_threshold = config;
+  other_threshold.m_scoreThreshold = 0.5F;
+  RetrievalConfig other_search = config;
+  other_search.m_searchType = SEARCH_TYPE_HYBRID;
+  RetrievalConfig reranked = config;
+  reranked.m_useReranker = true;
+  reranked.m_rerankerModelConfig.m_modelName = "reranker";
+  RetrievalConfig two_stage = config;
+  two_stage.m_documentLimit = 10;
+  RetrievalConfig filtered = config;
+  filtered.m_metadataFilter = {{"lang", {"en"}}};
+  RetrievalConfig other_filter = config;
+  other_filter.m_metadataFilter = {{"lang", {"en", "fr"}}};
+
+  EXPECT_FALSE(cache.find("space", "scope", "query", other_top_k).has_value());
+  EXPECT_FALSE(cache.find("space", "scope", "query", other_threshold).has_value());
+  EXPECT_FALSE(cache.find("space", "scope", "query", other_search).has_value());
+  EXPECT_FALSE(cache.find("space", "scope", "query", reranked).has_value());
+  EXPECT_FALSE(cache.find("space", "scope", "query", two_stage).has_value());
+  EXPECT_FALSE(cache.find("space", "scope", "query", filtered).has_value());
+  EXPECT_FALSE(cache.find("space", "scope", "query", other_filter).has_value());
+  EXPECT_FALSE(cache.find("space", "other", "query", config).has_value());
+  EXPECT_FALSE(cache.find("other", "scope", "query", config).has_value());
+  EXPECT_FALSE(cache.find("space", "scope", "Query", config).has_value());
+  EXPECT_TRUE(cache.find("space", "scope", "query", config).has_value());
+
+  // MMR lambda only matters to MMR searches
+  RetrievalConfig other_lambda = config;
+  other_lambda.m_mmrLambda = 0.9F;
+  EXPECT_TRUE(cache.find("space", "scope", "query", other_lambda).has_value());
+}
+
+TEST(OdaiRetrievalCacheTest, WritesInvalidateOnlyTheirScopeOrSpace)
+{
+  OdaiRetrievalCache cache(BYTES_PER_MB);
+  const RetrievalConfig config = make_retrieval_config();
+  for (const char* space : {"space", "other_space"})
+  {
+    for (const char* scope : {"scope", "other_scope"})
+    {
+      cache.insert(space, scope, "query", config, cache.generation(space, scope), make_chunks("answer"));
+    }
+  }
+
+  cache.invalidate_scope("space", "scope");
+  EXPECT_FALSE(cache.find("space", "scope", "query", config).has_value());
+  EXPECT_TRUE(cache.find("space", "other_scope", "query", config).has_value());
+  EXPECT_TRUE(cache.find("other_space", "scope", "query", config).has_value());
+  EXPECT_EQ(cache.stats().m_staleEntries, 1U);
+
+  cache.invalidate_space("other_space");
+  EXPECT_EQ(cache.stats().m_entries, 1U);
+  EXPECT_FALSE(cache.find("other_space", "scope", "query", config).has_value());
+  EXPECT_FALSE(cache.find("other_space", "other_scope", "query", config).has_value());
+  EXPECT_TRUE(cache.find("space", "other_scope", "query", config).has_value());
+
+  // a result retrieved after the write is current again
+  cache.insert("space", "scope", "query", config, cache.generation("space", "scope"), make_chunks("new answer"));
+  std::optional<std::vector<RetrievedChunk>> cached = cache.find("space", "scope", "query", config);
+  ASSERT_TRUE(cached.has_value());
+  EXPECT_EQ(texts(cached.value()), (std::vector<std::string>{"new answer"}));
+
+  cache.clear();
+  EXPECT_EQ(cache.stats().m_entries, 0U);
+  EXPECT_EQ(cache.stats().m_bytes, 0U);
+}
+
+TEST(OdaiRetrievalCacheTest, ResultRetrievedDuringAWriteIsNotCached)
+{
+  OdaiRetrievalCache cache(BYTES_PER_MB);
+  const RetrievalConfig config = make_retrieval_config();
+
+  const uint64_t generation = cache.generation("space", "scope");
+  cache.invalidate_scope("space", "scope");
+  cache.insert("space", "scope", "query", config, generation, make_chunks("outdated"));
+
+  EXPECT_FALSE(cache.find("space", "scope", "query", config).has_value());
+  EXPECT_EQ(cache.stats().m_entries, 0U);
+}
+
+TEST(OdaiRetrievalCacheTest, EvictsLeastRecentlyUsedResultsToStayWithinItsMemory)
+{
+  const RetrievalConfig config = make_retrieval_config();
+  const std::string text(1000, 'x');
+  OdaiRetrievalCache probe(BYTES_PER_MB);
+  probe.insert("space", "scope", "probe", config, 0, make_chunks(text));
+  const uint64_t entry_bytes = probe.stats().m_bytes;
+
+  OdaiRetrievalCache cache(entry_bytes * 2);
+  cache.insert("space", "scope", "first", config, 0, make_chunks(text));
+  cache.insert("space", "scope", "second", config, 0, make_chunks(text));
+  // using first makes second the least recently used
+  ASSERT_TRUE(cache.find("space", "scope", "first", config).has_value());
+  cache.insert("space", "scope", "third", config, 0, make_chunks(text));
+
+  EXPECT_TRUE(cache.find("space", "scope", "first", config).has_value());
+  EXPECT_FALSE(cache.find("space", "scope", "second", config).has_value());
+  EXPECT_TRUE(cache.find("space", "scope", "third", config).has_value());
+  EXPECT_LE(cache.stats().m_bytes, entry_bytes * 2);
+
+  // a result larger than the whole cache is never stored
+  cache.insert("space", "scope", "huge", config, 0, make_chunks(std::string(entry_bytes * 2, 'x')));
+  EXPECT_FALSE(cache.find("space", "scope", "huge", config).has_value());
+  EXPECT_EQ(cache.stats().m_entries, 2U);
+}
@@ -0,0 +1,123 @@
+#include "ragEngine/odai_retrieval_pool.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+/// Pool whose workers get no real resources, the tasks under test don't use them
+struct NullResourcePool
+{
+  explicit NullResourcePool(size_t max_workers)
+      : m_pool(
+            max_workers, []() -> OdaiResult<std::unique_ptr<IOdaiDb>> { return std::unique_ptr<IOdaiDb>{}; },
+            []() -> OdaiResult<std::unique_ptr<IOdaiBackendEngine>> { return std::unique_ptr<IOdaiBackendEngine>{}; })
+  {
+  }
+
+  OdaiRetrievalPool m_pool;
+};
+
+std::thread::id thread_of(OdaiRetrievalPool& pool, const ModelName& model_name)
+{
+  std::thread::id id;
+  std::future<OdaiResult<void>> result = pool.submit(model_name,
+                                                     [&id](RetrievalWorkerResources&) -> OdaiResult<void>
+                                                     {
+                                                       id = std::this_thread::get_id();
+                                                       return {};
+                                                     });
+  EXPECT_TRUE(result.get().has_value());
+  return id;
+}
+} // namespace
+
+TEST(OdaiRetrievalPoolTest, ModelsStayOnTheWorkerTheyWereFirstGiven)
+{
+  NullResourcePool resources(2);
+  OdaiRetrievalPool& pool = resources.m_pool;
+
+  const std::thread::id first = thread_of(pool, "model-a");
+  const std::thread::id second = thread_of(pool, "model-b");
+  EXPECT_NE(first, second);
+  EXPECT_NE(first, std::this_thread::get_id());
+  EXPECT_EQ(thread_of(pool, "model-a"), first);
+  EXPECT_EQ(thread_of(pool, "model-b"), second);
+
+  // past max_workers, new models share the existing workers round-robin
+  EXPECT_EQ(thread_of(pool, "model-c"), first);
+  EXPECT_EQ(pool.worker_count(), 2U);
+}
+
+TEST(OdaiRetrievalPoolTest, TasksOfDifferentWorkersRunConcurrently)
+{
+  NullResourcePool resources(2);
+  std::promise<void> a_started;
+  std::promise<void> b_started;
+  std::shared_future<void> a_started_future = a_started.get_future().share();
+  std::shared_future<void> b_started_future = b_started.get_future().share();
+
+  // each task only succeeds if the other one starts while it is still running
+  std::future<OdaiResult<void>> a = resources.m_pool.submit(
+      "model-a",
+      [&](RetrievalWorkerResources&) -> OdaiResult<void>
+      {
+        a_started.set_value();
+        if (b_started_future.wait_for(5s) != std::future_status::ready)
+        {
+          return unexpected_internal_error();
+        }
+        return {};
+      });
+  std::future<OdaiResult<void>> b = resources.m_pool.submit(
+      "model-b",
+      [&](RetrievalWorkerResources&) -> OdaiResult<void>
+      {
+        b_started.set_value();
+        if (a_started_future.wait_for(5s) != std::future_status::ready)
+        {
+          return unexpected_internal_error();
+        }
+        return {};
+      });
+
+  EXPECT_TRUE(a.get().has_value());
+  EXPECT_TRUE(b.get().has_value());
+}
+
+TEST(OdaiRetrievalPoolTest, FailingFactoriesAndThrowingTasksFailOnlyTheirTask)
+{
+  std::atomic<int> attempts{0};
+  OdaiRetrievalPool pool(
+      1,
+      [&attempts]() -> OdaiResult<std::unique_ptr<IOdaiDb>>
+      {
+        if (attempts++ == 0)
+        {
+          return tl::unexpected(OdaiResultEnum::NOT_FOUND);
+        }
+        return std::unique_ptr<IOdaiDb>{};
+      },
+      []() -> OdaiResult<std::unique_ptr<IOdaiBackendEngine>> { return std::unique_ptr<IOdaiBackendEngine>{}; });
+  auto succeed = [](RetrievalWorkerResources&) -> OdaiResult<void> { return {}; };
+
+  OdaiResult<void> failed = pool.submit("model-a", succeed).get();
+  ASSERT_FALSE(failed.has_value());
+  EXPECT_EQ(failed.error(), OdaiResultEnum::NOT_FOUND);
+  EXPECT_TRUE(pool.submit("model-a", succeed).get().has_value());
+
+  OdaiResult<void> thrown = pool
+                                .submit("model-a", [](RetrievalWorkerResources&) -> OdaiResult<void>
+                                        { throw std::runtime_error("task failed"); })
+                                .get();
+  ASSERT_FALSE(thrown.has_value());
+  EXPECT_EQ(thrown.error(), OdaiResultEnum::INTERNAL_ERROR);
+  EXPECT_TRUE(pool.submit("model-a", succeed).get().has_value());
+}
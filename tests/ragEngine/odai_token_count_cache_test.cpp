@@ -0,0 +1,119 @@
+#include "ragEngine/odai_token_count_cache.h"
+#include "types/odai_type_conversions.h"
+
+#include "odai_test_helpers.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using odai::test::expect_error;
+
+namespace
+{
+constexpr const char* MODEL_CHECKSUMS = R"({"base_model_path":"1234"})";
+
+/// Fake tokenizer counting one token per byte, recording the texts of every call
+struct FakeCounter
+{
+  OdaiResult<std::vector<uint32_t>> operator()(const std::vector<std::string>& texts)
+  {
+    m_calls.push_back(texts);
+    std::vector<uint32_t> counts;
+    for (const std::string& text : texts)
+    {
+      counts.push_back(static_cast<uint32_t>(text.size()));
+    }
+    return counts;
+  }
+
+  std::vector<std::vector<std::string>> m_calls;
+};
+} // namespace
+
+TEST(OdaiTokenCountCacheTest, CountsOnlyTextsMissingFromTheCache)
+{
+  OdaiTokenCountCache cache(8);
+  FakeCounter counter;
+
+  OdaiResult<std::vector<uint32_t>> first = cache.count("llm", MODEL_CHECKSUMS, {"abc", "de"}, std::ref(counter));
+  ASSERT_TRUE(first.has_value());
+  EXPECT_EQ(first.value(), (std::vector<uint32_t>{3, 2}));
+
+  OdaiResult<std::vector<uint32_t>> second =
+      cache.count("llm", MODEL_CHECKSUMS, {"de", "fghi", "abc"}, std::ref(counter));
+  ASSERT_TRUE(second.has_value());
+  EXPECT_EQ(second.value(), (std::vector<uint32_t>{2, 4, 3}));
+
+  ASSERT_EQ(counter.m_calls.size(), 2U);
+  EXPECT_EQ(counter.m_calls[1], (std::vector<std::string>{"fghi"}));
+
+  // every text cached, the counter isn't called at all
+  ASSERT_TRUE(cache.count("llm", MODEL_CHECKSUMS, {"fghi"}, std::ref(counter)).has_value());
+  EXPECT_EQ(counter.m_calls.size(), 2U);
+
+  const TokenCountCacheStats stats = cache.stats();
+  EXPECT_EQ(stats.m_hits, 3U);
+  EXPECT_EQ(stats.m_misses, 3U);
+  EXPECT_EQ(stats.m_entries, 3U);
+
+  // the counters odai_get_cache_stats() reports
+  CacheStats cache_stats;
+  cache_stats.m_tokenCount = stats;
+  const c_CacheStats c_stats = to_c(cache_stats);
+  EXPECT_EQ(c_stats.m_tokenCountHits, 3U);
+  EXPECT_EQ(c_stats.m_tokenCountMisses, 3U);
+  EXPECT_EQ(c_stats.m_tokenCountEntries, 3U);
+}
+
+TEST(OdaiTokenCountCacheTest, CountsArePerModelAndDroppedWithTheModel)
+{
+  OdaiTokenCountCache cache(8);
+  FakeCounter counter;
+  ASSERT_TRUE(cache.count("llm", MODEL_CHECKSUMS, {"text"}, std::ref(counter)).has_value());
+  ASSERT_TRUE(cache.count("other", R"({"base_model_path":"5678"})", {"text"}, std::ref(counter)).has_value());
+  EXPECT_EQ(counter.m_calls.size(), 2U);
+
+  cache.invalidate_model("llm");
+  EXPECT_EQ(cache.stats().m_entries, 1U);
+  ASSERT_TRUE(cache.count("llm", MODEL_CHECKSUMS, {"text"}, std::ref(counter)).has_value());
+  EXPECT_EQ(counter.m_calls.size(), 3U);
+}
+
+TEST(OdaiTokenCountCacheTest, EvictsTheLeastRecentlyUsedCount)
+{
+  OdaiTokenCountCache cache(2);
+  FakeCounter counter;
+  ASSERT_TRUE(cache.count("llm", MODEL_CHECKSUMS, {"first", "second"}, std::ref(counter)).has_value());
+  // using first makes second the least recently used
+  ASSERT_TRUE(cache.count("llm", MODEL_CHECKSUMS, {"first"}, std::ref(counter)).has_value());
+  ASSERT_TRUE(cache.count("llm", MODEL_CHECKSUMS, {"third"}, std::ref(counter)).has_value());
+
+  ASSERT_TRUE(cache.count("llm", MODEL_CHECKSUMS, {"first", "second"}, std::ref(counter)).has_value());
+  EXPECT_EQ(counter.m_calls.back(), (std::vector<std::string>{"second"}));
+  EXPECT_EQ(cache.stats().m_entries, 2U);
+}
+
+TEST(OdaiTokenCountCacheTest, CounterErrorsAreReturnedAndNothingIsCached)
+{
+  OdaiTokenCountCache cache(8);
+  TokenCountFn failing = [](const std::vector<std::string>&) -> OdaiResult<std::vector<uint32_t>>
+  { return tl::unexpected(OdaiResultEnum::NOT_FOUND); };
+  expect_error(cache.count("llm", MODEL_CHECKSUMS, {"text"}, failing), OdaiResultEnum::NOT_FOUND);
+
+  TokenCountFn short_result = [](const std::vector<std::string>&) -> OdaiResult<std::vector<uint32_t>>
+  { return std::vector<uint32_t>{}; };
+  expect_error(cache.count("llm", MODEL_CHECKSUMS, {"text"}, short_result), OdaiResultEnum::INTERNAL_ERROR);
+  EXPECT_EQ(cache.stats().m_entries, 0U);
+}
+
+TEST(OdaiTokenCountCacheTest, ZeroCapacityCountsEveryTime)
+{
+  OdaiTokenCountCache cache(0);
+  FakeCounter counter;
+  ASSERT_TRUE(cache.count("llm", MODEL_CHECKSUMS, {"text"}, std::ref(counter)).has_value());
+  ASSERT_TRUE(cache.count("llm", MODEL_CHECKSUMS, {"text"}, std::ref(counter)).has_value());
+  EXPECT_EQ(counter.m_calls.size(), 2U);
+  EXPECT_EQ(cache.stats().m_entries, 0U);
+}